@@ -2,7 +2,8 @@
 // Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
 
 /*
-  PWM capabilities provided by the ESP32 LEDC controller via the ESP-IDF driver
+  PWM capabilities provided by the ESP32 LEDC controller via the ESP-IDF driver,
+  or optionally by an MCPWM timer for finer duty steps at high frequencies
 */
 
 #include "Driver/PwmPin.h"
@@ -12,6 +13,8 @@
 
 #include "soc/soc_caps.h"
 #include "driver/ledc.h"
+#include "driver/mcpwm.h"
+#include "hal/mcpwm_ll.h"  // mcpwm_ll_operator_set_compare_value()
 
 //Use XTAL clock if possible to avoid timer frequency error when setting APB clock < 80 Mhz
 //Need to be fixed in ESP-IDF
@@ -71,7 +74,64 @@ static uint8_t calc_pwm_precision(uint32_t frequency) {
     return ledcMaxBits;
 }
 
-PwmPin::PwmPin(int gpio, bool invert, uint32_t frequency) : _gpio(gpio), _frequency(frequency) {
+#if SOC_MCPWM_SUPPORTED
+// Each pin gets a timer of its own, driving output A of the operator with the same number
+static int allocateMcpwmTimer() {
+    static int nextMcpwmTimer = 0;
+
+    Assert(nextMcpwmTimer < SOC_MCPWM_GROUPS * SOC_MCPWM_TIMERS_PER_GROUP, "Out of MCPWM PwmPin timers");
+    return nextMcpwmTimer++;
+}
+
+static mcpwm_dev_t* mcpwmDev(int unit) {
+    return unit ? &MCPWM1 : &MCPWM0;
+}
+
+void PwmPin::initMcpwm() {
+    const uint32_t groupClock = 160000000;  // The MCPWM source clock, undivided
+    const uint32_t maxPeriod  = 65535;      // The timer period register is 16 bits
+
+    if (_frequency == 0) {
+        _frequency = 1;  // Limited elsewhere but just to be safe...
+    }
+    _channel = allocateMcpwmTimer();
+
+    mcpwm_unit_t  unit    = mcpwm_unit_t(_channel / SOC_MCPWM_TIMERS_PER_GROUP);
+    mcpwm_timer_t timer   = mcpwm_timer_t(_channel % SOC_MCPWM_TIMERS_PER_GROUP);
+    uint32_t      divisor = (groupClock / _frequency + maxPeriod - 1) / maxPeriod;
+    if (divisor == 0) {
+        divisor = 1;
+    }
+    uint32_t resolution = groupClock / divisor;
+    _period             = resolution / _frequency;
+
+    mcpwm_config_t config = { .frequency    = _frequency,
+                              .cmpr_a       = 0,
+                              .cmpr_b       = 0,
+                              .duty_mode    = _invert ? MCPWM_DUTY_MODE_1 : MCPWM_DUTY_MODE_0,
+                              .counter_mode = MCPWM_UP_COUNTER };
+
+    if (mcpwm_gpio_init(unit, mcpwm_io_signals_t(MCPWM0A + 2 * timer), _gpio) != ESP_OK ||
+        mcpwm_group_set_resolution(unit, groupClock) != ESP_OK || mcpwm_timer_set_resolution(unit, timer, resolution) != ESP_OK ||
+        mcpwm_init(unit, timer, &config) != ESP_OK) {
+        log_error("mcpwm setup failed");
+        throw -1;
+    }
+    setDuty(0);
+}
+#else
+void PwmPin::initMcpwm() {
+    log_error("This chip has no MCPWM");
+    throw -1;
+}
+#endif
+
+PwmPin::PwmPin(int gpio, bool invert, uint32_t frequency, bool mcpwm) :
+    _gpio(gpio), _frequency(frequency), _mcpwm(mcpwm), _invert(invert) {
+    if (_mcpwm) {
+        initMcpwm();
+        return;
+    }
     uint8_t bits       = calc_pwm_precision(frequency);
     _period            = (1 << bits) - 1;
     _channel           = allocateChannel();
@@ -105,6 +165,23 @@ PwmPin::PwmPin(int gpio, bool invert, uint32_t frequency) : _gpio(gpio), _freque
 
 // cppcheck-suppress unusedFunction
 void IRAM_ATTR PwmPin::setDuty(uint32_t duty) {
+#if SOC_MCPWM_SUPPORTED
+    if (_mcpwm) {
+        // The compare value is latched when the timer next reaches zero, so a change never
+        // makes a runt pulse.  A duty of 0 forces the idle level, because a compare value
+        // of 0 coincides with the start of the period.  A duty above the last count never
+        // matches, so the output stays on for the whole period.
+        auto dev = mcpwmDev(_channel / SOC_MCPWM_TIMERS_PER_GROUP);
+        int  op  = _channel % SOC_MCPWM_TIMERS_PER_GROUP;
+        if (duty == 0) {
+            mcpwm_ll_gen_set_continue_force_level(dev, op, 0, _invert);
+        } else {
+            mcpwm_ll_operator_set_compare_value(dev, op, 0, duty);
+            mcpwm_ll_gen_disable_continue_force_action(dev, op, 0);
+        }
+        return;
+    }
+#endif
     uint8_t g = _channel >> 3, c = _channel & 7;
     bool    on = duty != 0;
 
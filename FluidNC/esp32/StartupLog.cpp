@@ -4,18 +4,46 @@
 #include "src/StartupLog.h"
 #include "src/Protocol.h"  // send_line()
 #include <sstream>
+#include <esp_timer.h>  // esp_timer_get_time
 
 // The startup log is stored in RTC RAM that is preserved across
 // resets.  That lets us show the previous startup log if the
 // system panics and resets.
 
-// The size is limited by the size of RTC RAM minus system usage thereof
-static const size_t           _maxlen = 7000;
+// The size is limited by the size of RTC RAM minus system usage thereof,
+// and the crash record, see Driver/crash_record.h
+static const size_t           _maxlen = 6500;
 static RTC_NOINIT_ATTR char   _messages[_maxlen];
 static RTC_NOINIT_ATTR size_t _len;
 static bool                   _paniced;
 
+struct Stage {
+    const char* name;
+    int32_t     us;
+    int32_t     heap;  // Bytes consumed; negative if the stage freed memory
+};
+static const size_t _maxstages = 48;
+static Stage        _stages[_maxstages];
+static size_t       _nstages;
+static int64_t      _stage_start;
+static int64_t      _init_time;
+static uint32_t     _stage_heap;
+
+void StartupLog::stage(const char* name) {
+    int64_t  now  = esp_timer_get_time();
+    uint32_t heap = xPortGetFreeHeapSize();
+    if (_nstages < _maxstages) {
+        _stages[_nstages++] = { name, int32_t(now - _stage_start), int32_t(_stage_heap - heap) };
+    }
+    _stage_start = now;
+    _stage_heap  = heap;
+}
+
 void StartupLog::init() {
+    _init_time   = esp_timer_get_time();
+    _stage_start = _init_time;
+    _stage_heap  = xPortGetFreeHeapSize();
+    _nstages     = 0;
     if (esp_reset_reason() == ESP_RST_PANIC) {
         _paniced = true;
     } else {
@@ -52,6 +80,19 @@ void StartupLog::dump(Channel& out) {
         }
         log_stream(out, line);
     }
+
+    if (_nstages) {
+        log_stream(out, "[Startup began at " << int32_t(_init_time) << "us]");
+        int32_t total_us   = 0;
+        int32_t total_heap = 0;
+        for (size_t i = 0; i < _nstages; i++) {
+            auto& s = _stages[i];
+            log_stream(out, "[Startup stage " << s.name << " " << s.us << "us heap:" << s.heap << "]");
+            total_us += s.us;
+            total_heap += s.heap;
+        }
+        log_stream(out, "[Startup total " << total_us << "us heap:" << total_heap << " free:" << _stage_heap << "]");
+    }
 }
 
 StartupLog::~StartupLog() {}
@@ -0,0 +1,53 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "driver/adc.h"
+#include "esp_adc_cal.h"
+
+#include "Driver/adc.h"
+#include "src/Logging.h"
+
+static esp_adc_cal_characteristics_t adc_chars;
+static bool                          adc_characterized = false;
+
+static bool adc_channel(pinnum_t pin, adc1_channel_t& channel) {
+    static const struct {
+        pinnum_t       pin;
+        adc1_channel_t channel;
+    } channels[] = {
+        { 36, ADC1_CHANNEL_0 }, { 37, ADC1_CHANNEL_1 }, { 38, ADC1_CHANNEL_2 }, { 39, ADC1_CHANNEL_3 },
+        { 32, ADC1_CHANNEL_4 }, { 33, ADC1_CHANNEL_5 }, { 34, ADC1_CHANNEL_6 }, { 35, ADC1_CHANNEL_7 },
+    };
+    for (auto& c : channels) {
+        if (c.pin == pin) {
+            channel = c.channel;
+            return true;
+        }
+    }
+    return false;
+}
+
+// cppcheck-suppress unusedFunction
+bool adc_init(pinnum_t pin) {
+    adc1_channel_t channel;
+    if (!adc_channel(pin, channel)) {
+        log_error("GPIO " << int(pin) << " is not an ADC1 pin");
+        return false;
+    }
+    adc1_config_width(ADC_WIDTH_BIT_12);
+    adc1_config_channel_atten(channel, ADC_ATTEN_DB_11);
+    if (!adc_characterized) {
+        esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12, 1100, &adc_chars);
+        adc_characterized = true;
+    }
+    return true;
+}
+
+// cppcheck-suppress unusedFunction
+uint32_t adc_read_mv(pinnum_t pin) {
+    adc1_channel_t channel;
+    if (!adc_channel(pin, channel)) {
+        return 0;
+    }
+    return esp_adc_cal_raw_to_voltage(adc1_get_raw(channel), &adc_chars);
+}
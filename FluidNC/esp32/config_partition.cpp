@@ -0,0 +1,103 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Driver/config_partition.h"
+
+#include "esp_partition.h"
+#include "wdt.h"
+#include "src/Config.h"
+
+#include <cstring>
+
+// The image is a header followed by the text.  The name is the file that the text
+// was copied from, so a change of $Config/Filename does not load a stale image.
+struct image_header {
+    char     magic[4];  // "FNCC"
+    uint32_t size;      // Bytes of text after the header
+    char     name[56];
+};
+
+static const char              image_magic[4] = { 'F', 'N', 'C', 'C' };
+static const char*             label          = "config";
+static spi_flash_mmap_handle_t map_handle;
+static bool                    mapped = false;
+
+static const esp_partition_t* find_partition() {
+    return esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+}
+
+const char* config_partition_map(size_t& size, const char*& name) {
+    auto part = find_partition();
+    if (!part || mapped) {
+        return nullptr;
+    }
+
+    // Reading the header first avoids mapping the whole partition when it is blank
+    image_header header;
+    if (esp_partition_read(part, 0, &header, sizeof(header)) != ESP_OK || memcmp(header.magic, image_magic, sizeof(image_magic)) ||
+        header.size == 0 || header.size > part->size - sizeof(header)) {
+        return nullptr;
+    }
+
+    const void* base;
+    esp_err_t   err = esp_partition_mmap(part, 0, sizeof(header) + header.size, SPI_FLASH_MMAP_DATA, &base, &map_handle);
+    if (err != ESP_OK) {
+        log_debug("Cannot map the config partition: " << esp_err_to_name(err));
+        return nullptr;
+    }
+    mapped = true;
+
+    auto image = static_cast<const image_header*>(base);
+    size       = image->size;
+    name       = image->name;
+    return reinterpret_cast<const char*>(image + 1);
+}
+
+void config_partition_unmap() {
+    if (mapped) {
+        spi_flash_munmap(map_handle);
+        mapped = false;
+    }
+}
+
+bool config_partition_write(const char* name, const char* text, size_t size) {
+    auto part = find_partition();
+    if (!part) {
+        log_error("The partition map has no config partition");
+        return true;
+    }
+    if (mapped || size == 0 || size > part->size - sizeof(image_header) || strlen(name) >= sizeof(image_header::name)) {
+        return true;
+    }
+
+    image_header header = {};
+    memcpy(header.magic, image_magic, sizeof(image_magic));
+    header.size = size;
+    strcpy(header.name, name);
+
+    size_t extent = (sizeof(header) + size + SPI_FLASH_SEC_SIZE - 1) & ~(SPI_FLASH_SEC_SIZE - 1);
+
+    // The header goes last so a power failure during the write leaves no image, not a partial one
+    disable_core0_WDT();
+    esp_err_t err = esp_partition_erase_range(part, 0, extent);
+    if (err == ESP_OK) {
+        err = esp_partition_write(part, sizeof(header), text, size);
+    }
+    if (err == ESP_OK) {
+        err = esp_partition_write(part, 0, &header, sizeof(header));
+    }
+    enable_core0_WDT();
+    if (err != ESP_OK) {
+        log_error("Config partition write failed: " << esp_err_to_name(err));
+        return true;
+    }
+    return false;
+}
+
+bool config_partition_erase() {
+    auto part = find_partition();
+    if (!part || mapped) {
+        return true;
+    }
+    return esp_partition_erase_range(part, 0, SPI_FLASH_SEC_SIZE) != ESP_OK;
+}
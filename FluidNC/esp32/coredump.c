@@ -5,6 +5,9 @@
 // This suppresses complaints about not being able to find a coredump partition.
 // We don't want to waste space for such a partition, and the Arduino Framework
 // enables coredumps.  We override that by stubbing out these routines.
+//
+// The panic handler still calls esp_core_dump_to_flash() before it restarts, which
+// makes it the place to write the compact crash record, see Driver/crash_record.h.
 
 #include <stddef.h>
 #include "esp_err.h"
@@ -21,8 +24,12 @@ void esp_core_dump_init(void) {}
 // cppcheck-suppress unusedFunction
 void esp_core_dump_flash_init(void) {}
 
+void crash_record_capture(const void* info);
+
 // cppcheck-suppress unusedFunction
-void esp_core_dump_to_flash(void* info) {}
+void esp_core_dump_to_flash(void* info) {
+    crash_record_capture(info);
+}
 
 // cppcheck-suppress unusedFunction
 esp_err_t esp_core_dump_image_check(void) {
@@ -0,0 +1,146 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Driver/crash_record.h"
+
+#include <sdkconfig.h>
+#include <cstring>
+
+#ifdef CONFIG_IDF_TARGET_ARCH_XTENSA
+
+#    include <esp_attr.h>                    // RTC_NOINIT_ATTR
+#    include <esp_timer.h>                   // esp_timer_get_time()
+#    include <esp_debug_helpers.h>           // esp_backtrace_get_next_frame()
+#    include <esp_private/panic_internal.h>  // panic_info_t
+#    include <soc/soc_memory_layout.h>       // esp_stack_ptr_is_sane()
+#    include <freertos/FreeRTOS.h>
+#    include <freertos/task.h>
+#    include <freertos/xtensa_context.h>  // XtExcFrame
+
+static const uint32_t crash_magic    = 0x48535243;  // "CRSH"
+static const uint32_t quick_panic_ms = 60000;
+static crash_hook_t   app_hook       = nullptr;
+
+// It shares the RTC memory that survives a restart with the startup log
+static RTC_NOINIT_ATTR crash_record_t record;
+
+static_assert(sizeof(crash_record_t) <= 512, "The crash record does not fit in its share of RTC memory");
+
+// FNV-1a of everything before check, so that the random contents of RTC memory
+// after a power-up are not taken for a record
+static uint32_t checksum(const crash_record_t& r) {
+    auto     p = reinterpret_cast<const uint8_t*>(&r);
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < offsetof(crash_record_t, check); i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+static bool valid() {
+    return record.magic == crash_magic && record.check == checksum(record);
+}
+
+// A return address has the window increment in its top two bits, and points after
+// the call.  This is what the panic handler prints, so decoders treat both alike.
+static uint32_t stack_pc(uint32_t pc) {
+    if (pc & 0x80000000) {
+        pc = (pc & 0x3fffffff) | 0x40000000;
+    }
+    return pc - 3;
+}
+
+static void record_backtrace(const XtExcFrame* frame) {
+    esp_backtrace_frame_t f = { uint32_t(frame->pc), uint32_t(frame->a1), uint32_t(frame->a0), frame };
+
+    record.backtrace[0][0] = stack_pc(f.pc);
+    record.backtrace[0][1] = f.sp;
+    record.depth           = 1;
+    if (!esp_stack_ptr_is_sane(f.sp)) {
+        record.corrupted = true;
+        return;
+    }
+    while (record.depth < crash_backtrace_depth && f.next_pc) {
+        if (!esp_backtrace_get_next_frame(&f)) {
+            record.corrupted = true;
+            return;
+        }
+        record.backtrace[record.depth][0] = stack_pc(f.pc);
+        record.backtrace[record.depth][1] = f.sp;
+        ++record.depth;
+    }
+}
+
+// Called by the panic handler, after it prints the registers and the backtrace, in
+// place of the core dump to flash, see coredump.c
+extern "C" void crash_record_capture(const void* arg) {
+    auto info = static_cast<const panic_info_t*>(arg);
+
+    uint32_t quick_panics = valid() ? record.quick_panics : 0;
+    memset(&record, 0, sizeof(record));
+    record.magic     = crash_magic;
+    record.core      = info->core;
+    record.uptime_ms = uint32_t(esp_timer_get_time() / 1000);
+    if (record.uptime_ms < quick_panic_ms) {
+        record.quick_panics = quick_panics + 1;
+    }
+    if (info->reason) {
+        strncpy(record.reason, info->reason, sizeof(record.reason) - 1);
+    }
+    TaskHandle_t task = xTaskGetCurrentTaskHandleForCPU(info->core);
+    if (task) {
+        strncpy(record.task, pcTaskGetName(task), sizeof(record.task) - 1);
+    }
+
+    auto frame = static_cast<const XtExcFrame*>(info->frame);
+    if (frame) {
+        record.pc       = frame->pc;
+        record.ps       = frame->ps;
+        record.sar      = frame->sar;
+        record.exccause = frame->exccause;
+        record.excvaddr = frame->excvaddr;
+        memcpy(record.a, &frame->a0, sizeof(record.a));
+        record_backtrace(frame);
+    }
+    record.check = checksum(record);
+
+    // The hook fills a copy, so that a fault in it leaves the record without the app
+    // area instead of without a valid check
+    if (app_hook) {
+        uint8_t app[crash_app_size] = {};
+        app_hook(app, sizeof(app));
+        memcpy(record.app, app, sizeof(app));
+        record.check = checksum(record);
+    }
+}
+
+bool crash_record_supported() {
+    return true;
+}
+
+void crash_record_set_hook(crash_hook_t hook) {
+    app_hook = hook;
+}
+
+const crash_record_t* crash_record_last() {
+    return valid() ? &record : nullptr;
+}
+
+void crash_record_clear() {
+    record.magic = 0;
+}
+
+#else
+
+extern "C" void crash_record_capture(const void* arg) {}
+
+bool crash_record_supported() {
+    return false;
+}
+void crash_record_set_hook(crash_hook_t hook) {}
+const crash_record_t* crash_record_last() {
+    return nullptr;
+}
+void crash_record_clear() {}
+
+#endif
@@ -5,6 +5,7 @@
 #include "src/Uart.h"
 #include "src/Protocol.h"
 #include "Driver/fluidnc_gpio.h"
+#include "Driver/delay_usecs.h"  // getCpuTicks()
 
 #include "driver/gpio.h"
 #include "hal/gpio_hal.h"
@@ -40,11 +41,13 @@ void gpio_mode(pinnum_t pin, int input, int output, int pullup, int pulldown, in
 void gpio_drive_strength(pinnum_t pin, int strength) {
     gpio_set_drive_capability((gpio_num_t)pin, (gpio_drive_cap_t)strength);
 }
-#if 0
+// mode is one of Pin::RISING_EDGE, FALLING_EDGE or EITHER_EDGE, which match gpio_int_type_t.
+// The callback runs in interrupt context and must be in IRAM.
 void gpio_add_interrupt(pinnum_t pin, int mode, void (*callback)(void*), void* arg) {
     gpio_install_isr_service(ESP_INTR_FLAG_IRAM);  // Will return an err if already called
 
     gpio_num_t gpio = (gpio_num_t)pin;
+    gpio_set_intr_type(gpio, (gpio_int_type_t)mode);
     gpio_isr_handler_add(gpio, callback, arg);
 
     //FIX interrupts on peripherals outputs (eg. LEDC,...)
@@ -58,7 +61,6 @@ void gpio_remove_interrupt(pinnum_t pin) {
     gpio_isr_handler_remove(gpio);  //remove handle and disable isr for pin
     gpio_set_intr_type(gpio, GPIO_INTR_DISABLE);
 }
-#endif
 void gpio_route(pinnum_t pin, uint32_t signal) {
     if (pin == 255) {
         return;
@@ -137,7 +139,7 @@ static void gpio_send_event(int gpio_num, bool active) {
 
         auto arg = gpioArgs[gpio_num];
         if (arg) {
-            protocol_send_event_from_ISR(active ? &pinActiveEvent : &pinInactiveEvent, arg);
+            protocol_send_pin_event_from_ISR(static_cast<InputPin*>(arg), active);
         }
         gpios_update(gpios_current, gpio_num, active);
     }
@@ -156,3 +158,58 @@ void poll_gpios() {
         }
     }
 }
+
+// Fast actions are sampled by the step ISR, so a limit switch stops its motor
+// within a step period plus the debounce time, instead of waiting for the
+// next poll_gpios() and a task switch.  A change must be stable for
+// fast_debounce_ticks before the action runs, which filters the electrical
+// noise that long switch cables pick up near stepper wiring.  The ESP32
+// GPIO matrix has no glitch filter, so the filtering is done here.
+static gpio_mask_t gpios_fast       = 0;  // GPIOs with a fast action
+static gpio_mask_t gpios_fast_state = 0;  // The debounced state of the fast GPIOs
+static gpio_mask_t gpios_fast_seen  = 0;  // The state that was pending at the last sample
+static int32_t     fast_since_ticks = 0;  // When gpios_fast_seen last changed
+
+static int32_t fast_debounce_ticks = 0;
+
+static void (*gpioFastCallbacks[GPIO_NUM_MAX + 1])(void*, int);
+static void* gpioFastArgs[GPIO_NUM_MAX + 1];
+
+void gpio_set_fast_action(int gpio_num, void (*callback)(void*, int), void* arg) {
+    gpioFastCallbacks[gpio_num] = callback;
+    gpioFastArgs[gpio_num]      = arg;
+    gpios_update(gpios_fast_state, gpio_num, gpio_is_active(gpio_num));
+    gpios_update(gpios_fast_seen, gpio_num, gpio_is_active(gpio_num));
+    gpios_update(gpios_fast, gpio_num, true);
+}
+void gpio_set_fast_debounce(int32_t ticks) {
+    fast_debounce_ticks = ticks;
+}
+
+void IRAM_ATTR gpio_sample_fast() {
+    if (!gpios_fast) {
+        return;
+    }
+    gpio_mask_t gpios_active = get_gpios() & gpios_fast;
+    int32_t     now          = getCpuTicks();
+    if (gpios_active != gpios_fast_seen) {
+        // Restart the debounce period on every change
+        gpios_fast_seen  = gpios_active;
+        fast_since_ticks = now;
+        if (fast_debounce_ticks) {
+            return;
+        }
+    }
+    gpio_mask_t gpios_changed = gpios_active ^ gpios_fast_state;
+    if (!gpios_changed || (now - fast_since_ticks) < fast_debounce_ticks) {
+        return;
+    }
+    gpios_fast_state = gpios_active;
+    int zeros;
+    while ((zeros = __builtin_clzll(gpios_changed)) != 64) {
+        int gpio_num = 63 - zeros;
+        gpio_mask_t mask     = 1ULL << gpio_num;
+        gpioFastCallbacks[gpio_num](gpioFastArgs[gpio_num], (gpios_active & mask) != 0);
+        gpios_changed &= ~mask;
+    }
+}
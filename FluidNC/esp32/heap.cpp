@@ -0,0 +1,42 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Driver/heap.h"
+
+#include <esp_heap_caps.h>
+
+static const uint32_t region_caps[HEAP_NREGIONS] = {
+    MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,  // HEAP_INTERNAL
+    MALLOC_CAP_SPIRAM,                      // HEAP_PSRAM
+    MALLOC_CAP_DMA,                         // HEAP_DMA
+};
+
+static const char* region_names[HEAP_NREGIONS] = { "Internal", "PSRAM", "DMA" };
+
+const char* heap_region_name(heap_region_t region) {
+    return region_names[region];
+}
+
+bool heap_region_stats(heap_region_t region, heap_region_stats_t& stats) {
+    uint32_t caps = region_caps[region];
+    if (heap_caps_get_total_size(caps) == 0) {
+        return false;
+    }
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, caps);
+    stats.total            = heap_caps_get_total_size(caps);
+    stats.free             = info.total_free_bytes;
+    stats.largest_block    = info.largest_free_block;
+    stats.min_free         = info.minimum_free_bytes;
+    stats.allocated_blocks = info.allocated_blocks;
+    stats.free_blocks      = info.free_blocks;
+    return true;
+}
+
+void* heap_region_calloc(heap_region_t region, size_t size) {
+    return heap_caps_calloc(1, size, region_caps[region] | MALLOC_CAP_8BIT);
+}
+
+void heap_region_free(void* ptr) {
+    heap_caps_free(ptr);
+}
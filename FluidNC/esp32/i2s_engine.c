@@ -9,6 +9,9 @@
 // pulse_func to determine the new values of those variables. The FIFO lets the ISR stay
 // just far enough ahead so the information is always ready, but not so far ahead to cause
 // latency problems.
+//
+// The I2S_STREAM engine at the end of this file feeds the same shift registers from DMA
+// buffers instead, see the description there.
 
 #include "Driver/step_engine.h"
 #include "Driver/i2s_out.h"
@@ -30,6 +33,7 @@
 #include "Driver/fluidnc_gpio.h"
 
 #include "esp_intr_alloc.h"
+#include "esp_heap_caps.h"
 
 uint32_t i2s_frame_us;  // 1, 2 or 4
 
@@ -152,14 +156,60 @@ static int i2s_out_start() {
 #define FIFO_REMAINING (FIFO_LENGTH - FIFO_THRESHOLD)
 #define FIFO_RELOAD 8
 
+// Samples in each of the two DMA buffers of the I2S_STREAM engine, 0.5 to 2 ms
+// depending on i2s_frame_us.  The DMA descriptor limit is 4095 bytes.
+#define DMA_SAMPLES 500
+
+// Samples that the I2S_STREAM engine sends from each buffer while homing or probing
+#define LOW_LATENCY_SAMPLES 50
+
 static bool timer_running = false;
+static bool i2s_streaming = false;  // True when DMA, not the FIFO ISR, feeds the I2S FIFO
+
+// Nesting depth of i2s_out_begin().  While it is nonzero, writes only change i2s_out_port_data
+// and i2s_out_commit() sends the result, so that a group of pin changes shares one latch.
+static volatile int  i2s_out_batch_depth   = 0;
+static volatile bool i2s_out_batch_dirty   = false;  // A write is waiting for the commit
+static volatile bool i2s_out_batch_delayed = false;  // A synchronous write is waiting for the commit
+
+static void wait_for_latch();
+
+void IRAM_ATTR i2s_out_begin() {
+    ++i2s_out_batch_depth;
+}
+
+void IRAM_ATTR i2s_out_commit() {
+    if (--i2s_out_batch_depth > 0) {
+        return;
+    }
+    if (i2s_out_batch_dirty) {
+        i2s_out_batch_dirty = false;
+        if (!timer_running && !i2s_streaming) {
+            I2S0.fifo_wr = i2s_out_port_data;
+        }
+    }
+    if (i2s_out_batch_delayed) {
+        i2s_out_batch_delayed = false;
+        wait_for_latch();
+    }
+}
 
 void i2s_out_delay() {
+    if (i2s_out_batch_depth) {
+        i2s_out_batch_delayed = true;
+        return;
+    }
+    wait_for_latch();
+}
+
+static void wait_for_latch() {
     // Empirically, FIFO_LENGTH/2 seems to be enough, but we use
     // FIFO_LENGTH to be safe.  This function is used infrequently,
     // typically only when setting up TMC drivers, so the extra
     // delay does not affect the performance significantly.
-    uint32_t wait_counts = FIFO_LENGTH;
+    // When streaming, a write appears after both DMA buffers have been sent.
+    // Buffers are never longer than DMA_SAMPLES, whatever the latency mode.
+    uint32_t wait_counts = i2s_streaming ? FIFO_LENGTH + 2 * DMA_SAMPLES : FIFO_LENGTH;
     delay_us(i2s_frame_us * wait_counts);
 }
 
@@ -171,7 +221,9 @@ void IRAM_ATTR i2s_out_write(pinnum_t pin, uint8_t val) {
         i2s_out_port_data &= ~bit;
     }
 
-    if (!timer_running) {
+    if (i2s_out_batch_depth) {
+        i2s_out_batch_dirty = true;
+    } else if (!timer_running && !i2s_streaming) {
         // Direct write to the I2S FIFO in case the pulse timer is not running
         I2S0.fifo_wr = i2s_out_port_data;
     }
@@ -405,10 +457,8 @@ static void i2s_fifo_intr_setup() {
                               NULL);
 }
 
-static uint32_t init_engine(uint32_t dir_delay_us, uint32_t pulse_us, uint32_t frequency, bool (*callback)(void)) {
-    _pulse_func = callback;
-    i2s_fifo_intr_setup();
-
+// Converts the pulse parameters to I2S frames.  Shared by both I2S engines.
+static void set_pulse_timing(uint32_t dir_delay_us, uint32_t pulse_us, uint32_t frequency) {
     if (pulse_us < i2s_frame_us) {
         pulse_us = i2s_frame_us;
     }
@@ -418,6 +468,13 @@ static uint32_t init_engine(uint32_t dir_delay_us, uint32_t pulse_us, uint32_t f
     _dir_delay_us = dir_delay_us;
     _pulse_counts = (pulse_us + i2s_frame_us - 1) / i2s_frame_us;
     _tick_divisor = frequency * i2s_frame_us / 1000000;
+}
+
+static uint32_t init_engine(uint32_t dir_delay_us, uint32_t pulse_us, uint32_t frequency, bool (*callback)(void)) {
+    _pulse_func = callback;
+    i2s_fifo_intr_setup();
+
+    set_pulse_timing(dir_delay_us, pulse_us, frequency);
 
     _remaining_pulse_counts = 0;
     _remaining_delay_counts = 0;
@@ -442,14 +499,18 @@ static IRAM_ATTR void set_dir_pin(int pin, int level) {
     i2s_out_write(pin, level);
 }
 
-// For direction changes, we push one sample to the FIFO
-// and busy-wait for the delay.  If the delay is short enough,
-// it might be possible to use the same multiple-sample trick
-// that we use for step pulses, but the optimizaton might not
-// be worthwhile since direction changes are infrequent.
+// For direction changes, we push one sample to the FIFO.  The
+// delay runs from then, and wait_dir() waits out what is left
+// of it before the next pulse.
+static int32_t _dirEndTime;
+
 static IRAM_ATTR void finish_dir() {
     I2S0.fifo_wr = i2s_out_port_data;
-    delay_us(_dir_delay_us);
+    _dirEndTime  = usToEndTicks(_dir_delay_us);
+}
+
+static IRAM_ATTR void wait_dir() {
+    spinUntil(_dirEndTime);
 }
 
 static void IRAM_ATTR start_step() {
@@ -493,7 +554,237 @@ step_engine_t i2s_engine = {
     max_pulses_per_sec,
     set_timer_ticks,
     start_timer,
-    stop_timer
+    stop_timer,
+    NULL,  // step_train
+    wait_dir
 };
 // clang-format on
 REGISTER_STEP_ENGINE(I2S, &i2s_engine);
+
+// I2S_STREAM engine.  Two DMA buffers alternate: while DMA sends one to the shift registers,
+// the end-of-frame interrupt of the other refills it.  The refill renders the step pulses
+// directly as sample words, and calls the pulse function only when everything it returned
+// last time has been rendered.  With stepping/pulse_trains, one call covers a whole train of
+// up to STEP_TRAIN_MAX_TICKS pulse events; without it, each call is a train of one event.
+// The CPU cost is a word store per sample plus one call per train, instead of an interrupt
+// every FIFO_RELOAD samples.  The price is latency: step pulses and writes to the other I2S
+// outputs reach the pins one to two buffers after they are generated.
+
+#define IDLE_SAMPLES 50  // Train length when the pulse function has nothing to do
+
+static lldesc_t* _dma_desc[2];
+
+static uint32_t _train_masks[STEP_TRAIN_MAX_TICKS];  // Step pins to toggle at each tick of the train
+static uint32_t _train_period;                        // Stepping timer ticks per train tick
+static uint32_t _train_ticks;                         // Stepping timer ticks in the train
+static uint32_t _tick_carry;                          // Stepping timer ticks not yet rendered as samples
+
+static uint32_t _train_len;         // Samples in the train
+static uint32_t _train_pos;         // Samples of the train already rendered
+static int      _train_tick;        // Tick of the next pulse of the train
+static uint32_t _pulse_start;       // Sample at which that pulse starts, UINT32_MAX when none
+static uint32_t _lead_counts;       // Samples before the first pulse when the direction changed
+static uint32_t _dir_delay_counts;  // dir_delay_us in samples
+
+static volatile uint32_t _dma_samples = DMA_SAMPLES;  // Samples per buffer from the next refill on
+
+static inline void IRAM_ATTR find_pulse() {
+    while (_train_tick < STEP_TRAIN_MAX_TICKS && !_train_masks[_train_tick]) {
+        ++_train_tick;
+    }
+    if (_train_tick == STEP_TRAIN_MAX_TICKS) {
+        _pulse_start = UINT32_MAX;
+        return;
+    }
+    uint32_t start = _train_tick * _train_period / _tick_divisor;
+    if (start < _lead_counts) {
+        start = _lead_counts;
+    }
+    if (start < _train_pos) {  // Pulses that are too close together are sent one after the other
+        start = _train_pos;
+    }
+    _pulse_start = start;
+}
+
+static void IRAM_ATTR start_train() {
+    for (int i = 0; i < STEP_TRAIN_MAX_TICKS; i++) {
+        _train_masks[i] = 0;
+    }
+    _train_period = 0;  // Unused by single steps, which are all at tick 0
+    _lead_counts  = 0;
+
+    // Without pulse trains, the train is one step at the period that pulse_func() set last
+    uint32_t ticks = _pulse_func() ? _train_ticks : IDLE_SAMPLES * _tick_divisor;
+    ticks += _tick_carry;
+    _train_len  = ticks / _tick_divisor;
+    _tick_carry = ticks % _tick_divisor;
+    if (_train_len == 0) {
+        _train_len = 1;
+    }
+    _train_pos  = 0;
+    _train_tick = 0;
+    find_pulse();
+}
+
+// Fills a DMA buffer with the next n samples
+static void IRAM_ATTR render_samples(uint32_t* buf, uint32_t n) {
+    while (n) {
+        if (_train_pos >= _train_len && _pulse_start == UINT32_MAX) {
+            start_train();
+        }
+        uint32_t data = i2s_out_port_data;
+        uint32_t end;
+        bool     pulse = _train_pos >= _pulse_start;
+        if (pulse) {
+            data ^= _train_masks[_train_tick];
+            end = _pulse_start + _pulse_counts;
+        } else {
+            // A pending pulse may start after the nominal end of the train
+            end = _pulse_start == UINT32_MAX ? _train_len : _pulse_start;
+        }
+        uint32_t count = end - _train_pos;
+        if (count > n) {
+            count = n;
+        }
+        _train_pos += count;
+        n -= count;
+        while (count--) {
+            *buf++ = data;
+        }
+        if (pulse && _train_pos == end) {
+            ++_train_tick;
+            find_pulse();
+        }
+    }
+}
+
+static void IRAM_ATTR i2s_dma_isr() {
+    // Clear first, so an end-of-frame during the refill is not lost
+    bool eof = I2S0.int_st.out_eof;
+    i2s_ll_clear_intr_status(&I2S0, I2S_OUT_EOF_INT_CLR);
+    if (eof) {
+        // The finished buffer is not in use by DMA, so its length can change now
+        lldesc_t* finished = (lldesc_t*)I2S0.out_eof_des_addr;
+        uint32_t  n        = _dma_samples;
+        finished->length   = n * sizeof(uint32_t);
+        render_samples((uint32_t*)finished->buf, n);
+    }
+}
+
+static uint32_t init_stream_engine(uint32_t dir_delay_us, uint32_t pulse_us, uint32_t frequency, bool (*callback)(void)) {
+    _pulse_func = callback;
+
+    set_pulse_timing(dir_delay_us, pulse_us, frequency);
+    _dir_delay_counts = (dir_delay_us + i2s_frame_us - 1) / i2s_frame_us;
+    _train_ticks      = IDLE_SAMPLES * _tick_divisor;
+    _tick_carry       = 0;
+    _train_len        = 0;
+    _train_pos        = 0;
+    _pulse_start      = UINT32_MAX;
+    _dma_samples      = DMA_SAMPLES;
+
+    // The buffers start out idle and are linked in a ring
+    for (int i = 0; i < 2; i++) {
+        lldesc_t* desc = (lldesc_t*)heap_caps_calloc(1, sizeof(lldesc_t), MALLOC_CAP_DMA);
+        uint32_t* buf  = (uint32_t*)heap_caps_malloc(DMA_SAMPLES * sizeof(uint32_t), MALLOC_CAP_DMA);
+        for (int j = 0; j < DMA_SAMPLES; j++) {
+            buf[j] = i2s_out_port_data;
+        }
+        desc->size   = DMA_SAMPLES * sizeof(uint32_t);
+        desc->length = DMA_SAMPLES * sizeof(uint32_t);
+        desc->owner  = 1;
+        desc->eof    = 1;
+        desc->buf    = (uint8_t*)buf;
+        _dma_desc[i] = desc;
+    }
+    _dma_desc[0]->qe.stqe_next = _dma_desc[1];
+    _dma_desc[1]->qe.stqe_next = _dma_desc[0];
+
+    i2s_ll_tx_stop(&I2S0);
+    i2s_ll_tx_reset(&I2S0);
+    i2s_ll_tx_reset_dma(&I2S0);
+    i2s_ll_tx_reset_fifo(&I2S0);
+    i2s_ll_enable_dma(&I2S0, true);  // The FIFO now pulls its data from DMA
+
+    esp_intr_alloc_intrstatus(ETS_I2S0_INTR_SOURCE,
+                              ESP_INTR_FLAG_IRAM | ESP_INTR_FLAG_LEVEL3,
+                              (uint32_t)i2s_ll_get_intr_status_reg(&I2S0),
+                              I2S_OUT_EOF_INT_CLR_M,
+                              i2s_dma_isr,
+                              NULL,
+                              NULL);
+    i2s_ll_clear_intr_status(&I2S0, I2S_OUT_EOF_INT_CLR);
+    i2s_ll_enable_intr(&I2S0, I2S_OUT_EOF_INT_ENA, 1);
+
+    i2s_streaming = true;
+    i2s_ll_tx_start_link(&I2S0, (uint32_t)_dma_desc[0]);
+    i2s_ll_tx_start(&I2S0);
+
+    return _pulse_counts * i2s_frame_us;
+}
+
+// The pulse function steps once at the start of the train it is building
+static void IRAM_ATTR stream_start_step() {}
+
+static IRAM_ATTR void stream_set_step_pin(int pin, int level) {
+    uint32_t bit = 1 << pin;
+    if (!!(i2s_out_port_data & bit) != !!level) {
+        _train_masks[0] |= bit;
+    }
+}
+
+static IRAM_ATTR void stream_step_train(int pin, const uint8_t* offsets, int count, uint32_t tick_period) {
+    uint32_t bit = 1 << pin;
+    for (int i = 0; i < count; i++) {
+        _train_masks[offsets[i]] |= bit;
+    }
+    _train_period = tick_period;
+}
+
+// The new direction levels are in i2s_out_port_data from the start of the train, so
+// only the first pulse needs to wait.
+static IRAM_ATTR void stream_finish_dir() {
+    _lead_counts = _dir_delay_counts;
+}
+
+static void IRAM_ATTR stream_set_timer_ticks(uint32_t ticks) {
+    if (ticks) {
+        _train_ticks = ticks;
+    }
+}
+
+// DMA runs all the time, so that writes to non-stepping I2S outputs reach the pins
+static void IRAM_ATTR stream_start_timer() {}
+static void IRAM_ATTR stream_stop_timer() {}
+
+// Both buffers are allocated at full length by init, and only the length that
+// the refill renders and DMA sends changes, so no buffer is drained or reallocated.
+// Each buffer takes the new length at its next refill, so the change is complete
+// within two buffers, while the train being rendered continues across it.
+static uint32_t stream_set_low_latency(int on) {
+    _dma_samples = on ? LOW_LATENCY_SAMPLES : DMA_SAMPLES;
+    return 2 * _dma_samples * i2s_frame_us;
+}
+
+// clang-format off
+step_engine_t i2s_stream_engine = {
+    "I2S_STREAM",
+    init_stream_engine,
+    init_step_pin,
+    set_dir_pin,
+    stream_finish_dir,
+    stream_start_step,
+    stream_set_step_pin,
+    finish_step,
+    start_unstep,
+    finish_unstep,
+    max_pulses_per_sec,
+    stream_set_timer_ticks,
+    stream_start_timer,
+    stream_stop_timer,
+    stream_step_train,
+    NULL,  // wait_dir
+    stream_set_low_latency
+};
+// clang-format on
+REGISTER_STEP_ENGINE(I2S_STREAM, &i2s_stream_engine);
@@ -0,0 +1,89 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Driver/iram_profile.h"
+
+#ifdef IRAM_PROFILE
+
+#    include <esp_attr.h>
+#    include <freertos/FreeRTOS.h>  // xPortInIsrContext()
+#    include <atomic>
+
+// Open addressing by function address.  The hooks run at every function entry,
+// in ISRs too, so they are in IRAM, use only atomics and are not instrumented.
+static const size_t table_bits = 10;
+static const size_t table_size = 1 << table_bits;
+
+static std::atomic<uintptr_t> addresses[table_size];
+static std::atomic<uint32_t>  isr_calls[table_size];
+static std::atomic<uint32_t>  task_calls[table_size];
+static std::atomic<uint32_t>  dropped;
+
+extern "C" {
+void IRAM_ATTR __attribute__((no_instrument_function)) __cyg_profile_func_enter(void* this_fn, void* call_site) {
+    uintptr_t address = uintptr_t(this_fn);
+    size_t    slot    = (address >> 2) & (table_size - 1);
+    for (size_t probe = 0; probe < table_size; ++probe, slot = (slot + 1) & (table_size - 1)) {
+        uintptr_t current = addresses[slot].load(std::memory_order_relaxed);
+        if (current == 0) {
+            if (!addresses[slot].compare_exchange_strong(current, address, std::memory_order_relaxed) && current != address) {
+                continue;  // Another function took the slot
+            }
+        } else if (current != address) {
+            continue;
+        }
+        auto& calls = xPortInIsrContext() ? isr_calls[slot] : task_calls[slot];
+        calls.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void IRAM_ATTR __attribute__((no_instrument_function)) __cyg_profile_func_exit(void* this_fn, void* call_site) {}
+}
+
+bool iram_profile_enabled() {
+    return true;
+}
+
+size_t iram_profile_entries(iram_profile_entry_t* entries, size_t max) {
+    size_t n = 0;
+    for (size_t slot = 0; slot < table_size && n < max; ++slot) {
+        uintptr_t address = addresses[slot].load(std::memory_order_relaxed);
+        if (address) {
+            entries[n++] = { address, isr_calls[slot].load(std::memory_order_relaxed), task_calls[slot].load(std::memory_order_relaxed) };
+        }
+    }
+    return n;
+}
+
+uint32_t iram_profile_dropped() {
+    return dropped;
+}
+
+// Keeps the addresses, so that a function that is running cannot lose its slot
+void iram_profile_reset() {
+    for (size_t slot = 0; slot < table_size; ++slot) {
+        isr_calls[slot]  = 0;
+        task_calls[slot] = 0;
+    }
+    dropped = 0;
+}
+
+#else
+
+bool iram_profile_enabled() {
+    return false;
+}
+
+size_t iram_profile_entries(iram_profile_entry_t* entries, size_t max) {
+    return 0;
+}
+
+uint32_t iram_profile_dropped() {
+    return 0;
+}
+
+void iram_profile_reset() {}
+
+#endif
@@ -0,0 +1,201 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Driver/pc_profile.h"
+
+#include <sdkconfig.h>
+
+#ifdef CONFIG_IDF_TARGET_ARCH_XTENSA
+
+#    include "hal/timer_ll.h"
+#    include "esp_intr_alloc.h"
+#    include <esp_ipc.h>
+#    include <esp_attr.h>
+#    include <freertos/FreeRTOS.h>  // portNUM_PROCESSORS
+#    include <new>  // std::nothrow
+
+// Timer group 1 is unused otherwise.  Core n samples with its timer n.
+static const uint32_t fTimers = 80000000;  // The frequency of ESP32 timers
+static const uint32_t fSample = 1000000;   // The frequency the timers count at
+
+static pc_sample_t*      rings[portNUM_PROCESSORS];
+static size_t            ring_size    = 0;
+static volatile uint32_t taken[portNUM_PROCESSORS];
+static uint32_t          jitter[portNUM_PROCESSORS];
+static intr_handle_t     handles[portNUM_PROCESSORS];
+static uint32_t          period_ticks = 0;
+static bool              running      = false;
+
+static timer_idx_t timer_of(int core) {
+    return core ? TIMER_1 : TIMER_0;
+}
+
+static void IRAM_ATTR sample_isr(void* arg) {
+    int         core  = int(uintptr_t(arg));
+    timer_idx_t timer = timer_of(core);
+    timer_ll_clear_intr_status(&TIMERG1, timer);
+
+    // The interrupt is level 3, so EPC3 and EPS3 hold the program counter and the
+    // processor state of the interrupted code.  Nothing at a lower level can change them.
+    uint32_t pc, ps;
+    asm volatile("rsr %0, epc3" : "=a"(pc));
+    asm volatile("rsr %0, eps3" : "=a"(ps));
+
+    uint32_t n                 = taken[core];
+    rings[core][n % ring_size] = { pc, (ps & 0xf) != 0 };
+    taken[core]                = n + 1;
+
+    // A few microseconds of pseudo-random jitter keeps the samples from locking to
+    // periodic work such as the step timer
+    uint32_t j   = jitter[core];
+    j            = j * 1103515245u + 12345u;
+    jitter[core] = j;
+    timer_ll_set_alarm_value(&TIMERG1, timer, period_ticks + ((j >> 16) & 7));
+    timer_ll_set_alarm_enable(&TIMERG1, timer, true);
+}
+
+// Run on the core that the interrupt is for, since that is the one that takes it
+static void start_on_core(void* arg) {
+    int         core   = int(uintptr_t(arg));
+    timer_idx_t timer  = timer_of(core);
+    auto&       groups = timer_group_periph_signals.groups[TIMER_GROUP_1];
+
+    timer_ll_intr_disable(&TIMERG1, timer);
+    timer_ll_set_counter_enable(&TIMERG1, timer, false);
+    timer_ll_set_divider(&TIMERG1, timer, fTimers / fSample);
+    timer_ll_set_counter_increase(&TIMERG1, timer, true);
+    timer_ll_set_counter_value(&TIMERG1, timer, 0);
+    timer_ll_set_alarm_value(&TIMERG1, timer, period_ticks);
+    timer_ll_set_auto_reload(&TIMERG1, timer, true);
+    timer_ll_clear_intr_status(&TIMERG1, timer);
+
+    esp_intr_alloc_intrstatus(core ? groups.t1_irq_id : groups.t0_irq_id,
+                              ESP_INTR_FLAG_IRAM | ESP_INTR_FLAG_LEVEL3,
+                              timer_ll_get_intr_status_reg(&TIMERG1),
+                              1 << timer,
+                              sample_isr,
+                              arg,
+                              &handles[core]);
+
+    timer_ll_intr_enable(&TIMERG1, timer);
+    timer_ll_set_alarm_enable(&TIMERG1, timer, true);
+    timer_ll_set_counter_enable(&TIMERG1, timer, true);
+}
+
+static void stop_on_core(void* arg) {
+    int         core  = int(uintptr_t(arg));
+    timer_idx_t timer = timer_of(core);
+
+    timer_ll_set_counter_enable(&TIMERG1, timer, false);
+    timer_ll_set_alarm_enable(&TIMERG1, timer, false);
+    timer_ll_intr_disable(&TIMERG1, timer);
+    if (handles[core]) {
+        esp_intr_free(handles[core]);
+        handles[core] = nullptr;
+    }
+}
+
+bool pc_profile_supported() {
+    return true;
+}
+
+bool pc_profile_start(uint32_t hz, size_t samples) {
+    pc_profile_stop();
+    if (hz == 0 || samples == 0) {
+        return false;
+    }
+    if (samples != ring_size) {
+        for (int core = 0; core < portNUM_PROCESSORS; core++) {
+            delete[] rings[core];
+            rings[core] = nullptr;
+        }
+        ring_size = 0;
+        for (int core = 0; core < portNUM_PROCESSORS; core++) {
+            rings[core] = new (std::nothrow) pc_sample_t[samples];
+            if (!rings[core]) {
+                return false;
+            }
+        }
+        ring_size = samples;
+    }
+    period_ticks = fSample / hz;
+    if (period_ticks < 20) {
+        period_ticks = 20;  // At most 50 kHz
+    }
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        taken[core]  = 0;
+        jitter[core] = core + 1;
+        esp_ipc_call_blocking(core, start_on_core, (void*)uintptr_t(core));
+    }
+    running = true;
+    return true;
+}
+
+void pc_profile_stop() {
+    if (!running) {
+        return;
+    }
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        esp_ipc_call_blocking(core, stop_on_core, (void*)uintptr_t(core));
+    }
+    running = false;
+}
+
+bool pc_profile_running() {
+    return running;
+}
+
+int pc_profile_cores() {
+    return portNUM_PROCESSORS;
+}
+
+uint32_t pc_profile_taken(int core) {
+    return core < portNUM_PROCESSORS ? taken[core] : 0;
+}
+
+size_t pc_profile_samples(int core, pc_sample_t* samples, size_t max) {
+    if (core >= portNUM_PROCESSORS || !rings[core]) {
+        return 0;
+    }
+    uint32_t n     = taken[core];
+    size_t   kept  = n < ring_size ? n : ring_size;
+    size_t   first = n - kept;  // The oldest sample that the ring still holds
+    if (kept > max) {
+        first += kept - max;
+        kept = max;
+    }
+    for (size_t i = 0; i < kept; i++) {
+        samples[i] = rings[core][(first + i) % ring_size];
+    }
+    return kept;
+}
+
+#else
+
+bool pc_profile_supported() {
+    return false;
+}
+
+bool pc_profile_start(uint32_t hz, size_t samples) {
+    return false;
+}
+
+void pc_profile_stop() {}
+
+bool pc_profile_running() {
+    return false;
+}
+
+int pc_profile_cores() {
+    return 0;
+}
+
+uint32_t pc_profile_taken(int core) {
+    return 0;
+}
+
+size_t pc_profile_samples(int core, pc_sample_t* samples, size_t max) {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,18 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Driver/psram.h"
+
+#include <esp_heap_caps.h>
+
+bool psram_available() {
+    return heap_caps_get_total_size(MALLOC_CAP_SPIRAM) != 0;
+}
+
+void* psram_malloc(size_t size) {
+    return heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+}
+
+size_t psram_free_size() {
+    return heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "driver/pcnt.h"
+#include "soc/pcnt_struct.h"
+#include <esp_attr.h>  // IRAM_ATTR
+
+#include "Driver/pulse_counter.h"
+#include "src/Logging.h"
+
+static bool pulse_counter_channel(int unit, pcnt_channel_t channel, pinnum_t pin, int16_t limit) {
+    pcnt_config_t conf = {
+        .pulse_gpio_num = pin,
+        .ctrl_gpio_num  = PCNT_PIN_NOT_USED,
+        .lctrl_mode     = PCNT_MODE_KEEP,
+        .hctrl_mode     = PCNT_MODE_KEEP,
+        .pos_mode       = PCNT_COUNT_INC,
+        .neg_mode       = PCNT_COUNT_INC,
+        .counter_h_lim  = limit,
+        .counter_l_lim  = 0,
+        .unit           = (pcnt_unit_t)unit,
+        .channel        = channel,
+    };
+    return pcnt_unit_config(&conf) == ESP_OK;
+}
+
+// cppcheck-suppress unusedFunction
+bool pulse_counter_init(int unit, pinnum_t a_pin, pinnum_t b_pin, int16_t limit) {
+    if (!pulse_counter_channel(unit, PCNT_CHANNEL_0, a_pin, limit)) {
+        log_error("pcnt_unit_config failed");
+        return false;
+    }
+    if (b_pin != 255 && !pulse_counter_channel(unit, PCNT_CHANNEL_1, b_pin, limit)) {
+        log_error("pcnt_unit_config failed");
+        return false;
+    }
+    // Ignore glitches shorter than 1 us (80 APB clocks)
+    pcnt_set_filter_value((pcnt_unit_t)unit, 80);
+    pcnt_filter_enable((pcnt_unit_t)unit);
+
+    pcnt_counter_pause((pcnt_unit_t)unit);
+    pcnt_counter_clear((pcnt_unit_t)unit);
+    pcnt_counter_resume((pcnt_unit_t)unit);
+    return true;
+}
+
+// Each channel counts the edges of one signal, in the direction given by the level of the other
+static bool quadrature_channel(int unit, pcnt_channel_t channel, pinnum_t pulse_pin, pinnum_t ctrl_pin, bool lead, int16_t limit) {
+    pcnt_config_t conf = {
+        .pulse_gpio_num = pulse_pin,
+        .ctrl_gpio_num  = ctrl_pin,
+        .lctrl_mode     = PCNT_MODE_REVERSE,
+        .hctrl_mode     = PCNT_MODE_KEEP,
+        .pos_mode       = lead ? PCNT_COUNT_DEC : PCNT_COUNT_INC,
+        .neg_mode       = lead ? PCNT_COUNT_INC : PCNT_COUNT_DEC,
+        .counter_h_lim  = limit,
+        .counter_l_lim  = int16_t(-limit),
+        .unit           = (pcnt_unit_t)unit,
+        .channel        = channel,
+    };
+    return pcnt_unit_config(&conf) == ESP_OK;
+}
+
+// cppcheck-suppress unusedFunction
+bool pulse_counter_init_quadrature(int unit, pinnum_t a_pin, pinnum_t b_pin, int16_t limit) {
+    if (!quadrature_channel(unit, PCNT_CHANNEL_0, a_pin, b_pin, true, limit) ||
+        !quadrature_channel(unit, PCNT_CHANNEL_1, b_pin, a_pin, false, limit)) {
+        log_error("pcnt_unit_config failed");
+        return false;
+    }
+    pcnt_set_filter_value((pcnt_unit_t)unit, 80);
+    pcnt_filter_enable((pcnt_unit_t)unit);
+
+    pcnt_counter_pause((pcnt_unit_t)unit);
+    pcnt_counter_clear((pcnt_unit_t)unit);
+    pcnt_counter_resume((pcnt_unit_t)unit);
+    return true;
+}
+
+// The driver's pcnt_get_counter_value() is not in IRAM, so read the register directly
+int16_t IRAM_ATTR pulse_counter_read(int unit) {
+    return (int16_t)PCNT.cnt_unit[unit].cnt_val;
+}
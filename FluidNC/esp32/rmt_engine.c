@@ -14,6 +14,9 @@
 static uint32_t _pulse_delay_us;
 static uint32_t _dir_delay_us;
 
+// Idle level of each channel, for writing pulse trains
+static uint8_t _idle_level[RMT_CHANNEL_MAX];
+
 static uint32_t init_engine(uint32_t dir_delay_us, uint32_t pulse_delay_us, uint32_t frequency, bool (*callback)(void)) {
     stepTimerInit(frequency, callback);
     _dir_delay_us   = dir_delay_us;
@@ -62,6 +65,7 @@ static int init_step_pin(int step_pin, int step_inverted) {
     rmtItem[0].level1 = !rmtConfig.tx_config.idle_level;
     rmt_config(&rmtConfig);
     rmt_fill_tx_items(rmtConfig.channel, &rmtItem[0], rmtConfig.mem_block_num, 0);
+    _idle_level[rmt_chan_num] = rmtConfig.tx_config.idle_level;
     return (int)rmt_chan_num;
 }
 
@@ -76,9 +80,8 @@ static IRAM_ATTR void finish_dir() {}
 // No need for any common setup before setting step pins
 static IRAM_ATTR void start_step() {}
 
-// Restart the RMT which has already been configured
-// for the desired pulse length, polarity, and direction delay
-static IRAM_ATTR void set_step_pin(int pin, int level) {
+// Restart transmission from the start of the channel memory
+static inline IRAM_ATTR void start_channel(int pin) {
 #ifdef CONFIG_IDF_TARGET_ESP32
     RMT.conf_ch[pin].conf1.mem_rd_rst = 1;
     RMT.conf_ch[pin].conf1.mem_rd_rst = 0;
@@ -91,6 +94,12 @@ static IRAM_ATTR void set_step_pin(int pin, int level) {
 #endif
 }
 
+// Restart the RMT which has already been configured
+// for the desired pulse length, polarity, and direction delay
+static IRAM_ATTR void set_step_pin(int pin, int level) {
+    start_channel(pin);
+}
+
 // This is a noop because the RMT channels do everything
 static IRAM_ATTR void finish_step() {}
 
@@ -127,6 +136,35 @@ static void IRAM_ATTR stop_timer() {
     stepTimerStop();
 }
 
+// Write a whole train of pulses into the channel memory, one item per pulse: the idle time
+// before the pulse, then the pulse.  A zero item ends the train.  The RMT clock runs at 4 MHz,
+// a fifth of the 20 MHz stepping timer.  A train of STEP_TRAIN_MAX_TICKS pulses plus the end
+// item fills exactly the channel's own 64-item memory block, and STEP_TRAIN_MAX_US keeps every
+// idle time within the 15-bit item durations.
+static void IRAM_ATTR step_train(int pin, const uint8_t* offsets, int count, uint32_t tick_period) {
+    volatile rmt_item32_t* item  = RMTMEM.chan[pin].data32;
+    uint32_t               idle  = _idle_level[pin];
+    uint32_t               pulse = _pulse_delay_us ? _pulse_delay_us * 4 : 1;
+    uint32_t               lead  = _dir_delay_us ? _dir_delay_us * 4 : 1;
+    uint32_t               end   = 0;  // End of the previous pulse in RMT ticks
+    for (int i = 0; i < count; i++) {
+        uint32_t start = offsets[i] * tick_period / 5;
+        uint32_t min   = i ? end + 1 : lead;
+        if (start < min) {
+            start = min;
+        }
+        rmt_item32_t next;
+        next.level0    = idle;
+        next.duration0 = start - end;
+        next.level1    = !idle;
+        next.duration1 = pulse;
+        item[i].val    = next.val;
+        end            = start + pulse;
+    }
+    item[count].val = 0;
+    start_channel(pin);
+}
+
 // clang-format off
 static step_engine_t engine = {
     "RMT",
@@ -142,7 +180,8 @@ static step_engine_t engine = {
     max_pulses_per_sec,
     set_timer_ticks,
     start_timer,
-    stop_timer
+    stop_timer,
+    step_train
 };
 
 REGISTER_STEP_ENGINE(RMT, &engine);
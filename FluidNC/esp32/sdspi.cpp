@@ -15,8 +15,12 @@
 #include "esp_error.hpp"
 
 #include "Driver/sdspi.h"
+#include "Driver/spi.h"  // spi_bus_lock()
 #include "src/Config.h"
 
+#include <esp_heap_caps.h>
+#include <algorithm>
+
 #define CHECK_EXECUTE_RESULT(err, str)                                                                                                     \
     do {                                                                                                                                   \
         if ((err) != ESP_OK) {                                                                                                             \
@@ -25,10 +29,112 @@
         }                                                                                                                                  \
     } while (0)
 
+sdmmc_host_t  host_config = SDSPI_HOST_DEFAULT();
+sdmmc_card_t* card        = NULL;
+const char*   base_path   = "/sd";
+
+static uint32_t min_freq_khz;
+static BYTE     card_pdrv = FF_DRV_NOT_USED;
+
+// Sectors per transfer between releases of the SPI bus.  8 sectors take about 2 ms at
+// 20 MHz, which bounds the wait of a TMC register access behind a long read, while
+// the multi-block transfers stay long enough to keep most of the streaming rate.
+static const UINT sd_burst_sectors = 8;
+
+// Transfers that fail, typically with CRC errors from a clock that is too fast for
+// the wiring, are retried at successively halved clocks down to the minimum.  The
+// lowered clock is kept for later mounts.
+static bool lower_card_clock() {
+    uint32_t freq_khz = card->max_freq_khz;
+    if (freq_khz <= min_freq_khz) {
+        return false;
+    }
+    freq_khz = std::max(freq_khz / 2, min_freq_khz);
+    if (host_config.set_card_clk(host_config.slot, freq_khz) != ESP_OK) {
+        return false;
+    }
+    card->max_freq_khz       = freq_khz;
+    host_config.max_freq_khz = freq_khz;
+    log_warn("SD transfer failed, lowering clock to " << freq_khz << " kHz");
+    return true;
+}
+
+// This replaces the disk I/O layer that ff_diskio_register_sdmmc() installs, adding
+// the clock fallback.  FATFS passes whole-sector runs of a large read directly to
+// disk_read(), which sdmmc_read_sectors() turns into one multi-block transfer when
+// the buffer is DMA capable.
+static DSTATUS sd_disk_initialize(BYTE pdrv) {
+    return sdmmc_get_status(card) == ESP_OK ? 0 : STA_NOINIT;
+}
+
+static DSTATUS sd_disk_status(BYTE pdrv) {
+    return 0;
+}
+
+static DRESULT sd_disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count) {
+    while (count) {
+        UINT      n = std::min(count, sd_burst_sectors);
+        esp_err_t err;
+        spi_bus_lock(false);
+        while ((err = sdmmc_read_sectors(card, buff, sector, n)) != ESP_OK) {
+            if (!lower_card_clock()) {
+                spi_bus_unlock();
+                log_debug("SD read of " << n << " sectors at " << sector << " failed code " << to_hex(err));
+                return RES_ERROR;
+            }
+        }
+        spi_bus_unlock();
+        buff += n * card->csd.sector_size;
+        sector += n;
+        count -= n;
+    }
+    return RES_OK;
+}
+
+static DRESULT sd_disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count) {
+    while (count) {
+        UINT      n = std::min(count, sd_burst_sectors);
+        esp_err_t err;
+        spi_bus_lock(false);
+        while ((err = sdmmc_write_sectors(card, buff, sector, n)) != ESP_OK) {
+            if (!lower_card_clock()) {
+                spi_bus_unlock();
+                log_debug("SD write of " << n << " sectors at " << sector << " failed code " << to_hex(err));
+                return RES_ERROR;
+            }
+        }
+        spi_bus_unlock();
+        buff += n * card->csd.sector_size;
+        sector += n;
+        count -= n;
+    }
+    return RES_OK;
+}
+
+static DRESULT sd_disk_ioctl(BYTE pdrv, BYTE cmd, void* buff) {
+    switch (cmd) {
+        case CTRL_SYNC:
+            return RES_OK;
+        case GET_SECTOR_COUNT:
+            *((DWORD*)buff) = card->csd.capacity;
+            return RES_OK;
+        case GET_SECTOR_SIZE:
+            *((WORD*)buff) = card->csd.sector_size;
+            return RES_OK;
+        default:
+            return RES_ERROR;
+    }
+}
+
+static const ff_diskio_impl_t sd_diskio = {
+    sd_disk_initialize, sd_disk_status, sd_disk_read, sd_disk_write, sd_disk_ioctl,
+};
+
 static esp_err_t mount_to_vfs_fat(int max_files, sdmmc_card_t* card, uint8_t pdrv, const char* base_path) {
     FATFS*    fs = NULL;
     esp_err_t err;
-    ff_diskio_register_sdmmc(pdrv, card);
+    ff_diskio_register(pdrv, &sd_diskio);
+    card_pdrv = pdrv;
 
     //    ESP_LOGD(TAG, "using pdrv=%i", pdrv);
     // Drive names are "0:", "1:", etc.
@@ -60,12 +166,10 @@ fail:
     }
     esp_vfs_fat_unregister_path(base_path);
     ff_diskio_unregister(pdrv);
+    card_pdrv = FF_DRV_NOT_USED;
     return err;
 }
 
-sdmmc_host_t  host_config = SDSPI_HOST_DEFAULT();
-sdmmc_card_t* card        = NULL;
-const char*   base_path   = "/sd";
 
 static void call_host_deinit(const sdmmc_host_t* host_config) {
     if (host_config->flags & SDMMC_HOST_FLAG_DEINIT_ARG) {
@@ -76,7 +180,7 @@ static void call_host_deinit(const sdmmc_host_t* host_config) {
 }
 
 // cppcheck-suppress unusedFunction
-bool sd_init_slot(uint32_t freq_hz, int cs_pin, int cd_pin, int wp_pin) {
+bool sd_init_slot(uint32_t freq_hz, uint32_t min_freq_hz, int cs_pin, int cd_pin, int wp_pin) {
     esp_err_t err;
 
     esp_log_level_set("sdmmc_sd", ESP_LOG_NONE);
@@ -91,6 +195,7 @@ bool sd_init_slot(uint32_t freq_hz, int cs_pin, int cd_pin, int wp_pin) {
     sdspi_device_config_t slot_config;
 
     host_config.max_freq_khz = freq_hz / 1000;
+    min_freq_khz             = std::min(min_freq_hz, freq_hz) / 1000;
 
     err = host_config.init();
     CHECK_EXECUTE_RESULT(err, "host init failed");
@@ -148,13 +253,22 @@ std::error_code sd_mount(int max_files) {
     // /mount_prepare_mem()
 
     // probe and initialize card
+    spi_bus_lock(false);
     err = sdmmc_card_init(&host_config, card);
     if (err != ESP_OK) {
         // Some cards fail the first time after they are inserted, but then succeed,
         // so we retry this step once.
         err = sdmmc_card_init(&host_config, card);
     }
+    while (err != ESP_OK && host_config.max_freq_khz > int(min_freq_khz)) {
+        // The card may not work at the configured clock
+        host_config.max_freq_khz = std::max(host_config.max_freq_khz / 2, int(min_freq_khz));
+        log_debug("Retrying SD card init at " << host_config.max_freq_khz << " kHz");
+        err = sdmmc_card_init(&host_config, card);
+    }
+    spi_bus_unlock();
     CHECK_EXECUTE_RESULT(err, "sdmmc_card_init failed");
+    log_verbose("SD card clock " << card->max_freq_khz << " kHz");
 
     err = mount_to_vfs_fat(max_files, card, pdrv, base_path);
     CHECK_EXECUTE_RESULT(err, "mount_to_vfs failed");
@@ -168,10 +282,11 @@ cleanup:
 
 // cppcheck-suppress unusedFunction
 void sd_unmount() {
-    BYTE pdrv = ff_diskio_get_pdrv_card(card);
-    if (pdrv == 0xff) {
+    BYTE pdrv = card_pdrv;
+    if (pdrv == FF_DRV_NOT_USED) {
         return;
     }
+    card_pdrv = FF_DRV_NOT_USED;
 
     // unmount
     const char drv[3] = { (char)('0' + pdrv), ':', 0 };
@@ -186,6 +301,16 @@ void sd_unmount() {
     card = NULL;
 }
 
+// cppcheck-suppress unusedFunction
+uint32_t sd_card_serial() {
+    return card ? card->cid.serial : 0;
+}
+
+// cppcheck-suppress unusedFunction
+void* sd_dma_malloc(size_t size) {
+    return heap_caps_malloc(size, MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+}
+
 // cppcheck-suppress unusedFunction
 void sd_deinit_slot() {
     sdspi_host_remove_device(host_config.slot);
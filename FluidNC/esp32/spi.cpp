@@ -8,11 +8,16 @@
 #include "src/Config.h"
 
 #include <sdkconfig.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 
 #ifdef CONFIG_IDF_TARGET_ESP32S3
 #    define HSPI_HOST SPI2_HOST
 #endif
 
+static SemaphoreHandle_t bus_mutex      = nullptr;
+static volatile int      urgent_waiters = 0;  // Urgent lockers that are waiting for the bus
+
 // cppcheck-suppress unusedFunction
 bool spi_init_bus(pinnum_t sck_pin, pinnum_t miso_pin, pinnum_t mosi_pin, bool dma, int8_t sck_drive_strength, int8_t mosi_drive_strength) {
     // Start the SPI bus with the pins defined here.  Once it has been started,
@@ -31,6 +36,9 @@ bool spi_init_bus(pinnum_t sck_pin, pinnum_t miso_pin, pinnum_t mosi_pin, bool d
     // Depends on the chip variant
     bool ok = !spi_bus_initialize(HSPI_HOST, &bus_cfg, dma ? SPI_DMA_CH_AUTO : SPI_DMA_DISABLED);
     if (ok) {
+        if (!bus_mutex) {
+            bus_mutex = xSemaphoreCreateRecursiveMutex();
+        }
         if (sck_drive_strength != -1) {
             gpio_drive_strength(sck_pin, sck_drive_strength);
         }
@@ -46,3 +54,28 @@ void spi_deinit_bus() {
     esp_err_t err = spi_bus_free(HSPI_HOST);
     log_debug("deinit spi " << int(err));
 }
+
+void spi_bus_lock(bool urgent) {
+    if (!bus_mutex) {
+        return;
+    }
+    if (urgent) {
+        __atomic_add_fetch(&urgent_waiters, 1, __ATOMIC_RELAXED);
+        xSemaphoreTakeRecursive(bus_mutex, portMAX_DELAY);
+        __atomic_sub_fetch(&urgent_waiters, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    // A nested lock must not wait, since the waiters are waiting for this task
+    if (xSemaphoreGetMutexHolder(bus_mutex) != xTaskGetCurrentTaskHandle()) {
+        while (urgent_waiters) {
+            vTaskDelay(1);
+        }
+    }
+    xSemaphoreTakeRecursive(bus_mutex, portMAX_DELAY);
+}
+
+void spi_bus_unlock() {
+    if (bus_mutex) {
+        xSemaphoreGiveRecursive(bus_mutex);
+    }
+}
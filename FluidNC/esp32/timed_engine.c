@@ -1,7 +1,7 @@
 // Copyright (c) 2024 -  Mitch Bradley
 // Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
 
-// Stepping engine that uses direct GPIO accesses timed by spin loops.
+// Stepping engine that uses direct GPIO register writes timed by spin loops.
 
 #include "Driver/step_engine.h"
 #include "Driver/fluidnc_gpio.h"
@@ -9,6 +9,7 @@
 #include "Driver/StepTimer.h"
 #include <esp32-hal-gpio.h>
 #include <esp_attr.h>  // IRAM_ATTR
+#include <soc/gpio_struct.h>
 
 static uint32_t _pulse_delay_us;
 static uint32_t _dir_delay_us;
@@ -20,37 +21,97 @@ static uint32_t init_engine(uint32_t dir_delay_us, uint32_t pulse_delay_us, uint
     return _pulse_delay_us;
 }
 
+// Pin changes are collected in set and clear masks for each of the two GPIO output
+// registers, then committed together, so the pulses of all motors start at the same
+// time with one register write.
+typedef struct {
+    uint32_t set;
+    uint32_t clear;
+    uint32_t set1;  // GPIOs 32 and up
+    uint32_t clear1;
+} gpio_masks_t;
+
+static gpio_masks_t _pending;  // Changes not yet committed
+static gpio_masks_t _unstep;   // Returns every step pin to its idle level
+
+static inline void IRAM_ATTR add_pin(gpio_masks_t* masks, int pin, int level) {
+    if (pin < 32) {
+        uint32_t bit = 1 << pin;
+        if (level) {
+            masks->set |= bit;
+        } else {
+            masks->clear |= bit;
+        }
+    } else {
+        uint32_t bit = 1 << (pin - 32);
+        if (level) {
+            masks->set1 |= bit;
+        } else {
+            masks->clear1 |= bit;
+        }
+    }
+}
+
+static inline void IRAM_ATTR commit(gpio_masks_t* masks) {
+    GPIO.out_w1ts      = masks->set;
+    GPIO.out_w1tc      = masks->clear;
+    GPIO.out1_w1ts.val = masks->set1;
+    GPIO.out1_w1tc.val = masks->clear1;
+}
+
+static inline void IRAM_ATTR clear_pending() {
+    _pending.set    = 0;
+    _pending.clear  = 0;
+    _pending.set1   = 0;
+    _pending.clear1 = 0;
+}
+
+// The idle level of an inverted step pin is high
 static int init_step_pin(int step_pin, int step_invert) {
+    add_pin(&_unstep, step_pin, step_invert);
     return step_pin;
 }
 
 static int _stepPulseEndTime;
 
 static void IRAM_ATTR set_pin(int pin, int level) {
-    gpio_write(pin, level);
+    add_pin(&_pending, pin, level);
 }
 
+static int _dirEndTime;
+
 static void IRAM_ATTR finish_dir() {
-    delay_us(_dir_delay_us);
+    commit(&_pending);
+    clear_pending();
+    _dirEndTime = usToEndTicks(_dir_delay_us);
 }
 
-static void IRAM_ATTR start_step() {}
+static void IRAM_ATTR wait_dir() {
+    spinUntil(_dirEndTime);
+}
+
+static void IRAM_ATTR start_step() {
+    clear_pending();
+}
 
 // Instead of waiting here for the step end time, we mark when the
 // step pulse should end, then return.  The stepper code can then do
 // some work that is overlapped with the pulse time.  The spin loop
 // will happen in start_unstep()
 static void IRAM_ATTR finish_step() {
+    commit(&_pending);
     _stepPulseEndTime = usToEndTicks(_pulse_delay_us);
 }
 
+// All step pins go idle with the precomputed masks, so the return value of 1 tells
+// Stepping.cpp to skip setting the pins one at a time.
 static int IRAM_ATTR start_unstep() {
     spinUntil(_stepPulseEndTime);
-    return 0;
+    commit(&_unstep);
+    return 1;
 }
 
-// This is a noop because each gpio_write() takes effect immediately,
-// so there is no need to commit multiple GPIO changes.
+// Not called since start_unstep() returns 1
 static void IRAM_ATTR finish_unstep() {}
 
 static uint32_t max_pulses_per_sec() {
@@ -84,7 +145,9 @@ static step_engine_t engine = {
     max_pulses_per_sec,
     set_timer_ticks,
     start_timer,
-    stop_timer
+    stop_timer,
+    NULL,  // step_train
+    wait_dir
 };
 
 REGISTER_STEP_ENGINE(Timed, &engine);
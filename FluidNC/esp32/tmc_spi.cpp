@@ -1,9 +1,9 @@
 // Copyright (c) 2022 Mitch Bradley
 // Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
 
-// There is no .h file to define the interface to this code.
-// It works by replacing weak methods in the TMCStepper library,
-// namely TMCStepper::read() and TMCStepper::write()
+// This code works by replacing weak methods in the TMCStepper library,
+// namely TMCStepper::read() and TMCStepper::write().  The whole-chain
+// functions declared in Driver/tmc_spi.h are the only other interface.
 
 // It uses low-level direct access to the SPI hardware instead of
 // trying to use the ESP-IDF spi_master() driver.  The reason for this
@@ -23,9 +23,10 @@
 // the compiler generates very compact code).  There are two downsides
 // to this method, neither of which really matter in our situation.
 // The first is that there is no locking to prevent this code from
-// interfering with SD card access that is already in progress.  That
-// is not a problem because TMC device access and SD Card access never
-// happen simultaneously.  The second is that the code polls for completion
+// interfering with SD card access that is already in progress, so both
+// sides take the bus lock from Driver/spi.h around each transaction, and
+// SD transfers are split into bursts that a TMC access can get between.
+// The second is that the code polls for completion
 // without letting other tasks run.  That is not a problem because TMC
 // register access was effectively a blocking operation anyway, so it
 // doesn't matter whether it blocks at a low or high level of abstraction.
@@ -37,13 +38,144 @@
 
 #include "src/Config.h"
 #include "esp32/tmc_spi_support.h"
+#include "Driver/tmc_spi.h"
+#include "Driver/spi.h"  // spi_bus_lock()
 #include <TMCStepper.h>  // https://github.com/teemuatlut/TMCStepper
+#include <algorithm>
+#include <vector>
+
+// Holds the SPI bus, ahead of SD transfers, for the life of a register access
+struct BusLock {
+    BusLock() { spi_bus_lock(true); }
+    ~BusLock() { spi_bus_unlock(); }
+};
+
+static const size_t packetLen     = 5;
+static const size_t maxBatchChain = 32;  // Chips per chain that a batch can queue for
+
+// A queued write of one register to some of the chips on the chain
+struct BatchEntry {
+    uint8_t  reg;
+    uint32_t chips;  // Bit n is set for link index n + 1
+    uint32_t data[maxBatchChain];
+};
+
+static bool                    batching    = false;
+static TMC2130Stepper*         batch_chain = nullptr;  // For the chain's CS pin
+static int                     batch_len   = 0;        // Longest link index seen
+static std::vector<BatchEntry> batch;
+
+static void put_packet(uint8_t* out, uint8_t cmd, uint32_t data) {
+    out[0] = cmd;
+    out[1] = data >> 24;
+    out[2] = data >> 16;
+    out[3] = data >> 8;
+    out[4] = data >> 0;
+}
+
+// Sends each queued register to the whole chain in one frame.  The packet for
+// the chip with link index k is at (length - k) * packetLen in the frame, since the
+// first packet sent is pushed farthest along the chain.  Chips without a write
+// for the register get a read of GCONF, which has no side effects.
+static void batch_flush() {
+    if (batch.empty()) {
+        return;
+    }
+    size_t  total_bytes = batch_len * packetLen;
+    uint8_t out[total_bytes];
+
+    BusLock lock;
+    tmc_spi_bus_setup();
+    for (auto& entry : batch) {
+        for (int k = 1; k <= batch_len; k++) {
+            uint8_t* packet = &out[(batch_len - k) * packetLen];
+            if (entry.chips & (1 << (k - 1))) {
+                put_packet(packet, entry.reg | 0x80, entry.data[k - 1]);
+            } else {
+                put_packet(packet, 0x00, 0);
+            }
+        }
+        batch_chain->switchCSpin(0);
+        tmc_spi_transfer_data(out, total_bytes * 8, NULL, 0);
+        batch_chain->switchCSpin(1);
+    }
+    batch.clear();
+}
+
+void tmc_spi_begin_batch() {
+    batching = true;
+}
+
+void tmc_spi_end_batch() {
+    batch_flush();
+    batching    = false;
+    batch_chain = nullptr;
+    batch_len   = 0;
+}
+
+void tmc_spi_read_chain(TMC2130Stepper& stepper, uint8_t reg, uint32_t* data, size_t n) {
+    size_t  total_bytes = n * packetLen;
+    uint8_t out[total_bytes];
+    uint8_t in[total_bytes];
+
+    for (size_t i = 0; i < n; i++) {
+        put_packet(&out[i * packetLen], reg, 0);
+    }
+
+    BusLock lock;
+    tmc_spi_bus_setup();
+
+    // The first frame latches the register on every chip and the second
+    // shifts the values out, the last chip's first
+    stepper.switchCSpin(0);
+    tmc_spi_transfer_data(out, total_bytes * 8, NULL, 0);
+    stepper.switchCSpin(1);
+
+    stepper.switchCSpin(0);
+    tmc_spi_transfer_data(out, total_bytes * 8, in, total_bytes * 8);
+    stepper.switchCSpin(1);
+
+    for (size_t k = 1; k <= n; k++) {
+        uint8_t* packet = &in[(n - k) * packetLen];
+        data[k - 1]     = (uint32_t(packet[1]) << 24) | (uint32_t(packet[2]) << 16) | (uint32_t(packet[3]) << 8) | packet[4];
+    }
+}
+
+// True if a write of reg to the chip with link index is queued
+static bool batch_pending(uint8_t reg, int index) {
+    for (auto& entry : batch) {
+        if (entry.reg == reg && (entry.chips & (1 << (index - 1)))) {
+            return true;
+        }
+    }
+    return false;
+}
 
 // Replace the library's weak definition of TMC2130Stepper::write()
 // This is executed in the object context so it has access to class
 // data such as the CS pin that switchCSpin() uses
 void TMC2130Stepper::write(uint8_t reg, uint32_t data) {
     log_verbose("TMC reg " << to_hex(reg) << " write " << to_hex(data));
+    if (batching && link_index > 0 && size_t(link_index) <= maxBatchChain) {
+        // A later write of the same register replaces the queued one
+        BatchEntry* entry = nullptr;
+        for (auto& e : batch) {
+            if (e.reg == reg) {
+                entry = &e;
+                break;
+            }
+        }
+        if (!entry) {
+            batch.push_back({ reg, 0, { 0 } });
+            entry = &batch.back();
+        }
+        entry->chips |= 1 << (link_index - 1);
+        entry->data[link_index - 1] = data;
+        batch_chain                 = this;
+        batch_len                   = std::max(batch_len, int(std::max(link_index, chain_length)));
+        return;
+    }
+    BusLock lock;
     tmc_spi_bus_setup();
 
     switchCSpin(0);
@@ -53,6 +185,10 @@ void TMC2130Stepper::write(uint8_t reg, uint32_t data) {
 
 // Replace the library's weak definition of TMC2130Stepper::read()
 uint32_t TMC2130Stepper::read(uint8_t reg) {
+    if (batching && link_index > 0 && batch_pending(reg, link_index)) {
+        batch_flush();
+    }
+    BusLock lock;
     tmc_spi_bus_setup();
 
     switchCSpin(0);
@@ -65,11 +201,10 @@ uint32_t TMC2130Stepper::read(uint8_t reg) {
     // to account for the chips in the chain after the target one.  The
     // data for those "after" chips will appear at the beginning of the input
     // buffer, with the desired data for the target chip at the end.
-    const size_t packetLen      = 5;
-    size_t       afterChips     = link_index > 0 ? chain_length - link_index : 0;
-    size_t       dummy_in_bytes = afterChips * packetLen;
-    size_t       total_bytes    = (afterChips + 1) * packetLen;
-    size_t       total_bits     = total_bytes * 8;
+    size_t afterChips     = link_index > 0 ? chain_length - link_index : 0;
+    size_t dummy_in_bytes = afterChips * packetLen;
+    size_t total_bytes    = (afterChips + 1) * packetLen;
+    size_t total_bits     = total_bytes * 8;
 
     uint8_t in[total_bytes] = { 0 };
 
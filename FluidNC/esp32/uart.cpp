@@ -22,7 +22,7 @@ void uart_data_callback(uart_port_t uart_num, uint8_t* buf, int* len) {
         if (last[uart_num]) {
             --out;
             uint8_t pinnum = c & (PINNUM_MAX - 1);
-            protocol_send_event_from_ISR(last[uart_num] == 0xc4 ? &pinInactiveEvent : &pinActiveEvent, (void*)objects[uart_num][pinnum]);
+            protocol_send_pin_event_from_ISR(objects[uart_num][pinnum], last[uart_num] != 0xc4);
             last[uart_num] = 0;
         } else {
             if (c == 0xc4 || c == 0xc5) {
@@ -32,18 +32,31 @@ void uart_data_callback(uart_port_t uart_num, uint8_t* buf, int* len) {
         }
     }
     *len = out;
+    protocol_wake_polling_from_ISR();
 }
 void uart_register_input_pin(int uart_num, uint8_t pinnum, InputPin* object) {
     objects[uart_num][pinnum] = object;
     last[uart_num]            = 0;
 }
 
+// The driver's receive buffer must hold everything that arrives between reads.  At
+// 2 Mbaud that is 200 bytes per millisecond, so it is sized to cover a few missed polls.
+const int RX_BUFFER_SIZE = 2048;
+
+// The interrupt moves the hardware FIFO to the receive buffer when it holds this many
+// bytes, or when the line has been idle for a few characters.  Leaving a quarter of the
+// 128-byte FIFO free gives the interrupt 32 character times to respond, which at high baud
+// rates is the difference between a chunked copy and an overrun.
+const int RX_FULL_THRESHOLD = 96;
+
 static void uart_driver_n_install(void* arg) {
     uart_port_t port = (uart_port_t)arg;
     if (port) {
-        fnc_uart_driver_install(port, 256, 0, 0, NULL, ESP_INTR_FLAG_IRAM);
+        fnc_uart_driver_install(port, RX_BUFFER_SIZE, 0, 0, NULL, ESP_INTR_FLAG_IRAM);
+        fnc_uart_set_rx_full_threshold(port, RX_FULL_THRESHOLD);
     } else {
-        uart_driver_install(port, 256, 0, 0, NULL, ESP_INTR_FLAG_IRAM);
+        uart_driver_install(port, RX_BUFFER_SIZE, 0, 0, NULL, ESP_INTR_FLAG_IRAM);
+        uart_set_rx_full_threshold(port, RX_FULL_THRESHOLD);
     }
 }
 
@@ -8,7 +8,11 @@
 
 class PwmPin {
 public:
-    PwmPin(int gpio, bool invert, uint32_t frequency);
+    // With mcpwm, the pin uses an MCPWM timer instead of LEDC.  The MCPWM timer
+    // counts at up to 160 MHz with a 16-bit period, so at high frequencies it has
+    // several times the duty resolution of LEDC, whose counter runs at 80 MHz in
+    // power-of-two steps.  There are only six MCPWM timers.
+    PwmPin(int gpio, bool invert, uint32_t frequency, bool mcpwm = false);
     ~PwmPin();
     uint32_t frequency() { return _frequency; }
     uint32_t period() { return _period; }
@@ -18,6 +22,10 @@ public:
 private:
     int      _gpio;
     uint32_t _frequency;
-    int      _channel;
+    int      _channel;  // LEDC channel, or MCPWM unit * 3 + timer
     int      _period;
+    bool     _mcpwm;
+    bool     _invert;
+
+    void initMcpwm();
 };
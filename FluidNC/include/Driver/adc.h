@@ -0,0 +1,17 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include "src/Pins/PinDetail.h"  // pinnum_t
+
+#include <cstdint>
+
+// ADC interface
+
+// Sets up a pin for analog input with the full-scale attenuation.  Only ADC1 pins can
+// be used, since ADC2 is taken by WiFi.  Returns false if the pin has no ADC1 channel.
+bool adc_init(pinnum_t pin);
+
+// Returns the calibrated voltage at a pin set up by adc_init(), in millivolts
+uint32_t adc_read_mv(pinnum_t pin);
@@ -0,0 +1,24 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include <cstddef>
+
+// Optional storage of the configuration file in a flash partition labeled "config".
+// The partition holds an image of one file - its name and its text - that is mapped
+// into the data address space, so the configuration can be parsed in place without
+// reading the file into the heap.
+
+// Maps the image.  Returns the text and sets size and name, or returns nullptr
+// if there is no config partition or it does not hold an image.  The text stays
+// valid until config_partition_unmap().
+const char* config_partition_map(size_t& size, const char*& name);
+void        config_partition_unmap();
+
+// Replaces the image with size bytes of text copied from the file name.
+// Returns true on error.
+bool config_partition_write(const char* name, const char* text, size_t size);
+
+// Erases the image, so the configuration is read from the file system again
+bool config_partition_erase();
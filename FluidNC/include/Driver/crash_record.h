@@ -0,0 +1,49 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// A compact record of the last panic, written by the panic handler into RTC memory,
+// which survives the restart.  It takes microseconds, where a core dump to flash
+// takes seconds, so the restart after a panic is as quick as any other.  The record
+// stays until it is cleared, and can be shown or saved at leisure after the restart.
+
+const int crash_backtrace_depth = 16;
+const int crash_app_size        = 200;
+
+struct crash_record_t {
+    uint32_t magic;
+    int32_t  core;          // The core that panicked
+    char     reason[40];    // As the panic handler prints it, e.g. LoadProhibited
+    char     task[16];      // The task that was running on that core
+    uint32_t uptime_ms;     // Time from the restart before it
+    uint32_t quick_panics;  // Consecutive panics, each within a minute of a restart
+
+    // The exception frame
+    uint32_t pc, ps, sar, exccause, excvaddr;
+    uint32_t a[16];
+
+    // The pc and sp of each frame, innermost first
+    uint32_t backtrace[crash_backtrace_depth][2];
+    uint8_t  depth;      // Frames in backtrace
+    bool     corrupted;  // The backtrace ended at a bad frame
+
+    alignas(4) uint8_t app[crash_app_size];  // Filled by the hook, see crash_record_set_hook()
+    uint32_t check;
+};
+
+// False on targets where the exception frame cannot be decoded
+bool crash_record_supported();
+
+// The hook is called by the panic handler, after the registers are recorded, to add
+// what the application knows, such as the line being executed, to the app area.  It
+// runs with the scheduler stopped and must not block, allocate or log.
+typedef void (*crash_hook_t)(uint8_t* app, size_t size);
+void crash_record_set_hook(crash_hook_t hook);
+
+// The record of the last panic, or nullptr if there is none
+const crash_record_t* crash_record_last();
+void                  crash_record_clear();
@@ -25,6 +25,13 @@ void gpio_set_event(int gpio_num, void* arg, int invert);
 void gpio_clear_event(int gpio_num);
 void poll_gpios();
 
+// callback runs in the step ISR, from gpio_sample_fast(), and must be in IRAM.
+// It is in addition to any event, so the pin must be registered with
+// gpio_set_event() first.
+void gpio_set_fast_action(int gpio_num, void (*callback)(void* arg, int active), void* arg);
+void gpio_set_fast_debounce(int32_t cpu_ticks);
+void gpio_sample_fast();
+
 #ifdef __cplusplus
 }
 #endif
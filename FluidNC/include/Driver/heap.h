@@ -0,0 +1,35 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include <cstddef>
+
+// Kinds of heap memory.  A region can be of several kinds; internal memory
+// is usually also DMA-capable.
+enum heap_region_t {
+    HEAP_INTERNAL,
+    HEAP_PSRAM,
+    HEAP_DMA,
+    HEAP_NREGIONS,
+};
+
+struct heap_region_stats_t {
+    size_t total;             // Bytes in the regions
+    size_t free;              // Bytes free
+    size_t largest_block;     // Largest allocation that can succeed
+    size_t min_free;          // Lowest free since boot
+    size_t allocated_blocks;  // Blocks in use
+    size_t free_blocks;       // Free blocks; many small ones mean fragmentation
+};
+
+// Name of the kind of memory, for reports
+const char* heap_region_name(heap_region_t region);
+
+// Statistics of the heap regions of a kind.  Returns false if the chip has none.
+bool heap_region_stats(heap_region_t region, heap_region_stats_t& stats);
+
+// Allocates size bytes of zeroed memory of a kind, or returns nullptr if there is not
+// enough of it.  The memory is released with heap_region_free().
+void* heap_region_calloc(heap_region_t region, size_t size);
+void  heap_region_free(void* ptr);
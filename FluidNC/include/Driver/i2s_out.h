@@ -67,9 +67,20 @@ void i2s_out_write(pinnum_t pin, uint8_t val);
 /*
   Dynamically delay until the Shift Register Pin changes
   according to the current I2S processing state and mode.
+  Between i2s_out_begin() and i2s_out_commit(), the delay
+  happens in i2s_out_commit() instead.
  */
 void i2s_out_delay();
 
+/*
+  Group pin writes into one shift register latch.  Writes between
+  the calls only change the internal pin state var, which
+  i2s_out_commit() then sends.  The calls nest; the outermost
+  i2s_out_commit() sends.
+ */
+void i2s_out_begin();
+void i2s_out_commit();
+
 /*
    Reference: "ESP32 Technical Reference Manual" by Espressif Systems
      https://www.espressif.com/sites/default/files/documentation/esp32_technical_reference_manual_en.pdf
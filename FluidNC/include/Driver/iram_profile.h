@@ -0,0 +1,30 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// In a build with IRAM_PROFILE and -finstrument-functions, see the iram_profile
+// environment in platformio.ini, every function entry is counted by address,
+// separately for ISR and task context.  ld/esp32/iram_report.py matches the
+// counts with the firmware symbols, to show IRAM functions that never run in an
+// ISR and ISR functions that are not in IRAM.
+
+struct iram_profile_entry_t {
+    uintptr_t address;
+    uint32_t  isr_calls;
+    uint32_t  task_calls;
+};
+
+// False unless the firmware was built for profiling
+bool iram_profile_enabled();
+
+// Copies up to max entries to entries, and returns the number copied
+size_t iram_profile_entries(iram_profile_entry_t* entries, size_t max);
+
+// Functions whose entries did not fit in the table
+uint32_t iram_profile_dropped();
+
+void iram_profile_reset();
@@ -0,0 +1,39 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// A sampling profiler.  A timer interrupt on each core records the program counter
+// of the code that it interrupted into a ring per core, which keeps the latest samples.
+// ld/esp32/pc_profile_report.py matches the dumped addresses with the firmware symbols
+// to find where the time goes during a real job, without a debugger.
+//
+// The timer interrupt is at the level of the step timer and of critical sections, so
+// neither of those is sampled; the time they take is charged to the code they interrupt.
+
+struct pc_sample_t {
+    uint32_t pc;
+    bool     isr;  // The sample interrupted a lower-level interrupt handler
+};
+
+// False on targets where the interrupted program counter cannot be read
+bool pc_profile_supported();
+
+// Starts sampling each core hz times per second, keeping up to samples per core.
+// Any earlier samples are discarded.  Returns false if unsupported or out of memory.
+bool pc_profile_start(uint32_t hz, size_t samples);
+void pc_profile_stop();
+bool pc_profile_running();
+
+// The number of cores sampled
+int pc_profile_cores();
+
+// Samples taken on core since the start, including those the ring no longer holds
+uint32_t pc_profile_taken(int core);
+
+// Copies up to max of the samples that the ring of core holds, oldest first, and returns
+// the number copied.  Call it when the profiler is stopped.
+size_t pc_profile_samples(int core, pc_sample_t* samples, size_t max);
@@ -0,0 +1,16 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include <cstddef>
+
+// True if the chip has external PSRAM that is usable by the heap
+bool psram_available();
+
+// Allocates from external PSRAM.  Returns nullptr if there is no PSRAM
+// or it is exhausted.  The memory is released with free().
+void* psram_malloc(size_t size);
+
+// Bytes of PSRAM heap still free
+size_t psram_free_size();
@@ -0,0 +1,18 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include "src/Pins/PinDetail.h"  // pinnum_t
+
+// Pulse counter interface
+
+// Counts both edges of a_pin, and of b_pin unless it is 255, upward regardless of the
+// direction of rotation.  The count returns to zero when it reaches limit.
+bool    pulse_counter_init(int unit, pinnum_t a_pin, pinnum_t b_pin, int16_t limit);
+int16_t pulse_counter_read(int unit);  // Safe to call from an ISR
+
+// Decodes a quadrature signal on a_pin and b_pin, counting four per cycle, up in one direction
+// of rotation and down in the other.  Swapping the pins reverses the count.  The count
+// returns to zero when it reaches limit or -limit, so it is only meaningful modulo limit.
+bool pulse_counter_init_quadrature(int unit, pinnum_t a_pin, pinnum_t b_pin, int16_t limit);
@@ -1,7 +1,19 @@
 #include <system_error>
+#include <cstddef>
+#include <cstdint>
 
-bool sd_init_slot(uint32_t freq_hz, int cs_pin, int cd_pin = -1, int wp_pin = -1);
+// The card is driven at up to freq_hz, falling back to slower clocks, but not below
+// min_freq_hz, if it cannot initialize or transfers fail
+bool sd_init_slot(uint32_t freq_hz, uint32_t min_freq_hz, int cs_pin, int cd_pin = -1, int wp_pin = -1);
 void sd_unmount();
 void sd_deinit_slot();
 
 std::error_code sd_mount(int max_files = 1);
+
+// The serial number of the mounted card, or 0 if none is mounted.  It tells
+// whether the card was changed between mounts.
+uint32_t sd_card_serial();
+
+// Allocates memory that the card can transfer into directly, so that large reads
+// become multi-block transfers.  The memory is released with free().
+void* sd_dma_malloc(size_t size);
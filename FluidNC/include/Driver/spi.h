@@ -7,6 +7,13 @@
 bool spi_init_bus(pinnum_t sck_pin, pinnum_t miso_pin, pinnum_t mosi_pin, bool dma, int8_t sck_drive_strength, int8_t mosi_drive_strength);
 void spi_deinit_bus();
 
+// The SD card and the TMC drivers share the bus, each driving the hardware its own
+// way, so every transaction holds the bus lock.  Urgent holders, the short TMC
+// register accesses, go ahead of waiting bulk holders, so a driver poll waits for
+// at most one SD burst.  The lock is recursive.
+void spi_bus_lock(bool urgent);
+void spi_bus_unlock();
+
 // Returns devid or -1
 spi_device_t spi_register_device(pinnum_t cs_pin);
 
@@ -11,6 +11,10 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// Limits of one pulse train, see step_train below
+#define STEP_TRAIN_MAX_TICKS 63  // ISR ticks per train, so that a train fits in one RMT memory block
+#define STEP_TRAIN_MAX_US 4000   // Longest train in microseconds
+
 typedef struct step_engine {
     const char* name;
 
@@ -28,7 +32,7 @@ typedef struct step_engine {
     void (*set_dir_pin)(int pin, int level);
 
     // Commit all of the direction pin changes and wait for dir_delay_us
-    // if necessary
+    // if necessary, or arrange for wait_dir to do it
     void (*finish_dir)();
 
     // Set the state of the step pin to level
@@ -62,6 +66,27 @@ typedef struct step_engine {
     // Stop the pulse event timer
     void (*stop_timer)();
 
+    // Optional, NULL if the engine only steps once per timer event.
+    // Emit a train of count step pulses on a step pin identified by init_step_pin(),
+    // starting now. offsets are the ascending start times of the pulses in units of
+    // tick_period ticks of the stepping timer, each smaller than STEP_TRAIN_MAX_TICKS,
+    // and the train is no longer than STEP_TRAIN_MAX_US. The direction pins have been
+    // set; the engine must allow dir_delay_us before the first pulse.
+    void (*step_train)(int pin, const uint8_t* offsets, int count, uint32_t tick_period);
+
+    // Optional, NULL if finish_dir waits for dir_delay_us itself.  Waits for what remains
+    // of dir_delay_us since the last finish_dir.  With it, Stepping.cpp sets the directions
+    // for the next pulse as soon as the previous pulse ends, so the delay overlaps the time
+    // between pulses and the wait before the next pulse is usually over already.
+    void (*wait_dir)();
+
+    // Optional, NULL if the engine latency is always low.  Trades CPU time for a shorter
+    // delay between generating a step and the pulse reaching the pin, while homing or
+    // probing, where the delay becomes distance travelled after a switch trips.  The
+    // change uses the resources from init, so it is cheap enough to make for every probe.
+    // The return value is the new latency in microseconds.
+    uint32_t (*set_low_latency)(int on);
+
     // Link to next engine in the list of registered stepping engines
     struct step_engine* link;
 } step_engine_t;
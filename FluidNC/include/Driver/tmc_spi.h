@@ -0,0 +1,23 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class TMC2130Stepper;
+
+// Whole-chain access to daisy-chained TMC SPI drivers
+
+// Between these calls, register writes to chained drivers are queued
+// instead of sent.  tmc_spi_end_batch() then sends each register to all
+// of the drivers that have a write for it in one transfer.  A read of a
+// register that has a queued write sends the queue first.
+void tmc_spi_begin_batch();
+void tmc_spi_end_batch();
+
+// Reads a register from all n drivers on the chain that stepper is on, in
+// two transfers.  data[i] receives the value from the driver with link
+// index i + 1.
+void tmc_spi_read_chain(TMC2130Stepper& stepper, uint8_t reg, uint32_t* data, size_t n);
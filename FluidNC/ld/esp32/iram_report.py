@@ -0,0 +1,148 @@
+# IRAM usage report
+#
+# As a PlatformIO extra script, this adds an "iram_report" target:
+#
+#   pio run -e wifi -t iram_report
+#
+# It can also be run directly on a built firmware:
+#
+#   python FluidNC/ld/esp32/iram_report.py .pio/build/wifi/firmware.elf [--top N] [--profile LOG]
+#
+# The report lists the functions in the IRAM sections by size, and the sizes of
+# the IRAM sections.  With --profile, LOG is a captured $IRAM/Profile output from
+# a firmware built with the iram_profile environment.  The report then marks:
+#   flash?  IRAM functions that never ran in an ISR, which may move to flash
+#   IRAM!   functions that ran in an ISR but are not in IRAM, which can crash
+#           when the flash cache is disabled
+
+import argparse
+import os
+import re
+import shutil
+import subprocess
+
+IRAM_SECTIONS = (".iram0.vectors", ".iram0.text")
+
+
+def tool(prefix, name):
+    return prefix + name if prefix else name
+
+
+def sections(elf, prefix):
+    # Returns {name: (address, size)} of the sections of elf
+    out = subprocess.check_output([tool(prefix, "objdump"), "-h", elf]).decode()
+    result = {}
+    for line in out.splitlines():
+        fields = line.split()
+        # Idx Name Size VMA LMA File-off Algn
+        if len(fields) >= 7 and fields[0].isdigit():
+            result[fields[1]] = (int(fields[3], 16), int(fields[2], 16))
+    return result
+
+
+def symbols(elf, prefix):
+    # Returns [(address, size, name)] of the sized function and object symbols of elf
+    out = subprocess.check_output([tool(prefix, "nm"), "-S", "-C", elf]).decode("utf-8", "replace")
+    # Symbols without a size, such as undefined ones, have fewer fields
+    pattern = re.compile(r"^([0-9a-fA-F]+) ([0-9a-fA-F]+) \w (.*)$")
+    result = []
+    for line in out.splitlines():
+        m = pattern.match(line)
+        if m:
+            result.append((int(m.group(1), 16), int(m.group(2), 16), m.group(3)))
+    return result
+
+
+def in_any(address, ranges):
+    return any(start <= address < start + size for start, size in ranges)
+
+
+def read_profile(path):
+    # $IRAM/Profile lines look like [IRAM 0x400d1234 isr:12 task:3]
+    pattern = re.compile(r"\[IRAM (0x[0-9a-fA-F]+) isr:(\d+) task:(\d+)\]")
+    result = {}
+    with open(path, errors="replace") as f:
+        for line in f:
+            m = pattern.search(line)
+            if m:
+                result[int(m.group(1), 16)] = (int(m.group(2)), int(m.group(3)))
+    return result
+
+
+def report(elf, prefix="", top=40, profile=None):
+    secs = sections(elf, prefix)
+    iram = [secs[name] for name in IRAM_SECTIONS if name in secs]
+    syms = symbols(elf, prefix)
+    hot = read_profile(profile) if profile else {}
+
+    print("IRAM sections:")
+    total = 0
+    for name in IRAM_SECTIONS:
+        if name in secs:
+            print("  %-16s %7d bytes" % (name, secs[name][1]))
+            total += secs[name][1]
+    print("  %-16s %7d bytes" % ("total", total))
+
+    consumers = sorted((s for s in syms if in_any(s[0], iram)), key=lambda s: -s[1])
+    print()
+    print("Largest IRAM consumers:")
+    for address, size, name in consumers[:top]:
+        mark = ""
+        if hot and hot.get(address, (0, 0))[0] == 0:
+            mark = "flash?"
+        print("  %7d  %-6s %s" % (size, mark, name))
+
+    if hot:
+        by_address = {s[0]: s for s in syms}
+        unused = sum(s[1] for s in consumers if hot.get(s[0], (0, 0))[0] == 0)
+        print()
+        print("IRAM bytes in functions that never ran in an ISR: %d" % unused)
+        print("Functions that ran in an ISR:")
+        for address, (isr, task) in sorted(hot.items(), key=lambda h: -h[1][0]):
+            if isr == 0:
+                continue
+            sym = by_address.get(address)
+            name = sym[2] if sym else hex(address)
+            mark = "" if in_any(address, iram) else "IRAM!"
+            print("  %9d isr %9d task  %-6s %s" % (isr, task, mark, name))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="List the IRAM consumers of an ESP32 firmware")
+    parser.add_argument("elf")
+    parser.add_argument("--top", type=int, default=40, help="number of functions to list")
+    parser.add_argument("--profile", help="captured $IRAM/Profile output")
+    parser.add_argument("--prefix", default="", help="toolchain prefix, e.g. xtensa-esp32-elf-")
+    args = parser.parse_args()
+    prefix = args.prefix
+    if not prefix:
+        for candidate in ("xtensa-esp32-elf-", "xtensa-esp32s3-elf-"):
+            if shutil.which(candidate + "nm"):
+                prefix = candidate
+                break
+    report(args.elf, prefix, args.top, args.profile)
+
+
+try:
+    Import("env")
+except NameError:
+    env = None
+
+if env is None:
+    if __name__ == "__main__":
+        main()
+else:
+
+    def iram_report_action(target, source, env):
+        # The compiler is <prefix>gcc, and the binutils have the same prefix
+        cc = os.path.basename(env.subst("$CC"))
+        prefix = os.path.join(os.path.dirname(env.subst("$CC")), cc[: -len("gcc")]) if cc.endswith("gcc") else ""
+        report(str(source[0]), prefix)
+
+    env.AddCustomTarget(
+        name="iram_report",
+        dependencies="$BUILD_DIR/${PROGNAME}.elf",
+        actions=iram_report_action,
+        title="IRAM report",
+        description="List the functions that use IRAM",
+    )
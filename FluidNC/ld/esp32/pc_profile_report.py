@@ -0,0 +1,91 @@
+# Sampling profile report
+#
+# Folds a captured $Profile/Dump output into functions, using the symbols of the
+# firmware that produced it:
+#
+#   python FluidNC/ld/esp32/pc_profile_report.py .pio/build/wifi/firmware.elf LOG [--top N]
+#
+# To capture LOG, send $Profile/Start, run the job, then send $Profile/Dump and save
+# what it prints.  Each function is listed with its share of the samples of each core,
+# and how many of them were in an interrupt handler.
+
+import argparse
+import bisect
+import re
+import shutil
+import subprocess
+
+
+def tool(prefix, name):
+    return prefix + name if prefix else name
+
+
+def functions(elf, prefix):
+    # Returns the sorted [(address, size, name)] of the function symbols of elf
+    out = subprocess.check_output([tool(prefix, "nm"), "-S", "-C", "--defined-only", elf]).decode("utf-8", "replace")
+    pattern = re.compile(r"^([0-9a-fA-F]+) ([0-9a-fA-F]+) [tTwW] (.*)$")
+    result = []
+    for line in out.splitlines():
+        m = pattern.match(line)
+        if m:
+            result.append((int(m.group(1), 16), int(m.group(2), 16), m.group(3)))
+    result.sort()
+    return result
+
+
+def read_dump(path):
+    # $Profile/Dump lines look like [PC 0x400d1234 core:0 samples:12 isr:3]
+    pattern = re.compile(r"\[PC (0x[0-9a-fA-F]+) core:(\d+) samples:(\d+) isr:(\d+)\]")
+    result = []
+    with open(path, errors="replace") as f:
+        for line in f:
+            m = pattern.search(line)
+            if m:
+                result.append((int(m.group(1), 16), int(m.group(2)), int(m.group(3)), int(m.group(4))))
+    return result
+
+
+def report(elf, dump, prefix="", top=40):
+    syms = functions(elf, prefix)
+    starts = [s[0] for s in syms]
+    samples = read_dump(dump)
+
+    totals = {}  # core: samples
+    by_function = {}  # (core, name): [samples, isr]
+    for address, core, count, isr in samples:
+        totals[core] = totals.get(core, 0) + count
+        i = bisect.bisect_right(starts, address) - 1
+        if i >= 0 and address < syms[i][0] + max(syms[i][1], 1):
+            name = syms[i][2]
+        else:
+            name = hex(address)
+        entry = by_function.setdefault((core, name), [0, 0])
+        entry[0] += count
+        entry[1] += isr
+
+    for core in sorted(totals):
+        print("Core %d, %d samples:" % (core, totals[core]))
+        rows = sorted(((v[0], v[1], k[1]) for k, v in by_function.items() if k[0] == core), reverse=True)
+        for count, isr, name in rows[:top]:
+            print("  %6.2f%% %7d  isr:%-7d %s" % (100.0 * count / totals[core], count, isr, name))
+        print()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Fold a $Profile/Dump capture into functions")
+    parser.add_argument("elf")
+    parser.add_argument("dump", help="captured $Profile/Dump output")
+    parser.add_argument("--top", type=int, default=40, help="number of functions to list per core")
+    parser.add_argument("--prefix", default="", help="toolchain prefix, e.g. xtensa-esp32-elf-")
+    args = parser.parse_args()
+    prefix = args.prefix
+    if not prefix:
+        for candidate in ("xtensa-esp32-elf-", "xtensa-esp32s3-elf-"):
+            if shutil.which(candidate + "nm"):
+                prefix = candidate
+                break
+    report(args.elf, args.dump, prefix, args.top)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,120 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  ArcChords.h - the end points of the chords that approximate an arc
+
+  mc_arc() computed each chord end point between the planner calls for the chords, so
+  the rotation and the planner work took turns in the registers and the cache.  An
+  ArcChords computes the points a batch at a time in a loop without calls.  The points
+  are the same as before: each is the previous radius vector rotated by a third-order
+  small angle approximation, except that every correction'th point is the exact
+  rotation of the starting radius vector, so the approximation error cannot accumulate.
+
+  arc_fit() chooses fewer chords for an arc that the steppers would otherwise run in less
+  than one step segment per chord, see below.  Both are header-only so that they can be
+  tested on the host.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+class ArcChords {
+    float    _start[2];   // Radius vector from the center to the start of the arc
+    float    _radius[2];  // Radius vector of the last point
+    float    _theta;      // Angle per chord
+    float    _cos;
+    float    _sin;
+    int      _correction;
+    int      _count = 0;  // Approximated points since the last exact one
+    uint32_t _index = 0;  // Number of the last point, 0 for the start
+
+public:
+    ArcChords(float r0, float r1, float theta_per_segment, int correction) :
+        _start { r0, r1 }, _radius { r0, r1 }, _theta(theta_per_segment), _correction(correction) {
+        // cos_T = 1 - theta_per_segment^2/2, sin_T = theta_per_segment - theta_per_segment^3/6
+        _cos = 2.0f - _theta * _theta;
+        _sin = _theta * 0.16666667f * (_cos + 4.0f);
+        _cos *= 0.5f;
+    }
+
+    // Stores the radius vectors of the next n points in r0 and r1
+    void next(int n, float* r0, float* r1) {
+        float    x     = _radius[0];
+        float    y     = _radius[1];
+        int      count = _count;
+        uint32_t i     = _index;
+        for (int k = 0; k < n; k++) {
+            ++i;
+            if (count < _correction) {
+                float yi = x * _sin + y * _cos;
+                x        = x * _cos - y * _sin;
+                y        = yi;
+                count++;
+            } else {
+                float cos_Ti = cosf(i * _theta);
+                float sin_Ti = sinf(i * _theta);
+                x            = _start[0] * cos_Ti - _start[1] * sin_Ti;
+                y            = _start[0] * sin_Ti + _start[1] * cos_Ti;
+                count        = 0;
+            }
+            r0[k] = x;
+            r1[k] = y;
+        }
+        _radius[0] = x;
+        _radius[1] = y;
+        _count     = count;
+        _index     = i;
+    }
+};
+
+struct ArcFit {
+    uint16_t segments;  // Number of chords
+    float    radius;    // Distance from the center to the end points between the chords
+};
+
+// With segments chords from arc_tolerance, a fast arc can have chords that take less than a
+// step segment to run, which only adds planner blocks.  arc_fit() returns fewer chords, down to
+// one per min_chord mm, as long as arc_tolerance still holds.  The chords keep their end points
+// on the arc only when they are short enough to be inside it by at most the tolerance; longer
+// chords move the end points between them out from the arc, so the chords cross it and deviate
+// from it by at most the tolerance on either side.  The first and last end points, the start
+// and the target of the arc, stay on the arc.
+static inline ArcFit arc_fit(float angular_travel, float radius, float tolerance, float min_chord, uint16_t segments) {
+    ArcFit fit    = { segments, radius };
+    float  travel = fabsf(angular_travel);
+    float  length = travel * radius;
+    if (segments <= 2 || min_chord * segments <= length || 2.0f * radius <= 1.5f * tolerance) {
+        return fit;
+    }
+    // Pushing the end points out by tolerance allows a sagitta of about 1.5 tolerance on the
+    // first and last chords, which are the worst because one of their ends is on the arc
+    float sagitta = 1.5f * tolerance;
+    float fewest  = ceilf(0.5f * length / sqrtf(sagitta * (2.0f * radius - sagitta)));
+    for (uint16_t n = uint16_t(std::max({ fewest, floorf(length / min_chord), 2.0f })); n < segments; n++) {
+        float half    = 0.5f * travel / n;  // Half the angle of a chord
+        float cos_h   = cosf(half);
+        float sin_q   = sinf(0.5f * half);
+        float inside  = 2.0f * radius * sin_q * sin_q;  // Sagitta with both end points on the arc
+        float minimum = std::max(0.0f, 2.0f * (inside - tolerance) / cos_h);
+        for (float push : { std::min(minimum, tolerance), tolerance }) {
+            float outer = radius + push;
+            // How far the first chord and the chords between are inside the arc, written so
+            // that the large terms cancel before the float rounding
+            float sin_h = sinf(half);
+            float dx    = push - 2.0f * outer * sin_h * sin_h;
+            float dy    = 2.0f * outer * sin_h * cos_h;
+            float first = radius - radius * dy / sqrtf(dx * dx + dy * dy);
+            float inner = 2.0f * outer * sin_q * sin_q - push;
+            if (std::max(first, inner) <= tolerance) {
+                fit.segments = n;
+                fit.radius   = outer;
+                return fit;
+            }
+        }
+    }
+    return fit;
+}
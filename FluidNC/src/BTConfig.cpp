@@ -7,10 +7,12 @@
 #include "src/Report.h"  // CLIENT_*
 #include "src/Channel.h"
 #include "src/Logging.h"
+#include "src/string_util.h"  // printable_run()
 
 #include "esp_bt.h"
 #include "esp_bt_main.h"
 
+#include <algorithm>
 #include <cstdint>
 
 // SerialBT sends the data over Bluetooth
@@ -31,12 +33,55 @@ namespace WebUI {
     std::string    BTConfig::_btname   = "";
 
     size_t BTChannel::write(uint8_t data) {
-        static uint8_t lastchar = '\0';
-        if (_addCR && data == '\n' && lastchar != '\r') {
-            SerialBT.write('\r');
+        return write(&data, 1);
+    }
+
+    size_t BTChannel::write(const uint8_t* buffer, size_t length) {
+        std::lock_guard<std::mutex> lock(_output_mutex);
+        for (size_t i = 0; i < length; i++) {
+            // Room for \r\n
+            if (_output_length + 2 > OUTPUT_BUFFER_SIZE) {
+                sendOutput();
+            }
+            uint8_t c = buffer[i];
+            if (_addCR && c == '\n' && _lastchar != '\r') {
+                _output[_output_length++] = '\r';
+            }
+            _output[_output_length++] = c;
+            _lastchar                 = c;
+        }
+
+        // The end of a batch of queued messages.  Output held back by congestion
+        // is sent by handle() once the link clears.
+        if (!_congested && length && buffer[length - 1] == '\n' && !uxQueueMessagesWaiting(message_queue)) {
+            sendOutput();
+        }
+        return length;
+    }
+
+    void BTChannel::flush() {
+        std::lock_guard<std::mutex> lock(_output_mutex);
+        sendOutput();
+        SerialBT.flush();
+    }
+
+    // The caller holds _output_mutex
+    void BTChannel::sendOutput() {
+        if (!_output_length) {
+            return;
         }
-        lastchar = data;
-        return SerialBT.write(data);
+        if (SerialBT.hasClient()) {
+            auto nWritten = SerialBT.write(_output, _output_length);
+            if (nWritten) {
+                ++_packets_sent;
+                _bytes_sent += nWritten;
+            }
+        }
+        _output_length = 0;
+    }
+
+    void BTChannel::printStats(Print& out) {
+        out << " writes:" << _packets_sent << " bytes:" << _bytes_sent;
     }
 
     BTConfig::BTConfig(const char* name) : Module(name) {
@@ -53,11 +98,16 @@ namespace WebUI {
                 uint8_t* addr = param->srv_open.rem_bda;
                 sprintf(str, "%02X:%02X:%02X:%02X:%02X:%02X", addr[0], addr[1], addr[2], addr[3], addr[4], addr[5]);
                 _btclient = str;
+                btChannel.connected();
                 log_info("BT Connected with " << str);
             } break;
             case ESP_SPP_CLOSE_EVT:  //Client connection closed
                 log_info("BT Disconnected");
                 _btclient = "";
+                btChannel.setCongested(false);
+                break;
+            case ESP_SPP_CONG_EVT:  // The link's transmit queue filled or drained
+                btChannel.setCongested(param->cong.cong);
                 break;
             default:
                 break;
@@ -74,11 +124,14 @@ namespace WebUI {
     }
 
     int BTChannel::available() {
-        return SerialBT.available();
+        return _rx.size() + SerialBT.available();
     }
     int BTChannel::read() {
         return SerialBT.read();
     }
+    int BTChannel::rx_buffer_available() {
+        return std::max(0, _rx_window - available());
+    }
     int BTChannel::peek() {
         return SerialBT.peek();
     }
@@ -98,6 +151,40 @@ namespace WebUI {
         return false;
     }
 
+    size_t BTChannel::appendRun(const uint8_t* data, size_t length) {
+        if (_lineedit->is_editing()) {
+            return 0;
+        }
+        size_t run = string_util::printable_run(data, length);
+        _lineedit->append(reinterpret_cast<const char*>(data), run);
+        return run;
+    }
+
+    void BTChannel::handle() {
+        if (!_congested) {
+            std::lock_guard<std::mutex> lock(_output_mutex);
+            sendOutput();
+        }
+
+        // Interactive editing decides which characters are realtime as it goes,
+        // so input is only queued ahead of the line editor when it is not in use
+        if (_lineedit->is_editing()) {
+            return;
+        }
+        uint8_t buffer[READ_CHUNK_SIZE];
+        while (size_t room = std::min(_rx.capacity() - _rx.size(), sizeof(buffer))) {
+            int avail = SerialBT.available();
+            if (avail <= 0) {
+                break;
+            }
+            size_t n = SerialBT.readBytes(buffer, std::min(room, size_t(avail)));
+            if (!n) {
+                break;
+            }
+            push(buffer, n);
+        }
+    }
+
     Error BTChannel::pollLine(char* line) {
         if (_lineedit == nullptr) {
             return Error::NoData;
@@ -10,6 +10,8 @@
 #include "src/Settings.h"
 
 #include <BluetoothSerial.h>
+#include <atomic>
+#include <mutex>
 
 const char* const DEFAULT_BT_NAME = "FluidNC";
 
@@ -20,23 +22,55 @@ namespace WebUI {
     private:
         Lineedit* _lineedit;
 
+        // Received data is moved from the SerialBT queue into _rx as it arrives, so
+        // a sender can keep more in flight than the 512 bytes of RX_QUEUE_SIZE, which
+        // is defined in BluetoothSerial.cpp but not in its .h
+        static const int RX_WINDOW       = 1024;
+        static const int READ_CHUNK_SIZE = 256;
+
+        // Output is collected here, with \n expanded to \r\n, and handed to SerialBT
+        // in pieces of up to one SPP MTU, so that each "ok" is not a packet of its
+        // own.  It is sent when the buffer fills, when a line ends and no more
+        // messages are queued, or from handle().  While the SPP link reports
+        // congestion, output is held until the buffer fills instead of blocking
+        // the sender in SerialBT.write().
+        static const size_t OUTPUT_BUFFER_SIZE = 990;  // ESP_SPP_MAX_MTU
+
+        std::mutex        _output_mutex;
+        uint8_t           _output[OUTPUT_BUFFER_SIZE];
+        size_t            _output_length = 0;
+        uint8_t           _lastchar      = '\0';
+        std::atomic<bool> _congested { false };
+
+        uint32_t _packets_sent = 0;
+        uint32_t _bytes_sent   = 0;
+
+        void sendOutput();
+
     public:
-        // BTChannel(bool addCR = false) : _linelen(0), _addCR(addCR) {}
-        BTChannel() : Channel("bluetooth", true) { _lineedit = new Lineedit(this, _line, Channel::maxLine - 1); }
+        BTChannel() : Channel("bluetooth", true) {
+            _lineedit = new Lineedit(this, _line, Channel::maxLine - 1);
+            setRxWindow(RX_WINDOW);
+        }
         virtual ~BTChannel() = default;
 
         int    available() override;
         int    read() override;
         int    peek() override;
-        void   flush() override { SerialBT.flush(); }
+        void   flush() override;
         size_t write(uint8_t data) override;
-        // 512 is RX_QUEUE_SIZE which is defined in BluetoothSerial.cpp but not in its .h
-        int rx_buffer_available() override { return 512 - SerialBT.available(); }
+        size_t write(const uint8_t* buffer, size_t length) override;
+        int    rx_buffer_available() override;
 
-        bool realtimeOkay(char c) override;
-        bool lineComplete(char* line, char c) override;
+        bool   realtimeOkay(char c) override;
+        bool   lineComplete(char* line, char c) override;
+        size_t appendRun(const uint8_t* data, size_t length) override;
 
+        void  handle() override;
         Error pollLine(char* line) override;
+        void  printStats(Print& out) override;
+
+        void setCongested(bool congested) { _congested = congested; }
     };
     extern BTChannel btChannel;
 
@@ -63,6 +97,7 @@ namespace WebUI {
         void init() override;
         void build_info(Channel& out) override;
         bool is_radio() override { return true; }
+        bool deferred_init() override { return true; }
 
         ~BTConfig();
     };
@@ -8,7 +8,11 @@
 #include "Limits.h"
 #include "Logging.h"
 #include "Job.h"
+#include "Protocol.h"  // protocol_wake_polling
+#include "Driver/delay_usecs.h"  // getCpuTicks(), ticks_per_us
+#include "string_util.h"        // printable_run()
 #include <string_view>
+#include <cstring>  // memcpy
 #include <algorithm>
 
 Channel::Channel(const std::string& name, bool addCR) : _name(name), _linelen(0), _addCR(addCR) {}
@@ -28,11 +32,10 @@ void Channel::resume() {
 }
 
 void Channel::flushRx() {
-    _linelen   = 0;
-    _lastWasCR = false;
-    while (_queue.size()) {
-        _queue.pop();
-    }
+    _linelen     = 0;
+    _lastWasCR   = false;
+    _pending_oks = 0;  // The sender expects nothing for lines sent before a reset
+    _rx.clear();
 }
 
 bool Channel::lineComplete(char* line, char ch) {
@@ -85,6 +88,18 @@ bool Channel::lineComplete(char* line, char ch) {
     return false;
 }
 
+size_t Channel::appendRun(const uint8_t* data, size_t length) {
+    size_t run = string_util::printable_run(data, length);
+    if (run) {
+        // Like lineComplete(), characters that do not fit are dropped
+        size_t n = std::min(run, size_t(Channel::maxLine - 1) - _linelen);
+        memcpy(&_line[_linelen], data, n);
+        _linelen += n;
+        _lastWasCR = false;
+    }
+    return run;
+}
+
 uint32_t Channel::setReportInterval(uint32_t ms) {
     uint32_t actual = ms;
     if (actual) {
@@ -95,6 +110,21 @@ uint32_t Channel::setReportInterval(uint32_t ms) {
     _lastTool       = 255;  // Force GCodeState report
     return actual;
 }
+int Channel::setAckBatch(int lines) {
+    flushAcks();
+    _ack_batch = std::min(std::max(lines, 0), maxAckBatch);
+    return _ack_batch;
+}
+
+void Channel::flushAcks() {
+    if (_pending_oks == 1) {
+        sendLine(MsgLevelNone, "ok");
+    } else if (_pending_oks) {
+        log_stream(*this, "ok:" << _pending_oks);
+    }
+    _pending_oks = 0;
+}
+
 static bool motionState() {
     return state_is(State::Cycle) || state_is(State::Homing) || state_is(State::Jog);
 }
@@ -119,10 +149,47 @@ void Channel::autoReportGCodeState() {
         _lastFeedRate     = gc_state.feed_rate;
     }
 }
+void Channel::autoReportDelta() {
+    if ((int32_t(xTaskGetTickCount()) - _nextReportTime) < 0) {
+        return;
+    }
+    _nextReportTime = xTaskGetTickCount() + _reportInterval;
+
+    StatusSnapshot      snapshot  = status_snapshot();
+    StatusFrame::Fields fields    = snapshot.fields;
+    const char*         stateName = snapshot.state_name;
+    fields.rx_free                = std::min(rx_buffer_available(), 0xffff);
+
+    // A full report starts the sequence and resynchronizes the client when a job
+    // starts or ends and when the offsets or overrides change
+    if (!_deltaValid || _reportOvr || _reportWco || _lastJobActive != Job::active()) {
+        report_ovr_counter = 0;
+        report_wco_counter = 0;
+        _reportOvr         = false;
+        _reportWco         = false;
+        _lastJobActive     = Job::active();
+        report_realtime_status(*this);
+    } else {
+        report_realtime_delta(*this, fields, _lastFields, stateName != _lastStateName);
+    }
+    _lastFields    = fields;
+    _lastStateName = stateName;
+    _deltaValid    = true;
+}
+
 void Channel::autoReport() {
+    if (_reportInterval && _reportDelta) {
+        autoReportDelta();
+        if (_reportNgc != CoordIndex::End) {
+            report_ngc_coord(_reportNgc, *this);
+            _reportNgc = CoordIndex::End;
+        }
+        autoReportGCodeState();
+        return;
+    }
     if (_reportInterval) {
         const char* stateName = state_name();
-        if (_reportOvr || _reportWco || stateName != _lastStateName || _lastPinString != report_pin_string ||
+        if (_reportOvr || _reportWco || stateName != _lastStateName || _lastPinMask != report_pin_mask ||
             (motionState() && (int32_t(xTaskGetTickCount()) - _nextReportTime) >= 0) || (_lastJobActive != Job::active())) {
             if (_reportOvr) {
                 report_ovr_counter = 0;
@@ -133,7 +200,7 @@ void Channel::autoReport() {
                 _reportWco         = false;
             }
             _lastStateName = stateName;
-            _lastPinString = report_pin_string;
+            _lastPinMask   = report_pin_mask;
             _lastJobActive = Job::active();
 
             _nextReportTime = xTaskGetTickCount() + _reportInterval;
@@ -149,12 +216,14 @@ void Channel::autoReport() {
 
 void Channel::pin_event(uint32_t pinnum, bool active) {
     auto input_pin = _pins.at(pinnum);
-    protocol_send_event(active ? &pinActiveEvent : &pinInactiveEvent, input_pin);
+    protocol_send_pin_event(input_pin, active);
 }
 
 void Channel::handleRealtimeCharacter(uint8_t ch) {
     uint32_t cmd = 0;
 
+    ++_stats.realtime;
+
     if ((ch & 0xf8) == 0xf8) {
         // 0xf8-0xff are not valid UTF-8 byte but can appear under some
         // glitch conditions.
@@ -198,12 +267,52 @@ void Channel::handleRealtimeCharacter(uint8_t ch) {
     execute_realtime_command(static_cast<Cmd>(cmd), *this);
 }
 
+void Channel::setRxWindow(int bytes) {
+    _rx_window = bytes;
+    if (_rx.capacity() < size_t(bytes)) {
+        _rx.set_capacity(bytes);
+    }
+}
+
 void Channel::push(uint8_t byte) {
+    ++_stats.rx_bytes;
     if (is_realtime_command(byte)) {
         handleRealtimeCharacter(byte);
-    } else {
-        _queue.push(byte);
+    } else if (!_rx.push(byte)) {
+        ++_stats.dropped;
+        log_error(name() << " input overflow");
     }
+    protocol_wake_polling();
+}
+
+// Realtime characters are handled immediately and the runs of ordinary
+// characters between them are copied into the queue in bulk.
+void Channel::push(const uint8_t* data, size_t length) {
+    size_t dropped = 0;
+    _stats.rx_bytes += length;
+    while (length) {
+        size_t run = 0;
+        while (run < length && !is_realtime_command(data[run])) {
+            ++run;
+        }
+        dropped += run - _rx.push(data, run);
+        if (run < length) {
+            handleRealtimeCharacter(data[run++]);
+        }
+        data += run;
+        length -= run;
+    }
+    if (dropped) {
+        _stats.dropped += dropped;
+        log_error(name() << " input overflow, " << dropped << " characters lost");
+    }
+    protocol_wake_polling();
+}
+
+// Counts a complete line and starts timing its ack
+void Channel::lineReceived() {
+    ++_stats.rx_lines;
+    _line_ticks = getCpuTicks();
 }
 
 Error Channel::pollLine(char* line) {
@@ -212,31 +321,51 @@ Error Channel::pollLine(char* line) {
     }
     handle();
     while (1) {
-        int ch = -1;
-        if (line && _queue.size()) {
-            ch = _queue.front();
-            _queue.pop();
-        } else {
-            ch = read();
-            if (ch < 0) {
-                break;
+        const uint8_t* data;
+        if (size_t n = line ? _rx.peek(data) : 0) {
+            // Assemble the line directly from the queued input, taking whole
+            // runs of ordinary characters at a time
+            size_t used     = 0;
+            bool   complete = false;
+            while (used < n && !complete) {
+                used += appendRun(data + used, n - used);
+                if (used < n) {
+                    complete = lineComplete(line, data[used++]);
+                }
             }
-            _active = true;
-            if (realtimeOkay(ch) && is_realtime_command(ch)) {
-                handleRealtimeCharacter((uint8_t)ch);
-                continue;
+            _rx.consume(used);
+            if (complete) {
+                lineReceived();
+                return Error::Ok;
             }
-            if (!line) {
-                _queue.push(ch);
-                continue;
-            }
-            // Fall through if line is non-null and it is not a realtime character
+            continue;
         }
 
+        int ch = read();
+        if (ch < 0) {
+            break;
+        }
+        _active = true;
+        if (realtimeOkay(ch) && is_realtime_command(ch)) {
+            ++_stats.rx_bytes;
+            handleRealtimeCharacter((uint8_t)ch);
+            continue;
+        }
+        if (!line) {
+            push(uint8_t(ch));  // Counted there
+            continue;
+        }
+        ++_stats.rx_bytes;
+
         if (lineComplete(line, ch)) {
+            lineReceived();
             return Error::Ok;
         }
     }
+    if (line) {
+        // The sender has nothing more for us now, so it may be waiting for acks
+        flushAcks();
+    }
     if (_active) {
         autoReport();
     }
@@ -262,10 +391,24 @@ void Channel::registerEvent(uint8_t pinnum, InputPin* obj) {
 }
 
 void Channel::ack(Error status) {
+    uint32_t us = (getCpuTicks() - _line_ticks) / ticks_per_us;
+    ++_stats.acks;
+    _stats.ack_total_us += us;
+    if (us > _stats.ack_max_us) {
+        _stats.ack_max_us = us;
+    }
     if (status == Error::Ok) {
+        if (_ack_batch > 1) {
+            if (++_pending_oks >= _ack_batch) {
+                flushAcks();
+            }
+            return;
+        }
         sendLine(MsgLevelNone, "ok");
         return;
     }
+    // The lines before this one must be acknowledged before it is
+    flushAcks();
     // With verbose errors, the message text is displayed instead of the number.
     // Grbl 0.9 used to display the text, while Grbl 1.1 switched to the number.
     // Many senders support both formats.
@@ -280,26 +423,30 @@ void Channel::ack(Error status) {
 
 void Channel::print_msg(MsgLevel level, const char* msg) {
     if (_message_level >= level) {
-        write(msg);
-        write("\n");
+        _stats.tx_bytes += write(msg);
+        _stats.tx_bytes += write("\n");
+        ++_stats.tx_lines;
     }
 }
 
-// This overload is used primarily with fixed string
-// values.  It sends a pointer to the string whose
-// memory does not need to be reclaimed later.
-// This is the most efficient form, but it only works
-// with fixed messages.
+// This overload is used with fixed string values and
+// with the pooled lines that log_*() builds messages in.
+// It sends a pointer to the string, which the output
+// task returns to the pool after sending it.  Fixed
+// strings are not in the pool, so they are left alone.
+// This is the most efficient form.
 void Channel::sendLine(MsgLevel level, const char* line) {
     if (outputTask) {
         LogMessage msg { this, (void*)line, level, false };
         while (!xQueueSend(message_queue, &msg, 10)) {}
     } else {
         print_msg(level, line);
+        release_log_line(line);
     }
 }
 
-// This overload is used primarily with log_*() where
+// This overload is used with log_*() when the line
+// pool is exhausted or a message is too long for it:
 // a std::string is dynamically allocated with "new",
 // and then extended to construct the message.  Its
 // pointer is sent to the output task, which sends
@@ -352,8 +499,8 @@ bool Channel::is_visible(const std::string& stem, std::string extension, bool is
     // Convert extension to canonical lower case format
     std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
 
-    // common gcode extensions
-    std::string_view extensions(".g .gc .gco .gcode .nc .ngc .ncc .txt .cnc .tap");
+    // common gcode extensions, and .gz for compressed files
+    std::string_view extensions(".g .gc .gco .gcode .nc .ngc .ncc .txt .cnc .tap .gz");
     int              pos = 0;
     while (extensions.length()) {
         auto             next_pos       = extensions.find_first_of(' ', pos);
@@ -369,9 +516,43 @@ bool Channel::is_visible(const std::string& stem, std::string extension, bool is
     return false;
 }
 
+int                   Channel::_pinBatchDepth = 0;
+std::vector<Channel*> Channel::_pinBatchChannels;
+
 void Channel::writeUTF8(uint32_t code) {
-    auto v = _utf8.encode(code);
-    for (auto const& b : v) {
-        write(b);
+    uint8_t buf[UTF8::max_length];
+    size_t  len = UTF8::encode(code, buf);
+    if (!_pinBatchDepth) {
+        write(buf, len);
+        return;
+    }
+    if (_pinBatchLen + len > maxPinBatch) {
+        flushPinBatch();
+    }
+    if (_pinBatchLen == 0) {
+        _pinBatchChannels.push_back(this);
+    }
+    memcpy(_pinBatch + _pinBatchLen, buf, len);
+    _pinBatchLen += len;
+}
+
+void Channel::flushPinBatch() {
+    if (_pinBatchLen) {
+        write(_pinBatch, _pinBatchLen);
+        _pinBatchLen = 0;
+    }
+}
+
+void Channel::beginPinBatch() {
+    ++_pinBatchDepth;
+}
+
+void Channel::commitPinBatch() {
+    if (--_pinBatchDepth) {
+        return;
+    }
+    for (auto channel : _pinBatchChannels) {
+        channel->flushPinBatch();
     }
+    _pinBatchChannels.clear();
 }
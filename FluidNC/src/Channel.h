@@ -21,18 +21,31 @@
 #include "src/Types.h"        // MotorMask
 #include "src/RealtimeCmd.h"  // Cmd
 #include "src/UTF8.h"
+#include "src/RxRing.h"
+#include "src/StatusFrame.h"
 
 #include "src/Pins/PinAttributes.h"
 #include "src/Machine/EventPin.h"
 
 #include <Stream.h>
+#include <vector>
+#include <map>
 #include <freertos/FreeRTOS.h>  // TickType_T
-#include <queue>
 
 class Channel : public Stream {
 private:
     void pin_event(uint32_t pinnum, bool active);
 
+    static constexpr int maxPinBatch = 32;
+
+    uint8_t _pinBatch[maxPinBatch];
+    size_t  _pinBatchLen = 0;
+
+    static int                   _pinBatchDepth;
+    static std::vector<Channel*> _pinBatchChannels;  // Channels with batched pin commands
+
+    void flushPinBatch();
+
     static constexpr int PinACK = 0xB2;
     static constexpr int PinNAK = 0xB3;
     static constexpr int PinRST = 0xB4;
@@ -56,7 +69,10 @@ protected:
     bool        _addCR         = false;
     char        _lastWasCR     = false;
 
-    std::queue<uint8_t> _queue;
+    // Input that has been received but not yet assembled into lines.  Channels whose
+    // input arrives in large chunks can enlarge it in their constructor.
+    RxRing _rx { 256 };
+    int    _rx_window = 256;  // Bytes a sender may have in flight, see rx_buffer_available()
 
     uint32_t _reportInterval = 0;
     int32_t  _nextReportTime = 0;
@@ -68,7 +84,14 @@ protected:
     const char* _lastStateName    = "";
     MotorMask   _lastLimits       = 0;
     bool        _lastJobActive    = false;
-    std::string _lastPinString    = "";
+    uint32_t    _lastPinMask      = 0;
+
+    // With delta reports ($Report/Delta), an auto report carries only the fields whose
+    // raw values differ from _lastFields, and none at all when nothing changed
+    bool                _reportDelta = false;
+    bool                _deltaValid  = false;  // _lastFields describes the last report
+    StatusFrame::Fields _lastFields;
+    void                autoReportDelta();
 
     bool       _reportOvr = true;
     bool       _reportWco = true;
@@ -76,8 +99,36 @@ protected:
 
     Cmd _last_rt_cmd = Cmd::None;
 
+    // With ack batching, the "ok"s for consecutive successful lines are counted and sent
+    // as one "ok:N" when _ack_batch lines have been acknowledged or the channel has no
+    // complete line waiting, so a pipelining sender is never left waiting for an ack.
+    int _ack_batch   = 0;  // 0 or 1 to send each "ok" separately
+    int _pending_oks = 0;
+
     std::map<int, InputPin*> _pins;
 
+public:
+    // Traffic counters, shown by $Channels/Stats and by the WebUI system status, to tell
+    // whether a stalled job was waiting on its transport
+    struct Stats {
+        uint32_t rx_bytes;      // Bytes received, including realtime characters
+        uint32_t rx_lines;      // Lines assembled
+        uint32_t realtime;      // Realtime characters handled
+        uint32_t dropped;       // Bytes lost because the input queue was full
+        uint32_t tx_bytes;      // Bytes of responses and messages sent
+        uint32_t tx_lines;      // Responses and messages sent
+        uint32_t acks;          // Lines acknowledged
+        uint32_t ack_max_us;    // Longest time from assembling a line to acknowledging it
+        uint64_t ack_total_us;  // Sum of those times, for the mean
+        uint32_t connects;      // Times the transport connected
+    };
+
+protected:
+    Stats    _stats      = {};
+    uint32_t _line_ticks = 0;  // When the line awaiting its ack was assembled
+
+    void lineReceived();
+
     UTF8 _utf8;
 
     bool _ended   = false;
@@ -112,9 +163,14 @@ public:
     // a reception buffer, even if the system is busy.  Channels that can handle external
     // input via an interrupt or other background mechanism should override it to return
     // the remaining space that mechanism has available.
-    // The queue can handle more than 256 characters but we don't want it to get too
-    // large, so we report a limited size.
-    virtual int rx_buffer_available() { return std::max(0, 256 - int(_queue.size())); }
+    // Character-counting senders keep this many bytes in flight, so on links with a long
+    // round trip a larger window keeps the planner fed.  It is reported in |Bf:.
+    virtual int rx_buffer_available() { return std::max(0, _rx_window - int(_rx.size())); }
+
+    // setRxWindow() sets the number of bytes reported by rx_buffer_available() when
+    // nothing is queued, enlarging the queue to hold them if necessary.  The queue can
+    // only be enlarged before input arrives, so call it from the constructor.
+    void setRxWindow(int bytes);
 
     // flushRx() discards any characters that have already been received.  It is used
     // after a reset, so that anything already sent will not be processed.
@@ -133,6 +189,11 @@ public:
     // end is seen.
     virtual bool lineComplete(char* line, char c);
 
+    // appendRun() adds the printable ASCII characters at the start of data to the line
+    // in one step, returning how many it took, so that lineComplete() only sees
+    // line ends and other special characters.  It may take none.
+    virtual size_t appendRun(const uint8_t* data, size_t length);
+
     virtual size_t timedReadBytes(char* buffer, size_t length, TickType_t timeout) {
         setTimeout(timeout);
         return readBytes(buffer, length);
@@ -146,6 +207,19 @@ public:
 
     void writeUTF8(uint32_t code);
 
+    // Expander pin commands sent between beginPinBatch() and commitPinBatch() are
+    // collected and sent in one write per channel, so that outputs that change
+    // together cost one UART transfer instead of one per pin.  The expander does
+    // not acknowledge pin writes, so nothing waits for them.  Calls nest; the
+    // outermost commitPinBatch() sends.  PinBatch calls them from a scope.
+    static void beginPinBatch();
+    static void commitPinBatch();
+
+    struct PinBatch {
+        PinBatch() { beginPinBatch(); }
+        ~PinBatch() { commitPinBatch(); }
+    };
+
     bool setCr(bool on) {
         bool retval = _addCR;
         _addCR      = on;
@@ -158,28 +232,52 @@ public:
 
     int peek() override { return -1; }
     int read() override { return -1; }
-    int available() override { return _queue.size(); }
+    int available() override { return _rx.size(); }
 
     virtual void print_msg(MsgLevel level, const char* msg);
 
     void print_msg(MsgLevel level, const std::string& msg) { print_msg(level, msg.c_str()); }
 
+    // Sends a line that already ends with a newline and has passed the level filter.
+    // AllChannels uses it to send one formatted copy of a broadcast to every channel.
+    virtual void print_line(const char* line, size_t length) {
+        _stats.tx_bytes += write(reinterpret_cast<const uint8_t*>(line), length);
+        ++_stats.tx_lines;
+    }
+
+    static constexpr int maxAckBatch = 64;
+
+    int  setAckBatch(int lines);
+    int  getAckBatch() { return _ack_batch; }
+    void flushAcks();
+
     uint32_t     setReportInterval(uint32_t ms);
     uint32_t     getReportInterval() { return _reportInterval; }
+    void         setReportDelta(bool on) {
+        _reportDelta = on;
+        _deltaValid  = false;
+    }
+    bool getReportDelta() { return _reportDelta; }
+
+    // Channels that can carry binary data override these to send a StatusFrame every
+    // ms milliseconds, or not at all if ms is 0.  See StatusFrame.h.
+    virtual bool     setFrameInterval(uint32_t ms) { return false; }
+    virtual uint32_t getFrameInterval() { return 0; }
+
+    // Appends traffic counters, if the channel keeps any, to its entry in $Channels
+    virtual void printStats(Print& out) {}
+
+    const Stats& stats() { return _stats; }
+    void         resetStats() { _stats = {}; }
+
+    // Called by channels whose transport can connect and disconnect, as it connects
+    void connected() { ++_stats.connects; }
     virtual void autoReport();
     void         autoReportGCodeState();
 
     void push(uint8_t byte);
-    void push(const uint8_t* data, size_t length) {
-        while (length--) {
-            push(*data++);
-        }
-    }
-    void push(std::string_view data) {
-        for (auto const& c : data) {
-            push((uint8_t)c);
-        }
-    }
+    void push(const uint8_t* data, size_t length);
+    void push(std::string_view data) { push(reinterpret_cast<const uint8_t*>(data.data()), data.length()); }
     void push(const std::string& s) { push(reinterpret_cast<const uint8_t*>(s.c_str()), s.length()); }
 
     void end() { _ended = true; }
@@ -201,6 +299,15 @@ public:
     virtual size_t position() { return 0; }
     virtual void   set_position(size_t pos) {}
 
+    // prefetch() is called by the polling task while the line it last returned is being
+    // executed, so that a channel that reads from storage can read ahead during that time.
+    virtual void prefetch() {}
+
+    // skip_to_label() moves the read position to the start of the next line whose O word
+    // is o_label, so that flow control can pass over a skipped block without reading it.
+    // It returns false, leaving the position unchanged, if the channel cannot do that.
+    virtual bool skip_to_label(uint32_t o_label) { return false; }
+
     void pause();
     void resume();
 };
@@ -0,0 +1,270 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "CompiledFile.h"
+
+#include "Logging.h"
+
+#include <cctype>
+#include <cstring>
+
+static const char    magic[]      = { 'F', 'N', 'C', 'B', 1 };  // Identifier and format version
+static const char    word_names[] = "XYZABCF";
+static const uint8_t motion_tag   = 0x80;  // Motion record, the low bits say which words follow
+static const uint8_t text_tag     = 0x00;  // Text record, a length byte and the line follow
+static const uint8_t delta_flag   = 0x10;  // In the places byte, the digits are a difference
+static const int     max_digits   = 18;    // Digits that fit in an int64_t
+
+CompiledFile::CompiledFile(const char* defaultFs, const char* path) : InputFile(defaultFs, path) {
+    char header[sizeof(magic)];
+    if (read(header, sizeof(header)) != sizeof(header) || memcmp(header, magic, sizeof(magic))) {
+        throw Error::FsFailedRead;
+    }
+    _start = sizeof(magic);
+    reset();
+}
+
+void CompiledFile::reset() {
+    memset(_previous_places, 0xff, sizeof(_previous_places));
+}
+
+void CompiledFile::set_position(size_t pos) {
+    reset();
+    InputFile::set_position(pos);
+}
+
+bool CompiledFile::is_compiled(const std::string& path) {
+    size_t len = strlen(extension);
+    return path.length() > len && strcasecmp(path.c_str() + path.length() - len, extension) == 0;
+}
+
+// Varints are little-endian groups of 7 bits, with the top bit set on all but the last.
+// Signed values are zigzag encoded first, so that small negative numbers stay short.
+static bool read_varint(FileStream& file, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t b;
+        if (file.read(&b, 1) != 1) {
+            return false;
+        }
+        value |= uint64_t(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static size_t put_varint(uint8_t* out, uint64_t value) {
+    size_t n = 0;
+    for (; value >= 0x80; value >>= 7) {
+        out[n++] = uint8_t(value) | 0x80;
+    }
+    out[n++] = uint8_t(value);
+    return n;
+}
+
+static uint64_t zigzag(int64_t v) {
+    return (uint64_t(v) << 1) ^ uint64_t(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v) {
+    return int64_t(v >> 1) ^ -int64_t(v & 1);
+}
+
+Error CompiledFile::nextLine(char* line, int maxlen, size_t& line_number) {
+    uint8_t tag;
+    if (read(&tag, 1) != 1) {
+        return Error::Eof;
+    }
+    ++line_number;
+
+    if (!(tag & motion_tag)) {
+        uint8_t len;
+        if (read(&len, 1) != 1 || len >= maxlen || read(line, len) != len) {
+            return Error::FsFailedRead;
+        }
+        line[len] = '\0';
+        reset();
+        return Error::Ok;
+    }
+
+    char* p   = line;
+    char* end = line + maxlen;
+    for (int word = 0; word < nWords; word++) {
+        if (!(tag & (1 << word))) {
+            continue;
+        }
+        uint8_t  places;
+        uint64_t digits;
+        if (read(&places, 1) != 1 || !read_varint(*this, digits)) {
+            return Error::FsFailedRead;
+        }
+        int64_t value = unzigzag(digits);
+        if (places & delta_flag) {
+            value += _previous[word];
+        }
+        places &= ~delta_flag;
+        _previous[word]        = value;
+        _previous_places[word] = places;
+
+        // Canonical form: sign, at least one digit before the point, no point for integers
+        char     text[24];
+        uint64_t magnitude = value < 0 ? -uint64_t(value) : uint64_t(value);
+        int      n         = 0;
+        do {
+            text[n++] = char('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude || n <= places);
+        if (end - p < n + 4) {
+            return Error::LineLengthExceeded;
+        }
+        *p++ = word_names[word];
+        if (value < 0) {
+            *p++ = '-';
+        }
+        while (n) {
+            if (n == places) {
+                *p++ = '.';
+            }
+            *p++ = text[--n];
+        }
+    }
+    *p = '\0';
+    return Error::Ok;
+}
+
+// Collapses a line that holds only motion words and fills in its words, or returns false.
+struct MotionWord {
+    int64_t digits;
+    uint8_t places;
+};
+
+static bool parse_motion(const char* line, uint8_t& mask, MotionWord* words) {
+    mask = 0;
+    const char* p = line;
+    while (isspace(*p)) {
+        ++p;
+    }
+    if (!*p) {
+        return false;
+    }
+    while (*p) {
+        const char* name = strchr(word_names, toupper(*p));
+        if (!isalpha(*p) || !name) {
+            return false;
+        }
+        int word = name - word_names;
+        if (mask & (1 << word)) {
+            return false;
+        }
+        ++p;
+        while (isspace(*p)) {
+            ++p;
+        }
+        bool negative = *p == '-';
+        if (*p == '-' || *p == '+') {
+            ++p;
+        }
+        int64_t digits  = 0;
+        int     ndigit  = 0;
+        int     places  = 0;
+        bool    decimal = false;
+        for (;; ++p) {
+            if (isdigit(*p)) {
+                if (++ndigit > max_digits) {
+                    return false;
+                }
+                digits = digits * 10 + (*p - '0');
+                places += decimal;
+            } else if (*p == '.' && !decimal) {
+                decimal = true;
+            } else if (!isspace(*p)) {
+                break;
+            }
+        }
+        if (!ndigit || places > 15) {
+            return false;
+        }
+        mask |= 1 << word;
+        words[word] = { negative ? -digits : digits, uint8_t(places) };
+    }
+    return true;
+}
+
+Error CompiledFile::compile(const char* fsname, const char* source, const char* dest, Channel& out) {
+    InputFile*  in     = nullptr;
+    FileStream* result = nullptr;
+    try {
+        in     = new InputFile(fsname, source);
+        result = new FileStream(dest, "w", fsname);
+    } catch (Error err) {
+        log_error_to(out, "Cannot open " << (in ? dest : source));
+        delete in;
+        return err;
+    }
+
+    int64_t previous[nWords];
+    int     previous_places[nWords];
+    memset(previous_places, 0xff, sizeof(previous_places));
+
+    result->write(reinterpret_cast<const uint8_t*>(magic), sizeof(magic));
+
+    char       line[Channel::maxLine];
+    uint8_t    record[4 + Channel::maxLine];
+    size_t     lines  = 0;
+    size_t     motion = 0;
+    Error      err;
+    MotionWord words[nWords];
+    while ((err = in->readLine(line, Channel::maxLine)) == Error::Ok) {
+        ++lines;
+        uint8_t mask;
+        size_t  len = 0;
+        if (parse_motion(line, mask, words)) {
+            record[len++] = motion_tag | mask;
+            for (int word = 0; word < nWords; word++) {
+                if (!(mask & (1 << word))) {
+                    continue;
+                }
+                auto& w = words[word];
+                if (w.places == previous_places[word]) {
+                    record[len++] = w.places | delta_flag;
+                    len += put_varint(&record[len], zigzag(w.digits - previous[word]));
+                } else {
+                    record[len++] = w.places;
+                    len += put_varint(&record[len], zigzag(w.digits));
+                }
+                previous[word]        = w.digits;
+                previous_places[word] = w.places;
+            }
+            ++motion;
+        } else {
+            const char* start = line;
+            while (isspace(*start)) {
+                ++start;
+            }
+            size_t n = strlen(start);
+            while (n && isspace(start[n - 1])) {
+                --n;
+            }
+            if (!n) {
+                continue;  // Blank lines do nothing
+            }
+            record[len++] = text_tag;
+            record[len++] = uint8_t(n);
+            memcpy(&record[len], start, n);
+            len += n;
+            memset(previous_places, 0xff, sizeof(previous_places));
+        }
+        result->write(record, len);
+    }
+    delete in;
+    delete result;
+
+    if (err != Error::Eof) {
+        log_error_to(out, "Compile failed at line " << lines + 1 << " of " << source);
+        return err;
+    }
+    log_info_to(out, "Compiled " << lines << " lines of " << source << ", " << motion << " to motion records");
+    return Error::Ok;
+}
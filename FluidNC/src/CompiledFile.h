@@ -0,0 +1,52 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  CompiledFile.h - G-code job files converted once into a compact binary form
+
+  $File/Compile converts a G-code file into a .gcb file next to it.  Lines that hold only
+  X, Y, Z, A, B, C and F words become motion records: a byte with a bit for each word
+  present, then for each word its decimal places and its digits as an integer, stored as
+  the difference from the same word in the previous motion record when the decimal places
+  agree.  Raster and finishing files, whose coordinates change by a few digits per line,
+  shrink to a few bytes per line.  Every other line, including comments, is stored as a
+  text record, so messages, parameters and flow control behave as in the source.
+
+  Running a .gcb file decodes each motion record into its canonical collapsed line, with
+  exactly the digits of the source, which the executor takes on its fast path for motion
+  lines.  A text record resets the differences, so a flow control jump, which always lands
+  after an O word line, resumes correctly.  Blank lines are dropped, so line numbers in
+  reports count the records of the compiled file.
+*/
+
+#include "InputFile.h"
+
+#include <cstdint>
+
+class CompiledFile : public InputFile {
+private:
+    static const int nWords = 7;  // X Y Z A B C F
+
+    int64_t _previous[nWords];
+    uint8_t _previous_places[nWords];
+
+    void reset();
+
+protected:
+    Error nextLine(char* line, int len, size_t& line_number) override;
+
+public:
+    static constexpr const char* extension = ".gcb";
+
+    CompiledFile(const char* fsname, const char* path);
+
+    void set_position(size_t pos) override;
+
+    // True if path names a compiled file
+    static bool is_compiled(const std::string& path);
+
+    // Converts the G-code file source into the compiled file dest
+    static Error compile(const char* fsname, const char* source, const char* dest, Channel& out);
+};
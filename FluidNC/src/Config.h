@@ -44,8 +44,27 @@ const int A2_AXIS = (A_AXIS + MAX_N_AXIS);
 const int B2_AXIS = (B_AXIS + MAX_N_AXIS);
 const int C2_AXIS = (C_AXIS + MAX_N_AXIS);
 
+// The built-in cores and priorities of the tasks; the tasks: section can change them, see
+// Machine/Tasks.h
 const int SUPPORT_TASK_CORE = 0;  // Reference: CONFIG_ARDUINO_RUNNING_CORE = 1
 
+// Core and priority of the segment preparation task used when stepping/prep_task is enabled.
+// It runs on the core opposite WiFi, above the main loop, so that G-code parsing and
+// WebUI traffic cannot starve the step segment buffer.
+const int PREP_TASK_CORE     = 1;
+const int PREP_TASK_PRIORITY = 3;
+
+// Core and priority of the task that moves RC servos at step segment boundaries.  The step ISR
+// wakes it, so it runs above the main loop, but below segment preparation.
+const int SERVO_TASK_CORE     = 1;
+const int SERVO_TASK_PRIORITY = 2;
+
+// Events queued from ISRs and other tasks for protocol_handle_events().  An event sent to a
+// full queue is lost and counted, see $Events/Stats.  Urgent events, such as alarms and
+// resets, have a queue of their own that is handled first.
+const int EVENT_QUEUE_SIZE        = 32;
+const int EVENT_URGENT_QUEUE_SIZE = 8;
+
 // Serial baud rate
 // OK to change, but the ESP32 boot text is 115200, so you will not see that is your
 // serial monitor, sender, etc uses a different value than 115200
@@ -140,6 +159,24 @@ const int REPORT_WCO_REFRESH_IDLE_COUNT = 10;  // (2-255) Must be less than or e
 // certain the step segment buffer is increased/decreased to account for these changes.
 const int ACCELERATION_TICKS_PER_SECOND = 100;
 
+// The segment duration is adapted to the ramp state the segment starts in. Segments that start
+// while accelerating or decelerating use RAMP_TICKS_PER_SECOND, so the step rate follows the
+// velocity profile more closely. Segments that start while cruising use CRUISE_TICKS_PER_SECOND,
+// which costs less preparation time at constant speed. A cruise segment that runs into a ramp is
+// cut short at the ramp segment duration. Setting both to ACCELERATION_TICKS_PER_SECOND gives the
+// classic fixed segment duration; ACCELERATION_TICKS_PER_SECOND still sets the increment used to
+// stretch very slow segments until they contain a step.
+// NOTE: Shorter ramp segments store less time in the step segment buffer. If you raise
+// RAMP_TICKS_PER_SECOND considerably, increase stepping/segments to match.
+const int RAMP_TICKS_PER_SECOND   = 200;
+const int CRUISE_TICKS_PER_SECOND = 50;
+
+// Selects the fixed-point step rate computation at the end of every prepped segment (see
+// SegmentTiming.h). It replaces the two float divides and three ceilf() calls per segment with
+// integer arithmetic. Step counts are identical to the float path and step periods agree to within
+// one timer tick. The float path remains the reference implementation.
+const bool USE_FIXED_POINT_SEGMENTS = false;  // Default disabled. Set to true to enable.
+
 // Sets which axis the tool length offset is applied. Assumes the spindle is always parallel with
 // the selected axis with the tool oriented toward the negative direction. In other words, a positive
 // tool length offset value is subtracted from the current location.
@@ -153,6 +190,12 @@ const int TOOL_LENGTH_OFFSET_AXIS = Z_AXIS;  // Default z-axis. Valid values are
 // should not be much greater than zero or to the minimum value necessary for the machine to work.
 const float MINIMUM_JUNCTION_SPEED = 0.0f;  // (mm/min)
 
+// Junctions that deflect the path by less than this (as the cosine of the deflection angle, about
+// 8 degrees) do not break an S-curve run. Consecutive blocks joined by such junctions share one
+// jerk-limited velocity profile computed over their combined length, instead of each block
+// ramping on its own, so chains of short, nearly collinear segments can reach the programmed feed.
+const float S_CURVE_RUN_COS_THETA = 0.99f;
+
 // Sets the minimum feed rate the planner will allow. Any value below it will be set to this minimum
 // value. This also ensures that a planned motion always completes and accounts for any floating-point
 // round-off errors. Although not recommended, a lower value than 1.0 mm/min will likely work in smaller
@@ -165,6 +208,11 @@ const double MINIMUM_FEED_RATE = 1.0;  // (mm/min)
 // bogged down by too many trig calculations.
 const int N_ARC_CORRECTION = 12;  // Integer (1-255)
 
+// In G64 mode the planner rounds each corner between feed moves with chords along a circle that
+// stays within the G64 P tolerance. This caps the number of chords per corner, since every chord
+// is a planner block that uses up look-ahead. Chord count otherwise follows arc_tolerance_mm.
+const int BLEND_MAX_SEGMENTS = 4;  // Integer (1-16)
+
 // The arc G2/3 GCode standard is problematic by definition. Radius-based arcs have horrible numerical
 // errors when arc at semi-circles(pi) or full-circles(2*pi). Offset-based arcs are much more accurate
 // but still have a problem when arcs are full-circles (2*pi). This define accounts for the floating
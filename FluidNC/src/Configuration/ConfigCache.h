@@ -0,0 +1,157 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  ConfigCache.h - binary form of the tokens of a configuration file
+
+  The YAML configuration is parsed on every boot.  After a configuration file has
+  loaded and validated, its tokens are saved beside it, in <file>.cache, so that the
+  next boot can replay them to the parser instead of scanning the text for lines,
+  comments, keys and quotes, and can skip the validation pass that the same tokens
+  already passed.  The cache is keyed by a hash of the firmware version and the text
+  of the file, so any change to either makes the parser read the YAML again and
+  write a new cache.
+
+  The blob is little-endian:
+
+    offset  size  field
+         0     4  magic, "FNCC"
+         4     1  version, 1
+         5     4  hash
+         9        tokens, each:
+                    2  YAML line number, for error messages
+                    1  indent
+                    1  key length, K
+                    2  value length, V
+                    K  key
+                    V  value
+
+  It is header-only so that it can be tested on the host.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Configuration {
+    namespace ConfigCache {
+        const char    magic[]     = "FNCC";
+        const uint8_t version     = 1;
+        const size_t  header_size = 9;
+
+        struct Token {
+            uint32_t         line   = 0;
+            uint32_t         indent = 0;
+            std::string_view key;
+            std::string_view value;
+        };
+
+        // FNV-1a, chained through seed so that several strings can be hashed together
+        inline uint32_t hash(std::string_view data, uint32_t seed = 2166136261u) {
+            uint32_t h = seed;
+            for (char c : data) {
+                h ^= uint8_t(c);
+                h *= 16777619u;
+            }
+            return h;
+        }
+
+        class Writer {
+            std::string _blob;
+            bool        _ok = true;
+
+            void put(uint32_t value, size_t size) {
+                for (size_t i = 0; i < size; i++) {
+                    _blob += char(value >> (8 * i));
+                }
+            }
+
+        public:
+            explicit Writer(uint32_t key) {
+                _blob.append(magic, 4);
+                _blob += char(version);
+                put(key, 4);
+            }
+
+            // A token that does not fit the format means that the configuration cannot be cached
+            void add(const Token& token) {
+                if (token.line > 0xffff || token.indent > 0xff || token.key.size() > 0xff || token.value.size() > 0xffff) {
+                    _ok = false;
+                    return;
+                }
+                put(token.line, 2);
+                put(token.indent, 1);
+                put(uint32_t(token.key.size()), 1);
+                put(uint32_t(token.value.size()), 2);
+                _blob.append(token.key);
+                _blob.append(token.value);
+            }
+
+            bool               ok() const { return _ok; }
+            const std::string& blob() const { return _blob; }
+        };
+
+        class Reader {
+            std::string_view _rest;
+            bool             _valid = false;
+
+            uint32_t get(size_t size) {
+                uint32_t value = 0;
+                for (size_t i = 0; i < size; i++) {
+                    value |= uint32_t(uint8_t(_rest[i])) << (8 * i);
+                }
+                _rest.remove_prefix(size);
+                return value;
+            }
+
+        public:
+            Reader() = default;
+
+            // valid() is false unless blob is a complete cache for key, so that a
+            // truncated file cannot load part of a configuration
+            Reader(std::string_view blob, uint32_t key) : _rest(blob) {
+                if (_rest.size() < header_size || _rest.substr(0, 4) != std::string_view(magic, 4) || uint8_t(_rest[4]) != version) {
+                    return;
+                }
+                _rest.remove_prefix(5);
+                if (get(4) != key) {
+                    return;
+                }
+                _valid = true;
+
+                Reader scan(*this);
+                Token  token;
+                while (scan.next(token)) {}
+                _valid = scan._valid;
+            }
+
+            bool valid() const { return _valid; }
+
+            // Returns false at the end of the tokens
+            bool next(Token& token) {
+                if (!_valid || _rest.empty()) {
+                    return false;
+                }
+                if (_rest.size() < 6) {
+                    _valid = false;
+                    return false;
+                }
+                token.line       = get(2);
+                token.indent     = get(1);
+                size_t key_len   = get(1);
+                size_t value_len = get(2);
+                if (_rest.size() < key_len + value_len) {
+                    _valid = false;
+                    return false;
+                }
+                token.key   = _rest.substr(0, key_len);
+                token.value = _rest.substr(key_len, value_len);
+                _rest.remove_prefix(key_len + value_len);
+                return true;
+            }
+        };
+    }
+}
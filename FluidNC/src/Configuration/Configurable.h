@@ -22,6 +22,11 @@ namespace Configuration {
         virtual void validate() {};
         virtual void group(HandlerBase& handler) = 0;
         virtual void afterParse() {}
+
+        // Called after a runtime setting ($/path=value) changes an item in this
+        // section or in a section below it, while the machine is idle, so that
+        // state that init() derived from the configuration is derived again.
+        virtual void reload() {}
         // virtual const char* name() const = 0;
 
         virtual ~Configurable() {}
@@ -5,6 +5,8 @@
 
 #include <vector>
 #include <sstream>
+#include <cstdio>  // snprintf
+#include <string_view>
 
 #include "src/Pin.h"
 #include "src/Report.h"    // report_gcode_modes()
@@ -42,7 +44,9 @@ namespace Configuration {
     public:
         Generator(Channel& dst, int indent = 0);
 
-        void send_item(const char* name, const std::string& value) {
+        // Each item is formatted straight into a pooled log line, which the channel
+        // queue throttles, so a dump of any size needs no heap per item
+        void send_item(const char* name, std::string_view value) {
             LogStream s(dst_, "");
             lastIsNewline_ = false;
             for (int i = 0; i < indent_ * 2; ++i) {
@@ -52,7 +56,7 @@ namespace Configuration {
             s << ": ";
 
             // If value contains a colon, wrap text as string
-            if (value.find(':') == std::string::npos) {
+            if (value.find(':') == std::string_view::npos) {
                 s << value;
             } else {
                 s << "'";
@@ -61,16 +65,23 @@ namespace Configuration {
             }
         }
 
+        // The same text as std::to_string(), without the allocation
         void item(const char* name, int& value, const int32_t minValue, const int32_t maxValue) override {
-            send_item(name, std::to_string(value));
+            char buf[16];
+            snprintf(buf, sizeof(buf), "%d", value);
+            send_item(name, buf);
         }
 
         void item(const char* name, uint32_t& value, const uint32_t minValue, const uint32_t maxValue) override {
-            send_item(name, std::to_string(value));
+            char buf[16];
+            snprintf(buf, sizeof(buf), "%u", unsigned(value));
+            send_item(name, buf);
         }
 
         void item(const char* name, float& value, const float minValue, const float maxValue) override {
-            send_item(name, std::to_string(value));
+            char buf[48];
+            snprintf(buf, sizeof(buf), "%f", value);
+            send_item(name, buf);
         }
 
         void item(const char* name, std::vector<speedEntry>& value) {
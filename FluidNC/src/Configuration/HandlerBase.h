@@ -78,6 +78,13 @@ namespace Configuration {
             }
         }
 
+        // A section that is a member of its parent, so there is nothing to create
+        void section(const char* name, Configurable& value) {
+            if (handlerType() != HandlerType::Parser || matchesUninitialized(name)) {
+                enterSection(name, &value);
+            }
+        }
+
         template <typename T>
         void enterFactory(const char* name, T& value) {
             enterSection(name, &value);
@@ -16,6 +16,7 @@
 
 namespace Configuration {
     Parser::Parser(std::string_view yaml_string) : Tokenizer(yaml_string) {}
+    Parser::Parser(const ConfigCache::Reader& reader) : Tokenizer(reader) {}
 
     void Parser::parseError(const char* description) const {
         // Attempt to use the correct position in the parser:
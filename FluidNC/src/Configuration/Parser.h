@@ -20,6 +20,7 @@ namespace Configuration {
 
     public:
         explicit Parser(std::string_view yaml_string);
+        explicit Parser(const ConfigCache::Reader& reader);
 
         bool is(const char* expected);
 
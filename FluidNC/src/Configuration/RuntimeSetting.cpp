@@ -55,6 +55,9 @@ namespace Configuration {
                 // Recurse to handle child nodes
                 start_ = residue;
                 value->group(*this);
+                if (isHandled_ && !newValue_.empty()) {
+                    changed_.push_back(value);
+                }
             }
 
             // Restore situation:
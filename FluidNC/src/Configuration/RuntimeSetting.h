@@ -50,6 +50,9 @@ namespace Configuration {
 
         bool isHandled_ = false;
 
+        // The sections that hold a changed item, innermost first, for reload()
+        std::vector<Configuration::Configurable*> changed_;
+
         virtual ~RuntimeSetting();
     };
 }
@@ -12,6 +12,7 @@
 namespace Configuration {
 
     Tokenizer::Tokenizer(std::string_view yaml_string) : _remainder(yaml_string), _linenum(0), _token() {}
+    Tokenizer::Tokenizer(const ConfigCache::Reader& reader) : _replay(true), _reader(reader), _linenum(0), _token() {}
 
     bool Tokenizer::isWhiteSpace(char c) {
         return c == ' ' || c == '\t' || c == '\f' || c == '\r';
@@ -150,9 +151,26 @@ namespace Configuration {
         // We parse 1 line at a time. Each time we get here, we can assume that the cursor
         // is at the start of the line.
 
-        if (nextLine()) {
+        if (_replay) {
+            ConfigCache::Token t;
+            if (_reader.next(t)) {
+                _linenum       = t.line;
+                _token._indent = t.indent;
+                _token._key    = t.key;
+                _token._value  = t.value;
+                return;
+            }
+        } else if (nextLine()) {
             parseKey();
             parseValue();
+            if (_recorder) {
+                ConfigCache::Token t;
+                t.line   = _linenum;
+                t.indent = _token._indent;
+                t.key    = _token._key;
+                t.value  = _token._value;
+                _recorder->add(t);
+            }
             return;
         }
 
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "TokenState.h"
+#include "ConfigCache.h"
 #include "../Config.h"
 #include <string_view>
 
@@ -13,6 +14,11 @@ namespace Configuration {
     class Tokenizer {
         std::string_view _remainder;
 
+        // Replaying tokens from a configuration cache instead of scanning text
+        bool                 _replay = false;
+        ConfigCache::Reader  _reader;
+        ConfigCache::Writer* _recorder = nullptr;
+
         bool isWhiteSpace(char c);
         bool isIdentifierChar(char c);
         bool nextLine();
@@ -40,6 +46,11 @@ namespace Configuration {
 
     public:
         explicit Tokenizer(std::string_view yaml_string);
+        explicit Tokenizer(const ConfigCache::Reader& reader);
+
+        // Adds each token to recorder
+        void record(ConfigCache::Writer* recorder) { _recorder = recorder; }
+
         void                    Tokenize();
         inline std::string_view key() const { return _token._key; }
     };
@@ -5,6 +5,7 @@
 
 #include "Protocol.h"        // *Event
 #include "Machine/Macros.h"  // macro0Event
+#include "StatusFrame.h"     // pin_bit()
 
 Control::Control() {
     // The SafetyDoor pin must be defined first because it is checked explicity in safety_door_ajar()
@@ -43,6 +44,16 @@ std::string Control::report_status() {
     return ret;
 }
 
+uint32_t Control::pin_mask() {
+    uint32_t mask = 0;
+    for (auto pin : _pins) {
+        if (pin->get()) {
+            mask |= StatusFrame::pin_bit(pin->letter());
+        }
+    }
+    return mask;
+}
+
 bool Control::pins_block_unlock() {
     std::string blockers("FE");  // Fault, E-Stop block unlock and homing
     for (auto pin : _pins) {
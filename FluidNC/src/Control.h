@@ -25,6 +25,7 @@ public:
     bool pins_block_unlock();
 
     std::string report_status();
+    uint32_t    pin_mask();  // Active pins as in StatusFrame::pin_bits()
 
     bool startup_check();
 
@@ -4,6 +4,8 @@
 
 #include "CoolantControl.h"
 #include "System.h"
+#include "Machine/I2SOBus.h"  // I2SOBus::Transaction
+#include "Channel.h"          // Channel::PinBatch
 
 void CoolantControl::init() {
     static bool init_message = true;  // used to show messages only once.
@@ -44,6 +46,8 @@ CoolantState CoolantControl::get_state() {
 }
 
 void CoolantControl::write(CoolantState state) {
+    Machine::I2SOBus::Transaction batch;      // Flood and mist on I2SO change together
+    Channel::PinBatch             expanders;  // and go to an expander in one write
     if (_flood.defined()) {
         bool pinState = state.Flood;
         _flood.synchronousWrite(pinState);
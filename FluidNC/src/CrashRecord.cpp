@@ -0,0 +1,163 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "CrashRecord.h"
+
+#include "Driver/crash_record.h"
+#include "Driver/restart.h"  // restart_was_panic()
+#include "Driver/localfs.h"  // localfsName
+#include "FileStream.h"
+#include "Job.h"             // Job::active()
+#include "Logging.h"
+#include "Machine/Axes.h"    // Machine::Axes::_numberAxis
+#include "NutsBolts.h"       // to_hex()
+#include "Report.h"          // state_name()
+#include "Stepper.h"         // Stepper::executing_line()
+
+#include <cstring>
+#include <string>
+
+namespace {
+    const size_t   max_trace        = 5;
+    const uint32_t max_quick_panics = 3;  // Before the configuration file is skipped
+
+    struct AppRecord {
+        char                state[8];          // As in the status report
+        bool                started;           // setup() was done
+        bool                job;               // A job was running
+        uint8_t             n_trace;           // Entries in trace
+        int32_t             line_number;       // Of the executing block
+        int32_t             job_line;          // Last line read of the job
+        Stepper::TraceEntry trace[max_trace];  // The last segments of the segment trace, oldest first
+    };
+    static_assert(sizeof(AppRecord) <= crash_app_size, "AppRecord does not fit in the crash record");
+
+    bool setup_done = false;
+
+    // Runs in the panic handler
+    void capture(uint8_t* app, size_t size) {
+        AppRecord r = {};
+        strncpy(r.state, state_name(), sizeof(r.state) - 1);
+        r.started     = setup_done;
+        r.line_number = Stepper::executing_line();
+        if (Job::active()) {
+            r.job      = true;
+            r.job_line = Job::source()->lineNumber();
+        }
+        size_t count = Stepper::trace_count();
+        for (size_t i = count > max_trace ? count - max_trace : 0; i < count; i++) {
+            if (Stepper::get_trace_entry(i, r.trace[r.n_trace])) {
+                ++r.n_trace;
+            }
+        }
+        memcpy(app, &r, sizeof(r));
+    }
+
+    AppRecord app_record(const crash_record_t& rec) {
+        AppRecord app;
+        memcpy(&app, rec.app, sizeof(app));
+        return app;
+    }
+
+    void report(const crash_record_t& rec, Channel& out) {
+        auto app = app_record(rec);
+
+        log_stream(out, "[Crash core:" << rec.core << " task:" << rec.task << " uptime:" << rec.uptime_ms << "ms " << rec.reason << "]");
+        log_stream(out,
+                   "[Crash PC:" << to_hex(rec.pc) << " PS:" << to_hex(rec.ps) << " SAR:" << to_hex(rec.sar) << " EXCCAUSE:" << rec.exccause
+                                << " EXCVADDR:" << to_hex(rec.excvaddr) << "]");
+        for (int i = 0; i < 16; i += 4) {
+            std::string regs;
+            for (int j = i; j < i + 4; j++) {
+                regs += " A" + std::to_string(j) + ":" + to_hex(rec.a[j]);
+            }
+            log_stream(out, "[Crash" << regs << "]");
+        }
+
+        std::string backtrace = "Backtrace:";
+        for (int i = 0; i < rec.depth; i++) {
+            backtrace += " ";
+            backtrace += to_hex(rec.backtrace[i][0]);
+            backtrace += ":";
+            backtrace += to_hex(rec.backtrace[i][1]);
+        }
+        if (rec.corrupted) {
+            backtrace += " |<-CORRUPTED";
+        }
+        log_stream(out, "[Crash " << backtrace << "]");
+
+        log_stream(out,
+                   "[Crash state:" << app.state << " line:" << app.line_number << " job:" << (app.job ? "yes" : "no") << " job line:"
+                                   << app.job_line << (app.started ? "" : " during startup") << "]");
+        for (size_t i = 0; i < app.n_trace && i < max_trace; i++) {
+            auto&       entry = app.trace[i];
+            std::string steps;
+            for (int axis = 0; axis < Machine::Axes::_numberAxis; axis++) {
+                steps += axis ? "," : "";
+                steps += std::to_string(entry.steps[axis]);
+            }
+            log_stream(out,
+                       "[Crash segment:" << entry.segment << " time:" << entry.time << " line:" << entry.line_number << " steps:" << steps
+                                         << "]");
+        }
+    }
+}
+
+void CrashRecord::init() {
+    crash_record_set_hook(capture);
+    if (!restart_was_panic()) {
+        return;
+    }
+    auto rec = crash_record_last();
+    if (!rec) {
+        log_error("Restarted after a panic that left no crash record");
+        return;
+    }
+    auto app = app_record(*rec);
+    log_error("Restarted after a panic in " << rec->task << ": " << rec->reason << " at " << to_hex(rec->pc) << " line "
+                                            << app.line_number << ", see $Crash/Show");
+}
+
+void CrashRecord::started() {
+    setup_done = true;
+}
+
+bool CrashRecord::skip_config() {
+    if (!restart_was_panic()) {
+        return false;
+    }
+    auto rec = crash_record_last();
+    if (!rec) {
+        return true;  // Nothing to tell where it happened
+    }
+    return !app_record(*rec).started || rec->quick_panics >= max_quick_panics;
+}
+
+Error CrashRecord::show(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    auto rec = crash_record_last();
+    if (!rec) {
+        log_info_to(out, "No crash record");
+        return Error::Ok;
+    }
+    report(*rec, out);
+    return Error::Ok;
+}
+
+Error CrashRecord::save(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    auto rec = crash_record_last();
+    if (!rec) {
+        log_info_to(out, "No crash record");
+        return Error::Ok;
+    }
+    try {
+        FileStream file(value && *value ? value : "crash.txt", "w", localfsName);
+        report(*rec, file);
+        log_info_to(out, "Crash record saved to " << file.path());
+    } catch (Error err) { return err; }
+    return Error::Ok;
+}
+
+Error CrashRecord::clear(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    crash_record_clear();
+    return Error::Ok;
+}
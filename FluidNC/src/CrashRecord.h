@@ -0,0 +1,33 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include "Error.h"
+#include "WebUI/Authentication.h"  // AuthenticationLevel
+
+class Channel;
+
+// What FluidNC adds to the crash record that the panic handler writes, see
+// Driver/crash_record.h: the machine state, the GCode line being executed, and the
+// last entries of the segment trace.  After the restart, a one-line summary goes to
+// the startup log, and the commands below report the rest when it is wanted.
+class CrashRecord {
+public:
+    // Installs the panic hook, and reports a panic that caused the restart
+    static void init();
+
+    // Marks the end of setup().  A panic before it is blamed on the configuration.
+    static void started();
+
+    // True if the configuration file should not be loaded, because the restart was
+    // caused by a panic during startup, or by several panics soon after restarts
+    static bool skip_config();
+
+    // $Crash/Show, and $Crash/Save[=file], which writes it to a file on the local
+    // filesystem.  The backtrace is in the form that the panic handler prints, so the
+    // esp32_exception_decoder monitor filter decodes it on the host.
+    static Error show(const char* value, AuthenticationLevel auth_level, Channel& out);
+    static Error save(const char* value, AuthenticationLevel auth_level, Channel& out);
+    static Error clear(const char* value, AuthenticationLevel auth_level, Channel& out);
+};
@@ -0,0 +1,100 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  DecimalParser.h - locale-free conversion of G-code decimal numbers
+
+  G-code numbers are an optional sign, digits and at most one decimal point; there is no
+  exponent, since E is a word letter.  parse_decimal() collects the digits into an integer
+  and applies the decimal point with a single correctly rounded float operation whenever
+  both the integer and the power of ten are exact floats, which is the case for up to 7
+  significant digits with up to 10 decimals, so the result equals that of strtof().  Longer
+  numbers fall back to double arithmetic, which is exact up to 15 digits before the final
+  rounding to float.  Digits beyond the 19th are ignored.  It is header-only so that it can
+  be tested and timed on the host.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+// Returns false if there are no digits at line[pos].  Otherwise stores the value in result
+// and leaves pos at the first character after the number.
+inline bool parse_decimal(const char* line, size_t& pos, float& result) {
+    static const float  exact_float[]  = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+    static const double exact_double[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                           1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    const int           max_digits     = 19;  // Digits that fit in a uint64_t
+
+    const char* ptr      = line + pos;
+    bool        negative = *ptr == '-';
+    if (negative || *ptr == '+') {
+        ++ptr;
+    }
+
+    // Most numbers have 9 digits or fewer, which fit in 32-bit arithmetic
+    uint32_t low      = 0;
+    uint64_t mantissa = 0;
+    int      ndigit   = 0;    // Significant digits collected
+    int      exp      = 0;    // Power of ten to apply to the mantissa
+    bool     decimal  = false;
+    bool     any      = false;
+    for (;; ++ptr) {
+        char c = *ptr;
+        if (c >= '0' && c <= '9') {
+            any = true;
+            if (ndigit == 0 && c == '0') {
+                // Leading zeros are not significant
+                exp -= decimal;
+                continue;
+            }
+            if (ndigit < 9) {
+                low = low * 10 + (c - '0');
+            } else if (ndigit < max_digits) {
+                if (ndigit == 9) {
+                    mantissa = low;
+                }
+                mantissa = mantissa * 10 + (c - '0');
+            } else {
+                exp += !decimal;  // Drop the digit, keeping the magnitude
+                continue;
+            }
+            ++ndigit;
+            exp -= decimal;
+        } else if (c == '.' && !decimal) {
+            decimal = true;
+        } else {
+            break;
+        }
+    }
+    if (!any) {
+        return false;
+    }
+    pos = ptr - line;
+
+    float value;
+    if (ndigit <= 9) {
+        mantissa = low;
+    }
+    if (mantissa == 0) {
+        value = 0.0f;
+    } else if (mantissa <= (1u << 24) && exp >= -10 && exp <= 10) {
+        // Both operands are exact, so the one rounding is that of the operation
+        value = exp < 0 ? float(mantissa) / exact_float[-exp] : float(mantissa) * exact_float[exp];
+    } else {
+        double d = double(mantissa);
+        while (exp < -22) {
+            d /= 1e22;
+            exp += 22;
+        }
+        while (exp > 22) {
+            d *= 1e22;
+            exp -= 22;
+        }
+        d     = exp < 0 ? d / exact_double[-exp] : d * exact_double[exp];
+        value = float(d);
+    }
+    result = negative ? -value : value;
+    return true;
+}
@@ -0,0 +1,154 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "DirIndex.h"
+
+#include "Driver/psram.h"  // psram_available()
+#include "Driver/sdspi.h"  // sd_card_serial()
+#include "string_util.h"   // glob_match()
+
+#include <map>
+#include <mutex>
+
+// The listings are shared with the tasks that are reading them, so dropping them
+// from the index never frees a listing that is still in use.  generation counts the
+// invalidations, so that a listing read while something changed is not kept.
+static std::mutex                                  index_mutex;
+static std::map<std::string, DirIndex::ListingPtr> listings;  // By directory path
+static size_t                                      cached_entries = 0;
+static uint32_t                                    generation     = 0;
+static uint32_t                                    sd_serial      = 0;  // Of the card the /sd listings are from
+
+// "/sd" for "/sd/jobs/part.nc"
+static std::string mount_of(const std::filesystem::path& path) {
+    auto it = path.begin();
+    if (it == path.end() || ++it == path.end()) {
+        return "";
+    }
+    return "/" + it->string();
+}
+
+// Called with index_mutex held
+static void drop(const std::string& mount) {
+    for (auto it = listings.begin(); it != listings.end();) {
+        auto& key = it->first;
+        if (mount.empty() || (key.compare(0, mount.length(), mount) == 0 && (key.length() == mount.length() || key[mount.length()] == '/'))) {
+            cached_entries -= it->second->entries.size();
+            it = listings.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    ++generation;
+}
+
+size_t DirIndex::max_entries() {
+    return psram_available() ? 16384 : 1024;
+}
+
+void DirIndex::invalidate(const std::filesystem::path& path) {
+    std::lock_guard<std::mutex> lock(index_mutex);
+    drop(mount_of(path));
+}
+
+void DirIndex::invalidate_all() {
+    std::lock_guard<std::mutex> lock(index_mutex);
+    drop("");
+}
+
+DirIndex::ListingPtr DirIndex::list_path(const std::filesystem::path& dir, std::error_code& ec) {
+    std::string key = dir.string();
+    if (key.length() > 1 && key.back() == '/') {
+        key.pop_back();
+    }
+    std::string mount = mount_of(dir);
+
+    uint32_t start_generation;
+    {
+        std::lock_guard<std::mutex> lock(index_mutex);
+        if (mount == "/sd") {
+            // The card might have been changed while it was unmounted
+            uint32_t serial = sd_card_serial();
+            if (serial != sd_serial) {
+                drop(mount);
+                sd_serial = serial;
+            }
+        }
+        auto it = listings.find(key);
+        if (it != listings.end()) {
+            return it->second;
+        }
+        start_generation = generation;
+    }
+
+    auto iter = stdfs::directory_iterator { dir, ec };
+    if (ec) {
+        return nullptr;
+    }
+    auto listing = std::make_shared<Listing>();
+    for (auto const& dir_entry : iter) {
+        std::error_code entry_ec;
+        Entry           entry;
+        entry.name   = listing->names.length();
+        entry.is_dir = dir_entry.is_directory(entry_ec);
+        entry.size   = entry.is_dir ? 0 : dir_entry.file_size(entry_ec);
+        entry.mtime  = dir_entry.last_write_time(entry_ec).time_since_epoch().count();
+        if (entry_ec) {
+            entry.mtime = 0;
+        }
+        listing->names += dir_entry.path().filename().string();
+        listing->names += '\0';
+        listing->entries.push_back(entry);
+    }
+    listing->entries.shrink_to_fit();
+    listing->names.shrink_to_fit();
+
+    std::lock_guard<std::mutex> lock(index_mutex);
+    size_t                      n = listing->entries.size();
+    if (generation == start_generation && n <= max_entries()) {
+        if (cached_entries + n > max_entries()) {
+            drop("");
+        }
+        listings[key] = listing;
+        cached_entries += n;
+    }
+    return listing;
+}
+
+DirIndex::ListingPtr DirIndex::list(const FluidPath& dir, std::error_code& ec) {
+    return list_path(dir, ec);
+}
+
+void DirIndex::find_path(const std::filesystem::path&                                            dir,
+                         const std::string&                                                      prefix,
+                         std::string_view                                                        pattern,
+                         const std::function<void(const std::string& path, const Entry& entry)>& found,
+                         std::error_code&                                                        ec) {
+    auto listing = list_path(dir, ec);
+    if (!listing) {
+        return;
+    }
+    for (auto const& entry : listing->entries) {
+        const char* name = listing->name(entry);
+        if (*name == '.') {
+            continue;
+        }
+        std::string path = prefix + name;
+        if (string_util::glob_match(pattern, name)) {
+            found(path, entry);
+        }
+        if (entry.is_dir) {
+            find_path(dir / name, path + "/", pattern, found, ec);
+            if (ec) {
+                return;
+            }
+        }
+    }
+}
+
+void DirIndex::find(const FluidPath&                                                         dir,
+                    std::string_view                                                         pattern,
+                    const std::function<void(const std::string& path, const Entry& entry)>& found,
+                    std::error_code&                                                         ec) {
+    find_path(dir, "", pattern, found, ec);
+}
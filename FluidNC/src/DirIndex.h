@@ -0,0 +1,62 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include "FluidPath.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A cache of directory listings, so that listing or searching a directory of an SD
+// card with thousands of files does not read and stat every entry each time.  A
+// directory is read when it is first listed, and the listings of a filesystem are
+// dropped whenever something on it is written, deleted or renamed, and for the SD
+// card, when a different card is mounted.
+class DirIndex {
+public:
+    struct Entry {
+        uint32_t name;   // Offset of the name in Listing::names
+        bool     is_dir;
+        uint32_t size;
+        int64_t  mtime;
+    };
+    struct Listing {
+        std::vector<Entry> entries;
+        std::string        names;  // NUL-terminated, in the order of entries
+
+        const char* name(const Entry& entry) const { return names.c_str() + entry.name; }
+    };
+    using ListingPtr = std::shared_ptr<const Listing>;
+
+    // The entries of dir, or nullptr with ec set if it cannot be read.  The listing
+    // stays valid while it is held, even if the index drops it.
+    static ListingPtr list(const FluidPath& dir, std::error_code& ec);
+
+    // Calls found with the path relative to dir of each file below dir, and of each
+    // subdirectory, whose name matches the glob pattern.  Hidden entries are skipped.
+    static void find(const FluidPath&                                                         dir,
+                     std::string_view                                                         pattern,
+                     const std::function<void(const std::string& path, const Entry& entry)>& found,
+                     std::error_code&                                                         ec);
+
+    // Drops the listings of the filesystem that path is on, after a change to it
+    static void invalidate(const std::filesystem::path& path);
+    static void invalidate_all();
+
+private:
+    // The entries kept for all directories together.  A directory with more than
+    // this is read every time.
+    static size_t max_entries();
+
+    static ListingPtr list_path(const std::filesystem::path& dir, std::error_code& ec);
+    static void       find_path(const std::filesystem::path&                                            dir,
+                                const std::string&                                                      prefix,
+                                std::string_view                                                        pattern,
+                                const std::function<void(const std::string& path, const Entry& entry)>& found,
+                                std::error_code&                                                        ec);
+};
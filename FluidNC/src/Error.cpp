@@ -5,7 +5,7 @@
 
 #include "Error.h"
 
-const std::map<Error, const char*> ErrorNames = {
+static constexpr auto error_names = sorted_table<Error, const char*>({
     { Error::Ok, "No error" },
     { Error::ExpectedCommandLetter, "Expected GCodecommand letter" },
     { Error::BadNumberFormat, "Bad GCode number format" },
@@ -89,4 +89,5 @@ const std::map<Error, const char*> ErrorNames = {
     { Error::FlowControlStackOverflow, "Flow Control Stack Overflow" },
     { Error::ParameterAssignmentFailed, "Parameter Assignment Failed" },
     { Error::GcodeValueWordInvalid, "Gcode invalid word value" },
-};
+});
+const FlatMap<Error, const char*> ErrorNames(error_names);
@@ -5,7 +5,7 @@
 
 #pragma once
 
-#include <map>
+#include "FlatMap.h"
 #include <cstdint>
 
 // Error codes. Valid values (0-255)
@@ -98,4 +98,4 @@ enum class Error : uint8_t {
 
 const char* errorString(Error errorNumber);
 
-extern const std::map<Error, const char*> ErrorNames;
+extern const FlatMap<Error, const char*> ErrorNames;
@@ -3,19 +3,50 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+
 // Objects derived from the Event base class are placed in the event queue.
 // Protocol dequeues them and calls their run methods.
 class Event {
 public:
-    Event() {}
+    // How a send of the event is queued, see protocol_send_event()
+    enum class Queue : uint8_t {
+        Normal,
+        Urgent,     // Ahead of the normal events, and not lost when they fill their queue
+        Latest,     // Merged into a waiting send, which then runs with the last arg
+        Increment,  // Merged into a waiting send, which then runs with the sum of the args
+    };
+
+    explicit Event(Queue queue = Queue::Normal, int32_t reset = 0) : _queue(queue), _reset(reset) {}
     virtual void run(void* arg) const = 0;
+
+    const Queue   _queue;
+    const int32_t _reset;  // For Increment, an arg that discards the sum before it
+
+    // The sends merged into the waiting one, for Latest and Increment: a waiting flag, a
+    // reset flag and the arg or the sum.  Plain data, because ISRs send events.
+    mutable std::atomic<uint32_t> _merged { 0 };
+};
+
+// Time from the detection of an input change to the run of the event that acts on it,
+// in CPU cycles.  Reported by $Events/Stats.
+struct EventLatency {
+    static const int n_bins   = 10;
+    static const int bin0_max = 64;  // Microseconds; bin n < bin0_max << n, the last bin is everything longer
+
+    uint32_t count     = 0;
+    uint32_t max_ticks = 0;
+    uint32_t histogram[n_bins] = { 0 };
+
+    void record(uint32_t ticks);
 };
 
 class NoArgEvent : public Event {
     void (*_function)() = nullptr;
 
 public:
-    explicit NoArgEvent(void (*function)()) : _function(function) {}
+    explicit NoArgEvent(void (*function)(), Queue queue = Queue::Normal) : Event(queue), _function(function) {}
     void run(void* arg) const override {
         if (_function) {
             _function();
@@ -27,7 +58,8 @@ class ArgEvent : public Event {
     void (*_function)(void*) = nullptr;
 
 public:
-    explicit ArgEvent(void (*function)(void*)) : _function(function) {}
+    explicit ArgEvent(void (*function)(void*), Queue queue = Queue::Normal, int32_t reset = 0) :
+        Event(queue, reset), _function(function) {}
     void run(void* arg) const override {
         if (_function) {
             _function(arg);
@@ -28,6 +28,10 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #define DEGRAD (180 / M_PI)
 #define RADDEG (M_PI / 180)
@@ -680,21 +684,18 @@ Error read_unary(const char* line, size_t& pos, float& value) {
     return execute_unary(value, operation);
 }
 
-/*! \brief Evaluate expression and set result if successful.
+/*! \brief Evaluate expression text directly, for expressions that could not be compiled.
 
 \param line pointer to RS274/NGC code (block).
 \param pos offset into line where expression starts.
 \param value pointer to float where result is to be stored.
 \returns #Error::Ok enum value if evaluated without error, appropriate \ref Error enum value if not.
 */
-Error expression(const char* line, size_t& pos, float& value) {
+static Error evaluate(const char* line, size_t& pos, float& value) {
     float           values[MAX_STACK];
     ngc_binary_op_t operators[MAX_STACK];
     uint_fast8_t    stack_index = 1;
 
-    if (line[pos] != '[')
-        return Error::GcodeUnsupportedCommand;
-
     pos++;
 
     Error status;
@@ -737,3 +738,333 @@ Error expression(const char* line, size_t& pos, float& value) {
 
     return Error::Ok;
 }
+
+// Expressions are compiled on first sight into a postfix program that
+// evaluates operands and operators in the same order as evaluate(), so
+// the results and errors are identical.  Programs are cached by their
+// text, so expressions in loop bodies and subroutines are parsed once.
+
+#define MAX_PROGRAM_STACK 16
+#define MAX_PROGRAMS 32
+
+typedef enum : uint8_t {
+    Step_Number,    // Push value
+    Step_Param,     // Push the value of refs[index]
+    Step_Indirect,  // Replace the top with the value of the parameter it numbers
+    Step_Exists,    // Push whether names[index] exists
+    Step_Negate,    // Negate the top
+    Step_Unary,     // Apply the unary operation to the top
+    Step_Atan,      // Replace the top two with their ATAN
+    Step_Binary,    // Replace the top two with the result of the binary operation
+} ngc_step_t;
+
+struct expr_step_t {
+    ngc_step_t op;
+    uint8_t    operation = 0;      // ngc_unary_op_t or ngc_binary_op_t
+    bool       nested    = false;  // Binary operation inside an operand, whose errors make the operand invalid
+    float      value     = 0.0f;
+    uint16_t   index     = 0;
+};
+
+struct expr_program_t {
+    std::vector<expr_step_t> steps;
+    std::vector<param_ref_t> refs;
+    std::vector<std::string> names;
+    size_t                   depth     = 0;
+    size_t                   max_depth = 0;
+};
+
+static std::map<std::string, expr_program_t, std::less<>> programs;
+
+static void emit(expr_program_t& program, const expr_step_t& step) {
+    switch (step.op) {
+        case Step_Number:
+        case Step_Param:
+        case Step_Exists:
+            if (++program.depth > program.max_depth) {
+                program.max_depth = program.depth;
+            }
+            break;
+        case Step_Atan:
+        case Step_Binary:
+            --program.depth;
+            break;
+        default:
+            break;
+    }
+    program.steps.push_back(step);
+}
+
+static bool compile_expression(const char* line, size_t& pos, expr_program_t& program, bool nested);
+
+// Like get_param_ref() followed by get_param(), with the initial # already consumed
+static bool compile_param(const char* line, size_t& pos, expr_program_t& program) {
+    char c = line[pos];
+
+    switch (c) {
+        case '#':
+            ++pos;
+            if (!compile_param(line, pos, program)) {
+                return false;
+            }
+            break;
+        case '[':
+            if (!compile_expression(line, pos, program, true)) {
+                return false;
+            }
+            break;
+        case '<': {
+            param_ref_t param_ref;
+            ++pos;
+            while ((c = line[pos]) && c != '>') {
+                ++pos;
+                if (!isspace(c)) {
+                    param_ref.name += toupper(c);
+                }
+            }
+            if (!c || param_ref.name.empty()) {
+                return false;
+            }
+            ++pos;
+            program.refs.push_back(param_ref);
+            emit(program, { Step_Param, 0, false, 0.0f, uint16_t(program.refs.size() - 1) });
+            return true;
+        }
+        default: {
+            float result;
+            if (!read_float(line, pos, result)) {
+                return false;
+            }
+            param_ref_t param_ref;
+            param_ref.id = result;
+            program.refs.push_back(param_ref);
+            emit(program, { Step_Param, 0, false, 0.0f, uint16_t(program.refs.size() - 1) });
+            return true;
+        }
+    }
+    emit(program, { Step_Indirect });
+    return true;
+}
+
+// Like read_unary()
+static bool compile_unary(const char* line, size_t& pos, expr_program_t& program) {
+    ngc_unary_op_t operation;
+
+    if (read_operation_unary(line, pos, operation) != Error::Ok || line[pos] != '[') {
+        return false;
+    }
+    if (operation == Unary_Exists) {
+        ++pos;
+        std::string arg;
+        char        c;
+        while ((c = line[pos]) && c != ']') {
+            ++pos;
+            arg += c;
+        }
+        if (!c) {
+            return false;
+        }
+        ++pos;
+        program.names.push_back(arg);
+        emit(program, { Step_Exists, 0, false, 0.0f, uint16_t(program.names.size() - 1) });
+        return true;
+    }
+    if (!compile_expression(line, pos, program, true)) {
+        return false;
+    }
+    if (operation == Unary_ATAN) {
+        if (line[pos] != '/' || line[++pos] != '[' || !compile_expression(line, pos, program, true)) {
+            return false;
+        }
+        emit(program, { Step_Atan });
+        return true;
+    }
+    emit(program, { Step_Unary, uint8_t(operation) });
+    return true;
+}
+
+// Like read_number() with in_expression true
+static bool compile_operand(const char* line, size_t& pos, expr_program_t& program) {
+    char c = line[pos];
+
+    if (c == '#') {
+        ++pos;
+        return compile_param(line, pos, program);
+    }
+    if (c == '[') {
+        return compile_expression(line, pos, program, true);
+    }
+    if (isalpha(c)) {
+        return compile_unary(line, pos, program);
+    }
+    if (c == '-') {
+        ++pos;
+        if (!compile_operand(line, pos, program)) {
+            return false;
+        }
+        emit(program, { Step_Negate });
+        return true;
+    }
+    if (c == '+') {
+        ++pos;
+        return compile_operand(line, pos, program);
+    }
+    float result;
+    if (!read_float(line, pos, result)) {
+        return false;
+    }
+    emit(program, { Step_Number, 0, false, result });
+    return true;
+}
+
+// Like evaluate(), emitting each operation where evaluate() would perform it
+static bool compile_expression(const char* line, size_t& pos, expr_program_t& program, bool nested) {
+    ngc_binary_op_t operators[MAX_STACK];
+    uint_fast8_t    stack_index = 1;
+
+    if (line[pos] != '[')
+        return false;
+
+    pos++;
+
+    if (!compile_operand(line, pos, program) || read_operation(line, pos, operators[0]) != Error::Ok)
+        return false;
+
+    for (; operators[0] != Binary_RightBracket;) {
+        if (stack_index >= MAX_STACK || !compile_operand(line, pos, program) ||
+            read_operation(line, pos, operators[stack_index]) != Error::Ok)
+            return false;
+
+        if (precedence(operators[stack_index]) > precedence(operators[stack_index - 1]))
+            stack_index++;
+        else {  // precedence of latest operator is <= previous precedence
+            for (; precedence(operators[stack_index]) <= precedence(operators[stack_index - 1]);) {
+                emit(program, { Step_Binary, uint8_t(operators[stack_index - 1]), nested });
+
+                operators[stack_index - 1] = operators[stack_index];
+                if ((stack_index > 1) && precedence(operators[stack_index - 1]) <= precedence(operators[stack_index - 2]))
+                    stack_index--;
+                else
+                    break;
+            }
+        }
+    }
+
+    return true;
+}
+
+static Error run(expr_program_t& program, float& value) {
+    float  stack[MAX_PROGRAM_STACK];
+    size_t sp = 0;
+
+    for (auto const& step : program.steps) {
+        Error status = Error::Ok;
+
+        switch (step.op) {
+            case Step_Number:
+                stack[sp++] = step.value;
+                break;
+            case Step_Param: {
+                auto const& param_ref = program.refs[step.index];
+                if (!get_param(param_ref, stack[sp++])) {
+                    log_debug("Undefined parameter " << param_ref.name);
+                    return Error::BadNumberFormat;
+                }
+            } break;
+            case Step_Indirect: {
+                param_ref_t param_ref;
+                param_ref.id = stack[sp - 1];
+                if (!get_param(param_ref, stack[sp - 1])) {
+                    log_debug("Undefined parameter " << param_ref.id);
+                    return Error::BadNumberFormat;
+                }
+            } break;
+            case Step_Exists:
+                stack[sp++] = named_param_exists(program.names[step.index]) ? 1.0 : 0.0;
+                break;
+            case Step_Negate:
+                stack[sp - 1] = -stack[sp - 1];
+                break;
+            case Step_Unary:
+                if (execute_unary(stack[sp - 1], ngc_unary_op_t(step.operation)) != Error::Ok) {
+                    return Error::BadNumberFormat;
+                }
+                break;
+            case Step_Atan:
+                --sp;
+                stack[sp - 1] = atan2f(stack[sp - 1], stack[sp]) * DEGRAD; /* value in radians, convert to degrees */
+                break;
+            case Step_Binary:
+                --sp;
+                if ((status = execute_binary(stack[sp - 1], ngc_binary_op_t(step.operation), stack[sp])) != Error::Ok) {
+                    if (!step.nested) {
+                        return status;
+                    }
+                    log_debug(errorString(status));
+                    return Error::BadNumberFormat;
+                }
+                break;
+        }
+    }
+
+    value = stack[0];
+
+    return Error::Ok;
+}
+
+// Returns the length of the bracketed expression at line, or 0 if it is unterminated
+static size_t expression_length(const char* line) {
+    size_t depth = 0;
+    for (size_t i = 0; line[i]; ++i) {
+        switch (line[i]) {
+            case '[':
+                ++depth;
+                break;
+            case ']':
+                if (--depth == 0) {
+                    return i + 1;
+                }
+                break;
+            case '<':  // Parameter names may contain brackets
+                while (line[i + 1] && line[i + 1] != '>') {
+                    ++i;
+                }
+                break;
+        }
+    }
+    return 0;
+}
+
+/*! \brief Evaluate expression and set result if successful.
+
+\param line pointer to RS274/NGC code (block).
+\param pos offset into line where expression starts.
+\param value pointer to float where result is to be stored.
+\returns #Error::Ok enum value if evaluated without error, appropriate \ref Error enum value if not.
+*/
+Error expression(const char* line, size_t& pos, float& value) {
+    if (line[pos] != '[')
+        return Error::GcodeUnsupportedCommand;
+
+    size_t length = expression_length(line + pos);
+    if (length) {
+        std::string_view text(line + pos, length);
+
+        auto it = programs.find(text);
+        if (it == programs.end()) {
+            expr_program_t program;
+            size_t         end = pos;
+            if (compile_expression(line, end, program, false) && end == pos + length && program.max_depth <= MAX_PROGRAM_STACK) {
+                if (programs.size() >= MAX_PROGRAMS) {
+                    programs.clear();
+                }
+                it = programs.emplace(text, std::move(program)).first;
+            }
+        }
+        if (it != programs.end()) {
+            pos += length;
+            return run(it->second, value);
+        }
+    }
+    return evaluate(line, pos, value);
+}
@@ -2,14 +2,20 @@
 // Copyright (c) 2014 Luc Lebosse. All rights reserved.
 // Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
 
+#include "src/FileCommands.h"
 #include "src/Settings.h"
 #include "src/WebUI/Authentication.h"
 #include "src/Configuration/JsonGenerator.h"
-#include "src/InputFile.h"    // InputFile
-#include "src/Job.h"          // Job::
-#include "src/xmodem.h"       // xmodemReceive(), xmodemTransmit()
-#include "src/Protocol.h"     // pollingPaused
-#include "src/string_util.h"  // split_prefix()
+#include "src/InputFile.h"     // InputFile
+#include "src/CompiledFile.h"  // CompiledFile
+#include "src/GzipFile.h"      // GzipFile
+#include "src/Job.h"           // Job::
+#include "src/JobQueue.h"      // JobQueue::
+#include "src/Resume.h"        // Resume::seek
+#include "src/xmodem.h"        // xmodemReceive(), xmodemTransmit()
+#include "src/Protocol.h"      // pollingPaused
+#include "src/string_util.h"   // split_prefix(), glob_match()
+#include "src/DirIndex.h"      // DirIndex::
 
 #include "src/HashFS.h"
 
@@ -34,11 +40,12 @@ static Error formatLocalFS(const char* parameter, AuthenticationLevel auth_level
     if (localfs_format(parameter)) {
         return Error::FsFailedFormat;
     }
+    DirIndex::invalidate_all();
     log_info("Local filesystem formatted to " << localfsName);
     return Error::Ok;
 }
 
-static Error openFile(const char* fs, const char* parameter, Channel& out, InputFile*& theFile) {
+Error openFile(const char* fs, const char* parameter, Channel& out, InputFile*& theFile) {
     if (*parameter == '\0') {
         log_string(out, "Missing file name!");
         return Error::InvalidValue;
@@ -49,7 +56,13 @@ static Error openFile(const char* fs, const char* parameter, Channel& out, Input
     }
 
     try {
-        theFile = new InputFile(fs, path.c_str());
+        if (CompiledFile::is_compiled(path)) {
+            theFile = new CompiledFile(fs, path.c_str());
+        } else if (GzipFile::is_gzip(path)) {
+            theFile = new GzipFile(fs, path.c_str());
+        } else {
+            theFile = new InputFile(fs, path.c_str());
+        }
     } catch (Error err) { return err; }
     return Error::Ok;
 }
@@ -244,15 +257,26 @@ static Error fileSendJson(const char* parameter, AuthenticationLevel auth_level,
     return err;
 }
 
-static Error runFile(const char* fs, const char* parameter, AuthenticationLevel auth_level, Channel& out) {
+Error startFile(const char* fs, const char* path, size_t start_line, size_t start_offset, Channel& out) {
     Error err;
     if (state_is(State::Alarm) || state_is(State::ConfigAlarm)) {
         log_string(out, "Alarm");
         return Error::IdleError;
     }
+    bool resume = start_line > 1 || start_offset > 0;
+    if (resume && Job::active()) {
+        log_error_to(out, "Only a top level job can start partway through");
+        return Error::InvalidStatement;
+    }
+
     Job::save();
     InputFile* theFile;
-    if ((err = openFile(fs, parameter, out, theFile)) != Error::Ok) {
+    if ((err = openFile(fs, path, out, theFile)) != Error::Ok) {
+        Job::restore();
+        return err;
+    }
+    if (resume && (err = Resume::seek(*theFile, start_line, start_offset, out)) != Error::Ok) {
+        delete theFile;
         Job::restore();
         return err;
     }
@@ -261,6 +285,22 @@ static Error runFile(const char* fs, const char* parameter, AuthenticationLevel
     return Error::Ok;
 }
 
+// " line=N" or " offset=N" after the path starts the file partway through, see Resume.h
+static Error runFile(const char* fs, const char* parameter, AuthenticationLevel auth_level, Channel& out) {
+    std::string path(parameter);
+    std::string s;
+    size_t      start_line   = 0;
+    size_t      start_offset = 0;
+    if (get_param(parameter, "line=", s)) {
+        start_line = atoi(s.c_str());
+    }
+    if (get_param(parameter, "offset=", s)) {
+        start_offset = atoi(s.c_str());
+    }
+    path = path.substr(0, std::min(path.find(" line="), path.find(" offset=")));
+    return startFile(fs, path.c_str(), start_line, start_offset, out);
+}
+
 static Error runSDFile(const char* parameter, AuthenticationLevel auth_level, Channel& out) {  // ESP220
     return runFile("sd", parameter, auth_level, out);
 }
@@ -270,6 +310,25 @@ static Error runLocalFile(const char* parameter, AuthenticationLevel auth_level,
     return runFile("", parameter, auth_level, out);
 }
 
+// $Job/Queue=<path> queues an SD file to run after the others, see JobQueue.h;
+// without a path it shows the queue.
+static Error queueJob(const char* parameter, AuthenticationLevel auth_level, Channel& out) {
+    if (!parameter || !*parameter) {
+        JobQueue::show(out);
+        return Error::Ok;
+    }
+    if (state_is(State::Alarm) || state_is(State::ConfigAlarm)) {
+        log_string(out, "Alarm");
+        return Error::IdleError;
+    }
+    return JobQueue::add("sd", parameter, out);
+}
+
+static Error clearJobQueue(const char* parameter, AuthenticationLevel auth_level, Channel& out) {
+    JobQueue::clear();
+    return Error::Ok;
+}
+
 static Error deleteObject(const char* fs, const char* name, Channel& out) {
     std::error_code ec;
 
@@ -285,6 +344,7 @@ static Error deleteObject(const char* fs, const char* name, Channel& out) {
         } else {
             stdfs::remove(fpath);
         }
+        DirIndex::invalidate(fpath);
         HashFS::delete_file(fpath);
     } catch (std::filesystem::filesystem_error const& ex) {
         log_error_to(out, ex.what());
@@ -338,29 +398,89 @@ static Error listLocalFiles(const char* parameter, AuthenticationLevel auth_leve
     return listFilesystem(localfsName, parameter, auth_level, out);
 }
 
-static Error listFilesystemJSON(const char* fs, const char* value, AuthenticationLevel auth_level, Channel& out) {
+// The JSON listing commands accept " offset=N limit=M" after the path so that a
+// directory with many files can be listed a page at a time.  When more entries
+// follow the page, the "next" member is the offset of the next page.  With
+// " pattern=GLOB", only the names that match the wildcard pattern are listed.
+struct ListPage {
+    std::string path;
+    std::string pattern;
+    size_t      offset = 0;
+    size_t      limit  = 0;  // No limit
+    size_t      index  = 0;
+    bool        more   = false;
+
+    explicit ListPage(const char* parameter) : path(parameter) {
+        std::string s;
+        if (get_param(parameter, "offset=", s)) {
+            offset = atoi(s.c_str());
+        }
+        if (get_param(parameter, "limit=", s)) {
+            limit = atoi(s.c_str());
+        }
+        get_param(parameter, "pattern=", pattern);
+        path = path.substr(0, std::min({ path.find(" offset="), path.find(" limit="), path.find(" pattern=") }));
+    }
+
+    bool matches(const char* name) { return pattern.empty() || string_util::glob_match(pattern, name); }
+
+    // Returns true if the next entry falls on the page
+    bool take() {
+        if (index++ < offset) {
+            return false;
+        }
+        if (limit && index > offset + limit) {
+            more = true;
+        }
+        return !more;
+    }
+
+    void report_next(JSONencoder& j) {
+        if (more) {
+            j.member("next", offset + limit);
+        }
+    }
+};
+
+static Error listFilesystemJSON(const char* fs, const char* parameter, AuthenticationLevel auth_level, Channel& out) {
+    ListPage page(parameter);
     try {
-        FluidPath fpath { value, fs };
-        auto      space = stdfs::space(fpath);
-        auto      iter  = stdfs::directory_iterator { fpath };
+        FluidPath       fpath { page.path, fs };
+        auto            space = stdfs::space(fpath);
+        std::error_code ec;
+        auto            listing = DirIndex::list(fpath, ec);
+        if (!listing) {
+            throw stdfs::filesystem_error { "Cannot list directory", fpath, ec };
+        }
 
         JSONencoder j(false, &out);
         j.begin();
 
         j.begin_array("files");
-        for (auto const& dir_entry : iter) {
+        for (auto const& entry : listing->entries) {
+            const char* name = listing->name(entry);
+            if (!page.matches(name)) {
+                continue;
+            }
+            if (!page.take()) {
+                if (page.more) {
+                    break;
+                }
+                continue;
+            }
             j.begin_object();
-            j.member("name", dir_entry.path().filename());
-            j.member("size", dir_entry.is_directory() ? -1 : dir_entry.file_size());
+            j.member("name", name);
+            j.member("size", entry.is_dir ? -1 : int(entry.size));
             j.end_object();
         }
         j.end_array();
+        page.report_next(j);
 
         auto totalBytes = space.capacity;
         auto freeBytes  = space.available;
         auto usedBytes  = totalBytes - freeBytes;
 
-        j.member("path", value);
+        j.member("path", page.path);
         j.member("total", formatBytes(totalBytes));
         j.member("used", formatBytes(usedBytes + 1));
 
@@ -386,39 +506,47 @@ static Error listLocalFilesJSON(const char* parameter, AuthenticationLevel auth_
 // This is used by pendants to get lists of GCode files
 static Error listGCodeFiles(const char* parameter, AuthenticationLevel auth_level, Channel& out) {  // No ESP command
     const char* error = "";
+    ListPage    page(parameter);
 
     JSONencoder j(true, &out);  // Encapsulated JSON
     j.begin();
 
     std::error_code ec;
 
-    FluidPath fpath { parameter, sdName, ec };
+    FluidPath fpath { page.path, sdName, ec };
     if (ec) {
         error = "No volume";
     }
 
     j.begin_array("files");
     if (!*error) {  // Array is empty for failure to open the volume
-        auto iter = stdfs::directory_iterator { fpath, ec };
-        if (ec) {
+        auto listing = DirIndex::list(fpath, ec);
+        if (!listing) {
             // Array is empty for failure to open the path
             error = "Bad path";
         } else {
-            for (auto const& dir_entry : iter) {
-                auto fn     = dir_entry.path().filename();
-                auto is_dir = dir_entry.is_directory();
-                if (out.is_visible(fn.stem(), fn.extension(), is_dir)) {
+            for (auto const& entry : listing->entries) {
+                const char*           name = listing->name(entry);
+                std::filesystem::path fn { name };
+                if (page.matches(name) && out.is_visible(fn.stem(), fn.extension(), entry.is_dir)) {
+                    if (!page.take()) {
+                        if (page.more) {
+                            break;
+                        }
+                        continue;
+                    }
                     j.begin_object();
-                    j.member("name", dir_entry.path().filename());
-                    j.member("size", is_dir ? -1 : dir_entry.file_size());
+                    j.member("name", name);
+                    j.member("size", entry.is_dir ? -1 : int(entry.size));
                     j.end_object();
                 }
             }
         }
     }
     j.end_array();
+    page.report_next(j);
 
-    j.member("path", parameter);
+    j.member("path", page.path);
     if (*error) {
         j.member("error", error);
     }
@@ -444,6 +572,56 @@ static Error listGCodeFiles(const char* parameter, AuthenticationLevel auth_leve
     return Error::Ok;
 }
 
+// Searches the SD card below the path for the files whose names match the pattern,
+// e.g. $Files/Find=/jobs pattern=*.nc, listing them with paths relative to the path
+static Error findGCodeFiles(const char* parameter, AuthenticationLevel auth_level, Channel& out) {  // No ESP command
+    const char* error = "";
+    ListPage    page(parameter);
+    if (page.pattern.empty()) {
+        page.pattern = "*";
+    }
+
+    JSONencoder j(true, &out);  // Encapsulated JSON
+    j.begin();
+
+    std::error_code ec;
+
+    FluidPath fpath { page.path, sdName, ec };
+    if (ec) {
+        error = "No volume";
+    }
+
+    j.begin_array("files");
+    if (!*error) {
+        DirIndex::find(
+            fpath,
+            page.pattern,
+            [&](const std::string& path, const DirIndex::Entry& entry) {
+                std::filesystem::path fn { path };
+                if (entry.is_dir || page.more || !out.is_visible(fn.stem(), fn.extension(), false) || !page.take()) {
+                    return;
+                }
+                j.begin_object();
+                j.member("name", path);
+                j.member("size", int(entry.size));
+                j.end_object();
+            },
+            ec);
+        if (ec) {
+            error = "Bad path";
+        }
+    }
+    j.end_array();
+    page.report_next(j);
+
+    j.member("path", page.path);
+    if (*error) {
+        j.member("error", error);
+    }
+    j.end();
+    return Error::Ok;
+}
+
 static Error renameObject(const char* fs, const char* parameter, AuthenticationLevel auth_level, Channel& out) {
     if (!parameter || *parameter == '\0') {
         return Error::InvalidValue;
@@ -458,6 +636,8 @@ static Error renameObject(const char* fs, const char* parameter, AuthenticationL
         FluidPath inPath { ipath, fs };
         FluidPath outPath { opath, fs };
         std::filesystem::rename(inPath, outPath);
+        DirIndex::invalidate(inPath);
+        DirIndex::invalidate(outPath);
         HashFS::rename_file(inPath, outPath, true);
     } catch (std::filesystem::filesystem_error const& ex) {
         log_error_to(out, ex.what());
@@ -542,8 +722,18 @@ static Error copyDir(const char* iDir, const char* oDir, Channel& out) {  // No
     return err;
 }
 static Error showLocalFSHashes(const char* parameter, AuthenticationLevel auth_level, Channel& out) {
-    for (const auto& [name, hash] : HashFS::localFsHashes) {
-        log_info_to(out, name << ": " << hash);
+    std::error_code ec;
+    FluidPath       lfspath { "", localfsName, ec };
+    if (ec) {
+        return Error::FsFailedMount;
+    }
+    // hash() can compute missing hashes, which changes the map
+    std::vector<std::string> names;
+    for (const auto& [name, entry] : HashFS::localFsHashes) {
+        names.push_back(name);
+    }
+    for (const auto& name : names) {
+        log_info_to(out, name << ": " << HashFS::hash(lfspath / name));
     }
     return Error::Ok;
 }
@@ -569,6 +759,7 @@ static Error migrateLocalFS(const char* parameter, AuthenticationLevel auth_leve
     if (localfs_format(newfs)) {
         return Error::FsFailedFormat;
     }
+    DirIndex::invalidate_all();
     log_info("Restoring local filesystem contents");
     return copyDir("/sd/localfs", "/localfs", out);
 }
@@ -586,7 +777,23 @@ static Error showSDStatus(const char* parameter, AuthenticationLevel auth_level,
     return Error::Ok;
 }
 
-static Error xmodem_receive(const char* value, AuthenticationLevel auth_level, Channel& out) {
+static Error showReadAheadStats(const char* parameter, AuthenticationLevel auth_level, Channel& out) {
+    auto stats = FileStream::read_ahead_stats();
+    log_info_to(out,
+                "Read ahead blocks:" << stats.fills << " ahead:" << stats.ahead << " stalls:" << stats.stalls
+                                     << " fill us mean:" << stats.mean_fill_us() << " max:" << stats.max_fill_us);
+    return Error::Ok;
+}
+
+static Error showWriteBehindStats(const char* parameter, AuthenticationLevel auth_level, Channel& out) {
+    auto stats = FileStream::write_behind_stats();
+    log_info_to(out,
+                "Write behind blocks:" << stats.writes << " bytes:" << stats.bytes << " stalls:" << stats.stalls
+                                       << " write us mean:" << stats.mean_write_us() << " max:" << stats.max_write_us);
+    return Error::Ok;
+}
+
+static Error receive_file(const char* value, Channel& out, bool streaming) {
     if (!value || !*value) {
         value = "uploaded";
     }
@@ -601,7 +808,7 @@ static Error xmodem_receive(const char* value, AuthenticationLevel auth_level, C
     pollingPaused = true;
     bool oldCr    = out.setCr(false);
     delay_ms(1000);
-    int size = xmodemReceive(&out, outfile);
+    int size = xmodemReceive(&out, outfile, streaming);
     out.setCr(oldCr);
     pollingPaused = false;
     if (size >= 0) {
@@ -616,6 +823,15 @@ static Error xmodem_receive(const char* value, AuthenticationLevel auth_level, C
     return size < 0 ? Error::UploadFailed : Error::Ok;
 }
 
+static Error xmodem_receive(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    return receive_file(value, out, false);
+}
+
+// Streams without per-block acknowledgements, for USB and network links that do their own error checking
+static Error xmodem_receive_streaming(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    return receive_file(value, out, true);
+}
+
 static Error xmodem_send(const char* value, AuthenticationLevel auth_level, Channel& out) {
     if (!value || !*value) {
         value = "config.yaml";
@@ -641,6 +857,33 @@ static Error xmodem_send(const char* value, AuthenticationLevel auth_level, Chan
     return size < 0 ? Error::DownloadFailed : Error::Ok;
 }
 
+// Writes the compiled form of a G-code file next to it, with the extension .gcb
+static Error compileFile(const char* parameter, AuthenticationLevel auth_level, Channel& out) {
+    if (notIdleOrAlarm()) {
+        return Error::IdleError;
+    }
+    if (!parameter || !*parameter) {
+        log_error_to(out, "Missing file name!");
+        return Error::InvalidValue;
+    }
+    std::string source(parameter);
+    if (source[0] != '/') {
+        source = "/" + source;
+    }
+    if (CompiledFile::is_compiled(source)) {
+        log_error_to(out, "File is already compiled");
+        return Error::InvalidValue;
+    }
+    std::string dest  = source;
+    auto        dot   = dest.rfind('.');
+    auto        slash = dest.rfind('/');
+    if (dot != std::string::npos && dot > slash) {
+        dest.erase(dot);
+    }
+    dest += CompiledFile::extension;
+    return CompiledFile::compile(sdName, source.c_str(), dest.c_str(), out);
+}
+
 static Error restart(const char* parameter, AuthenticationLevel auth_level, Channel& out) {
     log_info("Restarting");
     protocol_send_event(&fullResetEvent);
@@ -653,7 +896,7 @@ void make_file_commands() {
     new WebCommand("path", WEBCMD, WU, NULL, "LocalFS/Show", showLocalFile);
     new WebCommand("path", WEBCMD, WU, "ESP700", "LocalFS/Run", runLocalFile, nullptr);
     new WebCommand("path", WEBCMD, WU, NULL, "LocalFS/List", listLocalFiles);
-    new WebCommand("path", WEBCMD, WU, NULL, "LocalFS/ListJSON", listLocalFilesJSON);
+    new WebCommand("path offset=N limit=M pattern=GLOB", WEBCMD, WU, NULL, "LocalFS/ListJSON", listLocalFilesJSON);
     new WebCommand("path", WEBCMD, WU, NULL, "LocalFS/Delete", deleteLocalFile);
     new WebCommand("path", WEBCMD, WU, NULL, "LocalFS/Rename", renameLocalObject);
     new WebCommand("path", WEBCMD, WU, NULL, "LocalFS/Backup", backupLocalFS);
@@ -664,15 +907,22 @@ void make_file_commands() {
     new WebCommand("path", WEBCMD, WU, NULL, "File/SendJSON", fileSendJson);
     new WebCommand("path", WEBCMD, WU, NULL, "File/ShowSome", fileShowSome);
     new WebCommand("path", WEBCMD, WU, NULL, "File/ShowHash", fileShowHash);
+    new WebCommand("path", WEBCMD, WU, NULL, "File/Compile", compileFile);
     new WebCommand("path", WEBCMD, WU, "ESP221", "SD/Show", showSDFile);
-    new WebCommand("path", WEBCMD, WU, "ESP220", "SD/Run", runSDFile, nullptr);
+    new WebCommand("path line=N offset=N", WEBCMD, WU, "ESP220", "SD/Run", runSDFile, nullptr);
+    new WebCommand("path", WEBCMD, WU, NULL, "Job/Queue", queueJob, nullptr);
+    new WebCommand(NULL, WEBCMD, WU, NULL, "Job/Queue/Clear", clearJobQueue, anyState);
     new WebCommand("file_or_directory_path", WEBCMD, WU, "ESP215", "SD/Delete", deleteSDObject);
     new WebCommand("path", WEBCMD, WU, NULL, "SD/Rename", renameSDObject);
     new WebCommand(NULL, WEBCMD, WU, "ESP210", "SD/List", listSDFiles);
-    new WebCommand("path", WEBCMD, WU, NULL, "SD/ListJSON", listSDFilesJSON);
+    new WebCommand("path offset=N limit=M pattern=GLOB", WEBCMD, WU, NULL, "SD/ListJSON", listSDFilesJSON);
     new WebCommand(NULL, WEBCMD, WU, "ESP200", "SD/Status", showSDStatus);
-    new WebCommand("path", WEBCMD, WU, NULL, "Files/ListGCode", listGCodeFiles);
+    new WebCommand(NULL, WEBCMD, WU, NULL, "SD/ReadStats", showReadAheadStats);
+    new WebCommand(NULL, WEBCMD, WU, NULL, "SD/WriteStats", showWriteBehindStats);
+    new WebCommand("path offset=N limit=M pattern=GLOB", WEBCMD, WU, NULL, "Files/ListGCode", listGCodeFiles);
+    new WebCommand("path pattern=GLOB offset=N limit=M", WEBCMD, WU, NULL, "Files/Find", findGCodeFiles);
     new UserCommand("XR", "Xmodem/Receive", xmodem_receive, allowConfigStates);
+    new UserCommand("XG", "Xmodem/ReceiveStreaming", xmodem_receive_streaming, allowConfigStates);
     new UserCommand("XS", "Xmodem/Send", xmodem_send, notIdleOrAlarm);
 
     new WebCommand("RESTART", WEBCMD, WA, NULL, "Bye", restart);
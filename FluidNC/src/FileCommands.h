@@ -1 +1,16 @@
+#pragma once
+
+#include "Error.h"
+
+#include <cstddef>
+
+class Channel;
+class InputFile;
+
 void make_file_commands();
+
+// Opens a G-code file to run, as $SD/Run does, choosing the reader by the file name
+Error openFile(const char* fs, const char* parameter, Channel& out, InputFile*& theFile);
+
+// Starts a G-code file as a job, at start_line or start_offset when either is set, see Resume.h
+Error startFile(const char* fs, const char* path, size_t start_line, size_t start_offset, Channel& out);
@@ -3,6 +3,199 @@
 
 #include "FileStream.h"
 #include "Machine/MachineConfig.h"  // config->
+#include "Driver/psram.h"           // psram_malloc()
+#include "Driver/sdspi.h"           // sd_dma_malloc()
+#include "Driver/delay_usecs.h"     // getCpuTicks()
+#include "HeapTag.h"                // HeapTag
+#include "DirIndex.h"               // DirIndex::invalidate()
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <mutex>
+
+// One task refills the read-ahead buffers and writes out the write-behind buffers of
+// all open files that use them.  It holds the mutex while it reads or writes, so a
+// file that is unregistered is no longer being served.
+static const int          maxBackgroundFiles = 4;
+static FileStream*        background_files[maxBackgroundFiles];
+static std::mutex         background_mutex;
+static TaskHandle_t       background_task = nullptr;
+static ReadAhead::Stats   last_read_ahead_stats;
+static WriteBehind::Stats last_write_behind_stats;
+static HeapTag            heap_tag("FileStream");
+
+static void background_wait() {
+    vTaskDelay(1);
+}
+
+void FileStream::background_loop(void* unused) {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        bool busy;
+        do {
+            busy = false;
+            std::lock_guard<std::mutex> lock(background_mutex);
+            for (auto file : background_files) {
+                if (file && file->_read_ahead && file->_read_ahead->fill_ahead()) {
+                    busy = true;
+                }
+                if (file && file->_write_behind && file->_write_behind->write_behind()) {
+                    busy = true;
+                }
+            }
+        } while (busy);
+    }
+}
+
+// Called with background_mutex held
+bool FileStream::register_background() {
+    if (!background_task) {
+        Machine::Tasks::get()._fileBuffers.create(background_loop, nullptr, &background_task);
+    }
+    for (auto& file : background_files) {
+        if (!file) {
+            file = this;
+            return true;
+        }
+    }
+    return false;
+}
+
+void FileStream::unregister_background() {
+    std::lock_guard<std::mutex> lock(background_mutex);
+    for (auto& file : background_files) {
+        if (file == this) {
+            file = nullptr;
+        }
+    }
+    if (_read_ahead) {
+        last_read_ahead_stats = _read_ahead->stats();
+    }
+    if (_write_behind) {
+        last_write_behind_stats = _write_behind->stats();
+    }
+}
+
+// Block buffers come from PSRAM if asked for, else from memory that the SD driver can transfer from directly
+static char* alloc_blocks(size_t size, bool psram) {
+    char* buffer = nullptr;
+    if (psram) {
+        buffer = static_cast<char*>(psram_malloc(size));
+    }
+    if (!buffer) {
+        buffer = static_cast<char*>(sd_dma_malloc(size));
+    }
+    return heap_tag.allocated(buffer, size);
+}
+
+size_t FileStream::read_file(void* arg, char* buffer, size_t length) {
+    auto    stream = static_cast<FileStream*>(arg);
+    int32_t start  = getCpuTicks();
+    size_t  count  = fread(buffer, 1, length, stream->_fd);
+    stream->_read_ahead->record_fill_time(uint32_t(getCpuTicks() - start) / ticks_per_us);
+    return count;
+}
+
+size_t FileStream::write_file(void* arg, const char* buffer, size_t length) {
+    auto    stream = static_cast<FileStream*>(arg);
+    int32_t start  = getCpuTicks();
+    size_t  count  = fwrite(buffer, 1, length, stream->_fd);
+    stream->_write_behind->record_write_time(uint32_t(getCpuTicks() - start) / ticks_per_us);
+    return count;
+}
+
+void FileStream::wake_read_ahead() {
+    if (_read_ahead->wants_fill()) {
+        xTaskNotifyGive(background_task);
+    }
+}
+
+void FileStream::enable_read_ahead(size_t block_size, bool psram) {
+    if (_read_ahead || _write_behind || block_size == 0) {
+        return;
+    }
+    _block_bytes  = 2 * block_size;
+    _block_buffer = alloc_blocks(_block_bytes, psram);
+    if (!_block_buffer) {
+        log_debug("No memory to read ahead in " << _fpath.c_str());
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(background_mutex);
+    if (!register_background()) {
+        // Too many files are using background buffers
+        heap_tag.freed(_block_buffer, _block_bytes);
+        free(_block_buffer);
+        _block_buffer = nullptr;
+        return;
+    }
+    _read_ahead = new ReadAhead(_block_buffer, block_size, read_file, this, background_wait);
+    // Blocks are read straight into the buffer instead of through stdio's small one
+    setvbuf(_fd, nullptr, _IONBF, 0);
+    _read_ahead->reset(ftell(_fd));
+    xTaskNotifyGive(background_task);
+}
+
+void FileStream::enable_write_behind(size_t block_size, bool psram) {
+    if (_read_ahead || _write_behind || block_size == 0) {
+        return;
+    }
+    _block_bytes  = 2 * block_size;
+    _block_buffer = alloc_blocks(_block_bytes, psram);
+    if (!_block_buffer) {
+        log_debug("No memory to write behind " << _fpath.c_str());
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(background_mutex);
+    if (!register_background()) {
+        heap_tag.freed(_block_buffer, _block_bytes);
+        free(_block_buffer);
+        _block_buffer = nullptr;
+        return;
+    }
+    _write_behind = new WriteBehind(_block_buffer, block_size, write_file, this, background_wait);
+    // Whole blocks go straight to the filesystem, which writes aligned clusters directly
+    setvbuf(_fd, nullptr, _IONBF, 0);
+    free_write_cache();
+}
+
+void FileStream::free_write_cache() {
+    if (_write_cache) {
+        heap_tag.freed(_write_cache, write_cache_size);
+        free(_write_cache);
+        _write_cache = nullptr;
+    }
+}
+
+bool FileStream::finish_writes() {
+    if (!_write_behind) {
+        return !ferror(_fd);
+    }
+    xTaskNotifyGive(background_task);
+    bool ok = _write_behind->finish();
+    return ok && !ferror(_fd);
+}
+
+ReadAhead::Stats FileStream::read_ahead_stats() {
+    std::lock_guard<std::mutex> lock(background_mutex);
+    for (auto file : background_files) {
+        if (file && file->_read_ahead) {
+            return file->_read_ahead->stats();
+        }
+    }
+    return last_read_ahead_stats;
+}
+
+WriteBehind::Stats FileStream::write_behind_stats() {
+    std::lock_guard<std::mutex> lock(background_mutex);
+    for (auto file : background_files) {
+        if (file && file->_write_behind) {
+            return file->_write_behind->stats();
+        }
+    }
+    return last_write_behind_stats;
+}
 
 std::string FileStream::path() {
     return _fpath.c_str();
@@ -17,6 +210,11 @@ int FileStream::available() {
 }
 
 int FileStream::read() {
+    if (_read_ahead) {
+        int c = _read_ahead->read();
+        wake_read_ahead();
+        return c;
+    }
     char   data;
     size_t res = fread(&data, 1, 1, _fd);
     return res == 1 ? data : -1;
@@ -26,9 +224,18 @@ int FileStream::peek() {
     return -1;
 }
 
-void FileStream::flush() {}
+void FileStream::flush() {
+    if (_write_cache) {
+        fflush(_fd);
+    }
+}
 
 size_t FileStream::read(char* buffer, size_t length) {
+    if (_read_ahead) {
+        size_t count = _read_ahead->read(buffer, length);
+        wake_read_ahead();
+        return count;
+    }
     return fread(buffer, 1, length, _fd);
 }
 
@@ -37,14 +244,36 @@ size_t FileStream::write(uint8_t c) {
 }
 
 size_t FileStream::write(const uint8_t* buffer, size_t length) {
+    if (_write_behind) {
+        bool ok = _write_behind->write(reinterpret_cast<const char*>(buffer), length);
+        if (_write_behind->wants_write()) {
+            xTaskNotifyGive(background_task);
+        }
+        return ok ? length : 0;
+    }
     return fwrite(buffer, 1, length, _fd);
 }
 
+void FileStream::sendLine(MsgLevel level, const char* line) {
+    print_msg(level, line);
+    release_log_line(line);
+}
+void FileStream::sendLine(MsgLevel level, const std::string* line) {
+    print_msg(level, line->c_str());
+    delete line;
+}
+void FileStream::sendLine(MsgLevel level, const std::string& line) {
+    print_msg(level, line.c_str());
+}
+
 size_t FileStream::size() {
     return _size;
 }
 
 size_t FileStream::position() {
+    if (_read_ahead) {
+        return _read_ahead->position();
+    }
     return ftell(_fd);
 }
 
@@ -57,6 +286,22 @@ void FileStream::setup(const char* mode) {
         throw opening ? Error::FsFailedOpenFile : Error::FsFailedCreateFile;
     }
     _size = stdfs::file_size(_fpath);
+
+    // The listings are dropped again when the file is closed, with its final size
+    bool writing = mode[0] == 'w' || mode[0] == 'a';
+    if (writing) {
+        DirIndex::invalidate(_fpath);
+    }
+
+    // Without the cache, stdio's default buffer is small enough that a settings
+    // export or a tool table costs a filesystem write, and often a metadata
+    // update, for every few lines.  If there is no memory, the default is used.
+    if (writing && !_fpath.isSD()) {
+        _write_cache = heap_tag.allocated(static_cast<char*>(malloc(write_cache_size)), write_cache_size);
+        if (_write_cache) {
+            setvbuf(_fd, _write_cache, _IOFBF, write_cache_size);
+        }
+    }
 }
 
 FileStream::FileStream(const char* filename, const char* mode, const char* fs) : Channel(filename), _fpath(filename, fs), _mode(mode) {
@@ -69,11 +314,21 @@ FileStream::FileStream(FluidPath fpath, const char* mode) : Channel("file"), _mo
 }
 
 void FileStream::set_position(size_t pos) {
+    if (_read_ahead) {
+        _read_ahead->suspend();
+        fseek(_fd, pos, SEEK_SET);
+        _read_ahead->reset(pos);
+        wake_read_ahead();
+        return;
+    }
     fseek(_fd, pos, SEEK_SET);
 }
 
 void FileStream::save() {
-    _saved_position = position();
+    _saved_position = FileStream::position();
+    if (_read_ahead) {
+        _read_ahead->suspend();
+    }
     fclose(_fd);
     _fd = nullptr;
 }
@@ -81,14 +336,38 @@ void FileStream::save() {
 void FileStream::restore() {
     _fd = fopen(_fpath.c_str(), _mode);
     if (_fd) {
+        if (_read_ahead) {
+            setvbuf(_fd, nullptr, _IONBF, 0);
+        }
+        if (_write_cache) {
+            setvbuf(_fd, _write_cache, _IOFBF, write_cache_size);
+        }
         fseek(_fd, _saved_position, SEEK_SET);
+        if (_read_ahead) {
+            _read_ahead->reset(_saved_position);
+            wake_read_ahead();
+        }
     } else {
         // XXX need to unwind the job stack somehow
     }
 }
 
 FileStream::~FileStream() {
+    if (_write_behind) {
+        finish_writes();
+    }
+    if (_read_ahead || _write_behind) {
+        unregister_background();
+        delete _read_ahead;
+        delete _write_behind;
+        heap_tag.freed(_block_buffer, _block_bytes);
+        free(_block_buffer);
+    }
     if (_fd) {
-        fclose(_fd);
+        fclose(_fd);  // Commits the write cache
+    }
+    free_write_cache();
+    if (_mode[0] == 'w' || _mode[0] == 'a') {
+        DirIndex::invalidate(_fpath);
     }
 }
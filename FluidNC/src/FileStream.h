@@ -12,6 +12,8 @@
 
 #include "Channel.h"
 #include "FluidPath.h"
+#include "ReadAhead.h"
+#include "WriteBehind.h"
 
 extern "C" {
 #include <stdio.h>
@@ -30,6 +32,26 @@ class FileStream : public Channel {
 
     void setup(const char* mode);
 
+    // Optional double buffer that a background task keeps filled ahead of the reader,
+    // or writes out behind the writer
+    ReadAhead*   _read_ahead   = nullptr;
+    WriteBehind* _write_behind = nullptr;
+    char*        _block_buffer = nullptr;
+    size_t       _block_bytes  = 0;  // Size of _block_buffer, for heap_tag
+
+    // Files written on the local filesystem collect small writes in a larger stdio
+    // buffer, so LittleFS and SPIFFS see whole blocks instead of a write per line
+    static const size_t write_cache_size = 4096;
+    char*               _write_cache     = nullptr;
+    void                free_write_cache();
+
+    static size_t read_file(void* arg, char* buffer, size_t length);
+    static size_t write_file(void* arg, const char* buffer, size_t length);
+    static void   background_loop(void* unused);
+    bool          register_background();
+    void          unregister_background();
+    void          wake_read_ahead();
+
 public:
     FileStream() = default;
     FileStream(std::string filename, const char* mode, const char* defaultFs = "") : FileStream(filename.c_str(), mode, defaultFs) {}
@@ -43,7 +65,7 @@ public:
     int         available() override;
     int         read() override;
     int         peek() override;
-    void        flush() override;
+    void        flush() override;  // Commits the write cache
 
     size_t readBytes(char* buffer, size_t length) { return read((uint8_t*)buffer, length); }
 
@@ -53,9 +75,34 @@ public:
     size_t write(uint8_t c) override;
     size_t write(const uint8_t* buffer, size_t length) override;
 
-    size_t size();
-    size_t position();
-    void   set_position(size_t);
+    // Lines are written by the caller instead of the output task, so a large dump
+    // goes to the file as it is generated, throttled by the file writes, and the
+    // stream can be closed as soon as the last line is sent
+    void sendLine(MsgLevel level, const char* line) override;
+    void sendLine(MsgLevel level, const std::string* line) override;
+    void sendLine(MsgLevel level, const std::string& line) override;
+
+    virtual size_t size();
+    size_t         position() override;
+    void           set_position(size_t) override;
+
+    // Reads through two blocks of block_size bytes, refilled in the background.  If
+    // the blocks cannot be allocated, reads go directly to the file.
+    void enable_read_ahead(size_t block_size, bool psram);
+
+    // Read-ahead statistics for the open file that uses it, or else the last one closed
+    static ReadAhead::Stats read_ahead_stats();
+
+    // Collects writes into two blocks of block_size bytes that are written to the file
+    // in the background.  If the blocks cannot be allocated, writes go directly to the file.
+    void enable_write_behind(size_t block_size, bool psram);
+    bool writes_behind() { return _write_behind; }
+
+    // Waits until everything written has reached the file, returning false if any write failed
+    bool finish_writes();
+
+    // Write-behind statistics for the open file that uses it, or else the last one closed
+    static WriteBehind::Stats write_behind_stats();
 
     // pollLine() is a required method of the Channel class that
     // FileStream implements as a no-op.
@@ -0,0 +1,87 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// FlatMap is a read-only map over a table that is sorted at compile time, for the
+// fixed name tables such as the error and alarm names.  A std::map of the same
+// entries is built on the heap by a static constructor at every boot; a sorted
+// table is constant data in flash, and find() is a binary search.
+//
+//   static constexpr auto names_table = sorted_table<Code, const char*>({
+//       { Code::B, "b" },
+//       { Code::A, "a" },
+//   });
+//   const FlatMap<Code, const char*> Names(names_table);
+//
+// The entries have first and second like std::map's, and find() returns end()
+// for a missing key, so lookups read the same as they did with std::map.
+// Iteration is in key order.  A duplicate key is a compile error.
+//
+// It is header-only so that it can be tested on the host.
+
+#include <cstddef>
+
+template <typename K, typename V>
+struct FlatEntry {
+    K first;
+    V second;
+};
+
+template <typename K, typename V, size_t N>
+struct FlatTable {
+    FlatEntry<K, V> entries[N];
+};
+
+template <typename K, typename V, size_t N>
+constexpr FlatTable<K, V, N> sorted_table(const FlatEntry<K, V> (&entries)[N]) {
+    FlatTable<K, V, N> table {};
+    for (size_t i = 0; i < N; ++i) {
+        // Insertion sort, which is fine for a few dozen entries at compile time
+        size_t j = i;
+        for (; j > 0 && entries[i].first < table.entries[j - 1].first; --j) {
+            table.entries[j] = table.entries[j - 1];
+        }
+        table.entries[j] = entries[i];
+    }
+    for (size_t i = 1; i < N; ++i) {
+        if (!(table.entries[i - 1].first < table.entries[i].first)) {
+            throw "Duplicate key in sorted_table";  // Not a constant expression, so it will not compile
+        }
+    }
+    return table;
+}
+
+template <typename K, typename V>
+class FlatMap {
+    const FlatEntry<K, V>* _entries;
+    size_t                 _size;
+
+public:
+    using entry_type = FlatEntry<K, V>;
+
+    template <size_t N>
+    constexpr FlatMap(const FlatTable<K, V, N>& table) : _entries(table.entries), _size(N) {}
+
+    constexpr const entry_type* begin() const { return _entries; }
+    constexpr const entry_type* end() const { return _entries + _size; }
+    constexpr size_t            size() const { return _size; }
+
+    template <typename Key>
+    constexpr const entry_type* find(const Key& key) const {
+        size_t lo = 0;
+        size_t hi = _size;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (_entries[mid].first < key) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo < _size && !(key < _entries[lo].first)) {
+            return _entries + lo;
+        }
+        return end();
+    }
+};
@@ -11,7 +11,9 @@
 #include "Expression.h"
 #include "Parameters.h"
 #include "Job.h"
+#include "FlatMap.h"
 #include <stack>
+#include <string_view>
 
 #ifndef NGC_STACK_DEPTH
 #    define NGC_STACK_DEPTH 10
@@ -50,7 +52,7 @@ typedef struct {
 
 std::stack<ngc_stack_entry_t> context;
 
-std::map<std::string, ngc_cmd_t, std::less<>> commands = {
+static constexpr auto command_table = sorted_table<std::string_view, ngc_cmd_t>({
     { "IF", Op_If },
     { "ELSEIF", Op_ElseIf },
     { "ELSE", Op_Else },
@@ -65,7 +67,8 @@ std::map<std::string, ngc_cmd_t, std::less<>> commands = {
     { "RETURN", Op_Return },
     { "ALARM", Op_RaiseAlarm },
     { "ERROR", Op_RaiseError },
-};
+});
+static const FlatMap<std::string_view, ngc_cmd_t> commands(command_table);
 
 static Error read_command(const char* line, size_t& pos, ngc_cmd_t& operation) {
     size_t start = pos;
@@ -377,6 +380,10 @@ Error flowcontrol(uint32_t o_label, const char* line, size_t& pos, bool& skip) {
         log_debug(line);
     } else {
         skip = !context.empty() && context.top().skip;
+        // The lines up to the next one with this label are skipped, so seek past them
+        if (skip && Job::active() && context.top().file == Job::source()) {
+            Job::source()->skip_to_label(context.top().o_label);
+        }
     }
 
     return status;
@@ -27,6 +27,8 @@ public:
     // /localfs/foo -> true,  /localfs -> false
     bool hasTail() { return ++(++begin()) != end(); }
 
+    bool isSD() { return _isSD; }
+
 private:
     FluidPath(const char* name, const char* fs, std::error_code*);
 
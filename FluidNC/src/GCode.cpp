@@ -20,6 +20,7 @@
 #include "Machine/MachineConfig.h"
 #include "Parameters.h"
 #include "Flowcontrol.h"
+#include "LineLatency.h"
 
 #include <string.h>  // memset
 #include <math.h>    // sqrt etc.
@@ -92,6 +93,7 @@ gc_modal_t modal_defaults = {
     // CutterCompensation::Disable,
     ToolLengthOffset::Cancel,
     CoordIndex::G54,
+    ControlMode::ExactPath,
     ProgramFlow::Running,
     {}, // 0, // CoolantState::M7,
     SpindleState::Disable,
@@ -115,6 +117,10 @@ void gc_init() {
     gc_state.current_tool   = -1;
     coords[gc_state.modal.coord_select]->get(gc_state.coord_system);
     flowcontrol_init();
+
+    // G49 is the default, so tool center point control ends with a reset
+    config->_kinematics->set_tcp(false);
+    invalidate_mpos_cache();
 }
 
 // Sets g-code parser position in mm. Input in steps. Called by the system abort and hard
@@ -273,6 +279,97 @@ void gc_wco_changed() {
     allChannels.notifyWco();
 }
 
+// Executes a collapsed line that holds only axis words and F, in a G0 or G1 modal state
+// that needs none of the checks and side effects of the general parser: units per minute
+// feed mode, no coordinate rotation and no laser.  The result is the same as that of the
+// general path for such a line, but most streamed jobs consist of lines like this.
+// Returns false, without changing any state, if the line needs the general path.
+static bool gc_execute_motion(const char* line, Error& status) {
+    if (gc_state.skip_blocks || spindle->isRateAdjusted() || gc_state.modal.feed_rate != FeedRate::UnitsPerMin ||
+        (gc_state.modal.motion != Motion::Seek && gc_state.modal.motion != Motion::Linear) ||
+        (gc_state.modal.coord_rotation == CoordinateRotation::Enabled && gc_state.rotation_angle != 0.0f)) {
+        return false;
+    }
+
+    static const char axis_letters[] = "XYZABC";
+
+    auto   n_axis     = Axes::_numberAxis;
+    bool   inches     = gc_state.modal.units == Units::Inches;
+    size_t axis_words = 0;
+    bool   have_feed  = false;
+    float  feed_rate  = gc_state.feed_rate;
+    float  target[MAX_N_AXIS];
+
+    for (size_t pos = 0; line[pos] != '\0';) {
+        char letter = line[pos++];
+        char c      = line[pos];
+        // Parameters and expressions are evaluated by the general path
+        if (!(isdigit(c) || c == '.' || c == '-' || c == '+')) {
+            return false;
+        }
+        float value;
+        if (!read_float(line, pos, value)) {
+            return false;
+        }
+        if (letter == 'F') {
+            if (have_feed || value < 0.0f) {
+                return false;
+            }
+            have_feed = true;
+            feed_rate = inches ? value * MM_PER_INCH : value;
+            continue;
+        }
+        const char* axis_letter = strchr(axis_letters, letter);
+        if (!axis_letter) {
+            return false;
+        }
+        size_t axis = axis_letter - axis_letters;
+        if (axis >= n_axis || bitnum_is_true(axis_words, axis)) {
+            return false;
+        }
+        set_bitnum(axis_words, axis);
+        target[axis] = (inches && axis < A_AXIS) ? value * MM_PER_INCH : value;
+    }
+    if (!axis_words || (gc_state.modal.motion == Motion::Linear && feed_rate == 0.0f)) {
+        return false;
+    }
+
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        if (bitnum_is_false(axis_words, axis)) {
+            target[axis] = gc_state.position[axis];
+        } else if (gc_state.modal.distance == Distance::Absolute) {
+            target[axis] += gc_state.coord_system[axis] + gc_state.coord_offset[axis];
+            if (axis == TOOL_LENGTH_OFFSET_AXIS) {
+                target[axis] += gc_state.tool_length_offset;
+            }
+        } else {
+            target[axis] += gc_state.position[axis];
+        }
+    }
+
+    plan_line_data_t plan_data;
+    memset(&plan_data, 0, sizeof(plan_line_data_t));
+    gc_state.line_number         = 0;
+    gc_state.feed_rate           = feed_rate;
+    plan_data.feed_rate          = feed_rate;
+    plan_data.spindle_speed      = gc_state.spindle_speed;
+    plan_data.spindle            = gc_state.modal.spindle;
+    plan_data.coolant            = gc_state.modal.coolant;
+    plan_data.motion.rapidMotion = gc_state.modal.motion == Motion::Seek;
+    if (gc_state.modal.control == ControlMode::Continuous) {
+        plan_data.blend_tolerance = gc_state.blend_tolerance;
+    }
+
+    mc_linear(target, &plan_data, gc_state.position);
+    if (sys.abort) {
+        status = Error::Reset;
+        return true;
+    }
+    copyAxes(gc_state.position, target);
+    status = Error::Ok;
+    return true;
+}
+
 // Executes one line of NUL-terminated G-Code.
 // The line may contain whitespace and comments, which are first removed,
 // and lower case characters, which are converted to upper case.
@@ -286,9 +383,17 @@ Error gc_execute_line(const char* input_line) {
     }
     strcpy(line, input_line);
 
+    LineLatency::ParseScope latency;  // Stamps the start and the end of the execution
+    params_begin_line();
+
     // Step 0 - remove whitespace and comments and convert to upper case
     collapseGCode(line);
 
+    Error motionStatus;
+    if (gc_execute_motion(line, motionStatus)) {
+        return motionStatus;
+    }
+
     /* -------------------------------------------------------------------------------------
        STEP 1: Initialize parser block struct and copy current g-code state modes. The parser
        updates these modes and commands as the block line is parser and will only be used and
@@ -322,6 +427,7 @@ Error gc_execute_line(const char* input_line) {
     auto    n_axis = Axes::_numberAxis;
     float   coord_data[MAX_N_AXIS];  // Used by WCO-related commands
     uint8_t pValue;                  // Integer value of P word
+    float   blendTolerance = config->_blendTolerance;  // G64 P value, or the default if P is not given
 
     // Determine if the line is a jogging motion or a normal g-code block.
     if (line[0] == '$') {  // NOTE: `$J=` already parsed when passed to this function.
@@ -463,6 +569,35 @@ Error gc_execute_line(const char* input_line) {
                         gc_block.modal.motion = Motion::CcwArc;
                         mg_word_bit           = ModalGroup::MG1;
                         break;
+                    case 5:  // G5 - cubic spline, G5.1 - quadratic spline
+                        axis_command = AxisCommand::MotionMode;
+                        switch (mantissa) {
+                            case 0:
+                                gc_block.modal.motion = Motion::CubicSpline;
+                                break;
+                            case 10:
+                                gc_block.modal.motion = Motion::QuadraticSpline;
+                                break;
+                            default:
+                                return Error::GcodeUnsupportedCommand;  // [Unsupported G5.x command]
+                        }
+                        mantissa    = 0;  // Set to zero to indicate valid non-integer G command.
+                        mg_word_bit = ModalGroup::MG1;
+                        break;
+                    case 33:  // G33 - spindle-synchronized motion
+                        if (!spindle->_encoder) {
+                            log_info("No spindle encoder defined");
+                            return Error::GcodeUnsupportedCommand;  // [Unsupported G command]
+                        }
+                        // Each move is one planner block, which kinematics could split
+                        if (!config->_kinematics->native_arcs()) {
+                            log_info("G33 requires cartesian kinematics");
+                            return Error::GcodeUnsupportedCommand;
+                        }
+                        axis_command          = AxisCommand::MotionMode;
+                        gc_block.modal.motion = Motion::SpindleSync;
+                        mg_word_bit           = ModalGroup::MG1;
+                        break;
                     case 38:  // G38 - probe
                         //only allow G38 "Probe" commands if a probe pin is defined.
                         if (!config->_probe->exists()) {
@@ -591,6 +726,8 @@ Error gc_execute_line(const char* input_line) {
                             gc_block.modal.tool_length = ToolLengthOffset::Cancel;
                         } else if (mantissa == 10) {  // G43.1
                             gc_block.modal.tool_length = ToolLengthOffset::EnableDynamic;
+                        } else if (mantissa == 40) {  // G43.4
+                            gc_block.modal.tool_length = ToolLengthOffset::Tcp;
                         } else {
                             return Error::GcodeUnsupportedCommand;  // [Unsupported G43.x command]
                         }
@@ -626,8 +763,12 @@ Error gc_execute_line(const char* input_line) {
                         if (mantissa != 0) {
                             return Error::GcodeUnsupportedCommand;  // [G61.1 not supported]
                         }
-                        // gc_block.modal.control = ControlMode::ExactPath; // G61
-                        mg_word_bit = ModalGroup::MG13;
+                        gc_block.modal.control = ControlMode::ExactPath;  // G61
+                        mg_word_bit            = ModalGroup::MG13;
+                        break;
+                    case 64:
+                        gc_block.modal.control = ControlMode::Continuous;  // G64
+                        mg_word_bit            = ModalGroup::MG13;
                         break;
                     case 68:
                         gc_block.modal.coord_rotation = CoordinateRotation::Enabled;
@@ -919,8 +1060,13 @@ Error gc_execute_line(const char* input_line) {
                 }
                 // Check for invalid negative values for words F, N, P, T, and S.
                 // NOTE: Negative value check is done here simply for code-efficiency.
-                if (bitmask & (bitnum_to_mask(GCodeWord::F) | bitnum_to_mask(GCodeWord::N) | bitnum_to_mask(GCodeWord::P) |
-                               bitnum_to_mask(GCodeWord::T) | bitnum_to_mask(GCodeWord::S))) {
+                // P is a signed control point offset in G5, so it is allowed once G5 is the motion mode.
+                uint32_t unsigned_words = bitnum_to_mask(GCodeWord::F) | bitnum_to_mask(GCodeWord::N) | bitnum_to_mask(GCodeWord::T) |
+                                          bitnum_to_mask(GCodeWord::S);
+                if (gc_block.modal.motion != Motion::CubicSpline) {
+                    unsigned_words |= bitnum_to_mask(GCodeWord::P);
+                }
+                if (bitmask & unsigned_words) {
                     if (value < 0.0) {
                         return Error::NegativeValue;  // [Word value cannot be negative]
                     }
@@ -990,7 +1136,8 @@ Error gc_execute_line(const char* input_line) {
         if (gc_block.modal.feed_rate == FeedRate::InverseTime) {  // = G93
             // NOTE: G38 can also operate in inverse time, but is undefined as an error. Missing F word check added here.
             if (axis_command == AxisCommand::MotionMode) {
-                if ((gc_block.modal.motion != Motion::None) && (gc_block.modal.motion != Motion::Seek)) {
+                if ((gc_block.modal.motion != Motion::None) && (gc_block.modal.motion != Motion::Seek) &&
+                    (gc_block.modal.motion != Motion::SpindleSync)) {
                     if (bitnum_is_false(value_words, GCodeWord::F)) {
                         return Error::GcodeUndefinedFeedRate;  // [F word missing]
                     }
@@ -1095,7 +1242,7 @@ Error gc_execute_line(const char* input_line) {
         //  - Ignored if L is 0 (Immediate).
         //  - Error if value 0 seconds, and L is not 0 (Immediate).
         if (bitnum_is_true(value_words, GCodeWord::Q)) {
-            if (gc_block.values.q != 0.0) {
+            if (gc_block.values.q <= 0.0) {
                 if (wait_mode != WaitOnInputMode::Immediate) {
                     // Non-immediate waits must have a non-zero timeout
                     return Error::GcodeValueWordInvalid;
@@ -1160,6 +1307,16 @@ Error gc_execute_line(const char* input_line) {
                 return Error::GcodeG43DynamicAxisError;
             }
         }
+        // [G43.4 Errors]: Axis words, or kinematics without tool center point control.
+        //   NOTE: G43.4 keeps the current tool length offset; there is no tool table for H.
+        if (gc_block.modal.tool_length == ToolLengthOffset::Tcp) {
+            if (axis_words) {
+                return Error::GcodeAxisWordsExist;
+            }
+            if (!config->_kinematics->has_tcp()) {
+                return Error::GcodeUnsupportedCommand;
+            }
+        }
     }
     // [15. Coordinate system selection ]: *N/A. Error, if cutter radius comp is active.
     // TODO: Reading the coordinate data may require a buffer sync when the cycle
@@ -1203,7 +1360,16 @@ Error gc_execute_line(const char* input_line) {
             gc_state.rotation_center[Y_AXIS] = 0.0f;
         }
     }
-    // [16. Set path control mode ]: N/A. Only G61. G61.1 and G64 NOT SUPPORTED.
+    // [16. Set path control mode ]: G64 takes an optional P path tolerance. G61.1 NOT SUPPORTED.
+    if (bitnum_is_true(command_words, ModalGroup::MG13) && gc_block.modal.control == ControlMode::Continuous) {
+        if (bitnum_is_true(value_words, GCodeWord::P)) {
+            blendTolerance = gc_block.values.p;
+            if (gc_block.modal.units == Units::Inches) {
+                blendTolerance *= MM_PER_INCH;
+            }
+            clear_bitnum(value_words, GCodeWord::P);
+        }
+    }
     // [17. Set distance mode ]: N/A. Only G91.1. G90.1 NOT SUPPORTED.
     // [18. Set retract mode ]: NOT SUPPORTED.
     // [19. Remaining non-modal actions ]: Check go to predefined position, set G10, or set axis offsets.
@@ -1370,9 +1536,30 @@ Error gc_execute_line(const char* input_line) {
             if (!axis_words) {
                 axis_command = AxisCommand::None;
             }
-            // All remaining motion modes (all but G0 and G80), require a valid feed rate value. In units per mm mode,
-            // the value must be positive. In inverse time mode, a positive value must be passed with each block.
+        } else if (gc_block.modal.motion == Motion::SpindleSync) {
+            // [G33 Errors]: K word missing or not positive. Spindle not turning.
+            // The feed follows the spindle, K per revolution, so no feed rate is needed.
+            // Axis words are optional. If missing, set axis command flag to ignore execution.
+            if (bitnum_is_false(value_words, GCodeWord::K)) {
+                return Error::GcodeValueWordMissing;  // [K word missing]
+            }
+            if (gc_block.values.ijk[Z_AXIS] <= 0.0f) {
+                return Error::GcodeInvalidTarget;  // [K must be positive]
+            }
+            if (gc_block.modal.spindle == SpindleState::Disable || gc_block.values.s == 0.0f) {
+                log_info("G33 needs the spindle to be turning");
+                return Error::GcodeUnsupportedCommand;
+            }
+            if (gc_block.modal.units == Units::Inches) {
+                gc_block.values.ijk[Z_AXIS] *= MM_PER_INCH;
+            }
+            clear_bitnum(value_words, GCodeWord::K);
+            if (!axis_words) {
+                axis_command = AxisCommand::None;
+            }
         } else {
+            // All remaining motion modes (all but G0, G33 and G80), require a valid feed rate value. In units per mm mode,
+            // the value must be positive. In inverse time mode, a positive value must be passed with each block.
             // Check if feed rate is defined for the motion modes that require it.
             if (gc_block.values.f == 0.0) {
                 return Error::GcodeUndefinedFeedRate;  // [Feed rate undefined]
@@ -1382,6 +1569,8 @@ Error gc_execute_line(const char* input_line) {
                     break;  // Feed rate is unnecessary
                 case Motion::Seek:
                     break;  // Feed rate is unnecessary
+                case Motion::SpindleSync:
+                    break;  // Checked above
                 case Motion::Linear:
                     // [G1 Errors]: Feed rate undefined. Axis letter not configured or without real value.
                     // Axis words are optional. If missing, set axis command flag to ignore execution.
@@ -1538,6 +1727,46 @@ Error gc_execute_line(const char* input_line) {
                     }
                     clear_bitnum(value_words, GCodeWord::P);
                     break;
+                case Motion::CubicSpline:
+                case Motion::QuadraticSpline:
+                    // [G5/G5.1 Errors]: Feed rate undefined. Plane is not G17. Axis words other than X and Y.
+                    // [G5 Errors]: P or Q missing. Only one of I and J given. I and J omitted when the previous
+                    //   motion was not a G5, so there is no second control point to reflect.
+                    // [G5.1 Errors]: I and J both omitted.
+                    // NOTE: I,J locate the first control point relative to the start, P,Q the second control
+                    // point relative to the end. Missing X or Y words leave that coordinate unchanged.
+                    if (gc_block.modal.plane_select != Plane::XY) {
+                        return Error::GcodeUnsupportedCommand;  // [Spline outside G17]
+                    }
+                    if (axis_words & ~(bitnum_to_mask(X_AXIS) | bitnum_to_mask(Y_AXIS))) {
+                        return Error::GcodeAxisWordsExist;  // [Axis word other than X,Y]
+                    }
+                    if (!nonmodalG38 && gc_block.modal.units == Units::Inches) {
+                        gc_block.values.ijk[X_AXIS] *= MM_PER_INCH;
+                        gc_block.values.ijk[Y_AXIS] *= MM_PER_INCH;
+                        gc_block.values.p *= MM_PER_INCH;
+                        gc_block.values.q *= MM_PER_INCH;
+                    }
+                    if (gc_block.modal.motion == Motion::CubicSpline) {
+                        if (bitnum_is_false(value_words, GCodeWord::P) || bitnum_is_false(value_words, GCodeWord::Q)) {
+                            return Error::GcodeValueWordMissing;  // [P or Q missing]
+                        }
+                        if (!(ijk_words & (bitnum_to_mask(X_AXIS) | bitnum_to_mask(Y_AXIS)))) {
+                            if (gc_state.modal.motion != Motion::CubicSpline) {
+                                return Error::GcodeValueWordMissing;  // [I,J missing on the first G5]
+                            }
+                            // Continue the previous spline smoothly by mirroring its second control point.
+                            gc_block.values.ijk[X_AXIS] = -gc_state.spline_pq[0];
+                            gc_block.values.ijk[Y_AXIS] = -gc_state.spline_pq[1];
+                        } else if (bitnum_is_false(ijk_words, X_AXIS) || bitnum_is_false(ijk_words, Y_AXIS)) {
+                            return Error::GcodeValueWordMissing;  // [Only one of I,J]
+                        }
+                        clear_bits(value_words, (bitnum_to_mask(GCodeWord::P) | bitnum_to_mask(GCodeWord::Q)));
+                    } else if (!(ijk_words & (bitnum_to_mask(X_AXIS) | bitnum_to_mask(Y_AXIS)))) {
+                        return Error::GcodeNoOffsetsInPlane;  // [No I,J]
+                    }
+                    clear_bits(value_words, (bitnum_to_mask(GCodeWord::I) | bitnum_to_mask(GCodeWord::J)));
+                    break;
                 case Motion::ProbeTowardNoError:
                 case Motion::ProbeAwayNoError:
                     probeNoError = true;  // No break intentional.
@@ -1626,9 +1855,11 @@ Error gc_execute_line(const char* input_line) {
     // If in laser mode, setup laser power based on current and past parser conditions.
     if (spindle->isRateAdjusted()) {
         bool blockIsFeedrateMotion = (gc_block.modal.motion == Motion::Linear) || (gc_block.modal.motion == Motion::CwArc) ||
-                                     (gc_block.modal.motion == Motion::CcwArc);
+                                     (gc_block.modal.motion == Motion::CcwArc) || (gc_block.modal.motion == Motion::CubicSpline) ||
+                                     (gc_block.modal.motion == Motion::QuadraticSpline);
         bool stateIsFeedrateMotion = (gc_state.modal.motion == Motion::Linear) || (gc_state.modal.motion == Motion::CwArc) ||
-                                     (gc_state.modal.motion == Motion::CcwArc);
+                                     (gc_state.modal.motion == Motion::CcwArc) || (gc_state.modal.motion == Motion::CubicSpline) ||
+                                     (gc_state.modal.motion == Motion::QuadraticSpline);
 
         if (!blockIsFeedrateMotion) {
             // If the new mode is not a feedrate move (G1/2/3) we want the laser off
@@ -1672,10 +1903,19 @@ Error gc_execute_line(const char* input_line) {
     pl_data->feed_rate = gc_state.feed_rate;  // Record data for planner use.
     // [4. Set spindle speed ]:
     if ((gc_state.spindle_speed != gc_block.values.s) || syncLaser) {
-        if (gc_state.modal.spindle != SpindleState::Disable && !laserIsMotion && !state_is(State::CheckMode)) {
-            protocol_buffer_synchronize();
-            spindle->setState(gc_state.modal.spindle, disableLaser ? 0 : (uint32_t)gc_block.values.s);
-            gc_ovr_changed();
+        // Like a laser, a spindle with queued_speed_changes gets the new speed from the
+        // planner block of the motion, when the stepper starts it
+        bool speedIsMotion = laserIsMotion ||
+                             (spindle->_queued_speed_changes && axis_words && axis_command == AxisCommand::MotionMode &&
+                              gc_block.modal.spindle == gc_state.modal.spindle);
+        if (gc_state.modal.spindle != SpindleState::Disable && !state_is(State::CheckMode)) {
+            if (!speedIsMotion) {
+                protocol_buffer_synchronize();
+                spindle->setState(gc_state.modal.spindle, disableLaser ? 0 : (uint32_t)gc_block.values.s);
+                gc_ovr_changed();
+            } else if (!laserIsMotion) {
+                spindle->_current_speed = gc_block.values.s;  // So the next setState() ramps from the queued speed
+            }
         }
         gc_state.spindle_speed = gc_block.values.s;  // Update spindle speed state.
     }
@@ -1685,7 +1925,9 @@ Error gc_execute_line(const char* input_line) {
     }                                                     // else { pl_data->spindle_speed = 0.0; } // Initialized as zero already.
     // [5. Select tool ]: NOT SUPPORTED. Only tracks tool value.
     // [M6. Change tool ]:
-    if (gc_block.modal.tool_change == ToolChange::Enable) {
+    if (gc_block.modal.tool_change == ToolChange::Enable && state_is(State::CheckMode)) {
+        gc_state.current_tool = gc_state.selected_tool;  // Checking or resuming, see Resume.h
+    } else if (gc_block.modal.tool_change == ToolChange::Enable) {
         if (gc_state.selected_tool != gc_state.current_tool) {
             bool stopped_spindle = false;   // was spindle stopped via the change
             bool new_spindle     = false;   // was the spindle changed
@@ -1773,11 +2015,14 @@ Error gc_execute_line(const char* input_line) {
     if ((gc_block.modal.io_control == IoControl::DigitalOnSync) || (gc_block.modal.io_control == IoControl::DigitalOffSync) ||
         (gc_block.modal.io_control == IoControl::DigitalOnImmediate) || (gc_block.modal.io_control == IoControl::DigitalOffImmediate)) {
         if (gc_block.values.p < MaxUserDigitalPin) {
-            if ((gc_block.modal.io_control == IoControl::DigitalOnSync) || (gc_block.modal.io_control == IoControl::DigitalOffSync)) {
-                protocol_buffer_synchronize();
-            }
             bool turnOn = gc_block.modal.io_control == IoControl::DigitalOnSync || gc_block.modal.io_control == IoControl::DigitalOnImmediate;
-            if (!config->_userOutputs->setDigital((int)gc_block.values.p, turnOn)) {
+            if ((gc_block.modal.io_control == IoControl::DigitalOnSync) || (gc_block.modal.io_control == IoControl::DigitalOffSync)) {
+                // Queued in the planner to change when the next motion starts, without a stop
+                if (turnOn && config->_userOutputs->_digitalOutput[(int)gc_block.values.p].undefined()) {
+                    return Error::PParamMaxExceeded;
+                }
+                plan_sync_digital_output((int)gc_block.values.p, turnOn);
+            } else if (!config->_userOutputs->setDigital((int)gc_block.values.p, turnOn)) {
                 return Error::PParamMaxExceeded;
             }
         } else {
@@ -1792,9 +2037,15 @@ Error gc_execute_line(const char* input_line) {
                 gc_block.values.q = 100.0f;
             }
             if (gc_block.modal.io_control == IoControl::SetAnalogSync) {
-                protocol_buffer_synchronize();
-            }
-            if (!config->_userOutputs->setAnalogPercent((int)gc_block.values.e, gc_block.values.q)) {
+                int io_num = (int)gc_block.values.e;
+                if (config->_userOutputs->_analogOutput[io_num].undefined()) {
+                    if (gc_block.values.q != 0.0f) {
+                        return Error::PParamMaxExceeded;
+                    }
+                } else {
+                    plan_sync_analog_output(io_num, config->_userOutputs->analogDuty(io_num, gc_block.values.q));
+                }
+            } else if (!config->_userOutputs->setAnalogPercent((int)gc_block.values.e, gc_block.values.q)) {
                 return Error::PParamMaxExceeded;
             }
         } else {
@@ -1803,16 +2054,9 @@ Error gc_execute_line(const char* input_line) {
     }
     if (gc_block.modal.io_control == IoControl::WaitOnInput) {
         auto const validate_input_number = [&](const float input_number) -> std::optional<uint8_t> {
-            if (input_number < 0) {
+            if (input_number < 0 || input_number >= (isWaitOnInputDigital ? MaxUserDigitalPin : MaxUserAnalogPin)) {
                 return std::nullopt;
             }
-            if (isWaitOnInputDigital) {
-                if (input_number > MaxUserDigitalPin) {
-                    return std::nullopt;
-                } else if (input_number > MaxUserAnalogPin) {
-                    return std::nullopt;
-                }
-            }
             return (uint8_t)input_number;
         };
         auto const maybe_input_number = validate_input_number(isWaitOnInputDigital ? gc_block.values.p : gc_block.values.e);
@@ -1822,7 +2066,10 @@ Error gc_execute_line(const char* input_line) {
         auto const input_number = *maybe_input_number;
         auto const wait_mode    = *validate_wait_on_input_mode_value(gc_block.values.l);
         auto const timeout      = gc_block.values.q;
-        gc_wait_on_input(isWaitOnInputDigital, input_number, wait_mode, timeout);
+        Error status = gc_wait_on_input(isWaitOnInputDigital, input_number, wait_mode, timeout);
+        if (status != Error::Ok) {
+            return status;
+        }
     }
 
     // [9. Override control ]: NOT SUPPORTED. Always enabled, except for parking control.
@@ -1835,7 +2082,7 @@ Error gc_execute_line(const char* input_line) {
 
     // [10. Dwell ]:
     if (gc_block.non_modal_command == NonModal::Dwell) {
-        mc_dwell(int32_t(gc_block.values.p * 1000.0f));
+        mc_dwell(int32_t(gc_block.values.p * 1000.0f), pl_data);
     }
     // [11. Set active plane ]:
     gc_state.modal.plane_select = gc_block.modal.plane_select;
@@ -1848,12 +2095,20 @@ Error gc_execute_line(const char* input_line) {
     // of execution. The error-checking step would simply load the offset value into the correct
     // axis of the block XYZ value array.
     if (axis_command == AxisCommand::ToolLengthOffset) {  // Indicates a change.
+        bool tcp = gc_block.modal.tool_length == ToolLengthOffset::Tcp;
+        if (tcp != (gc_state.modal.tool_length == ToolLengthOffset::Tcp)) {
+            // Positions change frame, so the motion planned in the old frame must finish first
+            protocol_buffer_synchronize();
+            config->_kinematics->set_tcp(tcp);
+            invalidate_mpos_cache();
+            gc_sync_position();
+        }
         gc_state.modal.tool_length = gc_block.modal.tool_length;
         if (gc_state.modal.tool_length == ToolLengthOffset::Cancel) {  // G49
             gc_block.values.xyz[TOOL_LENGTH_OFFSET_AXIS] = 0.0;
         }
-        // else G43.1
-        if (gc_state.tool_length_offset != gc_block.values.xyz[TOOL_LENGTH_OFFSET_AXIS]) {
+        // else G43.1; G43.4 keeps the offset
+        if (!tcp && gc_state.tool_length_offset != gc_block.values.xyz[TOOL_LENGTH_OFFSET_AXIS]) {
             gc_state.tool_length_offset = gc_block.values.xyz[TOOL_LENGTH_OFFSET_AXIS];
         }
     }
@@ -1863,8 +2118,14 @@ Error gc_execute_line(const char* input_line) {
         copyAxes(gc_state.coord_system, block_coord_system);
         gc_wco_changed();
     }
-    // [16. Set path control mode ]: G61.1/G64 NOT SUPPORTED
-    // gc_state.modal.control = gc_block.modal.control; // NOTE: Always default.
+    // [16. Set path control mode ]: G61.1 NOT SUPPORTED
+    gc_state.modal.control = gc_block.modal.control;
+    if (bitnum_is_true(command_words, ModalGroup::MG13) && gc_block.modal.control == ControlMode::Continuous) {
+        gc_state.blend_tolerance = blendTolerance;
+    }
+    if (gc_state.modal.control == ControlMode::Continuous) {
+        pl_data->blend_tolerance = gc_state.blend_tolerance;  // Record data for planner use.
+    }
     // [17. Set distance mode ]:
     gc_state.modal.distance = gc_block.modal.distance;
     // [17.1. Set coordinate rotation mode ]:
@@ -1933,7 +2194,24 @@ Error gc_execute_line(const char* input_line) {
     if (gc_state.modal.motion != Motion::None) {
         if (axis_command == AxisCommand::MotionMode) {
             GCUpdatePos gc_update_pos = GCUpdatePos::Target;
-            if (gc_state.modal.motion == Motion::Linear) {
+            if (gc_state.modal.motion == Motion::SpindleSync) {
+                // K is the travel along Z per revolution, or along the path if Z does not move.
+                // The planner works with the path, and with the nominal feed rate at speed S.
+                float length = 0.0f;
+                for (size_t axis = 0; axis < n_axis; axis++) {
+                    float delta = gc_block.values.xyz[axis] - gc_state.position[axis];
+                    length += delta * delta;
+                }
+                length        = sqrtf(length);
+                float dz      = fabsf(gc_block.values.xyz[Z_AXIS] - gc_state.position[Z_AXIS]);
+                float per_rev = gc_block.values.ijk[Z_AXIS] * (dz > 0.0f ? length / dz : 1.0f);
+                pl_data->spindle_sync          = per_rev;
+                pl_data->feed_rate             = per_rev * gc_state.spindle_speed;
+                pl_data->motion.inverseTime    = 0;
+                pl_data->motion.noFeedOverride = 1;
+                pl_data->blend_tolerance       = 0.0f;
+            }
+            if (gc_state.modal.motion == Motion::Linear || gc_state.modal.motion == Motion::SpindleSync) {
                 float rotated_coords[MAX_N_AXIS];
                 copyAxes(rotated_coords, gc_block.values.xyz);
                 apply_coordinate_rotation(rotated_coords);
@@ -2006,6 +2284,37 @@ Error gc_execute_line(const char* input_line) {
                            clockwiseArc,
                            int(gc_block.values.p));
                 }
+            } else if ((gc_state.modal.motion == Motion::CubicSpline) || (gc_state.modal.motion == Motion::QuadraticSpline)) {
+                // Rotation is the identity when G68 is not active, so always rotating keeps this simple.
+                float rotated_coords[MAX_N_AXIS];
+                float rotated_position[MAX_N_AXIS];
+                float first_offset[3]  = { gc_block.values.ijk[X_AXIS], gc_block.values.ijk[Y_AXIS], 0.0f };  // I,J
+                float second_offset[3] = { gc_block.values.p, gc_block.values.q, 0.0f };                      // P,Q
+                copyAxes(rotated_coords, gc_block.values.xyz);
+                copyAxes(rotated_position, gc_state.position);
+                apply_coordinate_rotation(rotated_coords);
+                apply_coordinate_rotation(rotated_position);
+                apply_coordinate_rotation_to_offset(first_offset);
+                apply_coordinate_rotation_to_offset(second_offset);
+
+                float control_1[2], control_2[2];
+                for (size_t i = 0; i < 2; i++) {
+                    if (gc_state.modal.motion == Motion::CubicSpline) {
+                        control_1[i] = rotated_position[X_AXIS + i] + first_offset[i];
+                        control_2[i] = rotated_coords[X_AXIS + i] + second_offset[i];
+                    } else {
+                        // Degree elevation: the cubic control points lie 2/3 of the way from each end
+                        // to the quadratic control point.
+                        float control = rotated_position[X_AXIS + i] + first_offset[i];
+                        control_1[i]  = rotated_position[X_AXIS + i] + (2.0f / 3.0f) * (control - rotated_position[X_AXIS + i]);
+                        control_2[i]  = rotated_coords[X_AXIS + i] + (2.0f / 3.0f) * (control - rotated_coords[X_AXIS + i]);
+                    }
+                }
+                if (gc_state.modal.motion == Motion::CubicSpline) {
+                    gc_state.spline_pq[0] = gc_block.values.p;
+                    gc_state.spline_pq[1] = gc_block.values.q;
+                }
+                mc_spline(rotated_coords, pl_data, rotated_position, control_1, control_2);
             } else {
                 // NOTE: gc_block.values.xyz is returned from mc_probe_cycle with the updated position value. So
                 // upon a successful probing cycle, the machine position and the returned value should be the same.
@@ -2124,7 +2433,7 @@ Error gc_execute_line(const char* input_line) {
    group 8 = {M7*} enable mist coolant (* Compile-option)
    group 9 = {M48, M49} enable/disable feed and speed override switches
    group 10 = {G98, G99} return mode canned cycles
-   group 13 = {G61.1, G64} path control mode (G61 is supported)
+   group 13 = {G61.1} path control mode (G61 and G64 are supported)
 */
 
 static std::optional<WaitOnInputMode> validate_wait_on_input_mode_value(uint8_t value) {
@@ -2151,23 +2460,31 @@ struct overloaded : Ts... {
 template <class... Ts>
 overloaded(Ts...) -> overloaded<Ts...>;
 
+// As in LinuxCNC, #5399 is the value of the input, or -1 if a wait timed out.  A wait
+// starts when the motion before it is done.
 static Error gc_wait_on_input(bool is_digital, uint8_t input_number, WaitOnInputMode mode, float timeout) {
-    // TODO - only Immediate read mode is supported
+    bool met = true;
+    auto result = Machine::UserInputs::ReadInputResult(false);
     if (mode == WaitOnInputMode::Immediate) {
-        auto const result = is_digital ? config->_userInputs->readDigitalInput(input_number) :
-                                         config->_userInputs->readAnalogInput(input_number);
-        auto const on_ok  = [&](bool result) {
-            log_debug("M66: " << (is_digital ? "digital" : "analog") << "_input" << input_number << " result=" << result);
-            set_numbered_param(5399, result ? 1.0 : 0.0);
-            return Error::Ok;
-        };
-        auto const on_error = [&](Error error) {
-            log_error("M66: " << (is_digital ? "digital" : "analog") << "_input" << input_number << " failed");
-            return error;
-        };
-        return std::visit(overloaded { on_ok, on_error }, result);
+        result = is_digital ? config->_userInputs->readDigitalInput(input_number) : config->_userInputs->readAnalogInput(input_number);
+    } else {
+        protocol_buffer_synchronize();
+        if (sys.abort) {
+            return Error::Reset;
+        }
+        result = config->_userInputs->waitDigitalInput(input_number, mode, uint32_t(timeout * 1000), met);
     }
-
-    // TODO - implement rest of modes
-    return Error::GcodeValueWordInvalid;
+    auto const on_ok = [&](bool result) {
+        log_debug("M66: " << (is_digital ? "digital" : "analog") << "_input" << input_number << " result=" << result
+                          << (met ? "" : " timeout"));
+        set_numbered_param(5399, met ? (result ? 1.0 : 0.0) : -1.0);
+        return Error::Ok;
+    };
+    auto const on_error = [&](Error error) {
+        if (error != Error::Reset) {
+            log_error("M66: " << (is_digital ? "digital" : "analog") << "_input" << input_number << " failed");
+        }
+        return error;
+    };
+    return std::visit(overloaded { on_ok, on_error }, result);
 }
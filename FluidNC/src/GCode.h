@@ -30,7 +30,7 @@ enum class Override : uint8_t {
 enum class ModalGroup : uint8_t {
     // Table 5. G-code Modal Groups
     MG0  = 0,   // [G4,G10,G28,G28.1,G30,G30.1,G53,G92,G92.1] Non-modal
-    MG1  = 1,   // [G0,G1,G2,G3,G38.2,G38.3,G38.4,G38.5,G80] Motion
+    MG1  = 1,   // [G0,G1,G2,G3,G33,G38.2,G38.3,G38.4,G38.5,G80] Motion
     MG2  = 2,   // [G17,G18,G19] Plane selection
     MG3  = 3,   // [G90,G91] Distance mode
     MG4  = 4,   // [G91.1] Arc IJK distance mode
@@ -79,6 +79,9 @@ enum class Motion : gcodenum_t {
     Linear             = 10,   // G1
     CwArc              = 20,   // G2
     CcwArc             = 30,   // G3
+    CubicSpline        = 50,   // G5
+    QuadraticSpline    = 51,   // G5.1
+    SpindleSync        = 330,  // G33
     ProbeToward        = 382,  // G38.2
     ProbeTowardNoError = 383,  // G38.3
     ProbeAway          = 384,  // G38.4
@@ -134,7 +137,8 @@ enum class CutterCompensation : gcodenum_t {
 
 // Modal Group G13: Control mode
 enum class ControlMode : gcodenum_t {
-    ExactPath = 610,  // G61
+    ExactPath  = 610,  // G61 Default
+    Continuous = 640,  // G64
 };
 
 // Modal Group G14: Coordinate rotation
@@ -191,6 +195,7 @@ static const int MaxUserAnalogPin  = 4;
 enum class ToolLengthOffset : gcodenum_t {
     Cancel        = 490,  // G49 Default
     EnableDynamic = 431,  // G43.1
+    Tcp           = 434,  // G43.4 Tool center point control, see Kinematics/TableTable.h
 };
 
 static const uint32_t MaxToolNumber = 99999999;
@@ -277,7 +282,7 @@ struct gc_modal_t {
     // CutterCompensation cutter_comp;  // {G40} NOTE: Don't track. Only default supported.
     ToolLengthOffset tool_length;   // {G43.1,G49}
     CoordIndex       coord_select;  // {G54,G55,G56,G57,G58,G59}
-    // uint8_t control;      // {G61} NOTE: Don't track. Only default supported.
+    ControlMode      control;       // {G61,G64}
     ProgramFlow   program_flow;  // {M0,M1,M2,M30}
     CoolantState  coolant;       // {M7,M8,M9}
     SpindleState  spindle;       // {M3,M4,M5}
@@ -319,6 +324,8 @@ struct parser_state_t {
     float coord_offset[MAX_N_AXIS];  // Retains the G92 coordinate offset (work coordinates) relative to
     // machine zero in mm. Non-persistent. Cleared upon reset and boot.
     float tool_length_offset;  // Tracks tool length offset value when enabled.
+    float blend_tolerance;     // G64 P path tolerance in mm. Zero until the first G64.
+    float spline_pq[2];        // P,Q offset of the last G5, reflected when the next G5 omits I,J
     bool  skip_blocks;         // Skipping due to flow control
     
     // Coordinate rotation state (G68/G69)
@@ -348,6 +355,9 @@ void gc_init();
 // Execute one block of rs275/ngc/g-code
 Error gc_execute_line(const char* line);
 
+// Edit a line in place, removing whitespace and comments and converting to uppercase
+void collapseGCode(char* line);
+
 // Set g-code parser position. Input in steps.
 void gc_sync_position();
 
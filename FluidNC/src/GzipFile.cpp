@@ -0,0 +1,99 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "GzipFile.h"
+
+#include "Logging.h"
+#include "SettingsDefinitions.h"  // sd_read_ahead_psram
+#include "Driver/psram.h"         // psram_malloc()
+#include "HeapTag.h"              // HeapTag
+
+#include <cstdlib>
+#include <cstring>
+
+static HeapTag heap_tag("Gzip");
+
+uint8_t* GzipFile::allocate_window() {
+    void* window = nullptr;
+    if (sd_read_ahead_psram->get()) {
+        window = psram_malloc(Inflater::window_size);
+    }
+    if (!window) {
+        window = malloc(Inflater::window_size);
+    }
+    if (!window) {
+        log_error("No memory to decompress");
+        throw Error::FsFailedOpenFile;
+    }
+    return static_cast<uint8_t*>(heap_tag.allocated(window, Inflater::window_size));
+}
+
+GzipFile::GzipFile(const char* defaultFs, const char* path) :
+    InputFile(defaultFs, path), _window(allocate_window()), _inflater(read_compressed, this, _window) {
+    // The last four bytes of the file hold the decompressed size, modulo 2^32
+    size_t  compressed = FileStream::size();
+    uint8_t trailer[4] = {};
+    if (compressed >= 4) {
+        FileStream::set_position(compressed - 4);
+        FileStream::read(trailer, sizeof(trailer));
+        FileStream::set_position(0);
+    }
+    _size = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | (uint32_t(trailer[3]) << 24);
+}
+
+bool GzipFile::is_gzip(const std::string& path) {
+    size_t len = strlen(extension);
+    return path.length() > len && strcasecmp(path.c_str() + path.length() - len, extension) == 0;
+}
+
+size_t GzipFile::read_compressed(void* arg, uint8_t* buffer, size_t length) {
+    return static_cast<GzipFile*>(arg)->FileStream::read(buffer, length);
+}
+
+int GzipFile::read() {
+    if (_out_pos == _out_len) {
+        _out_len = _inflater.read(_out, sizeof(_out));
+        _out_pos = 0;
+        if (_out_len == 0) {
+            return -1;
+        }
+    }
+    return _out[_out_pos++];
+}
+
+Error GzipFile::nextLine(char* line, int len, size_t& line_number) {
+    Error err = InputFile::nextLine(line, len, line_number);
+    if (err == Error::Eof && _inflater.failed()) {
+        log_error("Corrupt compressed data in " << path());
+        return Error::FsFailedRead;
+    }
+    return err;
+}
+
+size_t GzipFile::size() {
+    return _size;
+}
+
+size_t GzipFile::position() {
+    return _inflater.total_out() - (_out_len - _out_pos);
+}
+
+void GzipFile::set_position(size_t pos) {
+    size_t here = position();
+    if (pos < here) {
+        // Decompress again from the start
+        InputFile::set_position(0);
+        _inflater.reset();
+        _out_pos = _out_len = 0;
+        here                = 0;
+    } else {
+        // Clears the lines read ahead without moving the compressed data
+        InputFile::set_position(FileStream::position());
+    }
+    for (; here < pos && read() >= 0; ++here) {}
+}
+
+GzipFile::~GzipFile() {
+    heap_tag.freed(_window, Inflater::window_size);
+    free(_window);
+}
@@ -0,0 +1,57 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  GzipFile.h - G-code job files compressed with gzip
+
+  Files whose names end in .gz are decompressed as they are read, so a raster job that
+  compresses ten to one uploads ten times faster and is read from the card in a tenth
+  of the time.  The compressed data goes through the read-ahead buffer like any job
+  file, and the decompressed bytes are cut into lines by InputFile.
+
+  Positions are offsets in the decompressed text, so flow control works as in a plain
+  file.  Moving back, as a loop does, decompresses again from the start of the file up
+  to the new position, so loops in compressed files are slow.  The label table that
+  speeds up skipping forward is not built, since building it would read the whole file.
+*/
+
+#include "InputFile.h"
+#include "Inflate.h"
+
+#include <cstdint>
+
+class GzipFile : public InputFile {
+private:
+    uint8_t* _window = nullptr;
+    Inflater _inflater;
+
+    uint8_t _out[256];  // Decompressed bytes not yet read
+    size_t  _out_pos = 0;
+    size_t  _out_len = 0;
+
+    size_t _size = 0;  // Decompressed size from the trailer
+
+    static size_t read_compressed(void* arg, uint8_t* buffer, size_t length);
+    static uint8_t* allocate_window();
+
+protected:
+    Error nextLine(char* line, int len, size_t& line_number) override;
+
+public:
+    static constexpr const char* extension = ".gz";
+
+    GzipFile(const char* fsname, const char* path);
+
+    int    read() override;
+    size_t size() override;
+    size_t position() override;
+    void   set_position(size_t pos) override;
+    bool   skip_to_label(uint32_t o_label) override { return false; }
+
+    // True if path names a compressed file
+    static bool is_gzip(const std::string& path);
+
+    ~GzipFile();
+};
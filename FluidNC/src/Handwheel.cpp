@@ -0,0 +1,150 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Handwheel.h"
+
+#include "Machine/MachineConfig.h"  // Axes
+#include "Jog.h"                    // jog_follow
+#include "Protocol.h"               // protocol_send_event
+#include "Event.h"
+#include "Driver/pulse_counter.h"  // pulse_counter_init_quadrature, pulse_counter_read
+#include "Logging.h"
+
+#include <cctype>
+
+static ArgEvent handwheelEvent { Handwheel::move_event };
+
+void Handwheel::init() {
+    _a_pin.setAttr(Pin::Attr::Input);
+    _b_pin.setAttr(Pin::Attr::Input);
+    if (!pulse_counter_init_quadrature(PCNT_UNIT,
+                                       _a_pin.getNative(Pin::Capabilities::Input | Pin::Capabilities::Native),
+                                       _b_pin.getNative(Pin::Capabilities::Input | Pin::Capabilities::Native),
+                                       COUNT_LIMIT)) {
+        log_error("Handwheel cannot use the pulse counter");
+        return;
+    }
+    _last_raw = pulse_counter_read(PCNT_UNIT);
+
+    std::string axes;
+    for (size_t axis = 0; axis < Axes::_numberAxis; axis++) {
+        if (_axis_pins[axis].defined()) {
+            _axis_pins[axis].setAttr(Pin::Attr::Input);
+            axes += Axes::axisName(axis);
+            _any_axis = true;
+        }
+    }
+    if (_x10_pin.defined()) {
+        _x10_pin.setAttr(Pin::Attr::Input);
+    }
+    if (_x100_pin.defined()) {
+        _x100_pin.setAttr(Pin::Attr::Input);
+    }
+    if (!_any_axis) {
+        axes = Axes::axisName(0);
+    }
+    _ready = true;
+
+    log_info("Handwheel A:" << _a_pin.name() << " B:" << _b_pin.name() << " Counts/detent:" << _counts_per_detent
+                            << " mm/detent:" << _mm_per_detent << " Axes:" << axes);
+}
+
+int Handwheel::selected_axis() {
+    if (!_any_axis) {
+        return 0;
+    }
+    for (size_t axis = 0; axis < Axes::_numberAxis; axis++) {
+        if (_axis_pins[axis].defined() && _axis_pins[axis].read()) {
+            return axis;
+        }
+    }
+    return -1;
+}
+
+int Handwheel::multiplier() {
+    if (_x100_pin.defined() && _x100_pin.read()) {
+        return 100;
+    }
+    if (_x10_pin.defined() && _x10_pin.read()) {
+        return 10;
+    }
+    return 1;
+}
+
+// The counter wraps at COUNT_LIMIT, far more counts than a hand can turn between polls
+void Handwheel::poll() {
+    if (!_ready) {
+        return;
+    }
+    int16_t raw   = pulse_counter_read(PCNT_UNIT);
+    int32_t delta = (int32_t(raw) - _last_raw) % COUNT_LIMIT;
+    if (delta > COUNT_LIMIT / 2) {
+        delta -= COUNT_LIMIT;
+    } else if (delta < -COUNT_LIMIT / 2) {
+        delta += COUNT_LIMIT;
+    }
+    _last_raw = raw;
+    _counts += delta;
+
+    int32_t detents = _counts / _counts_per_detent;
+    if (detents == 0) {
+        return;
+    }
+    _counts -= detents * _counts_per_detent;
+
+    int axis = selected_axis();
+    if (axis < 0) {
+        return;
+    }
+    int32_t add = detents * multiplier() * 8;
+
+    // Adds to what move() has not taken yet, unless that was for another axis.  Only the
+    // first addition after move() took the last one needs an event.
+    int32_t queued = _queued.load();
+    int32_t next;
+    do {
+        next = (queued >> 3) && (queued & 7) == axis ? queued + add : add + axis;
+    } while (!_queued.compare_exchange_weak(queued, next));
+    if ((queued >> 3) == 0) {
+        protocol_send_event(&handwheelEvent, this);
+    }
+}
+
+void Handwheel::move() {
+    int32_t queued  = _queued.exchange(0);
+    int32_t detents = queued >> 3;
+    if (detents == 0) {
+        return;
+    }
+    float distance[MAX_N_AXIS] = { 0.0f };
+    distance[queued & 7]       = detents * _mm_per_detent;
+    if (jog_follow(distance) != Error::Ok) {
+        log_debug("Handwheel ignored while the machine is busy");
+    }
+}
+
+void Handwheel::move_event(void* arg) {
+    static_cast<Handwheel*>(arg)->move();
+}
+
+void Handwheel::validate() {
+    Assert(_a_pin.defined() && _b_pin.defined(), "Handwheel a_pin and b_pin must be configured");
+}
+
+void Handwheel::group(Configuration::HandlerBase& handler) {
+    handler.item("a_pin", _a_pin);
+    handler.item("b_pin", _b_pin);
+    handler.item("counts_per_detent", _counts_per_detent, 1, 100);
+    handler.item("mm_per_detent", _mm_per_detent, 0.0001, 10.0);
+    char item_name[16];
+    for (size_t axis = 0; axis < MAX_N_AXIS; axis++) {
+        snprintf(item_name, sizeof(item_name), "axis_%c_pin", tolower(Axes::_names[axis]));
+        handler.item(item_name, _axis_pins[axis]);
+    }
+    handler.item("x10_pin", _x10_pin);
+    handler.item("x100_pin", _x100_pin);
+}
+
+namespace {
+    ConfigurableModuleFactory::InstanceBuilder<Handwheel> registration("handwheel");
+}
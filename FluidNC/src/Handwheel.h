@@ -0,0 +1,87 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  Handwheel.h - a manual pulse generator (MPG) that jogs the machine
+
+  A hardware pulse counter decodes the quadrature signal of the wheel on a_pin and b_pin;
+  swap them if the axis moves opposite to the wheel.  Every counts_per_detent counts move
+  the selected axis by mm_per_detent, times 10 while x10_pin is active and times 100 while
+  x100_pin is.  The axis is the one whose axis_<letter>_pin is active, as from the axis
+  switch of a pendant; with none active the wheel does nothing.  Without any axis pins it
+  always moves the first axis.
+
+  The moves bypass the parser and the planner: the polling task reads the counter about
+  once a millisecond and the distance goes straight to the segment generator as a velocity
+  jog steered by position, see Stepper::follow_jog().  The axis goes where the wheel has
+  sent it as fast as its max rate and acceleration allow and stops there, so a fast spin
+  neither lags behind in a queue of jog commands nor overruns when the wheel stops.  The
+  wheel only moves the machine from Idle, or while its own jog runs; turns at other times
+  are ignored.
+
+  handwheel:
+    a_pin: gpio.34
+    b_pin: gpio.35
+    counts_per_detent: 4
+    mm_per_detent: 0.01
+    axis_x_pin: gpio.25:low:pu
+    axis_y_pin: gpio.26:low:pu
+    axis_z_pin: gpio.27:low:pu
+    x10_pin: gpio.32:low:pu
+    x100_pin: gpio.33:low:pu
+*/
+
+#include "Config.h"  // MAX_N_AXIS
+#include "Module.h"
+#include "Pin.h"
+
+#include <atomic>
+#include <cstdint>
+
+class Handwheel : public ConfigurableModule {
+    Pin   _a_pin;
+    Pin   _b_pin;
+    int   _counts_per_detent = 4;
+    float _mm_per_detent     = 0.01f;
+    Pin   _axis_pins[MAX_N_AXIS];
+    Pin   _x10_pin;
+    Pin   _x100_pin;
+
+    static const int PCNT_UNIT   = 7;  // Unit 0 is the spindle encoder's, 1-6 are motor encoders'
+    static const int COUNT_LIMIT = 30000;
+
+    bool    _ready    = false;
+    bool    _any_axis = false;  // Some axis pin is configured
+    int16_t _last_raw = 0;
+    int32_t _counts   = 0;  // Not yet a whole detent
+
+    // Detents times the multiplier, shifted left by 3, plus the axis; set by poll(),
+    // taken by move()
+    std::atomic<int32_t> _queued { 0 };
+
+    int  selected_axis();
+    int  multiplier();
+    void move();
+
+public:
+    Handwheel(const char* name) : ConfigurableModule(name) {}
+
+    Handwheel(const Handwheel&)            = delete;
+    Handwheel(Handwheel&&)                 = delete;
+    Handwheel& operator=(const Handwheel&) = delete;
+    Handwheel& operator=(Handwheel&&)      = delete;
+
+    virtual ~Handwheel() = default;
+
+    void init() override;
+    void poll() override;
+
+    // Runs in the executor, which owns the motion state, for the handwheel arg
+    static void move_event(void* arg);
+
+    // Configuration handlers:
+    void validate() override;
+    void group(Configuration::HandlerBase& handler) override;
+};
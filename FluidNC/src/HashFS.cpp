@@ -2,8 +2,14 @@
 #include "FileStream.h"
 
 #include <mbedtls/md.h>
+#include <sstream>
 
-std::map<std::string, std::string> HashFS::localFsHashes;
+// Hashes are kept in a hidden file on the local filesystem, each with the size and
+// modification time of the file it was computed from.  At startup only the stamps
+// are compared; a file whose stamp changed is hashed when its hash is first wanted.
+std::map<std::string, HashFS::Entry> HashFS::localFsHashes;
+const char*                          HashFS::cacheName = ".hashes";
+static std::filesystem::path         cache_path;
 
 static char hexNibble(int i) {
     return "0123456789ABCDEF"[i & 0xf];
@@ -47,8 +53,64 @@ void HashFS::report_change() {
     log_msg("Files changed");
 }
 
+bool HashFS::stamp(const std::filesystem::path& path, Entry& entry) {
+    std::error_code ec;
+    entry.size = stdfs::file_size(path, ec);
+    if (ec) {
+        return false;
+    }
+    entry.mtime = stdfs::last_write_time(path, ec).time_since_epoch().count();
+    if (ec) {
+        entry.mtime = 0;
+    }
+    return true;
+}
+
+// Each line is: size mtime hash name
+void HashFS::load_cache(const std::filesystem::path& dir) {
+    cache_path = dir / cacheName;
+    std::string contents;
+    try {
+        FileStream cache { cache_path, "r" };
+        char       buf[256];
+        size_t     len;
+        while ((len = cache.read(buf, sizeof(buf))) > 0) {
+            contents.append(buf, len);
+        }
+    } catch (const Error err) { return; }
+
+    std::istringstream lines(contents);
+    std::string        line;
+    while (std::getline(lines, line)) {
+        std::istringstream fields(line);
+        Entry              entry;
+        std::string        name;
+        if (fields >> entry.size >> entry.mtime >> entry.hash && fields.get() == ' ' && std::getline(fields, name) && name.length()) {
+            localFsHashes[name] = entry;
+        }
+    }
+}
+
+void HashFS::save_cache() {
+    if (cache_path.empty()) {
+        return;
+    }
+    std::string contents;
+    for (const auto& [name, entry] : localFsHashes) {
+        if (entry.hash.length()) {
+            contents += std::to_string(entry.size) + ' ' + std::to_string(entry.mtime) + ' ' + entry.hash + ' ' + name + '\n';
+        }
+    }
+    try {
+        FileStream cache { cache_path, "w" };
+        cache.write(reinterpret_cast<const uint8_t*>(contents.data()), contents.length());
+    } catch (const Error err) { log_debug("Cannot write " << cache_path); }
+}
+
 void HashFS::delete_file(const std::filesystem::path& path, bool report) {
-    localFsHashes.erase(path.filename());
+    if (localFsHashes.erase(path.filename())) {
+        save_cache();
+    }
     if (report) {
         report_change();
     }
@@ -65,17 +127,22 @@ bool HashFS::file_is_hashable(const std::filesystem::path& path) {
     if (count != 3) {
         return false;
     }
+    if (path.filename() == cacheName) {
+        return false;
+    }
     auto fsname = *++path.begin();
     return fsname == "littlefs" || fsname == "spiffs" || fsname == "localfs";
 }
 
+// The new hash is computed when it is first wanted
 void HashFS::rehash_file(const std::filesystem::path& path, bool report) {
     if (file_is_hashable(path)) {
-        std::string hash;
-        if (hashFile(path, hash) != Error::Ok) {
+        Entry entry;
+        if (!stamp(path, entry)) {
             delete_file(path, false);
         } else {
-            localFsHashes[path.filename()] = hash;
+            localFsHashes[path.filename()] = entry;
+            save_cache();
         }
     }
     if (report) {
@@ -83,6 +150,20 @@ void HashFS::rehash_file(const std::filesystem::path& path, bool report) {
     }
 }
 void HashFS::rename_file(const std::filesystem::path& ipath, const std::filesystem::path& opath, bool report) {
+    if (file_is_hashable(ipath) && file_is_hashable(opath)) {
+        auto it = localFsHashes.find(ipath.filename());
+        if (it != localFsHashes.end()) {
+            // Renaming keeps the contents and the modification time
+            Entry entry = it->second;
+            localFsHashes.erase(it);
+            localFsHashes[opath.filename()] = entry;
+            save_cache();
+            if (report) {
+                report_change();
+            }
+            return;
+        }
+    }
     delete_file(ipath, false);
     rehash_file(opath, report);
 }
@@ -101,19 +182,48 @@ void HashFS::hash_all() {
         log_error(lfspath << " " << ec.message());
         return;
     }
+
+    load_cache(lfspath);
+    auto cached = std::move(localFsHashes);
+    localFsHashes.clear();
+
+    bool changed = false;
     for (auto const& dir_entry : iter) {
-        if (!dir_entry.is_directory()) {
-            rehash_file(dir_entry, false);
+        if (dir_entry.is_directory() || !file_is_hashable(dir_entry)) {
+            continue;
         }
+        std::string name = dir_entry.path().filename();
+        Entry       entry;
+        if (!stamp(dir_entry, entry)) {
+            continue;
+        }
+        auto it = cached.find(name);
+        if (it != cached.end() && it->second.size == entry.size && it->second.mtime == entry.mtime) {
+            entry.hash = it->second.hash;
+            cached.erase(it);
+        } else {
+            changed = true;
+        }
+        localFsHashes[name] = entry;
+    }
+    if (changed || !cached.empty()) {
+        save_cache();
     }
 }
 std::string HashFS::hash(const std::filesystem::path& path, bool useCacheOnly /*= false*/) {
     if (file_is_hashable(path)) {
-        std::map<std::string, std::string>::const_iterator it;
-        it = localFsHashes.find(path.filename());
-        if (it != localFsHashes.end()) {
-            return it->second;
+        auto it = localFsHashes.find(path.filename());
+        if (it == localFsHashes.end()) {
+            return std::string();
+        }
+        if (it->second.hash.empty() && !useCacheOnly) {
+            if (hashFile(path, it->second.hash) != Error::Ok) {
+                localFsHashes.erase(it);
+                return std::string();
+            }
+            save_cache();
         }
+        return it->second.hash;
     } else if (!useCacheOnly) {
         std::string theHash;
         hashFile(path, theHash);
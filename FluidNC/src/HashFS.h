@@ -2,10 +2,18 @@
 #include <string>
 #include <map>
 #include <filesystem>
+#include <cstdint>
 
 class HashFS {
 public:
-    static std::map<std::string, std::string> localFsHashes;
+    // A file's hash, and the size and modification time it was computed for.  An
+    // empty hash has not been computed yet.
+    struct Entry {
+        std::string hash;
+        uintmax_t   size  = 0;
+        int64_t     mtime = 0;
+    };
+    static std::map<std::string, Entry> localFsHashes;
 
     static bool file_is_hashable(const std::filesystem::path& path);
     static void delete_file(const std::filesystem::path& path, bool report = true);
@@ -17,4 +25,9 @@ public:
     static std::string hash(const std::filesystem::path& path, bool useCacheOnly = false);
 
 private:
+    static const char* cacheName;
+
+    static bool stamp(const std::filesystem::path& path, Entry& entry);
+    static void load_cache(const std::filesystem::path& dir);
+    static void save_cache();
 };
@@ -0,0 +1,65 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// HeapTag counts the large heap allocations of a subsystem, so that $Heap/Stats
+// can show which subsystem holds memory after a long uptime, and how much it
+// needed at most.  A subsystem defines a tag with static storage duration and
+// tells it the size of each buffer that it allocates and frees.
+//
+// It is header-only so that it can be tested on the host.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+class HeapTag {
+    const char*           _name;
+    std::atomic<uint32_t> _allocs { 0 };
+    std::atomic<uint32_t> _frees { 0 };
+    std::atomic<uint32_t> _bytes { 0 };
+    std::atomic<uint32_t> _peak { 0 };
+    HeapTag*              _next;
+
+    static HeapTag*& head() {
+        static HeapTag* tags = nullptr;
+        return tags;
+    }
+
+public:
+    // Tags are only constructed during static initialization, so the list needs no lock
+    explicit HeapTag(const char* name) : _name(name), _next(head()) { head() = this; }
+
+    HeapTag(const HeapTag&)            = delete;
+    HeapTag& operator=(const HeapTag&) = delete;
+
+    // Returns ptr, counting size bytes if the allocation succeeded
+    template <typename T>
+    T* allocated(T* ptr, size_t size) {
+        if (ptr) {
+            ++_allocs;
+            uint32_t bytes = _bytes += uint32_t(size);
+            uint32_t peak  = _peak;
+            while (bytes > peak && !_peak.compare_exchange_weak(peak, bytes)) {}
+        }
+        return ptr;
+    }
+
+    void freed(const void* ptr, size_t size) {
+        if (ptr) {
+            ++_frees;
+            _bytes -= uint32_t(size);
+        }
+    }
+
+    const char* name() const { return _name; }
+    uint32_t    allocs() const { return _allocs; }
+    uint32_t    frees() const { return _frees; }
+    uint32_t    in_use() const { return _allocs - _frees; }
+    uint32_t    bytes() const { return _bytes; }
+    uint32_t    peak() const { return _peak; }
+
+    static HeapTag* first() { return head(); }
+    HeapTag*        next() const { return _next; }
+};
@@ -0,0 +1,252 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "HeightMap.h"
+
+#include "Machine/MachineConfig.h"  // config, Axes
+#include "GCode.h"                  // gc_execute_line
+#include "MotionControl.h"          // probe_succeeded
+#include "System.h"                 // sys, get_wco, probe_steps_to_mpos
+#include "FileStream.h"
+#include "Logging.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>   // snprintf
+#include <cstdlib>  // strtof
+#include <memory>
+
+namespace HeightMap {
+    // The grid, row by row in Y, machine coordinates
+    static float* heights    = nullptr;
+    static int    n_x        = 0;
+    static int    n_y        = 0;
+    static float  origin[2]  = { 0.0f, 0.0f };
+    static float  spacing[2] = { 1.0f, 1.0f };
+    static bool   enabled    = false;
+
+    bool active() { return enabled; }
+
+    void enable(bool on) { enabled = on && heights; }
+
+    bool loaded() { return heights != nullptr; }
+
+    void clear() {
+        enabled = false;
+        delete[] heights;
+        heights = nullptr;
+        n_x = n_y = 0;
+    }
+
+    static void allocate(int nx, int ny) {
+        clear();
+        n_x     = nx;
+        n_y     = ny;
+        heights = new float[nx * ny];
+    }
+
+    // Grid coordinate of a position along one axis, clamped to the grid
+    static float grid_coordinate(float position, int axis, int n) {
+        float u = (position - origin[axis]) / spacing[axis];
+        return u < 0.0f ? 0.0f : u > float(n - 1) ? float(n - 1) : u;
+    }
+
+    float offset(float x, float y) {
+        if (!heights) {
+            return 0.0f;
+        }
+        float u  = grid_coordinate(x, 0, n_x);
+        float v  = grid_coordinate(y, 1, n_y);
+        int   i  = std::min(int(u), n_x - 2);
+        int   j  = std::min(int(v), n_y - 2);
+        float fu = u - i;
+        float fv = v - j;
+
+        const float* row0 = &heights[j * n_x + i];
+        const float* row1 = row0 + n_x;
+        float        z0   = row0[0] + fu * (row0[1] - row0[0]);
+        float        z1   = row1[0] + fu * (row1[1] - row1[0]);
+        return z0 + fv * (z1 - z0);
+    }
+
+    // Fraction of the line at which one coordinate next reaches a grid line, after t
+    static float axis_crossing(float from, float to, int axis, int n, float t) {
+        float delta = to - from;
+        if (delta == 0.0f) {
+            return 1.0f;
+        }
+        float position = from + t * delta;
+        float cell     = (position - origin[axis]) / spacing[axis];
+        float line     = delta > 0.0f ? floorf(cell) + 1.0f : ceilf(cell) - 1.0f;
+        // Ignore the grid line at the current position, or one that rounding has put behind it
+        float crossing = (origin[axis] + line * spacing[axis] - from) / delta;
+        if (crossing <= t + 1e-6f) {
+            line += delta > 0.0f ? 1.0f : -1.0f;
+            crossing = (origin[axis] + line * spacing[axis] - from) / delta;
+        }
+        // Beyond the grid the offset is constant, so there is nothing to follow
+        if (line < 0.0f || line > float(n - 1)) {
+            return 1.0f;
+        }
+        return std::min(crossing, 1.0f);
+    }
+
+    float next_crossing(const float* start, const float* end, float t) {
+        float tx = axis_crossing(start[X_AXIS], end[X_AXIS], 0, n_x, t);
+        float ty = axis_crossing(start[Y_AXIS], end[Y_AXIS], 1, n_y, t);
+        return std::min(tx, ty);
+    }
+
+    static Error run_gcode(const char* line, Channel& out) {
+        Error err = gc_execute_line(line);
+        if (err != Error::Ok) {
+            log_error_to(out, "Height map probing failed at: " << line);
+        }
+        return err;
+    }
+
+    Error probe(Channel& out, float x0, float y0, float x1, float y1, int nx, int ny, float depth, float clearance, float feed) {
+        if (nx < 2 || ny < 2 || nx > MAX_POINTS || ny > MAX_POINTS || x1 <= x0 || y1 <= y0 || depth >= clearance || feed <= 0.0f) {
+            return Error::InvalidValue;
+        }
+        if (!config->_probe->exists()) {
+            log_error_to(out, "Probe pin is not configured");
+            return Error::InvalidStatement;
+        }
+
+        // The lines of the probing moves must not be compensated by an earlier map.
+        allocate(nx, ny);
+        float* wco = get_wco();
+        origin[0]  = x0 + wco[X_AXIS];
+        origin[1]  = y0 + wco[Y_AXIS];
+        spacing[0] = (x1 - x0) / (nx - 1);
+        spacing[1] = (y1 - y0) / (ny - 1);
+
+        char line[80];
+        snprintf(line, sizeof(line), "G90G0Z%.3f", clearance);
+        Error err = run_gcode(line, out);
+        // Rows alternate in direction, so that the tool does not travel back across the stock.
+        for (int j = 0; j < ny && err == Error::Ok; j++) {
+            for (int k = 0; k < nx && err == Error::Ok; k++) {
+                int i = (j & 1) ? nx - 1 - k : k;
+                snprintf(line, sizeof(line), "G0X%.3fY%.3f", x0 + i * spacing[0], y0 + j * spacing[1]);
+                if ((err = run_gcode(line, out)) != Error::Ok) {
+                    break;
+                }
+                snprintf(line, sizeof(line), "G38.2Z%.3fF%.1f", depth, feed);
+                if ((err = run_gcode(line, out)) != Error::Ok) {
+                    break;
+                }
+                if (sys.abort || !probe_succeeded) {
+                    err = sys.abort ? Error::Reset : Error::SystemGcLock;  // The probe cycle has raised an alarm
+                    break;
+                }
+                float contact[MAX_N_AXIS];
+                probe_steps_to_mpos(contact);
+                heights[j * nx + i] = contact[Z_AXIS];
+                log_info_to(out, "Height map " << i << "," << j << " Z:" << contact[Z_AXIS]);
+
+                snprintf(line, sizeof(line), "G0Z%.3f", clearance);
+                err = run_gcode(line, out);
+            }
+        }
+        if (err != Error::Ok) {
+            clear();
+            return err;
+        }
+
+        float reference = heights[0];
+        for (int n = 0; n < nx * ny; n++) {
+            heights[n] -= reference;
+        }
+        enable(true);
+        return save(DEFAULT_FILE, out);
+    }
+
+    void show(Channel& out) {
+        if (!heights) {
+            log_stream(out, "[HEIGHTMAP none]");
+            return;
+        }
+        log_stream(out,
+                   "[HEIGHTMAP " << (enabled ? "on" : "off") << " size:" << n_x << "x" << n_y << " origin:" << origin[0] << "," << origin[1]
+                                 << " spacing:" << spacing[0] << "," << spacing[1] << "]");
+        for (int j = 0; j < n_y; j++) {
+            LogStream msg(out, MsgLevelNone);
+            msg << "[HEIGHTMAP Y" << j << ":";
+            for (int i = 0; i < n_x; i++) {
+                msg << (i ? "," : "") << heights[j * n_x + i];
+            }
+            msg << "]";
+        }
+    }
+
+    // The file holds "nx ny x0 y0 dx dy" followed by the heights row by row.
+    Error save(std::string_view filename, Channel& out) {
+        if (!heights) {
+            log_error_to(out, "No height map");
+            return Error::InvalidStatement;
+        }
+        try {
+            FileStream file(std::string { filename }, "w", "");
+            log_stream(file, n_x << " " << n_y << " " << origin[0] << " " << origin[1] << " " << spacing[0] << " " << spacing[1]);
+            for (int j = 0; j < n_y; j++) {
+                LogStream msg(file, MsgLevelNone);
+                for (int i = 0; i < n_x; i++) {
+                    msg << (i ? " " : "") << heights[j * n_x + i];
+                }
+            }
+            log_info_to(out, "Height map saved to " << file.path());
+        } catch (...) {
+            log_error_to(out, "Cannot open " << filename);
+            return Error::FsFailedCreateFile;
+        }
+        return Error::Ok;
+    }
+
+    Error load(std::string_view filename, Channel& out) {
+        std::unique_ptr<char[]> buffer;
+        try {
+            FileStream file(std::string { filename }, "r", "");
+            auto       filesize = file.size();
+            buffer              = std::make_unique<char[]>(filesize + 1);
+            buffer[filesize]    = '\0';
+            if (file.read(buffer.get(), filesize) != filesize) {
+                return Error::FsFailedRead;
+            }
+        } catch (...) {
+            log_error_to(out, "Cannot open " << filename);
+            return Error::FsFailedOpenFile;
+        }
+
+        char* pos    = buffer.get();
+        auto  number = [&pos](float& value) {
+            char* end = pos;
+            value     = strtof(pos, &end);
+            bool ok   = end != pos;
+            pos       = end;
+            return ok;
+        };
+        float nx, ny, x0, y0, dx, dy;
+        if (!number(nx) || !number(ny) || !number(x0) || !number(y0) || !number(dx) || !number(dy) || nx < 2 || ny < 2 || nx > MAX_POINTS ||
+            ny > MAX_POINTS || dx <= 0.0f || dy <= 0.0f) {
+            log_error_to(out, "Bad height map header in " << filename);
+            return Error::InvalidValue;
+        }
+        allocate(int(nx), int(ny));
+        origin[0]  = x0;
+        origin[1]  = y0;
+        spacing[0] = dx;
+        spacing[1] = dy;
+        for (int n = 0; n < n_x * n_y; n++) {
+            if (!number(heights[n])) {
+                log_error_to(out, "Height map " << filename << " is short");
+                clear();
+                return Error::InvalidValue;
+            }
+        }
+        enable(true);
+        log_info_to(out, "Height map " << n_x << "x" << n_y << " loaded from " << filename);
+        return Error::Ok;
+    }
+}
@@ -0,0 +1,51 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  HeightMap.h - probed surface height map and Z compensation
+
+  A grid of probed Z heights over a rectangle of the XY plane, for engraving or milling stock
+  that is not flat, such as PCBs.  When the map is enabled, mc_linear() adds the height of the
+  surface below the tool to the Z of every move.  Between grid points the height is the bilinear
+  interpolation of the four surrounding points, and outside the grid that of the nearest edge.
+
+  Positions and heights are in machine coordinates.  Heights are relative to the first probed
+  point, so Z work coordinates set on that point stay valid.
+*/
+
+#include "Error.h"
+
+#include <cstdint>
+#include <string_view>
+
+class Channel;
+
+namespace HeightMap {
+    const int         MAX_POINTS   = 32;  // Grid points along each axis
+    const char* const DEFAULT_FILE = "heightmap.txt";
+
+    // True when a map is loaded and compensation is turned on.
+    bool active();
+    void enable(bool on);
+    bool loaded();
+
+    // Z offset of the surface at machine position x, y.
+    float offset(float x, float y);
+
+    // Returns the fraction of the line from start to end at which it next crosses a grid line after
+    // the fraction t, or 1 if it does not.  mc_linear() splits compensated lines there, so the line
+    // follows the interpolated surface cell by cell; within a cell it runs straight.
+    float next_crossing(const float* start, const float* end, float t);
+
+    // Probes an nx by ny grid over the rectangle from x0,y0 to x1,y1 in work coordinates.  Each
+    // point is approached at work Z clearance, and probed with G38.2 down to work Z depth at feed.
+    // The map is enabled and saved to DEFAULT_FILE when all points have been probed.
+    Error probe(Channel& out, float x0, float y0, float x1, float y1, int nx, int ny, float depth, float clearance, float feed);
+
+    void  show(Channel& out);
+    Error save(std::string_view filename, Channel& out);
+    Error load(std::string_view filename, Channel& out);
+    void  clear();
+}
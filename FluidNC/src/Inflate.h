@@ -0,0 +1,473 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  Inflate.h - streaming gzip decoder
+
+  Decompresses a gzip file as it is read, so that a compressed job can run without
+  being expanded first.  Memory is fixed: the 32 KiB window that deflate back
+  references can reach, supplied by the caller, a small input buffer and the Huffman
+  tables of the current block.  Output is produced on demand; a back reference that
+  does not fit in the caller's buffer is finished on the next call.  Each member's
+  CRC and length are checked, and concatenated members are decoded in turn.
+
+  Huffman codes are decoded a bit at a time from canonical code counts, as in zlib's
+  puff.c, which needs no lookup tables and is fast enough for G-code.  It is
+  header-only so that it can be tested on the host.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+class Inflater {
+public:
+    // Reads up to length bytes of compressed data, returning 0 at the end
+    using Source = size_t (*)(void* arg, uint8_t* buffer, size_t length);
+
+    static const size_t window_size = 32768;
+
+private:
+    enum class State : uint8_t { Header, Block, Stored, Codes, Trailer, Done, Failed };
+
+    static const int maxBits  = 15;
+    static const int maxLCode = 286;
+    static const int maxDCode = 30;
+    static const int fixLCode = 288;
+
+    struct Huffman {
+        uint16_t count[maxBits + 1];  // Number of codes of each length
+        uint16_t symbol[fixLCode];    // Symbols ordered by code
+    };
+
+    Source   _source;
+    void*    _arg;
+    uint8_t* _window;
+
+    uint8_t _in[256];
+    size_t  _in_pos = 0;
+    size_t  _in_len = 0;
+
+    uint32_t _bitbuf = 0;
+    int      _bitcnt = 0;
+
+    State    _state = State::Header;
+    bool     _last  = false;
+    uint32_t _stored_left;
+    uint32_t _match_len  = 0;
+    uint32_t _match_dist = 0;
+
+    uint32_t _window_pos = 0;
+    uint32_t _member_out = 0;  // Bytes output by this member, modulo 2^32 as in the trailer
+    uint32_t _crc        = 0;
+    uint64_t _total_out  = 0;
+
+    Huffman _lencode;
+    Huffman _distcode;
+
+    int next_byte() {
+        if (_in_pos == _in_len) {
+            _in_len = _source(_arg, _in, sizeof(_in));
+            _in_pos = 0;
+            if (_in_len == 0) {
+                return -1;
+            }
+        }
+        return _in[_in_pos++];
+    }
+
+    bool need(int n) {
+        while (_bitcnt < n) {
+            int c = next_byte();
+            if (c < 0) {
+                _state = State::Failed;
+                return false;
+            }
+            _bitbuf |= uint32_t(c) << _bitcnt;
+            _bitcnt += 8;
+        }
+        return true;
+    }
+
+    // Returns n bits, or 0 after setting Failed at the end of the input
+    uint32_t bits(int n) {
+        if (!need(n)) {
+            return 0;
+        }
+        uint32_t value = _bitbuf & ((1u << n) - 1);
+        _bitbuf >>= n;
+        _bitcnt -= n;
+        return value;
+    }
+
+    int byte() { return int(bits(8)); }
+
+    uint32_t le32() {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) {
+            value |= uint32_t(byte()) << (8 * i);
+        }
+        return value;
+    }
+
+    void to_byte_boundary() {
+        _bitbuf >>= _bitcnt & 7;
+        _bitcnt &= ~7;
+    }
+
+    static uint32_t crc32_update(uint32_t crc, uint8_t b) {
+        static const uint32_t table[16] = { 0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4,
+                                            0x4db26158, 0x5005713c, 0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+                                            0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c };
+        crc ^= b;
+        crc = (crc >> 4) ^ table[crc & 15];
+        crc = (crc >> 4) ^ table[crc & 15];
+        return crc;
+    }
+
+    void put(uint8_t*& out, uint8_t b) {
+        *out++                                     = b;
+        _window[_window_pos++ & (window_size - 1)] = b;
+        _crc                                       = crc32_update(_crc, b);
+        ++_member_out;
+        ++_total_out;
+    }
+
+    // Builds the code counts and symbol order from code lengths.  Returns 0 for a
+    // complete code, a positive number for an incomplete one, and -1 if the lengths
+    // are over-subscribed.
+    static int construct(Huffman& h, const uint8_t* length, int n) {
+        memset(h.count, 0, sizeof(h.count));
+        for (int symbol = 0; symbol < n; symbol++) {
+            h.count[length[symbol]]++;
+        }
+        if (h.count[0] == n) {
+            return 0;  // No codes, which is complete but unusable
+        }
+        int left = 1;
+        for (int len = 1; len <= maxBits; len++) {
+            left <<= 1;
+            left -= h.count[len];
+            if (left < 0) {
+                return -1;
+            }
+        }
+        uint16_t offs[maxBits + 1];
+        offs[1] = 0;
+        for (int len = 1; len < maxBits; len++) {
+            offs[len + 1] = offs[len] + h.count[len];
+        }
+        for (int symbol = 0; symbol < n; symbol++) {
+            if (length[symbol] != 0) {
+                h.symbol[offs[length[symbol]]++] = symbol;
+            }
+        }
+        return left;
+    }
+
+    int decode(const Huffman& h) {
+        int code  = 0;  // Bits read so far
+        int first = 0;  // First code of this length
+        int index = 0;  // Index of that code in symbol[]
+        for (int len = 1; len <= maxBits; len++) {
+            if (!need(1)) {
+                return -1;
+            }
+            code |= _bitbuf & 1;
+            _bitbuf >>= 1;
+            --_bitcnt;
+            int count = h.count[len];
+            if (code - count < first) {
+                return h.symbol[index + (code - first)];
+            }
+            index += count;
+            first += count;
+            first <<= 1;
+            code <<= 1;
+        }
+        _state = State::Failed;  // Ran out of codes
+        return -1;
+    }
+
+    void fixed_tables() {
+        uint8_t lengths[fixLCode];
+        int     symbol = 0;
+        for (; symbol < 144; symbol++) {
+            lengths[symbol] = 8;
+        }
+        for (; symbol < 256; symbol++) {
+            lengths[symbol] = 9;
+        }
+        for (; symbol < 280; symbol++) {
+            lengths[symbol] = 7;
+        }
+        for (; symbol < fixLCode; symbol++) {
+            lengths[symbol] = 8;
+        }
+        construct(_lencode, lengths, fixLCode);
+        for (symbol = 0; symbol < maxDCode; symbol++) {
+            lengths[symbol] = 5;
+        }
+        construct(_distcode, lengths, maxDCode);
+    }
+
+    bool dynamic_tables() {
+        static const uint8_t order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+        int nlen  = bits(5) + 257;
+        int ndist = bits(5) + 1;
+        int ncode = bits(4) + 4;
+        if (_state == State::Failed || nlen > maxLCode || ndist > maxDCode) {
+            return false;
+        }
+
+        uint8_t lengths[maxLCode + maxDCode];
+        int     index;
+        for (index = 0; index < ncode; index++) {
+            lengths[order[index]] = bits(3);
+        }
+        for (; index < 19; index++) {
+            lengths[order[index]] = 0;
+        }
+        if (construct(_lencode, lengths, 19) != 0) {
+            return false;  // The code length code must be complete
+        }
+
+        for (index = 0; index < nlen + ndist;) {
+            int symbol = decode(_lencode);
+            if (symbol < 0) {
+                return false;
+            }
+            if (symbol < 16) {
+                lengths[index++] = symbol;
+                continue;
+            }
+            uint8_t len = 0;
+            int     repeat;
+            if (symbol == 16) {
+                if (index == 0) {
+                    return false;  // Nothing to repeat
+                }
+                len    = lengths[index - 1];
+                repeat = 3 + bits(2);
+            } else if (symbol == 17) {
+                repeat = 3 + bits(3);
+            } else {
+                repeat = 11 + bits(7);
+            }
+            if (_state == State::Failed || index + repeat > nlen + ndist) {
+                return false;
+            }
+            while (repeat--) {
+                lengths[index++] = len;
+            }
+        }
+        if (lengths[256] == 0) {
+            return false;  // No end of block code
+        }
+
+        // Incomplete codes are only allowed if there is a single code of length 1
+        int err = construct(_lencode, lengths, nlen);
+        if (err < 0 || (err > 0 && nlen - _lencode.count[0] != 1)) {
+            return false;
+        }
+        err = construct(_distcode, lengths + nlen, ndist);
+        if (err < 0 || (err > 0 && ndist - _distcode.count[0] != 1)) {
+            return false;
+        }
+        return true;
+    }
+
+    bool gzip_header() {
+        const int FHCRC = 2, FEXTRA = 4, FNAME = 8, FCOMMENT = 16;
+
+        if (byte() != 0x1f || byte() != 0x8b || byte() != 8) {
+            return false;  // Not gzip, or not deflate
+        }
+        int flags = byte();
+        for (int i = 0; i < 6; i++) {
+            byte();  // Time, extra flags and OS
+        }
+        if (flags & FEXTRA) {
+            int length = byte();
+            length |= byte() << 8;
+            while (length-- && _state != State::Failed) {
+                byte();
+            }
+        }
+        if (flags & FNAME) {
+            while (byte() && _state != State::Failed) {}
+        }
+        if (flags & FCOMMENT) {
+            while (byte() && _state != State::Failed) {}
+        }
+        if (flags & FHCRC) {
+            byte();
+            byte();
+        }
+        _crc        = 0xffffffff;
+        _member_out = 0;
+        return _state != State::Failed;
+    }
+
+    // Returns false at the end of the input
+    bool more_input() {
+        if (_bitcnt) {
+            return true;
+        }
+        if (_in_pos == _in_len) {
+            _in_len = _source(_arg, _in, sizeof(_in));
+            _in_pos = 0;
+        }
+        return _in_pos < _in_len;
+    }
+
+public:
+    // window must hold window_size bytes
+    Inflater(Source source, void* arg, uint8_t* window) : _source(source), _arg(arg), _window(window) {}
+
+    Inflater(const Inflater&)            = delete;
+    Inflater& operator=(const Inflater&) = delete;
+
+    // Starts again; the source must also be back at the start of the gzip data
+    void reset() {
+        _in_pos = _in_len = 0;
+        _bitbuf           = 0;
+        _bitcnt           = 0;
+        _state            = State::Header;
+        _last             = false;
+        _match_len        = 0;
+        _window_pos       = 0;
+        _total_out        = 0;
+    }
+
+    bool     failed() const { return _state == State::Failed; }
+    bool     done() const { return _state == State::Done; }
+    uint64_t total_out() const { return _total_out; }
+
+    // Decompresses up to length bytes into buffer, returning fewer only at the end of
+    // the data or after an error
+    size_t read(uint8_t* buffer, size_t length) {
+        static const uint16_t lbase[29]  = { 3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23,  27,
+                                             31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const uint8_t  lextra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        static const uint16_t dbase[30]  = { 1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+                                             193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+        static const uint8_t  dextra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+        uint8_t* out = buffer;
+        uint8_t* end = buffer + length;
+        while (out < end) {
+            if (_match_len) {
+                uint8_t b = _window[(_window_pos - _match_dist) & (window_size - 1)];
+                put(out, b);
+                --_match_len;
+                continue;
+            }
+            switch (_state) {
+                case State::Header:
+                    if (!gzip_header()) {
+                        _state = State::Failed;
+                        break;
+                    }
+                    _state = State::Block;
+                    break;
+
+                case State::Block: {
+                    if (_last) {
+                        _state = State::Trailer;
+                        break;
+                    }
+                    _last    = bits(1);
+                    int type = bits(2);
+                    if (_state == State::Failed) {
+                        break;
+                    }
+                    if (type == 0) {
+                        to_byte_boundary();
+                        uint32_t len  = bits(16);
+                        uint32_t nlen = bits(16);
+                        if (_state == State::Failed || len != (~nlen & 0xffff)) {
+                            _state = State::Failed;
+                            break;
+                        }
+                        _stored_left = len;
+                        _state       = State::Stored;
+                    } else if (type == 1) {
+                        fixed_tables();
+                        _state = State::Codes;
+                    } else if (type == 2 && dynamic_tables()) {
+                        _state = State::Codes;
+                    } else {
+                        _state = State::Failed;
+                    }
+                } break;
+
+                case State::Stored:
+                    if (_stored_left == 0) {
+                        _state = State::Block;
+                        break;
+                    }
+                    {
+                        int c = byte();
+                        if (_state == State::Failed) {
+                            break;
+                        }
+                        put(out, c);
+                        --_stored_left;
+                    }
+                    break;
+
+                case State::Codes: {
+                    int symbol = decode(_lencode);
+                    if (symbol < 0) {
+                        _state = State::Failed;
+                    } else if (symbol < 256) {
+                        put(out, symbol);
+                    } else if (symbol == 256) {
+                        _state = State::Block;
+                    } else {
+                        symbol -= 257;
+                        if (symbol >= 29) {
+                            _state = State::Failed;
+                            break;
+                        }
+                        uint32_t len = lbase[symbol] + bits(lextra[symbol]);
+                        symbol       = decode(_distcode);
+                        if (symbol < 0 || symbol >= 30) {
+                            _state = State::Failed;
+                            break;
+                        }
+                        uint32_t dist = dbase[symbol] + bits(dextra[symbol]);
+                        if (_state == State::Failed || dist > _member_out || dist > window_size) {
+                            _state = State::Failed;  // Reaches back before the start
+                            break;
+                        }
+                        _match_len  = len;
+                        _match_dist = dist;
+                    }
+                } break;
+
+                case State::Trailer: {
+                    to_byte_boundary();
+                    uint32_t crc  = le32();
+                    uint32_t size = le32();
+                    if (_state == State::Failed || crc != ~_crc || size != _member_out) {
+                        _state = State::Failed;
+                        break;
+                    }
+                    // Another member may follow
+                    _last  = false;
+                    _state = more_input() ? State::Header : State::Done;
+                } break;
+
+                case State::Done:
+                case State::Failed:
+                    return out - buffer;
+            }
+        }
+        return out - buffer;
+    }
+};
@@ -4,8 +4,19 @@
 #include "InputFile.h"
 
 #include "Report.h"
+#include "Job.h"        // Job::channel
+#include "Resume.h"     // Resume::line_done
+#include "PowerLoss.h"  // PowerLoss::line_done
+#include "SettingsDefinitions.h"  // sd_read_ahead
 
-InputFile::InputFile(const char* defaultFs, const char* path) : FileStream(path, "r", defaultFs) {}
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+InputFile::InputFile(const char* defaultFs, const char* path) : FileStream(path, "r", defaultFs) {
+    enable_read_ahead(sd_read_ahead->get() * 1024, sd_read_ahead_psram->get());
+}
 /*
   Read a line from the file
   Returns Error::Ok if a line was read, even if the line was empty.
@@ -13,6 +24,10 @@ InputFile::InputFile(const char* defaultFs, const char* path) : FileStream(path,
   Returns other Error code on error, after displaying a message.
 */
 Error InputFile::readLine(char* line, int maxlen) {
+    return nextLine(line, maxlen, _line_number);
+}
+
+Error InputFile::nextLine(char* line, int maxlen, size_t& line_number) {
     int len = 0;
     int c;
     while ((c = read()) >= 0) {
@@ -23,7 +38,7 @@ Error InputFile::readLine(char* line, int maxlen) {
             continue;
         }
         if (c == '\n') {
-            ++_line_number;
+            ++line_number;
             if (len == 0) {
                 ++_blank_lines;
             }
@@ -36,6 +51,11 @@ Error InputFile::readLine(char* line, int maxlen) {
 }
 
 void InputFile::ack(Error status) {
+    // A line that nested another job has not finished
+    if (status == Error::Ok && Job::active() && Job::channel() == this) {
+        Resume::line_done(*this, lineNumber(), _line_end);
+        PowerLoss::line_done(*this, lineNumber(), _line_end);
+    }
     if (status != Error::Ok) {
         log_error(static_cast<int>(status) << " (" << errorString(status) << ") in " << name() << " at line " << lineNumber());
         if (status != Error::GcodeUnsupportedCommand) {
@@ -80,7 +100,29 @@ Error InputFile::pollLine(char* line) {
         end_message();
         return Error::Eof;
     }
-    switch (auto err = readLine(line, Channel::maxLine)) {
+    Error err;
+    if (_prefetch_count) {
+        auto& next = _prefetched[_prefetch_head];
+        strcpy(line, next.line);
+        _line_number   = next.line_number;
+        _line_end      = next.end;
+        _prefetch_head = (_prefetch_head + 1) % prefetchLines;
+        --_prefetch_count;
+        err = Error::Ok;
+    } else if (_prefetch_status != Error::Ok) {
+        err              = _prefetch_status;
+        _prefetch_status = Error::Ok;
+    } else {
+        // The read-ahead buffer, unlike stdio, is not locked against prefetch()
+        while (_file_busy.test_and_set(std::memory_order_acquire)) {
+            vTaskDelay(1);
+        }
+        err       = readLine(line, Channel::maxLine);
+        _line_end = position();
+        _file_busy.clear(std::memory_order_release);
+        _read_sync = needsSync(line);
+    }
+    switch (err) {
         case Error::Ok: {
             float percent_complete = ((float)position()) * 100.0f / size();
 
@@ -98,4 +140,138 @@ Error InputFile::pollLine(char* line) {
     }
 }
 
+// Lines that can make the executor read, move or replace the file: O words for flow
+// control, M codes such as M2, M30 and M6 that end the file or run macros, $ commands
+// that can run other files, and % which can end the file.
+bool InputFile::needsSync(const char* line) {
+    return strpbrk(line, "OoMm$%") != nullptr;
+}
+
+void InputFile::prefetch() {
+    if (_read_sync || _prefetch_count == prefetchLines || _prefetch_status != Error::Ok) {
+        return;
+    }
+    if (_file_busy.test_and_set(std::memory_order_acquire)) {
+        return;
+    }
+    if (_closed) {
+        _file_busy.clear(std::memory_order_release);
+        return;
+    }
+    if (!_prefetch_count) {
+        _prefetch_line = _line_number;
+    }
+    auto& slot = _prefetched[(_prefetch_head + _prefetch_count) % prefetchLines];
+    Error err  = nextLine(slot.line, Channel::maxLine, _prefetch_line);
+    slot.end   = position();
+    _file_busy.clear(std::memory_order_release);
+    if (err != Error::Ok) {
+        // Reported by pollLine() once the lines before it have been returned
+        _prefetch_status = err;
+        return;
+    }
+    slot.line_number = _prefetch_line;
+    _read_sync       = needsSync(slot.line);
+    ++_prefetch_count;
+}
+
+void InputFile::set_position(size_t pos) {
+    _prefetch_count  = 0;
+    _prefetch_status = Error::Ok;
+    _read_sync       = false;
+    FileStream::set_position(pos);
+}
+
+void InputFile::read_labels() {
+    _labels_read  = true;
+    _labels_valid = true;
+
+    size_t here        = position();
+    size_t blank_lines = _blank_lines;
+    size_t line_number = 0;
+    char   line[Channel::maxLine];
+    set_position(_start);
+    for (size_t start = _start;; start = position()) {
+        Error err = nextLine(line, Channel::maxLine, line_number);
+        if (err != Error::Ok) {
+            _labels_valid = err == Error::Eof;
+            break;
+        }
+        // Find the first word the way collapseGCode() would see it
+        const char* p       = line;
+        bool        comment = false;
+        bool        first   = true;
+        for (; *p && *p != ';'; ++p) {
+            if (comment) {
+                comment = *p != ')';
+            } else if (*p == '(') {
+                comment = true;
+            } else if (*p == '%') {
+                _labels.push_back({ 0, start, line_number });
+            } else if (*p == 'O' || *p == 'o') {
+                char*         digits;
+                unsigned long o_label = strtoul(p + 1, &digits, 10);
+                if (!first || digits == p + 1 || o_label == 0) {
+                    _labels_valid = false;  // A label that only the parser can evaluate
+                    break;
+                }
+                _labels.push_back({ uint32_t(o_label), start, line_number });
+                break;
+            } else if (!isspace(*p)) {
+                first = false;
+            }
+        }
+        if (!_labels_valid) {
+            break;
+        }
+    }
+    set_position(here);
+    _blank_lines = blank_lines;
+    if (!_labels_valid) {
+        _labels.clear();
+    }
+}
+
+bool InputFile::skip_to_label(uint32_t o_label) {
+    // O word lines stop reading ahead, so the file is positioned just after this one
+    if (_prefetch_count) {
+        return false;
+    }
+    if (!_labels_read) {
+        read_labels();
+    }
+    if (!_labels_valid) {
+        return false;
+    }
+    size_t here = position();
+    auto   it   = std::lower_bound(_labels.begin(), _labels.end(), here, [](const Label& l, size_t pos) { return l.position < pos; });
+    for (; it != _labels.end(); ++it) {
+        if (it->o_label == 0) {
+            return false;  // A % line must still be read
+        }
+        if (it->o_label == o_label) {
+            set_position(it->position);
+            _line_number = it->line_number - 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+// The read position is kept across save() and restore(), so lines that were read ahead
+// are still the next ones when the file is reopened.
+void InputFile::save() {
+    while (_file_busy.test_and_set(std::memory_order_acquire)) {
+        vTaskDelay(1);
+    }
+    FileStream::save();
+    _closed = true;
+    _file_busy.clear(std::memory_order_release);
+}
+
+void InputFile::restore() {
+    FileStream::restore();
+    _closed = false;
+}
+
 InputFile::~InputFile() {}
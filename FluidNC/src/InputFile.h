@@ -18,6 +18,8 @@
 #include "Error.h"
 
 #include <cstdint>
+#include <atomic>
+#include <vector>
 
 class InputFile : public FileStream {
 private:
@@ -26,6 +28,51 @@ private:
 
     size_t _blank_lines = 0;
 
+    // Lines read ahead of the executor by prefetch(), oldest first.  Reading ahead stops
+    // after a line that can make the executor touch the file, such as an O word that
+    // moves the file position or a command that nests another job, so that the file
+    // is always positioned after that line when it executes.
+    static const int prefetchLines = 4;
+    struct Prefetched {
+        char   line[Channel::maxLine];
+        size_t line_number;
+        size_t end;  // File position after the line
+    };
+    Prefetched _prefetched[prefetchLines];
+    int        _prefetch_head   = 0;  // Next line to return
+    int        _prefetch_count  = 0;
+    size_t     _prefetch_line   = 0;  // Line number of the last line read
+    Error      _prefetch_status = Error::Ok;
+    bool       _read_sync       = false;  // The last line read must execute before reading on
+    size_t     _line_end        = 0;      // File position after the line pollLine() returned
+
+    // A macro can nest a job and close this file, via save(), at any time from the
+    // executor task, so the file is held while prefetch() reads it in the polling task.
+    std::atomic_flag _file_busy = ATOMIC_FLAG_INIT;
+    bool             _closed    = false;
+
+    // Where each O word line is, built on the first skip_to_label(), so that skipped flow
+    // control blocks are passed over with one seek.  Lines with % are noted as well, since
+    // reading them can end the file even inside a skipped block.
+    struct Label {
+        uint32_t o_label;  // Zero for a % line
+        size_t   position;
+        size_t   line_number;
+    };
+    std::vector<Label> _labels;
+    bool               _labels_read  = false;
+    bool               _labels_valid = false;  // False if some O word is not a plain number
+
+    static bool needsSync(const char* line);
+    void        read_labels();
+
+protected:
+    size_t _start = 0;  // Position of the first line
+
+    // Reads the next line into line, counting it in line_number.  A file whose contents
+    // are not G-code text overrides this to decode them into lines.
+    virtual Error nextLine(char* line, int len, size_t& line_number);
+
 public:
     // fsname is the default file system on which the file is located, in case the path does not specify
     // path is the full path to the file
@@ -51,6 +98,11 @@ public:
     size_t write(uint8_t c) override { return 0; }
     void   ack(Error status) override;
     Error  pollLine(char* line) override;
+    void   prefetch() override;
+    void   set_position(size_t pos) override;
+    void   save() override;
+    void   restore() override;
+    bool   skip_to_label(uint32_t o_label) override;
 
     ~InputFile();
 };
@@ -0,0 +1,159 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  InputShaper.h - input shaping of the segment generator output
+
+  An input shaper replaces every move with the sum of a few time-shifted, scaled copies of
+  itself.  The delays and amplitudes are chosen so that the copies cancel the ringing they
+  excite at the resonant frequency of the machine.  The shaped position of an axis at time t
+  is sum(A_i * p(t - T_i)), where p is the unshaped position.
+
+  The segment generator records the unshaped position at the end of every segment in a
+  ShaperHistory.  Within a segment the velocity is constant, so the unshaped position is
+  exactly the linear interpolation between the recorded points.
+
+  Times are in step timer ticks and are only ever subtracted, so they may wrap.
+*/
+
+#include <cstdint>
+#include <cmath>
+
+// Shaper types, selected per axis by the axis "shaper" config item.
+enum ShaperType : int {
+    SHAPER_NONE = 0,
+    SHAPER_ZV,   // Two impulses over half the ringing period.  Shortest, least robust.
+    SHAPER_ZVD,  // Three impulses over a full period.  Tolerant of a frequency error.
+    SHAPER_MZV,  // Three impulses over 3/4 period.  Between ZV and ZVD.
+};
+
+const int MAX_SHAPER_IMPULSES = 3;
+
+struct ShaperImpulses {
+    int      count;                           // 1 when shaping is disabled
+    float    amplitude[MAX_SHAPER_IMPULSES];  // Sums to 1
+    uint32_t delay[MAX_SHAPER_IMPULSES];      // In timer ticks, ascending, delay[0] == 0
+};
+
+// Computes the impulses of a shaper for the given ringing frequency (Hz) and damping ratio.
+inline void shaper_impulses(int type, float frequency, float damping, uint32_t ticks_per_second, ShaperImpulses& out) {
+    out.count        = 1;
+    out.amplitude[0] = 1.0f;
+    out.delay[0]     = 0;
+    if (type == SHAPER_NONE || frequency <= 0.0f) {
+        return;
+    }
+
+    float root   = sqrtf(1.0f - damping * damping);
+    float period = 1.0f / (frequency * root);  // Damped ringing period (s)
+    float K      = expf(-damping * float(M_PI) / root);
+
+    float a[MAX_SHAPER_IMPULSES];
+    float t[MAX_SHAPER_IMPULSES];
+    switch (type) {
+        case SHAPER_ZV:
+            out.count = 2;
+            a[0]      = 1.0f;
+            a[1]      = K;
+            t[0]      = 0.0f;
+            t[1]      = 0.5f * period;
+            break;
+        case SHAPER_ZVD:
+            out.count = 3;
+            a[0]      = 1.0f;
+            a[1]      = 2.0f * K;
+            a[2]      = K * K;
+            t[0]      = 0.0f;
+            t[1]      = 0.5f * period;
+            t[2]      = period;
+            break;
+        default:  // SHAPER_MZV
+        {
+            float k   = expf(-0.75f * damping * float(M_PI) / root);
+            float a1  = 1.0f - 1.0f / sqrtf(2.0f);
+            out.count = 3;
+            a[0]      = a1;
+            a[1]      = (sqrtf(2.0f) - 1.0f) * k;
+            a[2]      = a1 * k * k;
+            t[0]      = 0.0f;
+            t[1]      = 0.375f * period;
+            t[2]      = 0.75f * period;
+        } break;
+    }
+
+    float sum = 0.0f;
+    for (int i = 0; i < out.count; i++) {
+        sum += a[i];
+    }
+    for (int i = 0; i < out.count; i++) {
+        out.amplitude[i] = a[i] / sum;
+        out.delay[i]     = uint32_t(t[i] * float(ticks_per_second) + 0.5f);
+    }
+}
+
+// Ring of (time, unshaped position) samples for n_axis axes, newest last.  Lookups further back
+// than the oldest sample return the oldest position, so N must cover the longest shaper delay
+// at the shortest segment time that occurs in practice.
+template <int N, int MAX_AXIS>
+class ShaperHistory {
+    uint32_t _time[N];
+    float    _position[N][MAX_AXIS];
+    int      _newest = 0;
+    int      _count  = 1;
+    int      _n_axis = 0;
+
+public:
+    uint32_t now() const { return _time[_newest]; }
+
+    // Starts over with the machine at rest at position.
+    void reset(uint32_t now, const float* position, int n_axis) {
+        _n_axis  = n_axis;
+        _newest  = 0;
+        _count   = 1;
+        _time[0] = now;
+        for (int axis = 0; axis < n_axis; axis++) {
+            _position[0][axis] = position[axis];
+        }
+    }
+
+    // Records the unshaped position at the end of a segment that lasted duration ticks.
+    void push(uint32_t duration, const float* position) {
+        uint32_t now = _time[_newest] + duration;
+        _newest      = _newest == N - 1 ? 0 : _newest + 1;
+        if (_count < N) {
+            ++_count;
+        }
+        _time[_newest] = now;
+        for (int axis = 0; axis < _n_axis; axis++) {
+            _position[_newest][axis] = position[axis];
+        }
+    }
+
+    // Unshaped position of axis, delay ticks before the newest sample.
+    float sample(int axis, uint32_t delay) const {
+        uint32_t now   = _time[_newest];
+        int      newer = _newest;
+        for (int n = 1; n < _count; n++) {
+            int      older = newer == 0 ? N - 1 : newer - 1;
+            uint32_t age   = now - _time[older];
+            if (age >= delay) {
+                uint32_t newer_age = now - _time[newer];
+                float    frac      = float(delay - newer_age) / float(age - newer_age);  // 0 at newer, 1 at older
+                return _position[newer][axis] + frac * (_position[older][axis] - _position[newer][axis]);
+            }
+            newer = older;
+        }
+        return _position[newer][axis];
+    }
+
+    // Shaped position of axis at the time of the newest sample.
+    float shaped(int axis, const ShaperImpulses& impulses) const {
+        float position = 0.0f;
+        for (int i = 0; i < impulses.count; i++) {
+            position += impulses.amplitude[i] * sample(axis, impulses.delay[i]);
+        }
+        return position;
+    }
+};
@@ -16,6 +16,12 @@ JSONencoder::JSONencoder(std::string* str) : level(0), _str(str), category("nvs"
     count[level] = 0;
 }
 
+JSONencoder::JSONencoder(Sink sink, size_t chunk_size) :
+    level(0), _str(&linebuf), _sink(sink), _chunk_size(chunk_size), category("nvs") {
+    count[level] = 0;
+    linebuf.reserve(chunk_size + 100);
+}
+
 void JSONencoder::flush() {
     if (_channel && (*_str).length()) {
         if (_encapsulate) {
@@ -26,12 +32,19 @@ void JSONencoder::flush() {
         }
         (*_str).clear();
     }
+    if (_sink && (*_str).length()) {
+        _sink(*_str);
+        (*_str).clear();
+    }
 }
 void JSONencoder::add(char c) {
     (*_str) += c;
     if (_channel && (*_str).length() >= 100) {
         flush();
     }
+    if (_sink && (*_str).length() >= _chunk_size) {
+        flush();
+    }
 }
 
 void JSONencoder::verbatim(const std::string& s) {
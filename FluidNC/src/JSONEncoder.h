@@ -6,6 +6,10 @@
 // Class for creating JSON-encoded strings.
 
 class JSONencoder {
+public:
+    // Receives pieces of the encoded text as they are produced
+    using Sink = void (*)(const std::string& s);
+
 private:
     static const int MAX_JSON_LEVEL = 16;
 
@@ -26,6 +30,8 @@ private:
 
     std::string* _str     = nullptr;
     Channel*     _channel = nullptr;
+    Sink         _sink    = nullptr;
+    size_t       _chunk_size = 0;
 
     std::string category;
 
@@ -36,6 +42,10 @@ public:
     JSONencoder(bool encapsulate, Channel* channel);
     explicit JSONencoder(std::string* str);
 
+    // Constructor for output that is too large to hold in memory; the text is passed
+    // to sink in pieces of about chunk_size bytes, the last of them from end()
+    explicit JSONencoder(Sink sink, size_t chunk_size = 1024);
+
     // begin() starts the encoding process.
     void begin();
 
@@ -2,6 +2,9 @@
 // Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
 
 #include "Job.h"
+#include "PlannerStats.h"  // PlannerStats::job_start(), job_end()
+#include "JobStats.h"      // JobStats::job_start(), job_end()
+#include "JobQueue.h"      // JobQueue::clear()
 #include <map>
 #include <stack>
 
@@ -32,8 +35,12 @@ void Job::restore() {
 }
 void Job::nest(Channel* in_channel, Channel* out_channel) {
     auto source = new JobSource(in_channel);
-    if (out_channel && job.empty()) {
-        leader = out_channel;
+    if (job.empty()) {
+        PlannerStats::job_start();
+        JobStats::job_start();
+        if (out_channel) {
+            leader = out_channel;
+        }
     }
     job.push(source);
 }
@@ -43,6 +50,8 @@ void Job::pop() {
     delete source;
     if (!active()) {
         leader = nullptr;
+        PlannerStats::job_end();
+        JobStats::job_end();
     }
 }
 void Job::unnest() {
@@ -53,10 +62,11 @@ void Job::unnest() {
 }
 
 void Job::abort() {
-    // Kill all active jobs
+    // Kill all active jobs, and the ones queued to follow them
     while (active()) {
         pop();
     }
+    JobQueue::clear();
 }
 
 bool Job::get_param(const std::string& name, float& value) {
@@ -2,28 +2,24 @@
 // Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
 
 #include "Channel.h"
+#include "ParamTable.h"
 #include <stack>
 
 class JobSource {
 private:
-    Channel*                     _channel;
-    std::map<std::string, float> _local_params;
+    Channel*    _channel;
+    NamedParams _local_params;
 
 public:
     JobSource(Channel* channel) : _channel(channel) {}
     bool get_param(const std::string& name, float& value) {
-        auto it = _local_params.find(name);
-        if (it == _local_params.end()) {
-            return false;
-        }
-        value = it->second;
-        return true;
+        return _local_params.get(name, value);
     }
     bool set_param(const std::string& name, float value) {
-        _local_params[name] = value;
+        _local_params.set(name, value);
         return true;
     }
-    bool param_exists(const std::string& name) { return _local_params.count(name) != 0; }
+    bool param_exists(const std::string& name) { return _local_params.exists(name); }
 
     void   save() { _channel->save(); }
     void   restore() { _channel->restore(); }
@@ -31,6 +27,7 @@ public:
     void   set_position(size_t pos) { _channel->set_position(pos); }
     size_t lineNumber() { return _channel->lineNumber(); }
     void   setLineNumber(size_t line_number) { _channel->setLineNumber(line_number); }
+    bool   skip_to_label(uint32_t o_label) { return _channel->skip_to_label(o_label); }
 
     Channel* channel() { return _channel; }
 
@@ -0,0 +1,108 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "JobQueue.h"
+
+#include "FileCommands.h"  // openFile
+#include "InputFile.h"
+#include "Job.h"
+#include "Logging.h"
+
+#include <deque>
+#include <mutex>
+#include <string>
+
+namespace JobQueue {
+    struct Entry {
+        std::string fs;
+        std::string path;
+    };
+
+    // $Job/Queue runs in the executor task while the polling task reads the job, so
+    // everything here is under the mutex.
+    static std::mutex        queue_mutex;
+    static std::deque<Entry> pending;
+    static Channel*          leader  = nullptr;  // The channel of the last $Job/Queue
+    static InputFile*        running = nullptr;  // Only compared; its job deletes it
+    static InputFile*        next    = nullptr;  // pending.front(), opened ahead
+
+    // How close to its end the running file is read before the next is opened
+    static const size_t prefetch_margin = 4096;
+
+    static void drop_next() {
+        delete next;
+        next = nullptr;
+    }
+
+    static bool start_locked() {
+        running = nullptr;
+        if (pending.empty()) {
+            return false;
+        }
+        Entry      entry = pending.front();
+        InputFile* file  = next;
+        pending.pop_front();
+        next = nullptr;
+        if (!file && openFile(entry.fs.c_str(), entry.path.c_str(), *leader, file) != Error::Ok) {
+            log_error_to(*leader, "Cannot open " << entry.path << ", job queue cleared");
+            pending.clear();
+            return false;
+        }
+        log_info_to(*leader, "Job queue: " << entry.path << ", " << pending.size() << " more");
+        Job::nest(file, leader);
+        running = file;
+        return true;
+    }
+
+    Error add(const char* fs, const char* path, Channel& out) {
+        if (!path || !*path) {
+            log_string(out, "Missing file name!");
+            return Error::InvalidValue;
+        }
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        pending.push_back({ fs, path });
+        leader = &out;
+        if (!Job::active() && !start_locked()) {
+            return Error::FsFailedOpenFile;
+        }
+        return Error::Ok;
+    }
+
+    void show(Channel& out) {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (running && Job::active()) {
+            log_stream(out, "[JOB running:" << running->path() << "]");
+        }
+        for (auto const& entry : pending) {
+            log_stream(out, "[JOB queued:" << entry.path << (next && &entry == &pending.front() ? " (opened)" : "") << "]");
+        }
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        drop_next();
+        pending.clear();
+        running = nullptr;
+    }
+
+    void prefetch() {
+        std::unique_lock<std::mutex> lock(queue_mutex, std::try_to_lock);
+        if (!lock.owns_lock() || next || pending.empty() || !running || Job::channel() != running) {
+            return;
+        }
+        if (running->position() + prefetch_margin < running->size()) {
+            return;
+        }
+        // A file that cannot be opened now is reported by start_next()
+        auto&      entry = pending.front();
+        InputFile* file;
+        if (openFile(entry.fs.c_str(), entry.path.c_str(), *leader, file) == Error::Ok) {
+            next = file;
+        }
+    }
+
+    bool start_next() {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        return start_locked();
+    }
+}
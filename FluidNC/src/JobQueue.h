@@ -0,0 +1,26 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// JobQueue runs files one after another, for pallet jobs and the like.  $Job/Queue=<path>
+// adds a file, and starts it if no job is running.  When the running file has been read to
+// within a few KiB of its end, the next file is opened so that its read-ahead buffer fills
+// while the tail of the current one executes, and it starts as soon as the job stack empties.
+// An alarm or an error that aborts the job clears the queue.
+
+#include "Error.h"
+
+class Channel;
+
+namespace JobQueue {
+    Error add(const char* fs, const char* path, Channel& out);
+    void  show(Channel& out);
+    void  clear();
+
+    // Called by the polling loop while a job line executes
+    void prefetch();
+
+    // Called by the polling loop when the job stack empties; true if another file started
+    bool start_next();
+}
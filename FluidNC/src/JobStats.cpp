@@ -0,0 +1,115 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "JobStats.h"
+
+#include "PlannerStats.h"        // PlannerStats::get()
+#include "Planner.h"             // plan_get_current_block()
+#include "Stepper.h"             // Stepper::get_realtime_rate(), get_isr_stats()
+#include "System.h"              // sys
+#include "Logging.h"             // log_info()
+#include "Driver/delay_usecs.h"  // ticks_per_us
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>  // xTaskGetTickCount()
+
+namespace JobStats {
+    static Summary  summary         = {};
+    static bool     running         = false;  // From the start of a job until its summary is logged
+    static bool     sent            = false;  // The job has ended, its motion may not have
+    static uint32_t start_time      = 0;
+    static uint32_t last_time       = 0;
+    static uint32_t start_underruns = 0;
+
+    static uint32_t underruns() {
+        Stepper::IsrStats stats;
+        Stepper::get_isr_stats(stats);
+        return stats.underruns;
+    }
+
+    static void report() {
+        PlannerStats::Stats total, job;
+        PlannerStats::get(total, job);
+        float starved_s = job.planner_ticks[0] / (ticks_per_us * 1e6f);
+
+        float wall_s = summary.wall_ms / 1000.0f;
+        log_info("Job time " << wall_s << "s cycle:" << (summary.cycle_ms / 1000.0f) << "s hold:" << (summary.hold_ms / 1000.0f)
+                             << "s idle:" << (summary.idle_ms / 1000.0f) << "s");
+        log_info("Job lines " << summary.lines << " " << (wall_s > 0 ? summary.lines / wall_s : 0.0f) << "/s");
+        float average = summary.programmed_ms > 0 ? float(100.0 * summary.feed_ms / summary.programmed_ms) : 0.0f;
+        log_info("Job feed average:" << average << "% of programmed peak:" << summary.peak_feed << "mm/min");
+        log_info("Job starved " << starved_s << "s planner empty:" << job.starved << " segment underruns:" << summary.underruns);
+    }
+
+    static void finish(uint32_t now) {
+        running           = false;
+        summary.wall_ms   = (now - start_time) * portTICK_PERIOD_MS;
+        summary.underruns = underruns() - start_underruns;
+        report();
+    }
+
+    void job_start() {
+        if (running) {
+            finish(xTaskGetTickCount());  // The motion of the previous job has not finished
+        }
+        summary         = {};
+        running         = true;
+        sent            = false;
+        start_time      = xTaskGetTickCount();
+        last_time       = start_time;
+        start_underruns = underruns();
+    }
+
+    void job_end() { sent = true; }
+
+    void line() {
+        if (running) {
+            ++summary.lines;
+        }
+    }
+
+    void poll() {
+        if (!running) {
+            return;
+        }
+        uint32_t now     = xTaskGetTickCount();
+        uint32_t elapsed = (now - last_time) * portTICK_PERIOD_MS;
+        if (elapsed == 0) {
+            return;
+        }
+        last_time = now;
+
+        switch (sys.state) {
+            case State::Cycle:
+            case State::Jog:
+            case State::Homing: {
+                summary.cycle_ms += elapsed;
+                float         feed  = Stepper::get_realtime_rate();
+                plan_block_t* block = plan_get_current_block();
+                if (block) {
+                    summary.feed_ms += double(feed) * elapsed;
+                    summary.programmed_ms += double(block->programmed_rate) * elapsed;
+                }
+                if (feed > summary.peak_feed) {
+                    summary.peak_feed = feed;
+                }
+            } break;
+            case State::Hold:
+            case State::SafetyDoor:
+                summary.hold_ms += elapsed;
+                break;
+            case State::Idle:
+                summary.idle_ms += elapsed;
+                break;
+            default:
+                break;
+        }
+
+        // The summary covers the motion of the job, which continues after its last line is sent
+        bool at_rest = !plan_get_current_block() && sys.state != State::Cycle && sys.state != State::Hold;
+        if (sent && at_rest) {
+            finish(now);
+        }
+    }
+
+}
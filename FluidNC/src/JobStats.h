@@ -0,0 +1,49 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  JobStats.h - a performance summary of each job
+
+  From the start of the outermost job until its motion has finished, the polling task charges
+  the time to the machine state and samples the feed rate.  When the job has been sent and the
+  machine is at rest again, the summary is logged:
+
+    Job time   wall time, and the part of it in cycle, hold, and idle waiting for job lines
+    Job lines  lines delivered by the job channels, and lines per second of wall time
+    Job feed   time-weighted average of the achieved feed as a percentage of the programmed
+               feed, which excludes overrides, and the peak achieved feed
+    Job starved  cycle time that the planner was empty, see PlannerStats.h, and the number
+               of segment buffer underruns
+
+  The feed is sampled at the polling rate, so it is an estimate, but a consistent one across
+  settings, which is what comparing acceleration, jerk and transport settings needs.
+*/
+
+#include <cstdint>
+
+namespace JobStats {
+    struct Summary {
+        uint32_t wall_ms;
+        uint32_t cycle_ms;       // In Cycle, Jog or Homing state
+        uint32_t hold_ms;        // In Hold or SafetyDoor state
+        uint32_t idle_ms;        // In Idle state, waiting for the next line
+        uint32_t lines;          // Lines delivered by the job channels
+        uint32_t underruns;      // Segment buffer underruns
+        float    peak_feed;      // mm/min
+        double   feed_ms;        // Achieved feed in mm/min times ms, summed over the cycle time
+        double   programmed_ms;  // The same for the programmed feed
+    };
+
+    // Called by Job when the outermost job starts and ends
+    void job_start();
+    void job_end();
+
+    // Called by the polling task for each line that a job channel delivers
+    void line();
+
+    // Called by the polling task on each pass, to charge the time since the last pass
+    // and to log the summary when the motion of the job has finished
+    void poll();
+}
@@ -8,10 +8,20 @@
 #include "MotionControl.h"  // mc_linear
 #include "Stepper.h"        // st_prep_buffer, st_wake_up
 #include "Limits.h"         // constrainToSoftLimits()
+#include "SettingsDefinitions.h"  // jog_velocity_timeout
+#include "Logging.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
 
 // Sets up valid jog motion received from g-code parser, checks for soft-limits, and executes the jog.
 // cancelledInflight will be set to true if was not added to parser due to a cancelJog.
 Error jog_execute(plan_line_data_t* pl_data, parser_block_t* gc_block, bool* cancelledInflight) {
+    if (Stepper::velocity_jog_active()) {
+        return Error::IdleError;  // The planner is not in charge of the motion
+    }
     config->_kinematics->constrain_jog(gc_block->values.xyz, pl_data, gc_state.position);
 
     // Initialize planner data struct for jogging motions.
@@ -28,3 +38,98 @@ Error jog_execute(plan_line_data_t* pl_data, parser_block_t* gc_block, bool* can
     // The motion will be initiated by the cycle start mechanism
     return Error::Ok;
 }
+
+// Sets off a velocity jog that was started from Idle.  Returns false if it is against a soft
+// limit already, so nothing moved.
+static bool run_velocity_jog() {
+    set_state(State::Jog);
+    Stepper::prep_buffer();
+    if (!Stepper::velocity_jog_active()) {
+        Stepper::end_velocity_jog();
+        set_state(State::Idle);
+        return false;
+    }
+    Stepper::wake_up();
+    return true;
+}
+
+Error jog_velocity(const char* words, Channel& out) {
+    auto  n_axis = Axes::_numberAxis;
+    float direction[MAX_N_AXIS] = { 0.0f };
+    float feed                  = 0.0f;
+
+    size_t pos = 0;
+    while (words[pos]) {
+        char letter = toupper(words[pos++]);
+        if (isspace(letter)) {
+            continue;
+        }
+        float value;
+        if (!read_float(words, pos, value)) {
+            return Error::BadNumberFormat;
+        }
+        if (letter == 'F') {
+            feed = value;
+            continue;
+        }
+        auto axis = strchr(Axes::_names, letter);
+        if (!axis || size_t(axis - Axes::_names) >= n_axis) {
+            return Error::GcodeUnsupportedCommand;
+        }
+        direction[axis - Axes::_names] = value;
+    }
+    if (feed < 0.0f) {
+        return Error::NegativeValue;
+    }
+
+    // Scale the direction to the speed, then down until every axis is within its max rate
+    float length = 0.0f;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        length += direction[axis] * direction[axis];
+    }
+    length = sqrtf(length);
+    if (gc_state.modal.units == Units::Inches) {
+        feed *= MM_PER_INCH;
+    }
+    float velocity[MAX_N_AXIS] = { 0.0f };
+    if (length > 0.0f) {
+        float scale = feed / length;
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            if (direction[axis] != 0.0f) {
+                scale = std::min(scale, Axes::_axis[axis]->_maxRate / fabsf(direction[axis]));
+            }
+        }
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            velocity[axis] = direction[axis] * scale;
+        }
+    }
+    bool moving = length > 0.0f && feed > 0.0f;
+
+    if (Stepper::velocity_jog_active()) {
+        Stepper::velocity_jog(velocity, jog_velocity_timeout->get());
+        return Error::Ok;
+    }
+    if (!moving) {
+        return Error::Ok;
+    }
+    if (!state_is(State::Idle) || plan_get_current_block()) {
+        return Error::IdleError;
+    }
+    Stepper::velocity_jog(velocity, jog_velocity_timeout->get());
+    if (!run_velocity_jog()) {
+        log_info_to(out, "Jog blocked by a soft limit");
+    }
+    return Error::Ok;
+}
+
+Error jog_follow(const float* distance) {
+    if (state_is(State::Jog)) {
+        return Stepper::follow_jog(distance, false) ? Error::Ok : Error::IdleError;
+    }
+    if (!state_is(State::Idle) || plan_get_current_block()) {
+        return Error::IdleError;
+    }
+    Stepper::follow_jog(distance, true);
+    run_velocity_jog();
+    return Error::Ok;
+}
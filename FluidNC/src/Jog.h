@@ -8,9 +8,23 @@
 #include "Planner.h"
 #include "GCode.h"
 
+class Channel;
+
 // System motion line numbers must be zero.
 const int JOG_LINE_NUMBER = 0;
 
 // Sets up valid jog motion received from g-code parser, checks for soft-limits, and executes the jog.
 // cancelledInflight will be set to true if was not added to parser due to a cancelJog.
 Error jog_execute(plan_line_data_t* pl_data, parser_block_t* gc_block, bool* cancelledInflight);
+
+// Starts or steers a velocity mode jog, which the segment generator runs without the planner,
+// see Stepper::velocity_jog().  words is like "X1 Y-1 F1000": the axis words give the direction
+// and F the speed along it, in the current units per minute.  Without axis words or F, or with
+// F0, the jog decelerates to a stop.  The host repeats the command at least every
+// $Jog/VelocityTimeout ms while the jog runs, so that a lost connection stops the machine.
+Error jog_velocity(const char* words, Channel& out);
+
+// Moves by distance, in mm per axis, as a velocity jog steered by position, see
+// Stepper::follow_jog().  From Idle it starts one; while it runs, the distances add up.
+// Refused while anything else moves the machine.
+Error jog_follow(const float* distance);
@@ -27,10 +27,15 @@ namespace Kinematics {
         float* target, plan_line_data_t* pl_data, float* position, float center[3], float radius, size_t caxes[3], bool is_clockwise_arc) {
         pl_data->limits_checked = true;
 
-        auto axes = config->_axes;
-        // Handle the orthognal axis first to get it out of the way.
-        size_t the_axis = caxes[2];
-        if (axes->_axis[the_axis]->_softLimits) {
+        auto axes   = config->_axes;
+        auto n_axis = Axes::_numberAxis;
+        // Handle the axes outside the circle plane first to get them out of the way.  They move
+        // linearly, so their range is that of the endpoints.  The arc segments are not checked
+        // individually, so this covers every axis, not just the orthogonal one.
+        for (size_t the_axis = 0; the_axis < n_axis; the_axis++) {
+            if (the_axis == caxes[0] || the_axis == caxes[1] || !axes->_axis[the_axis]->_softLimits) {
+                continue;
+            }
             float amin = std::min(position[the_axis], target[the_axis]);
             if (amin < limitsMinPosition(the_axis)) {
                 limit_error(the_axis, amin);
@@ -154,7 +159,7 @@ namespace Kinematics {
         }
         // Now check limits based on arc endpoints and axis crossings
         for (size_t a = 0; a < 2; ++a) {
-            the_axis = caxes[a];
+            size_t the_axis = caxes[a];
             if (limited[a]) {
                 // If we crossed the axis in the positive half plane, the
                 // maximum extent along that axis is at center + radius.
@@ -285,7 +290,13 @@ namespace Kinematics {
         axisMask = Machine::Axes::motors_to_axes(motorMask);
 
         // Return true when an axis drops out of the mask, causing replan
-        // on any remaining axes.
+        // on any remaining axes.  With parallel homing the limited motors are
+        // already held by Stepping::limit() and the others keep moving along
+        // the planned vector, in which each axis has its own homing rate, so
+        // the motion only stops when the last axis reaches its switch.
+        if (Machine::Axes::_homing_parallel) {
+            return axisMask != oldAxisMask && !axisMask;
+        }
         return axisMask != oldAxisMask;
     }
 
@@ -38,6 +38,8 @@ namespace Kinematics {
         virtual void init_position() override;
         void         motors_to_cartesian(float* cartesian, float* motors, int n_axis) override;
         bool         transform_cartesian_to_motors(float* cartesian, float* motors) override;
+        bool         native_arcs() override { return true; }
+        LinearKind   linear_kind(float& x_scaler) override { return LinearKind::Cartesian; }
 
         bool         canHome(AxisMask axisMask) override;
         void         releaseMotors(AxisMask axisMask, MotorMask motors) override;
@@ -41,6 +41,12 @@ namespace Kinematics {
         void         afterParse() override {}
 
         bool transform_cartesian_to_motors(float* motors, float* cartesian) override;
+        bool native_arcs() override { return false; }
+
+        LinearKind linear_kind(float& x_scaler) override {
+            x_scaler = _x_scaler;
+            return LinearKind::CoreXY;
+        }
 
         ~CoreXY() {}
 
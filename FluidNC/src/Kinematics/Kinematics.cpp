@@ -5,6 +5,7 @@
 #include "Kinematics.h"
 
 #include "src/Config.h"
+#include "src/Machine/Axes.h"  // Machine::Axes::_numberAxis
 #include "Cartesian.h"
 
 namespace Kinematics {
@@ -24,13 +25,48 @@ namespace Kinematics {
         return _system->invalid_arc(target, pl_data, position, center, radius, caxes, is_clockwise_arc);
     }
 
+#if FAST_KINEMATICS_AXES
+    using FastCartesian = Linear<LinearKind::Cartesian, FAST_KINEMATICS_AXES>;
+    using FastCoreXY    = Linear<LinearKind::CoreXY, FAST_KINEMATICS_AXES>;
+#endif
+
     bool Kinematics::cartesian_to_motors(float* target, plan_line_data_t* pl_data, float* position) {
         Assert(_system != nullptr, "No kinematic system");
+#if FAST_KINEMATICS_AXES
+        switch (_fast) {
+            case LinearKind::Cartesian:
+                return mc_move_motors(target, pl_data);
+            case LinearKind::CoreXY: {
+                float motors[MAX_N_AXIS];
+                FastCoreXY::to_motors(motors, target, _x_scaler);
+                if (!pl_data->motion.rapidMotion) {
+                    pl_data->feed_rate *= FastCoreXY::feed_scale(target, position, _x_scaler);
+                }
+                return mc_move_motors(motors, pl_data);
+            }
+            case LinearKind::None:
+                break;
+        }
+#endif
         return _system->cartesian_to_motors(target, pl_data, position);
     }
 
     void Kinematics::motors_to_cartesian(float* cartesian, float* motors, int n_axis) {
         Assert(_system != nullptr, "No kinematic system");
+#if FAST_KINEMATICS_AXES
+        if (n_axis == FAST_KINEMATICS_AXES) {
+            switch (_fast) {
+                case LinearKind::Cartesian:
+                    FastCartesian::to_cartesian(cartesian, motors, _x_scaler);
+                    return;
+                case LinearKind::CoreXY:
+                    FastCoreXY::to_cartesian(cartesian, motors, _x_scaler);
+                    return;
+                case LinearKind::None:
+                    break;
+            }
+        }
+#endif
         return _system->motors_to_cartesian(cartesian, motors, n_axis);
     }
 
@@ -56,9 +92,38 @@ namespace Kinematics {
 
     bool Kinematics::transform_cartesian_to_motors(float* motors, float* cartesian) {
         Assert(_system != nullptr, "No kinematics system.");
+#if FAST_KINEMATICS_AXES
+        switch (_fast) {
+            case LinearKind::Cartesian:
+                FastCartesian::to_motors(motors, cartesian, _x_scaler);
+                return true;
+            case LinearKind::CoreXY:
+                FastCoreXY::to_motors(motors, cartesian, _x_scaler);
+                return true;
+            case LinearKind::None:
+                break;
+        }
+#endif
         return _system->transform_cartesian_to_motors(motors, cartesian);
     }
 
+    bool Kinematics::native_arcs() {
+        Assert(_system != nullptr, "No kinematics system.");
+        return _system->native_arcs();
+    }
+
+    bool Kinematics::has_tcp() {
+        Assert(_system != nullptr, "No kinematics system.");
+        return _system->has_tcp();
+    }
+
+    void Kinematics::set_tcp(bool on) {
+        Assert(_system != nullptr, "No kinematics system.");
+        if (_system->has_tcp()) {
+            _system->set_tcp(on);
+        }
+    }
+
     void Kinematics::group(Configuration::HandlerBase& handler) {
         ::Kinematics::KinematicsFactory::factory(handler, _system);
     }
@@ -72,6 +137,12 @@ namespace Kinematics {
     void Kinematics::init() {
         Assert(_system != nullptr, "init: Kinematics system missing.");
         _system->init();
+
+        // After init(), which sets the x_scaler of a Midtbot
+        _fast = _system->linear_kind(_x_scaler);
+        if (Machine::Axes::_numberAxis != FAST_KINEMATICS_AXES) {
+            _fast = LinearKind::None;
+        }
     }
 
     void Kinematics::init_position() {
@@ -7,6 +7,7 @@
 #include "src/Planner.h"
 #include "src/Types.h"
 #include "src/Machine/Homing.h"
+#include "LinearKinematics.h"
 
 /*
 Special types
@@ -39,6 +40,9 @@ namespace Kinematics {
         bool cartesian_to_motors(float* target, plan_line_data_t* pl_data, float* position);
         void motors_to_cartesian(float* cartesian, float* motors, int n_axis);
         bool transform_cartesian_to_motors(float* motors, float* cartesian);
+        bool native_arcs();
+        bool has_tcp();
+        void set_tcp(bool on);
 
         void constrain_jog(float* target, plan_line_data_t* pl_data, float* position);
         bool invalid_line(float* target);
@@ -52,6 +56,10 @@ namespace Kinematics {
 
     private:
         ::Kinematics::KinematicSystem* _system = nullptr;
+
+        // The specialized path for the system, see LinearKinematics.h
+        LinearKind _fast     = LinearKind::None;
+        float      _x_scaler = 1.0f;
     };
 
     class KinematicSystem : public Configuration::Configurable {
@@ -81,6 +89,19 @@ namespace Kinematics {
 
         virtual bool transform_cartesian_to_motors(float* motors, float* cartesian) = 0;
 
+        // True if the planner can queue arcs as single blocks. This requires motor space
+        // to be cartesian space, since the segment generator interpolates arcs in motor space.
+        virtual bool native_arcs() { return false; }
+
+        // The linear system whose specialized transforms, see LinearKinematics.h, are equivalent
+        // to this one's, with its x_scaler for CoreXY.  A subclass that changes the transforms
+        // must return LinearKind::None.
+        virtual LinearKind linear_kind(float& x_scaler) { return LinearKind::None; }
+
+        // Tool center point control, G43.4. set_tcp() is only called if has_tcp().
+        virtual bool has_tcp() { return false; }
+        virtual void set_tcp(bool on) {}
+
         virtual bool canHome(AxisMask axisMask) { return false; }
         virtual void releaseMotors(AxisMask axisMask, MotorMask motors) {}
         virtual bool limitReached(AxisMask& axisMask, MotorMask& motors, MotorMask limited) { return false; }
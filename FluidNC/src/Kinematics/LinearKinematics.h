@@ -0,0 +1,83 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  LinearKinematics.h - compile-time specialized transforms of the linear kinematic systems
+
+  Cartesian and CoreXY motor positions are linear in the cartesian position, so a line stays a
+  line and needs only its end points transformed.  Linear<Kind, N> does that for N axes with
+  the loops unrolled at compile time.  Kinematics, the front end that the motion path calls,
+  uses it instead of the virtual KinematicSystem methods when the configured system and axis
+  count match a specialization built in, see FAST_KINEMATICS_AXES.
+*/
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// The axis count of the specialized paths; 0 leaves every system on the virtual path
+#ifndef FAST_KINEMATICS_AXES
+#    define FAST_KINEMATICS_AXES 3
+#endif
+
+namespace Kinematics {
+    // The kinematic systems that have specialized paths
+    enum class LinearKind : uint8_t {
+        None,       // Not linear, or not specialized
+        Cartesian,  // Motor space is cartesian space
+        CoreXY,     // See CoreXY.h; x_scaler is 2 for a Midtbot
+    };
+
+    template <LinearKind Kind, size_t N>
+    struct Linear {
+        static_assert(Kind != LinearKind::None, "No specialization");
+        static_assert(Kind != LinearKind::CoreXY || N >= 2, "CoreXY needs X and Y");
+
+        static void to_motors(float* motors, const float* cartesian, float x_scaler) {
+            size_t axis = 0;
+            if (Kind == LinearKind::CoreXY) {
+                motors[0] = (x_scaler * cartesian[0]) + cartesian[1];
+                motors[1] = (x_scaler * cartesian[0]) - cartesian[1];
+                axis      = 2;
+            }
+            for (; axis < N; axis++) {
+                motors[axis] = cartesian[axis];
+            }
+        }
+
+        static void to_cartesian(float* cartesian, const float* motors, float x_scaler) {
+            size_t axis = 0;
+            if (Kind == LinearKind::CoreXY) {
+                cartesian[0] = 0.5f * (motors[0] + motors[1]) / x_scaler;
+                cartesian[1] = 0.5f * (motors[0] - motors[1]);
+                axis         = 2;
+            }
+            for (; axis < N; axis++) {
+                cartesian[axis] = motors[axis];
+            }
+        }
+
+        // The ratio of the motor distance to the cartesian distance of the move from position to
+        // target, by which cartesian_to_motors() scales the feed rate.  Since the transform is
+        // linear, the motor move is the transform of the cartesian move.
+        static float feed_scale(const float* target, const float* position, float x_scaler) {
+            if (Kind == LinearKind::Cartesian) {
+                return 1.0f;
+            }
+            float dx        = target[0] - position[0];
+            float dy        = target[1] - position[1];
+            float mx        = (x_scaler * dx) + dy;
+            float my        = (x_scaler * dx) - dy;
+            float cartesian = dx * dx + dy * dy;
+            float motor     = mx * mx + my * my;
+            for (size_t axis = 2; axis < N; axis++) {
+                float d = target[axis] - position[axis];
+                cartesian += d * d;
+                motor += d * d;
+            }
+            return cartesian == 0.0f ? 1.0f : sqrtf(motor / cartesian);
+        }
+    };
+}
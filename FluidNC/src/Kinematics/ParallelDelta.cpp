@@ -7,6 +7,7 @@
 #include "../Protocol.h"  // protocol_execute_realtime
 
 #include <cmath>
+#include <algorithm>  // std::max
 
 /*
   ==================== How it Works ====================================
@@ -33,6 +34,20 @@
   angles. This is done by calculating the segment move distance and the angle 
   move distance and applying that ration to the feedrate. 
 
+  With kinematic_tolerance_mm, the segments are as long as the path allows instead
+  of kinematic_segment_len_mm.  A segment is halved until the arm angles at its middle
+  are within the tolerance, as a distance at the crank, of the straight motor move, or
+  until it is kinematic_segment_len_mm long.  Near the center, where the kinematics are
+  nearly linear, segments reach kinematic_max_segment_mm and the planner gets fewer
+  blocks; near the edges, they stay short.
+
+  With stepper_segments, a move is not split at all.  The planner plans the straight
+  cartesian line as one block and the segment generator computes the arm angles for
+  each step segment, so lookahead spans the real path length.  The axis max_rate,
+  acceleration and jerk then limit the cartesian motion of the end effector in mm,
+  and the arm speeds are not limited separately.  A move with an unreachable point,
+  checked every kinematic_segment_len_mm, is split as before so that it stops there.
+
   FYI: http://forums.trossenrobotics.com/tutorials/introduction-129/delta-robot-kinematics-3276/
   Better: http://hypertriangle.com/~alex/delta-robot-tutorial/
 
@@ -74,6 +89,9 @@ namespace Kinematics {
         handler.item("linkage_mm", re, 20.0, 500.0);
         handler.item("end_effector_triangle_mm", e, 20.0, 500.0);
         handler.item("kinematic_segment_len_mm", _kinematic_segment_len_mm, 0.05, 20.0);  //
+        handler.item("kinematic_tolerance_mm", _kinematic_tolerance_mm, 0.0, 1.0);
+        handler.item("kinematic_max_segment_mm", _kinematic_max_segment_mm, 0.05, 100.0);
+        handler.item("stepper_segments", _stepper_segments);
         handler.item("homing_mpos_radians", _homing_mpos);
         handler.item("soft_limits", _softLimits);
         handler.item("max_z_mm", _max_z, -10000.0, 0.0);  //
@@ -121,9 +139,23 @@ namespace Kinematics {
         return false;
     }
 
-    // TO DO. This is not supported yet. Other levels of protection will prevent "damage"
+    // Checks the arc once instead of per arc segment.  cartesian_to_motors() transforms every
+    // kinematic segment of every arc segment and stops at the first unreachable one, so checking each
+    // arc segment target beforehand only repeats that work.  What is left to check up front is the
+    // end point, and for arcs in the XY plane the Z range against max_z.  Arcs in the other planes
+    // can rise above their end points, so for those the arc segments are still checked one by one.
     bool ParallelDelta::invalid_arc(
         float* target, plan_line_data_t* pl_data, float* position, float center[3], float radius, size_t caxes[3], bool is_clockwise_arc) {
+        if (!_softLimits || caxes[2] != Z_AXIS) {
+            return false;
+        }
+
+        float motors[MAX_N_AXIS] = { 0.0, 0.0, 0.0 };
+        if (std::max(position[Z_AXIS], target[Z_AXIS]) > _max_z || !transform_cartesian_to_motors(motors, target)) {
+            limit_error();
+            return true;
+        }
+        pl_data->limits_checked = true;
         return false;
     }
 
@@ -188,10 +220,27 @@ namespace Kinematics {
         dx         = target[X_AXIS] - position[X_AXIS];
         dy         = target[Y_AXIS] - position[Y_AXIS];
         dz         = target[Z_AXIS] - position[Z_AXIS];
-        float dist = sqrt((dx * dx) + (dy * dy) + (dz * dz));
+        float dist = sqrtf((dx * dx) + (dy * dy) + (dz * dz));
+
+        float delta[3] = { dx, dy, dz };
+        if (_stepper_segments && dist > 0.0f && mc_kinematic_line(pl_data) && line_reachable(position, delta, dist)) {
+            float motors[MAX_N_AXIS];
+            copyAxes(motors, target);  // Other axes are not transformed
+            memcpy(motors, motor_angles, sizeof(motor_angles));
+            pl_data->feed_rate = feed_rate;  // Planned in cartesian space
+            if (!mc_move_kinematic(target, position, motors, pl_data)) {
+                return false;
+            }
+            memcpy(last_angle, motor_angles, sizeof(motor_angles));
+            return true;
+        }
+
+        if (_kinematic_tolerance_mm > 0.0f && dist > _kinematic_segment_len_mm) {
+            return adaptive_segments(position, delta, dist, feed_rate, pl_data);
+        }
 
         // determine the number of segments we need	... round up so there is at least 1 (except when dist is 0)
-        uint32_t segment_count = ceil(dist / _kinematic_segment_len_mm);
+        uint32_t segment_count = ceilf(dist / _kinematic_segment_len_mm);
 
         float segment_dist = dist / ((float)segment_count);  // distance of each segment...will be used for feedrate conversion
 
@@ -217,23 +266,113 @@ namespace Kinematics {
                 }
                 return false;
             }
-            if (pl_data->motion.rapidMotion) {
-                pl_data->feed_rate = feed_rate;
-            } else {
-                float delta_distance = three_axis_dist(motor_angles, last_angle);
-                pl_data->feed_rate   = (feed_rate * delta_distance / segment_dist);
+            if (!send_segment(motor_angles, segment_dist, feed_rate, pl_data)) {
+                return false;
             }
+        }
+        return true;
+    }
 
-            // mc_line() returns false if a jog is cancelled.
-            // In that case we stop sending segments to the planner.
-            if (!mc_move_motors(motor_angles, pl_data)) {
+    // True if the arms can reach every point along the move from position along delta, at
+    // kinematic_segment_len_mm spacing, so that the segment generator can follow it.
+    bool ParallelDelta::line_reachable(float* position, float* delta, float dist) {
+        uint32_t count = ceilf(dist / _kinematic_segment_len_mm);
+        for (uint32_t i = 1; i < count; i++) {
+            float point[3], angles[3];
+            for (int axis = 0; axis < 3; axis++) {
+                point[axis] = position[axis] + delta[axis] * i / count;
+            }
+            if (!transform_cartesian_to_motors(angles, point)) {
                 return false;
             }
+        }
+        return true;
+    }
 
-            // save angles for next distance calc
-            // This is after mc_line() so that we do not update
-            // last_angle if the segment was discarded.
-            memcpy(last_angle, motor_angles, sizeof(motor_angles));
+    // Queues a segment ending at motor_angles, converting the cartesian feed rate
+    bool ParallelDelta::send_segment(float* motor_angles, float segment_dist, float feed_rate, plan_line_data_t* pl_data) {
+        if (pl_data->motion.rapidMotion) {
+            pl_data->feed_rate = feed_rate;
+        } else {
+            float delta_distance = three_axis_dist(motor_angles, last_angle);
+            pl_data->feed_rate   = (feed_rate * delta_distance / segment_dist);
+        }
+
+        // mc_line() returns false if a jog is cancelled.
+        // In that case we stop sending segments to the planner.
+        if (!mc_move_motors(motor_angles, pl_data)) {
+            return false;
+        }
+
+        // save angles for next distance calc
+        // This is after mc_line() so that we do not update
+        // last_angle if the segment was discarded.
+        memcpy(last_angle, motor_angles, 3 * sizeof(float));
+        return true;
+    }
+
+    // Splits the move from position along delta into segments whose middles are within
+    // _kinematic_tolerance_mm of the straight motor move, see How it Works above.  Each
+    // halving reuses the middle that was found off the path as the new end, so a halving
+    // costs one inverse kinematics solution.
+    bool ParallelDelta::adaptive_segments(float* position, float* delta, float dist, float feed_rate, plan_line_data_t* pl_data) {
+        const float tolerance = _kinematic_tolerance_mm / rf;  // As an arm angle, in radians
+        const float min_step  = _kinematic_segment_len_mm / dist;
+        const float max_step  = std::max(_kinematic_max_segment_mm, _kinematic_segment_len_mm) / dist;
+
+        auto solve = [&](float fraction, float* angles) {
+            float point[3];
+            for (int axis = 0; axis < 3; axis++) {
+                point[axis] = position[axis] + delta[axis] * fraction;
+            }
+            if (!transform_cartesian_to_motors(angles, point)) {
+                log_error("Kinematic error motors (" << angles[0] << "," << angles[1] << "," << angles[2] << ")");
+                return false;
+            }
+            return true;
+        };
+
+        float start_angles[3];  // At done
+        if (!solve(0.0f, start_angles)) {
+            return false;
+        }
+        float done = 0.0f;      // The fraction of the move that has been queued
+        float step = max_step;  // The fraction to try for the next segment
+        while (done < 1.0f) {
+            if (sys.abort) {
+                return true;
+            }
+            float end = done + step;
+            if (end > 1.0f - min_step * 0.01f) {
+                end = 1.0f;  // Do not leave a sliver
+            }
+
+            float end_angles[3];
+            if (!solve(end, end_angles)) {
+                return false;
+            }
+            while (end - done > min_step) {
+                float mid = (done + end) / 2;
+                float mid_angles[3];
+                if (!solve(mid, mid_angles)) {
+                    return false;
+                }
+                float deviation = 0.0f;
+                for (int motor = 0; motor < 3; motor++) {
+                    deviation = std::max(deviation, fabsf(mid_angles[motor] - (start_angles[motor] + end_angles[motor]) / 2));
+                }
+                if (deviation <= tolerance) {
+                    break;
+                }
+                end = mid;
+                memcpy(end_angles, mid_angles, sizeof(end_angles));
+            }
+            if (!send_segment(end_angles, (end - done) * dist, feed_rate, pl_data)) {
+                return false;
+            }
+            memcpy(start_angles, end_angles, sizeof(start_angles));
+            step = std::min(2 * (end - done), max_step);  // The path changes gradually, so try a longer next segment
+            done = end;
         }
         return true;
     }
@@ -244,16 +383,16 @@ namespace Kinematics {
 
         float t = (f - e) * tan30 / 2;
 
-        float y1 = -(t + rf * cos(motors[0]));
-        float z1 = -rf * sin(motors[0]);
+        float y1 = -(t + rf * cosf(motors[0]));
+        float z1 = -rf * sinf(motors[0]);
 
-        float y2 = (t + rf * cos(motors[1])) * sin30;
+        float y2 = (t + rf * cosf(motors[1])) * sin30;
         float x2 = y2 * tan60;
-        float z2 = -rf * sin(motors[1]);
+        float z2 = -rf * sinf(motors[1]);
 
-        float y3 = (t + rf * cos(motors[2])) * sin30;
+        float y3 = (t + rf * cosf(motors[2])) * sin30;
         float x3 = -y3 * tan60;
-        float z3 = -rf * sin(motors[2]);
+        float z3 = -rf * sinf(motors[2]);
 
         float dnm = (y2 - y1) * x3 - (y3 - y1) * x2;
 
@@ -263,11 +402,11 @@ namespace Kinematics {
 
         // x = (a1*z + b1)/dnm
         float a1 = (z2 - z1) * (y3 - y1) - (z3 - z1) * (y2 - y1);
-        float b1 = -((w2 - w1) * (y3 - y1) - (w3 - w1) * (y2 - y1)) / 2.0;
+        float b1 = -((w2 - w1) * (y3 - y1) - (w3 - w1) * (y2 - y1)) / 2.0f;
 
         // y = (a2*z + b2)/dnm;
         float a2 = -(z2 - z1) * x3 + (z3 - z1) * x2;
-        float b2 = ((w2 - w1) * x3 - (w3 - w1) * x2) / 2.0;
+        float b2 = ((w2 - w1) * x3 - (w3 - w1) * x2) / 2.0f;
 
         // a*z^2 + b*z + c = 0
         float a = a1 * a1 + a2 * a2 + dnm * dnm;
@@ -280,7 +419,7 @@ namespace Kinematics {
             log_warn("Forward Kinematics Error");
             return;
         }
-        cartesian[Z_AXIS] = -(float)0.5 * (b + sqrt(d)) / a;
+        cartesian[Z_AXIS] = -(float)0.5 * (b + sqrtf(d)) / a;
         cartesian[X_AXIS] = (a1 * cartesian[Z_AXIS] + b1) / dnm;
         cartesian[Y_AXIS] = (a2 * cartesian[Z_AXIS] + b2) / dnm;
     }
@@ -307,8 +446,8 @@ namespace Kinematics {
 
     // helper functions, calculates angle theta1 (for YZ-pane)
     bool ParallelDelta::delta_calcAngleYZ(float x0, float y0, float z0, float& theta) {
-        float y1 = -0.5 * 0.57735 * f;  // f/2 * tg 30
-        y0 -= 0.5 * 0.57735 * e;        // shift center to edge
+        float y1 = -0.5f * 0.57735f * f;  // f/2 * tg 30
+        y0 -= 0.5f * 0.57735f * e;        // shift center to edge
         // z = a + b*y
         float a = (x0 * x0 + y0 * y0 + z0 * z0 + rf * rf - re * re - y1 * y1) / (2 * z0);
         float b = (y1 - y0) / z0;
@@ -318,10 +457,10 @@ namespace Kinematics {
             //log_warn("Kinematics: Target unreachable");
             return false;
         }                                                 // non-existing point
-        float yj = (y1 - a * b - sqrt(d)) / (b * b + 1);  // choosing outer point
+        float yj = (y1 - a * b - sqrtf(d)) / (b * b + 1);  // choosing outer point
         float zj = a + b * yj;
 
-        theta = atan(-zj / (y1 - yj)) + ((yj > y1) ? M_PI : 0.0);
+        theta = atanf(-zj / (y1 - yj)) + ((yj > y1) ? float(M_PI) : 0.0f);
 
         return true;
     }
@@ -360,7 +499,7 @@ namespace Kinematics {
 
     // Determine the unit distance between (2) 3D points
     float ParallelDelta::three_axis_dist(float* point1, float* point2) {
-        return sqrt(((point1[0] - point2[0]) * (point1[0] - point2[0])) + ((point1[1] - point2[1]) * (point1[1] - point2[1])) +
+        return sqrtf(((point1[0] - point2[0]) * (point1[0] - point2[0])) + ((point1[1] - point2[1]) * (point1[1] - point2[1])) +
                     ((point1[2] - point2[2]) * (point1[2] - point2[2])));
     }
 
@@ -37,6 +37,8 @@ namespace Kinematics {
         bool cartesian_to_motors(float* target, plan_line_data_t* pl_data, float* position) override;
         void motors_to_cartesian(float* cartesian, float* motors, int n_axis) override;
         bool transform_cartesian_to_motors(float* motors, float* cartesian) override;
+        bool native_arcs() override { return false; }
+        LinearKind linear_kind(float& x_scaler) override { return LinearKind::None; }
         //bool soft_limit_error_exists(float* cartesian) override;
         bool         kinematics_homing(AxisMask& axisMask) override;
         virtual void constrain_jog(float* cartesian, plan_line_data_t* pl_data, float* position) override;
@@ -66,7 +68,10 @@ namespace Kinematics {
         float re = 133.50;
         float e  = 86.603;
 
-        float _kinematic_segment_len_mm = 1.0;  // the maximun segment length the move is broken into
+        float _kinematic_segment_len_mm = 1.0;   // the maximun segment length the move is broken into
+        float _kinematic_tolerance_mm   = 0.0;   // With this, segments are as long as the path allows
+        float _kinematic_max_segment_mm = 10.0;  // The longest segment with a tolerance
+        bool  _stepper_segments         = false;  // Plan in cartesian space, see How it Works
         bool  _softLimits               = false;
         float _homing_mpos              = 0.0;
         float _max_z                    = 0.0;
@@ -74,6 +79,9 @@ namespace Kinematics {
 
         bool  delta_calcAngleYZ(float x0, float y0, float z0, float& theta);
         float three_axis_dist(float* point1, float* point2);
+        bool  send_segment(float* motor_angles, float segment_dist, float feed_rate, plan_line_data_t* pl_data);
+        bool  line_reachable(float* position, float* delta, float dist);
+        bool  adaptive_segments(float* position, float* delta, float dist, float feed_rate, plan_line_data_t* pl_data);
 
     protected:
     };
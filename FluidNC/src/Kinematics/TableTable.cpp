@@ -0,0 +1,248 @@
+#include "TableTable.h"
+
+#include "src/Machine/MachineConfig.h"
+#include "src/Limits.h"
+
+#include <cmath>
+#include <algorithm>  // std::max
+
+/*
+  ==================== How it Works ====================================
+  The part is fixed to the C table, which turns about its own axis.  The table is carried by
+  the A cradle, which tilts about a line parallel to X.  The spindle stays vertical, so the
+  tool length offset is an ordinary Z offset.
+
+  Without TCP (G49), motor space is cartesian space, as for Cartesian kinematics.  With TCP
+  (G43.4), X, Y and Z are the tool tip position in the frame of the table, measured as it is
+  at A0 C0.  A point of the part is turned by C about the C axis line and then tilted by A
+  about the A axis line, and the linear axes go to where the point has moved.  Set the work
+  offsets of the part with the rotaries at zero.
+
+  The tool tip moves in straight lines in the table frame, so the motors move on curves.
+  Each move is split into segments no longer than segment_len_mm along the tool tip path
+  and turning no more than segment_deg.  F is the tool tip feed rate along the path in the
+  table frame; for a move that only turns the rotaries, it is the feed over all axes, in mm
+  and degrees, as without TCP.  The feed of each segment is scaled by the ratio of its
+  motor distance to its share of that path.  With G93, each segment gets its share of the
+  move time.
+
+  With stepper_segments, a move is not split into planner blocks.  The planner plans the
+  line in the table frame as one block and the segment generator computes the motor
+  positions for each step segment.  The axis max_rate and acceleration then apply to the
+  motion in the table frame, and the motors are not limited separately.
+
+  Soft limits are checked against the motor positions at the ends of each line.
+
+Default configuration
+
+kinematics:
+  table_table:
+    a_axis: 3
+    c_axis: 5
+    a_pivot_y_mm: 0
+    a_pivot_z_mm: 0
+    c_pivot_x_mm: 0
+    c_pivot_y_mm: 0
+    reverse_a: false
+    reverse_c: false
+    segment_len_mm: 1.0
+    segment_deg: 1.0
+    stepper_segments: false
+*/
+
+namespace Kinematics {
+    const float dtr = M_PI / 180.0f;  // degrees to radians
+
+    void TableTable::group(Configuration::HandlerBase& handler) {
+        handler.item("a_axis", _a_axis, 0, MAX_N_AXIS - 1);
+        handler.item("c_axis", _c_axis, 0, MAX_N_AXIS - 1);
+        handler.item("a_pivot_y_mm", _a_pivot_y);
+        handler.item("a_pivot_z_mm", _a_pivot_z);
+        handler.item("c_pivot_x_mm", _c_pivot_x);
+        handler.item("c_pivot_y_mm", _c_pivot_y);
+        handler.item("reverse_a", _reverse_a);
+        handler.item("reverse_c", _reverse_c);
+        handler.item("segment_len_mm", _segment_len, 0.05, 20.0);
+        handler.item("segment_deg", _segment_deg, 0.05, 20.0);
+        handler.item("stepper_segments", _stepper_segments);
+    }
+
+    void TableTable::init() {
+        log_info("Kinematic system: " << name() << " A:" << Axes::axisName(_a_axis) << " C:" << Axes::axisName(_c_axis));
+        auto n_axis = Axes::_numberAxis;
+        _valid      = _a_axis != _c_axis && _a_axis > Z_AXIS && _c_axis > Z_AXIS && _a_axis < n_axis && _c_axis < n_axis;
+        if (!_valid) {
+            log_config_error("table_table needs two rotary axes after Z");
+        }
+        _tcp = false;
+        init_position();
+    }
+
+    // Where a point of the part at table, as at A0 C0, is with the rotaries at a and c radians
+    void TableTable::table_to_machine(float* machine, const float* table, float a, float c) {
+        float x = table[X_AXIS] - _c_pivot_x;
+        float y = table[Y_AXIS] - _c_pivot_y;
+        float z = table[Z_AXIS];
+
+        // C turns the point about the C axis line
+        float cos_c = cosf(c);
+        float sin_c = sinf(c);
+        float x1    = x * cos_c - y * sin_c + _c_pivot_x;
+        float y1    = x * sin_c + y * cos_c + _c_pivot_y;
+
+        // A tilts the table about the A axis line
+        float cos_a = cosf(a);
+        float sin_a = sinf(a);
+        float dy    = y1 - _a_pivot_y;
+        float dz    = z - _a_pivot_z;
+
+        machine[X_AXIS] = x1;
+        machine[Y_AXIS] = dy * cos_a - dz * sin_a + _a_pivot_y;
+        machine[Z_AXIS] = dy * sin_a + dz * cos_a + _a_pivot_z;
+    }
+
+    // The inverse of table_to_machine()
+    void TableTable::machine_to_table(float* table, const float* machine, float a, float c) {
+        float cos_a = cosf(a);
+        float sin_a = sinf(a);
+        float dy    = machine[Y_AXIS] - _a_pivot_y;
+        float dz    = machine[Z_AXIS] - _a_pivot_z;
+        float y1    = dy * cos_a + dz * sin_a + _a_pivot_y;
+        float z     = -dy * sin_a + dz * cos_a + _a_pivot_z;
+
+        float cos_c = cosf(c);
+        float sin_c = sinf(c);
+        float x     = machine[X_AXIS] - _c_pivot_x;
+        float y     = y1 - _c_pivot_y;
+
+        table[X_AXIS] = x * cos_c + y * sin_c + _c_pivot_x;
+        table[Y_AXIS] = -x * sin_c + y * cos_c + _c_pivot_y;
+        table[Z_AXIS] = z;
+    }
+
+    bool TableTable::transform_cartesian_to_motors(float* motors, float* cartesian) {
+        copyAxes(motors, cartesian);
+        if (_tcp) {
+            float a = (_reverse_a ? -dtr : dtr) * cartesian[_a_axis];
+            float c = (_reverse_c ? -dtr : dtr) * cartesian[_c_axis];
+            table_to_machine(motors, cartesian, a, c);
+        }
+        return true;
+    }
+
+    void TableTable::motors_to_cartesian(float* cartesian, float* motors, int n_axis) {
+        copyAxes(cartesian, motors);
+        if (_tcp) {
+            float a = (_reverse_a ? -dtr : dtr) * motors[_a_axis];
+            float c = (_reverse_c ? -dtr : dtr) * motors[_c_axis];
+            machine_to_table(cartesian, motors, a, c);
+        }
+    }
+
+    bool TableTable::cartesian_to_motors(float* target, plan_line_data_t* pl_data, float* position) {
+        if (!_tcp) {
+            return Cartesian::cartesian_to_motors(target, pl_data, position);
+        }
+        auto  n_axis = Axes::_numberAxis;
+        float motors[MAX_N_AXIS];
+
+        // The distance that F applies to, see How it Works
+        float tip_mm  = vector_distance(target, position, 3);
+        float move_mm = vector_distance(target, position, n_axis);
+        float path_mm = tip_mm > 0.0f ? tip_mm : move_mm;
+        if (path_mm == 0.0f) {
+            transform_cartesian_to_motors(motors, target);
+            return mc_move_motors(motors, pl_data);
+        }
+
+        float feed_rate = pl_data->feed_rate;
+        if (_stepper_segments && mc_kinematic_line(pl_data)) {
+            transform_cartesian_to_motors(motors, target);
+            if (!pl_data->motion.rapidMotion && !pl_data->motion.inverseTime) {
+                pl_data->feed_rate = feed_rate * move_mm / path_mm;  // The block is planned over all axes
+            }
+            return mc_move_kinematic(target, position, motors, pl_data);
+        }
+
+        float    turn     = std::max(fabsf(target[_a_axis] - position[_a_axis]), fabsf(target[_c_axis] - position[_c_axis]));
+        uint32_t segments = std::max(1.0f, std::max(ceilf(tip_mm / _segment_len), ceilf(turn / _segment_deg)));
+
+        float last_motors[MAX_N_AXIS], segment_end[MAX_N_AXIS];
+        transform_cartesian_to_motors(last_motors, position);
+        for (uint32_t segment = 1; segment <= segments; segment++) {
+            if (sys.abort) {
+                return true;
+            }
+            float fraction = float(segment) / segments;
+            for (size_t axis = 0; axis < n_axis; axis++) {
+                segment_end[axis] = position[axis] + (target[axis] - position[axis]) * fraction;
+            }
+            transform_cartesian_to_motors(motors, segment_end);
+
+            if (!pl_data->motion.rapidMotion) {
+                if (pl_data->motion.inverseTime) {
+                    pl_data->feed_rate = feed_rate * segments;
+                } else {
+                    pl_data->feed_rate = feed_rate * vector_distance(motors, last_motors, n_axis) * segments / path_mm;
+                }
+            }
+            // mc_move_motors() returns false if a jog is cancelled.
+            // In that case we stop sending segments to the planner.
+            if (!mc_move_motors(motors, pl_data)) {
+                return false;
+            }
+            copyAxes(last_motors, motors);
+        }
+        return true;
+    }
+
+    bool TableTable::within_limits(const float* motors) {
+        auto axes   = config->_axes;
+        auto n_axis = Axes::_numberAxis;
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            if (axes->_axis[axis]->_softLimits && (motors[axis] < limitsMinPosition(axis) || motors[axis] > limitsMaxPosition(axis))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // With TCP, a jog whose end is beyond the soft limits of a motor is dropped rather than
+    // shortened, since shortening it per axis in the table frame does not bring the motors in.
+    void TableTable::constrain_jog(float* target, plan_line_data_t* pl_data, float* position) {
+        if (!_tcp) {
+            Cartesian::constrain_jog(target, pl_data, position);
+            return;
+        }
+        float motors[MAX_N_AXIS];
+        transform_cartesian_to_motors(motors, target);
+        if (!within_limits(motors)) {
+            copyAxes(target, position);
+            log_debug("Jog beyond soft limits with TCP");
+        }
+        pl_data->limits_checked = true;
+    }
+
+    bool TableTable::invalid_line(float* cartesian) {
+        if (!_tcp) {
+            return Cartesian::invalid_line(cartesian);
+        }
+        float motors[MAX_N_AXIS];
+        transform_cartesian_to_motors(motors, cartesian);
+        return Cartesian::invalid_line(motors);
+    }
+
+    // With TCP, an arc is split into lines that are checked one by one
+    bool TableTable::invalid_arc(
+        float* target, plan_line_data_t* pl_data, float* position, float center[3], float radius, size_t caxes[3], bool is_clockwise_arc) {
+        if (!_tcp) {
+            return Cartesian::invalid_arc(target, pl_data, position, center, radius, caxes, is_clockwise_arc);
+        }
+        return false;
+    }
+
+    // Configuration registration
+    namespace {
+        KinematicsFactory::InstanceBuilder<TableTable> registration("table_table");
+    }
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+	TableTable.h
+
+	A 5-axis machine whose part sits on a rotary table (C) carried by a tilting cradle (A), with
+	tool center point control.  With G43.4 the program gives the tool tip position in the frame
+	of the table, and the kinematics move the linear axes to follow the part as it rotates.
+	G49 returns to plain cartesian motion.
+*/
+
+#include "Cartesian.h"
+
+namespace Kinematics {
+    class TableTable : public Cartesian {
+    public:
+        TableTable(const char* name) : Cartesian(name) {}
+
+        TableTable(const TableTable&)            = delete;
+        TableTable(TableTable&&)                 = delete;
+        TableTable& operator=(const TableTable&) = delete;
+        TableTable& operator=(TableTable&&)      = delete;
+
+        // Kinematic Interface
+
+        void init() override;
+        bool cartesian_to_motors(float* target, plan_line_data_t* pl_data, float* position) override;
+        void motors_to_cartesian(float* cartesian, float* motors, int n_axis) override;
+        bool transform_cartesian_to_motors(float* motors, float* cartesian) override;
+        bool native_arcs() override { return !_tcp; }
+        bool has_tcp() override { return _valid; }
+        void set_tcp(bool on) override { _tcp = on; }
+
+        // The transforms change with the TCP mode
+        LinearKind linear_kind(float& x_scaler) override { return LinearKind::None; }
+
+        void constrain_jog(float* cartesian, plan_line_data_t* pl_data, float* position) override;
+        bool invalid_line(float* cartesian) override;
+        bool invalid_arc(float*            target,
+                         plan_line_data_t* pl_data,
+                         float*            position,
+                         float             center[3],
+                         float             radius,
+                         size_t            caxes[3],
+                         bool              is_clockwise_arc) override;
+
+        // Configuration handlers:
+        void group(Configuration::HandlerBase& handler) override;
+
+        ~TableTable() {}
+
+    private:
+        void table_to_machine(float* machine, const float* table, float a, float c);
+        void machine_to_table(float* table, const float* machine, float a, float c);
+        bool within_limits(const float* motors);
+
+        bool _tcp   = false;  // G43.4 is active
+        bool _valid = false;  // The rotary axes exist
+
+        // Parameters
+        int32_t _a_axis           = 3;      // Tilts the cradle about a line parallel to X
+        int32_t _c_axis           = 5;      // Turns the table about its own axis, parallel to Z at A0
+        float   _a_pivot_y        = 0.0f;   // Where the A axis line crosses the YZ plane (mm)
+        float   _a_pivot_z        = 0.0f;
+        float   _c_pivot_x        = 0.0f;   // Where the C axis line crosses the XY plane at A0 (mm)
+        float   _c_pivot_y        = 0.0f;
+        bool    _reverse_a        = false;  // Positive A turns the table clockwise seen from +X
+        bool    _reverse_c        = false;  // Positive C turns the table clockwise seen from +Z
+        float   _segment_len      = 1.0f;   // Longest segment of the tool tip path (mm)
+        float   _segment_deg      = 1.0f;   // Largest rotation in a segment (degrees)
+        bool    _stepper_segments = false;  // Plan in the table frame, see TableTable.cpp
+    };
+}  //  namespace Kinematics
@@ -15,6 +15,7 @@ namespace Kinematics {
         handler.item("right_anchor_y", _right_anchor_y);
 
         handler.item("segment_length", _segment_length);
+        handler.item("stepper_segments", _stepper_segments);
     }
 
     void WallPlotter::init() {
@@ -47,8 +48,17 @@ namespace Kinematics {
         return false;
     }
 
-    bool WallPlotter::transform_cartesian_to_motors(float* cartesian, float* motors) {
-        log_error("WallPlotter::transform_cartesian_to_motors is broken");
+    // Converts a cartesian position to the motor positions that cartesian_to_motors() queues.
+    // Note that the left motor runs backward.
+    bool WallPlotter::transform_cartesian_to_motors(float* motors, float* cartesian) {
+        float left_length, right_length;
+        xy_to_lengths(cartesian[X_AXIS], cartesian[Y_AXIS], left_length, right_length);
+        motors[0]   = 0 - (left_length - zero_left);
+        motors[1]   = 0 + (right_length - zero_right);
+        auto n_axis = Axes::_numberAxis;
+        for (size_t axis = Z_AXIS; axis < n_axis; axis++) {
+            motors[axis] = cartesian[axis];
+        }
         return true;
     }
 
@@ -74,6 +84,22 @@ namespace Kinematics {
             return true;
         }
 
+        // With stepper_segments, the planner plans the cartesian line as one block and the
+        // segment generator computes the cord lengths along it, so the segments are only as
+        // long as a step segment.  The axis limits then apply to the puck, not to the cords.
+        if (_stepper_segments && mc_kinematic_line(pl_data)) {
+            float motors[n_axis];
+            transform_cartesian_to_motors(motors, target);
+            if (!mc_move_kinematic(target, position, motors, pl_data)) {
+                return false;
+            }
+            xy_to_lengths(target[X_AXIS], target[Y_AXIS], last_motor_segment_end[0], last_motor_segment_end[1]);
+            for (size_t axis = Z_AXIS; axis < n_axis; axis++) {
+                last_motor_segment_end[axis] = target[axis];
+            }
+            return true;
+        }
+
         float cartesian_feed_rate = pl_data->feed_rate;
 
         // calculate the total X,Y axis move distance
@@ -28,7 +28,7 @@ namespace Kinematics {
         void init_position() override;
         bool cartesian_to_motors(float* target, plan_line_data_t* pl_data, float* position) override;
         void motors_to_cartesian(float* cartesian, float* motors, int n_axis) override;
-        bool transform_cartesian_to_motors(float* cartesian, float* motors) override;
+        bool transform_cartesian_to_motors(float* motors, float* cartesian) override;
         bool kinematics_homing(AxisMask& axisMask) override;
 
         // Configuration handlers:
@@ -56,5 +56,7 @@ namespace Kinematics {
         float _right_anchor_x = 100;
         float _right_anchor_y = 100;
         float _segment_length = 10;
+
+        bool _stepper_segments = false;
     };
 }  //  namespace Kinematics
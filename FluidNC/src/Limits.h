@@ -28,9 +28,6 @@ float limitsMinPosition(size_t axis);
 // Returns limit state under mask
 AxisMask limits_check(AxisMask check_mask);
 
-// A task that runs after a limit switch interrupt.
-void limitCheckTask(void* pvParameters);
-
 bool limitsCheckTravel(float* target);
 
 // True if an axis is reporting engaged limits on both ends.  This
@@ -0,0 +1,108 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// Arena is a bump allocator for memory that lives only while one line of GCode
+// is parsed and executed.  Allocation moves a pointer through a fixed buffer, and
+// reset() at the start of the next line releases everything at once, so the
+// per-line containers neither search nor fragment the heap.
+//
+// ArenaAllocator plugs an Arena into standard containers.  When the buffer is
+// full it falls back to the heap rather than fail, and overflows() counts that,
+// so the buffer can be sized from $Heap/Stats.  A container that uses the arena
+// must not outlive the next reset().
+//
+// It is header-only so that it can be tested on the host.
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+class Arena {
+    uint8_t* _buffer;
+    size_t   _size;
+    size_t   _used       = 0;
+    size_t   _high_water = 0;  // Most bytes used by one line
+    uint32_t _overflows  = 0;  // Allocations that did not fit
+
+public:
+    Arena(void* buffer, size_t size) : _buffer(static_cast<uint8_t*>(buffer)), _size(size) {}
+
+    Arena(const Arena&)            = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Returns nullptr if size bytes do not fit
+    void* allocate(size_t size, size_t align) {
+        size_t start = (_used + align - 1) & ~(align - 1);
+        if (start + size > _size) {
+            ++_overflows;
+            return nullptr;
+        }
+        _used = start + size;
+        if (_used > _high_water) {
+            _high_water = _used;
+        }
+        return _buffer + start;
+    }
+
+    bool owns(const void* ptr) const {
+        auto p = static_cast<const uint8_t*>(ptr);
+        return p >= _buffer && p < _buffer + _size;
+    }
+
+    void reset() { _used = 0; }
+
+    size_t   size() const { return _size; }
+    size_t   used() const { return _used; }
+    size_t   high_water() const { return _high_water; }
+    uint32_t overflows() const { return _overflows; }
+};
+
+template <size_t N>
+class StaticArena : public Arena {
+    alignas(8) uint8_t _storage[N];
+
+public:
+    StaticArena() : Arena(_storage, N) {}
+};
+
+template <typename T>
+class ArenaAllocator {
+    template <typename U>
+    friend class ArenaAllocator;
+
+    Arena* _arena;
+
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(Arena& arena) : _arena(&arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : _arena(other._arena) {}
+
+    T* allocate(size_t n) {
+        void* p = _arena->allocate(n * sizeof(T), alignof(T));
+        if (!p) {
+            p = ::operator new(n * sizeof(T));
+        }
+        return static_cast<T*>(p);
+    }
+
+    // Memory in the arena is released by reset()
+    void deallocate(T* p, size_t n) {
+        if (!_arena->owns(p)) {
+            ::operator delete(p);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const {
+        return _arena == other._arena;
+    }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const {
+        return _arena != other._arena;
+    }
+};
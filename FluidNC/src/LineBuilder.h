@@ -0,0 +1,114 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  LineBuilder.h - formats a line of output into a caller-supplied buffer
+
+  Reports that are sent many times a second, like the realtime status report, are built
+  with a LineBuilder in a stack buffer instead of with streams, so formatting them never
+  touches the heap.  Numbers are formatted by hand: fixed() scales a value to an integer
+  number of its last decimal place and prints the digits, which is much cheaper than a
+  general floating point conversion.  Text that does not fit is dropped, so a line can
+  be truncated but never overruns the buffer.  It is header-only so that it can be tested
+  on the host.
+*/
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>  // snprintf
+#include <string_view>
+
+class LineBuilder {
+    char*  _buffer;
+    size_t _size;
+    size_t _length = 0;
+
+public:
+    // One byte of buffer is kept for the terminator
+    LineBuilder(char* buffer, size_t size) : _buffer(buffer), _size(size) { _buffer[0] = '\0'; }
+
+    LineBuilder& operator<<(char c) {
+        if (_length + 1 < _size) {
+            _buffer[_length++] = c;
+            _buffer[_length]   = '\0';
+        }
+        return *this;
+    }
+
+    LineBuilder& operator<<(std::string_view s) {
+        size_t n = s.length();
+        if (n > _size - 1 - _length) {
+            n = _size - 1 - _length;
+        }
+        for (size_t i = 0; i < n; i++) {
+            _buffer[_length + i] = s[i];
+        }
+        _length += n;
+        _buffer[_length] = '\0';
+        return *this;
+    }
+    LineBuilder& operator<<(const char* s) { return *this << std::string_view(s); }
+
+    LineBuilder& operator<<(uint64_t value) {
+        char  digits[20];
+        char* p = digits + sizeof(digits);
+        do {
+            *--p = char('0' + value % 10);
+            value /= 10;
+        } while (value);
+        return *this << std::string_view(p, digits + sizeof(digits) - p);
+    }
+    LineBuilder& operator<<(uint32_t value) { return *this << uint64_t(value); }
+    LineBuilder& operator<<(int64_t value) {
+        if (value < 0) {
+            *this << '-';
+            return *this << uint64_t(0) - uint64_t(value);
+        }
+        return *this << uint64_t(value);
+    }
+    LineBuilder& operator<<(int32_t value) { return *this << int64_t(value); }
+
+    // Appends value rounded to decimals places, like printf("%.*f")
+    LineBuilder& fixed(float value, int decimals) {
+        static const double scales[] = { 1, 10, 100, 1e3, 1e4, 1e5, 1e6 };
+
+        double scaled = value;
+        if (decimals >= 0 && decimals <= 6) {
+            scaled *= scales[decimals];
+        }
+        if (decimals < 0 || decimals > 6 || !(std::fabs(scaled) < 9e15)) {
+            // Out of range, infinite or NaN
+            char text[64];
+            snprintf(text, sizeof(text), "%.*f", decimals, double(value));
+            return *this << text;
+        }
+
+        if (std::signbit(value)) {
+            *this << '-';
+            scaled = -scaled;
+        }
+        uint64_t units = uint64_t(scaled + 0.5);
+
+        char  digits[24];
+        char* p = digits + sizeof(digits);
+        for (int i = 0; i < decimals; i++) {
+            *--p = char('0' + units % 10);
+            units /= 10;
+        }
+        if (decimals) {
+            *--p = '.';
+        }
+        do {
+            *--p = char('0' + units % 10);
+            units /= 10;
+        } while (units);
+        return *this << std::string_view(p, digits + sizeof(digits) - p);
+    }
+
+    const char*      c_str() const { return _buffer; }
+    size_t           length() const { return _length; }
+    std::string_view view() const { return std::string_view(_buffer, _length); }
+};
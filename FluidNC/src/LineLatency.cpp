@@ -0,0 +1,118 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "LineLatency.h"
+
+#include "Driver/delay_usecs.h"  // getCpuTicks(), ticks_per_us
+
+namespace LineLatency {
+    const uint32_t stale_us = 10000000;  // A block that has not stepped after this is given up on
+
+    volatile Stage    stage      = Stage::Idle;
+    volatile uint32_t step_ticks = 0;
+
+    static bool              on = false;
+    static volatile uint32_t received_ticks;
+    static uint32_t          start_ticks;
+    static uint32_t          end_ticks;
+    static uint32_t          planned_ticks;
+    static Stats             stats;
+
+    void enable(bool enable) {
+        on    = enable;
+        stage = Stage::Idle;
+    }
+    bool enabled() { return on; }
+
+    void received() {
+        if (on && stage == Stage::Idle) {
+            received_ticks = getCpuTicks();
+            stage          = Stage::Received;
+        }
+    }
+
+    void parse_start() {
+        if (stage == Stage::Received) {
+            start_ticks = getCpuTicks();
+            end_ticks   = start_ticks;
+            stage       = Stage::Started;
+        }
+    }
+
+    void parse_end() {
+        if (stage == Stage::Started) {
+            end_ticks = getCpuTicks();
+        }
+    }
+
+    bool planned() {
+        if (stage != Stage::Started) {
+            return false;
+        }
+        planned_ticks = getCpuTicks();
+        stage         = Stage::Planned;
+        return true;
+    }
+
+    // Records the stages of a line whose first block has stepped
+    static void finish_motion() {
+        stats.queue.record(start_ticks - received_ticks);
+        stats.gcode.record(planned_ticks - start_ticks);
+        stats.motion.record(step_ticks - planned_ticks);
+        stats.total.record(step_ticks - received_ticks);
+        stage = Stage::Idle;
+    }
+
+    // Records the stages of a line without motion
+    static void finish_line() {
+        stats.queue.record(start_ticks - received_ticks);
+        stats.gcode.record(end_ticks - start_ticks);
+        stats.total.record(end_ticks - received_ticks);
+        stage = Stage::Idle;
+    }
+
+    void executed() {
+        switch (stage) {
+            case Stage::Received:
+                // A line that the parser did not see, such as a $ command
+                start_ticks = getCpuTicks();
+                end_ticks   = start_ticks;
+                finish_line();
+                break;
+            case Stage::Started:
+                finish_line();
+                break;
+            case Stage::Planned:
+                stage = Stage::Executed;
+                break;
+            case Stage::Executed:
+                if (uint32_t(getCpuTicks() - planned_ticks) / ticks_per_us > stale_us) {
+                    stage = Stage::Idle;
+                }
+                break;
+            case Stage::Stepped:
+                finish_motion();
+                break;
+            case Stage::Idle:
+                break;
+        }
+    }
+
+    void abandon() {
+        if (stage != Stage::Received) {
+            stage = Stage::Idle;
+        }
+    }
+
+    void get(Stats& out) {
+        if (stage == Stage::Stepped) {
+            finish_motion();
+        }
+        out = stats;
+    }
+
+    void reset() {
+        stats = Stats();
+        stage = Stage::Idle;
+    }
+}
@@ -0,0 +1,86 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  LineLatency.h - where the time goes between receiving a line and the first step of its motion
+
+  When enabled with $Line/Latency=on, one line at a time is traced.  The polling task stamps it
+  when a channel delivers it, the GCode parser when it starts and finishes executing it, the
+  planner when it queues its first block, and the step ISR when that block starts stepping.
+  A new line is only traced once the previous one is finished, so the trace costs a few
+  comparisons per line.  $Line/Latency reports a histogram of each stage:
+
+    queue   received to the start of execution, while the main loop finishes earlier work
+    gcode   execution to the first queued block, including any wait for planner room; for a
+            line without motion, to the end of its execution
+    motion  first queued block to its first step, while the blocks ahead of it run
+    total   received to the first step, or to the end of execution for a line without motion
+
+  Times are taken from the CPU cycle counter, so stages longer than its wrap time, about 17 s
+  at 240 MHz, are not meaningful.
+*/
+
+#include "Event.h"  // EventLatency
+
+#include <esp_attr.h>  // IRAM_ATTR
+#include <cstdint>
+
+namespace LineLatency {
+    struct Stats {
+        EventLatency queue;
+        EventLatency gcode;
+        EventLatency motion;
+        EventLatency total;
+    };
+
+    enum class Stage : uint8_t {
+        Idle,      // No line is traced
+        Received,  // The line has been received
+        Started,   // Its execution has started
+        Planned,   // Its first block is queued
+        Executed,  // Its execution finished after queueing a block, which has not stepped yet
+        Stepped,   // Its first block has started stepping
+    };
+
+    extern volatile Stage    stage;
+    extern volatile uint32_t step_ticks;
+
+    void enable(bool on);
+    bool enabled();
+
+    // Called by the polling task when a channel delivers a line
+    void received();
+
+    // Called by gc_execute_line(), through a ParseScope
+    void parse_start();
+    void parse_end();
+
+    class ParseScope {
+    public:
+        ParseScope() { parse_start(); }
+        ~ParseScope() { parse_end(); }
+    };
+
+    // Called by the planner for each new block.  Returns true if the block is the first of
+    // the traced line, and must call first_step() when it starts stepping.
+    bool planned();
+
+    // Called by the main loop after executing a line of any kind
+    void executed();
+
+    // Called by the step ISR
+    inline void IRAM_ATTR first_step(uint32_t ticks) {
+        if (stage == Stage::Planned || stage == Stage::Executed) {
+            step_ticks = ticks;
+            stage      = Stage::Stepped;
+        }
+    }
+
+    // Drops the traced line, as when a reset discards its motion
+    void abandon();
+
+    void get(Stats& stats);
+    void reset();
+}
@@ -0,0 +1,56 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  LinePool.h - fixed set of buffers for building output lines
+
+  Log messages and reports are built in one task and freed in the output task after they
+  have been sent.  Taking their buffers from a fixed pool instead of the heap bounds the
+  cost of a message and keeps the constant churn of short lines from fragmenting the heap.
+  A bit per buffer records whether it is free, so any task can acquire or release a buffer
+  without a lock.  When every buffer is in use, acquire() returns nullptr and counts a miss,
+  and the caller falls back to the heap.  It is header-only so that it can be tested on the
+  host.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+template <size_t Count, size_t Size>
+class LinePool {
+    static_assert(Count > 0 && Count <= 32, "The free set is one 32-bit word");
+
+    char                  _lines[Count][Size];
+    std::atomic<uint32_t> _free { Count == 32 ? ~0u : (1u << Count) - 1 };
+    std::atomic<uint32_t> _misses { 0 };
+
+public:
+    static constexpr size_t line_size = Size;
+
+    char* acquire() {
+        uint32_t free = _free.load(std::memory_order_relaxed);
+        while (free) {
+            uint32_t bit = free & -free;  // Lowest free buffer
+            if (_free.compare_exchange_weak(free, free & ~bit, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return _lines[__builtin_ctz(bit)];
+            }
+        }
+        _misses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    bool owns(const char* line) const { return line >= _lines[0] && line < _lines[Count]; }
+
+    // Returns a buffer from acquire(); other pointers are ignored
+    void release(const char* line) {
+        if (owns(line)) {
+            _free.fetch_or(1u << ((line - _lines[0]) / Size), std::memory_order_release);
+        }
+    }
+
+    size_t   in_use() const { return Count - __builtin_popcount(_free.load(std::memory_order_relaxed)); }
+    uint32_t misses() const { return _misses.load(std::memory_order_relaxed); }
+};
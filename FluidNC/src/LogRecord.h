@@ -0,0 +1,103 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  LogRecord.h - a log message that is formatted by the output task
+
+  log_*() formats its message in the calling task, which on paths like homing and the
+  VFD task takes time that the motion is waiting for.  A LogRecord instead holds the
+  format and up to max_args raw argument values, so the caller only copies a few words
+  into the message queue, and the output task builds the text later with format().
+  Each {} in the format is replaced by the next argument.  Arguments are integers,
+  floats, and strings that outlive the message, such as literals and the names of
+  configured objects.  It is header-only so that it can be tested on the host.
+*/
+
+#include "LineBuilder.h"
+
+#include <cstdint>
+#include <type_traits>
+
+struct LogRecord {
+    static const int max_args = 4;
+
+    enum Type : uint8_t { None, Int, Uint, Float, Str };
+
+    union Value {
+        int32_t     i;
+        uint32_t    u;
+        float       f;
+        const char* s;
+    };
+
+    const char* prefix           = nullptr;  // Like "[MSG:DBG: ", which the closing ']' matches
+    const char* format           = nullptr;  // nullptr for a message that is not a LogRecord
+    Type        types[max_args]  = {};
+    Value       values[max_args] = {};
+
+    template <typename T>
+    void put(int n, T v) {
+        if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>) {
+            types[n]    = Str;
+            values[n].s = v;
+        } else if constexpr (std::is_floating_point_v<T>) {
+            types[n]    = Float;
+            values[n].f = float(v);
+        } else if constexpr (std::is_enum_v<T>) {
+            types[n]    = Int;
+            values[n].i = int32_t(v);
+        } else {
+            static_assert(std::is_integral_v<T> && sizeof(T) <= sizeof(int32_t), "Unsupported deferred log argument");
+            if constexpr (std::is_signed_v<T>) {
+                types[n]    = Int;
+                values[n].i = v;
+            } else {
+                types[n]    = Uint;
+                values[n].u = v;
+            }
+        }
+    }
+
+    void format_to(LineBuilder& out) const {
+        out << prefix;
+        int n = 0;
+        for (const char* p = format; *p; ++p) {
+            if (p[0] == '{' && p[1] == '}' && n < max_args && types[n] != None) {
+                switch (types[n]) {
+                    case Int:
+                        out << values[n].i;
+                        break;
+                    case Uint:
+                        out << values[n].u;
+                        break;
+                    case Float:
+                        out.fixed(values[n].f, 3);  // Like the float inserter of log_*()
+                        break;
+                    default:
+                        out << values[n].s;
+                        break;
+                }
+                ++n;
+                ++p;
+            } else {
+                out << *p;
+            }
+        }
+        if (prefix[0] == '[') {
+            out << ']';
+        }
+    }
+};
+
+template <typename... Args>
+LogRecord make_log_record(const char* prefix, const char* format, Args... args) {
+    static_assert(sizeof...(Args) <= LogRecord::max_args, "Too many deferred log arguments");
+    LogRecord record;
+    record.prefix = prefix;
+    record.format = format;
+    int n         = 0;
+    (record.put(n++, args), ...);
+    return record;
+}
@@ -6,6 +6,8 @@
 #include "Serial.h"
 #include "SettingsDefinitions.h"
 #include "Channel.h"
+#include "LinePool.h"
+#include "LineBuilder.h"
 
 const EnumItem messageLevels2[] = { { MsgLevelNone, "None" }, { MsgLevelError, "Error" }, { MsgLevelWarning, "Warn" },
                                     { MsgLevelInfo, "Info" }, { MsgLevelDebug, "Debug" }, { MsgLevelVerbose, "Verbose" },
@@ -15,8 +17,58 @@ bool atMsgLevel(MsgLevel level) {
     return message_level == nullptr || message_level->get() >= level;
 }
 
+// Long enough for a status report.  The message queue holds 10 lines, so a few more
+// buffers cover the messages being built while the queue is full.
+static LinePool<16, 256> log_lines;
+
+void release_log_line(const char* line) {
+    log_lines.release(line);
+}
+size_t log_lines_in_use() {
+    return log_lines.in_use();
+}
+uint32_t log_line_pool_misses() {
+    return log_lines.misses();
+}
+
+static uint32_t deferred_drops = 0;
+
+uint32_t log_deferred_drops() {
+    return deferred_drops;
+}
+
+void log_deferred(MsgLevel level, const LogRecord& record) {
+    if (!outputTask) {
+        print_log_record(allChannels, level, record);
+        return;
+    }
+    LogMessage msg { &allChannels, nullptr, level, false, record };
+    if (!xQueueSend(message_queue, &msg, 0)) {
+        ++deferred_drops;
+    }
+}
+
+// Called by the output task, so it prints directly instead of queueing
+void print_log_record(Channel& channel, MsgLevel level, const LogRecord& record) {
+    static uint32_t reported_drops = 0;
+
+    char buffer[log_lines.line_size];
+    if (uint32_t drops = deferred_drops; drops != reported_drops) {
+        LineBuilder warning(buffer, sizeof(buffer));
+        warning << "[MSG:WARN: " << (drops - reported_drops) << " deferred messages dropped]";
+        channel.print_msg(MsgLevelWarning, warning.c_str());
+        reported_drops = drops;
+    }
+    LineBuilder line(buffer, sizeof(buffer));
+    record.format_to(line);
+    channel.print_msg(level, line.c_str());
+}
+
 LogStream::LogStream(Channel& channel, MsgLevel level) : _channel(channel), _level(level) {
-    _line = new std::string();
+    _buffer = log_lines.acquire();
+    if (!_buffer) {
+        _line = new std::string();
+    }
 }
 
 LogStream::LogStream(Channel& channel, MsgLevel level, const char* name) : LogStream(channel, level) {
@@ -27,11 +79,30 @@ LogStream::LogStream(Channel& channel, const char* name) : LogStream(channel, Ms
 LogStream::LogStream(MsgLevel level, const char* name) : LogStream(allChannels, level, name) {}
 
 size_t LogStream::write(uint8_t c) {
+    if (_buffer) {
+        // Leave room for the closing ']' and the terminator
+        if (_length < log_lines.line_size - 2) {
+            _buffer[_length++] = c;
+            return 1;
+        }
+        // Too long for a pooled line
+        _line = new std::string(_buffer, _length);
+        log_lines.release(_buffer);
+        _buffer = nullptr;
+    }
     *_line += (char)c;
     return 1;
 }
 
 LogStream::~LogStream() {
+    if (_buffer) {
+        if (_length && _buffer[0] == '[') {
+            _buffer[_length++] = ']';
+        }
+        _buffer[_length] = '\0';
+        _channel.sendLine(_level, const_cast<const char*>(_buffer));
+        return;
+    }
     if ((*_line).length() && (*_line)[0] == '[') {
         *_line += ']';
     }
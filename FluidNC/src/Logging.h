@@ -8,6 +8,7 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
 #include "State.h"
+#include "LogRecord.h"
 
 class Channel;
 
@@ -21,10 +22,11 @@ enum MsgLevel {
 };
 
 struct LogMessage {
-    Channel* channel;
-    void*    line;
-    MsgLevel level;
-    bool     isString;
+    Channel*  channel;
+    void*     line;
+    MsgLevel  level;
+    bool      isString;
+    LogRecord record;  // Formatted by the output task when record.format is set
 };
 
 extern TaskHandle_t outputTask;
@@ -33,6 +35,13 @@ extern xQueueHandle message_queue;
 
 extern const EnumItem messageLevels2[];
 
+// Most messages are built in a buffer from a fixed pool; see LinePool.h.  A pooled
+// line is sent as a const char* and must be returned with release_log_line() after
+// it has been printed.  release_log_line() ignores lines that are not from the pool.
+void     release_log_line(const char* line);
+size_t   log_lines_in_use();
+uint32_t log_line_pool_misses();
+
 // How to use logging? Well, the basics are pretty simple:
 //
 // - The syntax is like standard iostream's.
@@ -59,12 +68,21 @@ public:
 
 private:
     Channel&     _channel;
-    std::string* _line;
+    char*        _buffer = nullptr;  // Pooled line, or nullptr after falling back to _line
+    size_t       _length = 0;
+    std::string* _line   = nullptr;
     MsgLevel     _level;
 };
 
 extern bool atMsgLevel(MsgLevel level);
 
+// Queues a record for the output task to format and send to all channels.  It never
+// waits: when the message queue is full the record is dropped and counted, and the
+// output task reports the count with the next record it sends.
+void     log_deferred(MsgLevel level, const LogRecord& record);
+void     print_log_record(Channel& channel, MsgLevel level, const LogRecord& record);
+uint32_t log_deferred_drops();
+
 // clang-format off
 
 // Note: these '{'..'}' scopes are here for a reason: the destructor should flush.
@@ -87,6 +105,12 @@ extern bool atMsgLevel(MsgLevel level);
 #define log_error_to(out, x) if (atMsgLevel(MsgLevelError)) { LogStream ss(out, MsgLevelError, "[MSG:ERR: "); ss << x; }
 #define log_fatal_to(out, x) { LogStream ss(out, MsgLevelNone, "[MSG:FATAL: "); ss << x;  Assert(false, "A fatal error occurred."); }
 
+// Deferred forms for hot paths, with a {} format and raw arguments; see LogRecord.h.
+// log_debug_deferred("Synced speed " << speed) becomes log_debug_deferred("Synced speed {}", speed)
+#define log_verbose_deferred(format, ...) if (atMsgLevel(MsgLevelVerbose)) { log_deferred(MsgLevelVerbose, make_log_record("[MSG:VRB: ", format, ##__VA_ARGS__)); }
+#define log_debug_deferred(format, ...) if (atMsgLevel(MsgLevelDebug)) { log_deferred(MsgLevelDebug, make_log_record("[MSG:DBG: ", format, ##__VA_ARGS__)); }
+#define log_info_deferred(format, ...) if (atMsgLevel(MsgLevelInfo)) { log_deferred(MsgLevelInfo, make_log_record("[MSG:INFO: ", format, ##__VA_ARGS__)); }
+
 // #define log_to(out, prefix, x) { LogStream ss(out, MsgLevelNone, prefix); ss << x; }
 #define log_stream(out, x) { LogStream ss(out, MsgLevelNone); ss << x; }
 #define log_string(out, x) out.sendLine(MsgLevelNone, x)
@@ -7,6 +7,10 @@
 #include "../Stepper.h"     // stepper_id_t
 #include "MachineConfig.h"  // config->
 #include "../Limits.h"
+#include "I2SOBus.h"  // I2SOBus::Transaction
+
+#include "Driver/delay_usecs.h"   // usToCpuTicks()
+#include "Driver/fluidnc_gpio.h"  // gpio_set_fast_debounce()
 
 const EnumItem axisType[] = { { 0, "X" }, { 1, "Y" }, { 2, "Z" }, { 3, "A" }, { 4, "B" }, { 5, "C" }, EnumItem(0) };
 
@@ -23,7 +27,9 @@ namespace Machine {
     Pin Axes::_sharedStepperDisable;
     Pin Axes::_sharedStepperReset;
 
-    uint32_t Axes::_homing_runs = 2;  // Number of Approach/Pulloff cycles
+    uint32_t Axes::_homing_runs     = 2;      // Number of Approach/Pulloff cycles
+    bool     Axes::_homing_parallel = false;  // Stop and replan the cycle each time an axis reaches its switch
+    uint32_t Axes::_limitDebounceUs = 50;     // Time a limit switch change must be stable for the step ISR
 
     int Axes::_numberAxis = 0;
 
@@ -34,6 +40,8 @@ namespace Machine {
     void Axes::init() {
         log_info("Axis count " << Axes::_numberAxis);
 
+        gpio_set_fast_debounce(usToCpuTicks(_limitDebounceUs));
+
         if (_sharedStepperDisable.defined()) {
             _sharedStepperDisable.setAttr(Pin::Attr::Output);
             _sharedStepperDisable.report("Shared stepper disable");
@@ -61,7 +69,12 @@ namespace Machine {
         config_motors();
     }
 
+    void Axes::reload() {
+        gpio_set_fast_debounce(usToCpuTicks(_limitDebounceUs));
+    }
+
     void IRAM_ATTR Axes::set_disable(int axis, bool disable) {
+        I2SOBus::Transaction batch;  // The motors of the axis latch together
         for (int motor = 0; motor < Axis::MAX_MOTORS_PER_AXIS; motor++) {
             auto m = _axis[axis]->_motors[motor];
             if (m) {
@@ -73,11 +86,14 @@ namespace Machine {
     }
 
     void IRAM_ATTR Axes::set_disable(bool disable) {
+        // All of the enable pins on I2SO change in one latch, before the enable delay
+        I2SOBus::begin();
         for (int axis = 0; axis < _numberAxis; axis++) {
             set_disable(axis, disable);
         }
 
         _sharedStepperDisable.synchronousWrite(disable);
+        I2SOBus::commit();
 
         if (!disable && disabled) {
             disabled = false;
@@ -155,6 +171,8 @@ namespace Machine {
         handler.item("shared_stepper_disable_pin", _sharedStepperDisable);
         handler.item("shared_stepper_reset_pin", _sharedStepperReset);
         handler.item("homing_runs", _homing_runs, 1, 5);
+        handler.item("homing_parallel", _homing_parallel);
+        handler.item("limit_debounce_us", _limitDebounceUs, 0, 10000);
 
         // Handle axis names xyzabc.  handler.section is inferred
         // from a template.
@@ -34,7 +34,9 @@ namespace Machine {
         static Pin _sharedStepperDisable;
         static Pin _sharedStepperReset;
 
-        static uint32_t _homing_runs;  // Number of Approach/Pulloff cycles
+        static uint32_t _homing_runs;      // Number of Approach/Pulloff cycles
+        static bool     _homing_parallel;  // Axes of a cycle stop at their switches without halting the others
+        static uint32_t _limitDebounceUs;  // Time a limit switch change must be stable before the step ISR acts on it
 
         static inline char axisName(int index) { return index < MAX_N_AXIS ? _names[index] : '?'; }  // returns axis letter
 
@@ -87,6 +89,7 @@ namespace Machine {
         // Configuration helpers:
         void group(Configuration::HandlerBase& handler) override;
         void afterParse() override;
+        void reload() override;
 
         ~Axes();
     };
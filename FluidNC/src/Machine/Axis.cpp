@@ -2,10 +2,15 @@
 #include "Axis.h"
 #include "MachineConfig.h"  // config
 #include "../SCurve.h"      // For S-curve validation
+#include "../Stepper.h"     // Stepper::reload_shaper()
 
 #include <cstring>
 
 namespace Machine {
+    const EnumItem shaperTypes[] = {
+        { SHAPER_NONE, "None" }, { SHAPER_ZV, "ZV" }, { SHAPER_ZVD, "ZVD" }, { SHAPER_MZV, "MZV" }, EnumItem(SHAPER_NONE)
+    };
+
     void Axis::group(Configuration::HandlerBase& handler) {
         handler.item("steps_per_mm", _stepsPerMm, 0.001, 100000.0);
         handler.item("max_rate_mm_per_min", _maxRate, 0.001, 250000.0);
@@ -13,6 +18,10 @@ namespace Machine {
         handler.item("max_jerk_mm_per_sec3", _maxJerk, 0.0, 1000000.0);
         handler.item("max_travel_mm", _maxTravel, 0.1, 10000000.0);
         handler.item("soft_limits", _softLimits);
+        handler.item("backlash_mm", _backlash, 0.0, 10.0);
+        handler.item("shaper", _shaper, shaperTypes);
+        handler.item("shaper_frequency_hz", _shaperFrequency, 1.0, 500.0);
+        handler.item("shaper_damping_ratio", _shaperDamping, 0.0, 0.9);
         handler.section("homing", _homing);
 
         char tmp[7];
@@ -42,6 +51,10 @@ namespace Machine {
                 log_info("Axis " << _axis << " S-curve acceleration enabled (jerk: " << _maxJerk << " mm/sec³)");
             }
         }
+
+        if (_shaper != SHAPER_NONE) {
+            log_info("Axis " << _axis << " input shaping at " << _shaperFrequency << " Hz, damping " << _shaperDamping);
+        }
     }
 
     void Axis::init() {
@@ -73,6 +86,36 @@ namespace Machine {
         }
     }
 
+    // Rates, accelerations, jerk and travel are read by the planner for each block,
+    // so only what init() derived from the settings is derived again
+    void Axis::reload() {
+        uint32_t stepRate = uint32_t(_stepsPerMm * _maxRate / 60.0);
+        auto     maxRate  = Stepping::maxPulsesPerSec();
+        if (stepRate > maxRate) {
+            log_warn("Axis " << Axes::axisName(_axis) << " stepping rate " << stepRate << " steps/sec exceeds the maximum rate " << maxRate);
+        }
+
+        if (_homing && _homing->_cycle >= 0) {
+            set_bitnum(Axes::homingMask, _axis);
+        } else {
+            clear_bitnum(Axes::homingMask, _axis);
+        }
+        if (_homing && !_homing->_positiveDirection) {
+            set_bitnum(Homing::direction_mask, _axis);
+        } else {
+            clear_bitnum(Homing::direction_mask, _axis);
+        }
+
+        for (size_t i = 0; i < Axis::MAX_MOTORS_PER_AXIS; i++) {
+            auto m = _motors[i];
+            if (m && m->_encoder) {
+                m->_encoder->rescale();
+            }
+        }
+
+        Stepper::reload_shaper();
+    }
+
     void Axis::config_motors() {
         for (int motor = 0; motor < Axis::MAX_MOTORS_PER_AXIS; ++motor) {
             auto mot = _motors[motor];
@@ -8,6 +8,7 @@
 // #include "Axes.h"
 #include "Motor.h"
 #include "Homing.h"
+#include "../InputShaper.h"
 
 namespace MotorDrivers {
     class MotorDriver;
@@ -36,15 +37,24 @@ namespace Machine {
         float _maxJerk      = 0.0f;  // 0.0 = S-curve disabled, >0 = S-curve enabled
         float _maxTravel    = 1000.0f;
         bool  _softLimits   = false;
+        float _backlash     = 0.0f;  // Lost motion on a direction reversal, taken up by extra steps
+
+        // Input shaping of the step stream, see InputShaper.h
+        int   _shaper          = SHAPER_NONE;
+        float _shaperFrequency = 40.0f;  // Ringing frequency in Hz
+        float _shaperDamping   = 0.1f;   // Damping ratio of the ringing
 
         // Configuration system helpers:
         void group(Configuration::HandlerBase& handler) override;
         void afterParse() override;
+        void reload() override;
 
         // Checks if a motor matches this axis:
         bool hasMotor(const MotorDrivers::MotorDriver* const driver) const;
         bool hasDualMotor();
 
+        int32_t backlashSteps() { return lroundf(_backlash * _stepsPerMm); }
+
         float commonPulloff();
         float extraPulloff();
 
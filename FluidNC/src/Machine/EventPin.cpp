@@ -1,7 +1,7 @@
 #include "EventPin.h"
 #include "src/Report.h"
 
-#include "src/Protocol.h"  // protocol_send_event
+#include "src/Protocol.h"  // protocol_forward_event
 
 void InputPin::init() {
     if (undefined()) {
@@ -19,9 +19,18 @@ void InputPin::trigger(bool active) {
     report_recompute_pin_string();
 }
 
+std::vector<EventPin*> EventPin::_all;
+
+void EventPin::init() {
+    InputPin::init();
+    if (defined()) {
+        _all.push_back(this);
+    }
+}
+
 void EventPin::trigger(bool active) {
     InputPin::trigger(active);
     if (active) {
-        protocol_send_event(_event, this);
+        protocol_forward_event(_event, this, &_latency);
     }
 }
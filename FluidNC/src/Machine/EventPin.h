@@ -3,11 +3,13 @@
 #include "src/Event.h"
 #include "src/Pin.h"
 #include <string>
+#include <vector>
 
 class InputPin : public Pin {
 protected:
     std::string _legend;  // The name that appears in init() messages and the name of the configuration item
-    bool        _value = false;
+    bool        _value  = false;
+    bool        _urgent = false;  // Changes go to the urgent event queue
 
 public:
     InputPin(const char* legend) : _legend(legend) {};
@@ -16,6 +18,7 @@ public:
 
     void update(bool state) { _value = state; };
     bool get() { return _value; }
+    bool urgent() const { return _urgent; }
 
     virtual void trigger(bool active);
 
@@ -29,9 +32,19 @@ protected:
     const Event* _event;
 
 public:
-    EventPin(const Event* event, const char* legend) : InputPin(legend), _event(event) {};
+    // The pin is urgent when its event is, so its changes are not queued behind normal events
+    EventPin(const Event* event, const char* legend) : InputPin(legend), _event(event) {
+        _urgent = event->_queue == Event::Queue::Urgent;
+    };
+
+    void init();
 
     void trigger(bool active) override;
 
+    // From the detection of an activation to the run of _event
+    EventLatency _latency;
+
+    static std::vector<EventPin*> _all;  // Initialized pins, for $Events/Stats
+
     ~EventPin() {}
 };
@@ -98,7 +98,7 @@ namespace Machine {
     }
 
     void Homing::cycleStop() {
-        log_debug("CycleStop " << phaseName(_phase));
+        log_debug_deferred("CycleStop {}", phaseName(_phase));
         if (approach()) {
             // Cycle stop while approaching means that we did not hit
             // a limit switch in the programmed distance
@@ -135,7 +135,7 @@ namespace Machine {
             _phase = SlowApproach;
         }
 
-        log_debug("Homing nextPhase " << phaseName(_phase));
+        log_debug_deferred("Homing nextPhase {}", phaseName(_phase));
         if (_phase == CycleDone || (_phase == Phase::Pulloff2 && !needsPulloff2(_cycleMotors))) {
             set_mpos();
             nextCycle();
@@ -147,7 +147,7 @@ namespace Machine {
     void Homing::axisVector(AxisMask axisMask, MotorMask motors, Machine::Homing::Phase phase, float* target, float& rate, uint32_t& settle_ms) {
         copyAxes(target, get_mpos());
 
-        log_debug("Starting from " << target[0] << "," << target[1] << "," << target[2]);
+        log_debug_deferred("Starting from {},{},{}", target[0], target[1], target[2]);
 
         float maxSeekTime = 0.0;
         float ratesq      = 0.0;
@@ -282,7 +282,7 @@ namespace Machine {
         }
 
         rate = sqrtf(ratesq);  // Magnitude of homing rate vector
-        log_debug("Planned move to " << target[0] << "," << target[1] << "," << target[2] << " @ " << rate);
+        log_debug_deferred("Planned move to {},{},{} @ {}", target[0], target[1], target[2], rate);
     }
 
     void Homing::runPhase() {
@@ -3,6 +3,9 @@
 
 #include "I2CBus.h"
 #include "Driver/fluidnc_i2c.h"
+#include "Tasks.h"  // Tasks::get()
+
+#include <cstring>
 
 namespace Machine {
     I2CBus::I2CBus(int busNumber) : _busNumber(busNumber) {}
@@ -30,7 +33,68 @@ namespace Machine {
         _error = i2c_master_init(_busNumber, sdaPin, sclPin, _frequency);
         if (_error) {
             log_error("I2C init failed");
+            return;
+        }
+
+        if (!_task) {
+            _queues[0] = xQueueCreate(QUEUE_LENGTH[0], sizeof(Transaction));
+            _queues[1] = xQueueCreate(QUEUE_LENGTH[1], sizeof(Transaction));
+            Tasks::get()._i2c.create(bus_task, this, &_task);
+        }
+    }
+
+    const int I2CBus::QUEUE_LENGTH[2] = { 8, 24 };  // Input, Display
+
+    void I2CBus::bus_task(void* arg) {
+        auto        bus = static_cast<I2CBus*>(arg);
+        Transaction t;
+        while (true) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            // The Input queue is checked first each time, so a read waits for at most one display write
+            while (xQueueReceive(bus->_queues[0], &t, 0) == pdTRUE || xQueueReceive(bus->_queues[1], &t, 0) == pdTRUE) {
+                int result = t.read ? bus->read(t.address, t.dest, t.count) : bus->write(t.address, t.data, t.count);
+                if (t.done) {
+                    t.done(t.arg, result);
+                }
+            }
+        }
+    }
+
+    bool I2CBus::queue(const Transaction& t, Priority priority) {
+        if (_error || !_task) {
+            return false;
+        }
+        if (xQueueSend(_queues[int(priority)], &t, QUEUE_WAIT_MS / portTICK_PERIOD_MS) != pdTRUE) {
+            return false;
+        }
+        xTaskNotifyGive(_task);
+        return true;
+    }
+
+    bool I2CBus::queue_write(uint8_t address, const uint8_t* data, size_t count, Priority priority, Callback done, void* arg) {
+        if (count > MAX_QUEUED_WRITE) {
+            return false;
         }
+        Transaction t;
+        t.address = address;
+        t.read    = false;
+        t.count   = count;
+        t.dest    = nullptr;
+        t.done    = done;
+        t.arg     = arg;
+        memcpy(t.data, data, count);
+        return queue(t, priority);
+    }
+
+    bool I2CBus::queue_read(uint8_t address, uint8_t* data, size_t count, Priority priority, Callback done, void* arg) {
+        Transaction t;
+        t.address = address;
+        t.read    = true;
+        t.count   = count;
+        t.dest    = data;
+        t.done    = done;
+        t.arg     = arg;
+        return queue(t, priority);
     }
 
     int I2CBus::write(uint8_t address, const uint8_t* data, size_t count) {
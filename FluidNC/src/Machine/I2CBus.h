@@ -6,14 +6,45 @@
 #include "../Configuration/Configurable.h"
 
 #include <esp_attr.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
 
 class TwoWire;
 
 namespace Machine {
     class I2CBus : public Configuration::Configurable {
+    public:
+        // Queued transactions are run by a task for the bus, so that the caller does not
+        // wait for the bus.  Each priority is a FIFO, and the task takes Input transactions,
+        // such as expander reads, ahead of Display updates, checking again after each one.
+        enum class Priority : uint8_t { Input, Display };
+        using Callback = void (*)(void* arg, int result);  // result as from write() or read()
+
+        static const size_t MAX_QUEUED_WRITE = 132;  // An SSD1306 page and its control byte
+
     private:
         bool _error = false;
 
+        struct Transaction {
+            uint8_t  address;
+            bool     read;
+            size_t   count;
+            uint8_t* dest;  // For reads
+            Callback done;
+            void*    arg;
+            uint8_t  data[MAX_QUEUED_WRITE];  // For writes
+        };
+
+        static const int QUEUE_LENGTH[2];
+        static const int QUEUE_WAIT_MS = 50;  // A caller that outruns the bus waits up to this long for room
+
+        QueueHandle_t _queues[2] = { nullptr, nullptr };
+        TaskHandle_t  _task      = nullptr;
+
+        bool        queue(const Transaction& t, Priority priority);
+        static void bus_task(void* arg);
+
     public:
         I2CBus(int busNumber);
 
@@ -29,6 +60,12 @@ namespace Machine {
         int write(uint8_t address, const uint8_t* data, size_t count);
         int read(uint8_t address, uint8_t* data, size_t count);
 
+        // Return false if the transaction could not be queued.  done, if not null, runs
+        // in the bus task when the transaction completes.  The data of a write is copied,
+        // but the data of a read must stay valid until done runs.
+        bool queue_write(uint8_t address, const uint8_t* data, size_t count, Priority priority, Callback done = nullptr, void* arg = nullptr);
+        bool queue_read(uint8_t address, uint8_t* data, size_t count, Priority priority, Callback done, void* arg = nullptr);
+
         ~I2CBus() = default;
     };
 }
@@ -3,7 +3,9 @@
 // Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
 
 #include "I2SOBus.h"
-#include "Driver/i2s_out.h"  // i2s_out_init()
+#include "Driver/i2s_out.h"  // i2s_out_init(), i2s_out_begin()
+
+#include <esp_attr.h>  // IRAM_ATTR
 
 namespace Machine {
     const EnumItem pulseUsValues[] = { { 1, "1" }, { 2, "2" }, { 4, "4" }, EnumItem(2) };
@@ -53,4 +55,12 @@ namespace Machine {
             i2s_out_init(&params);
         }
     }
+
+    void IRAM_ATTR I2SOBus::begin() {
+        i2s_out_begin();
+    }
+
+    void IRAM_ATTR I2SOBus::commit() {
+        i2s_out_commit();
+    }
 }
@@ -22,6 +22,17 @@ namespace Machine {
 
         void init();
 
+        // Pin writes between begin() and commit() reach the shift registers in one
+        // latch, and synchronous writes among them wait once, in commit().  Without
+        // I2SO pins, they do nothing.  Transaction calls them from a scope.
+        static void begin();
+        static void commit();
+
+        struct Transaction {
+            Transaction() { begin(); }
+            ~Transaction() { commit(); }
+        };
+
         ~I2SOBus() = default;
     };
 }
@@ -5,6 +5,8 @@
 #include "src/Limits.h"
 #include "src/Protocol.h"  // protocol_send_event_from_ISR()
 
+#include "Driver/fluidnc_gpio.h"  // gpio_set_fast_action()
+
 namespace Machine {
     LimitPin::LimitPin(int axis, int motor, int direction, bool& pHardLimits) :
         EventPin(&limitEvent, "Limit"), _axis(axis), _motorNum(motor), _pHardLimits(pHardLimits) {
@@ -44,18 +46,34 @@ namespace Machine {
 
     void LimitPin::init() {
         EventPin::init();
-        _pLimited = Stepping::limit_var(_axis, _motorNum);
+        if (defined() && capabilities().has(Pin::Capabilities::Native)) {
+            // Let the step ISR stop the motor without waiting for the event
+            gpio_set_fast_action(getNative(Pin::Capabilities::Input | Pin::Capabilities::Native), fast_trigger, this);
+        }
     }
 
-    void LimitPin::trigger(bool active) {
+    void IRAM_ATTR LimitPin::fast_trigger(void* arg, int active) {
+        static_cast<LimitPin*>(arg)->set_limited(active);
+    }
+
+    void IRAM_ATTR LimitPin::limit_motors(bool active) {
+        if (active) {
+            Stepping::limit(_axis, _motorNum);
+            if (_extraAxis >= 0) {
+                Stepping::limit(_extraAxis, _extraMotor);
+            }
+        } else {
+            Stepping::unlimit(_axis, _motorNum);
+            if (_extraAxis >= 0) {
+                Stepping::unlimit(_extraAxis, _extraMotor);
+            }
+        }
+    }
+
+    void IRAM_ATTR LimitPin::set_limited(bool active) {
         if (active) {
             if (Homing::approach() || (!state_is(State::Homing) && _pHardLimits)) {
-                if (_pLimited != nullptr) {
-                    *_pLimited = active;
-                }
-                if (_pExtraLimited != nullptr) {
-                    *_pExtraLimited = active;
-                }
+                limit_motors(true);
             }
 
             if (_posLimits != nullptr) {
@@ -65,12 +83,7 @@ namespace Machine {
                 set_bits(*_negLimits, _bitmask);
             }
         } else {
-            if (_pLimited != nullptr) {
-                *_pLimited = active;
-            }
-            if (_pExtraLimited != nullptr) {
-                *_pExtraLimited = active;
-            }
+            limit_motors(false);
             if (_posLimits != nullptr) {
                 clear_bits(*_posLimits, _bitmask);
             }
@@ -78,6 +91,10 @@ namespace Machine {
                 clear_bits(*_negLimits, _bitmask);
             }
         }
+    }
+
+    void LimitPin::trigger(bool active) {
+        set_limited(active);
         EventPin::trigger(active);
     }
 
@@ -89,6 +106,7 @@ namespace Machine {
     }
 
     void LimitPin::setExtraMotorLimit(int axis, int motorNum) {
-        _pExtraLimited = Stepping::limit_var(axis, motorNum);
+        _extraAxis  = axis;
+        _extraMotor = motorNum;
     }
 }
@@ -2,6 +2,8 @@
 
 #include "EventPin.h"
 
+#include <esp_attr.h>  // IRAM_ATTR
+
 namespace Machine {
     class LimitPin : public EventPin {
     private:
@@ -12,18 +14,24 @@ namespace Machine {
         // limit behavior dynamically.
         bool& _pHardLimits;
 
-        // _pLimited is a reference to the _limited member of
-        // the Motor class.  Setting it when the Limit ISR fires
-        // lets the motor driver respond rapidly to a limit switch
-        // touch, increasing the accuracy of homing
-        // _pExtraLimited lets the limit control two motors, as with
-        // CoreXY
-        volatile bool* _pLimited;
-        volatile bool* _pExtraLimited = nullptr;
+        // Stopping the motor with Stepping::limit() when the Limit ISR
+        // fires lets the motor respond rapidly to a limit switch touch,
+        // increasing the accuracy of homing.  _extraAxis lets the limit
+        // control a second motor, as with CoreXY; -1 for none.
+        int _extraAxis  = -1;
+        int _extraMotor = 0;
+
+        void IRAM_ATTR limit_motors(bool active);
 
         volatile uint32_t* _posLimits = nullptr;
         volatile uint32_t* _negLimits = nullptr;
 
+        // Updates the motor limits and the limit masks.  Called by the step
+        // ISR, through fast_trigger(), as soon as a native GPIO switch
+        // changes, and again by trigger() when the event arrives.
+        void IRAM_ATTR        set_limited(bool active);
+        static void IRAM_ATTR fast_trigger(void* arg, int active);
+
     public:
         LimitPin(int axis, int motorNum, int direction, bool& phardLimits);
 
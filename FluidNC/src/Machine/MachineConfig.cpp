@@ -21,9 +21,12 @@
 #include "src/Configuration/Validator.h"
 #include "src/Configuration/AfterParse.h"
 #include "src/Configuration/ParseException.h"
-#include "src/Config.h"  // ENABLE_*
+#include "src/Configuration/ConfigCache.h"
+#include "src/Report.h"       // git_info
+#include "src/Config.h"       // ENABLE_*
+#include "src/CrashRecord.h"  // CrashRecord::skip_config()
 
-#include "Driver/restart.h"
+#include "Driver/config_partition.h"  // config_partition_map()
 
 #include <cstdio>
 #include <cstring>
@@ -35,6 +38,11 @@ Machine::MachineConfig* config;
 // TODO FIXME: Split this file up into several files, perhaps put it in some folder and namespace Machine?
 
 namespace Machine {
+    // Only the hot block records count against internal RAM when the side table is in PSRAM,
+    // so a deeper planner is allowed in that case.
+    static const size_t max_planner_blocks       = 256;
+    static const size_t max_planner_blocks_psram = 512;
+
     void MachineConfig::group(Configuration::HandlerBase& handler) {
         handler.item("board", _board);
         handler.item("name", _name);
@@ -65,6 +73,7 @@ namespace Machine {
         handler.section("macros", _macros);
         handler.section("start", _start);
         handler.section("parking", _parking);
+        handler.section("tasks", _tasks);
 
         handler.section("user_outputs", _userOutputs);
         handler.section("user_inputs", _userInputs);
@@ -76,14 +85,23 @@ namespace Machine {
         // TODO: Consider putting these under a gcode: hierarchy level? Or motion control?
         handler.item("arc_tolerance_mm", _arcTolerance, 0.001, 1.0);
         handler.item("junction_deviation_mm", _junctionDeviation, 0.01, 1.0);
+        handler.item("blend_tolerance_mm", _blendTolerance, 0.0, 1.0);
         handler.item("verbose_errors", _verboseErrors);
         handler.item("report_inches", _reportInches);
         handler.item("enable_parking_override_control", _enableParkingOverrideControl);
         handler.item("use_line_numbers", _useLineNumbers);
-        handler.item("planner_blocks", _planner_blocks, 10, 120);
+        handler.item("planner_blocks", _planner_blocks, 10, max_planner_blocks_psram);
+        handler.item("planner_psram", _planner_psram);
+        handler.item("planner_replan_limit", _planner_replan_limit, 0, 256);
+        handler.item("native_arcs", _native_arcs);
     }
 
     void MachineConfig::afterParse() {
+        if (_planner_blocks > max_planner_blocks && !_planner_psram) {
+            log_warn("planner_blocks above " << max_planner_blocks << " requires planner_psram");
+            _planner_blocks = max_planner_blocks;
+        }
+
         if (_axes == nullptr) {
             log_info("Axes: using defaults");
             _axes = new Axes();
@@ -136,6 +154,10 @@ namespace Machine {
             _parking = new Parking();
         }
 
+        if (_tasks == nullptr) {
+            _tasks = new Tasks();
+        }
+
         auto spindles = Spindles::SpindleFactory::objects();
         if (spindles.size() == 0) {
             spindles.push_back(new Spindles::Null("NoSpindle"));
@@ -161,9 +183,11 @@ namespace Machine {
     const char defaultConfig[] = "name: Default (Test Drive)\nboard: None\n";
 
     void MachineConfig::load() {
-        // If the system crashes we skip the config file and use the default
-        // builtin config.  This helps prevent reset loops on bad config files.
-        if (restart_was_panic()) {
+        // If the system crashes during startup, or keeps crashing soon after it,
+        // we skip the config file and use the default builtin config.  This helps
+        // prevent reset loops on bad config files.  After any other panic the
+        // machine comes back with its own configuration.
+        if (CrashRecord::skip_config()) {
             log_error("Skipping configuration file due to panic");
             log_info("Using default configuration");
             load_yaml(defaultConfig);
@@ -173,8 +197,40 @@ namespace Machine {
         }
     }
 
+    // An image of the file in the config partition is parsed where it is mapped, without
+    // a copy in the heap.  It is skipped if the file exists with a different size, which
+    // means that the file was edited after $Config/Flash.
+    bool MachineConfig::load_partition(const std::string_view filename) {
+        size_t      size;
+        const char* name;
+        const char* text = config_partition_map(size, name);
+        if (!text) {
+            return false;
+        }
+        bool stale = filename != name;
+        if (!stale) {
+            try {
+                FileStream file(std::string { filename }, "r", "");
+                stale = size_t(file.size()) != size;
+                if (stale) {
+                    log_info("Configuration file:" << filename << " differs from the config partition");
+                }
+            } catch (...) {}
+        }
+        if (!stale) {
+            log_info("Configuration file:" << filename << " from the config partition");
+            load_text(std::string_view { text, size }, filename);
+        }
+        config_partition_unmap();  // The parsed values are copies, so nothing points into the mapping
+        return !stale;
+    }
+
     void MachineConfig::load_file(const std::string_view filename) {
         try {
+            if (load_partition(filename)) {
+                return;
+            }
+
             FileStream file(std::string { filename }, "r", "");
 
             auto filesize = file.size();
@@ -191,7 +247,7 @@ namespace Machine {
                 return;
             }
             log_info("Configuration file:" << filename);
-            load_yaml(std::string_view { buffer.get(), filesize });
+            load_text(std::string_view { buffer.get(), size_t(filesize) }, filename);
         } catch (...) {
             log_config_error("Cannot open configuration file:" << filename);
             log_info("Using default configuration");
@@ -200,10 +256,62 @@ namespace Machine {
         }
     }
 
+    void MachineConfig::load_text(std::string_view yaml, const std::string_view filename) {
+        // The cache for this text and this firmware skips the scan and the validation
+        uint32_t    key        = Configuration::ConfigCache::hash(yaml, Configuration::ConfigCache::hash(git_info));
+        std::string cache_name = std::string(filename) + ".cache";
+        if (load_cache(cache_name, key)) {
+            return;
+        }
+
+        Configuration::ConfigCache::Writer recorder(key);
+        Configuration::Parser              parser(yaml);
+        parser.record(&recorder);
+        load_parsed(parser, true);
+        if (recorder.ok() && !state_is(State::ConfigAlarm)) {
+            save_cache(cache_name, recorder.blob());
+        }
+    }
+
+    bool MachineConfig::load_cache(const std::string& filename, uint32_t key) {
+        std::unique_ptr<char[]> blob;
+        size_t                  size;
+        try {
+            FileStream file(filename, "r", "");
+            size = file.size();
+            blob = std::make_unique<char[]>(size);
+            if (file.read(blob.get(), size) != size) {
+                return false;
+            }
+        } catch (...) { return false; }
+
+        Configuration::ConfigCache::Reader reader(std::string_view { blob.get(), size }, key);
+        if (!reader.valid()) {
+            return false;
+        }
+        log_info("Configuration cache:" << filename);
+        Configuration::Parser parser(reader);
+        load_parsed(parser, false);
+        return true;
+    }
+
+    void MachineConfig::save_cache(const std::string& filename, const std::string& blob) {
+        try {
+            FileStream file(filename, "w", "");
+            if (file.write(reinterpret_cast<const uint8_t*>(blob.data()), blob.size()) == blob.size()) {
+                log_debug("Saved configuration cache " << filename);
+            }
+        } catch (...) { log_debug("Cannot save configuration cache " << filename); }
+    }
+
     void MachineConfig::load_yaml(std::string_view input) {
-        bool successful = false;
+        Configuration::Parser parser(input);
+        load_parsed(parser, true);
+    }
+
+    // validate is false for tokens from the cache, which passed validation when the cache was made
+    void MachineConfig::load_parsed(Configuration::Parser& parser, bool validate) {
         try {
-            Configuration::Parser        parser(input);
             Configuration::ParserHandler handler(parser);
 
             // instance() is by reference, so we can just get rid of an old instance and
@@ -227,13 +335,15 @@ namespace Machine {
                 config->group(afterParse);
             } catch (std::exception& ex) { log_error("Validation error: " << ex.what()); }
 
-            log_debug("Checking configuration");
+            if (validate) {
+                log_debug("Checking configuration");
 
-            try {
-                Configuration::Validator validator;
-                config->validate();
-                config->group(validator);
-            } catch (std::exception& ex) { log_config_error("Validation error: " << ex.what()); }
+                try {
+                    Configuration::Validator validator;
+                    config->validate();
+                    config->group(validator);
+                } catch (std::exception& ex) { log_config_error("Validation error: " << ex.what()); }
+            }
 
             // log_info("Heap size after configuation load is " << uint32_t(xPortGetFreeHeapSize()));
 
@@ -27,6 +27,7 @@
 #include "UserOutputs.h"
 #include "UserInputs.h"
 #include "Macros.h"
+#include "Tasks.h"
 
 #include <string_view>
 
@@ -75,17 +76,30 @@ namespace Machine {
         Macros*         _macros         = nullptr;
         Start*          _start          = nullptr;
         Parking*        _parking        = nullptr;
+        Tasks*          _tasks          = nullptr;
 
         UartChannel* _uart_channels[MAX_N_UARTS] = { nullptr };
         Uart*        _uarts[MAX_N_UARTS]         = { nullptr };
 
         float _arcTolerance      = 0.002f;
         float _junctionDeviation = 0.01f;
+        float _blendTolerance    = 0.02f;  // G64 path tolerance when no P word is given
         bool  _verboseErrors     = true;
         bool  _reportInches      = false;
 
         size_t _planner_blocks = 16;
 
+        // Put the planner side table in PSRAM, allowing deeper planners on boards that have it.
+        bool _planner_psram = false;
+
+        // Maximum number of blocks the planner revisits when a new block is appended.
+        // 0 means no limit; the replan still stops as soon as it converges with the old plan.
+        size_t _planner_replan_limit = 0;
+
+        // Queue G2/G3 arcs as single planner blocks that the segment generator interpolates,
+        // instead of chords. Only used with kinematics whose motor space is cartesian space.
+        bool _native_arcs = false;
+
         // Enables a special set of M-code commands that enables and disables the parking motion.
         // These are controlled by `M56`, `M56 P1`, or `M56 Px` to enable and `M56 P0` to disable.
         // The command is modal and will be set after a planner sync. Since it is GCode, it is
@@ -112,6 +126,15 @@ namespace Machine {
         static void load_file(std::string_view file);
         static void load_yaml(std::string_view yaml_string);
 
+    private:
+        static bool load_partition(std::string_view filename);
+        static void load_text(std::string_view yaml, std::string_view filename);
+        static void load_parsed(Configuration::Parser& parser, bool validate);
+        static bool load_cache(const std::string& filename, uint32_t key);
+        static void save_cache(const std::string& filename, const std::string& blob);
+
+    public:
+
         ~MachineConfig();
     };
 }
@@ -6,8 +6,9 @@
 #include "src/System.h"                 // sys
 #include "src/Machine/MachineConfig.h"  // config
 #include "src/Job.h"                    // Job::
-#include <sstream>
-#include <iomanip>
+#include "src/FlatMap.h"                // FlatMap
+
+#include <cstdio>  // snprintf
 
 void MacroEvent::run(void* arg) const {
     config->_macros->_macro[_num].run(nullptr);
@@ -32,7 +33,7 @@ Macro Macros::_after_reset { "after_reset" };
 Macro Macros::_after_unlock { "after_unlock" };
 
 // clang-format off
-const std::map<std::string, Cmd> overrideCodes = {
+static constexpr auto override_table = sorted_table<std::string_view, Cmd>({
     { "fr", Cmd::FeedOvrReset },
     { "f>", Cmd::FeedOvrCoarsePlus },
     { "f<", Cmd::FeedOvrCoarseMinus },
@@ -50,14 +51,55 @@ const std::map<std::string, Cmd> overrideCodes = {
     { "ss", Cmd::SpindleOvrStop },
     { "ft", Cmd::CoolantFloodOvrToggle },
     { "mt", Cmd::CoolantMistOvrToggle },
-};
+});
+static const FlatMap<std::string_view, Cmd> overrideCodes(override_table);
 // clang-format on
 
-Cmd findOverride(std::string name) {
+Cmd findOverride(std::string_view name) {
     auto it = overrideCodes.find(name);
     return it == overrideCodes.end() ? Cmd::None : it->second;
 }
 
+void Macro::compile() {
+    _text.clear();
+    _cmds.clear();
+    _lines.clear();
+
+    const size_t gcode_len = _gcode.length();
+    size_t       position  = 0;
+    do {
+        Line line { uint32_t(_text.length()), 0, uint32_t(_cmds.size()), 0, 0 };
+        while (position < gcode_len) {
+            char c = _gcode[position++];
+            // XXX this can probably be pushed into the GCode parser alongside expressions
+            // Realtime characters can be inserted in macros with #xx escapes
+            if (c == '#') {
+                if ((position + 2) <= gcode_len) {
+                    Cmd cmd = findOverride(std::string_view(_gcode).substr(position, 2));
+                    if (cmd != Cmd::None) {
+                        position += 2;
+                        _cmds.push_back(cmd);
+                        continue;
+                    }
+                }
+            }
+            // & is a proxy for newlines in macros, because you cannot
+            // enter a newline directly in a config file string value.
+            if (c == '&' || c == '\n') {
+                break;
+            }
+            _text += c;
+        }
+        line.length = uint32_t(_text.length() - line.text);
+        line.n_cmds = uint32_t(_cmds.size() - line.cmds);
+        line.end    = uint32_t(position);
+        _lines.push_back(line);
+        // Running stops at the first line with no text, so there is no need to compile beyond it
+    } while (_lines.back().length && position < gcode_len);
+
+    _compiled = true;
+}
+
 bool Macro::run(Channel* channel) {
     if (_gcode.length()) {
         if (channel) {
@@ -71,32 +113,20 @@ bool Macro::run(Channel* channel) {
 }
 
 Error MacroChannel::readLine(char* line, int maxlen) {
-    int                len       = 0;
-    const std::string& gcode     = _macro->_gcode;
-    const int          gcode_len = gcode.length();
-    while (_position < gcode_len) {
-        if (len >= maxlen) {
+    auto&  lines = _macro->lines();
+    size_t len   = 0;
+    if (_position < lines.size()) {
+        auto& l = lines[_position++];
+        if (l.length >= size_t(maxlen)) {
             return Error::LineLengthExceeded;
         }
-        char c = gcode[_position++];
-        // XXX this can probably be pushed into the GCode parser alongside expressions
-        // Realtime characters can be inserted in macros with #xx escapes
-        if (c == '#') {
-            if ((_position + 2) <= gcode_len) {
-                Cmd cmd = findOverride(gcode.substr(_position, 2));
-                if (cmd != Cmd::None) {
-                    _position += 2;
-                    execute_realtime_command(cmd, *this);
-                    continue;
-                }
-            }
-        }
-        // & is a proxy for newlines in macros, because you cannot
-        // enter a newline directly in a config file string value.
-        if (c == '&' || c == '\n') {
-            break;
+        const Cmd* cmds = _macro->cmds(l);
+        for (size_t i = 0; i < l.n_cmds; i++) {
+            execute_realtime_command(cmds[i], *this);
         }
-        line[len++] = c;
+        auto text = _macro->text(l);
+        len       = text.copy(line, text.length());
+        _end      = l.end;
     }
     line[len] = '\0';
     ++_line_number;
@@ -152,11 +182,14 @@ Error MacroChannel::pollLine(char* line) {
     switch (auto err = readLine(line, Channel::maxLine)) {
         case Error::Ok: {
             log_debug("Macro line: " << line);
-            float percent_complete = (float)_position * 100.0f / _macro->get().length();
-
-            std::ostringstream s;
-            s << "SD:" << std::fixed << std::setprecision(2) << percent_complete << "," << name();
-            _progress = s.str();
+            float percent_complete = (float)_end * 100.0f / _macro->get().length();
+
+            char percent[12];
+            snprintf(percent, sizeof(percent), "%.2f", percent_complete);
+            _progress = "SD:";
+            _progress += percent;
+            _progress += ",";
+            _progress += name();
         }
             return Error::Ok;
         case Error::Eof:
@@ -57,7 +57,8 @@ namespace Machine {
     class MacroChannel : public Channel {
     private:
         Error  _pending_error = Error::Ok;
-        size_t _position      = 0;
+        size_t _position      = 0;  // Index of the next line of the compiled macro
+        size_t _end           = 0;  // Offset in the macro text after the last line read
         size_t _blank_lines   = 0;
 
         Macro* _macro;
@@ -20,6 +20,7 @@ namespace Machine {
         handler.item("limit_all_pin", _allLimitPin);
         handler.item("hard_limits", _hardLimits);
         handler.item("pulloff_mm", _pulloff, 0.1, 100000.0);
+        handler.section("encoder", _encoder);
         MotorDrivers::MotorFactory::factory(handler, _driver);
     }
 
@@ -38,6 +39,10 @@ namespace Machine {
         _negLimitPin.init();
         _posLimitPin.init();
         _allLimitPin.init();
+
+        if (_encoder) {
+            _encoder->init(_axis, _motorNum);
+        }
     }
 
     void Motor::config_motor() {
@@ -70,6 +75,7 @@ namespace Machine {
     }
 
     Motor::~Motor() {
+        delete _encoder;
         delete _driver;
     }
 }
@@ -6,6 +6,7 @@
 
 #include "../Configuration/Configurable.h"
 #include "LimitPin.h"
+#include "MotorEncoder.h"
 
 namespace MotorDrivers {
     class MotorDriver;
@@ -32,6 +33,8 @@ namespace Machine {
 
         bool _hardLimits = false;
 
+        MotorEncoder* _encoder = nullptr;  // For closed-loop position verification
+
         // Configuration system helpers:
         void group(Configuration::HandlerBase& handler) override;
         void afterParse() override;
@@ -0,0 +1,141 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "MotorEncoder.h"
+
+#include "Axes.h"
+#include "../Logging.h"
+#include "../Protocol.h"           // followingErrorEvent
+#include "../Stepping.h"           // Stepping::getSteps()
+#include "Driver/pulse_counter.h"  // pulse_counter_init_quadrature, pulse_counter_read
+
+#include <cstdlib>  // abs
+
+namespace Machine {
+    MotorEncoder* MotorEncoder::_encoders[MAX_ENCODERS];
+    int           MotorEncoder::_n_encoders = 0;
+
+    void MotorEncoder::init(size_t axis, int motor) {
+        _axis  = axis;
+        _motor = motor;
+        if (_n_encoders == MAX_ENCODERS) {
+            log_error("Too many motor encoders");
+            return;
+        }
+        _unit = _n_encoders + 1;
+
+        _a_pin.setAttr(Pin::Attr::Input);
+        _b_pin.setAttr(Pin::Attr::Input);
+        if (!pulse_counter_init_quadrature(_unit,
+                                           _a_pin.getNative(Pin::Capabilities::Input | Pin::Capabilities::Native),
+                                           _b_pin.getNative(Pin::Capabilities::Input | Pin::Capabilities::Native),
+                                           COUNT_LIMIT)) {
+            return;
+        }
+
+        rescale();
+        _last_raw = pulse_counter_read(_unit);
+
+        _encoders[_n_encoders++] = this;
+
+        log_info("Motor encoder Axis:" << Axes::axisName(axis) << (motor ? "2" : "") << " A:" << _a_pin.name() << " B:" << _b_pin.name()
+                                       << " Counts/mm:" << _counts_per_mm << " Max error:" << _max_error_mm << "mm");
+    }
+
+    void MotorEncoder::rescale() {
+        float steps_per_mm = Axes::_axis[_axis]->_stepsPerMm;
+        _steps_per_count   = int64_t(steps_per_mm / _counts_per_mm * 65536.0f);
+        _max_error         = int32_t(_max_error_mm * steps_per_mm);
+        _correct           = int32_t(_correct_mm * steps_per_mm);
+        _resync            = true;
+    }
+
+    // The 16-bit counter wraps at COUNT_LIMIT, so it must be read at least once
+    // per COUNT_LIMIT / 2 counts.  At a segment boundary every few milliseconds,
+    // that allows count rates of several MHz.
+    bool IRAM_ATTR MotorEncoder::check(int32_t steps, bool restart) {
+        int16_t raw   = pulse_counter_read(_unit);
+        int32_t delta = (int32_t(raw) - _last_raw) % COUNT_LIMIT;
+        if (delta > COUNT_LIMIT / 2) {
+            delta -= COUNT_LIMIT;
+        } else if (delta < -COUNT_LIMIT / 2) {
+            delta += COUNT_LIMIT;
+        }
+        _last_raw = raw;
+        _count += delta;
+
+        if (restart || _resync) {
+            _ref_count = _count;
+            _ref_steps = steps;
+            _error     = 0;
+            _resync    = false;
+            _tripped   = false;
+            return true;
+        }
+        int32_t position = int32_t(((_count - _ref_count) * _steps_per_count) >> 16);
+        _error           = (steps - _ref_steps) - position;
+        return abs(_error) <= _max_error;
+    }
+
+    void IRAM_ATTR MotorEncoder::check_all() {
+        // Homing holds back motors of ganged axes while their steps are counted
+        bool homing = state_is(State::Homing);
+        for (int i = 0; i < _n_encoders; ++i) {
+            MotorEncoder* e = _encoders[i];
+            if (!e->check(int32_t(Stepping::getSteps(e->_axis)), homing) && !e->_tripped) {
+                e->_tripped = true;
+                protocol_send_event_from_ISR(&followingErrorEvent, e);
+            }
+        }
+    }
+
+    void MotorEncoder::resync(size_t axis) {
+        for (int i = 0; i < _n_encoders; ++i) {
+            if (_encoders[i]->_axis == axis) {
+                _encoders[i]->_resync = true;
+            }
+        }
+    }
+
+    // The step count is shared by the motors of an axis, so only the encoder of
+    // an axis with one motor can correct it
+    bool MotorEncoder::correct_drift() {
+        bool corrected = false;
+        for (int i = 0; i < _n_encoders; ++i) {
+            MotorEncoder* e = _encoders[i];
+            if (!e->_correct || Axes::_axis[e->_axis]->hasDualMotor()) {
+                continue;
+            }
+            int32_t steps = int32_t(Stepping::getSteps(e->_axis));
+            e->check(steps, false);  // The last segment has finished since the ISR checked
+            int32_t error = e->_error;
+            if (error == 0 || abs(error) > e->_correct) {
+                continue;
+            }
+            Stepping::setSteps(e->_axis, steps - error);
+            e->_ref_steps -= error;
+            e->_error = 0;
+            corrected = true;
+            log_debug(Axes::axisName(e->_axis) << " encoder corrected " << error << " steps");
+        }
+        return corrected;
+    }
+
+    float MotorEncoder::error_mm() {
+        return _error / Axes::_axis[_axis]->_stepsPerMm;
+    }
+
+    void MotorEncoder::validate() {
+        Assert(_a_pin.defined() && _b_pin.defined(), "Motor encoder a_pin and b_pin must be configured");
+        Assert(_counts_per_mm > 0, "Motor encoder counts_per_mm must be set");
+        Assert(_correct_mm < _max_error_mm, "Motor encoder correct_mm must be less than max_error_mm");
+    }
+
+    void MotorEncoder::group(Configuration::HandlerBase& handler) {
+        handler.item("a_pin", _a_pin);
+        handler.item("b_pin", _b_pin);
+        handler.item("counts_per_mm", _counts_per_mm, 0.0, 1000000.0);
+        handler.item("max_error_mm", _max_error_mm, 0.001, 100.0);
+        handler.item("correct_mm", _correct_mm, 0.0, 100.0);
+    }
+}
@@ -0,0 +1,87 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include "../Configuration/Configurable.h"
+#include "../Pin.h"
+
+#include <esp_attr.h>  // IRAM_ATTR
+#include <cstdint>
+
+namespace Machine {
+    // A quadrature encoder that verifies the position of a stepper motor.  A
+    // hardware pulse counter decodes a_pin and b_pin; swap them if the count
+    // runs opposite to the motor.  counts_per_mm is the encoder resolution in
+    // the units of the axis, so the encoder can be on the motor shaft or on a
+    // linear scale.
+    //
+    // The step ISR compares the count with the step count of the axis at every
+    // segment boundary.  When they differ by more than max_error_mm, for
+    // example because the motor lost steps, a FollowingError alarm stops the
+    // machine.  With correct_mm set, a smaller difference that is left when a
+    // motion ends is corrected instead: the step count takes over the encoder
+    // position, so that the next motion starts from where the motor really is.
+    //
+    // The comparison restarts whenever the step count is set, and during
+    // homing, where motors are held back on purpose.
+    class MotorEncoder : public Configuration::Configurable {
+        Pin   _a_pin;
+        Pin   _b_pin;
+        float _counts_per_mm = 0.0f;
+        float _max_error_mm  = 0.5f;
+        float _correct_mm    = 0.0f;
+
+        static const int MAX_ENCODERS = 6;  // Pulse counter units 1-6; 0 is the spindle encoder's, 7 the handwheel's
+        static const int COUNT_LIMIT  = 30000;
+
+        static MotorEncoder* _encoders[MAX_ENCODERS];
+        static int           _n_encoders;
+
+        int     _unit            = -1;
+        size_t  _axis            = 0;
+        int     _motor           = 0;
+        int64_t _steps_per_count = 0;  // 16.16 fixed point, because the ISR cannot use floats
+        int32_t _max_error       = 0;  // Steps
+        int32_t _correct         = 0;  // Steps
+
+        // Updated by the step ISR
+        int16_t          _last_raw  = 0;
+        int32_t          _count     = 0;  // Counts since init, extended from the 16-bit counter
+        int32_t          _ref_count = 0;
+        int32_t          _ref_steps = 0;
+        volatile int32_t _error     = 0;  // Step count minus encoder position, in steps
+        volatile bool    _resync    = true;
+        volatile bool    _tripped   = false;
+
+        bool IRAM_ATTR check(int32_t steps, bool restart);
+
+    public:
+        MotorEncoder() = default;
+
+        void init(size_t axis, int motor);
+
+        // Converts the limits to steps, again after steps_per_mm changes
+        void rescale();
+
+        // Called by the step ISR at each segment boundary.  Sends followingErrorEvent
+        // for an encoder whose error exceeds max_error_mm.
+        static void IRAM_ATTR check_all();
+
+        // Restarts the comparison of the encoders on axis, after its step count was set
+        static void resync(size_t axis);
+
+        // Corrects the drift of the encoders with correct_mm set, with the motion
+        // stopped.  Returns true if any step count changed, in which case the
+        // planner and parser positions must be synced to the motors.
+        static bool correct_drift();
+
+        float  error_mm();
+        size_t axis() { return _axis; }
+        int    motor() { return _motor; }
+
+        // Configuration handlers:
+        void validate() override;
+        void group(Configuration::HandlerBase& handler) override;
+    };
+}
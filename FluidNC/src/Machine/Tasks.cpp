@@ -0,0 +1,39 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Tasks.h"
+#include "MachineConfig.h"  // config
+
+namespace Machine {
+    bool TaskConfig::create(TaskFunction_t function, void* parameters, TaskHandle_t* handle) const {
+        return xTaskCreatePinnedToCore(function, _name, _stackSize, parameters, _priority, handle, _core) == pdPASS;
+    }
+
+    void TaskConfig::group(Configuration::HandlerBase& handler) {
+        handler.item("core", _core, 0, 1);
+        handler.item("priority", _priority, 1, configMAX_PRIORITIES - 1);
+        handler.item("stack_size", _stackSize, 1024, 65536);
+    }
+
+    const Tasks& Tasks::get() {
+        static const Tasks builtin;
+        return config && config->_tasks ? *config->_tasks : builtin;
+    }
+
+    void Tasks::group(Configuration::HandlerBase& handler) {
+        handler.section("poller", _poller);
+        handler.section("output", _output);
+        handler.section("prep", _prep);
+        handler.section("servo", _servo);
+        handler.section("file_buffers", _fileBuffers);
+        handler.section("i2c", _i2c);
+        handler.section("modbus", _modbus);
+        handler.section("modbus_io", _modbusIO);
+        handler.section("thc", _thc);
+        handler.section("trinamic_diag", _trinamicDiag);
+        handler.section("trinamic_current", _trinamicCurrent);
+        handler.section("notifications", _notifications);
+        handler.section("web_commands", _webCommands);
+        handler.section("firmware_writer", _firmwareWriter);
+    }
+}
@@ -0,0 +1,72 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  Tasks.h - the core, priority and stack size of the FreeRTOS tasks
+
+  WiFi and the TCP/IP stack run on core 0, so under heavy network traffic the tasks that
+  share that core see jitter.  The optional tasks: section moves them, for example:
+
+  tasks:
+    poller:
+      core: 1
+      priority: 2
+    output:
+      stack_size: 20000
+
+  Items that are not given keep the built-in values, which are those of the tasks before
+  the section existed.  The settings take effect when a task is created, which for all of
+  them is after the configuration is loaded, so a change needs a restart.  A task with a
+  priority above the main loop's must block often, or it starves the tasks below it on its
+  core, including the idle task that feeds the watchdog.
+*/
+
+#include "../Configuration/Configurable.h"
+#include "../Config.h"  // SUPPORT_TASK_CORE, PREP_TASK_CORE, SERVO_TASK_CORE
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace Machine {
+    class TaskConfig : public Configuration::Configurable {
+        const char* _name;  // Of the FreeRTOS task
+
+    public:
+        int32_t _core;
+        int32_t _priority;
+        int32_t _stackSize;
+
+        TaskConfig(const char* name, int32_t core, int32_t priority, int32_t stackSize) :
+            _name(name), _core(core), _priority(priority), _stackSize(stackSize) {}
+
+        // xTaskCreatePinnedToCore() with this core, priority and stack size
+        bool create(TaskFunction_t function, void* parameters, TaskHandle_t* handle) const;
+
+        void group(Configuration::HandlerBase& handler) override;
+    };
+
+    class Tasks : public Configuration::Configurable {
+    public:
+        TaskConfig _poller { "poller", SUPPORT_TASK_CORE, 1, 8192 };
+        TaskConfig _output { "output", SUPPORT_TASK_CORE, 2, 16000 };
+        TaskConfig _prep { "prep", PREP_TASK_CORE, PREP_TASK_PRIORITY, 4096 };
+        TaskConfig _servo { "servoSync", SERVO_TASK_CORE, SERVO_TASK_PRIORITY, 3000 };
+        TaskConfig _fileBuffers { "filebuffers", SUPPORT_TASK_CORE, 1, 4096 };
+        TaskConfig _i2c { "i2cBusTask", SUPPORT_TASK_CORE, 1, 3000 };
+        TaskConfig _modbus { "modbusBusTask", SUPPORT_TASK_CORE, 1, 2048 };
+        TaskConfig _modbusIO { "modbusIO", SUPPORT_TASK_CORE, 2, 3072 };  // Above the poller, for the output latency
+        TaskConfig _thc { "thc", SUPPORT_TASK_CORE, 2, 3072 };
+        TaskConfig _trinamicDiag { "trinamicDiag", SUPPORT_TASK_CORE, 1, 3000 };
+        TaskConfig _trinamicCurrent { "trinamicCurrent", SUPPORT_TASK_CORE, 1, 3000 };
+        TaskConfig _notifications { "notifications", SUPPORT_TASK_CORE, 1, 8192 };  // Enough for a TLS handshake
+        TaskConfig _webCommands { "webCommands", SUPPORT_TASK_CORE, 1, 8192 };      // Like the poller, which ran them before
+        TaskConfig _firmwareWriter { "firmwareWriter", SUPPORT_TASK_CORE, 1, 6144 };  // Holds an Inflater
+
+        // The configured tasks, or the built-in ones before the configuration is loaded
+        static const Tasks& get();
+
+        void group(Configuration::HandlerBase& handler) override;
+    };
+}
@@ -2,8 +2,28 @@
 // Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
 
 #include "UserInputs.h"
+#include "../Protocol.h"  // protocol_execute_realtime(), protocol_wait_for_event()
+#include "../System.h"    // sys.abort
 
 namespace Machine {
+    void UserInputPin::init() {
+        if (canEvent()) {
+            registerEvent(this);
+            _events = true;
+        }
+        update(read());
+    }
+
+    // Runs in the executor; only changes are sent
+    void UserInputPin::trigger(bool active) {
+        if (active) {
+            ++_rises;
+        } else {
+            ++_falls;
+        }
+        update(active);
+    }
+
     UserInputs::UserInputs() {}
     UserInputs::~UserInputs() {}
 
@@ -31,6 +51,7 @@ namespace Machine {
         for (auto& input : _digitalInput) {
             if (input.pin.defined()) {
                 input.pin.setAttr(Pin::Attr::Input);
+                input.pin.init();
                 log_info("User Digital Input: " << input.name << " on Pin " << input.pin.name());
             }
         }
@@ -47,6 +68,64 @@ namespace Machine {
         return input.pin.read();
     }
 
+    // Pins that send events are checked when an event arrives, which is what wakes the wait;
+    // the others are read every tick.  Events, such as a feed hold or a reset, are handled
+    // while waiting.
+    UserInputs::ReadInputResult UserInputs::waitDigitalInput(uint8_t input_number, WaitOnInputMode mode, uint32_t timeout_ms, bool& met) {
+        if (input_number >= MaxUserDigitalPin) {
+            return Error::PParamMaxExceeded;
+        }
+        auto& pin = _digitalInput[input_number].pin;
+        if (!pin.defined()) {
+            return Error::InvalidValue;
+        }
+        TickType_t start   = xTaskGetTickCount();
+        TickType_t timeout = timeout_ms / portTICK_PERIOD_MS;
+        uint32_t   rises   = pin._rises;
+        uint32_t   falls   = pin._falls;
+        bool       last    = pin._events ? pin.get() : pin.read();
+        while (true) {
+            protocol_execute_realtime();
+            if (sys.abort) {
+                return Error::Reset;
+            }
+            bool value = pin._events ? pin.get() : pin.read();
+            if (!pin._events && value != last) {
+                if (value) {
+                    ++pin._rises;
+                } else {
+                    ++pin._falls;
+                }
+                last = value;
+            }
+            switch (mode) {
+                case WaitOnInputMode::Rise:
+                    met = pin._rises != rises;
+                    break;
+                case WaitOnInputMode::Fall:
+                    met = pin._falls != falls;
+                    break;
+                case WaitOnInputMode::High:
+                    met = value;
+                    break;
+                case WaitOnInputMode::Low:
+                    met = !value;
+                    break;
+                default:
+                    met = true;
+                    break;
+            }
+            if (met) {
+                return value;
+            }
+            TickType_t elapsed = xTaskGetTickCount() - start;
+            if (elapsed >= timeout) {
+                return false;
+            }
+            protocol_wait_for_event(pin._events ? timeout - elapsed : 1);
+        }
+    }
+
     UserInputs::ReadInputResult UserInputs::readAnalogInput(uint8_t input_number) {
         // TODO - analog pins are read the same as digital.
         if (input_number >= MaxUserAnalogPin) {
@@ -11,13 +11,31 @@
 
 namespace Machine {
 
+    // A digital input whose changes arrive as pin events if the pin can send them, so that a
+    // wait on it sleeps until the change instead of polling the pin
+    class UserInputPin : public InputPin {
+    public:
+        uint32_t _rises  = 0;      // Changes seen by trigger()
+        uint32_t _falls  = 0;
+        bool     _events = false;  // Registered for pin events
+
+        UserInputPin() : InputPin("") {}
+
+        void init();
+        void trigger(bool active) override;
+    };
+
     class UserInputs : public Configuration::Configurable {
         struct PinAndName {
             std::string name;
             Pin         pin;
         };
+        struct InputPinAndName {
+            std::string  name;
+            UserInputPin pin;
+        };
 
-        std::array<PinAndName, MaxUserDigitalPin> _digitalInput;
+        std::array<InputPinAndName, MaxUserDigitalPin> _digitalInput;
 
         // TODO - analog pins are read the same as digital. The Pin
         // API should either be extended to support analog reads, or
@@ -34,6 +52,11 @@ namespace Machine {
         using ReadInputResult = std::variant<bool, Error>;
         ReadInputResult readDigitalInput(uint8_t input_number);
         ReadInputResult readAnalogInput(uint8_t input_number);
+
+        // Waits for the digital input as M66 L1 to L4 does, the motion before it done.  The
+        // result is the value of the input, or false on a timeout; wait_mode says which.
+        // Returns Error::Reset if the wait was aborted.
+        ReadInputResult waitDigitalInput(uint8_t input_number, WaitOnInputMode mode, uint32_t timeout_ms, bool& met);
     };
 
 }  // namespace Machine
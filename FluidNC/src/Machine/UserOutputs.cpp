@@ -4,6 +4,7 @@
 
 #include "UserOutputs.h"
 #include "../Config.h"      // log_*
+#include "../Channel.h"     // Channel::PinBatch
 #include <esp32-hal-cpu.h>  // getApbFrequency()
 
 namespace Machine {
@@ -38,6 +39,7 @@ namespace Machine {
     }
 
     void UserOutputs::all_off() {
+        Channel::PinBatch expanders;  // One write for all outputs on each expander
         for (size_t io_num = 0; io_num < MaxUserDigitalPin; io_num++) {
             setDigital(io_num, false);
         }
@@ -63,8 +65,7 @@ namespace Machine {
             return percent == 0.0;
         }
 
-        // The 0.5 rounds to the nearest duty unit
-        uint32_t duty = uint32_t(((percent * pin.maxDuty()) / 100.0f) + 0.5);
+        uint32_t duty = analogDuty(io_num, percent);
         if (_current_value[io_num] == duty) {
             return true;
         }
@@ -76,6 +77,33 @@ namespace Machine {
         return true;
     }
 
+    uint32_t UserOutputs::analogDuty(size_t io_num, float percent) {
+        // The 0.5 rounds to the nearest duty unit
+        return uint32_t(((percent * _analogOutput[io_num].maxDuty()) / 100.0f) + 0.5);
+    }
+
+    // Pins were checked when the changes were queued, so this only needs to skip undefined
+    // pins that are being turned off.
+    void IRAM_ATTR UserOutputs::setFromISR(const plan_io_t& io) {
+        for (size_t io_num = 0; io_num < MaxUserDigitalPin; io_num++) {
+            Pin& pin = _digitalOutput[io_num];
+            if (pin.defined()) {
+                if (bitnum_is_true(io.digital_on, io_num)) {
+                    pin.write(true);
+                } else if (bitnum_is_true(io.digital_off, io_num)) {
+                    pin.write(false);
+                }
+            }
+        }
+        for (size_t io_num = 0; io_num < MaxUserAnalogPin; io_num++) {
+            Pin& pin = _analogOutput[io_num];
+            if (bitnum_is_true(io.analog, io_num) && pin.defined()) {
+                _current_value[io_num] = io.analog_duty[io_num];
+                pin.setDuty(io.analog_duty[io_num]);
+            }
+        }
+    }
+
     void UserOutputs::group(Configuration::HandlerBase& handler) {
         handler.item("analog0_pin", _analogOutput[0]);
         handler.item("analog1_pin", _analogOutput[1]);
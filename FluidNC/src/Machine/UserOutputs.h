@@ -5,7 +5,8 @@
 #pragma once
 
 #include "../Configuration/Configurable.h"
-#include "../GCode.h"  // MaxUserDigitalPin MaxUserAnalogPin
+#include "../GCode.h"    // MaxUserDigitalPin MaxUserAnalogPin
+#include "../Planner.h"  // plan_io_t
 
 namespace Machine {
     class UserOutputs : public Configuration::Configurable {
@@ -25,6 +26,12 @@ namespace Machine {
         bool setDigital(size_t io_num, bool isOn);
         bool setAnalogPercent(size_t io_num, float percent);
 
+        // Converts a percentage to the duty units of an analog output
+        uint32_t analogDuty(size_t io_num, float percent);
+
+        // Applies the synchronized output changes of a planner block. Called by the stepper ISR.
+        void setFromISR(const plan_io_t& io);
+
         virtual ~UserOutputs();
     };
 }
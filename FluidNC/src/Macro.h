@@ -1,19 +1,60 @@
 #pragma once
 #include "Channel.h"
+#include "RealtimeCmd.h"  // Cmd
+
+#include <vector>
 
 class Macro {
     std::string _name;
 
+public:
+    // A line of the compiled macro.  The text of the line, without its realtime
+    // #xx escapes, is in _text; the realtime commands of the line are in _cmds.
+    struct Line {
+        uint32_t text;    // Offset of the text in _text
+        uint32_t length;  // Length of the text
+        uint32_t cmds;    // Index of the first realtime command in _cmds
+        uint32_t n_cmds;  // Number of realtime commands
+        uint32_t end;     // Offset in _gcode after the line, for the progress report
+    };
+
+private:
+    // The macro is split into lines when it is set, or when it first runs after
+    // addf(), so that running it copies lines out of RAM instead of scanning the
+    // text for separators and escapes every time
+    std::string       _text;
+    std::vector<Cmd>  _cmds;
+    std::vector<Line> _lines;
+    bool              _compiled = true;
+
+    void compile();
+
 public:
     std::string        _gcode;
     bool               run(Channel* channel);
-    void               set(const char* value) { _gcode = value; }
-    void               set(const std::string& value) { _gcode = value; }
-    void               set(const std::string_view value) { _gcode = value; }
-    void               erase() { _gcode = ""; }
+    void               set(const char* value) { set(std::string_view(value)); }
+    void               set(const std::string& value) { set(std::string_view(value)); }
+    void               set(const std::string_view value) {
+        _gcode = value;
+        compile();
+    }
+    void erase() {
+        _gcode = "";
+        compile();
+    }
     const std::string& get() { return _gcode; }
     const char*        name() { return _name.c_str(); }
 
+    // The compiled lines; a line with no text ends the macro
+    const std::vector<Line>& lines() {
+        if (!_compiled) {
+            compile();
+        }
+        return _lines;
+    }
+    std::string_view text(const Line& line) const { return std::string_view(_text).substr(line.text, line.length); }
+    const Cmd*       cmds(const Line& line) const { return _cmds.data() + line.cmds; }
+
     // add to _gcode using a printf style formatting like _macro.addf("G53G0Z%0.3f", _safe_z);
     void addf(const char* format, ...) {
         char    loc_buf[100];
@@ -38,6 +79,7 @@ public:
         }
 
         _gcode += std::string(temp);
+        _compiled = false;
     }
 
     explicit Macro(const std::string& name) : _name(name) {}
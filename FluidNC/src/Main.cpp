@@ -18,7 +18,10 @@
 #    include "MotionControl.h"
 #    include "Platform.h"
 #    include "StartupLog.h"
+#    include "CrashRecord.h"
 #    include "Module.h"
+#    include "ToolTable.h"
+#    include "PowerLoss.h"
 
 #    include "Driver/localfs.h"
 #    include "esp32-hal.h"  // disableCore0WDT
@@ -27,24 +30,46 @@
 
 extern void make_user_commands();
 
+// Initializes the modules that deferred_init() lets wait, typically the network
+// ones, after setup() has made the machine ready for a serial sender
+static void deferred_init_task(void* unused) {
+    StartupLog::stage("deferred_start");
+    for (auto const& module : Modules()) {
+        if (module->deferred_init()) {
+            try {
+                module->init();
+            } catch (const AssertionFailed& ex) { log_config_error("Critical error in " << module->name() << " init: " << ex.what()); }
+            module->set_ready();
+            StartupLog::stage(module->name());
+        }
+    }
+    allChannels.deregistration(&startupLog);
+    vTaskDelete(NULL);
+}
+
 void setup() {
+    bool deferred = false;  // Set if some modules wait for deferred_init_task
     disableCore0WDT();
     try {
         timing_init();
         uartInit();  // Setup serial port
 
-        StartupLog::init();
+        StartupLog::init();  // Starts the stage timing for $Startup/Show
+        CrashRecord::init();
 
         // Setup input polling loop after loading the configuration,
         // because the polling may depend on the config
         allChannels.init();
+        StartupLog::stage("channels");
 
         // WebUI::WiFiConfig::reset();
 
         protocol_init();
+        StartupLog::stage("protocol");
 
         // Load settings from non-volatile storage
         settings_init();  // requires config
+        StartupLog::stage("settings");
 
         log_info("FluidNC " << git_info << " " << git_url);
         log_info("Compiled with ESP32 SDK:" << esp_get_idf_version());
@@ -54,10 +79,13 @@ void setup() {
         } else {
             log_info("Local filesystem type is " << localfsName);
         }
+        StartupLog::stage("localfs");
 
         config->load();
+        StartupLog::stage("config");
 
         make_user_commands();
+        StartupLog::stage("user_commands");
 
         log_info("Machine " << config->_name);
         log_info("Board " << config->_board);
@@ -73,15 +101,19 @@ void setup() {
                 config->_uart_channels[i]->init();
             }
         }
+        StartupLog::stage("uarts");
 
         if (config->_i2so) {
             config->_i2so->init();
+            StartupLog::stage("i2so");
         }
         if (config->_spi) {
             config->_spi->init();
+            StartupLog::stage("spi");
 
             if (config->_sdCard != nullptr) {
                 config->_sdCard->init();
+                StartupLog::stage("sdcard");
             }
         }
         for (size_t i = 0; i < MAX_N_I2C; i++) {
@@ -89,49 +121,79 @@ void setup() {
                 config->_i2c[i]->init();
             }
         }
+        StartupLog::stage("i2c");
 
         Stepping::init();  // Configure stepper interrupt timers
+        StartupLog::stage("stepping");
 
         plan_init();
+        StartupLog::stage("planner");
 
         config->_userOutputs->init();
+        StartupLog::stage("user_outputs");
 
         config->_userInputs->init();
+        StartupLog::stage("user_inputs");
 
         Axes::init();
+        StartupLog::stage("axes");
 
         config->_control->init();
+        StartupLog::stage("control");
 
         config->_kinematics->init();
+        StartupLog::stage("kinematics");
 
         limits_init();
 
         // Initialize system state.
         for (auto const& module : Modules()) {
+            module->init_settings();
+            if (module->deferred_init()) {
+                deferred = true;
+                continue;
+            }
             module->init();
+            module->set_ready();
+            StartupLog::stage(module->name());
         }
         for (auto const& module : ConfigurableModules()) {
             module->init();
+            StartupLog::stage(module->name());
         }
 
+        ToolTable::init();
+        StartupLog::stage("tool_table");
+
+        PowerLoss::init();
+        StartupLog::stage("power_loss");
+
         auto atcs = ATCs::ATCFactory::objects();
         for (auto const& atc : atcs) {
             atc->init();
+            StartupLog::stage(atc->name());
         }
 
         if (!state_is(State::ConfigAlarm)) {
             auto spindles = Spindles::SpindleFactory::objects();
             for (auto const& spindle : spindles) {
                 spindle->init();
+                if (spindle->_encoder) {
+                    spindle->_encoder->init();
+                }
             }
             bool stopped_spindle, new_spindle;
             Spindles::Spindle::switchSpindle(0, spindles, spindle, stopped_spindle, new_spindle);
+            StartupLog::stage("spindles");
 
             config->_coolant->init();
+            StartupLog::stage("coolant");
             config->_probe->init();
+            StartupLog::stage("probe");
         }
 
         make_proxies();
+        StartupLog::stage("proxies");
 
     } catch (const AssertionFailed& ex) {
         // This means something is terribly broken:
@@ -139,7 +201,20 @@ void setup() {
     }
 
     allChannels.ready();
-    allChannels.deregistration(&startupLog);
+    CrashRecord::started();
+    if (deferred) {
+        // The startup log stays registered so $SS shows the network messages too
+        xTaskCreatePinnedToCore(deferred_init_task,  // task
+                                "deferredInit",      // name for task
+                                8192,                // size of task stack
+                                0,                   // parameters
+                                1,                   // priority
+                                NULL,                // task handle
+                                SUPPORT_TASK_CORE    // core
+        );
+    } else {
+        allChannels.deregistration(&startupLog);
+    }
     protocol_send_event(&startEvent);
 }
 
@@ -0,0 +1,307 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "ModbusIO.h"
+
+#include "Machine/MachineConfig.h"  // config->_uarts
+#include "Machine/Tasks.h"          // Machine::Tasks::get()
+#include "Protocol.h"               // protocol_send_pin_event()
+#include "Report.h"                 // hex_msg()
+#include "Uart.h"
+
+#include <algorithm>
+
+using Spindles::VFD::VFDProtocol;
+
+ModbusIO::Points ModbusIO::_points[MAX_DEVICES];
+TaskHandle_t     ModbusIO::_task     = nullptr;
+ModbusIO*        ModbusIO::_instance = nullptr;
+
+void ModbusIO::Device::group(Configuration::HandlerBase& handler) {
+    handler.item("modbus_id", _modbus_id, 0, 247);
+    handler.item("inputs", _inputs, 0, MAX_POINTS);
+    handler.item("input_address", _input_address, 0, 65535);
+    handler.item("input_function", _input_function, 1, 2);
+    handler.item("coils", _coils, 0, MAX_POINTS);
+    handler.item("coil_address", _coil_address, 0, 65535);
+    handler.item("registers", _registers, 0, MAX_REGISTERS);
+    handler.item("register_address", _register_address, 0, 65535);
+    handler.item("register_max", _register_max, 1, 65535);
+}
+
+void ModbusIO::group(Configuration::HandlerBase& handler) {
+    handler.item("uart_num", _uart_num);
+    handler.item("poll_ms", _poll_ms, 1, 10000);
+    handler.item("response_ms", _response_ms, 5, 1000);
+    handler.item("retries", _retries, 1, 10);
+    handler.item("debug", _debug, 0, 3);
+    handler.section("device0", _devices[0]);
+    handler.section("device1", _devices[1]);
+    handler.section("device2", _devices[2]);
+    handler.section("device3", _devices[3]);
+}
+
+void ModbusIO::validate() {
+    Assert(_uart_num >= 1 && _uart_num < MAX_N_UARTS, "modbus_io uart_num must be 1 or 2");
+}
+
+// The pins can be set up before the section is parsed, so they only use _points
+void ModbusIO::afterParse() {
+    for (int i = 0; i < MAX_DEVICES; i++) {
+        _points[i].register_max = _devices[i]._register_max;
+    }
+}
+
+void ModbusIO::init() {
+    _uart = config->_uarts[_uart_num];
+    if (!_uart) {
+        log_error("ModbusIO: Missing uart" << _uart_num << " section");
+        return;
+    }
+    if (_uart->setHalfDuplex()) {
+        log_error("ModbusIO: RS485 UART set half duplex failed");
+        return;
+    }
+    for (int i = 0; i < MAX_DEVICES; i++) {
+        auto& dev = _devices[i];
+        if (dev._modbus_id) {
+            log_info("ModbusIO device" << i << " id:" << dev._modbus_id << " inputs:" << dev._inputs << " coils:" << dev._coils
+                                       << " registers:" << dev._registers);
+        }
+    }
+    _uart->config_message("ModbusIO", " I/O");
+
+    _instance = this;
+    if (!_task) {
+        Machine::Tasks::get()._modbusIO.create(bus_task, this, &_task);
+    }
+}
+
+void IRAM_ATTR ModbusIO::wake() {
+    if (!_task) {
+        return;
+    }
+    if (xPortInIsrContext()) {
+        BaseType_t higherPriorityTaskWoken = pdFALSE;
+        vTaskNotifyGiveFromISR(_task, &higherPriorityTaskWoken);
+        if (higherPriorityTaskWoken) {
+            portYIELD_FROM_ISR();
+        }
+    } else {
+        xTaskNotifyGive(_task);
+    }
+}
+
+void IRAM_ATTR ModbusIO::set_coil(int device, int point, bool on) {
+    auto&    coils = _points[device].coils;
+    uint32_t mask  = 1u << point;
+    uint32_t old   = on ? coils.fetch_or(mask) : coils.fetch_and(~mask);
+    if (bool(old & mask) != on) {
+        wake();
+    }
+}
+
+void IRAM_ATTR ModbusIO::set_register(int device, int index, uint32_t value) {
+    auto& points = _points[device];
+    value        = std::min(value, uint32_t(points.register_max));
+    if (points.registers[index] != value) {
+        points.registers[index] = value;
+        points.dirty.fetch_or(1u << index);
+        wake();
+    }
+}
+
+// Output changes are written before each input read, and whenever a pin wakes the
+// task, so an output waits for at most the transaction that is on the wire.  The
+// inputs are read on a fixed schedule, also when output writes are frequent.
+void ModbusIO::bus_task(void* arg) {
+    auto       io        = static_cast<ModbusIO*>(arg);
+    TickType_t period    = std::max(io->_poll_ms / portTICK_PERIOD_MS, TickType_t(1));
+    TickType_t next_read = xTaskGetTickCount();
+    while (true) {
+        io->write_changes();
+        TickType_t now = xTaskGetTickCount();
+        if (int32_t(next_read - now) <= 0) {
+            for (int i = 0; i < MAX_DEVICES; i++) {
+                io->write_changes();
+                io->read_inputs(i);
+            }
+            next_read += period;
+            if (int32_t(next_read - now) <= 0) {
+                next_read = now + period;  // Overrun; the bus is slower than poll_ms
+            }
+        }
+        int32_t wait = next_read - xTaskGetTickCount();
+        ulTaskNotifyTake(pdTRUE, std::max(wait, int32_t(0)));
+    }
+}
+
+void ModbusIO::write_changes() {
+    for (int i = 0; i < MAX_DEVICES; i++) {
+        if (_devices[i]._modbus_id) {
+            write_changes(i);
+        }
+    }
+}
+
+void ModbusIO::write_changes(int device) {
+    auto& dev    = _devices[device];
+    auto& points = _points[device];
+
+    if (dev._coils) {
+        uint32_t want = points.coils.load() & (dev._coils == 32 ? ~0u : (1u << dev._coils) - 1);
+        if (!dev._coils_known || want != dev._written) {
+            // Write Multiple Coils, the first coil in the low bit of the first byte
+            ModbusCommand cmd;
+            int           nbytes = (dev._coils + 7) / 8;
+            cmd.msg[1]           = 0x0F;
+            cmd.msg[2]           = dev._coil_address >> 8;
+            cmd.msg[3]           = dev._coil_address & 0xff;
+            cmd.msg[4]           = 0;
+            cmd.msg[5]           = dev._coils;
+            cmd.msg[6]           = nbytes;
+            for (int i = 0; i < nbytes; i++) {
+                cmd.msg[7 + i] = (want >> (8 * i)) & 0xff;
+            }
+            cmd.tx_length = 7 + nbytes;
+            cmd.rx_length = 6;
+            uint8_t response[VFDProtocol::VFD_RS485_MAX_MSG_SIZE];
+            if (transact(dev, cmd, response)) {
+                dev._written     = want;
+                dev._coils_known = true;
+            }
+        }
+    }
+
+    uint32_t dirty = points.dirty.exchange(0);
+    for (int i = 0; dirty; i++, dirty >>= 1) {
+        if (!(dirty & 1) || i >= dev._registers) {
+            continue;
+        }
+        // Write Single Register
+        ModbusCommand cmd;
+        uint16_t      address = dev._register_address + i;
+        uint16_t      value   = points.registers[i];
+        cmd.msg[1]            = 0x06;
+        cmd.msg[2]            = address >> 8;
+        cmd.msg[3]            = address & 0xff;
+        cmd.msg[4]            = value >> 8;
+        cmd.msg[5]            = value & 0xff;
+        cmd.tx_length         = 6;
+        cmd.rx_length         = 6;
+        uint8_t response[VFDProtocol::VFD_RS485_MAX_MSG_SIZE];
+        if (!transact(dev, cmd, response) || points.registers[i] != value) {
+            points.dirty.fetch_or(1u << i);  // Try again, or write the newer value
+        }
+    }
+}
+
+void ModbusIO::read_inputs(int device) {
+    auto& dev = _devices[device];
+    if (!dev._modbus_id || !dev._inputs) {
+        return;
+    }
+    auto& points = _points[device];
+
+    // Read Discrete Inputs, or Read Coils
+    ModbusCommand cmd;
+    int           nbytes = (dev._inputs + 7) / 8;
+    cmd.msg[1]           = dev._input_function;
+    cmd.msg[2]           = dev._input_address >> 8;
+    cmd.msg[3]           = dev._input_address & 0xff;
+    cmd.msg[4]           = 0;
+    cmd.msg[5]           = dev._inputs;
+    cmd.tx_length        = 6;
+    cmd.rx_length        = 3 + nbytes;
+    uint8_t response[VFDProtocol::VFD_RS485_MAX_MSG_SIZE];
+    if (!transact(dev, cmd, response) || response[2] != nbytes) {
+        return;
+    }
+    uint32_t value = 0;
+    for (int i = 0; i < nbytes; i++) {
+        value |= uint32_t(response[3 + i]) << (8 * i);
+    }
+    uint32_t changed = points.inputs.exchange(value) ^ value;
+    for (int i = 0; changed; i++, changed >>= 1) {
+        if ((changed & 1) && points.events[i]) {
+            protocol_send_pin_event(points.events[i], bool((value ^ points.inverted) & (1u << i)));
+        }
+    }
+}
+
+// The framing is that of the VFD bus, see ModbusBus::transact().  The response has
+// the same length every time, so it is read with a timeout instead of the
+// inter-character gap.
+bool ModbusIO::transact(Device& dev, ModbusCommand& cmd, uint8_t* response) {
+    auto& uart = *_uart;
+
+    cmd.msg[0]               = dev._modbus_id;
+    auto crc16               = VFDProtocol::ModRTU_CRC(cmd.msg, cmd.tx_length);
+    cmd.msg[cmd.tx_length++] = crc16 & 0xFF;
+    cmd.msg[cmd.tx_length++] = (crc16 & 0xFF00) >> 8;
+    cmd.rx_length += 2;
+
+    if (_debug > 2) {
+        hex_msg(cmd.msg, "ModbusIO Tx: ", cmd.tx_length);
+    }
+
+    TickType_t response_ticks = std::max(_response_ms / portTICK_PERIOD_MS, TickType_t(1));
+    for (uint32_t retry = 0; retry < _retries; ++retry) {
+        uart.flush();
+        TickType_t sent = xTaskGetTickCount();
+        uart.write(cmd.msg, cmd.tx_length);
+        uart.flushTxTimed(response_ticks);
+
+        size_t length = 0;
+        size_t got;
+        do {
+            got = uart.timedReadBytes(response + length, cmd.rx_length - length, response_ticks);
+            length += got;
+        } while (length < cmd.rx_length && got > 0);
+
+        ++_transactions;
+        if (length == cmd.rx_length && response[0] == dev._modbus_id && response[1] == cmd.msg[1]) {
+            auto crc = VFDProtocol::ModRTU_CRC(response, length - 2);
+            if (response[length - 2] == (crc & 0xFF) && response[length - 1] == (crc & 0xFF00) >> 8) {
+                _max_ms = std::max(_max_ms, uint32_t((xTaskGetTickCount() - sent) * portTICK_PERIOD_MS));
+                if (_debug > 2) {
+                    hex_msg(response, "ModbusIO Rx: ", length);
+                }
+                if (dev._unresponsive) {
+                    log_info("ModbusIO id " << dev._modbus_id << " responding");
+                    dev._unresponsive = false;
+                }
+                return true;
+            }
+        }
+        ++_timeouts;
+        if (_debug) {
+            hex_msg(response, "ModbusIO bad response: ", length);
+        }
+    }
+    ++_failures;
+    if (!dev._unresponsive) {
+        log_warn("ModbusIO id " << dev._modbus_id << " unresponsive");
+        dev._unresponsive = true;
+    }
+    return false;
+}
+
+Error ModbusIO::show_stats(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    auto io = _instance;
+    if (!io) {
+        log_info_to(out, "ModbusIO is not configured");
+        return Error::Ok;
+    }
+    log_info_to(out,
+                "ModbusIO transactions:" << io->_transactions << " timeouts:" << io->_timeouts << " failures:" << io->_failures
+                                         << " max ms:" << io->_max_ms);
+    if (value && *value) {
+        io->_transactions = io->_timeouts = io->_failures = io->_max_ms = 0;
+    }
+    return Error::Ok;
+}
+
+namespace {
+    ConfigurableModuleFactory::InstanceBuilder<ModbusIO> registration("modbus_io");
+}
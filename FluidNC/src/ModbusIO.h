@@ -0,0 +1,143 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  ModbusIO.h - RS485 Modbus RTU I/O blocks as pins
+
+  The inputs and coils of Modbus I/O blocks can be used wherever a pin can, for example
+  as user_inputs for M66 and user_outputs for M62 to M65:
+
+  modbus_io:
+    uart_num: 2
+    poll_ms: 20
+    device0:
+      modbus_id: 1
+      inputs: 8
+      coils: 8
+    device1:
+      modbus_id: 2
+      registers: 2
+      register_max: 1000
+
+  user_outputs:
+    digital0_pin: modbus_io0.3
+    analog0_pin: modbus_io1.0
+  user_inputs:
+    digital0_pin: modbus_io0.5:low
+
+  The pin number is the offset from input_address for an input, from coil_address for a
+  digital output and from register_address for an analog output.  A pin write only
+  records the value and wakes the bus task, so it can be made from the stepper ISR, and
+  the task writes the coils of a device, and each changed register, as soon as the
+  transaction on the wire finishes.  Only changes are written.  The inputs are read
+  every poll_ms, and a change is sent as a pin event, so M66 waits without polling.
+
+  The bus needs a UART of its own; a VFD spindle cannot share it.
+*/
+
+#include "src/Config.h"
+#include "src/Module.h"
+#include "src/Spindles/VFD/VFDProtocol.h"  // ModbusCommand
+#include "src/WebUI/Authentication.h"      // AuthenticationLevel
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+
+class Uart;
+class InputPin;
+
+class ModbusIO : public ConfigurableModule {
+public:
+    static const int MAX_DEVICES   = 4;
+    static const int MAX_POINTS    = 32;  // Inputs or coils of one device
+    static const int MAX_REGISTERS = 4;   // Analog outputs of one device
+
+    // The values of the points of a device.  The pins read and change them without
+    // waiting for the bus; the bus task brings them up to date.
+    struct Points {
+        std::atomic<uint32_t> inputs { 0 };  // As last read
+        std::atomic<uint32_t> coils { 0 };   // As wanted
+        std::atomic<uint32_t> dirty { 0 };   // Registers to write
+        uint16_t              registers[MAX_REGISTERS] = {};
+        uint16_t              register_max             = 1000;
+        uint32_t              inverted                 = 0;  // Inputs that are active low
+        InputPin*             events[MAX_POINTS]       = {};
+    };
+    static Points _points[MAX_DEVICES];
+
+    // Called by the pins, from a task or an ISR
+    static void set_coil(int device, int point, bool on);
+    static void set_register(int device, int index, uint32_t value);
+
+    class Device : public Configuration::Configurable {
+    public:
+        int _modbus_id = 0;  // 0 for an unused device
+
+        int _inputs           = 0;
+        int _input_address    = 0;
+        int _input_function   = 2;  // 2 reads discrete inputs, 1 reads coils
+        int _coils            = 0;
+        int _coil_address     = 0;
+        int _registers        = 0;  // Holding registers, written with function 6
+        int _register_address = 0;
+        int _register_max     = 1000;  // The register value of 100%
+
+        // Bus task state
+        uint32_t _written      = 0;  // Coils as last written
+        bool     _coils_known  = false;
+        bool     _unresponsive = false;
+
+        void group(Configuration::HandlerBase& handler) override;
+    };
+
+private:
+    int      _uart_num    = -1;
+    uint32_t _poll_ms     = 20;
+    uint32_t _response_ms = 50;
+    uint32_t _retries     = 2;
+    int      _debug       = 0;
+    Device   _devices[MAX_DEVICES];
+
+    Uart* _uart = nullptr;
+
+    // For $ModbusIO/Stats
+    uint32_t _transactions = 0;
+    uint32_t _timeouts     = 0;  // Attempts without a valid response
+    uint32_t _failures     = 0;  // Transactions that used up the retries
+    uint32_t _max_ms       = 0;  // Longest successful transaction
+
+    static TaskHandle_t _task;
+    static ModbusIO*    _instance;
+
+    static void bus_task(void* arg);
+    static void wake();
+
+    using ModbusCommand = Spindles::VFD::VFDProtocol::ModbusCommand;
+
+    void write_changes();
+    void write_changes(int device);
+    void read_inputs(int device);
+    bool transact(Device& dev, ModbusCommand& cmd, uint8_t* response);
+
+public:
+    ModbusIO(const char* name) : ConfigurableModule(name) {}
+
+    ModbusIO(const ModbusIO&)            = delete;
+    ModbusIO(ModbusIO&&)                 = delete;
+    ModbusIO& operator=(const ModbusIO&) = delete;
+    ModbusIO& operator=(ModbusIO&&)      = delete;
+
+    virtual ~ModbusIO() = default;
+
+    void init() override;
+
+    // Configuration handlers:
+    void validate() override;
+    void afterParse() override;
+    void group(Configuration::HandlerBase& handler) override;
+
+    static Error show_stats(const char* value, AuthenticationLevel auth_level, Channel& out);
+};
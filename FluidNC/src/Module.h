@@ -32,11 +32,19 @@ configuration items by overriding the group() method.  A module that needs no co
 should derive from the Module class.
 
 ConfigurableModule methods:
+   void init_settings()
+       FluidNC calls all the init_settings methods at startup, before the init methods,
+       to create the module's settings and commands.  They must be created from setup(),
+       before other tasks can look through the lists of settings and commands, so a
+       module whose init() is deferred must create them here instead of in init().
    void init()
        FluidNC calls all the init methods at startup, to prepare the modules for use
    void deinit()
        The deinit method disables the module.  FluidNC does not call the deinit()
        methods.  It is for completeness and possible future use.
+   void poll()
+       FluidNC calls all the poll() methods from the polling task, about once a
+       millisecond when it is idle, as for Module.
 
 Module methods:
    void init()
@@ -60,6 +68,12 @@ Module methods:
     bool is_radio()
        Returns true if the module is for a radio like Bluetooth or WiFi.  This is
        used to populate the "R" field in the Grbl signon message.
+    bool deferred_init()
+       Returns true if init() can wait until motion, limits and control pins are
+       ready.  Network modules return true, so a background task initializes them
+       after setup() has finished and a serial sender need not wait for WiFi to
+       associate.  Until init() returns, ready() is false and FluidNC does not
+       call the module's poll(), build_info() or wifi_stats().
 */
 #pragma once
 
@@ -73,7 +87,8 @@ class Module;
 class JSONencoder;
 
 class Module {
-    const char* _name;
+    const char*   _name;
+    volatile bool _ready = false;
 
 public:
     Module() : _name("noname") {}
@@ -82,6 +97,10 @@ public:
 
     const char* name() { return _name; };
 
+    bool ready() { return _ready; }
+    void set_ready() { _ready = true; }
+
+    virtual void init_settings() {}
     virtual void init() {}
     virtual void deinit() {}
     virtual void poll() {}
@@ -90,6 +109,7 @@ public:
     virtual void build_info(Channel& out) {}
     virtual void wifi_stats(JSONencoder& j) {}
     virtual bool is_radio() { return false; }
+    virtual bool deferred_init() { return false; }
 };
 
 class ConfigurableModule : public Configuration::Configurable {
@@ -102,6 +122,7 @@ public:
     const char*  name() { return _name; };
     virtual void init() {}
     virtual void deinit() {}
+    virtual void poll() {}
 };
 
 using ModuleFactory = Configuration::GenericFactory<Module>;
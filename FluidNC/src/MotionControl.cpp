@@ -14,8 +14,16 @@
 #include "Platform.h"        // WEAK_LINK
 #include "Settings.h"        // coords
 #include "State.h"           // State
+#include "HeightMap.h"       // HeightMap::active
+#include "Simulation.h"      // Simulation::active
+#include "PlannerStats.h"    // PlannerStats::blocked
+#include "ArcChords.h"       // ArcChords, arc_fit()
+#include "StepperPrivate.h"  // DT_SEGMENT
+#include "Driver/delay_usecs.h"  // getCpuTicks()
 
 #include <cmath>
+#include <cstring>    // memset
+#include <algorithm>  // std::sort, std::min
 
 // M_PI is not defined in standard C/C++ but some compilers
 // support it anyway.  The following suppresses Intellisense
@@ -51,7 +59,8 @@ bool mc_move_motors(float* target, plan_line_data_t* pl_data) {
     mc_pl_data_inflight = pl_data;
 
     // If in check gcode mode, prevent motion by blocking planner. Soft limits still work.
-    if (state_is(State::CheckMode)) {
+    // A simulation plans the motion and times it instead of running it.
+    if (state_is(State::CheckMode) && !Simulation::active()) {
         mc_pl_data_inflight = NULL;
         return submitted_result;  // Bail, if system abort.
     }
@@ -70,17 +79,29 @@ bool mc_move_motors(float* target, plan_line_data_t* pl_data) {
     // parser and planner are separate from the system machine positions, this is doable.
     // If the buffer is full: good! That means we are well ahead of the robot.
     // Remain in this loop until there is room in the buffer.
+    // A G64 corner adds up to BLEND_MAX_SEGMENTS chords ahead of the line, so wait for room for those too.
+    plan_index_t needed = 1;
+    if (pl_data->blend_tolerance > 0.0f) {
+        needed = MIN(BLEND_MAX_SEGMENTS + 1, int(config->_planner_blocks) - 1);
+    }
+    if (Simulation::active()) {
+        Simulation::make_room(needed);
+    }
 
-    while (plan_check_full_buffer()) {
-        protocol_auto_cycle_start();  // Auto-cycle start when buffer is full.
+    if (plan_get_block_buffer_available() < needed) {
+        uint32_t wait_start = getCpuTicks();
+        while (plan_get_block_buffer_available() < needed) {
+            protocol_auto_cycle_start();  // Auto-cycle start when buffer is full.
 
-        // While we are waiting for room in the buffer, look for realtime
-        // commands and other situations that could cause state changes.
-        protocol_execute_realtime();
-        if (sys.abort) {
-            mc_pl_data_inflight = NULL;
-            return submitted_result;  // Bail, if system abort.
+            // While we are waiting for room in the buffer, look for realtime
+            // commands and other situations that could cause state changes.
+            protocol_execute_realtime();
+            if (sys.abort) {
+                mc_pl_data_inflight = NULL;
+                return submitted_result;  // Bail, if system abort.
+            }
         }
+        PlannerStats::blocked(getCpuTicks() - wait_start);
     }
 
     // Plan and queue motion into planner buffer
@@ -92,6 +113,79 @@ bool mc_move_motors(float* target, plan_line_data_t* pl_data) {
     return submitted_result;
 }
 
+// Queue an arc in machine coordinates as a single planner block. Waits for room in the
+// planner like mc_move_motors(). Returns true if the arc was submitted to the planner.
+static bool mc_move_arc(float*            target,
+                        plan_line_data_t* pl_data,
+                        float*            center,
+                        float             radius,
+                        float             start_angle,
+                        float             angular_travel,
+                        size_t            axis_0,
+                        size_t            axis_1) {
+    if (state_is(State::CheckMode) && !Simulation::active()) {
+        return false;
+    }
+    if (Simulation::active()) {
+        Simulation::make_room(1);
+    }
+    if (plan_check_full_buffer()) {
+        uint32_t wait_start = getCpuTicks();
+        while (plan_check_full_buffer()) {
+            protocol_auto_cycle_start();  // Auto-cycle start when buffer is full.
+            protocol_execute_realtime();
+            if (sys.abort) {
+                return false;
+            }
+        }
+        PlannerStats::blocked(getCpuTicks() - wait_start);
+    }
+    return plan_buffer_arc(target, pl_data, center, radius, start_angle, angular_travel, axis_0, axis_1);
+}
+
+bool mc_kinematic_line(plan_line_data_t* pl_data) {
+    if (pl_data->motion.systemMotion) {
+        return false;
+    }
+    auto n_axis = Axes::_numberAxis;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        if (Axes::_axis[axis]->_backlash > 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Waits for room in the planner like mc_move_motors(), and can likewise be cancelled as a jog.
+bool mc_move_kinematic(float* target, float* position, float* motors, plan_line_data_t* pl_data) {
+    if (state_is(State::CheckMode) && !Simulation::active()) {
+        return false;
+    }
+    mc_pl_data_inflight = pl_data;
+    if (Simulation::active()) {
+        Simulation::make_room(1);
+    }
+    if (plan_check_full_buffer()) {
+        uint32_t wait_start = getCpuTicks();
+        while (plan_check_full_buffer()) {
+            protocol_auto_cycle_start();  // Auto-cycle start when buffer is full.
+            protocol_execute_realtime();
+            if (sys.abort) {
+                mc_pl_data_inflight = NULL;
+                return false;
+            }
+        }
+        PlannerStats::blocked(getCpuTicks() - wait_start);
+    }
+    bool submitted_result = false;
+    if (mc_pl_data_inflight == pl_data) {
+        plan_buffer_kinematic_line(target, position, motors, pl_data);
+        submitted_result = true;
+    }
+    mc_pl_data_inflight = NULL;
+    return submitted_result;
+}
+
 void mc_cancel_jog() {
     if (mc_pl_data_inflight != NULL && ((plan_line_data_t*)mc_pl_data_inflight)->is_jog) {
         mc_pl_data_inflight = NULL;
@@ -107,12 +201,42 @@ void mc_cancel_jog() {
 static bool mc_linear_no_check(float* target, plan_line_data_t* pl_data, float* position) {
     return config->_kinematics->cartesian_to_motors(target, pl_data, position);
 }
+
+// Follows the height map surface. The line is split where it crosses the grid lines, so that
+// long moves are split only as much as the map needs, and the surface offset is added to the Z
+// of every piece. A line in inverse time mode is not split, because its feed rate is the time of
+// the whole line; only its end is compensated.
+static bool mc_linear_compensated(float* target, plan_line_data_t* pl_data, float* position) {
+    auto  n_axis = Axes::_numberAxis;
+    float start[MAX_N_AXIS];
+    float end[MAX_N_AXIS];
+    copyAxes(start, position);
+    start[Z_AXIS] += HeightMap::offset(position[X_AXIS], position[Y_AXIS]);
+    float t = 0.0f;
+    do {
+        t = pl_data->motion.inverseTime ? 1.0f : HeightMap::next_crossing(position, target, t);
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            end[axis] = t < 1.0f ? position[axis] + t * (target[axis] - position[axis]) : target[axis];
+        }
+        end[Z_AXIS] += HeightMap::offset(end[X_AXIS], end[Y_AXIS]);
+        if (!mc_linear_no_check(end, pl_data, start)) {
+            return false;
+        }
+        copyAxes(start, end);
+    } while (t < 1.0f);
+    return true;
+}
+
 bool mc_linear(float* target, plan_line_data_t* pl_data, float* position) {
     if (!pl_data->is_jog && !pl_data->limits_checked) {  // soft limits for jogs have already been dealt with
         if (config->_kinematics->invalid_line(target)) {
             return false;
         }
     }
+    // A synchronized move must stay one block, since each block starts at a spindle index pulse
+    if (HeightMap::active() && !pl_data->is_jog && !pl_data->motion.systemMotion && !pl_data->spindle_sync) {
+        return mc_linear_compensated(target, pl_data, position);
+    }
     return mc_linear_no_check(target, pl_data, position);
 }
 
@@ -179,6 +303,27 @@ void mc_arc(float*            target,
     // For most uses, this value should not exceed 2000.
     uint16_t segments =
         uint16_t(floorf(fabsf(0.5 * angular_travel * radius) / sqrtf(config->_arcTolerance * (2 * radius - config->_arcTolerance))));
+
+    // With native arcs the whole arc is one planner block, and the segment generator computes
+    // points on the true arc instead of chords, so arc_tolerance does not apply.  The plane axes
+    // can reverse within a native arc, which backlash compensation cannot see, so an arc whose
+    // plane axes have backlash is split into lines.
+    bool backlash = Axes::_axis[axis_0]->_backlash > 0.0f || Axes::_axis[axis_1]->_backlash > 0.0f;
+    // Height map compensation is applied to lines, so a compensated arc is split into lines too.
+    if (segments && config->_native_arcs && config->_kinematics->native_arcs() && !backlash && !HeightMap::active()) {
+        mc_move_arc(target, pl_data, center, radius, atan2f(radii[1], radii[0]), angular_travel, axis_0, axis_1);
+        return;
+    }
+
+    // A chord that runs in less than one step segment at the feed rate only loads the planner
+    float arc_length = fabsf(angular_travel) * radius;
+    float min_chord  = pl_data->feed_rate * DT_SEGMENT;
+    if (pl_data->motion.inverseTime) {
+        min_chord *= arc_length;  // The feed rate is the inverse of the time for the whole arc
+    }
+    ArcFit fit = arc_fit(angular_travel, radius, config->_arcTolerance, min_chord, segments);
+    segments   = fit.segments;
+
     if (segments) {
         // Multiply inverse feed_rate to compensate for the fact that this movement is approximated
         // by a number of discrete segments. The inverse feed_rate should be correct for the sum of
@@ -218,46 +363,33 @@ void mc_arc(float*            target,
            a correction, the planner should have caught up to the lag caused by the initial mc_arc overhead.
            This is important when there are successive arc motions.
         */
-        // Computes: cos_T = 1 - theta_per_segment^2/2, sin_T = theta_per_segment - theta_per_segment^3/6) in ~52usec
-        float cos_T = 2.0f - theta_per_segment * theta_per_segment;
-        float sin_T = theta_per_segment * 0.16666667f * (cos_T + 4.0f);
-        cos_T *= 0.5;
-        float    sin_Ti;
-        float    cos_Ti;
-        uint16_t i;
-        size_t   count             = 0;
-        float    original_feedrate = pl_data->feed_rate;  // Kinematics may alter the feedrate, so save an original copy
-        for (i = 1; i < segments; i++) {                  // Increment (segments-1).
-            if (count < N_ARC_CORRECTION) {
-                // Apply vector rotation matrix. ~40 usec
-                float ri = radii[0] * sin_T + radii[1] * cos_T;
-                radii[0] = radii[0] * cos_T - radii[1] * sin_T;
-                radii[1] = ri;
-                count++;
-            } else {
-                // Arc correction to radius vector. Computed only every N_ARC_CORRECTION increments. ~375 usec
-                // Compute exact location by applying transformation matrix from initial radius vector(=-offset).
-                cos_Ti   = cosf(i * theta_per_segment);
-                sin_Ti   = sinf(i * theta_per_segment);
-                radii[0] = -offset[axis_0] * cos_Ti + offset[axis_1] * sin_Ti;
-                radii[1] = -offset[axis_0] * sin_Ti - offset[axis_1] * cos_Ti;
-                count    = 0;
-            }
-            // Update arc_target location
-            position[axis_0] = center[0] + radii[0];
-            position[axis_1] = center[1] + radii[1];
-            position[axis_linear] += linear_per_segment[axis_linear];
-            for (size_t i = A_AXIS; i < n_axis; i++) {
-                position[i] += linear_per_segment[i];
-            }
-            pl_data->feed_rate = original_feedrate;  // This restores the feedrate kinematics may have altered
-            mc_linear(position, pl_data, previous_position);
-            previous_position[axis_0]      = position[axis_0];
-            previous_position[axis_1]      = position[axis_1];
-            previous_position[axis_linear] = position[axis_linear];
-            // Bail mid-circle on system abort. Runtime command check already performed by mc_linear.
-            if (sys.abort) {
-                return;
+        // The chord end points are computed a batch at a time, see ArcChords.h
+        const int batch = 16;
+        float     batch_r0[batch];
+        float     batch_r1[batch];
+        float     scale = fit.radius / radius;  // The chord end points can be outside the arc, see arc_fit()
+        ArcChords chords(radii[0] * scale, radii[1] * scale, theta_per_segment, N_ARC_CORRECTION);
+        float     original_feedrate = pl_data->feed_rate;  // Kinematics may alter the feedrate, so save an original copy
+        for (uint16_t i = 1; i < segments;) {              // Increment (segments-1).
+            int n = std::min(batch, segments - i);
+            chords.next(n, batch_r0, batch_r1);
+            for (int k = 0; k < n; k++, i++) {
+                // Update arc_target location
+                position[axis_0] = center[0] + batch_r0[k];
+                position[axis_1] = center[1] + batch_r1[k];
+                position[axis_linear] += linear_per_segment[axis_linear];
+                for (size_t i = A_AXIS; i < n_axis; i++) {
+                    position[i] += linear_per_segment[i];
+                }
+                pl_data->feed_rate = original_feedrate;  // This restores the feedrate kinematics may have altered
+                mc_linear(position, pl_data, previous_position);
+                previous_position[axis_0]      = position[axis_0];
+                previous_position[axis_1]      = position[axis_1];
+                previous_position[axis_linear] = position[axis_linear];
+                // Bail mid-circle on system abort. Runtime command check already performed by mc_linear.
+                if (sys.abort) {
+                    return;
+                }
             }
         }
     }
@@ -265,13 +397,106 @@ void mc_arc(float*            target,
     mc_linear(target, pl_data, previous_position);
 }
 
+// Magnitude of the second derivative at u of a cubic Bezier in the XY plane. dd0 and dd1 are the
+// second differences P0-2*P1+P2 and P1-2*P2+P3 of its control points.
+static float spline_curvature(const float* dd0, const float* dd1, float u) {
+    return 6.0f * hypot_f((1.0f - u) * dd0[0] + u * dd1[0], (1.0f - u) * dd0[1] + u * dd1[1]);
+}
+
+// Returns the parameter value where the line from u should end. A chord spanning a parameter
+// interval h deviates from the curve by at most h^2/8 times the largest second derivative over
+// the interval, and since that derivative is linear in u its largest magnitude is at one end.
+static float spline_next_u(const float* dd0, const float* dd1, float u) {
+    float limit = 8.0f * config->_arcTolerance;
+    float d2    = spline_curvature(dd0, dd1, u);
+    float h     = d2 > 0.0f ? sqrtf(limit / d2) : 1.0f;
+    if (u + h < 1.0f) {
+        // Shrinking the interval can only lower the bound, so one correction is enough.
+        d2 = fmaxf(d2, spline_curvature(dd0, dd1, u + h));
+        h  = d2 > 0.0f ? sqrtf(limit / d2) : 1.0f;
+    }
+    return fminf(u + h, 1.0f);
+}
+
+static void spline_point(float* point, const float* p0, const float* p1, const float* p2, const float* p3, float u) {
+    float v = 1.0f - u;
+    for (size_t i = 0; i < 2; i++) {
+        point[X_AXIS + i] = v * v * v * p0[i] + 3.0f * v * v * u * p1[i] + 3.0f * v * u * u * p2[i] + u * u * u * p3[i];
+    }
+}
+
+void mc_spline(float* target, plan_line_data_t* pl_data, float* position, float* control_1, float* control_2) {
+    float p0[2] = { position[X_AXIS], position[Y_AXIS] };
+    float p3[2] = { target[X_AXIS], target[Y_AXIS] };
+    float dd0[2], dd1[2];
+    for (size_t i = 0; i < 2; i++) {
+        dd0[i] = p0[i] - 2.0f * control_1[i] + control_2[i];
+        dd1[i] = control_1[i] - 2.0f * control_2[i] + p3[i];
+    }
+
+    float previous_position[MAX_N_AXIS];
+    float point[MAX_N_AXIS];
+    copyAxes(previous_position, position);
+    copyAxes(point, position);
+
+    // The lines have different lengths, so an inverse time feed rate cannot be applied to each of
+    // them. Convert it to the equivalent rate over the length of the flattened curve.
+    if (pl_data->motion.inverseTime) {
+        float length  = 0.0f;
+        float last[2] = { p0[0], p0[1] };
+        for (float u = 0.0f; u < 1.0f;) {
+            u = spline_next_u(dd0, dd1, u);
+            spline_point(point, p0, control_1, control_2, p3, u);
+            length += hypot_f(point[X_AXIS] - last[0], point[Y_AXIS] - last[1]);
+            last[0] = point[X_AXIS];
+            last[1] = point[Y_AXIS];
+        }
+        pl_data->feed_rate *= length;
+        pl_data->motion.inverseTime = 0;  // Force as feed absolute mode over spline lines.
+    }
+
+    float original_feedrate = pl_data->feed_rate;  // Kinematics may alter the feedrate, so save an original copy
+    for (float u = spline_next_u(dd0, dd1, 0.0f); u < 1.0f; u = spline_next_u(dd0, dd1, u)) {
+        spline_point(point, p0, control_1, control_2, p3, u);
+        pl_data->feed_rate = original_feedrate;  // This restores the feedrate kinematics may have altered
+        mc_linear(point, pl_data, previous_position);
+        copyAxes(previous_position, point);
+        // Bail mid-spline on system abort. Runtime command check already performed by mc_linear.
+        if (sys.abort) {
+            return;
+        }
+    }
+    // Ensure last line arrives at target location.
+    pl_data->feed_rate = original_feedrate;
+    mc_linear(target, pl_data, previous_position);
+}
+
 // Execute dwell in seconds.
-bool mc_dwell(int32_t milliseconds) {
+// A dwell is queued in the planner, so the motion on either side of it stays planned ahead.
+// G4 P0 queues nothing; it waits for the motion before it to finish, as it always has.
+bool mc_dwell(int32_t milliseconds, plan_line_data_t* pl_data) {
     if (milliseconds < 0 || state_is(State::CheckMode)) {
+        if (milliseconds > 0 && Simulation::active()) {
+            Simulation::dwell(milliseconds / 1000.0f);
+        }
         return false;
     }
-    protocol_buffer_synchronize();
-    return dwell_ms(milliseconds, DwellMode::Dwell);
+    if (milliseconds == 0) {
+        protocol_buffer_synchronize();
+        return !sys.abort;
+    }
+    if (plan_check_full_buffer()) {
+        uint32_t wait_start = getCpuTicks();
+        while (plan_check_full_buffer()) {
+            protocol_auto_cycle_start();  // Auto-cycle start when buffer is full.
+            protocol_execute_realtime();
+            if (sys.abort) {
+                return false;
+            }
+        }
+        PlannerStats::blocked(getCpuTicks() - wait_start);
+    }
+    return plan_buffer_dwell(uint32_t(milliseconds), pl_data);
 }
 
 volatile bool probing;
@@ -280,21 +505,12 @@ bool probe_succeeded = false;
 
 // Perform tool length probe cycle. Requires probe switch.
 // NOTE: Upon probe failure, the program will be stopped and placed into ALARM state.
-GCUpdatePos mc_probe_cycle(float* target, plan_line_data_t* pl_data, bool away, bool no_error, uint8_t offsetAxis, float offset) {
-    if (!config->_probe->exists()) {
-        log_error("Probe pin is not configured");
-        return GCUpdatePos::None;
-    }
-    // TODO: Need to update this cycle so it obeys a non-auto cycle start.
-    if (state_is(State::CheckMode)) {
-        return config->_probe->_check_mode_start ? GCUpdatePos::None : GCUpdatePos::Target;
-    }
-    // Finish all queued commands and empty planner buffer before starting probe cycle.
-    protocol_buffer_synchronize();
-    if (sys.abort) {
-        return GCUpdatePos::None;  // Return if system reset has been issued.
-    }
+enum class ProbeTouch { Aborted, Contact, NoContact };
 
+// Moves from position toward target until the probe trips, and leaves the machine stopped
+// with the planner synced to where it stopped.  Contact, with the position of the trip in
+// probe_steps and probe_fraction, or NoContact if the motion ended without a trip.
+static ProbeTouch probe_touch(float* target, plan_line_data_t* pl_data, float* position, bool away) {
     Stepping::beginLowLatency();
 
     // Initialize probing control variables
@@ -306,11 +522,12 @@ GCUpdatePos mc_probe_cycle(float* target, plan_line_data_t* pl_data, bool away,
         send_alarm(ExecAlarm::ProbeFailInitial);
         protocol_execute_realtime();
         Stepping::endLowLatency();
-        return GCUpdatePos::None;  // Nothing else to do but bail.
+        return ProbeTouch::Aborted;  // Nothing else to do but bail.
     }
     // Setup and queue probing motion. Auto cycle-start should not start the cycle.
-    mc_linear(target, pl_data, gc_state.position);
+    mc_linear(target, pl_data, position);
     // Activate the probing state monitor in the stepper module.
+    config->_probe->arm_latch();
     probing = true;
     // Perform probing cycle. Wait here until probe is triggered or motion completes.
     protocol_send_event(&cycleStartEvent);
@@ -318,29 +535,154 @@ GCUpdatePos mc_probe_cycle(float* target, plan_line_data_t* pl_data, bool away,
         protocol_execute_realtime();
         if (sys.abort) {
             Stepping::endLowLatency();
-            return GCUpdatePos::None;  // Check for system abort
+            return ProbeTouch::Aborted;  // Check for system abort
         }
     } while (!state_is(State::Idle));
 
     Stepping::endLowLatency();
 
+    bool contact = !probing;
+    probing      = false;         // Ensure probe state monitor is disabled.
+    protocol_execute_realtime();  // Check and execute run-time commands
+    // Reset the stepper and planner buffers to remove the remainder of the probe motion.
+    Stepper::reset();      // Reset step segment buffer.
+    plan_reset();          // Reset planner buffer. Zero planner positions. Ensure probing motion is cleared.
+    plan_sync_position();  // Sync planner position to current machine position.
+    return contact ? ProbeTouch::Contact : ProbeTouch::NoContact;
+}
+
+// Touches again repeat_touches - 1 times after the first contact, backing off by
+// repeat_retract_mm before each one, and replaces the contact with the mean of the
+// touches.  Touches farther than repeat_tolerance_mm along the probing direction
+// from the median touch are left out of the mean.  Returns false if a touch failed,
+// in which case the alarm has been sent.
+static bool probe_repeat(float* target, plan_line_data_t* pl_data) {
+    Probe*    probe  = config->_probe;
+    auto      n_axis = Axes::_numberAxis;
+    const int n      = probe->_repeat_touches;
+
+    float contact[Probe::MAX_REPEAT_TOUCHES][MAX_N_AXIS];
+    float along[Probe::MAX_REPEAT_TOUCHES];  // Distance of each touch along the probing direction
+    float dir[MAX_N_AXIS];
+
+    probe_steps_to_mpos(contact[0]);
+    float travel = vector_distance(target, contact[0], n_axis);
+    if (travel == 0.0f) {
+        return true;  // The probe tripped at the target, so there is no direction to back off along
+    }
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        dir[axis] = (target[axis] - contact[0][axis]) / travel;
+    }
+
+    plan_line_data_t touch_data = *pl_data;
+    if (probe->_repeat_feed_rate > 0.0f) {
+        touch_data.feed_rate = probe->_repeat_feed_rate;
+    }
+    plan_line_data_t retract_data    = touch_data;
+    retract_data.motion.rapidMotion = 1;
+
+    for (int i = 1; i < n; i++) {
+        float retract[MAX_N_AXIS];
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            retract[axis] = contact[i - 1][axis] - dir[axis] * probe->_repeat_retract_mm;
+        }
+        mc_linear(retract, &retract_data, get_mpos());
+        protocol_buffer_synchronize();
+        if (sys.abort) {
+            return false;
+        }
+        if (probe_touch(target, &touch_data, get_mpos(), false) != ProbeTouch::Contact) {
+            if (!sys.abort) {
+                send_alarm(ExecAlarm::ProbeFailContact);
+            }
+            return false;
+        }
+        probe_steps_to_mpos(contact[i]);
+    }
+
+    float sorted[Probe::MAX_REPEAT_TOUCHES];
+    for (int i = 0; i < n; i++) {
+        along[i] = 0.0f;
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            along[i] += (contact[i][axis] - contact[0][axis]) * dir[axis];
+        }
+        sorted[i] = along[i];
+    }
+    std::sort(sorted, sorted + n);
+    float median = sorted[n / 2];
+
+    float mean[MAX_N_AXIS] = { 0 };
+    int   used             = 0;
+    for (int i = 0; i < n; i++) {
+        if (probe->_repeat_tolerance_mm > 0.0f && fabsf(along[i] - median) > probe->_repeat_tolerance_mm) {
+            continue;
+        }
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            mean[axis] += contact[i][axis];
+        }
+        ++used;
+    }
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        mean[axis] /= used;
+    }
+    log_info("Probe touches:" << used << " of " << n << " spread:" << (sorted[n - 1] - sorted[0]));
+
+    // Store the mean the way a latched contact is stored, in whole and fractional motor steps
+    float motors[MAX_N_AXIS];
+    config->_kinematics->transform_cartesian_to_motors(motors, mean);
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        float steps          = motors[axis] * Axes::_axis[axis]->_stepsPerMm;
+        probe_steps[axis]    = int32_t(floorf(steps));
+        probe_fraction[axis] = steps - probe_steps[axis];
+    }
+    return true;
+}
+
+GCUpdatePos mc_probe_cycle(float* target, plan_line_data_t* pl_data, bool away, bool no_error, uint8_t offsetAxis, float offset) {
+    if (!config->_probe->exists()) {
+        log_error("Probe pin is not configured");
+        return GCUpdatePos::None;
+    }
+    // TODO: Need to update this cycle so it obeys a non-auto cycle start.
+    if (state_is(State::CheckMode)) {
+        if (config->_probe->_check_mode_start) {
+            return GCUpdatePos::None;
+        }
+        if (Simulation::active()) {
+            mc_linear(target, pl_data, gc_state.position);  // Time the probe as a move that reaches the target
+        }
+        return GCUpdatePos::Target;
+    }
+    // Finish all queued commands and empty planner buffer before starting probe cycle.
+    protocol_buffer_synchronize();
+    if (sys.abort) {
+        return GCUpdatePos::None;  // Return if system reset has been issued.
+    }
+
+    ProbeTouch touch = probe_touch(target, pl_data, gc_state.position, away);
+    if (touch == ProbeTouch::Aborted) {
+        return GCUpdatePos::None;
+    }
+
     // Probing cycle complete!
     // Set state variables and error out, if the probe failed and cycle with error is enabled.
-    if (probing) {
+    if (touch == ProbeTouch::NoContact) {
         if (no_error) {
             get_motor_steps(probe_steps);
+            memset(probe_fraction, 0, sizeof(probe_fraction));
         } else {
             send_alarm(ExecAlarm::ProbeFailContact);
+            protocol_execute_realtime();
         }
+    } else if (!away && config->_probe->_repeat_touches > 1 && !probe_repeat(target, pl_data)) {
+        // Repeated touches only make sense toward the work; backing off from a G38.4 release
+        // point would push the probe into it.  A failed repeat leaves the machine short of the
+        // target, so the position comes from the machine.
+        probe_succeeded = false;
+        return sys.abort ? GCUpdatePos::None : GCUpdatePos::System;
     } else {
         probe_succeeded = true;  // Indicate to system the probing cycle completed successfully.
     }
-    probing = false;              // Ensure probe state monitor is disabled.
-    protocol_execute_realtime();  // Check and execute run-time commands
-    // Reset the stepper and planner buffers to remove the remainder of the probe motion.
-    Stepper::reset();      // Reset step segment buffer.
-    plan_reset();          // Reset planner buffer. Zero planner positions. Ensure probing motion is cleared.
-    plan_sync_position();  // Sync planner position to current machine position.
     if (MESSAGE_PROBE_COORDINATES) {
         // All done! Output the probe position as message.
         report_probe_parameters(allChannels);
@@ -353,7 +695,7 @@ GCUpdatePos mc_probe_cycle(float* target, plan_line_data_t* pl_data, bool away,
             float coord_data[MAX_N_AXIS];
             float probe_contact[MAX_N_AXIS];
 
-            motor_steps_to_mpos(probe_contact, probe_steps);
+            probe_steps_to_mpos(probe_contact);
             coords[gc_state.modal.coord_select]->get(coord_data);  // get a copy of the current coordinate offsets
             auto n_axis = Axes::_numberAxis;
             for (int axis = 0; axis < n_axis; axis++) {  // find the axis specified. There should only be one.
@@ -24,6 +24,15 @@ bool mc_linear(float* target, plan_line_data_t* pl_data, float* position);
 // Execute a linear motion in motor space.
 bool mc_move_motors(float* target, plan_line_data_t* pl_data);  // returns true if line was submitted to planner
 
+// True if a kinematic system may queue a cartesian line as a single block with
+// mc_move_kinematic() instead of splitting it. Not for system motions, nor with backlash
+// compensation, which cannot see a motor reverse within the line.
+bool mc_kinematic_line(plan_line_data_t* pl_data);
+
+// Execute a linear motion in cartesian space as a single planner block. The segment generator
+// computes the motor positions along it with the kinematics. motors is the motor position at target.
+bool mc_move_kinematic(float* target, float* position, float* motors, plan_line_data_t* pl_data);  // returns true if line was submitted to planner
+
 // Execute an arc in offset mode format. position == current xyz, target == target xyz,
 // offset == offset from current xyz, axis_XXX defines circle plane in tool space, axis_linear is
 // the direction of helical travel, radius == circle radius, is_clockwise_arc boolean. Used
@@ -39,8 +48,13 @@ void mc_arc(float*            target,
             bool              is_clockwise_arc,
             int               pword_rotations);
 
-// Dwell for a specific number of seconds
-bool mc_dwell(int32_t milliseconds);
+// Execute a cubic Bezier spline in the XY plane from position to target, with control points
+// control_1 and control_2 (absolute XY). The curve is flattened into lines that stay within
+// arc_tolerance of it, with shorter lines where it bends more sharply. Other axes do not move.
+void mc_spline(float* target, plan_line_data_t* pl_data, float* position, float* control_1, float* control_2);
+
+// Dwell for a specific number of milliseconds, with the spindle and coolant of pl_data
+bool mc_dwell(int32_t milliseconds, plan_line_data_t* pl_data);
 
 // Perform tool length probe cycle. Requires probe switch.
 GCUpdatePos mc_probe_cycle(float* target, plan_line_data_t* pl_data, bool away, bool no_error, uint8_t offsetAxis, float offset);
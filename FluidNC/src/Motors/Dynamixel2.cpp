@@ -125,11 +125,27 @@ namespace MotorDrivers {
         finish_write();
     }
 
-    // This is static; it updates the positions of all the Dynamixels on the UART bus
+    // This is static; it updates all the Dynamixels on the UART bus.  The servos
+    // with torque on get their goal positions in one Sync Write packet, and the
+    // positions of the ones with torque off, which can be moved by hand, are read
+    // back with one Sync Read packet, so the number of packets does not grow with
+    // the number of servos.
     void Dynamixel2::update_all() {
         if (_has_errors) {
             return;
         }
+        sync_read_positions();
+        sync_write_goals();
+    }
+
+    void Dynamixel2::sync_write_goals() {
+        bool any = false;
+        for (const auto& instance : _instances) {
+            any = any || !instance->_disabled;
+        }
+        if (!any) {
+            return;
+        }
 
         start_message(DXL_BROADCAST_ID, DXL_SYNC_WRITE);
         add_uint16(DXL_GOAL_POSITION);
@@ -140,6 +156,9 @@ namespace MotorDrivers {
         config->_kinematics->transform_cartesian_to_motors(motors, mpos);
 
         for (const auto& instance : _instances) {
+            if (instance->_disabled) {
+                continue;
+            }
             float    dxl_count_min, dxl_count_max;
             uint32_t dxl_position;
 
@@ -156,6 +175,45 @@ namespace MotorDrivers {
         }
         finish_message();
     }
+
+    void Dynamixel2::sync_read_positions() {
+        bool any = false;
+        for (const auto& instance : _instances) {
+            any = any || instance->_disabled;
+        }
+        if (!any) {
+            return;
+        }
+
+        start_message(DXL_BROADCAST_ID, DXL_SYNC_READ);
+        add_uint16(DXL_PRESENT_POSITION);
+        add_uint16(4);  // data length
+        for (const auto& instance : _instances) {
+            if (instance->_disabled) {
+                add_uint8(instance->_id);
+            }
+        }
+        finish_message();
+
+        // The servos reply one after another in the order of the IDs in the request
+        bool changed = false;
+        for (const auto& instance : _instances) {
+            if (!instance->_disabled) {
+                continue;
+            }
+            if (dxl_get_response(READ4_RSP_LEN) != READ4_RSP_LEN) {
+                break;  // Later servos wait for this one, so they will not reply either
+            }
+            if (_rx_message[DXL_MSG_ID] != instance->_id || _rx_message[DXL_MSG_START]) {
+                continue;
+            }
+            instance->set_position(_rx_message[9] | (_rx_message[10] << 8) | (_rx_message[11] << 16) | (_rx_message[12] << 24));
+            changed = true;
+        }
+        if (changed) {
+            plan_sync_position();
+        }
+    }
     void Dynamixel2::update() {
         update_all();
     }
@@ -206,7 +264,7 @@ namespace MotorDrivers {
         uint16_t msg_len = _msg_index - DXL_MSG_INSTR + 2;
 
         _tx_message[DXL_MSG_LEN_L] = msg_len & 0xff;
-        _tx_message[DXL_MSG_LEN_H] = (msg_len >> 8) * 0xff;
+        _tx_message[DXL_MSG_LEN_H] = (msg_len >> 8) & 0xff;
 
         uint16_t crc = 0;
         crc          = dxl_update_crc(crc, _tx_message, _msg_index);
@@ -225,31 +283,14 @@ namespace MotorDrivers {
         finish_write();
     }
 
-    uint32_t Dynamixel2::dxl_read_position() {
-        uint16_t data_len = 4;
-
-        dxl_read(DXL_PRESENT_POSITION, data_len);
+    // Sets the axis position from a position that the servo reported
+    void Dynamixel2::set_position(uint32_t dxl_position) {
+        uint32_t pos_min_steps = mpos_to_steps(limitsMinPosition(_axis_index), _axis_index);
+        uint32_t pos_max_steps = mpos_to_steps(limitsMaxPosition(_axis_index), _axis_index);
 
-        data_len = dxl_get_response(15);
+        uint32_t temp = myMap(dxl_position, _countMin, _countMax, pos_min_steps, pos_max_steps);
 
-        if (data_len == 15) {
-            uint32_t dxl_position = _rx_message[9] | (_rx_message[10] << 8) | (_rx_message[11] << 16) | (_rx_message[12] << 24);
-
-            auto axis = Axes::_axis[_axis_index];
-
-            uint32_t pos_min_steps = mpos_to_steps(limitsMinPosition(_axis_index), _axis_index);
-            uint32_t pos_max_steps = mpos_to_steps(limitsMaxPosition(_axis_index), _axis_index);
-
-            uint32_t temp = myMap(dxl_position, _countMin, _countMax, pos_min_steps, pos_max_steps);
-
-            set_motor_steps(_axis_index, temp);
-
-            plan_sync_position();
-
-            return dxl_position;
-        } else {
-            return 0;
-        }
+        set_motor_steps(_axis_index, temp);
     }
 
     void Dynamixel2::dxl_read(uint16_t address, uint16_t data_len) {
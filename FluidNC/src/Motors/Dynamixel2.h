@@ -39,15 +39,18 @@ namespace MotorDrivers {
         void finish_write();
         void show_status();
 
-        bool     test();
-        uint32_t dxl_read_position();
-        void     dxl_read(uint16_t address, uint16_t data_len);
+        bool test();
+        void dxl_read(uint16_t address, uint16_t data_len);
+        void set_position(uint32_t dxl_position);
+
+        static void sync_read_positions();
+        static void sync_write_goals();
 
         void dxl_goal_position(int32_t position);  // set one motor
         void set_operating_mode(uint8_t mode);
         void LED_on(bool on);
 
-        size_t dxl_get_response(uint16_t length);
+        static size_t dxl_get_response(uint16_t length);
 
         static uint16_t dxl_update_crc(uint16_t crc_accum, uint8_t* data_blk_ptr, uint8_t data_blk_size);
 
@@ -84,7 +87,9 @@ namespace MotorDrivers {
         static const int  PING_RSP_LEN   = 14;
         static const char DXL_READ       = char(0x02);
         static const char DXL_WRITE      = char(0x03);
+        static const char DXL_SYNC_READ  = char(0x82);
         static const char DXL_SYNC_WRITE = char(0x83);
+        static const int  READ4_RSP_LEN  = 15;  // Status packet with 4 data bytes
 
         // protocol 2 register locations
         static const int DXL_OPERATING_MODE   = 11;
@@ -13,6 +13,10 @@
 
     Homing simply sets the axis Mpos to the endpoint as determined by homing/mpos
 
+    The pulse is updated whenever the step ISR starts a new segment, so the
+    servo follows the motion, and every timer_ms when there is no motion.
+    Digital servos accept pwm_hz up to 333.
+
 */
 
 #include "RcServo.h"
@@ -43,7 +47,7 @@ namespace MotorDrivers {
 
         _disabled = true;
 
-        schedule_update(this, _timer_ms);
+        schedule_sync_update(this, _timer_ms);
     }
 
     void RcServo::config_message() {
@@ -17,10 +17,16 @@
 
 #include "Servo.h"
 #include "../Machine/MachineConfig.h"
+#include "../Config.h"
 
+#include <algorithm>
 #include <atomic>
 
 namespace MotorDrivers {
+    std::vector<Servo*> Servo::_sync_servos;
+    TaskHandle_t        Servo::_sync_task     = nullptr;
+    TickType_t          Servo::_sync_interval = portMAX_DELAY;
+
     void Servo::update_servo(TimerHandle_t timer) {
         Servo* servo = static_cast<Servo*>(pvTimerGetTimerID(timer));
         servo->update();
@@ -41,4 +47,27 @@ namespace MotorDrivers {
         }
         log_info("    Update timer for " << object->name() << " at " << interval << " ms");
     }
+
+    void Servo::sync_task(void*) {
+        while (true) {
+            ulTaskNotifyTake(pdTRUE, _sync_interval);
+            for (Servo* servo : _sync_servos) {
+                servo->update();
+            }
+        }
+    }
+
+    void Servo::schedule_sync_update(Servo* object, int interval) {
+        // The fastest of the servos sets the update interval while there are no segments
+        _sync_interval = std::min(_sync_interval, TickType_t(interval / portTICK_PERIOD_MS));
+        if (_sync_servos.empty()) {
+            _sync_servos.reserve(MAX_N_AXIS * Machine::Axis::MAX_MOTORS_PER_AXIS);  // The task must not see it move
+        }
+        _sync_servos.push_back(object);
+        if (!_sync_task && !Machine::Tasks::get()._servo.create(sync_task, nullptr, &_sync_task)) {
+            log_error("Failed to create task for " << object->name());
+            return;
+        }
+        log_info("    Segment updates for " << object->name() << ", else every " << interval << " ms");
+    }
 }
@@ -4,6 +4,9 @@
 #pragma once
 #include <freertos/FreeRTOS.h>
 #include <freertos/timers.h>  // TimerHandle_t
+#include <freertos/task.h>    // TaskHandle_t
+#include <esp_attr.h>         // IRAM_ATTR
+#include <vector>
 
 /*
     This is a base class for servo-type motors - ones that autonomously
@@ -21,8 +24,30 @@ namespace MotorDrivers {
         virtual void update() = 0;  // This must be implemented by derived classes
         void         group(Configuration::HandlerBase& handler) override {}
 
+        // Called by the step ISR when it starts a segment
+        static void IRAM_ATTR segment_boundary() {
+            if (_sync_task) {
+                BaseType_t higherPriorityTaskWoken = pdFALSE;
+                vTaskNotifyGiveFromISR(_sync_task, &higherPriorityTaskWoken);
+                if (higherPriorityTaskWoken) {
+                    portYIELD_FROM_ISR();
+                }
+            }
+        }
+
     protected:
         static void update_servo(TimerHandle_t timer);
         static void schedule_update(Servo* object, int interval);
+
+        // Updates object at every segment boundary, so that it follows the motion
+        // with the latency of one segment, and every interval ms otherwise
+        static void schedule_sync_update(Servo* object, int interval);
+
+    private:
+        static void sync_task(void*);
+
+        static std::vector<Servo*> _sync_servos;
+        static TaskHandle_t        _sync_task;
+        static TickType_t          _sync_interval;
     };
 }
@@ -27,8 +27,10 @@ namespace MotorDrivers {
     }
 
     void TMC2130Driver::config_motor() {
+        chain_config_begin();
         tmc2130->begin();
         TrinamicBase::config_motor();
+        chain_config_end();
     }
 
     bool TMC2130Driver::test() {
@@ -86,21 +88,24 @@ namespace MotorDrivers {
         }
     }
 
+    void TMC2130Driver::set_run_current(float amps) {
+        tmc2130->rms_current(uint16_t(amps * 1000.0), TrinamicSpiDriver::holdPercent(amps));
+    }
+
     // Report diagnostic and tuning info
     void TMC2130Driver::debug_message() {
         if (_has_errors) {
             return;
         }
 
-        uint32_t tstep = tmc2130->TSTEP();
-
-        if (tstep == 0xFFFFF || tstep < 1) {  // if axis is not moving return
+        // poll_status() read DRV_STATUS, which also says whether the motor is moving
+        if (_drv_status & DRV_STATUS_STST) {
             return;
         }
         float feedrate = Stepper::get_realtime_rate();  //* settings.microsteps[axis_index] / 60.0 ; // convert mm/min to Hz
 
-        log_info(axisName() << " Stallguard " << tmc2130->stallguard() << "   SG_Val:" << tmc2130->sg_result() << " Rate:" << feedrate
-                            << " mm/min SG_Setting:" << constrain(_stallguard, -64, 63));
+        log_info(axisName() << " Stallguard " << bool(_drv_status & DRV_STATUS_STALLGUARD) << "   SG_Val:" << (_drv_status & DRV_STATUS_SG_RESULT)
+                            << " Rate:" << feedrate << " mm/min SG_Setting:" << constrain(_stallguard, -64, 63));
     }
 
     void TMC2130Driver::set_disable(bool disable) {
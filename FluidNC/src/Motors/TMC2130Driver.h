@@ -27,7 +27,10 @@ namespace MotorDrivers {
     private:
         TMC2130Stepper* tmc2130 = nullptr;
 
+        TMC2130Stepper* spi_stepper() override { return tmc2130; }
+
         bool test();
         void set_registers(bool isHoming) override;
+        void set_run_current(float amps) override;
     };
 }
@@ -44,6 +44,7 @@ namespace MotorDrivers {
         // and hold current as (float) fraction of run current.
         uint16_t run_i = (uint16_t)(_run_current * 1000.0);
 
+        std::lock_guard<std::mutex> lock(_bus_mutex);
         _cs_pin.synchronousWrite(true);
 
         tmc2208->I_scale_analog(false);  // do not scale via pot
@@ -60,9 +61,16 @@ namespace MotorDrivers {
         _cs_pin.synchronousWrite(false);
     }
 
+    void TMC2208Driver::set_run_current(float amps) {
+        _cs_pin.synchronousWrite(true);
+        tmc2208->rms_current(uint16_t(amps * 1000.0), TrinamicBase::holdPercent(amps));
+        _cs_pin.synchronousWrite(false);
+    }
+
     void TMC2208Driver::debug_message() {}
 
     void TMC2208Driver::set_disable(bool disable) {
+        std::lock_guard<std::mutex> lock(_bus_mutex);
         _cs_pin.synchronousWrite(true);
         if (TrinamicUartDriver::startDisable(disable)) {
             if (_use_enable) {
@@ -38,5 +38,6 @@ namespace MotorDrivers {
 
         bool test();
         void set_registers(bool isHoming);
+        void set_run_current(float amps) override;
     };
 }
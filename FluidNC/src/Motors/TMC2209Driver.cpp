@@ -46,6 +46,7 @@ namespace MotorDrivers {
         float    _mode_current = isHoming ? _homing_current : _run_current;
         uint16_t run_i         = (uint16_t)(_mode_current * 1000.0);
 
+        std::lock_guard<std::mutex> lock(_bus_mutex);
         _cs_pin.synchronousWrite(true);
 
         tmc2209->I_scale_analog(false);  // do not scale via pot
@@ -90,29 +91,51 @@ namespace MotorDrivers {
         _cs_pin.synchronousWrite(false);
     }
 
+    void TMC2209Driver::set_run_current(float amps) {
+        _cs_pin.synchronousWrite(true);
+        tmc2209->rms_current(uint16_t(amps * 1000.0), TrinamicBase::holdPercent(amps));
+        _cs_pin.synchronousWrite(false);
+    }
+
     void TMC2209Driver::debug_message() {
         if (_has_errors) {
             return;
         }
 
-        _cs_pin.synchronousWrite(true);
-
-        uint32_t tstep = tmc2209->TSTEP();
-
-        if (tstep == 0xFFFFF || tstep < 1) {  // if axis is not moving return
-            _cs_pin.synchronousWrite(false);
+        // The stepper rate says whether the machine is moving, so poll_status()
+        // reads TSTEP only for the load stream
+        float feedrate = Stepper::get_realtime_rate();  //* settings.microsteps[axis_index] / 60.0 ; // convert mm/min to Hz
+        if (feedrate == 0) {
             return;
         }
-        float feedrate = Stepper::get_realtime_rate();  //* settings.microsteps[axis_index] / 60.0 ; // convert mm/min to Hz
+        uint16_t sg = _sg_result;
 
-        if (tmc2209) {
-            log_info(axisName() << " SG_Val: " << tmc2209->SG_RESULT() << "   Rate: " << feedrate << " mm/min SG_Setting:" << _stallguard);
+        // Only changes are reported
+        if (sg == _last_sg && feedrate == _last_sg_rate) {
+            return;
         }
+        _last_sg      = sg;
+        _last_sg_rate = feedrate;
+        log_info(axisName() << " SG_Val: " << sg << "   Rate: " << feedrate << " mm/min SG_Setting:" << _stallguard);
+    }
 
+    // SG_RESULT is one UART round trip; the stream adds DRV_STATUS for CS_ACTUAL and TSTEP
+    bool TMC2209Driver::poll_status(uint32_t pass, bool full) {
+        if (_has_errors || !tmc2209) {
+            return false;
+        }
+        _cs_pin.synchronousWrite(true);
+        _sg_result = tmc2209->SG_RESULT();
+        if (full) {
+            _cs_actual = (tmc2209->DRV_STATUS() >> 16) & 0x1f;
+            _tstep     = tmc2209->TSTEP();
+        }
         _cs_pin.synchronousWrite(false);
+        return true;
     }
 
     void TMC2209Driver::set_disable(bool disable) {
+        std::lock_guard<std::mutex> lock(_bus_mutex);
         if (TrinamicUartDriver::startDisable(disable)) {
             if (_use_enable) {
                 _cs_pin.synchronousWrite(true);
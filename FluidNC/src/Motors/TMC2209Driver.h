@@ -22,6 +22,7 @@ namespace MotorDrivers {
         void set_disable(bool disable);
         void config_motor() override;
         void debug_message() override;
+        bool poll_status(uint32_t pass, bool full) override;
         void validate() override { StandardStepper::validate(); }
 
         void group(Configuration::HandlerBase& handler) override {
@@ -46,7 +47,11 @@ namespace MotorDrivers {
     private:
         TMC2209Stepper* tmc2209 = nullptr;
 
+        uint16_t _last_sg      = 0xffff;  // The last reported stallguard value and rate
+        float    _last_sg_rate = 0;
+
         bool test();
         void set_registers(bool isHoming);
+        void set_run_current(float amps) override;
     };
 }
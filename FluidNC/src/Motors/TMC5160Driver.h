@@ -31,10 +31,13 @@ namespace MotorDrivers {
     private:
         TMC5160Stepper* tmc5160 = nullptr;
 
+        TMC2130Stepper* spi_stepper() override { return tmc5160; }
+
         uint8_t _tpfd = 4;
 
         bool test();
         void set_registers(bool isHoming);
+        void set_run_current(float amps) override;
         void trinamic_test_response();
         void trinamic_stepper_enable(bool enable);
     };
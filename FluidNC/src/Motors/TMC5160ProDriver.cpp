@@ -24,8 +24,10 @@ namespace MotorDrivers {
     }
 
     void TMC5160ProDriver::config_motor() {
+        chain_config_begin();
         tmc5160->begin();
         TrinamicBase::config_motor();
+        chain_config_end();
     }
 
     bool TMC5160ProDriver::test() {
@@ -52,15 +54,14 @@ namespace MotorDrivers {
             return;
         }
 
-        uint32_t tstep = tmc5160->TSTEP();
-
-        if (tstep == 0xFFFFF || tstep < 1) {  // if axis is not moving return
+        // poll_status() read DRV_STATUS, which also says whether the motor is moving
+        if (_drv_status & DRV_STATUS_STST) {
             return;
         }
         float feedrate = Stepper::get_realtime_rate();  //* settings.microsteps[axis_index] / 60.0 ; // convert mm/min to Hz
 
-        log_info(axisName() << " Stallguard " << tmc5160->stallguard() << "   SG_Val:" << tmc5160->sg_result() << " Rate:" << feedrate
-                            << " mm/min SG_Setting:" << constrain(_stallguard, -64, 63));
+        log_info(axisName() << " Stallguard " << bool(_drv_status & DRV_STATUS_STALLGUARD) << "   SG_Val:" << (_drv_status & DRV_STATUS_SG_RESULT)
+                            << " Rate:" << feedrate << " mm/min SG_Setting:" << constrain(_stallguard, -64, 63));
     }
 
     void TMC5160ProDriver::set_disable(bool disable) {
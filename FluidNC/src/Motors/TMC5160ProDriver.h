@@ -55,6 +55,8 @@ namespace MotorDrivers {
     private:
         TMC5160Stepper* tmc5160 = nullptr;
 
+        TMC2130Stepper* spi_stepper() override { return tmc5160; }
+
         uint32_t CHOPCONF   = 322994520;
         uint32_t COOLCONF   = 0;
         uint32_t THIGH      = 0;
@@ -3,8 +3,13 @@
 
 #include "TrinamicBase.h"
 #include "../Machine/MachineConfig.h"
+#include "../Config.h"
+#include "../Protocol.h"  // stallEvent
+#include "Driver/tmc_spi.h"  // tmc_spi_begin_batch()
 
+#include <algorithm>
 #include <atomic>
+#include <string>
 
 namespace MotorDrivers {
     const EnumItem trinamicModes[] = { { TrinamicMode::StealthChop, "StealthChop" },
@@ -13,20 +18,155 @@ namespace MotorDrivers {
                                        EnumItem(TrinamicMode::StealthChop) };
 
     std::vector<TrinamicBase*> TrinamicBase::_instances;  // static list of all drivers for stallguard reporting
+    TaskHandle_t               TrinamicBase::_diag_task    = nullptr;
+    TaskHandle_t               TrinamicBase::_current_task = nullptr;
+    std::mutex                 TrinamicBase::_bus_mutex;
 
-    // Another approach would be to register a separate timer for each instance.
-    // I think that timers are cheap so having only a single timer might not buy us much
-    void TrinamicBase::read_sg(TimerHandle_t timer) {
-        if (inMotionState()) {
+    Channel* volatile TrinamicBase::_stream_out       = nullptr;
+    uint32_t          TrinamicBase::_stream_ms        = 0;
+    uint32_t          TrinamicBase::_stream_threshold = 0;
+
+    // The register reads block for a UART round trip each, so they run in a
+    // low-priority task on the support core instead of a timer callback, which
+    // would hold up the timer service task.  Each pass takes the bus once and
+    // reads all of the drivers back to back.
+    void TrinamicBase::diag_task(void*) {
+        TickType_t last = xTaskGetTickCount();
+        uint32_t   pass = 0;
+        while (true) {
+            Channel* out = _stream_out;
+            vTaskDelayUntil(&last, (out ? _stream_ms : DIAG_PERIOD_MS) / portTICK_PERIOD_MS);
+            if (!inMotionState()) {
+                continue;
+            }
+            ++pass;
+
+            std::string line;
+            {
+                std::lock_guard<std::mutex> lock(_bus_mutex);
+                for (TrinamicBase* t : _instances) {
+                    if (!(out || t->_stallguardDebugMode) || !t->poll_status(pass, out)) {
+                        continue;
+                    }
+                    if (t->_stallguardDebugMode) {
+                        t->debug_message();
+                    }
+                    if (out) {
+                        line += line.empty() ? "[SG:" : "|";
+                        line += Axes::axisName(t->axis_index());
+                        if (t->dual_axis_index()) {
+                            line += '2';
+                        }
+                        line += ':' + std::to_string(t->_sg_result) + ',' + std::to_string(t->_cs_actual) + ',' + std::to_string(t->_tstep);
+
+                        // SG_RESULT is only meaningful while the motor turns
+                        if (_stream_threshold && t->_tstep < 0xFFFFF && t->_sg_result <= _stream_threshold) {
+                            log_info("Stall detected on " << Axes::axisName(t->axis_index()) << (t->dual_axis_index() ? "2" : ""));
+                            protocol_send_event(&stallEvent, t);
+                        }
+                    }
+                }
+            }
+            if (out && !line.empty()) {
+                line += ']';
+                log_stream(*out, line);
+            }
+        }
+    }
+
+    bool TrinamicBase::start_diag_task() {
+        if (_diag_task) {
+            return true;
+        }
+        // Task failure is not fatal because you can still use the system
+        if (!Machine::Tasks::get()._trinamicDiag.create(diag_task, nullptr, &_diag_task)) {
+            log_error("Failed to create task for stallguard");
+            return false;
+        }
+        return true;
+    }
+
+    // Switches the run current of the drivers with current profiles as the
+    // step ISR moves between accelerating, cruising and stopped segments.  The
+    // ISR only publishes the phase; the register writes happen here, so they
+    // never hold up stepping.  Daisy-chained SPI drivers get their writes in
+    // one whole-chain transfer.  Homing sets its own current, so the profiles
+    // are left alone until it is done.
+    void TrinamicBase::current_task(void*) {
+        TickType_t last  = xTaskGetTickCount();
+        int        phase = -1;  // Unknown, so that the first pass writes the currents
+        while (true) {
+            vTaskDelayUntil(&last, CURRENT_PERIOD_MS / portTICK_PERIOD_MS);
+            if (state_is(State::Homing)) {
+                phase = -1;
+                continue;
+            }
+            auto now = Stepper::motion_phase();
+            if (int(now) == phase) {
+                continue;
+            }
+            phase = int(now);
+
+            std::lock_guard<std::mutex> lock(_bus_mutex);
+            tmc_spi_begin_batch();
             for (TrinamicBase* t : _instances) {
-                if (t->_stallguardDebugMode) {
-                    //log_info("SG:" << t->_stallguardDebugMode);
-                    t->debug_message();
+                if (t->_has_errors || !(t->_accel_current || t->_cruise_current)) {
+                    continue;
+                }
+                float amps = t->phase_current(now);
+                if (amps != t->_applied_current) {
+                    t->set_run_current(amps);
+                    t->_applied_current = amps;
                 }
             }
+            tmc_spi_end_batch();
         }
     }
 
+    bool TrinamicBase::start_current_task() {
+        if (_current_task) {
+            return true;
+        }
+        // Without the task, the drivers simply stay at run_amps
+        if (!Machine::Tasks::get()._trinamicCurrent.create(current_task, nullptr, &_current_task)) {
+            log_error("Failed to create task for Trinamic current profiles");
+            return false;
+        }
+        return true;
+    }
+
+    float TrinamicBase::phase_current(Stepper::MotionPhase phase) {
+        switch (phase) {
+            case Stepper::MotionPhase::Accel:
+            case Stepper::MotionPhase::Decel:
+                return _accel_current ? _accel_current : _run_current;
+            case Stepper::MotionPhase::Cruise:
+                return _cruise_current ? _cruise_current : _run_current;
+            default:
+                return _run_current;
+        }
+    }
+
+    bool TrinamicBase::stream(Channel& out, uint32_t interval_ms, uint32_t threshold) {
+        if (_instances.empty()) {
+            return false;
+        }
+        if (interval_ms == 0) {
+            _stream_out = nullptr;
+            return true;
+        }
+        _stream_ms        = std::max(interval_ms, MIN_STREAM_MS);
+        _stream_threshold = threshold;
+        _stream_out       = &out;
+        return start_diag_task();
+    }
+
+    bool TrinamicBase::streaming(uint32_t& interval_ms, uint32_t& threshold) {
+        interval_ms = _stream_ms;
+        threshold   = _stream_threshold;
+        return _stream_out != nullptr;
+    }
+
     // calculate a tstep from a rate
     // tstep = fclk / (time between 1/256 steps)
     // This is used to set the stallguard window from the homing speed.
@@ -78,15 +218,22 @@ namespace MotorDrivers {
 
     bool TrinamicBase::set_homing_mode(bool isHoming) {
         set_registers(isHoming);
+        _applied_current = isHoming ? 0.0 : _run_current;
         return true;
     }
 
     float TrinamicBase::holdPercent() {
-        if (_run_current == 0) {
+        return holdPercent(_run_current);
+    }
+
+    // The hold current is configured in Amps, so it is kept when a current
+    // profile changes the run current
+    float TrinamicBase::holdPercent(float run_current) {
+        if (run_current == 0) {
             return 0.0;
         }
 
-        float hold_percent = _hold_current / _run_current;
+        float hold_percent = _hold_current / run_current;
         if (hold_percent > 1.0) {
             hold_percent = 1.0;
         }
@@ -149,19 +296,22 @@ namespace MotorDrivers {
         }
 
         set_registers(false);
+        _applied_current = _run_current;
     }
     void TrinamicBase::registration() {
         // Display the stepper library version message once, before the first
         // TMC config message.
         if (_instances.empty()) {
             log_debug("TMCStepper Library Ver. " << to_hex(TMCSTEPPER_VERSION));
-            auto timer = xTimerCreate("Stallguard", 200, true, nullptr, read_sg);
-            // Timer failure is not fatal because you can still use the system
-            if (!timer) {
-                log_error("Failed to create timer for stallguard");
-            } else if (xTimerStart(timer, 0) == pdFAIL) {
-                log_error("Failed to start timer for stallguard");
-            }
+        }
+
+        // The task only exists when some driver reports stallguard values
+        // or a load stream is started
+        if (_stallguardDebugMode) {
+            start_diag_task();
+        }
+        if (_accel_current || _cruise_current) {
+            start_current_task();
         }
 
         _instances.push_back(this);
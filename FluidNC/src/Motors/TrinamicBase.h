@@ -5,8 +5,12 @@
 
 #include "StandardStepper.h"
 #include "../EnumItem.h"
+#include "../Stepper.h"  // Stepper::MotionPhase
 #include <TMCStepper.h>  // https://github.com/teemuatlut/TMCStepper
 #include <cstdint>
+#include <mutex>
+
+class Channel;
 
 namespace MotorDrivers {
 
@@ -20,11 +24,32 @@ namespace MotorDrivers {
 
     class TrinamicBase : public StandardStepper {
     private:
-        static void read_sg(TimerHandle_t);
+        static void diag_task(void*);
+        static bool start_diag_task();
 
         static std::vector<TrinamicBase*> _instances;
+        static TaskHandle_t               _diag_task;
+
+        static const uint32_t DIAG_PERIOD_MS = 200;
+
+        // Motion-phase current profiles, applied by current_task()
+        static void current_task(void*);
+        static bool start_current_task();
+
+        static TaskHandle_t _current_task;
+
+        static const uint32_t CURRENT_PERIOD_MS = 5;  // How often the motion phase is checked
+
+        // Load streaming, set by stream()
+        static Channel* volatile _stream_out;
+        static uint32_t          _stream_ms;
+        static uint32_t          _stream_threshold;
 
     protected:
+        // Serializes register traffic between the diagnostics task and the tasks that
+        // configure and enable the drivers, which would otherwise collide on a shared UART
+        static std::mutex _bus_mutex;
+
         uint32_t calc_tstep(int percent);
 
         bool         _disable_state_known = false;  // we need to always set the state least once.
@@ -42,6 +67,9 @@ namespace MotorDrivers {
         float _run_current         = 0.50;
         float _hold_current        = 0.50;
         float _homing_current      = 0.0;
+        float _accel_current       = 0.0;  // Accelerating and decelerating, 0 for _run_current
+        float _cruise_current      = 0.0;  // Cruising, 0 for _run_current
+        float _applied_current     = 0.0;  // Run current last written, 0 if unknown
         int   _microsteps          = 16;
         int   _stallguard          = 0;
         bool  _stallguardDebugMode = false;
@@ -53,12 +81,27 @@ namespace MotorDrivers {
         static constexpr double fclk = 12700000.0;  // Internal clock Approx (Hz) used to calculate TSTEP from homing rate
 
         float        holdPercent();
+        float        holdPercent(float run_current);
         bool         report_open_load(bool ola, bool olb);
         bool         report_short_to_ground(bool s2ga, bool s2gb);
         bool         report_over_temp(bool ot, bool otpw);
         bool         report_short_to_ps(bool vsa, bool vsb);
         bool         set_homing_mode(bool isHoming);
         virtual void set_registers(bool isHoming) {}
+
+        // Writes only the run current, keeping the hold current.  Called by the
+        // current task with the bus taken, so it must not take _bus_mutex.
+        virtual void set_run_current(float amps) {}
+        float        phase_current(Stepper::MotionPhase phase);
+
+        // Reads the registers that debug_message() reports into the fields below,
+        // and with full, also CS_ACTUAL and TSTEP.  Returns false if the driver
+        // cannot measure its load.
+        virtual bool poll_status(uint32_t pass, bool full) { return false; }
+
+        uint16_t _sg_result = 0;
+        uint8_t  _cs_actual = 0;
+        uint32_t _tstep     = 0xFFFFF;  // Standstill
         bool         reportTest(uint8_t result);
         void         reportCommsFailure(void);
         bool         checkVersion(uint8_t expected, uint8_t got);
@@ -73,12 +116,23 @@ namespace MotorDrivers {
     public:
         TrinamicBase(const char* name) : StandardStepper(name) {}
 
+        static const uint32_t MIN_STREAM_MS = 10;
+
+        // Sends a line with SG_RESULT, CS_ACTUAL and TSTEP of each driver to out
+        // every interval_ms while the machine moves.  A nonzero threshold raises
+        // a MotorStall alarm when a moving motor's SG_RESULT falls to it.  An
+        // interval of 0 stops the stream.  Returns false if there are no drivers.
+        static bool stream(Channel& out, uint32_t interval_ms, uint32_t threshold);
+        static bool streaming(uint32_t& interval_ms, uint32_t& threshold);
+
         void group(Configuration::HandlerBase& handler) override {
             StandardStepper::group(handler);
 
             handler.item("r_sense_ohms", _r_sense, 0.0, 1.00);
             handler.item("run_amps", _run_current, 0.05, 10.0);
             handler.item("hold_amps", _hold_current, 0.05, 10.0);
+            handler.item("accel_amps", _accel_current, 0.0, 10.0);
+            handler.item("cruise_amps", _cruise_current, 0.0, 10.0);
             handler.item("microsteps", _microsteps, 1, 256);
             handler.item("toff_disable", _toff_disable, 0, 15);
             handler.item("toff_stealthchop", _toff_stealthchop, 2, 15);
@@ -7,7 +7,9 @@
 
 #include "TrinamicSpiDriver.h"
 #include "../Machine/MachineConfig.h"
-#include <TMCStepper.h>  // https://github.com/teemuatlut/TMCStepper
+#include "Driver/tmc_spi.h"  // tmc_spi_begin_batch(), tmc_spi_read_chain()
+#include <TMCStepper.h>      // https://github.com/teemuatlut/TMCStepper
+#include <algorithm>
 #include <atomic>
 
 namespace MotorDrivers {
@@ -15,8 +17,69 @@ namespace MotorDrivers {
     pinnum_t TrinamicSpiDriver::daisy_chain_cs_id = 255;
     uint8_t  TrinamicSpiDriver::spi_index_mask    = 0;
 
+    std::vector<TrinamicSpiDriver*> TrinamicSpiDriver::_chain;
+    size_t                          TrinamicSpiDriver::_chain_configured = 0;
+    uint32_t                        TrinamicSpiDriver::_chain_pass       = 0;
+
     void TrinamicSpiDriver::init() {
         TrinamicBase::init();
+        if (_spi_index != -1) {
+            _chain.push_back(this);
+        }
+    }
+
+    void TrinamicSpiDriver::chain_config_begin() {
+        if (_spi_index != -1) {
+            tmc_spi_begin_batch();
+        }
+    }
+
+    void TrinamicSpiDriver::chain_config_end() {
+        if (_spi_index != -1 && ++_chain_configured == _chain.size()) {
+            tmc_spi_end_batch();
+        }
+    }
+
+    void TrinamicSpiDriver::set_status(uint32_t drv_status) {
+        _drv_status = drv_status;
+        _sg_result  = drv_status & DRV_STATUS_SG_RESULT;
+        _cs_actual  = (drv_status >> DRV_STATUS_CS_SHIFT) & 0x1f;
+    }
+
+    // A driver on a daisy chain reads the registers for the whole chain, unless
+    // another driver on it already did during this pass
+    bool TrinamicSpiDriver::poll_status(uint32_t pass, bool full) {
+        if (_has_errors) {
+            return false;
+        }
+        if (_spi_index == -1) {
+            set_status(spi_stepper()->DRV_STATUS());
+            if (full) {
+                _tstep = spi_stepper()->TSTEP();
+            }
+            return true;
+        }
+        if (_chain_pass == pass) {
+            return true;
+        }
+        _chain_pass = pass;
+
+        size_t length = 0;
+        for (auto d : _chain) {
+            length = std::max(length, size_t(d->_spi_index));
+        }
+        uint32_t values[length];
+        tmc_spi_read_chain(*spi_stepper(), DRV_STATUS_REG, values, length);
+        for (auto d : _chain) {
+            d->set_status(values[d->_spi_index - 1]);
+        }
+        if (full) {
+            tmc_spi_read_chain(*spi_stepper(), TSTEP_REG, values, length);
+            for (auto d : _chain) {
+                d->_tstep = values[d->_spi_index - 1];
+            }
+        }
+        return true;
     }
 
     uint8_t TrinamicSpiDriver::setupSPI() {
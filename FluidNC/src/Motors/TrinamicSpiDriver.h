@@ -8,6 +8,7 @@
 #include "../PinMapper.h"
 
 #include <cstdint>
+#include <vector>
 
 const int NORMAL_TCOOLTHRS = 0xFFFFF;  // 20 bit is max
 const int NORMAL_THIGH     = 0;
@@ -80,7 +81,25 @@ namespace MotorDrivers {
 
         static constexpr int _spi_freq = 100000;
 
+        // DRV_STATUS fields, the same on the TMC2130 and TMC5160
+        static const uint32_t TSTEP_REG             = 0x12;
+        static const uint32_t DRV_STATUS_REG        = 0x6F;
+        static const uint32_t DRV_STATUS_SG_RESULT  = 0x3FF;
+        static const int      DRV_STATUS_CS_SHIFT   = 16;  // CS_ACTUAL, 5 bits
+        static const uint32_t DRV_STATUS_STALLGUARD = 1 << 24;
+        static const uint32_t DRV_STATUS_STST       = 1u << 31;  // Standstill
+
+        uint32_t _drv_status = 0;  // From the last diagnostics pass
+
+        virtual TMC2130Stepper* spi_stepper() = 0;
+
         void config_message() override;
+        bool poll_status(uint32_t pass, bool full) override;
+
+        // Bracket config_motor() so that the configuration writes of a daisy chain
+        // are sent as whole-chain transfers once the last driver on it is configured
+        void chain_config_begin();
+        void chain_config_end();
 
         uint8_t setupSPI();
 
@@ -91,7 +110,13 @@ namespace MotorDrivers {
         static pinnum_t daisy_chain_cs_id;
         static uint8_t  spi_index_mask;
 
+        static std::vector<TrinamicSpiDriver*> _chain;  // The daisy-chained drivers
+        static size_t                          _chain_configured;
+        static uint32_t                        _chain_pass;  // Diagnostics pass that last read the chain
+
         PinMapper _cs_mapping;
+
+        void set_status(uint32_t drv_status);
     };
 
 }
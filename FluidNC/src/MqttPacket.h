@@ -0,0 +1,107 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  MqttPacket.h - the few MQTT 3.1.1 control packets that a telemetry publisher needs
+
+  The telemetry module only publishes, at QoS 0, so it needs CONNECT, PUBLISH,
+  PINGREQ and DISCONNECT, and it only has to recognize CONNACK.  Packets are
+  appended to a string, so several publishes can be collected and sent to the
+  broker in one TCP write.  It is header-only so that it can be tested on the host.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Mqtt {
+    const uint8_t CONNECT    = 0x10;
+    const uint8_t CONNACK    = 0x20;
+    const uint8_t PUBLISH    = 0x30;
+    const uint8_t PINGREQ    = 0xC0;
+    const uint8_t PINGRESP   = 0xD0;
+    const uint8_t DISCONNECT = 0xE0;
+
+    const uint8_t RETAIN = 0x01;
+
+    // The "remaining length" of the fixed header, 7 bits per byte, low bits first
+    inline void put_length(std::string& out, size_t length) {
+        do {
+            uint8_t byte = length & 0x7f;
+            length >>= 7;
+            if (length) {
+                byte |= 0x80;
+            }
+            out += char(byte);
+        } while (length);
+    }
+
+    inline void put_u16(std::string& out, uint16_t value) {
+        out += char(value >> 8);
+        out += char(value & 0xff);
+    }
+
+    inline void put_string(std::string& out, std::string_view s) {
+        put_u16(out, uint16_t(s.length()));
+        out.append(s.data(), s.length());
+    }
+
+    // A clean session, without a will.  An empty user name omits both the name and the password.
+    inline void connect(std::string& out, std::string_view client_id, uint16_t keepalive_s, std::string_view user, std::string_view password) {
+        std::string body;
+        put_string(body, "MQTT");
+        body += char(4);  // Protocol level 3.1.1
+
+        uint8_t flags = 0x02;  // Clean session
+        if (user.length()) {
+            flags |= 0x80;
+            if (password.length()) {
+                flags |= 0x40;
+            }
+        }
+        body += char(flags);
+        put_u16(body, keepalive_s);
+
+        put_string(body, client_id);
+        if (user.length()) {
+            put_string(body, user);
+            if (password.length()) {
+                put_string(body, password);
+            }
+        }
+
+        out += char(CONNECT);
+        put_length(out, body.length());
+        out += body;
+    }
+
+    // A QoS 0 publish, which has no packet identifier
+    inline void publish(std::string& out, std::string_view topic, std::string_view payload, bool retain = false) {
+        out += char(PUBLISH | (retain ? RETAIN : 0));
+        put_length(out, 2 + topic.length() + payload.length());
+        put_string(out, topic);
+        out.append(payload.data(), payload.length());
+    }
+
+    inline void pingreq(std::string& out) {
+        out += char(PINGREQ);
+        out += char(0);
+    }
+
+    inline void disconnect(std::string& out) {
+        out += char(DISCONNECT);
+        out += char(0);
+    }
+
+    // The return code of the CONNACK that data begins with, 0 for accepted, or
+    // -1 if data does not hold a complete CONNACK
+    inline int connack(const uint8_t* data, size_t length) {
+        if (length < 4 || data[0] != CONNACK || data[1] != 2) {
+            return -1;
+        }
+        return data[3];
+    }
+}
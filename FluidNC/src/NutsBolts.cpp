@@ -4,7 +4,8 @@
 // Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
 
 #include "Machine/MachineConfig.h"
-#include "Protocol.h"  // protocol_exec_rt_system
+#include "Protocol.h"       // protocol_exec_rt_system
+#include "DecimalParser.h"  // parse_decimal
 
 #include <cstring>
 #include <cstdint>
@@ -13,88 +14,11 @@
 #include <iomanip>
 #include <string_view>
 
-const int MAX_INT_DIGITS = 8;  // Maximum number of digits in int32 (and float)
-
-static float uint_to_float(uint32_t intval, int exp) {
-    float fval = (float)intval;
-    // Apply decimal. Should perform no more than two floating point multiplications for the
-    // expected range of E0 to E-4.
-    if (fval != 0) {
-        while (exp <= -2) {
-            fval *= 0.01f;
-            exp += 2;
-        }
-        if (exp < 0) {
-            fval *= 0.1f;
-        } else if (exp > 0) {
-            do {
-                fval *= 10.0;
-            } while (--exp > 0);
-        }
-    }
-    return fval;
-}
-
-// Extracts a floating point value from a string. The following code is based loosely on
-// the avr-libc strtod() function by Michael Stumpf and Dmitry Xmelkov and many freely
-// available conversion method examples, but has been highly optimized for Grbl. For known
-// CNC applications, the typical decimal value is expected to be in the range of E0 to E-4.
-// Scientific notation is officially not supported by g-code, and the 'E' character may
-// be a g-code word on some CNC systems. So, 'E' notation will not be recognized.
-// NOTE: Thanks to Radu-Eosif Mihailescu for identifying the issues with using strtod().
+// Extracts a floating point value from a string.  Scientific notation is officially not
+// supported by g-code, and the 'E' character may be a g-code word on some CNC systems. So,
+// 'E' notation will not be recognized.  See DecimalParser.h.
 bool read_float(const char* line, size_t& pos, float& result) {
-    const char* ptr = line + pos;
-
-    // Line is assumed to have no spaces
-
-    // Capture initial positive/minus character
-    char c          = *ptr;
-    bool isnegative = false;
-    if (c == '-') {
-        ++ptr;
-        isnegative = true;
-    } else if (c == '+') {
-        ++ptr;
-    }
-
-    // Extract number into fast integer. Track decimal in terms of exponent value.
-    uint32_t intval    = 0;
-    int8_t   exp       = 0;
-    size_t   ndigit    = 0;
-    bool     isdecimal = false;
-    while (1) {
-        c = *ptr;
-        if (isdigit(c)) {
-            ++ptr;
-            ndigit++;
-            if (ndigit <= MAX_INT_DIGITS) {
-                if (isdecimal) {
-                    exp--;
-                }
-                intval = intval * 10 + c - '0';
-            } else {
-                if (!(isdecimal)) {
-                    exp++;  // Drop overflow digits
-                }
-            }
-        } else if (c == '.' && !(isdecimal)) {
-            ++ptr;
-            isdecimal = true;
-        } else {
-            break;
-        }
-    }
-    // Return if no digits have been read.
-    if (!ndigit) {
-        return false;
-    }
-
-    float fval = uint_to_float(intval, exp);
-
-    result = isnegative ? -fval : fval;
-
-    pos = ptr - line;  // Set pos to next statement
-    return true;
+    return parse_decimal(line, pos, result);
 }
 
 void delay_ms(uint32_t ms) {
@@ -2,6 +2,8 @@
 #include "src/string_util.h"
 
 #include "Machine/MachineConfig.h"
+#include "Report.h"  // status_snapshot()
+#include "Job.h"     // Job::channel()
 
 void OLED::show(Layout& layout, const char* msg) {
     if (_width < layout._width_required) {
@@ -96,7 +98,7 @@ Error OLED::pollLine(char* line) {
 }
 
 void OLED::show_state() {
-    show(stateLayout, _state);
+    show(stateLayout, std::string(_state));
 }
 
 void OLED::show_limits(bool probe, const bool* limits) {
@@ -139,7 +141,7 @@ void OLED::show_file() {
         show(percentLayout64, std::to_string(pct) + '%');
     }
 }
-void OLED::show_dro(const float* axes, bool isMpos, bool* limits) {
+void OLED::show_dro(const float* axes, bool isMpos, const bool* limits) {
     if (_state == "Alarm") {
         return;
     }
@@ -174,7 +176,6 @@ void OLED::show_dro(const float* axes, bool isMpos, bool* limits) {
         snprintf(axisVal, 20 - 1, "%.3f", axes[axis]);
         _oled->drawString((_width == 128) ? 60 : 63, oled_y_pos, axisVal);
     }
-    _oled->display();
 }
 
 void OLED::show_radio_info() {
@@ -196,199 +197,72 @@ void OLED::show_radio_info() {
     }
 }
 
-void OLED::parse_numbers(std::string s, float* nums, int maxnums) {
-    size_t pos     = 0;
-    size_t nextpos = -1;
-    size_t i       = 0;
-    do {
-        if (i >= maxnums) {
-            return;
-        }
-        nextpos  = s.find_first_of(",", pos);
-        auto num = s.substr(pos, nextpos - pos);
-        string_util::from_float(num, nums[i++]);
-        pos = nextpos + 1;
-    } while (nextpos != std::string::npos);
+void OLED::autoReport() {
+    if (!_reportInterval || (int32_t(xTaskGetTickCount()) - _nextReportTime) < 0) {
+        return;
+    }
+    _nextReportTime = xTaskGetTickCount() + _reportInterval;
+
+    show_status(status_snapshot());
+}
+
+// The job progress has the form SD:percent,filename
+void OLED::parse_progress(std::string_view progress) {
+    _filename = "";
+    if (progress.rfind("SD:", 0) != 0) {
+        return;
+    }
+    progress.remove_prefix(3);
+    auto comma = progress.find_first_of(',');
+    if (comma == std::string_view::npos) {
+        return;
+    }
+    string_util::from_float(progress.substr(0, comma), _percent);
+    _filename = progress.substr(comma + 1);
 }
 
-void OLED::parse_axes(std::string s, float* axes) {
-    size_t pos     = 0;
-    size_t nextpos = -1;
-    size_t axis    = 0;
-    do {
-        nextpos  = s.find_first_of(",", pos);
-        auto num = s.substr(pos, nextpos - pos);
-        if (axis < MAX_N_AXIS) {
-            string_util::from_float(num, axes[axis++]);
+static bool same_status(const StatusFrame::Fields& a, const StatusFrame::Fields& b) {
+    if (a.n_axis != b.n_axis || a.flags != b.flags || a.pins != b.pins) {
+        return false;
+    }
+    for (size_t axis = 0; axis < a.n_axis; axis++) {
+        if (a.position[axis] != b.position[axis]) {
+            return false;
         }
-        pos = nextpos + 1;
-    } while (nextpos != std::string::npos);
+    }
+    return true;
 }
 
-void OLED::parse_status_report() {
-    if (_report.back() == '>') {
-        _report.pop_back();
+void OLED::show_status(const StatusSnapshot& snapshot) {
+    const StatusFrame::Fields& fields   = snapshot.fields;
+    std::string_view           state    = snapshot.state_name;
+    std::string                progress = Job::active() ? Job::channel()->_progress : "";
+
+    // The ticker moves with each report of a running job, so only an idle screen can be skipped
+    if (state == _shown_state && progress == _shown_progress && progress.empty() && same_status(fields, _shown)) {
+        return;
     }
-    // Now the string is a sequence of field|field|field
-    size_t pos     = 0;
-    auto   nextpos = _report.find_first_of("|", pos);
-    _state         = _report.substr(pos + 1, nextpos - pos - 1);
+    _shown          = fields;
+    _shown_state    = state;
+    _shown_progress = progress;
 
-    bool probe              = false;
-    bool limits[MAX_N_AXIS] = { false };
+    _state = state;
+    parse_progress(progress);
 
-    float axes[MAX_N_AXIS];
-    bool  isMpos = false;
-    _filename    = "";
-    uint32_t linenum;
-
-    // ... handle it
-    while (nextpos != std::string::npos) {
-        pos        = nextpos + 1;
-        nextpos    = _report.find_first_of("|", pos);
-        auto field = _report.substr(pos, nextpos - pos);
-        // MPos:, WPos:, Bf:, Ln:, FS:, Pn:, WCO:, Ov:, A:, SD: (ISRs:, Heap:)
-        auto colon = field.find_first_of(":");
-        auto tag   = field.substr(0, colon);
-        auto value = field.substr(colon + 1);
-        if (tag == "MPos") {
-            // x,y,z,...
-            parse_axes(value, axes);
-            isMpos = true;
-            continue;
-        }
-        if (tag == "WPos") {
-            // x,y,z...
-            parse_axes(value, axes);
-            isMpos = false;
-            continue;
-        }
-        if (tag == "Bf") {
-            // buf_avail,rx_avail
-            continue;
-        }
-        if (tag == "Ln") {
-            // n
-            string_util::from_decimal(value, linenum);
-            continue;
-        }
-        if (tag == "FS") {
-            // feedrate,spindle_speed
-            float fs[2];
-            parse_numbers(value, fs, 2);  // feed in [0], spindle in [1]
-            continue;
-        }
-        if (tag == "Pn") {
-            // PXxYy etc
-            for (char const& c : value) {
-                switch (c) {
-                    case 'P':
-                        probe = true;
-                        break;
-                    case 'X':
-                        limits[X_AXIS] = true;
-                        break;
-                    case 'Y':
-                        limits[Y_AXIS] = true;
-                        break;
-                    case 'Z':
-                        limits[Z_AXIS] = true;
-                        break;
-                    case 'A':
-                        limits[A_AXIS] = true;
-                        break;
-                    case 'B':
-                        limits[B_AXIS] = true;
-                        break;
-                    case 'C':
-                        limits[C_AXIS] = true;
-                        break;
-                }
-                continue;
-            }
-        }
-        if (tag == "WCO") {
-            // x,y,z,...
-            // We do not use the WCO values because the DROs show whichever
-            // position is in the status report
-            // float wcos[MAX_N_AXIS];
-            // auto  wcos = parse_axes(value, wcos);
-            continue;
-        }
-        if (tag == "Ov") {
-            // feed_ovr,rapid_ovr,spindle_ovr
-            float frs[3];
-            parse_numbers(value, frs, 3);  // feed in [0], rapid in [1], spindle in [2]
-            continue;
-        }
-        if (tag == "A") {
-            // SCFM
-            int  spindle = 0;
-            bool flood   = false;
-            bool mist    = false;
-            for (char const& c : value) {
-                switch (c) {
-                    case 'S':
-                        spindle = 1;
-                        break;
-                    case 'C':
-                        spindle = 2;
-                        break;
-                    case 'F':
-                        flood = true;
-                        break;
-                    case 'M':
-                        mist = true;
-                        break;
-                }
-            }
-            continue;
-        }
-        if (tag == "SD") {
-            auto commaPos = value.find_first_of(",");
-            string_util::from_float(value.substr(0, commaPos), _percent);
-            _filename = value.substr(commaPos + 1);
-            continue;
-        }
+    // Bit n of fields.pins is pin_letters[n], so the probe is bit 0
+    bool probe              = fields.pins & 1;
+    bool limits[MAX_N_AXIS] = { false };
+    for (size_t axis = 0; axis < fields.n_axis && axis < MAX_N_AXIS; axis++) {
+        limits[axis] = fields.pins & StatusFrame::pin_bits(std::string_view(&Machine::Axes::_names[axis], 1));
     }
+
     _oled->clear();
     show_state();
     show_file();
     show_limits(probe, limits);
-    show_dro(axes, isMpos, limits);
+    show_dro(fields.position, !(fields.flags & StatusFrame::WorkPosition), limits);
     show_radio_info();
-    _oled->display();
-}
-
-void OLED::parse_gcode_report() {
-    size_t pos     = 0;
-    size_t nextpos = _report.find_first_of(":", pos);
-    auto   name    = _report.substr(pos, nextpos - pos);
-    if (name != "[GC") {
-        return;
-    }
-    pos = nextpos + 1;
-    do {
-        nextpos  = _report.find_first_of(" ", pos);
-        auto tag = _report.substr(pos, nextpos - pos);
-        // G80 G0 G1 G2 G3  G38.2 G38.3 G38.4 G38.5
-        // G54 .. G59
-        // G17 G18 G19
-        // G20 G21
-        // G90 G91
-        // G94 G93
-        // M0 M1 M2 M30
-        // M3 M4 M5
-        // M7 M8 M9
-        // M56
-        // Tn
-        // Fn
-        // Sn
-        //        if (tag == "G0") {
-        //            continue;
-        //        }
-        pos = nextpos + 1;
-    } while (nextpos != std::string::npos);
+    _oled->display();  // Sends only the parts of the frame that changed
 }
 
 // [MSG:INFO: Connecting to STA:SSID foo]
@@ -461,14 +335,6 @@ void OLED::parse_report() {
     if (_report.length() == 0) {
         return;
     }
-    if (_report.rfind("<", 0) == 0) {
-        parse_status_report();
-        return;
-    }
-    if (_report.rfind("[GC:", 0) == 0) {
-        parse_gcode_report();
-        return;
-    }
     if (_report.rfind("[MSG:INFO: Connecting to STA SSID:", 0) == 0) {
         parse_STA();
         return;
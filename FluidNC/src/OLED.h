@@ -6,8 +6,11 @@
 
 #include "src/Channel.h"
 #include "src/Module.h"
+#include "src/Report.h"  // StatusSnapshot
 #include "SSD1306_I2C.h"
 
+#include <string_view>
+
 typedef const uint8_t* font_t;
 
 class OLED : public Channel, public ConfigurableModule {
@@ -37,8 +40,8 @@ private:
     std::string _radio_info;
     std::string _radio_addr;
 
-    std::string _state;
-    std::string _filename;
+    std::string_view _state;  // From state_name()
+    std::string      _filename;
 
     float       _percent;
     std::string _ticker;
@@ -48,22 +51,25 @@ private:
 
     uint8_t _i2c_num = 0;
 
+    // The status that is on the screen, so that an unchanged status is not redrawn
+    StatusFrame::Fields _shown;
+    std::string_view    _shown_state;
+    std::string         _shown_progress;
+
+    void show_status(const StatusSnapshot& snapshot);
+    void parse_progress(std::string_view progress);
+
     void parse_report();
-    void parse_status_report();
-    void parse_gcode_report();
     void parse_STA();
     void parse_IP();
     void parse_AP();
     void parse_BT();
     void parse_WebUI();
 
-    void parse_axes(std::string s, float* axes);
-    void parse_numbers(std::string s, float* nums, int maxnums);
-
     void show_limits(bool probe, const bool* limits);
     void show_state();
     void show_file();
-    void show_dro(const float* axes, bool isMpos, bool* limits);
+    void show_dro(const float* axes, bool isMpos, const bool* limits);
     void show_radio_info();
     void draw_checkbox(int16_t x, int16_t y, int16_t width, int16_t height, bool checked);
 
@@ -107,6 +113,10 @@ public:
     int peek(void) override { return -1; }
 
     Error pollLine(char* line) override;
+
+    // Draws the status from status_snapshot() instead of formatting a status
+    // report and parsing it back
+    void autoReport() override;
     void  flushRx() override {}
 
     bool   lineComplete(char*, char) override { return false; }
@@ -0,0 +1,119 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  ParamTable.h - flat storage for G-code parameter values
+
+  A ParamTable keeps its entries in a single open-addressed array with linear probing,
+  so finding a parameter costs one hash and usually one key compare, with no tree nodes
+  to chase.  Named tables own one copy of each name and are searched with a string_view,
+  so reading or rewriting an existing parameter never allocates.  G-code has no way
+  to delete a parameter, so entries are only ever added; clear() empties the whole table.
+  It is header-only so that it can be tested and timed on the host.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// FNV-1a
+inline uint32_t param_hash(std::string_view name) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash = (hash ^ uint8_t(c)) * 16777619u;
+    }
+    return hash;
+}
+
+// Fibonacci hashing spreads consecutive parameter numbers over the table
+inline uint32_t param_hash(int id) {
+    return uint32_t(id) * 2654435769u;
+}
+
+template <typename Key, typename LookupKey = Key>
+class ParamTable {
+    struct Entry {
+        Key   key;
+        float value = 0.0f;
+        bool  used  = false;
+    };
+
+    std::vector<Entry> _entries;  // Empty or a power of two in size
+    size_t             _count = 0;
+
+    // Returns the entry holding key, or the free entry where it belongs
+    const Entry* find(LookupKey key) const {
+        size_t mask = _entries.size() - 1;
+        for (size_t i = param_hash(key) & mask;; i = (i + 1) & mask) {
+            const Entry& entry = _entries[i];
+            if (!entry.used || entry.key == key) {
+                return &entry;
+            }
+        }
+    }
+    Entry* find(LookupKey key) { return const_cast<Entry*>(static_cast<const ParamTable*>(this)->find(key)); }
+
+    // Keeps the table at most 3/4 full so probe sequences stay short
+    void grow() {
+        std::vector<Entry> old(_entries.empty() ? 16 : _entries.size() * 2);
+        old.swap(_entries);
+        for (auto& entry : old) {
+            if (entry.used) {
+                *find(entry.key) = std::move(entry);
+            }
+        }
+    }
+
+public:
+    ParamTable() = default;
+    ParamTable(std::initializer_list<std::pair<Key, float>> values) {
+        for (auto const& [key, value] : values) {
+            set(key, value);
+        }
+    }
+
+    bool get(LookupKey key, float& value) const {
+        if (_count == 0) {
+            return false;
+        }
+        const Entry* entry = find(key);
+        if (!entry->used) {
+            return false;
+        }
+        value = entry->value;
+        return true;
+    }
+
+    bool exists(LookupKey key) const {
+        return _count != 0 && find(key)->used;
+    }
+
+    void set(LookupKey key, float value) {
+        if ((_count + 1) * 4 > _entries.size() * 3) {
+            grow();
+        }
+        Entry* entry = find(key);
+        if (!entry->used) {
+            entry->key  = Key(key);
+            entry->used = true;
+            ++_count;
+        }
+        entry->value = value;
+    }
+
+    void clear() {
+        _entries.clear();
+        _count = 0;
+    }
+
+    size_t size() const { return _count; }
+};
+
+using NamedParams    = ParamTable<std::string, std::string_view>;
+using NumberedParams = ParamTable<int>;
@@ -11,8 +11,12 @@
 #include "MotionControl.h"
 #include "GCode.h"
 #include "Job.h"
+#include "ParamTable.h"
+#include "LineArena.h"
 
 #include <string>
+#include <string_view>
+#include <cstring>
 #include <map>
 
 #include "Expression.h"
@@ -27,7 +31,7 @@ const std::map<const int, bool *> bool_params = {
     { 5070, &probe_succeeded },
 };
 
-std::map<const ngc_param_id_t, float> float_params = {
+NumberedParams float_params = {
     { 5399, 0.0 }, // M66 last immediate read input result
 };
 
@@ -71,41 +75,99 @@ const std::map<const ngc_param_id_t, CoordIndex> axis_params = {
     // { 5401, CoordIndex::TLO },
 };
 
-const std::map<const std::string, int> work_positions = {
-    { "_x", 0 },
-    { "_y", 1 },
-    { "_z", 2 },
-    { "_a", 3 },
-    { "_b", 4 },
-    { "_c", 5 },
-    //    { "_u", 0},
-    //    { "_v", 0},
-    //    { "_w", 0},
-};
-const std::map<const std::string, int> machine_positions = {
-    { "_abs_x", 0 },
-    { "_abs_y", 1 },
-    { "_abs_z", 2 },
-    { "_abs_a", 3 },
-    { "_abs_b", 4 },
-    { "_abs_c", 5 },
-    //    { "_abs_u", 0},
-    //    { "_abs_v", 0},
-    //    { "_abs_w", 0},
+typedef enum : uint8_t {
+    Sys_Work,         // Work position of axis
+    Sys_Machine,      // Machine position of axis
+    Sys_Unsupported,  // Always 0
+    Sys_SpindleOn,
+    Sys_SpindleCw,
+    Sys_SpindleM,
+    Sys_Mist,
+    Sys_Flood,
+    Sys_SpeedOverride,
+    Sys_FeedOverride,
+    Sys_FeedHold,
+    Sys_Feed,
+    Sys_Rpm,
+    Sys_SelectedTool,
+    Sys_CurrentTool,
+    Sys_VMajor,
+    Sys_VMinor,
+    Sys_Line,
+    Sys_MotionMode,
+    Sys_Plane,
+    Sys_CoordSystem,
+    Sys_Metric,
+    Sys_Imperial,
+    Sys_Absolute,
+    Sys_Incremental,
+    Sys_InverseTime,
+    Sys_UnitsPerMinute,
+    Sys_UnitsPerRev,
+} sys_param_t;
+
+struct sys_param_def_t {
+    const char* name;
+    sys_param_t param;
+    int         axis;
 };
 
-const std::array<const std::string, 6> unsupported_sys = {
-    "_spindle_rpm_mode",
-    "_spindle_css_mode",
-    "_ijk_absolute_mode",
-    "_lathe_diameter_mode",
-    "_lathe_radius_mode",
-    "_adaptive_feed",
+const sys_param_def_t sys_params[] = {
+    { "_x", Sys_Work, 0 },
+    { "_y", Sys_Work, 1 },
+    { "_z", Sys_Work, 2 },
+    { "_a", Sys_Work, 3 },
+    { "_b", Sys_Work, 4 },
+    { "_c", Sys_Work, 5 },
+    //    { "_u", Sys_Work, 0},
+    //    { "_v", Sys_Work, 0},
+    //    { "_w", Sys_Work, 0},
+    { "_abs_x", Sys_Machine, 0 },
+    { "_abs_y", Sys_Machine, 1 },
+    { "_abs_z", Sys_Machine, 2 },
+    { "_abs_a", Sys_Machine, 3 },
+    { "_abs_b", Sys_Machine, 4 },
+    { "_abs_c", Sys_Machine, 5 },
+    //    { "_abs_u", Sys_Machine, 0},
+    //    { "_abs_v", Sys_Machine, 0},
+    //    { "_abs_w", Sys_Machine, 0},
+    { "_spindle_rpm_mode", Sys_Unsupported },
+    { "_spindle_css_mode", Sys_Unsupported },
+    { "_ijk_absolute_mode", Sys_Unsupported },
+    { "_lathe_diameter_mode", Sys_Unsupported },
+    { "_lathe_radius_mode", Sys_Unsupported },
+    { "_adaptive_feed", Sys_Unsupported },
+    { "_spindle_on", Sys_SpindleOn },
+    { "_spindle_cw", Sys_SpindleCw },
+    { "_spindle_m", Sys_SpindleM },
+    { "_mist", Sys_Mist },
+    { "_flood", Sys_Flood },
+    { "_speed_override", Sys_SpeedOverride },
+    { "_feed_override", Sys_FeedOverride },
+    { "_feed_hold", Sys_FeedHold },
+    { "_feed", Sys_Feed },
+    { "_rpm", Sys_Rpm },
+    { "_selected_tool", Sys_SelectedTool },
+    { "_current_tool", Sys_CurrentTool },
+    { "_vmajor", Sys_VMajor },
+    { "_vminor", Sys_VMinor },
+    { "_line", Sys_Line },
+    { "_motion_mode", Sys_MotionMode },
+    { "_plane", Sys_Plane },
+    // { "_ccomp", Sys_CutterComp },
+    { "_coord_system", Sys_CoordSystem },
+    { "_metric", Sys_Metric },
+    { "_imperial", Sys_Imperial },
+    { "_absolute", Sys_Absolute },
+    { "_incremental", Sys_Incremental },
+    { "_inverse_time", Sys_InverseTime },
+    { "_units_per_minute", Sys_UnitsPerMinute },
+    { "_units_per_rev", Sys_UnitsPerRev },
 };
 
 // clang-format on
 
-std::map<std::string, float> global_named_params;
+NamedParams global_named_params;
 
 bool ngc_param_is_rw(ngc_param_id_t id) {
     return true;
@@ -146,7 +208,7 @@ bool get_numbered_param(ngc_param_id_t id, float& result) {
     axis = id - 5061;
     if (is_axis(axis)) {
         float probe_position[MAX_N_AXIS];
-        motor_steps_to_mpos(probe_position, probe_steps);
+        probe_steps_to_mpos(probe_position);
         result = to_inches(axis, probe_position[axis]);
         return true;
     }
@@ -181,8 +243,7 @@ bool get_numbered_param(ngc_param_id_t id, float& result) {
     }
 
     if (can_read_float_param(id)) {
-        if (auto param = float_params.find(id); param != float_params.end()) {
-            result = param->second;
+        if (float_params.get(id, result)) {
             return true;
         } else {
             log_info("param #" << id << " is not found");
@@ -193,12 +254,21 @@ bool get_numbered_param(ngc_param_id_t id, float& result) {
     return false;
 }
 
-// TODO - make this a variant?
-struct param_ref_t {
-    std::string    name;  // If non-empty, the parameter is named
-    ngc_param_id_t id;    // Valid if name is empty
-};
-std::vector<std::tuple<param_ref_t, float>> assignments;
+// Assignments take effect at the end of their line, so they are kept in the line arena
+using assignment_t = std::tuple<param_ref_t, float>;
+
+static StaticArena<1024>                                       line_arena;
+static std::vector<assignment_t, ArenaAllocator<assignment_t>> assignments { ArenaAllocator<assignment_t>(line_arena) };
+
+void params_begin_line() {
+    // A line that failed leaves its assignments behind; drop them before the arena is reused
+    std::vector<assignment_t, ArenaAllocator<assignment_t>>(assignments.get_allocator()).swap(assignments);
+    line_arena.reset();
+}
+
+const Arena& params_line_arena() {
+    return line_arena;
+}
 
 bool set_config_item(const std::string& name, float result) {
     try {
@@ -231,148 +301,163 @@ bool get_config_item(const std::string& name, float& result) {
 
 int coord_values[] = { 540, 550, 560, 570, 580, 590, 591, 592, 593 };
 
-bool get_system_param(const std::string& name, float& result) {
-    std::string sysn;
-    for (auto const& c : name) {
-        sysn += tolower(c);
-    }
-    if (auto search = work_positions.find(sysn); search != work_positions.end()) {
-        auto axis = search->second;
-        result    = to_inches(axis, get_mpos()[axis] - get_wco()[axis]);
-        return true;
-    }
-    if (auto search = machine_positions.find(sysn); search != machine_positions.end()) {
-        auto axis = search->second;
-        result    = to_inches(axis, get_mpos()[axis]);
-        return true;
-    }
-    if (std::find(unsupported_sys.begin(), unsupported_sys.end(), sysn) != unsupported_sys.end()) {
-        result = 0.0;
-        return true;
-    }
-    if (sysn == "_spindle_on") {
-        result = gc_state.modal.spindle != SpindleState::Disable;
-        return true;
-    }
-    if (sysn == "_spindle_cw") {
-        result = gc_state.modal.spindle == SpindleState::Cw;
-        return true;
-    }
-    if (sysn == "_spindle_m") {
-        result = static_cast<int>(gc_state.modal.spindle);
-        return true;
-    }
+// System parameter names are found with a perfect hash: the seed is chosen
+// so that every name gets its own slot, and one compare confirms the match.
+static const int    sys_slots_bits = 8;
+static const size_t sys_slots_size = 1 << sys_slots_bits;
 
-    if (sysn == "_mist") {
-        result = gc_state.modal.coolant.Mist;
-        return true;
-    }
-    if (sysn == "_flood") {
-        result = gc_state.modal.coolant.Flood;
-        return true;
-    }
-    if (sysn == "_speed_override") {
-        result = sys.spindle_speed_ovr != 100;
-        return true;
-    }
-    if (sysn == "_feed_override") {
-        result = sys.f_override != 100;
-        return true;
-    }
-    if (sysn == "_feed_hold") {
-        result = sys.state == State::Hold;
-        return true;
-    }
-    if (sysn == "_feed") {
-        result = to_inches(0, gc_state.feed_rate);
-        return true;
-    }
-    if (sysn == "_rpm") {
-        result = gc_state.spindle_speed;
-        return true;
-    }
-    if (sysn == "_selected_tool") {
-        result = gc_state.selected_tool;
-        return true;
-    }
-
-    if (sysn == "_current_tool") {
-        result = gc_state.current_tool;
-        return true;
+static uint32_t sys_hash(std::string_view name, uint32_t seed) {
+    uint32_t hash = seed;
+    for (char c : name) {
+        hash = (hash ^ uint8_t(tolower(c))) * 16777619u;
     }
+    return hash >> (32 - sys_slots_bits);  // The high bits depend on every character
+}
 
-    if (sysn == "_vmajor") {
-        std::string version(grbl_version);
-        auto        major = version.substr(0, version.find('.'));
-        result            = atoi(major.c_str());
-        return true;
+static const sys_param_def_t* find_sys_param(std::string_view name) {
+    static uint8_t  slots[sys_slots_size];
+    static uint32_t seed = 0;
+
+    const uint8_t empty    = 0xff;
+    const size_t  n_params = sizeof(sys_params) / sizeof(sys_params[0]);
+    static_assert(n_params < 0xff, "Too many system parameters for the slot table");
+
+    if (!seed) {
+        for (seed = 2166136261u;; ++seed) {
+            memset(slots, empty, sizeof(slots));
+            size_t i;
+            for (i = 0; i < n_params; ++i) {
+                auto& slot = slots[sys_hash(sys_params[i].name, seed)];
+                if (slot != empty) {
+                    break;
+                }
+                slot = uint8_t(i);
+            }
+            if (i == n_params) {
+                break;
+            }
+        }
     }
-    if (sysn == "_vminor") {
-        std::string version(grbl_version);
-        auto        minor = version.substr(version.find('.') + 1);
 
-        result = atoi(minor.c_str());
-        return true;
+    uint8_t index = slots[sys_hash(name, seed)];
+    if (index == empty) {
+        return nullptr;
     }
-    if (sysn == "_line") {
-        //XXX Implement me
-        return true;
-    }
-    if (sysn == "_motion_mode") {
-        result = static_cast<gcodenum_t>(gc_state.modal.motion);
-        return true;
+    const sys_param_def_t* def = &sys_params[index];
+    if (strlen(def->name) != name.length() || strncasecmp(def->name, name.data(), name.length())) {
+        return nullptr;
     }
-    if (sysn == "_plane") {
-        result = static_cast<gcodenum_t>(gc_state.modal.plane_select);
-        return true;
+    return def;
+}
+
+bool get_system_param(const std::string& name, float& result) {
+    auto def = find_sys_param(name);
+    if (!def) {
+        return false;
     }
+    auto axis = def->axis;
+    switch (def->param) {
+        case Sys_Work:
+            result = to_inches(axis, get_mpos()[axis] - get_wco()[axis]);
+            break;
+        case Sys_Machine:
+            result = to_inches(axis, get_mpos()[axis]);
+            break;
+        case Sys_Unsupported:
+            result = 0.0;
+            break;
+        case Sys_SpindleOn:
+            result = gc_state.modal.spindle != SpindleState::Disable;
+            break;
+        case Sys_SpindleCw:
+            result = gc_state.modal.spindle == SpindleState::Cw;
+            break;
+        case Sys_SpindleM:
+            result = static_cast<int>(gc_state.modal.spindle);
+            break;
+        case Sys_Mist:
+            result = gc_state.modal.coolant.Mist;
+            break;
+        case Sys_Flood:
+            result = gc_state.modal.coolant.Flood;
+            break;
+        case Sys_SpeedOverride:
+            result = sys.spindle_speed_ovr != 100;
+            break;
+        case Sys_FeedOverride:
+            result = sys.f_override != 100;
+            break;
+        case Sys_FeedHold:
+            result = sys.state == State::Hold;
+            break;
+        case Sys_Feed:
+            result = to_inches(0, gc_state.feed_rate);
+            break;
+        case Sys_Rpm:
+            result = gc_state.spindle_speed;
+            break;
+        case Sys_SelectedTool:
+            result = gc_state.selected_tool;
+            break;
+        case Sys_CurrentTool:
+            result = gc_state.current_tool;
+            break;
+        case Sys_VMajor: {
+            std::string version(grbl_version);
+            auto        major = version.substr(0, version.find('.'));
+            result            = atoi(major.c_str());
+        } break;
+        case Sys_VMinor: {
+            std::string version(grbl_version);
+            auto        minor = version.substr(version.find('.') + 1);
+
+            result = atoi(minor.c_str());
+        } break;
+        case Sys_Line:
+            //XXX Implement me
+            break;
+        case Sys_MotionMode:
+            result = static_cast<gcodenum_t>(gc_state.modal.motion);
+            break;
+        case Sys_Plane:
+            result = static_cast<gcodenum_t>(gc_state.modal.plane_select);
+            break;
 #if 0
-    if (sysn == "_ccomp") {
-        result = static_cast<gcodenum_t>(gc_state.modal.cutter_comp);
-        return true;
-    }
+        case Sys_CutterComp:
+            result = static_cast<gcodenum_t>(gc_state.modal.cutter_comp);
+            break;
 #endif
-    if (sysn == "_coord_system") {
-        result = coord_values[gc_state.modal.coord_select];
-        return true;
+        case Sys_CoordSystem:
+            result = coord_values[gc_state.modal.coord_select];
+            break;
+        case Sys_Metric:
+            result = gc_state.modal.units == Units::Mm;
+            break;
+        case Sys_Imperial:
+            result = gc_state.modal.units == Units::Inches;
+            break;
+        case Sys_Absolute:
+            result = gc_state.modal.distance == Distance::Absolute;
+            break;
+        case Sys_Incremental:
+            result = gc_state.modal.distance == Distance::Incremental;
+            break;
+        case Sys_InverseTime:
+            result = gc_state.modal.feed_rate == FeedRate::InverseTime;
+            break;
+        case Sys_UnitsPerMinute:
+            result = gc_state.modal.feed_rate == FeedRate::UnitsPerMin;
+            break;
+        case Sys_UnitsPerRev:
+            // result = gc_state.modal.feed_rate == FeedRate::UnitsPerRev;
+            result = 0.0;
+            break;
     }
-
-    if (sysn == "_metric") {
-        result = gc_state.modal.units == Units::Mm;
-        return true;
-    }
-    if (sysn == "_imperial") {
-        result = gc_state.modal.units == Units::Inches;
-        return true;
-    }
-    if (sysn == "_absolute") {
-        result = gc_state.modal.distance == Distance::Absolute;
-        return true;
-    }
-    if (sysn == "_incremental") {
-        result = gc_state.modal.distance == Distance::Incremental;
-        return true;
-    }
-    if (sysn == "_inverse_time") {
-        result = gc_state.modal.feed_rate == FeedRate::InverseTime;
-        return true;
-    }
-    if (sysn == "_units_per_minute") {
-        result = gc_state.modal.feed_rate == FeedRate::UnitsPerMin;
-        return true;
-    }
-    if (sysn == "_units_per_rev") {
-        // result = gc_state.modal.feed_rate == FeedRate::UnitsPerRev;
-        result = 0.0;
-        return true;
-    }
-
-    return false;
+    return true;
 }
 
 bool system_param_exists(const std::string& name) {
-    float dummy;
-    return get_system_param(name, dummy);
+    return find_sys_param(name) != nullptr;
 }
 
 // The LinuxCNC doc says that the EXISTS syntax is like EXISTS[#<_foo>]
@@ -397,24 +482,19 @@ bool named_param_exists(std::string& name) {
         if (got) {
             return true;
         }
-        return global_named_params.count(search) != 0;
+        return global_named_params.exists(search);
     }
     // If the name does not start with _ it is local so we look for a job-local parameter
     // If no job is active, we treat the interpretive context like a local context
-    return Job::active() ? Job::param_exists(search) : global_named_params.count(search) != 0;
+    return Job::active() ? Job::param_exists(search) : global_named_params.exists(search);
 }
 
 bool get_global_named_param(const std::string& name, float& value) {
-    auto it = global_named_params.find(name);
-    if (it == global_named_params.end()) {
-        return false;
-    }
-    value = it->second;
-    return true;
+    return global_named_params.get(name, value);
 }
 
 bool get_param(const param_ref_t& param_ref, float& value) {
-    auto name = param_ref.name;
+    auto const& name = param_ref.name;
     if (name.length()) {
         if (name[0] == '/') {
             return get_config_item(name, value);
@@ -486,7 +566,7 @@ bool get_param_ref(const char* line, size_t& pos, param_ref_t& param_ref) {
 }
 
 bool set_named_param(const std::string& name, float value) {
-    global_named_params[name] = value;
+    global_named_params.set(name, value);
     return true;
 }
 
@@ -516,7 +596,7 @@ bool set_numbered_param(ngc_param_id_t id, float value) {
         return true;
     }
     if (can_write_float_param(id)) {
-        float_params[id] = value;
+        float_params.set(id, value);
         return true;
     }
     log_info("param #" << id << " is not found");
@@ -525,7 +605,7 @@ bool set_numbered_param(ngc_param_id_t id, float value) {
 
 bool set_param(const param_ref_t& param_ref, float value) {
     if (param_ref.name.length()) {  // Named parameter
-        auto name = param_ref.name;
+        auto const& name = param_ref.name;
         if (name[0] == '/') {
             return set_config_item(param_ref.name, value);
         }
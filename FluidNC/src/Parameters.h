@@ -6,13 +6,28 @@
 #include <stddef.h>
 #include <string>
 
+class Arena;  // LineArena.h
+
 // TODO - make ngc_param_id_t an enum, give names to numbered parameters where
 // possible
 typedef int ngc_param_id_t;
 
+// TODO - make this a variant?
+struct param_ref_t {
+    std::string    name;  // If non-empty, the parameter is named
+    ngc_param_id_t id;    // Valid if name is empty
+};
+
 bool assign_param(const char* line, size_t& pos);
+bool get_param(const param_ref_t& param_ref, float& value);
 bool read_number(const char* line, size_t& pos, float& value, bool in_expression = false);
 bool perform_assignments();
+
+// Releases the per-line storage of the previous line; called at the start of each line
+void params_begin_line();
+
+// The arena of the per-line storage, for $Heap/Stats
+const Arena& params_line_arena();
 bool named_param_exists(std::string& name);
 bool set_named_param(const char* name, float value);
 bool set_numbered_param(ngc_param_id_t, float value);
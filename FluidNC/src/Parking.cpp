@@ -7,31 +7,71 @@
 #include "Machine/MachineConfig.h"  // config
 #include "Spindles/Spindle.h"       // spindle
 
-// Plans and executes the single special motion case for parking. Independent of main planner buffer.
-// NOTE: Uses the always free planner ring buffer head to store motion parameters for execution.
-void Parking::moveto(float* target) {
-    if (sys.abort) {
-        return;  // Block during abort.
-    }
-    if (plan_buffer_line(target, &plan_data)) {
-        sys.step_control.executeSysMotion = true;
-        sys.step_control.endMotion        = false;  // Allow parking motion to execute, if feed hold is active.
-        Stepper::parking_setup_buffer();            // Setup step segment buffer for special parking motion case
-        Stepper::prep_buffer();
-        Stepper::wake_up();
-        do {
-            protocol_exec_rt_system();
-            if (sys.abort) {
-                return;
-            }
-        } while (sys.step_control.executeSysMotion);
-        Stepper::parking_restore_buffer();  // Restore step segment buffer to normal run state.
+// Plans a parking motion with the current plan_data.  Independent of main planner buffer.
+// NOTE: Motions queued before start() run as one sequence, without stopping where the path
+// goes straight on, as the pullout and the parking motion do.
+void Parking::queue(float* target) {
+    if (!sys.abort && plan_buffer_line(target, &plan_data)) {
+        _queued = true;
+    }
+}
+
+// Starts the queued motions.  Returns false if there are none.
+bool Parking::start() {
+    if (!_queued || sys.abort) {
+        return false;
+    }
+    _queued                           = false;
+    _running                          = true;
+    sys.step_control.executeSysMotion = true;
+    sys.step_control.endMotion        = false;  // Allow parking motion to execute, if feed hold is active.
+    Stepper::parking_setup_buffer();            // Setup step segment buffer for special parking motion case
+    Stepper::prep_buffer();
+    Stepper::wake_up();
+    return true;
+}
+
+// Waits for the started motions to end
+void Parking::finish() {
+    if (!_running) {
+        return;
+    }
+    _running = false;
+    do {
+        protocol_exec_rt_system();
+        if (sys.abort) {
+            return;
+        }
+    } while (sys.step_control.executeSysMotion);
+    Stepper::parking_restore_buffer();  // Restore step segment buffer to normal run state.
+}
+
+// Executes the queued motions
+void Parking::run() {
+    if (start()) {
+        finish();
     } else {
         sys.step_control.executeSysMotion = false;
         protocol_exec_rt_system();
     }
 }
 
+// Plans and executes a single parking motion
+void Parking::moveto(float* target) {
+    queue(target);
+    run();
+}
+
+// Sends the spindle and coolant of plan_data off
+void Parking::clear_accessories() {
+    plan_data.spindle               = SpindleState::Disable;
+    plan_data.coolant               = {};
+    plan_data.motion                = {};
+    plan_data.motion.systemMotion   = 1;
+    plan_data.motion.noFeedOverride = 1;
+    plan_data.spindle_speed         = 0.0;
+}
+
 bool Parking::can_park() {
     if (!_enable) {
         return false;
@@ -68,9 +108,10 @@ void Parking::setup() {
     block                           = plan_get_current_block();
 
     if (block) {
-        saved_coolant       = block->coolant;
-        saved_spindle       = block->spindle;
-        saved_spindle_speed = block->spindle_speed;
+        plan_block_aux_t* aux = plan_get_block_aux(block);
+        saved_coolant         = aux->coolant;
+        saved_spindle         = aux->spindle;
+        saved_spindle_speed   = aux->spindle_speed;
     } else {
         saved_coolant       = gc_state.modal.coolant;
         saved_spindle       = gc_state.modal.spindle;
@@ -93,34 +134,52 @@ void Parking::park(bool restart) {
     if (can_park() && parking_target[_axis] < _target_mpos) {
         // Retract spindle by pullout distance. Ensure retraction motion moves away from
         // the workpiece and waypoint motion doesn't exceed the parking target location.
+        // With spindle_overlap the spindle goes off as the pullout starts, and spins down
+        // while the pullout and the parking motion run as one.  Otherwise it keeps running
+        // during the pullout and the parking motion waits for it to stop.
         if (parking_target[_axis] < retract_waypoint) {
             log_debug("Parking pullout");
-            parking_target[_axis]   = retract_waypoint;
-            plan_data.feed_rate     = _pullout_rate;
-            plan_data.coolant       = saved_coolant;
-            plan_data.spindle       = saved_spindle;
-            plan_data.spindle_speed = saved_spindle_speed;
-            moveto(parking_target);
+            parking_target[_axis] = retract_waypoint;
+            plan_data.feed_rate   = _pullout_rate;
+            if (_spindle_overlap) {
+                clear_accessories();
+            } else {
+                plan_data.coolant       = saved_coolant;
+                plan_data.spindle       = saved_spindle;
+                plan_data.spindle_speed = saved_spindle_speed;
+            }
+            queue(parking_target);
+            if (!_spindle_overlap) {
+                run();
+            }
         }
 
         // NOTE: Clear accessory state after retract and after an aborted restore motion.
-        plan_data.spindle               = SpindleState::Disable;
-        plan_data.coolant               = {};
-        plan_data.motion                = {};
-        plan_data.motion.systemMotion   = 1;
-        plan_data.motion.noFeedOverride = 1;
-        plan_data.spindle_speed         = 0.0;
-
-        log_debug("Spin down");
-        spindle->spinDown();
-        gc_ovr_changed();
+        clear_accessories();
+
+        if (!_spindle_overlap) {
+            log_debug("Spin down");
+            spindle->spinDown();
+            gc_ovr_changed();
+        }
 
         // Execute fast parking retract motion to parking target location.
         if (parking_target[_axis] < _target_mpos) {
             log_debug("Parking motion");
             parking_target[_axis] = _target_mpos;
             plan_data.feed_rate   = _rate;
-            moveto(parking_target);
+            queue(parking_target);
+        }
+        if (_spindle_overlap) {
+            bool moving = start();
+            log_debug("Spin down while parking");
+            spindle->spinDown();
+            gc_ovr_changed();
+            if (moving) {
+                finish();
+            }
+        } else {
+            run();
         }
     } else {
         log_debug("Spin down only");
@@ -134,13 +193,23 @@ void Parking::park(bool restart) {
 void Parking::unpark(bool restart) {
     // Execute fast restore motion to the pull-out position. Parking requires homing enabled.
     // NOTE: State is will remain DOOR, until the de-energizing and retract is complete.
+    // With spindle_overlap the spindle spins up during the return, so the segments of the
+    // return carry it as the program had it.
+    bool overlap = _spindle_overlap && !restart && gc_state.modal.spindle != SpindleState::Disable && !spindle->isRateAdjusted();
     if (can_park()) {
         // Check to ensure the motion doesn't move below pull-out position.
         if (parking_target[_axis] <= _target_mpos) {
             log_debug("Parking return to pullout position");
             parking_target[_axis] = retract_waypoint;
             plan_data.feed_rate   = _rate;
-            moveto(parking_target);
+            if (overlap) {
+                plan_data.spindle       = saved_spindle;
+                plan_data.spindle_speed = saved_spindle_speed;
+                queue(parking_target);
+                overlap = start();
+            } else {
+                moveto(parking_target);
+            }
         }
     }
 
@@ -165,6 +234,10 @@ void Parking::unpark(bool restart) {
             gc_ovr_changed();
         }
     }
+    if (overlap) {
+        finish();
+        clear_accessories();
+    }
 
     // Execute slow plunge motion from pull-out position to resume position.
     if (can_park()) {
@@ -197,4 +270,5 @@ void Parking::group(Configuration::HandlerBase& handler) {
     handler.item("rate_mm_per_min", _rate);
     handler.item("pullout_distance_mm", _pullout, 0, 3e38);
     handler.item("pullout_rate_mm_per_min", _pullout_rate);
+    handler.item("spindle_overlap", _spindle_overlap);
 }
@@ -22,6 +22,10 @@ private:
     float _pullout_rate = 250.0;
     int   _axis         = 2;  // Default to Z
 
+    // Spin the spindle down during the pullout and up during the return, instead of stopping
+    // the motion for the spindle delays
+    bool _spindle_overlap = false;
+
     // local variables
     float parking_target[MAX_N_AXIS];
     float restore_target[MAX_N_AXIS];
@@ -35,7 +39,15 @@ private:
 
     plan_block_t* block;
 
+    bool _queued  = false;  // Motions planned and not started
+    bool _running = false;  // Motions started and not waited for
+
+    void queue(float* target);
+    bool start();
+    void finish();
+    void run();
     void moveto(float* target);
+    void clear_accessories();
 
     bool can_park();
 
@@ -11,6 +11,7 @@
 #include "Pins/VoidPinDetail.h"
 #include "Pins/I2SOPinDetail.h"
 #include "Pins/ChannelPinDetail.h"
+#include "Pins/ModbusIOPinDetail.h"
 #include "Pins/ErrorPinDetail.h"
 #include "string_util.h"
 #include "Machine/MachineConfig.h"  // config
@@ -84,6 +85,21 @@ const char* Pin::parse(std::string_view pin_str, Pins::PinDetail*& pinImplementa
         return nullptr;
     }
 
+    if (string_util::starts_with_ignore_case(pin_type, "modbus_io")) {
+        auto num_str    = pin_type.substr(strlen("modbus_io"));
+        int  device_num = -1;
+        std::from_chars(num_str.data(), num_str.data() + num_str.size(), device_num);
+        if (device_num < 0 || device_num >= ModbusIO::MAX_DEVICES) {
+            return "Bad modbus_io device number";
+        }
+        if (pin_number >= uint32_t(ModbusIO::MAX_POINTS)) {
+            return "Bad modbus_io point number";
+        }
+
+        pinImplementation = new Pins::ModbusIOPinDetail(device_num, pin_number, parser);
+        return nullptr;
+    }
+
     if (string_util::equal_ignore_case(pin_type, "no_pin")) {
         pinImplementation = undefinedPin;
         return nullptr;
@@ -132,6 +132,7 @@ public:
 
     static Pin Error() { return Pin(errorPin); }
 
+    bool canEvent() { return _detail->canEvent(); }
     void registerEvent(InputPin* obj) { _detail->registerEvent(obj); };
 
     // Other functions:
@@ -28,6 +28,7 @@ namespace Pins {
         void          setDuty(uint32_t duty) override;
         uint32_t      maxDuty() override;
 
+        bool canEvent() override { return true; }
         void registerEvent(InputPin* obj) override;
 
         std::string toString() override;
@@ -60,6 +60,8 @@ namespace Pins {
                 setDriveStrength(2, PinAttributes::DS2);
             } else if (opt.is("ds3")) {
                 setDriveStrength(3, PinAttributes::DS3);
+            } else if (opt.is("mcpwm")) {
+                _mcpwm = true;
             } else {
                 Assert(false, "Bad GPIO option passed to pin %d: %.*s", int(index), static_cast<int>(opt().length()), opt().data());
             }
@@ -113,7 +115,7 @@ namespace Pins {
         _attributes = _attributes | value;
 
         if (value.has(PinAttributes::PWM)) {
-            _pwm = new PwmPin(_index, _attributes.has(PinAttributes::ActiveLow), frequency);
+            _pwm = new PwmPin(_index, _attributes.has(PinAttributes::ActiveLow), frequency, _mcpwm);
             // _pwm->setDuty(0);  // Unnecessary since new PwmPins start at 0 duty
             return;
         }
@@ -179,6 +181,9 @@ namespace Pins {
         if (_attributes.has(PinAttributes::DS3)) {
             s += ":ds3";
         }
+        if (_mcpwm) {
+            s += ":mcpwm";
+        }
 
         return s;
     }
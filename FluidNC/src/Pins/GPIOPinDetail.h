@@ -21,6 +21,7 @@ namespace Pins {
         PwmPin*     _pwm;
 
         int8_t _driveStrength = -1;
+        bool   _mcpwm         = false;  // :mcpwm, PWM from an MCPWM timer instead of LEDC
 
         void setDriveStrength(int n, PinAttributes attr);
 
@@ -44,6 +45,7 @@ namespace Pins {
 
         bool canStep() override { return true; }
 
+        bool canEvent() override { return true; }
         void registerEvent(InputPin* obj) override;
 
         std::string toString() override;
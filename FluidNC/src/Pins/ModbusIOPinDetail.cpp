@@ -0,0 +1,70 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "ModbusIOPinDetail.h"
+
+#include "../Assert.h"
+
+namespace Pins {
+    ModbusIOPinDetail::ModbusIOPinDetail(int device, int number, const PinOptionsParser& options) :
+        PinDetail(number), _device(device) {
+        for (auto opt : options) {
+            if (opt.is("low")) {
+                setAttr(PinAttributes::ActiveLow);
+            } else if (opt.is("high")) {
+                // Default: Active HIGH.
+            }
+        }
+    }
+
+    PinCapabilities ModbusIOPinDetail::capabilities() const {
+        return PinCapabilities::Output | PinCapabilities::Input | PinCapabilities::PWM | PinCapabilities::Void;
+    }
+
+    void IRAM_ATTR ModbusIOPinDetail::write(int high) {
+        ModbusIO::set_coil(_device, _index, bool(high) != _attributes.has(PinAttributes::ActiveLow));
+    }
+    uint32_t ModbusIOPinDetail::maxDuty() {
+        return ModbusIO::_points[_device].register_max;
+    }
+    void IRAM_ATTR ModbusIOPinDetail::setDuty(uint32_t duty) {
+        ModbusIO::set_register(_device, _index, duty);
+    }
+
+    int ModbusIOPinDetail::read() {
+        auto&    points = ModbusIO::_points[_device];
+        uint32_t bits   = _attributes.has(PinAttributes::Input) ? points.inputs.load() : points.coils.load();
+        return bool(bits & (1u << _index)) != _attributes.has(PinAttributes::ActiveLow);
+    }
+    void ModbusIOPinDetail::setAttr(PinAttributes attr, uint32_t frequency) {
+        _attributes = _attributes | attr;
+
+        Assert(!_attributes.has(PinAttributes::PWM) || _index < ModbusIO::MAX_REGISTERS,
+               "modbus_io%d.%d: analog outputs are numbered below %d",
+               _device,
+               _index,
+               ModbusIO::MAX_REGISTERS);
+
+        // Pin events report the active state, so the bus task needs the polarity
+        if (_attributes.has(PinAttributes::Input) && _attributes.has(PinAttributes::ActiveLow)) {
+            ModbusIO::_points[_device].inverted |= 1u << _index;
+        }
+    }
+    PinAttributes ModbusIOPinDetail::getAttr() const {
+        return _attributes;
+    }
+    std::string ModbusIOPinDetail::toString() {
+        std::string s = "modbus_io";
+        s += std::to_string(_device);
+        s += ".";
+        s += std::to_string(_index);
+        if (_attributes.has(PinAttributes::ActiveLow)) {
+            s += ":low";
+        }
+        return s;
+    }
+
+    void ModbusIOPinDetail::registerEvent(InputPin* obj) {
+        ModbusIO::_points[_device].events[_index] = obj;
+    }
+}
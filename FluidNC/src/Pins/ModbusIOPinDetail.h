@@ -0,0 +1,37 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include "PinDetail.h"
+#include "PinOptionsParser.h"
+#include "src/ModbusIO.h"  // ModbusIO::MAX_POINTS
+
+namespace Pins {
+    // A point of a Modbus I/O block, see ModbusIO.h
+    class ModbusIOPinDetail : public PinDetail {
+    private:
+        int           _device;
+        PinAttributes _attributes;
+
+    public:
+        ModbusIOPinDetail(int device, int number, const PinOptionsParser& options);
+
+        PinCapabilities capabilities() const override;
+
+        // I/O:
+        void          write(int high) override;
+        int           read() override;
+        void          setAttr(PinAttributes value, uint32_t frequency = 0) override;
+        PinAttributes getAttr() const override;
+        void          setDuty(uint32_t duty) override;
+        uint32_t      maxDuty() override;
+
+        bool canEvent() override { return true; }
+        void registerEvent(InputPin* obj) override;
+
+        std::string toString() override;
+
+        ~ModbusIOPinDetail() override {}
+    };
+}
@@ -43,6 +43,7 @@ namespace Pins {
 
         virtual bool canStep() { return false; }
 
+        virtual bool canEvent() { return false; }  // registerEvent() is supported
         virtual void registerEvent(InputPin* obj);
 
         virtual std::string toString() = 0;
@@ -11,21 +11,55 @@
 #include "Planner.h"
 #include "Machine/MachineConfig.h"
 #include "SCurve.h"
+#include "PlannerPasses.h"
+#include "LineLatency.h"
+#include "Raster.h"
+#include "Driver/psram.h"
 
 #include <cstdlib>  // PSoc Required for labs
 #include <cmath>
 
-static plan_block_t* block_buffer = nullptr;  // A ring buffer for motion instructions
-static uint8_t       block_buffer_tail;       // Index of the block to process now
-static uint8_t       block_buffer_head;       // Index of the next block to be pushed
-static uint8_t       next_buffer_head;        // Index of the next buffer head
-static uint8_t       block_buffer_planned;    // Index of the optimally planned block
+static plan_block_t*     block_buffer = nullptr;  // A ring buffer for motion instructions
+static plan_block_aux_t* block_aux    = nullptr;  // Side table of per-block data, parallel to block_buffer
+static plan_index_t  block_buffer_tail;       // Index of the block to process now
+static plan_index_t  block_buffer_head;       // Index of the next block to be pushed
+static plan_index_t  next_buffer_head;        // Index of the next buffer head
+static plan_index_t  block_buffer_planned;    // Index of the optimally planned block
+static uint32_t      blocks_pushed = 0;       // Blocks ever added, for plan_blocks_pushed()
+static uint32_t      blocks_done   = 0;       // Blocks ever discarded or flushed
+
+// System motions, for homing and parking, are planned in slots after the ring, so that they
+// can run while the ring holds a program that is on hold.  Parking plans a few ahead, as a
+// sequence that runs without stopping where the path goes straight on.
+static const plan_index_t system_motion_blocks = 2;
+static plan_index_t       system_count         = 0;      // Blocks in the sequence
+static plan_index_t       system_index         = 0;      // The one the segment generator is on
+static bool               system_started       = false;  // The segment generator has taken one
+static int32_t            system_position[MAX_N_AXIS];   // Where the sequence ends, in steps
 
 void plan_init() {
     if (block_buffer) {
         delete[] block_buffer;
     }
-    block_buffer = new plan_block_t[config->_planner_blocks];
+    if (block_aux) {
+        free(block_aux);
+        block_aux = nullptr;
+    }
+    // The hot block records always stay in internal RAM because the planner passes and
+    // the segment generator walk them constantly.  The side table is touched once per
+    // block, so it can live in the slower external PSRAM when the config asks for it.
+    size_t n_blocks = config->_planner_blocks + system_motion_blocks;
+    size_t aux_size = n_blocks * sizeof(plan_block_aux_t);
+    if (config->_planner_psram) {
+        block_aux = static_cast<plan_block_aux_t*>(psram_malloc(aux_size));
+        if (!block_aux) {
+            log_warn("No PSRAM for planner; using internal RAM");
+        }
+    }
+    if (!block_aux) {
+        block_aux = static_cast<plan_block_aux_t*>(malloc(aux_size));
+    }
+    block_buffer = new plan_block_t[n_blocks];
 }
 
 // Define planner variables
@@ -33,13 +67,20 @@ typedef struct {
     int32_t position[MAX_N_AXIS];  // The planner position of the tool in absolute steps. Kept separate
     // from g-code position for movements requiring multiple line motions,
     // i.e. arcs, canned cycles, and backlash compensation.
-    float previous_unit_vec[MAX_N_AXIS];  // Unit vector of previous path line segment
-    float previous_nominal_speed;         // Nominal speed of previous path line segment
+    float     previous_unit_vec[MAX_N_AXIS];  // Unit vector of previous path line segment
+    float     previous_nominal_speed;         // Nominal speed of previous path line segment
+    float     s_curve_run_mm;                 // Length of the current S-curve run, zero if none
+    float     s_curve_run_entry_speed;        // Entry speed of the first block in the S-curve run (mm/min)
+    AxisMask  backlash_negative;              // Backlash state after the last planned block, see plan_buffer_line()
+    plan_io_t pending_io;                     // Output changes waiting for the next motion block
+    bool      previous_sync;                  // The last block was spindle-synchronized
+    bool      previous_dwell;                 // The last block was a dwell
+    uint32_t  raster_end;                     // Raster position after the last scanline given to a block
 } planner_t;
 static planner_t pl;
 
 // Returns the index of the next block in the ring buffer. Also called by stepper segment buffer.
-static uint8_t plan_next_block_index(uint8_t block_index) {
+static plan_index_t plan_next_block_index(plan_index_t block_index) {
     block_index++;
     if (block_index == config->_planner_blocks) {
         block_index = 0;
@@ -48,7 +89,7 @@ static uint8_t plan_next_block_index(uint8_t block_index) {
 }
 
 // Returns the index of the previous block in the ring buffer
-static uint8_t plan_prev_block_index(uint8_t block_index) {
+static plan_index_t plan_prev_block_index(plan_index_t block_index) {
     if (block_index == 0) {
         block_index = config->_planner_blocks;
     }
@@ -120,108 +161,103 @@ static uint8_t plan_prev_block_index(uint8_t block_index) {
   to compute an optimal plan, so select carefully. The Arduino 328p memory is already maxed out, but future
   ARM versions should have enough memory and speed for look-ahead blocks numbering up to a hundred or more.
 
+  INCREMENTAL REPLANNING: Appending a block can only raise the reverse-pass entry speeds of the blocks
+  before it, and for every block after the planned pointer the stored entry speed is exactly its reverse-pass
+  value. So when a recomputed entry speed comes out unchanged (or the block is already at its maximum), no
+  earlier block can change either, and the reverse pass stops there. The forward pass then resumes from that
+  block instead of the planned pointer, since nothing before it moved. This gives the same plan as the full
+  pass, but for streaming moves the work per new block is proportional to how far the change propagates,
+  not to the buffer depth.
+    For very deep buffers, config->_planner_replan_limit optionally caps the number of blocks the reverse
+  pass may revisit per new block. Truncating the reverse pass only leaves earlier blocks at lower, still
+  feasible entry speeds; later insertions continue raising them. A full recompute (feed hold, overrides)
+  ignores both shortcuts, because max_entry_speed_sqr may have decreased and stored speeds must be lowered.
 */
-static void planner_recalculate() {
-    if (block_buffer_head == block_buffer_tail) {
-        // Nothing to do; planner buffer is empty.
-        return;
-    }
-    // Initialize block index to the last block in the planner buffer.
-    uint8_t block_index = plan_prev_block_index(block_buffer_head);
-    // Bail. Can't do anything with one only one plan-able block.
-    if (block_index == block_buffer_planned) {
-        return;
-    }
-    // Reverse Pass: Coarsely maximize all possible deceleration curves back-planning from the last
-    // block in buffer. Cease planning when the last optimal planned or tail pointer is reached.
-    // NOTE: Forward pass will later refine and correct the reverse pass to create an optimal plan.
-    float         entry_speed_sqr;
-    plan_block_t* next;
-    plan_block_t* current = &block_buffer[block_index];
-    // Calculate maximum entry speed for last block in buffer, where the exit speed is always zero.
-    current->entry_speed_sqr = MIN(current->max_entry_speed_sqr, 2 * current->acceleration * current->millimeters);
-    block_index              = plan_prev_block_index(block_index);
-    if (block_index == block_buffer_planned) {  // Only two plannable blocks in buffer. Reverse pass complete.
-        // Check if the first block is the tail. If so, notify stepper to update its current parameters.
-        if (block_index == block_buffer_tail) {
-            Stepper::update_plan_block_parameters();
-        }
-    } else {  // Three or more plan-able blocks
-        while (block_index != block_buffer_planned) {
-            next        = current;
-            current     = &block_buffer[block_index];
-            block_index = plan_prev_block_index(block_index);
-            // Check if next block is the tail block(=planned block). If so, update current stepper parameters.
-            if (block_index == block_buffer_tail) {
-                Stepper::update_plan_block_parameters();
-            }
-            // Compute maximum entry speed decelerating over the current block from its exit speed.
-            if (current->entry_speed_sqr != current->max_entry_speed_sqr) {
-                entry_speed_sqr = next->entry_speed_sqr + 2 * current->acceleration * current->millimeters;
-                if (entry_speed_sqr < current->max_entry_speed_sqr) {
-                    current->entry_speed_sqr = entry_speed_sqr;
-                } else {
-                    current->entry_speed_sqr = current->max_entry_speed_sqr;
-                }
-            }
-        }
-    }
-    // Forward Pass: Forward plan the acceleration curve from the planned pointer onward.
-    // Also scans for optimal plan breakpoints and appropriately updates the planned pointer.
-    next        = &block_buffer[block_buffer_planned];  // Begin at buffer planned pointer
-    block_index = plan_next_block_index(block_buffer_planned);
-    while (block_index != block_buffer_head) {
-        current = next;
-        next    = &block_buffer[block_index];
-        // Any acceleration detected in the forward pass automatically moves the optimal planned
-        // pointer forward, since everything before this is all optimal. In other words, nothing
-        // can improve the plan from the buffer tail to the planned pointer by logic.
-        if (current->entry_speed_sqr < next->entry_speed_sqr) {
-            entry_speed_sqr = current->entry_speed_sqr + 2 * current->acceleration * current->millimeters;
-            // If true, current block is full-acceleration and we can move the planned pointer forward.
-            if (entry_speed_sqr < next->entry_speed_sqr) {
-                next->entry_speed_sqr = entry_speed_sqr;  // Always <= max_entry_speed_sqr. Backward pass sets this.
-                block_buffer_planned  = block_index;      // Set optimal plan pointer.
-            }
-        }
-        // Any block set at its maximum entry speed also creates an optimal plan up to this
-        // point in the buffer. When the plan is bracketed by either the beginning of the
-        // buffer and a maximum entry speed or two maximum entry speeds, every block in between
-        // cannot logically be further improved. Hence, we don't have to recompute them anymore.
-        if (next->entry_speed_sqr == next->max_entry_speed_sqr) {
-            block_buffer_planned = block_index;
-        }
-        block_index = plan_next_block_index(block_index);
-    }
+static void planner_recalculate(bool full_replan = false) {
+    planner_passes(block_buffer,
+                   config->_planner_blocks,
+                   block_buffer_tail,
+                   block_buffer_head,
+                   block_buffer_planned,
+                   full_replan,
+                   config->_planner_replan_limit,
+                   Stepper::update_plan_block_parameters);
 }
 
 void plan_reset() {
+    Stepper::prep_lock();
     memset(&pl, 0, sizeof(planner_t));  // Clear planner struct
+    Raster::reset();
     plan_reset_buffer();
+    system_count   = 0;
+    system_index   = 0;
+    system_started = false;
+    Stepper::prep_unlock();
 }
 
 void plan_reset_buffer() {
+    Stepper::prep_lock();
     block_buffer_tail    = 0;
     block_buffer_head    = 0;  // Empty = tail
     next_buffer_head     = 1;  // plan_next_block_index(block_buffer_head)
     block_buffer_planned = 0;  // = block_buffer_tail;
+    blocks_done          = blocks_pushed;
+    Stepper::prep_unlock();
+}
+
+void plan_sync_digital_output(size_t io_num, bool on) {
+    if (on) {
+        set_bitnum(pl.pending_io.digital_on, io_num);
+        clear_bitnum(pl.pending_io.digital_off, io_num);
+    } else {
+        set_bitnum(pl.pending_io.digital_off, io_num);
+        clear_bitnum(pl.pending_io.digital_on, io_num);
+    }
+}
+
+void plan_sync_analog_output(size_t io_num, uint32_t duty) {
+    set_bitnum(pl.pending_io.analog, io_num);
+    pl.pending_io.analog_duty[io_num] = duty;
+}
+
+void plan_sync_raster(const uint8_t* pixels, size_t count) {
+    Raster::append(pixels, count);
+}
+
+size_t plan_raster_pending() {
+    return Raster::head - pl.raster_end;
 }
 
 // Called from stepper pulse function when the block is complete
 void plan_discard_current_block() {
     if (block_buffer_head != block_buffer_tail) {  // Discard non-empty buffer.
-        uint8_t block_index = plan_next_block_index(block_buffer_tail);
+        plan_index_t block_index = plan_next_block_index(block_buffer_tail);
         // Push block_buffer_planned pointer, if encountered.
         if (block_buffer_tail == block_buffer_planned) {
             block_buffer_planned = block_index;
         }
         block_buffer_tail = block_index;
+        ++blocks_done;
     }
 }
 
 // Returns address of planner buffer block used by system motions. Called by segment generator.
 plan_block_t* plan_get_system_motion_block() {
-    return &block_buffer[block_buffer_head];
+    system_started = true;
+    return system_index < system_count ? &block_buffer[config->_planner_blocks + system_index] : NULL;
+}
+
+float plan_get_system_motion_exit_speed_sqr() {
+    plan_index_t next = system_index + 1;
+    return next < system_count ? block_buffer[config->_planner_blocks + next].entry_speed_sqr : 0.0f;
+}
+
+bool plan_next_system_motion_block() {
+    if (system_index + 1 < system_count) {
+        ++system_index;
+        return true;
+    }
+    return false;
 }
 
 // Returns address of first planner block, if available. Called by various main program functions.
@@ -232,8 +268,12 @@ plan_block_t* plan_get_current_block() {
     return &block_buffer[block_buffer_tail];
 }
 
+plan_block_aux_t* plan_get_block_aux(const plan_block_t* block) {
+    return &block_aux[block - block_buffer];
+}
+
 float plan_get_exec_block_exit_speed_sqr() {
-    uint8_t block_index = plan_next_block_index(block_buffer_tail);
+    plan_index_t block_index = plan_next_block_index(block_buffer_tail);
     if (block_index == block_buffer_head) {
         return 0.0f;
     }
@@ -253,7 +293,7 @@ float plan_compute_profile_nominal_speed(plan_block_t* block) {
         nominal_speed *= (0.01f * sys.r_override);
     } else {
         if (!(block->motion.noFeedOverride)) {
-            nominal_speed *= (0.01f * sys.f_override);
+            nominal_speed *= (0.01f * sys.f_override) * (0.01f * sys.f_adaptive);
         }
         if (nominal_speed > block->rapid_rate) {
             nominal_speed = block->rapid_rate;
@@ -282,7 +322,8 @@ static void plan_compute_profile_parameters(plan_block_t* block, float nominal_s
 
 // Re-calculates buffered motions profile parameters upon a motion-based override change.
 void plan_update_velocity_profile_parameters() {
-    uint8_t       block_index = block_buffer_tail;
+    Stepper::prep_lock();
+    plan_index_t  block_index = block_buffer_tail;
     plan_block_t* block;
     float         nominal_speed;
     float         prev_nominal_speed = SOME_LARGE_VALUE;  // Set high for first block nominal speed calculation.
@@ -297,61 +338,116 @@ void plan_update_velocity_profile_parameters() {
     if (block_buffer_tail != block_buffer_head) {
         plan_cycle_reinitialize();
     }
+    Stepper::prep_unlock();
 }
 
-bool plan_buffer_line(float* target, plan_line_data_t* pl_data) {
-    // Prepare and initialize new block. Copy relevant pl_data for block execution.
-    plan_block_t* block = &block_buffer[block_buffer_head];
-    memset(block, 0, sizeof(plan_block_t));  // Zero all block values.
-    block->motion        = pl_data->motion;
-    block->coolant       = pl_data->coolant;
-    block->spindle       = pl_data->spindle;
-    block->spindle_speed = pl_data->spindle_speed;
-    block->line_number   = pl_data->line_number;
-    block->is_jog        = pl_data->is_jog;
+// Computes the S-curve profile of a newly added block.  Blocks joined by smooth junctions at the same
+// nominal speed form a run that shares one profile over the combined distance; the segment generator
+// carries the phase state from block to block through the run instead of restarting it.
+// Block S-curve data was zeroed with the block, so use_s_curve stays false unless a profile is found.
+static void plan_compute_s_curve(plan_block_t* block, plan_block_aux_t* aux, float nominal_speed, bool smooth_junction) {
+    if (block->max_jerk <= 0.0f) {
+        pl.s_curve_run_mm = 0.0f;
+        return;
+    }
 
-    // Compute and store initial move distance data.
-    int32_t target_steps[MAX_N_AXIS], position_steps[MAX_N_AXIS];
-    float   unit_vec[MAX_N_AXIS], delta_mm;
-    // Copy position data based on type of motion being planned.
-    if (block->motion.systemMotion) {
-        get_motor_steps(position_steps);
+    bool continues_run = smooth_junction && pl.s_curve_run_mm > 0.0f && fabsf(nominal_speed - pl.previous_nominal_speed) <= 0.01f * nominal_speed;
+    if (continues_run) {
+        pl.s_curve_run_mm += block->millimeters;
     } else {
-        if (!block->is_jog && Homing::unhomed_axes()) {
-            log_info("Unhomed axes: " << Axes::maskToNames(Homing::unhomed_axes()));
-            send_alarm(ExecAlarm::Unhomed);
-            return false;
+        pl.s_curve_run_mm          = block->millimeters;
+        pl.s_curve_run_entry_speed = sqrtf(block->entry_speed_sqr);
+    }
+
+    if (!should_use_s_curve(pl.s_curve_run_mm, block->max_jerk, block->acceleration)) {
+        return;
+    }
+
+    float entry_speed = pl.s_curve_run_entry_speed;
+    float exit_speed  = 0.0f;  // For now, assume exit speed is 0 (will be refined by planner recalculation)
+
+    // Use fast calculation for small moves or when speeds are similar
+    bool use_fast_calc = (pl.s_curve_run_mm < 50.0f) || (fabsf(entry_speed - exit_speed) < 100.0f);
+
+    SCurveProfile profile = calculate_s_curve_cached(use_fast_calc,
+                                                     pl.s_curve_run_mm,
+                                                     entry_speed,
+                                                     exit_speed,
+                                                     nominal_speed,
+                                                     block->acceleration / 3600.0f,  // Convert mm/min^2 to mm/sec^2
+                                                     block->max_jerk / 216000.0f     // Convert mm/min^3 to mm/sec^3
+    );
+
+    if (profile.valid) {
+        block->use_s_curve = true;
+        block->s_curve_run = continues_run;
+        for (int i = 0; i < 7; i++) {
+            aux->s_curve_phases[i]    = profile.T[i];
+            aux->s_curve_distances[i] = profile.S[i];
         }
-        copyAxes(position_steps, pl.position);
     }
+}
+
+// Adds a system motion block to the sequence.  It continues from the one before at the lower
+// of their rates if the path goes straight on.  The sequence is short and starts and ends at
+// rest, so it is replanned whole: backward so that every block can stop at the end, forward
+// so that every block can reach its entry speed from the start.
+static void plan_queue_system_block(plan_block_t* block, float* entry_unit_vec, float* exit_unit_vec, int32_t* target_steps) {
+    static float previous_unit_vec[MAX_N_AXIS];
+
     auto n_axis = Axes::_numberAxis;
-    for (size_t idx = 0; idx < n_axis; idx++) {
-        // Calculate target position in absolute steps, number of steps for each axis, and determine max step events.
-        // Also, compute individual axes distance for move and prep unit vector calculations.
-        // NOTE: Computes true distance from converted step values.
-        target_steps[idx]       = mpos_to_steps(target[idx], idx);
-        block->steps[idx]       = labs(target_steps[idx] - position_steps[idx]);
-        block->step_event_count = MAX(block->step_event_count, block->steps[idx]);
-        delta_mm                = steps_to_mpos((target_steps[idx] - position_steps[idx]), idx);
-        unit_vec[idx]           = delta_mm;  // Store unit vector numerator
-        // Set direction bits. Bit enabled always means direction is negative.
-        if (delta_mm < 0.0) {
-            block->direction_bits |= bitnum_to_mask(idx);
+    auto first  = &block_buffer[config->_planner_blocks];
+    if (system_count) {
+        float cos_theta = 0.0f;
+        for (size_t idx = 0; idx < n_axis; idx++) {
+            cos_theta += previous_unit_vec[idx] * entry_unit_vec[idx];
+        }
+        if (cos_theta > 0.999f) {
+            float speed                = MIN(plan_compute_profile_nominal_speed(block), plan_compute_profile_nominal_speed(block - 1));
+            block->max_entry_speed_sqr = speed * speed;
         }
     }
-    // Bail if this is a zero-length block. Highly unlikely to occur.
-    if (block->step_event_count == 0) {
-        return false;
+    copyAxes(previous_unit_vec, exit_unit_vec);
+    copyAxes(system_position, target_steps);
+
+    Stepper::prep_lock();
+    ++system_count;
+    float exit_speed_sqr = 0.0f;
+    for (plan_index_t i = system_count; i-- > 0;) {
+        plan_block_t* b    = &first[i];
+        b->entry_speed_sqr = MIN(b->max_entry_speed_sqr, exit_speed_sqr + 2 * b->acceleration * b->millimeters);
+        exit_speed_sqr     = b->entry_speed_sqr;
+    }
+    for (plan_index_t i = 1; i < system_count; i++) {
+        plan_block_t* prev       = &first[i - 1];
+        first[i].entry_speed_sqr = MIN(first[i].entry_speed_sqr, prev->entry_speed_sqr + 2 * prev->acceleration * prev->millimeters);
     }
+    Stepper::prep_unlock();
+}
 
-    // Calculate the unit vector of the line move and the block maximum feed rate and acceleration scaled
-    // down such that no individual axes maximum values are exceeded with respect to the line direction.
-    // NOTE: This calculation assumes all axes are orthogonal (Cartesian) and works with ABC-axes,
-    // if they are also orthogonal/independent. Operates on the absolute value of the unit vector.
-    block->millimeters  = convert_delta_vector_to_unit_vector(unit_vec);
-    block->acceleration = limit_acceleration_by_axis_maximum(unit_vec);
-    block->max_jerk     = limit_jerk_by_axis_maximum(unit_vec);
-    block->rapid_rate   = limit_rate_by_axis_maximum(unit_vec);
+// Finishes a new block whose distance, direction data and axis limits are set: applies the
+// programmed rate, computes the junction speed with the previous block, plans the block's
+// profile and queues it.  entry_unit_vec and exit_unit_vec are the path directions at the
+// start and the end of the block, which differ only for arcs.
+static void plan_queue_block(plan_block_t*     block,
+                             plan_block_aux_t* aux,
+                             plan_line_data_t* pl_data,
+                             float*            entry_unit_vec,
+                             float*            exit_unit_vec,
+                             int32_t*          target_steps) {
+    auto n_axis = Axes::_numberAxis;
+    // Output changes queued since the last motion take effect when this block starts
+    if (!block->motion.systemMotion && !block->is_jog) {
+        aux->io = pl.pending_io;
+        memset(&pl.pending_io, 0, sizeof(plan_io_t));
+    }
+    // So does a queued scanline, for a linear feed motion
+    aux->raster.start = pl.raster_end;
+    if (!block->motion.systemMotion && !block->is_jog && !block->motion.rapidMotion && !block->is_arc) {
+        aux->raster.length      = Raster::head - pl.raster_end;
+        aux->raster.millimeters = block->millimeters;
+        pl.raster_end           = Raster::head;
+    }
     // Store programmed rate.
     if (block->motion.rapidMotion) {
         block->programmed_rate = block->rapid_rate;
@@ -361,10 +457,15 @@ bool plan_buffer_line(float* target, plan_line_data_t* pl_data) {
             block->programmed_rate *= block->millimeters;
         }
     }
+    // True if the junction with the previous block is gentle enough to continue an S-curve run
+    bool smooth_junction = false;
     // TODO: Need to check this method handling zero junction speeds when starting from rest.
-    if ((block_buffer_head == block_buffer_tail) || (block->motion.systemMotion)) {
+    bool sync = aux->spindle_sync > 0.0f;
+    if ((block_buffer_head == block_buffer_tail) || (block->motion.systemMotion) || sync || pl.previous_sync || pl.previous_dwell) {
         // Initialize block entry speed as zero. Assume it will be starting from rest. Planner will correct this later.
         // If system motion, the system motion block always is assumed to start from rest and end at a complete stop.
+        // A spindle-synchronized block starts from rest at a spindle index pulse and ends at rest.
+        // So does a block after a dwell.
         block->entry_speed_sqr        = 0.0;
         block->max_junction_speed_sqr = 0.0;  // Starting from rest. Enforce start from zero velocity.
     } else {
@@ -392,9 +493,10 @@ bool plan_buffer_line(float* target, plan_line_data_t* pl_data) {
         float junction_unit_vec[MAX_N_AXIS];
         float junction_cos_theta = 0.0;
         for (size_t idx = 0; idx < n_axis; idx++) {
-            junction_cos_theta -= pl.previous_unit_vec[idx] * unit_vec[idx];
-            junction_unit_vec[idx] = unit_vec[idx] - pl.previous_unit_vec[idx];
+            junction_cos_theta -= pl.previous_unit_vec[idx] * entry_unit_vec[idx];
+            junction_unit_vec[idx] = entry_unit_vec[idx] - pl.previous_unit_vec[idx];
         }
+        smooth_junction = junction_cos_theta < -S_CURVE_RUN_COS_THETA;
         // NOTE: Computed without any expensive trig, sin() or acos(), by trig half angle identity of cos(theta).
         if (junction_cos_theta > 0.999999) {
             //  For a 0 degree acute junction, just set minimum junction speed.
@@ -412,15 +514,16 @@ bool plan_buffer_line(float* target, plan_line_data_t* pl_data) {
                 // Calculate base junction speed
                 float base_junction_speed_sqr = (junction_acceleration * config->_junctionDeviation * sin_theta_d2) / (1.0f - sin_theta_d2);
                 
-                // If S-curve is enabled, adjust junction speed considering jerk limits
-                if (junction_jerk > 0.0f) {
+                // If S-curve is enabled, adjust junction speed considering jerk limits.  A smooth junction
+                // inside an S-curve run does not change speed, so the run profile already bounds the jerk.
+                if (junction_jerk > 0.0f && !(smooth_junction && pl.s_curve_run_mm > 0.0f)) {
                     // Calculate S-curve aware junction velocity
                     float prev_distance = 0.0f;
                     float curr_distance = block->millimeters;
                     
                     // Get previous block distance if available
                     if (block_buffer_head != block_buffer_tail) {
-                        uint8_t prev_index = plan_prev_block_index(block_buffer_head);
+                        plan_index_t prev_index = plan_prev_block_index(block_buffer_head);
                         plan_block_t* prev_block = &block_buffer[prev_index];
                         prev_distance = prev_block->millimeters;
                     }
@@ -447,63 +550,456 @@ bool plan_buffer_line(float* target, plan_line_data_t* pl_data) {
         float nominal_speed = plan_compute_profile_nominal_speed(block);
         plan_compute_profile_parameters(block, nominal_speed, pl.previous_nominal_speed);
         
-        // Initialize S-curve profile data
-        block->use_s_curve = false;
-        for (int i = 0; i < 7; i++) {
-            block->s_curve_phases[i] = 0.0f;
-            block->s_curve_distances[i] = 0.0f;
-        }
-        
-        // Calculate S-curve profile if jerk is enabled
-        if (block->max_jerk > 0.0f && should_use_s_curve(block->millimeters, block->max_jerk, block->acceleration)) {
-            // Get entry and exit speeds for this block
-            float entry_speed = sqrtf(block->entry_speed_sqr);
-            float exit_speed = 0.0f; // For now, assume exit speed is 0 (will be refined by planner recalculation)
-            
-            // Use fast calculation for small moves or when speeds are similar
-            bool use_fast_calc = (block->millimeters < 50.0f) || 
-                               (fabsf(entry_speed - exit_speed) < 100.0f);
-            
-            SCurveProfile profile;
-            if (use_fast_calc) {
-                profile = calculate_s_curve_fast(
-                    block->millimeters,
-                    entry_speed,
-                    exit_speed, 
-                    nominal_speed,
-                    block->acceleration / 3600.0f,  // Convert mm/min^2 to mm/sec^2
-                    block->max_jerk / 216000.0f     // Convert mm/min^3 to mm/sec^3
-                );
-            } else {
-                profile = calculate_s_curve_profile(
-                    block->millimeters,
-                    entry_speed,
-                    exit_speed, 
-                    nominal_speed,
-                    block->acceleration / 3600.0f,  // Convert mm/min^2 to mm/sec^2
-                    block->max_jerk / 216000.0f     // Convert mm/min^3 to mm/sec^3
-                );
-            }
-            
-            if (profile.valid) {
-                block->use_s_curve = true;
-                for (int i = 0; i < 7; i++) {
-                    block->s_curve_phases[i] = profile.T[i];
-                    block->s_curve_distances[i] = profile.S[i];
-                }
-            }
-        }
-        
+        plan_compute_s_curve(block, aux, nominal_speed, smooth_junction);
+        aux->latency_traced = LineLatency::planned();
+
         pl.previous_nominal_speed = nominal_speed;
+        pl.previous_sync          = sync;
+        pl.previous_dwell         = false;
         // Update previous path unit_vector and planner position.
-        copyAxes(pl.previous_unit_vec, unit_vec);
+        copyAxes(pl.previous_unit_vec, exit_unit_vec);
         copyAxes(pl.position, target_steps);
         // New block is all set. Update buffer head and next buffer head indices.
+        // The segment generator cannot see the new block until the head moves, so only
+        // publishing it and replanning need the prep lock.
+        Stepper::prep_lock();
         block_buffer_head = next_buffer_head;
         next_buffer_head  = plan_next_block_index(block_buffer_head);
+        ++blocks_pushed;
         // Finish up by recalculating the plan with the new block.
         planner_recalculate();
+        Stepper::prep_unlock();
+    } else {
+        plan_queue_system_block(block, entry_unit_vec, exit_unit_vec, target_steps);
+    }
+}
+
+// G64 corner rounding. Shortens the last queued block to end where a circle tangent to it and
+// to the new line to target begins, then queues chords along that circle to where the new line
+// will start. The circle is chosen to pass within blend_tolerance of the corner. The corner is
+// left sharp if the last block is already in the segment generator, is not a feed move, or
+// could no longer stop at its shortened end from its planned entry speed, since the planner
+// never lowers the entry speed of a block that the stepper may already be approaching.
+static void plan_blend_corner(float* target, plan_line_data_t* pl_data) {
+    if (pl_data->motion.rapidMotion || pl_data->motion.systemMotion || pl_data->motion.inverseTime || pl_data->is_jog) {
+        return;
+    }
+    // The corner is computed in the planner's motor positions, so they must be cartesian.
+    if (!config->_kinematics->native_arcs() || block_buffer_head == block_buffer_tail) {
+        return;
+    }
+    plan_index_t  prev_index = plan_prev_block_index(block_buffer_head);
+    plan_block_t* prev       = &block_buffer[prev_index];
+    if (prev->is_arc || prev->is_dwell || prev->is_jog || prev->motion.rapidMotion || prev->motion.systemMotion || prev->motion.inverseTime ||
+        block_aux[prev_index].spindle_sync > 0.0f) {
+        return;
+    }
+
+    auto   n_axis   = Axes::_numberAxis;
+    float* prev_vec = pl.previous_unit_vec;
+    float  corner[MAX_N_AXIS], line_vec[MAX_N_AXIS];
+    for (size_t idx = 0; idx < n_axis; idx++) {
+        corner[idx]   = steps_to_mpos(pl.position[idx], idx);
+        line_vec[idx] = target[idx] - corner[idx];
+    }
+    float line_mm = vector_length(line_vec, n_axis);
+    if (line_mm == 0.0f) {
+        return;
+    }
+    scale_vector(line_vec, 1.0f / line_mm, n_axis);
+
+    float cos_phi = 0.0f;  // Cosine of the turn angle phi
+    for (size_t idx = 0; idx < n_axis; idx++) {
+        cos_phi += prev_vec[idx] * line_vec[idx];
+    }
+    if (cos_phi > 0.999999f || cos_phi < -0.999f) {
+        return;  // Straight on, or a reversal too tight to gain anything from rounding
+    }
+
+    // A circle tangent to both moves at blend_mm from the corner passes within
+    // blend_mm * (1 - cos(phi/2)) / sin(phi/2) of it. Leave at least half of each move for
+    // the corner at its other end.
+    float sin_half = sqrtf(0.5f * (1.0f - cos_phi));
+    float cos_half = sqrtf(0.5f * (1.0f + cos_phi));
+    float blend_mm = pl_data->blend_tolerance * sin_half / (1.0f - cos_half);
+    blend_mm       = MIN(blend_mm, 0.5f * prev->millimeters);
+    blend_mm       = MIN(blend_mm, 0.5f * line_mm);
+    float radius   = blend_mm * cos_half / sin_half;
+    float phi      = 2.0f * atan2f(sin_half, cos_half);
+
+    // Chords as in mc_arc(), within arc_tolerance of the circle. The line needs a block too.
+    float tolerance = config->_arcTolerance;
+    int   segments  = 1;
+    if (2.0f * radius > tolerance) {
+        segments = int(ceilf(0.5f * phi * radius / sqrtf(tolerance * (2.0f * radius - tolerance))));
+    }
+    segments = MIN(segments, BLEND_MAX_SEGMENTS);
+    segments = MIN(segments, int(plan_get_block_buffer_available()) - 1);
+    if (segments < 1) {
+        return;
+    }
+
+    // Shortened last block, from its start to the beginning of the blend.
+    float    blend_start[MAX_N_AXIS];
+    int32_t  end_steps[MAX_N_AXIS];
+    uint32_t steps[MAX_N_AXIS];
+    float    delta_vec[MAX_N_AXIS];
+    uint32_t step_event_count = 0;
+    for (size_t idx = 0; idx < n_axis; idx++) {
+        bool    negative = bitnum_is_true(prev->direction_bits, idx);
+        int32_t start    = pl.position[idx] + (negative ? int32_t(prev->steps[idx]) : -int32_t(prev->steps[idx]));
+        blend_start[idx] = corner[idx] - blend_mm * prev_vec[idx];
+        end_steps[idx]   = mpos_to_steps(blend_start[idx], idx);
+        steps[idx]       = labs(end_steps[idx] - start);
+        step_event_count = MAX(step_event_count, steps[idx]);
+        delta_vec[idx]   = steps_to_mpos(end_steps[idx] - start, idx);
     }
+    float prev_mm = vector_length(delta_vec, n_axis);
+    if (step_event_count == 0) {
+        return;
+    }
+
+    Stepper::prep_lock();
+    bool editable = block_buffer_tail != block_buffer_head && block_buffer_tail != prev_index &&
+                    prev->entry_speed_sqr <= 2 * prev->acceleration * prev_mm;
+    if (editable) {
+        copyAxes(prev->steps, steps);
+        prev->step_event_count = step_event_count;
+        prev->millimeters      = prev_mm;
+        // The S-curve profile was planned for the full length; run the shortened block trapezoidal.
+        prev->use_s_curve = false;
+        prev->s_curve_run = false;
+        pl.s_curve_run_mm = 0.0f;
+        copyAxes(pl.position, end_steps);
+    }
+    Stepper::prep_unlock();
+    if (!editable) {
+        return;
+    }
+
+    // Chords along the circle, which starts at blend_start heading along prev_vec and curves
+    // toward line_vec. The last one ends exactly where the new line begins.
+    plan_line_data_t chord_data = *pl_data;
+    chord_data.blend_tolerance  = 0.0f;
+    float sin_phi               = 2.0f * sin_half * cos_half;
+    for (int i = 1; i <= segments; i++) {
+        float point[MAX_N_AXIS];
+        float theta  = phi * i / segments;
+        float along  = radius * sinf(theta);
+        float across = radius * (1.0f - cosf(theta));
+        for (size_t idx = 0; idx < n_axis; idx++) {
+            if (i == segments) {
+                point[idx] = corner[idx] + blend_mm * line_vec[idx];
+            } else {
+                float normal = (line_vec[idx] - cos_phi * prev_vec[idx]) / sin_phi;  // Toward the circle center
+                point[idx]   = blend_start[idx] + along * prev_vec[idx] + across * normal;
+            }
+        }
+        plan_buffer_line(point, &chord_data);
+    }
+}
+
+bool plan_buffer_line(float* target, plan_line_data_t* pl_data) {
+    if (pl_data->blend_tolerance > 0.0f) {
+        plan_blend_corner(target, pl_data);
+    }
+
+    // Prepare and initialize new block. Copy relevant pl_data for block execution.
+    plan_index_t index = block_buffer_head;
+    if (pl_data->motion.systemMotion) {
+        // Planning after the segment generator has started on a sequence starts a new one
+        if (system_started || system_count == system_motion_blocks) {
+            system_count   = 0;
+            system_index   = 0;
+            system_started = false;
+        }
+        index = config->_planner_blocks + system_count;
+    }
+    plan_block_t*     block = &block_buffer[index];
+    plan_block_aux_t* aux   = &block_aux[index];
+    memset(block, 0, sizeof(plan_block_t));  // Zero all block values.
+    memset(aux, 0, sizeof(plan_block_aux_t));
+    block->motion      = pl_data->motion;
+    block->is_jog      = pl_data->is_jog;
+    aux->coolant       = pl_data->coolant;
+    aux->spindle       = pl_data->spindle;
+    aux->spindle_speed = pl_data->spindle_speed;
+    aux->line_number   = pl_data->line_number;
+    aux->spindle_sync  = pl_data->spindle_sync;
+
+    // Compute and store initial move distance data.
+    int32_t target_steps[MAX_N_AXIS], position_steps[MAX_N_AXIS];
+    float   unit_vec[MAX_N_AXIS], delta_mm;
+    // Copy position data based on type of motion being planned.
+    if (block->motion.systemMotion) {
+        // A sequence goes on from where the block before it ends
+        if (system_count) {
+            copyAxes(position_steps, system_position);
+        } else {
+            get_motor_steps(position_steps);
+        }
+    } else {
+        if (!block->is_jog && Homing::unhomed_axes()) {
+            log_info("Unhomed axes: " << Axes::maskToNames(Homing::unhomed_axes()));
+            send_alarm(ExecAlarm::Unhomed);
+            return false;
+        }
+        copyAxes(position_steps, pl.position);
+    }
+    auto n_axis = Axes::_numberAxis;
+    for (size_t idx = 0; idx < n_axis; idx++) {
+        // Calculate target position in absolute steps, number of steps for each axis, and determine max step events.
+        // Also, compute individual axes distance for move and prep unit vector calculations.
+        // NOTE: Computes true distance from converted step values.
+        target_steps[idx]       = mpos_to_steps(target[idx], idx);
+        block->steps[idx]       = labs(target_steps[idx] - position_steps[idx]);
+        block->step_event_count = MAX(block->step_event_count, block->steps[idx]);
+        delta_mm                = steps_to_mpos((target_steps[idx] - position_steps[idx]), idx);
+        unit_vec[idx]           = delta_mm;  // Store unit vector numerator
+        // Set direction bits. Bit enabled always means direction is negative.
+        if (delta_mm < 0.0) {
+            block->direction_bits |= bitnum_to_mask(idx);
+        }
+    }
+    // Bail if this is a zero-length block. Highly unlikely to occur.
+    if (block->step_event_count == 0) {
+        return false;
+    }
+
+    // Backlash compensation. When an axis reverses, this block takes up the backlash with extra
+    // steps in the new direction. The Bresenham algorithm spreads them over the block, so the
+    // reversal does not cost a stop. The distance and speeds are planned for the true path and
+    // pl.position stays the logical position. System motions start from the executed state and
+    // leave the planned state alone.
+    AxisMask backlash_negative = pl.backlash_negative;
+    if (block->motion.systemMotion) {
+        backlash_negative = system_count ? block_aux[index - 1].backlash_negative : Stepping::backlash_negative;
+    }
+    for (size_t idx = 0; idx < n_axis; idx++) {
+        int32_t backlash = Axes::_axis[idx]->backlashSteps();
+        if (backlash && block->steps[idx]) {
+            bool negative = bitnum_is_true(block->direction_bits, idx);
+            if (negative != bitnum_is_true(backlash_negative, idx)) {
+                block->steps[idx] += backlash;
+                block->step_event_count = MAX(block->step_event_count, block->steps[idx]);
+                if (negative) {
+                    set_bitnum(backlash_negative, idx);
+                } else {
+                    clear_bitnum(backlash_negative, idx);
+                }
+            }
+        }
+    }
+    aux->backlash_negative = backlash_negative;
+    if (!block->motion.systemMotion) {
+        pl.backlash_negative = backlash_negative;
+    }
+
+    // Calculate the unit vector of the line move and the block maximum feed rate and acceleration scaled
+    // down such that no individual axes maximum values are exceeded with respect to the line direction.
+    // NOTE: This calculation assumes all axes are orthogonal (Cartesian) and works with ABC-axes,
+    // if they are also orthogonal/independent. Operates on the absolute value of the unit vector.
+    block->millimeters  = convert_delta_vector_to_unit_vector(unit_vec);
+    block->acceleration = limit_acceleration_by_axis_maximum(unit_vec);
+    block->max_jerk     = limit_jerk_by_axis_maximum(unit_vec);
+    block->rapid_rate   = limit_rate_by_axis_maximum(unit_vec);
+    plan_queue_block(block, aux, pl_data, unit_vec, unit_vec, target_steps);
+    return true;
+}
+
+bool plan_buffer_dwell(uint32_t milliseconds, plan_line_data_t* pl_data) {
+    if (milliseconds == 0) {
+        return false;
+    }
+    plan_block_t*     block = &block_buffer[block_buffer_head];
+    plan_block_aux_t* aux   = &block_aux[block_buffer_head];
+    memset(block, 0, sizeof(plan_block_t));  // Zero all block values.
+    memset(aux, 0, sizeof(plan_block_aux_t));
+    block->is_dwell    = true;
+    aux->coolant       = pl_data->coolant;
+    aux->spindle       = pl_data->spindle;
+    aux->spindle_speed = pl_data->spindle_speed;
+    aux->line_number   = pl_data->line_number;
+    aux->dwell_ms      = milliseconds;
+
+    // The block has no distance and, with the junction speed limits zeroed above, no entry
+    // speed, so the planner passes decelerate the motion before it to a stop at its start.
+    // Output changes wait for the next motion, and a scanline for the next feed motion.
+    aux->backlash_negative = pl.backlash_negative;
+    aux->raster.start      = pl.raster_end;
+
+    pl.previous_nominal_speed = 0.0f;
+    pl.previous_sync          = false;
+    pl.previous_dwell         = true;
+    pl.s_curve_run_mm         = 0.0f;
+    Stepper::prep_lock();
+    block_buffer_head = next_buffer_head;
+    next_buffer_head  = plan_next_block_index(block_buffer_head);
+    ++blocks_pushed;
+    planner_recalculate();
+    Stepper::prep_unlock();
+    return true;
+}
+
+bool plan_buffer_arc(float*            target,
+                     plan_line_data_t* pl_data,
+                     float*            center,
+                     float             radius,
+                     float             start_angle,
+                     float             angular_travel,
+                     size_t            axis_0,
+                     size_t            axis_1) {
+    plan_block_t*     block = &block_buffer[block_buffer_head];
+    plan_block_aux_t* aux   = &block_aux[block_buffer_head];
+    memset(block, 0, sizeof(plan_block_t));  // Zero all block values.
+    memset(aux, 0, sizeof(plan_block_aux_t));
+    block->motion      = pl_data->motion;
+    block->is_arc      = true;
+    aux->coolant       = pl_data->coolant;
+    aux->spindle       = pl_data->spindle;
+    aux->spindle_speed = pl_data->spindle_speed;
+    aux->line_number   = pl_data->line_number;
+
+    if (Homing::unhomed_axes()) {
+        log_info("Unhomed axes: " << Axes::maskToNames(Homing::unhomed_axes()));
+        send_alarm(ExecAlarm::Unhomed);
+        return false;
+    }
+
+    // Arcs are only native without backlash compensation, see mc_arc()
+    aux->backlash_negative = pl.backlash_negative;
+
+    plan_arc_t& arc    = aux->arc;
+    arc.center[0]      = center[0];
+    arc.center[1]      = center[1];
+    arc.radius         = radius;
+    arc.start_angle    = start_angle;
+    arc.angular_travel = angular_travel;
+    arc.axis_0         = axis_0;
+    arc.axis_1         = axis_1;
+
+    // The path length of a helix is the hypotenuse of the plane arc length and the travel of
+    // the other axes, which move linearly with it.  Directions are derivatives of the position
+    // with respect to the fraction of the arc completed.
+    int32_t target_steps[MAX_N_AXIS];
+    float   entry_vec[MAX_N_AXIS], exit_vec[MAX_N_AXIS], limit_vec[MAX_N_AXIS];
+    float   plane_mm         = radius * fabsf(angular_travel);
+    float   length_sq        = plane_mm * plane_mm;
+    float   max_steps_per_mm = 0.0f;
+    auto    n_axis           = Axes::_numberAxis;
+    for (size_t idx = 0; idx < n_axis; idx++) {
+        target_steps[idx]    = mpos_to_steps(target[idx], idx);
+        arc.start_steps[idx] = pl.position[idx];
+        arc.end_steps[idx]   = target_steps[idx];
+        float delta_mm       = 0.0f;
+        if (idx != axis_0 && idx != axis_1) {
+            delta_mm = steps_to_mpos(target_steps[idx] - pl.position[idx], idx);
+            length_sq += delta_mm * delta_mm;
+        }
+        entry_vec[idx] = delta_mm;
+        exit_vec[idx]  = delta_mm;
+        if (delta_mm != 0.0f || idx == axis_0 || idx == axis_1) {
+            max_steps_per_mm = MAX(max_steps_per_mm, Axes::_axis[idx]->_stepsPerMm);
+        }
+    }
+    block->millimeters = sqrtf(length_sq);
+    if (block->millimeters == 0.0f) {
+        return false;
+    }
+    float sweep_mm    = radius * angular_travel;  // Signed
+    float end_angle   = start_angle + angular_travel;
+    entry_vec[axis_0] = -sweep_mm * sinf(start_angle);
+    entry_vec[axis_1] = sweep_mm * cosf(start_angle);
+    exit_vec[axis_0]  = -sweep_mm * sinf(end_angle);
+    exit_vec[axis_1]  = sweep_mm * cosf(end_angle);
+    convert_delta_vector_to_unit_vector(entry_vec);
+    convert_delta_vector_to_unit_vector(exit_vec);
+
+    // The tangent sweeps through the plane, so either plane axis may carry the full in-plane
+    // component somewhere along the arc.  Limit the plane axes for that worst case.
+    copyAxes(limit_vec, exit_vec);
+    float plane_fraction = plane_mm / block->millimeters;
+    limit_vec[axis_0]    = plane_fraction;
+    limit_vec[axis_1]    = plane_fraction;
+
+    // Split the acceleration budget between the tangential and centripetal directions, so their
+    // vector sum stays within the axis limits, and cap the speed so that the centripetal part
+    // v^2/r of the in-plane motion fits in its half.
+    block->acceleration = limit_acceleration_by_axis_maximum(limit_vec) * 0.70710678f;  // 1/sqrt(2)
+    block->max_jerk     = limit_jerk_by_axis_maximum(limit_vec);
+    block->rapid_rate   = limit_rate_by_axis_maximum(limit_vec);
+    if (plane_fraction > 0.0f) {
+        float centripetal_rate = sqrtf(block->acceleration * radius) / plane_fraction;
+        block->rapid_rate      = MIN(block->rapid_rate, centripetal_rate);
+    }
+
+    // Arcs are stepped from positions computed per segment, so steps[] and direction_bits are
+    // unused.  step_event_count only tells the segment generator the finest step spacing.
+    block->step_event_count = MAX(1, uint32_t(ceilf(block->millimeters * max_steps_per_mm)));
+
+    plan_queue_block(block, aux, pl_data, entry_vec, exit_vec, target_steps);
+    return true;
+}
+
+bool plan_buffer_kinematic_line(float* target, float* position, float* motors, plan_line_data_t* pl_data) {
+    plan_block_t*     block = &block_buffer[block_buffer_head];
+    plan_block_aux_t* aux   = &block_aux[block_buffer_head];
+    memset(block, 0, sizeof(plan_block_t));  // Zero all block values.
+    memset(aux, 0, sizeof(plan_block_aux_t));
+    block->motion       = pl_data->motion;
+    block->is_jog       = pl_data->is_jog;
+    block->is_kinematic = true;
+    aux->coolant        = pl_data->coolant;
+    aux->spindle        = pl_data->spindle;
+    aux->spindle_speed  = pl_data->spindle_speed;
+    aux->line_number    = pl_data->line_number;
+    aux->spindle_sync   = pl_data->spindle_sync;
+
+    if (!block->is_jog && Homing::unhomed_axes()) {
+        log_info("Unhomed axes: " << Axes::maskToNames(Homing::unhomed_axes()));
+        send_alarm(ExecAlarm::Unhomed);
+        return false;
+    }
+
+    // Kinematic lines are only used without backlash compensation, see mc_kinematic_line()
+    aux->backlash_negative = pl.backlash_negative;
+
+    // The motors can reverse within the line, so the step count of the finest motor is
+    // estimated from the motor position at the middle as well as at the ends.
+    int32_t target_steps[MAX_N_AXIS];
+    float   unit_vec[MAX_N_AXIS], middle[MAX_N_AXIS], middle_motors[MAX_N_AXIS];
+    auto    n_axis = Axes::_numberAxis;
+    for (size_t idx = 0; idx < n_axis; idx++) {
+        middle[idx]        = (position[idx] + target[idx]) / 2;
+        middle_motors[idx] = middle[idx];
+    }
+    bool middle_ok = config->_kinematics->transform_cartesian_to_motors(middle_motors, middle);
+    for (size_t idx = 0; idx < n_axis; idx++) {
+        target_steps[idx]         = mpos_to_steps(motors[idx], idx);
+        aux->arc.start_steps[idx] = pl.position[idx];
+        aux->arc.end_steps[idx]   = target_steps[idx];
+        aux->kinematic.start[idx] = position[idx];
+        aux->kinematic.end[idx]   = target[idx];
+        unit_vec[idx]             = target[idx] - position[idx];
+        uint32_t steps            = labs(target_steps[idx] - pl.position[idx]);
+        if (middle_ok) {
+            int32_t middle_steps = mpos_to_steps(middle_motors[idx], idx);
+            steps                = labs(middle_steps - pl.position[idx]) + labs(target_steps[idx] - middle_steps);
+        }
+        block->step_event_count = MAX(block->step_event_count, steps);
+    }
+    block->millimeters = convert_delta_vector_to_unit_vector(unit_vec);
+    if (block->millimeters == 0.0f || block->step_event_count == 0) {
+        return false;
+    }
+
+    // The tool moves along the cartesian line, so the axis limits apply to it rather than to
+    // the motors.  Like arcs, the block is stepped from positions computed per segment, so
+    // steps[] and direction_bits are unused.
+    block->acceleration = limit_acceleration_by_axis_maximum(unit_vec);
+    block->max_jerk     = limit_jerk_by_axis_maximum(unit_vec);
+    block->rapid_rate   = limit_rate_by_axis_maximum(unit_vec);
+    plan_queue_block(block, aux, pl_data, unit_vec, unit_vec, target_steps);
     return true;
 }
 
@@ -513,12 +1009,13 @@ void plan_sync_position() {
     // this function needs to be updated to accomodate the difference.
     if (config->_axes) {
         get_motor_steps(pl.position);
+        pl.backlash_negative = Stepping::backlash_negative;
     }
 }
 
 // Returns the number of available blocks are in the planner buffer.
 // Called from report_realtime_status
-uint8_t plan_get_block_buffer_available() {
+plan_index_t plan_get_block_buffer_available() {
     if (block_buffer_head >= block_buffer_tail) {
         return (config->_planner_blocks - 1) - (block_buffer_head - block_buffer_tail);
     } else {
@@ -526,11 +1023,29 @@ uint8_t plan_get_block_buffer_available() {
     }
 }
 
+uint32_t plan_blocks_pushed() {
+    return blocks_pushed;
+}
+
+uint32_t plan_blocks_done() {
+    return blocks_done;
+}
+
+float plan_get_queued_mm() {
+    float mm = 0.0f;
+    for (plan_index_t block_index = block_buffer_tail; block_index != block_buffer_head; block_index = plan_next_block_index(block_index)) {
+        mm += block_buffer[block_index].millimeters;
+    }
+    return mm;
+}
+
 // Re-initialize buffer plan with a partially completed block, assumed to exist at the buffer tail.
 // Called after a steppers have come to a complete stop for a feed hold and the cycle is stopped.
 void plan_cycle_reinitialize() {
     // Re-plan from a complete stop. Reset planner entry speeds and buffer planned pointer.
+    Stepper::prep_lock();
     Stepper::update_plan_block_parameters();
     block_buffer_planned = block_buffer_tail;
-    planner_recalculate();
+    planner_recalculate(true);
+    Stepper::prep_unlock();
 }
@@ -12,9 +12,13 @@
 #include "Config.h"            // MAX_N_AXIS
 #include "SpindleDatatypes.h"  // SpindleState
 #include "GCode.h"             // CoolantState
+#include "Types.h"             // AxisMask
 
 #include <cstdint>
 
+// Index into the planner ring buffer. 16 bits so that planner_blocks can exceed 255.
+typedef uint16_t plan_index_t;
+
 // Define planner data condition flags. Used to denote running conditions of a block.
 struct PlMotion {
     uint8_t rapidMotion : 1;
@@ -24,7 +28,9 @@ struct PlMotion {
 };
 
 // This struct stores a linear movement of a g-code block motion with its critical "nominal" values
-// are as specified in the source g-code.
+// are as specified in the source g-code.  It holds only the fields that the planner and the
+// segment generator touch on every pass, so the ring buffer stays compact.  Data that is read
+// once per block, or only by reporting and parking, lives in plan_block_aux_t.
 struct plan_block_t {
     // Fields used by the bresenham algorithm for tracing the line
     // NOTE: Used by stepper algorithm to execute the block correctly. Do not alter these values.
@@ -34,10 +40,13 @@ struct plan_block_t {
     uint8_t  direction_bits;     // The direction bit set for this block (refers to *_DIRECTION_BIT in config.h)
 
     // Block condition data to ensure correct execution depending on states and overrides.
-    PlMotion     motion;       // Block bitflag motion conditions. Copied from pl_line_data.
-    SpindleState spindle;      // Spindle enable state
-    CoolantState coolant;      // Coolant state
-    int32_t      line_number;  // Block line number for real-time reporting. Copied from pl_line_data.
+    PlMotion motion;            // Block bitflag motion conditions. Copied from pl_line_data.
+    uint8_t  use_s_curve : 1;   // True if this block uses S-curve acceleration
+    uint8_t  s_curve_run : 1;   // True if this block continues the S-curve profile of the previous block
+    uint8_t  is_arc : 1;        // True if this block is a native arc, see plan_arc_t
+    uint8_t  is_kinematic : 1;  // True if this block is a kinematic line, see plan_kinematic_t
+    uint8_t  is_dwell : 1;      // True if this block is a dwell, see plan_buffer_dwell()
+    bool     is_jog;
 
     // Fields used by the motion planner to manage acceleration. Some of these values may be updated
     // by the stepper module during execution of special motion cases for replanning purposes.
@@ -49,32 +58,95 @@ struct plan_block_t {
     float millimeters;   // The remaining distance for this block to be executed in (mm).
     // NOTE: This value may be altered by stepper algorithm during execution.
 
-    // S-curve acceleration profile data
-    bool use_s_curve;           // True if this block uses S-curve acceleration
-    float s_curve_phases[7];    // Duration of each S-curve phase in seconds
-    float s_curve_distances[7]; // Distance of each S-curve phase in mm
-
     // Stored rate limiting data used by planner when changes occur.
     float max_junction_speed_sqr;  // Junction entry speed limit based on direction vectors in (mm/min)^2
     float rapid_rate;              // Axis-limit adjusted maximum rate for this block direction in (mm/min)
     float programmed_rate;         // Programmed rate of this block (mm/min).
+};
+
+// Geometry of a native arc block. The plane axes follow the circle; every other axis moves
+// linearly from start_steps to end_steps over the length of the arc.  A kinematic line block
+// uses start_steps and end_steps for its motor positions at the ends.
+struct plan_arc_t {
+    int32_t start_steps[MAX_N_AXIS];  // Machine position at the start of the arc in steps
+    int32_t end_steps[MAX_N_AXIS];    // Machine position at the end of the arc in steps
+    float   center[2];                // Center in the plane axes (mm)
+    float   radius;                   // (mm)
+    float   start_angle;              // Angle of the start point about the center (rad)
+    float   angular_travel;           // Signed sweep, counterclockwise positive (rad)
+    uint8_t axis_0;                   // First plane axis
+    uint8_t axis_1;                   // Second plane axis
+};
+
+// Geometry of a kinematic line block. The planner plans the straight cartesian line and the
+// segment generator converts each point along it to motor positions.
+struct plan_kinematic_t {
+    float start[MAX_N_AXIS];  // Cartesian position at the start of the line (mm)
+    float end[MAX_N_AXIS];    // Cartesian position at the end of the line (mm)
+};
+
+// Output changes requested by M62, M63 and M67. They are attached to the next motion block and
+// applied by the stepper when that block starts executing, so setting them does not stop motion.
+struct plan_io_t {
+    uint8_t  digital_on;                     // Digital outputs to turn on
+    uint8_t  digital_off;                    // Digital outputs to turn off
+    uint8_t  analog;                         // Analog outputs to set
+    uint32_t analog_duty[MaxUserAnalogPin];  // Duty of each analog output in pin units
+};
+
+// The grayscale scanline of a raster engraving block, see Raster.h. A block without one has
+// length 0 and holds the position of the next scanline, so that it still releases the space of
+// the ones before it.
+struct plan_raster_t {
+    uint32_t start;        // Position of the first pixel in the Raster ring
+    uint32_t length;       // Number of pixels
+    float    millimeters;  // Length of the block the pixels are spread over
+};
+
+// Per-block data that is not needed by the planner passes or the per-segment step math.
+// Stored in a side table parallel to the block ring; use plan_get_block_aux() to reach it.
+struct plan_block_aux_t {
+    // S-curve acceleration profile data, copied into the segment generator when a block is loaded.
+    // For a block that continues an S-curve run, the profile covers the whole run up to and
+    // including this block, not just this block.
+    float s_curve_phases[7];     // Duration of each S-curve phase in seconds
+    float s_curve_distances[7];  // Distance of each S-curve phase in mm
+
+    SpindleState spindle;      // Spindle enable state
+    CoolantState coolant;      // Coolant state
+    int32_t      line_number;  // Block line number for real-time reporting. Copied from pl_line_data.
 
     // Stored spindle speed data used by spindle overrides and resuming methods.
     SpindleSpeed spindle_speed;  // Block spindle speed. Copied from pl_line_data.
 
-    bool is_jog;
+    plan_arc_t       arc;        // Arc geometry, valid when the block is_arc or is_kinematic
+    plan_kinematic_t kinematic;  // Cartesian line, valid when the block is_kinematic
+
+    AxisMask backlash_negative;  // Axes whose backlash is taken up in the negative direction once this block runs
+
+    plan_io_t io;  // Output changes to apply when the block starts
+
+    float spindle_sync;  // G33 path distance per spindle revolution (mm), zero if not synchronized
+
+    plan_raster_t raster;  // Scanline to engrave along the block
+
+    bool latency_traced;  // First block of the line that LineLatency traces
+
+    uint32_t dwell_ms;  // Length of a dwell block
 };
 
 // Planner data prototype. Must be used when passing new motions to the planner.
 struct plan_line_data_t {
-    float        feed_rate;       // Desired feed rate for line motion. Value is ignored, if rapid motion.
-    SpindleSpeed spindle_speed;   // Desired spindle speed through line motion.
-    PlMotion     motion;          // Bitflag variable to indicate motion conditions. See defines above.
-    SpindleState spindle;         // Spindle enable state
-    CoolantState coolant;         // Coolant state
-    int32_t      line_number;     // Desired line number to report when executing.
-    bool         is_jog;          // true if this was generated due to a jog command
-    bool         limits_checked;  // true if soft limits already checked
+    float        feed_rate;        // Desired feed rate for line motion. Value is ignored, if rapid motion.
+    SpindleSpeed spindle_speed;    // Desired spindle speed through line motion.
+    PlMotion     motion;           // Bitflag variable to indicate motion conditions. See defines above.
+    SpindleState spindle;          // Spindle enable state
+    CoolantState coolant;          // Coolant state
+    int32_t      line_number;      // Desired line number to report when executing.
+    bool         is_jog;           // true if this was generated due to a jog command
+    bool         limits_checked;   // true if soft limits already checked
+    float        blend_tolerance;  // G64 corner rounding tolerance in mm. Zero for exact path.
+    float        spindle_sync;     // G33 path distance per spindle revolution in mm. Zero if not synchronized.
 };
 
 void plan_init();
@@ -89,18 +161,68 @@ void plan_reset_buffer();  // Reset buffer only.
 // Returns true on success.
 bool plan_buffer_line(float* target, plan_line_data_t* pl_data);
 
+// Add an arc to the buffer as a single block, to be interpolated by the segment generator.
+// target is the absolute end position, center the arc center in the axis_0/axis_1 plane,
+// start_angle the angle of the current position about the center, and angular_travel the
+// signed sweep (counterclockwise positive). Axes other than the plane axes move linearly.
+// Requires motor space to be cartesian space. Returns true on success.
+bool plan_buffer_arc(float*            target,
+                     plan_line_data_t* pl_data,
+                     float*            center,
+                     float             radius,
+                     float             start_angle,
+                     float             angular_travel,
+                     size_t            axis_0,
+                     size_t            axis_1);
+
+// Add a cartesian line to the buffer as a single block, for a kinematic system whose motor
+// positions are not linear in the cartesian position. The block is planned along the straight
+// line from position to target, in mm, with the axis limits applied to the cartesian motion.
+// The segment generator converts each point along it with transform_cartesian_to_motors(), so
+// the kinematic system must be able to transform every point of the line. motors is the motor
+// position at target. Returns true on success.
+bool plan_buffer_kinematic_line(float* target, float* position, float* motors, plan_line_data_t* pl_data);
+
+// Add a dwell (G4) to the buffer as a block without motion. The motion before it stops at its
+// start and the motion after it starts from rest, but the blocks on either side are planned
+// and prepped as usual, so the planner does not have to run empty around it. The segment
+// generator times it with segments without steps. Returns true on success.
+bool plan_buffer_dwell(uint32_t milliseconds, plan_line_data_t* pl_data);
+
+// Queue an output change for the start of the next planned motion (M62, M63, M67). If no
+// motion follows, the change is never made. duty is in units of the output pin.
+void plan_sync_digital_output(size_t io_num, bool on);
+void plan_sync_analog_output(size_t io_num, uint32_t duty);
+
+// Queue grayscale pixels for the scanline of the next linear feed motion. Pixels queued by
+// consecutive calls make up one scanline. The caller waits until they fit in Raster::space().
+void plan_sync_raster(const uint8_t* pixels, size_t count);
+size_t plan_raster_pending();  // Pixels queued for the next scanline
+
 // Called when the current block is no longer needed. Discards the block and makes the memory
 // availible for new blocks.
 void plan_discard_current_block();
 
-// Gets the planner block for the special system motion cases. (Parking/Homing)
+// Gets the planner block for the special system motion cases. (Parking/Homing)  Several
+// system motions planned before the segment generator takes the first one form a sequence;
+// NULL once it is done.
 plan_block_t* plan_get_system_motion_block();
 
+// The entry speed of the next block of the sequence, or zero at its end
+float plan_get_system_motion_exit_speed_sqr();
+
+// Called by the segment generator at the end of a system motion block.  Moves on to the next
+// block of the sequence, or returns false at its end.
+bool plan_next_system_motion_block();
+
 // Gets the current block. Returns NULL if buffer empty
 plan_block_t* plan_get_current_block();
 
+// Gets the side-table data belonging to a block from the planner ring.
+plan_block_aux_t* plan_get_block_aux(const plan_block_t* block);
+
 // Increment block index with wrap-around
-static uint8_t plan_next_block_index(uint8_t block_index);
+static plan_index_t plan_next_block_index(plan_index_t block_index);
 
 // Called by step segment buffer when computing executing block velocity profile.
 float plan_get_exec_block_exit_speed_sqr();
@@ -118,7 +240,16 @@ void plan_sync_position();
 void plan_cycle_reinitialize();
 
 // Returns the number of available blocks are in the planner buffer.
-uint8_t plan_get_block_buffer_available();
+plan_index_t plan_get_block_buffer_available();
+
+// Count the blocks added to the planner since boot, and the blocks that have left it, taken
+// by the segment generator or flushed by a reset.  Once plan_blocks_done() reaches what
+// plan_blocks_pushed() returned after a block was added, that block has left the planner.
+uint32_t plan_blocks_pushed();
+uint32_t plan_blocks_done();
+
+// Returns the total distance of the blocks in the planner buffer in mm.
+float plan_get_queued_mm();
 
 // Returns the status of the block ring buffer. True, if buffer is full.
 uint8_t plan_check_full_buffer();
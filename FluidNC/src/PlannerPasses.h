@@ -0,0 +1,132 @@
+// Copyright (c) 2011-2016 Sungeun K. Jeon for Gnea Research LLC
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// The reverse and forward passes of planner_recalculate(), over a ring of n_blocks
+// blocks from tail to head.  See the comment above planner_recalculate() in Planner.cpp
+// for how the passes and the planned index work.
+//
+// Block needs entry_speed_sqr, max_entry_speed_sqr, acceleration and millimeters.
+// on_tail() is called when the pass reaches the block after the tail, whose profile the
+// segment generator may be executing.  The return value is the number of blocks that
+// the passes visited, which is the cost that benchmarks measure.
+//
+// It is header-only so that it can be benchmarked on the host.
+
+#include <cstddef>
+#include <cstdint>
+
+template <typename Block, typename Index, typename OnTail>
+uint32_t planner_passes(Block*  blocks,
+                        size_t  n_blocks,
+                        Index   tail,
+                        Index   head,
+                        Index&  planned,
+                        bool    full_replan,
+                        size_t  replan_limit,
+                        OnTail  on_tail) {
+    auto next_index = [n_blocks](Index index) -> Index { return ++index == n_blocks ? 0 : index; };
+    auto prev_index = [n_blocks](Index index) -> Index { return (index == 0 ? Index(n_blocks) : index) - 1; };
+
+    if (head == tail) {
+        // Nothing to do; planner buffer is empty.
+        return 0;
+    }
+    // Initialize block index to the last block in the planner buffer.
+    Index block_index = prev_index(head);
+    // Bail. Can't do anything with one only one plan-able block.
+    if (block_index == planned) {
+        return 0;
+    }
+    uint32_t visited = 1;
+    // Reverse Pass: Coarsely maximize all possible deceleration curves back-planning from the last
+    // block in buffer. Cease planning when the last optimal planned or tail pointer is reached, or
+    // when the new plan converges with the existing one.
+    // NOTE: Forward pass will later refine and correct the reverse pass to create an optimal plan.
+    float  entry_speed_sqr;
+    Block* next;
+    Block* current = &blocks[block_index];
+    // Calculate maximum entry speed for last block in buffer, where the exit speed is always zero.
+    current->entry_speed_sqr = current->max_entry_speed_sqr < 2 * current->acceleration * current->millimeters
+                                   ? current->max_entry_speed_sqr
+                                   : 2 * current->acceleration * current->millimeters;
+    block_index         = prev_index(block_index);
+    Index forward_start = planned;  // Block from which the forward pass will resume
+    if (block_index == planned) {   // Only two plannable blocks in buffer. Reverse pass complete.
+        // Check if the first block is the tail. If so, notify stepper to update its current parameters.
+        if (block_index == tail) {
+            on_tail();
+        }
+    } else {  // Three or more plan-able blocks
+        if (full_replan) {
+            replan_limit = 0;
+        }
+        size_t replanned = 0;
+        while (block_index != planned) {
+            next                = current;
+            current             = &blocks[block_index];
+            Index current_index = block_index;
+            block_index         = prev_index(block_index);
+            ++visited;
+            if (!full_replan) {
+                // A saturated block bounds everything before it. Nothing to propagate.
+                if (current->entry_speed_sqr == current->max_entry_speed_sqr) {
+                    forward_start = current_index;
+                    break;
+                }
+                if (replan_limit && ++replanned > replan_limit) {
+                    forward_start = current_index;
+                    break;
+                }
+            }
+            // Compute maximum entry speed decelerating over the current block from its exit speed.
+            if (current->entry_speed_sqr != current->max_entry_speed_sqr) {
+                entry_speed_sqr = next->entry_speed_sqr + 2 * current->acceleration * current->millimeters;
+                if (entry_speed_sqr > current->max_entry_speed_sqr) {
+                    entry_speed_sqr = current->max_entry_speed_sqr;
+                }
+                if (!full_replan && entry_speed_sqr == current->entry_speed_sqr) {
+                    // Converged with the previous plan. Earlier blocks cannot change.
+                    forward_start = current_index;
+                    break;
+                }
+                current->entry_speed_sqr = entry_speed_sqr;
+            }
+            // Check if next block is the tail block(=planned block). If so, update current stepper parameters.
+            if (block_index == tail) {
+                on_tail();
+            }
+        }
+    }
+    // Forward Pass: Forward plan the acceleration curve from the first block that may have changed onward.
+    // Also scans for optimal plan breakpoints and appropriately updates the planned pointer.
+    next        = &blocks[forward_start];  // Begin at buffer planned pointer or convergence point
+    block_index = next_index(forward_start);
+    while (block_index != head) {
+        current = next;
+        next    = &blocks[block_index];
+        ++visited;
+        // Any acceleration detected in the forward pass automatically moves the optimal planned
+        // pointer forward, since everything before this is all optimal. In other words, nothing
+        // can improve the plan from the buffer tail to the planned pointer by logic.
+        if (current->entry_speed_sqr < next->entry_speed_sqr) {
+            entry_speed_sqr = current->entry_speed_sqr + 2 * current->acceleration * current->millimeters;
+            // If true, current block is full-acceleration and we can move the planned pointer forward.
+            if (entry_speed_sqr < next->entry_speed_sqr) {
+                next->entry_speed_sqr = entry_speed_sqr;  // Always <= max_entry_speed_sqr. Backward pass sets this.
+                planned               = block_index;      // Set optimal plan pointer.
+            }
+        }
+        // Any block set at its maximum entry speed also creates an optimal plan up to this
+        // point in the buffer. When the plan is bracketed by either the beginning of the
+        // buffer and a maximum entry speed or two maximum entry speeds, every block in between
+        // cannot logically be further improved. Hence, we don't have to recompute them anymore.
+        if (next->entry_speed_sqr == next->max_entry_speed_sqr) {
+            planned = block_index;
+        }
+        block_index = next_index(block_index);
+    }
+    return visited;
+}
@@ -0,0 +1,107 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "PlannerStats.h"
+
+#include "State.h"               // state_is()
+#include "Driver/delay_usecs.h"  // getCpuTicks()
+
+#include <cstdio>  // snprintf
+
+namespace PlannerStats {
+    static Stats total = {};
+    static Stats job   = {};
+
+    static bool     in_job        = false;
+    static bool     drain         = false;
+    static bool     empty         = false;  // The current starvation has been counted
+    static bool     sampling      = false;  // last_ticks and the last bins are valid
+    static uint32_t last_ticks    = 0;
+    static int      last_planner  = 0;
+    static int      last_segments = 0;
+
+    static int bin(uint32_t used, uint32_t size) {
+        if (used == 0) {
+            return 0;
+        }
+        if (used >= size) {
+            return Stats::n_bins - 1;
+        }
+        return (4 * used + size - 1) / size;  // Quarters, 1 to 4
+    }
+
+    void job_start() {
+        job    = {};
+        in_job = true;
+        empty  = false;
+    }
+
+    void job_end() { in_job = false; }
+
+    void blocked(uint32_t ticks) {
+        ++total.blocked;
+        total.blocked_ticks += ticks;
+        if (in_job) {
+            ++job.blocked;
+            job.blocked_ticks += ticks;
+        }
+    }
+
+    void draining(bool on) { drain = on; }
+
+    void starved() {
+        if (empty || drain || !in_job || !state_is(State::Cycle)) {
+            return;
+        }
+        empty = true;
+        ++total.starved;
+        ++job.starved;
+    }
+
+    void fed() { empty = false; }
+
+    void sample(uint32_t planner_used, uint32_t planner_size, uint32_t segments_used, uint32_t segments_size) {
+        uint32_t now     = getCpuTicks();
+        bool     running = state_is(State::Cycle);
+        if (sampling && running) {
+            // The interval since the last sample is charged to the fill levels seen then
+            uint32_t ticks = now - last_ticks;
+            total.planner_ticks[last_planner] += ticks;
+            total.segment_ticks[last_segments] += ticks;
+            if (in_job) {
+                job.planner_ticks[last_planner] += ticks;
+                job.segment_ticks[last_segments] += ticks;
+            }
+        }
+        sampling      = running;
+        last_ticks    = now;
+        last_planner  = bin(planner_used, planner_size);
+        last_segments = bin(segments_used, segments_size);
+    }
+
+    void get(Stats& total_out, Stats& job_out) {
+        total_out = total;
+        job_out   = job;
+    }
+
+    void reset() {
+        total    = {};
+        sampling = false;
+    }
+
+    std::string occupancy(const uint64_t (&ticks)[Stats::n_bins]) {
+        static const char* names[Stats::n_bins] = { "empty", "<=25%", "<=50%", "<=75%", "<100%", "full" };
+
+        uint64_t sum = 0;
+        for (auto t : ticks) {
+            sum += t;
+        }
+        std::string out;
+        for (int i = 0; i < Stats::n_bins; i++) {
+            char buf[24];
+            snprintf(buf, sizeof(buf), "%s%s:%.1f%%", i ? " " : "", names[i], sum ? 100.0 * ticks[i] / sum : 0.0);
+            out += buf;
+        }
+        return out;
+    }
+}
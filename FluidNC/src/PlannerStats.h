@@ -0,0 +1,56 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  PlannerStats.h - how well the planner and the segment buffer are kept fed
+
+  |Bf: shows how full the planner is at one instant.  These statistics say how it got there:
+
+    blocked  the parser found the planner full and waited for room, so the sender is ahead
+    starved  the segment generator found the planner empty in Cycle state during a job, outside
+             of a wait for the motion to finish, so the sender fell behind and feed was lost
+
+  and how long each buffer spent at each fill level while in Cycle state.  They accumulate
+  since the last $Planner/Stats=reset, and separately for each job, which are summarized
+  with the "Job done" notification and in the job summary of JobStats.h.
+*/
+
+#include <cstdint>
+#include <string>
+
+namespace PlannerStats {
+    struct Stats {
+        static const int n_bins = 6;  // empty, <=1/4, <=1/2, <=3/4, partly full, full
+
+        uint32_t blocked;                // Times the parser waited for room in the planner
+        uint64_t blocked_ticks;          // CPU cycles spent waiting
+        uint32_t starved;                // Times the planner ran empty under a running job
+        uint64_t planner_ticks[n_bins];  // CPU cycles in Cycle state at each planner fill level
+        uint64_t segment_ticks[n_bins];  // CPU cycles in Cycle state at each segment buffer fill level
+    };
+
+    // Called by Job when the outermost job starts and ends
+    void job_start();
+    void job_end();
+
+    // Called by the motion control wait loops with the time spent waiting for planner room
+    void blocked(uint32_t ticks);
+
+    // Called by protocol_buffer_synchronize() around its wait, when an empty planner is expected
+    void draining(bool on);
+
+    // Called by the segment generator when it finds no planner block
+    void starved();
+    void fed();
+
+    // Called by the segment generator with the current fill levels
+    void sample(uint32_t planner_used, uint32_t planner_size, uint32_t segments_used, uint32_t segments_size);
+
+    void get(Stats& total, Stats& job);
+    void reset();
+
+    // The fill levels of one buffer as percentages of the time, like "empty:2.0% <=25%:8.5% ..."
+    std::string occupancy(const uint64_t (&ticks)[Stats::n_bins]);
+}
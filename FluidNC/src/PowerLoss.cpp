@@ -0,0 +1,258 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "PowerLoss.h"
+
+#include "Settings.h"             // Setting::_handle
+#include "SettingsDefinitions.h"  // power_loss_interval
+#include "GCode.h"                // gc_state
+#include "Planner.h"              // plan_blocks_pushed(), plan_blocks_done()
+#include "Stepper.h"              // Stepper::prep_buffer()
+#include "System.h"               // get_mpos()
+#include "Machine/Axes.h"         // Machine::Axes::_numberAxis
+#include "InputFile.h"
+#include "xmodem.h"               // crc16_ccitt()
+#include "Logging.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace PowerLoss {
+    static_assert(sizeof(Record) <= 64, "Keep the record small; it is written while the job runs");
+
+    // The job blob is written once per job, the records go round the slots
+    static const char* job_key = "plr_job";
+    static const int   n_slots = 8;
+
+    struct JobInfo {
+        uint32_t start;  // Records of this job have sequence numbers from here
+        char     path[100];
+    };
+
+    static uint32_t next_sequence = 1;
+
+    // The record found at boot
+    static bool        have_pending = false;
+    static Record      pending_record;
+    static std::string pending_path;
+
+    // Recent lines of the running job, newest last, with the planner count after each
+    struct Done {
+        uint32_t line;
+        uint32_t offset;
+        uint32_t pushed;
+    };
+    static const size_t history_size = 64;
+    static Done         history[history_size];
+    static size_t       history_count = 0;
+
+    static const InputFile* writing       = nullptr;  // Only compared
+    static uint16_t         writing_crc   = 0;        // Of its path
+    static uint32_t         last_line     = 0;        // Of the last line_done()
+    static uint32_t         recorded_line = 0;        // Of the last record
+    static TickType_t       last_write    = 0;
+
+    static void slot_key(char* key, uint32_t sequence) {
+        snprintf(key, 8, "plr%u", unsigned(sequence % n_slots));
+    }
+
+    static uint16_t record_crc(const Record& record) {
+        return crc16_ccitt(reinterpret_cast<const uint8_t*>(&record), offsetof(Record, crc));
+    }
+
+    static uint16_t path_crc(const char* path) {
+        return crc16_ccitt(reinterpret_cast<const uint8_t*>(path), strlen(path));
+    }
+
+    static bool read_slot(int slot, Record& record) {
+        char key[8];
+        slot_key(key, slot);
+        size_t len = sizeof(record);
+        return nvs_get_blob(Setting::_handle, key, &record, &len) == ESP_OK && len == sizeof(record) && record.sequence &&
+               record.crc == record_crc(record);
+    }
+
+    void init() {
+        JobInfo  job;
+        size_t   len      = sizeof(job);
+        bool     have_job = nvs_get_blob(Setting::_handle, job_key, &job, &len) == ESP_OK && len == sizeof(job);
+        uint32_t newest   = 0;
+        if (have_job) {
+            job.path[sizeof(job.path) - 1] = '\0';
+        }
+        for (int slot = 0; slot < n_slots; slot++) {
+            Record record;
+            if (!read_slot(slot, record)) {
+                continue;
+            }
+            newest = std::max(newest, record.sequence);
+            if (have_job && record.sequence >= job.start && record.path_crc == path_crc(job.path) &&
+                (!have_pending || record.sequence > pending_record.sequence)) {
+                pending_record = record;
+                have_pending   = true;
+            }
+        }
+        next_sequence = newest + 1;
+        if (have_pending) {
+            pending_path = job.path;
+            log_warn("Power lost in " << pending_path << " after line " << pending_record.line
+                                      << ", $PowerLoss/Resume to continue or $PowerLoss/Clear to discard");
+        }
+    }
+
+    static void start_job(InputFile& file) {
+        writing       = &file;
+        history_count = 0;
+        recorded_line = 0;
+        last_write    = xTaskGetTickCount();
+        have_pending  = false;
+
+        JobInfo job;
+        memset(&job, 0, sizeof(job));
+        job.start = next_sequence;
+        strncpy(job.path, file.path().c_str(), sizeof(job.path) - 1);
+        writing_crc = path_crc(job.path);
+        if (nvs_set_blob(Setting::_handle, job_key, &job, sizeof(job)) != ESP_OK || nvs_commit(Setting::_handle) != ESP_OK) {
+            log_debug("Cannot write the power loss job");
+            writing = nullptr;
+        }
+    }
+
+    // The newest line whose blocks have all left the planner.  A block that has left may
+    // still have segments in the stepper, so the counts must differ by at least one more.
+    static const Done* executed() {
+        uint32_t done = plan_blocks_done();
+        size_t   n    = std::min(history_count, history_size);
+        for (size_t i = 1; i <= n; i++) {
+            auto& entry = history[(history_count - i) % history_size];
+            if (int32_t(done - entry.pushed) > 0) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    static void write_record(const Done& line) {
+        Record record;
+        memset(&record, 0, sizeof(record));
+        record.sequence = next_sequence++;
+        record.line     = line.line;
+        record.offset   = line.offset;
+        auto mpos       = get_mpos();
+        for (size_t axis = 0; axis < Machine::Axes::_numberAxis; axis++) {
+            record.mpos[axis] = mpos[axis];
+        }
+        record.motion       = uint16_t(gc_state.modal.motion);
+        record.tool         = int16_t(gc_state.current_tool);
+        record.coord_select = uint8_t(gc_state.modal.coord_select);
+        record.plane        = uint8_t(uint16_t(gc_state.modal.plane_select) / 10);
+        record.spindle      = uint8_t(gc_state.modal.spindle);
+        if (gc_state.modal.units == Units::Inches) {
+            record.flags |= Inches;
+        }
+        if (gc_state.modal.distance == Distance::Incremental) {
+            record.flags |= Incremental;
+        }
+        if (gc_state.modal.feed_rate == FeedRate::InverseTime) {
+            record.flags |= InverseTime;
+        }
+        if (gc_state.modal.coolant.Mist) {
+            record.flags |= Mist;
+        }
+        if (gc_state.modal.coolant.Flood) {
+            record.flags |= Flood;
+        }
+        record.path_crc = writing_crc;
+        record.crc      = record_crc(record);
+
+        // A flash write stalls the caller for a few ms, so fill the segment buffer first
+        if (Stepper::prep_task_enabled()) {
+            Stepper::wake_prep_task();
+        } else {
+            Stepper::prep_buffer();
+        }
+        char key[8];
+        slot_key(key, record.sequence);
+        if (nvs_set_blob(Setting::_handle, key, &record, sizeof(record)) != ESP_OK || nvs_commit(Setting::_handle) != ESP_OK) {
+            log_debug("Cannot write the power loss record");
+        }
+    }
+
+    void line_done(InputFile& file, size_t line_number, size_t end) {
+        int interval = power_loss_interval->get();
+        if (interval == 0 || state_is(State::CheckMode)) {
+            return;
+        }
+        if (&file != writing || line_number <= last_line) {
+            start_job(file);
+            if (!writing) {
+                return;
+            }
+        }
+        last_line                                = line_number;
+        history[history_count++ % history_size] = { uint32_t(line_number), uint32_t(end), plan_blocks_pushed() };
+
+        TickType_t now = xTaskGetTickCount();
+        if (now - last_write < TickType_t(interval) * 1000 / portTICK_PERIOD_MS) {
+            return;
+        }
+        last_write = now;
+
+        // Nothing new has finished during a hold or a long move
+        auto line = executed();
+        if (line && line->line != recorded_line) {
+            recorded_line = line->line;
+            write_record(*line);
+        }
+    }
+
+    void job_done() {
+        if (writing) {
+            writing = nullptr;
+            clear();
+        }
+    }
+
+    bool pending(Record& record, std::string& path) {
+        if (have_pending) {
+            record = pending_record;
+            path   = pending_path;
+        }
+        return have_pending;
+    }
+
+    void show(Channel& out) {
+        if (!have_pending) {
+            log_string(out, "No unfinished job");
+            return;
+        }
+        auto& r = pending_record;
+        LogStream msg(out, "[POWERLOSS:");
+        msg << pending_path << " line:" << r.line << " offset:" << r.offset << " MPos:";
+        for (size_t axis = 0; axis < Machine::Axes::_numberAxis; axis++) {
+            msg << (axis ? "," : "") << r.mpos[axis];
+        }
+        msg << " G" << r.motion / 10;
+        if (r.motion % 10) {
+            msg << "." << r.motion % 10;
+        }
+        msg << " G" << 54 + r.coord_select << " G" << int(r.plane) << (r.flags & Inches ? " G20" : " G21")
+            << (r.flags & Incremental ? " G91" : " G90") << (r.flags & InverseTime ? " G93" : " G94") << " M" << int(r.spindle);
+        if (r.flags & Mist) {
+            msg << " M7";
+        }
+        if (r.flags & Flood) {
+            msg << " M8";
+        }
+        if (!(r.flags & (Mist | Flood))) {
+            msg << " M9";
+        }
+        msg << " T" << r.tool << "]";
+    }
+
+    void clear() {
+        have_pending = false;
+        nvs_erase_key(Setting::_handle, job_key);
+        nvs_commit(Setting::_handle);
+    }
+}
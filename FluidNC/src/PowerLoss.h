@@ -0,0 +1,69 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  PowerLoss.h - recovering a file job after a power cut
+
+  While a file job runs, every $PowerLoss/Interval seconds a small fixed-size record of where
+  the job is - line, file offset, machine position and the main modes - is written to NVS.
+  The line is the last one whose motion has left the planner, so the record never gets ahead
+  of the machine; the modes are only shown, since resuming reconstructs them from the file.
+  Records rotate through a ring of keys, so a cut during a write leaves the previous record,
+  and NVS spreads the writes over its pages.  The path of the file is written once when the
+  job starts, and erased when the job ends normally.
+
+  At boot a record of an unfinished job is reported, and $PowerLoss/Resume homes the machine
+  and starts the file at the line after the record, as $SD/Run=<path> line=<n> does, see
+  Resume.h.  $PowerLoss/Clear discards it.
+*/
+
+#include "Config.h"  // MAX_N_AXIS
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class Channel;
+class InputFile;
+
+namespace PowerLoss {
+    struct Record {
+        uint32_t sequence;  // Newer records have larger numbers; 0 is an empty slot
+        uint32_t line;      // The last line whose motion has left the planner
+        uint32_t offset;    // File position after it
+        float    mpos[MAX_N_AXIS];
+        uint16_t motion;        // Motion mode as G-code number times 10, e.g. 10 for G1
+        int16_t  tool;          // Tool in the spindle, -1 for none
+        uint8_t  coord_select;  // 0 for G54
+        uint8_t  plane;         // 17, 18 or 19
+        uint8_t  spindle;       // 3, 4 or 5 as M3, M4 or M5
+        uint8_t  flags;         // See Flag
+        uint16_t path_crc;      // Of the file path, to tell jobs apart
+        uint16_t crc;           // Of the bytes before it; must be last
+    };
+
+    enum Flag : uint8_t {
+        Inches      = 1 << 0,
+        Incremental = 1 << 1,
+        InverseTime = 1 << 2,
+        Mist        = 1 << 3,
+        Flood       = 1 << 4,
+    };
+
+    // Reads the ring at boot, after the NVS settings are open
+    void init();
+
+    // Called by InputFile::ack() after a line of the file job executes, as Resume::line_done()
+    void line_done(InputFile& file, size_t line_number, size_t end);
+
+    // Called when a job has been sent to the end
+    void job_done();
+
+    // The record of an unfinished job, if there is one
+    bool pending(Record& record, std::string& path);
+
+    void show(Channel& out);
+    void clear();
+}
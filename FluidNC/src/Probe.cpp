@@ -5,6 +5,9 @@
 #include "Probe.h"
 #include "Machine/EventPin.h"
 #include "Machine/MachineConfig.h"
+#include "Driver/fluidnc_gpio.h"  // gpio_add_interrupt
+
+#include <cstring>  // memset
 
 extern void    protocol_do_probe(void* arg);
 const ArgEvent probeEvent { protocol_do_probe };
@@ -14,6 +17,50 @@ Probe::ProbeEventPin::ProbeEventPin(const char* legend) : EventPin(&probeEvent,
 void Probe::init() {
     _probePin.init();
     _toolsetterPin.init();
+    add_latch_pin(_probePin);
+    add_latch_pin(_toolsetterPin);
+}
+
+void Probe::add_latch_pin(ProbeEventPin& pin) {
+    if (pin.undefined() || !pin.capabilities().has(Pin::Capabilities::Native | Pin::Capabilities::ISR)) {
+        return;
+    }
+    int gpio                    = pin.index();
+    _latchGpio[_latchPins]      = gpio;
+    _latchActiveLow[_latchPins] = pin.getAttr().has(Pin::Attr::ActiveLow);
+    ++_latchPins;
+    gpio_add_interrupt(gpio, Pin::EITHER_EDGE, latch_isr, this);
+}
+
+// Latches the position at the first edge that trips the probe during a probing cycle, and
+// sends the probe event right away instead of waiting for the pin to be polled.
+void IRAM_ATTR Probe::latch_isr(void* arg) {
+    Probe* p = static_cast<Probe*>(arg);
+    if (!probing || p->_latched) {
+        return;
+    }
+    bool active = false;
+    for (int i = 0; i < p->_latchPins; i++) {
+        active = active || (gpio_read(p->_latchGpio[i]) != 0) != p->_latchActiveLow[i];
+    }
+    if (active != p->_away) {
+        Stepper::latch_position(p->_latch);
+        p->_latched = true;
+        protocol_send_event_from_ISR(&probeEvent, p);
+    }
+}
+
+bool Probe::latched_position(int32_t* steps, float* fraction) {
+    if (!_latched) {
+        return false;
+    }
+    auto n_axis = Axes::_numberAxis;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        steps[axis] = _latch.steps[axis];
+    }
+    physical_to_motor_steps(steps);
+    Stepper::interpolate_latch(_latch, fraction);
+    return true;
 }
 
 void Probe::set_direction(bool away) {
@@ -37,12 +84,19 @@ void Probe::group(Configuration::HandlerBase& handler) {
     handler.item("toolsetter_pin", _toolsetterPin);
     handler.item("check_mode_start", _check_mode_start);
     handler.item("hard_stop", _hard_stop);
+    handler.item("repeat_touches", _repeat_touches, 1, MAX_REPEAT_TOUCHES);
+    handler.item("repeat_retract_mm", _repeat_retract_mm, 0.1f, 100.0f);
+    handler.item("repeat_feed_rate_mm_per_min", _repeat_feed_rate, 0.0f, 100000.0f);
+    handler.item("repeat_tolerance_mm", _repeat_tolerance_mm, 0.0f, 10.0f);
 }
 void protocol_do_probe(void* arg) {
     Probe* p = config->_probe;
-    if (p->tripped() && probing) {
+    if ((p->latched() || p->tripped()) && probing) {
         probing = false;
-        get_motor_steps(probe_steps);
+        if (!p->latched_position(probe_steps, probe_fraction)) {
+            get_motor_steps(probe_steps);
+            memset(probe_fraction, 0, sizeof(probe_fraction));
+        }
         if (p->_hard_stop) {
             Stepper::reset();
             plan_reset();
@@ -6,6 +6,7 @@
 
 #include "Configuration/HandlerBase.h"
 #include "Configuration/Configurable.h"
+#include "Stepper.h"  // Stepper::PositionLatch
 
 #include <cstdint>
 
@@ -20,13 +21,26 @@ class Probe : public Configuration::Configurable {
         // Differs from the EventPin version by sending the event on either edge
         void trigger(bool active) override {
             InputPin::trigger(active);
-            protocol_send_event(_event, this);
+            protocol_forward_event(_event, this, &_latency);
         }
     };
 
     ProbeEventPin _probePin;
     ProbeEventPin _toolsetterPin;
 
+    // Probe pins on GPIOs also interrupt on both edges, and the interrupt latches the motor
+    // position when the probe trips.  The polled pin event alone is seen several milliseconds
+    // late, by which time the motors have moved on.
+    static const int MAX_LATCH_PINS = 2;
+    int                    _latchGpio[MAX_LATCH_PINS];
+    bool                   _latchActiveLow[MAX_LATCH_PINS];
+    int                    _latchPins = 0;
+    Stepper::PositionLatch _latch;
+    volatile bool          _latched = false;
+
+    void                  add_latch_pin(ProbeEventPin& pin);
+    static void IRAM_ATTR latch_isr(void* arg);
+
 public:
     bool _hard_stop = false;
     // Configurable
@@ -35,6 +49,16 @@ public:
     // during check mode. false sets the position to the probe target,
     // true sets the position to the start position.
 
+    // A G38.2 or G38.3 cycle can touch repeat_touches times, backing off by
+    // repeat_retract_mm and re-approaching at repeat_feed_rate_mm_per_min after
+    // the first contact.  The contact is the mean of the touches, leaving out those
+    // farther than repeat_tolerance_mm from the median when that is nonzero.
+    static const int MAX_REPEAT_TOUCHES   = 9;
+    int              _repeat_touches      = 1;
+    float            _repeat_retract_mm   = 1.0f;
+    float            _repeat_feed_rate    = 0.0f;  // 0 re-approaches at the programmed feed rate
+    float            _repeat_tolerance_mm = 0.0f;
+
     Probe() : _probePin("Probe"), _toolsetterPin("Toolsetter") {}
 
     // Configurable
@@ -51,6 +75,16 @@ public:
     // Returns true if the probe pin is tripped, depending on the direction (away or not)
     bool IRAM_ATTR tripped();
 
+    // Readies the position latch for a probing cycle.
+    void arm_latch() { _latched = false; }
+
+    // True once the interrupt has latched the trip position of the current cycle.
+    bool latched() { return _latched; }
+
+    // Gets the latched trip position in motor steps, with the part of a step beyond them.
+    // Returns false if no position was latched.
+    bool latched_position(int32_t* steps, float* fraction);
+
     ProbeEventPin& probePin() { return _probePin; }
     ProbeEventPin& toolsetterPin() { return _toolsetterPin; }
 
@@ -23,14 +23,41 @@
 #include "Driver/gpio_dump.h"     // gpio_dump()
 #include "FileCommands.h"         // make_file_commands()
 #include "Job.h"                  // Job::active()
+#include "SCurve.h"               // s_curve_cache_stats()
+#include "Stepper.h"              // Stepper::get_isr_stats()
+#include "Driver/delay_usecs.h"   // ticks_per_us
+#include "HeightMap.h"            // HeightMap::
+#include "ToolTable.h"            // ToolTable::
+#include "PowerLoss.h"            // PowerLoss::
+#include "Jog.h"                  // jog_velocity()
+#include "Simulation.h"           // Simulation::
+#include "LineLatency.h"          // LineLatency::
+#include "PlannerStats.h"         // PlannerStats::
+#include "Raster.h"               // Raster::space()
+#include "string_util.h"          // string_util::from_base64()
+#include "Motors/TrinamicBase.h"  // TrinamicBase::stream()
+#include "Machine/EventPin.h"     // EventPin::_all
+#include "WordIndex.h"            // WordIndex
+#include "HeapTag.h"              // HeapTag
+#include "Driver/heap.h"          // heap_region_stats()
+#include "Driver/iram_profile.h"  // iram_profile_entries()
+#include "Driver/pc_profile.h"    // pc_profile_start()
+#include "Parameters.h"           // params_line_arena(), get_param()
+#include "Expression.h"           // expression()
+#include "ModbusIO.h"             // ModbusIO::show_stats()
+#include "CrashRecord.h"          // CrashRecord::show()
+#include "LineArena.h"            // Arena
 
 #include "FluidPath.h"
 #include "HashFS.h"
+#include "Driver/config_partition.h"
 
 #include <cstring>
 #include <string_view>
 #include <map>
 #include <filesystem>
+#include <algorithm>  // std::sort
+#include <vector>
 
 // WG Readable and writable as guest
 // WU Readable and writable as user and admin
@@ -131,6 +158,8 @@ static void show_setting(const char* name, const char* value, const char* descri
 }
 
 void settings_restore(uint8_t restore_flag) {
+    Setting::Transaction transaction;
+
     if (restore_flag & SettingsRestore::Wifi) {
         for (Setting* s : Setting::List) {
             if (!s->getType() == WEBSET) {
@@ -259,17 +288,47 @@ static Error toggle_check_mode(const char* value, AuthenticationLevel auth_level
     // idle and ready, regardless of alarm locks. This is mainly to keep things
     // simple and consistent.
     if (state_is(State::CheckMode)) {
+        if (Simulation::active()) {
+            Simulation::report(out);
+            Simulation::stop();
+        }
         report_feedback_message(Message::Disabled);
         sys.abort = true;
     } else {
         if (!state_is(State::Idle)) {
             return Error::IdleError;  // Requires no alarm mode.
         }
+        Simulation::stop();
         set_state(State::CheckMode);
         report_feedback_message(Message::Enabled);
     }
     return Error::Ok;
 }
+// $CS is check mode with planner timing, see Simulation.h.  $CS=<file> also writes the step
+// timeline to the file.  Leaving it with $CS or $C reports the estimated cycle time.
+static Error toggle_simulation(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (state_is(State::CheckMode)) {
+        return toggle_check_mode(value, auth_level, out);
+    }
+    FileStream* timeline = nullptr;
+    if (value && *value) {
+        if (!state_is(State::Idle)) {
+            return Error::IdleError;
+        }
+        try {
+            timeline = new FileStream(value, "w");
+        } catch (Error err) {
+            return err;
+        }
+    }
+    Error err = toggle_check_mode(value, auth_level, out);
+    if (err == Error::Ok) {
+        Simulation::start(timeline);
+    } else {
+        delete timeline;
+    }
+    return err;
+}
 static Error isStuck() {
     // Block if a control pin is stuck on
     if (config->_control->safety_door_ajar()) {
@@ -544,6 +603,63 @@ static Error restore_settings(const char* value, AuthenticationLevel auth_level,
     return Error::Ok;
 }
 
+// Senders probe many settings when they connect, so the lookups use sorted
+// indexes instead of searching the lists
+static WordIndex<Command> command_index(true, true);
+static WordIndex<Setting> setting_index(true, false);
+static WordIndex<Setting> grbl_setting_index(false, true);
+
+// $Settings/Load=<file> applies the $name=value lines of a file, like the output
+// of $SC, in one settings transaction.  Lines that are not settings are skipped.
+static Error load_settings_file(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (!value || !*value) {
+        return Error::InvalidValue;
+    }
+    std::string text;
+    try {
+        FileStream file(value, "r");
+        text.resize(file.size());
+        text.resize(file.read(text.data(), text.size()));
+    } catch (...) {
+        log_error_to(out, "Cannot open " << value);
+        return Error::FsFailedOpenFile;
+    }
+
+    Setting::Transaction transaction;
+    std::string_view     rest(text);
+    std::string_view     line;
+    size_t               changed = 0;
+    size_t               failed  = 0;
+    while (string_util::split_prefix(rest, line, '\n')) {
+        line = string_util::trim(line);
+        if (line.empty() || line[0] != '$') {
+            continue;
+        }
+        std::string_view key(line.substr(1));
+        std::string_view setting_value;
+        if (!string_util::split(key, setting_value, '=')) {
+            continue;
+        }
+        key        = string_util::trim(key);
+        Setting* s = setting_index.find(Setting::List, key);
+        if (!s) {
+            s = grbl_setting_index.find(Setting::List, key);
+        }
+        if (!s) {
+            continue;
+        }
+        Error err = s->setStringValue(uriDecode(setting_value));
+        if (err == Error::Ok) {
+            ++changed;
+        } else {
+            log_error_to(out, "$" << key << ": " << errorString(err));
+            ++failed;
+        }
+    }
+    log_info_to(out, "Loaded " << changed << " settings from " << value << (failed ? ", with errors" : ""));
+    return failed ? Error::InvalidValue : Error::Ok;
+}
+
 static Error showState(const char* value, AuthenticationLevel auth_level, Channel& out) {
     const char* name;
     const State state = sys.state;
@@ -701,9 +817,31 @@ static Error dump_config(const char* value, AuthenticationLevel auth_level, Chan
         config->group(generator);
     } catch (std::exception& ex) { log_info("Config dump error: " << ex.what()); }
     if (value) {
-        drain_messages();
-        delete ss;
+        delete ss;  // FileStream lines are written as they are sent, so none are pending
+    }
+    return Error::Ok;
+}
+
+// Copies the configuration file into the config partition, from which the next
+// startup parses it in place.  $Config/Flash=erase goes back to the file.
+static Error flash_config(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (value && !strcasecmp(value, "erase")) {
+        return config_partition_erase() ? Error::FsFailedDelFile : Error::Ok;
+    }
+    const char* filename = config_filename->get();
+    std::string text;
+    try {
+        FileStream file(filename, "r", "");
+        text.resize(file.size());
+        text.resize(file.read(text.data(), text.size()));
+    } catch (...) {
+        log_error_to(out, "Cannot open " << filename);
+        return Error::FsFailedOpenFile;
+    }
+    if (config_partition_write(filename, text.data(), text.size())) {
+        return Error::FsFailedCreateFile;
     }
+    log_info_to(out, "Copied " << filename << " to the config partition");
     return Error::Ok;
 }
 
@@ -728,6 +866,97 @@ static Error showChannelInfo(const char* value, AuthenticationLevel auth_level,
     return Error::Ok;
 }
 
+// Traffic counters of each channel.  Any value resets them.
+static Error showChannelStats(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (value) {
+        allChannels.resetStats();
+        return Error::Ok;
+    }
+    allChannels.listStats(out);
+    return Error::Ok;
+}
+
+// Measures the throughput of the requesting channel with $Channel/Bench=<mode>[,<seconds>]:
+//   tx    the controller sends numbered 64-byte lines for the whole time
+//   rx    the controller counts what the sender sends
+//   echo  the controller sends back what the sender sends
+//   ok    the controller answers each line with "ok", like a GCode stream
+// The receiving modes end after the time, 10 s by default, or after 2 s without data.
+static Error benchChannel(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    std::string_view args(value ? value : "tx");
+    std::string_view mode;
+    string_util::split_prefix(args, mode, ',');
+    uint32_t seconds = 10;
+    if (!args.empty() && (!string_util::from_decimal(args, seconds) || seconds == 0 || seconds > 600)) {
+        return Error::BadNumberFormat;
+    }
+    bool tx   = string_util::equal_ignore_case(mode, "tx");
+    bool rx   = string_util::equal_ignore_case(mode, "rx");
+    bool echo = string_util::equal_ignore_case(mode, "echo");
+    bool ok   = string_util::equal_ignore_case(mode, "ok");
+    if (!(tx || rx || echo || ok)) {
+        return Error::InvalidValue;
+    }
+
+    const TickType_t duration = pdMS_TO_TICKS(seconds * 1000);
+    const TickType_t idle     = pdMS_TO_TICKS(2000);
+    char             buffer[256];
+    size_t           bytes_in  = 0;
+    size_t           bytes_out = 0;
+    size_t           lines     = 0;
+
+    out.pause();  // Stop input polling, so the data is not taken as commands
+    TickType_t start = xTaskGetTickCount();
+    TickType_t last  = start;
+    TickType_t now   = start;
+    while ((now = xTaskGetTickCount()) - start < duration) {
+        if (tx) {
+            int len = snprintf(buffer, sizeof(buffer), "[BENCH:%08u ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrst]\n", unsigned(lines));
+            bytes_out += out.write(reinterpret_cast<uint8_t*>(buffer), len);
+            ++lines;
+            continue;
+        }
+        size_t len = out.timedReadBytes(buffer, sizeof(buffer), 10);
+        if (len == 0) {
+            if (bytes_in && now - last >= idle) {
+                break;
+            }
+            continue;
+        }
+        if (bytes_in == 0) {
+            start = now;  // Time from the first data, not from the command
+        }
+        last = xTaskGetTickCount();
+        bytes_in += len;
+        for (size_t i = 0; i < len; i++) {
+            if (buffer[i] == '\n') {
+                ++lines;
+                if (ok) {
+                    bytes_out += out.write(reinterpret_cast<const uint8_t*>("ok\n"), 3);
+                }
+            }
+        }
+        if (echo) {
+            bytes_out += out.write(reinterpret_cast<uint8_t*>(buffer), len);
+        }
+    }
+    out.flush();
+    if (!tx) {
+        now = last;  // The idle wait at the end is not part of the transfer
+    }
+    out.resume();
+
+    float elapsed = float(now - start) * portTICK_PERIOD_MS / 1000.0f;
+    if (elapsed <= 0.0f) {
+        elapsed = 0.001f;
+    }
+    log_info_to(out,
+                "Channel bench " << mode << " " << out.name() << ": in " << bytes_in << " bytes out " << bytes_out << " bytes " << lines
+                                 << " lines in " << setprecision(2) << elapsed << "s, in " << setprecision(0) << bytes_in / elapsed
+                                 << " B/s out " << bytes_out / elapsed << " B/s " << setprecision(1) << lines / elapsed << " lines/s");
+    return Error::Ok;
+}
+
 static Error showStartupLog(const char* value, AuthenticationLevel auth_level, Channel& out) {
     StartupLog::dump(out);
     return Error::Ok;
@@ -847,6 +1076,60 @@ static Error uartPassthrough(const char* value, AuthenticationLevel auth_level,
     return Error::Ok;
 }
 
+static Error setAckBatch(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (value) {
+        int32_t intValue;
+        if (!string_util::from_decimal(value, intValue)) {
+            return Error::BadNumberFormat;
+        }
+        if (intValue < 0 || intValue > Channel::maxAckBatch) {
+            return Error::NumberRange;
+        }
+        out.setAckBatch(intValue);
+    }
+    int actual = out.getAckBatch();
+    if (actual > 1) {
+        log_info_to(out, out.name() << " acknowledges up to " << actual << " lines with ok:N");
+    } else {
+        log_info_to(out, out.name() << " acknowledges each line with ok");
+    }
+    return Error::Ok;
+}
+
+static Error setFrameInterval(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (value) {
+        uint32_t intValue;
+        if (!string_util::from_decimal(value, intValue)) {
+            return Error::BadNumberFormat;
+        }
+        if (!out.setFrameInterval(intValue)) {
+            log_error_to(out, out.name() << " cannot send binary status frames");
+            return Error::InvalidStatement;
+        }
+    }
+    uint32_t actual = out.getFrameInterval();
+    if (actual) {
+        log_info_to(out, out.name() << " status frame interval is " << actual << " ms");
+    } else {
+        log_info_to(out, out.name() << " status frames are off");
+    }
+    return Error::Ok;
+}
+
+static Error setReportDelta(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (value && *value) {
+        if (string_util::equal_ignore_case(value, "on")) {
+            out.setReportDelta(true);
+        } else if (string_util::equal_ignore_case(value, "off")) {
+            out.setReportDelta(false);
+        } else {
+            return Error::InvalidValue;
+        }
+    }
+    log_info_to(out, out.name() << " auto reports " << (out.getReportDelta() ? "carry only changed fields" : "are complete"));
+    return Error::Ok;
+}
+
 static Error setReportInterval(const char* value, AuthenticationLevel auth_level, Channel& out) {
     if (!value) {
         uint32_t actual = out.getReportInterval();
@@ -877,6 +1160,31 @@ static Error setReportInterval(const char* value, AuthenticationLevel auth_level
     return Error::Ok;
 }
 
+// $Motors/Stream=<ms>[,<threshold>] streams the Trinamic load values to this
+// channel while moving; $Motors/Stream=0 stops it
+static Error streamMotors(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    uint32_t interval  = 0;
+    uint32_t threshold = 0;
+    if (value) {
+        std::string_view rest(value);
+        std::string_view first;
+        string_util::split_prefix(rest, first, ',');
+        if (!string_util::from_decimal(first, interval) || (!rest.empty() && !string_util::from_decimal(rest, threshold))) {
+            return Error::BadNumberFormat;
+        }
+        if (!MotorDrivers::TrinamicBase::stream(out, interval, threshold)) {
+            log_error_to(out, "No Trinamic drivers can stream their load");
+            return Error::InvalidStatement;
+        }
+    }
+    if (MotorDrivers::TrinamicBase::streaming(interval, threshold)) {
+        log_info_to(out, "Motor load stream every " << interval << " ms, stall threshold " << threshold);
+    } else {
+        log_info_to(out, "Motor load stream is off");
+    }
+    return Error::Ok;
+}
+
 static Error sendAlarm(const char* value, AuthenticationLevel auth_level, Channel& out) {
     int       intValue = value ? atoi(value) : 0;
     ExecAlarm alarm    = static_cast<ExecAlarm>(intValue);
@@ -887,6 +1195,618 @@ static Error sendAlarm(const char* value, AuthenticationLevel auth_level, Channe
 
 static Error showHeap(const char* value, AuthenticationLevel auth_level, Channel& out) {
     log_info("Heap free: " << xPortGetFreeHeapSize() << " min: " << heapLowWater);
+    log_info("Log lines in use: " << log_lines_in_use() << " pool misses: " << log_line_pool_misses());
+    return Error::Ok;
+}
+
+// Fragmentation shows as a largest block that is much smaller than the free space
+static Error showHeapStats(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    for (int r = 0; r < HEAP_NREGIONS; r++) {
+        auto                region = heap_region_t(r);
+        heap_region_stats_t stats;
+        if (heap_region_stats(region, stats)) {
+            log_stream(out,
+                       "[Heap " << heap_region_name(region) << " total:" << stats.total << " free:" << stats.free
+                                << " largest:" << stats.largest_block << " min:" << stats.min_free << " blocks:" << stats.allocated_blocks
+                                << " free_blocks:" << stats.free_blocks << "]");
+        }
+    }
+    for (auto tag = HeapTag::first(); tag; tag = tag->next()) {
+        log_stream(out,
+                   "[Heap " << tag->name() << " bytes:" << tag->bytes() << " peak:" << tag->peak() << " buffers:" << tag->in_use()
+                            << " allocs:" << tag->allocs() << "]");
+    }
+    auto& arena = params_line_arena();
+    log_stream(out, "[Heap GCode line arena size:" << arena.size() << " peak:" << arena.high_water() << " overflows:" << arena.overflows() << "]");
+    return Error::Ok;
+}
+
+static Error showTasks(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    report_tasks(out);
+    return Error::Ok;
+}
+
+// $IRAM/Profile lists the functions that ran since boot or the last $IRAM/Profile=reset,
+// in the form that ld/esp32/iram_report.py --profile reads
+static Error showIramProfile(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (!iram_profile_enabled()) {
+        log_error_to(out, "Build with the iram_profile environment to profile functions");
+        return Error::InvalidValue;
+    }
+    if (value) {
+        if (strcasecmp(value, "reset")) {
+            return Error::InvalidValue;
+        }
+        iram_profile_reset();
+        return Error::Ok;
+    }
+    const size_t max_entries = 1024;
+    auto         entries     = new iram_profile_entry_t[max_entries];
+    size_t       n           = iram_profile_entries(entries, max_entries);
+    for (size_t i = 0; i < n; ++i) {
+        auto& e = entries[i];
+        if (e.isr_calls || e.task_calls) {
+            log_stream(out, "[IRAM " << to_hex(uint32_t(e.address)) << " isr:" << e.isr_calls << " task:" << e.task_calls << "]");
+        }
+    }
+    delete[] entries;
+    if (iram_profile_dropped()) {
+        log_warn_to(out, iram_profile_dropped() << " calls were not counted because the table is full");
+    }
+    return Error::Ok;
+}
+
+// $Profile/Start[=hz] samples the program counter of each core, 1000 times per second by
+// default, until $Profile/Stop or $Profile/Dump.  $Profile/Dump[=n] lists the n, or all,
+// most sampled addresses in the form that ld/esp32/pc_profile_report.py reads.
+static const size_t pc_profile_ring = 8192;  // Samples kept per core
+
+static Error startPcProfile(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (!pc_profile_supported()) {
+        log_error_to(out, "Sampling is not supported on this processor");
+        return Error::InvalidValue;
+    }
+    uint32_t hz = 1000;
+    if (value) {
+        char* end;
+        hz = strtoul(value, &end, 10);
+        if (*end || hz == 0 || hz > 50000) {
+            return Error::InvalidValue;
+        }
+    }
+    if (!pc_profile_start(hz, pc_profile_ring)) {
+        log_error_to(out, "Cannot allocate the sample buffers");
+        return Error::InvalidValue;
+    }
+    log_info_to(out, "Sampling at " << hz << " Hz");
+    return Error::Ok;
+}
+
+static Error stopPcProfile(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    pc_profile_stop();
+    return Error::Ok;
+}
+
+static Error dumpPcProfile(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    size_t top = SIZE_MAX;
+    if (value) {
+        char* end;
+        top = strtoul(value, &end, 10);
+        if (*end || top == 0) {
+            return Error::InvalidValue;
+        }
+    }
+    pc_profile_stop();
+
+    auto samples = new pc_sample_t[pc_profile_ring];
+    for (int core = 0; core < pc_profile_cores(); core++) {
+        size_t n = pc_profile_samples(core, samples, pc_profile_ring);
+        log_stream(out, "[Profile core:" << core << " taken:" << pc_profile_taken(core) << " kept:" << n << "]");
+
+        // Count the samples of each address, then list the addresses by count
+        std::sort(samples, samples + n, [](const pc_sample_t& a, const pc_sample_t& b) { return a.pc < b.pc; });
+        struct Hit {
+            uint32_t pc;
+            uint32_t count;
+            uint32_t isr;
+        };
+        std::vector<Hit> hits;
+        for (size_t i = 0; i < n; i++) {
+            if (hits.empty() || hits.back().pc != samples[i].pc) {
+                hits.push_back({ samples[i].pc, 0, 0 });
+            }
+            ++hits.back().count;
+            hits.back().isr += samples[i].isr;
+        }
+        std::sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b) { return a.count > b.count; });
+        for (size_t i = 0; i < hits.size() && i < top; i++) {
+            auto& hit = hits[i];
+            log_stream(out, "[PC " << to_hex(hit.pc) << " core:" << core << " samples:" << hit.count << " isr:" << hit.isr << "]");
+        }
+    }
+    delete[] samples;
+    return Error::Ok;
+}
+
+static Error showSCurveCache(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (value) {
+        s_curve_cache_reset();
+    }
+    auto stats = s_curve_cache_stats();
+    log_stream(out,
+               "[SCurveCache hits:" << stats.hits << " misses:" << stats.misses << " entries:" << stats.entries << "/" << stats.capacity
+                                    << "]");
+    return Error::Ok;
+}
+
+static Error showStepperStats(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (value) {
+        Stepper::reset_isr_stats();
+    }
+    Stepper::IsrStats stats;
+    Stepper::get_isr_stats(stats);
+    if (stats.count == 0) {
+        log_stream(out, "[Stepper ISR calls:0 underruns:" << stats.underruns << "]");
+        return Error::Ok;
+    }
+    log_stream(out,
+               "[Stepper ISR calls:" << stats.count << " min:" << float(stats.min_ticks) / ticks_per_us
+                                     << "us max:" << float(stats.max_ticks) / ticks_per_us
+                                     << "us io_max:" << float(stats.max_io_ticks) / ticks_per_us << "us underruns:" << stats.underruns
+                                     << "]");
+    LogStream msg(out, MsgLevelNone);
+    msg << "[Stepper ISR histogram";
+    for (int i = 0; i < Stepper::IsrStats::n_bins; i++) {
+        if (i == Stepper::IsrStats::n_bins - 1) {
+            msg << " >=" << (1 << (i - 1));
+        } else {
+            msg << " <" << (1 << i);
+        }
+        msg << "us:" << stats.histogram[i];
+    }
+    msg << "]";
+    return Error::Ok;
+}
+
+// Shows how long input pin changes take to reach the actions on them, which bounds the
+// reaction time of safety_door_pin, estop_pin and the other control pins.
+static Error showEventStats(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (value) {
+        protocol_reset_event_queue_stats();
+        for (auto pin : EventPin::_all) {
+            pin->_latency = EventLatency();
+        }
+    }
+    EventQueueStats queue;
+    protocol_get_event_queue_stats(queue);
+    log_stream(out,
+               "[Event queue size:" << EVENT_QUEUE_SIZE << " urgent:" << EVENT_URGENT_QUEUE_SIZE << " peak:" << queue.peak
+                                    << " overflows:" << queue.overflows << " merged:" << queue.merged << "]");
+    for (auto pin : EventPin::_all) {
+        auto& latency = pin->_latency;
+        if (latency.count == 0) {
+            continue;
+        }
+        LogStream msg(out, MsgLevelNone);
+        msg << "[Event " << pin->legend() << " count:" << latency.count << " max:" << float(latency.max_ticks) / ticks_per_us << "us";
+        for (int i = 0; i < EventLatency::n_bins; i++) {
+            if (i == EventLatency::n_bins - 1) {
+                msg << " >=" << (EventLatency::bin0_max << (i - 1));
+            } else {
+                msg << " <" << (EventLatency::bin0_max << i);
+            }
+            msg << "us:" << latency.histogram[i];
+        }
+        msg << "]";
+    }
+    return Error::Ok;
+}
+
+// Times the parser on representative lines, with the output of the host micro-benchmarks
+// in tests/MicroBenchTest.cpp, one JSON object per case.  gc_execute_line() is only timed
+// in check mode, where the CAM lines change the parser state but move nothing.
+// Finds the highest step event rate that the stepping engine of this configuration sustains,
+// raising the rate by a quarter until more than 1% of the events overrun.  The result is
+// also bounded by the engine's theoretical rate and, after a motion without pulse trains,
+// by the longest step ISR call that the motion measured.
+static Error benchStepping(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (!state_is(State::Idle) && !state_is(State::Alarm)) {
+        return Error::IdleError;
+    }
+    const char* engine    = stepTypes[Machine::Stepping::_engine].name;
+    uint32_t    theory    = Machine::Stepping::maxPulsesPerSec();
+    uint32_t    sustained = 0;
+
+    for (uint32_t rate = 5000; rate <= 1000000 && rate <= 2 * theory; rate += rate / 4) {
+        Machine::Stepping::BenchStats stats;
+        Machine::Stepping::bench(rate, std::max(rate / 20, uint32_t(1000)), stats);  // About 50 ms each
+        {
+            LogStream msg(out, MsgLevelNone);
+            msg << "[BENCH:{\"name\":\"step\",\"engine\":\"" << engine << "\",\"rate\":" << rate;
+            msg << ",\"mean_us\":" << setprecision(2) << float(stats.mean_ticks) / ticks_per_us;
+            msg << ",\"max_us\":" << setprecision(2) << float(stats.max_ticks) / ticks_per_us;
+            msg << ",\"max_late_us\":" << setprecision(2) << float(stats.max_late_ticks) / ticks_per_us;
+            msg << ",\"overruns\":" << stats.overruns << "}]";
+        }
+        delay_ms(1);  // Let the other tasks on this core run between rates
+        if (stats.overruns * 100 > stats.events) {
+            break;
+        }
+        sustained = rate;
+    }
+
+    uint32_t limit = std::min(sustained, theory);
+    Stepper::IsrStats isr;
+    Stepper::get_isr_stats(isr);
+    if (isr.count && isr.max_ticks && !Machine::Stepping::_pulseTrains) {
+        limit = std::min(limit, uint32_t(uint64_t(ticks_per_us) * 1000000 / isr.max_ticks));
+    }
+    log_info_to(out, "Step rate " << engine << " sustained:" << sustained << " theoretical:" << theory << " limit:" << limit);
+    return Error::Ok;
+}
+
+static Error benchGCode(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (!state_is(State::Idle) && !state_is(State::CheckMode)) {
+        return Error::IdleError;
+    }
+    const int iterations = 1000;
+
+    auto bench = [&](const char* name, auto fn) {
+        uint32_t start = getCpuTicks();
+        for (int i = 0; i < iterations; i++) {
+            fn(i);
+        }
+        float ns = float(getCpuTicks() - start) * 1000.0f / ticks_per_us / iterations;
+        log_stream(out, "[BENCH:{\"name\":\"" << name << "\",\"iterations\":" << iterations << ",\"ns_per_op\":" << setprecision(1) << ns << "}]");
+    };
+
+    set_named_param("_BENCH_X", 12.5f);
+    set_named_param("_BENCH_DEPTH", -1.0f);
+
+    float       result;
+    const char* expressions[] = {
+        "[#<_BENCH_X>*2+1]",
+        "[#<_BENCH_X>+#<_BENCH_DEPTH>*SIN[30]]",
+        "[[#<_BENCH_X> GT 10] AND [#<_BENCH_DEPTH> LT 0]]",
+    };
+    bench("expression", [&](int i) {
+        size_t pos = 0;
+        expression(expressions[i % 3], pos, result);
+    });
+
+    param_ref_t named { "_BENCH_X", 0 };
+    bench("get_param_named", [&](int i) { get_param(named, result); });
+    param_ref_t numbered { "", 5221 };  // G54 X
+    bench("get_param_numbered", [&](int i) { get_param(numbered, result); });
+    bench("set_param_named", [&](int i) { set_named_param("_BENCH_X", float(i)); });
+
+    const char* lines[] = {
+        "G1 X12.345 Y-6.789 F1500",
+        "g1x12.345y-6.789 (cut) z-0.5",
+        "N120 G2 X10 Y10 I5 J0 ; arc",
+    };
+    bench("collapse_gcode", [&](int i) {
+        char line[64];
+        strcpy(line, lines[i % 3]);
+        collapseGCode(line);
+    });
+
+    if (state_is(State::CheckMode) && !Simulation::active()) {
+        const char* cam[] = {
+            "G1 X10.123 Y5.456 F1200",
+            "X10.234 Y5.512",
+            "G1 X10.345 Y5.598 Z-0.250",
+            "G2 X11 Y6 I0.5 J0.2",
+        };
+        bench("gc_execute_line", [&](int i) { gc_execute_line(cam[i % 4]); });
+    }
+    return Error::Ok;
+}
+
+// How well the sender keeps the planner fed, see PlannerStats.h.  Any value resets the totals.
+static Error showPlannerStats(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (value) {
+        PlannerStats::reset();
+    }
+    PlannerStats::Stats total, job;
+    PlannerStats::get(total, job);
+    const std::pair<const char*, const PlannerStats::Stats&> scopes[] = {
+        { "total", total },
+        { "job", job },
+    };
+    for (auto& scope : scopes) {
+        auto& stats = scope.second;
+        log_stream(out,
+                   "[Planner " << scope.first << " blocked:" << stats.blocked << " blocked_time:" << setprecision(3)
+                               << float(stats.blocked_ticks / ticks_per_us) / 1000000 << "s starved:" << stats.starved << "]");
+        log_stream(out, "[Planner " << scope.first << " occupancy " << PlannerStats::occupancy(stats.planner_ticks) << "]");
+        log_stream(out, "[Planner " << scope.first << " segments " << PlannerStats::occupancy(stats.segment_ticks) << "]");
+    }
+    return Error::Ok;
+}
+
+// How long lines take from their arrival to their first step, by stage, see LineLatency.h.
+// =on and =off start and stop tracing, =reset clears the histograms.
+static Error showLineLatency(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (value) {
+        if (!strcasecmp(value, "on")) {
+            LineLatency::enable(true);
+        } else if (!strcasecmp(value, "off")) {
+            LineLatency::enable(false);
+        } else if (!strcasecmp(value, "reset")) {
+            LineLatency::reset();
+        } else {
+            return Error::InvalidValue;
+        }
+        return Error::Ok;
+    }
+    LineLatency::Stats stats;
+    LineLatency::get(stats);
+    log_stream(out, "[Line latency tracing:" << (LineLatency::enabled() ? "on" : "off") << "]");
+    const std::pair<const char*, const EventLatency&> stages[] = {
+        { "queue", stats.queue },
+        { "gcode", stats.gcode },
+        { "motion", stats.motion },
+        { "total", stats.total },
+    };
+    for (auto& stage : stages) {
+        auto& latency = stage.second;
+        if (latency.count == 0) {
+            continue;
+        }
+        LogStream msg(out, MsgLevelNone);
+        msg << "[Line " << stage.first << " count:" << latency.count << " max:" << float(latency.max_ticks) / ticks_per_us << "us";
+        for (int i = 0; i < EventLatency::n_bins; i++) {
+            if (i == EventLatency::n_bins - 1) {
+                msg << " >=" << (EventLatency::bin0_max << (i - 1));
+            } else {
+                msg << " <" << (EventLatency::bin0_max << i);
+            }
+            msg << "us:" << latency.histogram[i];
+        }
+        msg << "]";
+    }
+    return Error::Ok;
+}
+
+static Error showSpindleStats(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    spindle->print_stats(out, value != nullptr);
+    return Error::Ok;
+}
+
+// Queues base64-encoded grayscale pixels for the scanline of the next linear feed motion,
+// see Raster.h.  A scanline longer than one line can take is sent as several commands.
+static Error queueRaster(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (!value || !*value) {
+        return Error::InvalidValue;
+    }
+    if (!spindle->isRateAdjusted() || !config->_kinematics->native_arcs()) {
+        log_error_to(out, "Raster engraving needs a laser and cartesian kinematics");
+        return Error::GcodeUnsupportedCommand;
+    }
+    uint8_t pixels[LINE_BUFFER_SIZE * 3 / 4];
+    int     count = string_util::from_base64(value, pixels, sizeof(pixels));
+    if (count < 0 || plan_raster_pending() + count > Raster::BUFFER_SIZE) {
+        return Error::InvalidValue;
+    }
+    if (state_is(State::CheckMode)) {
+        return Error::Ok;  // No motion takes the pixels
+    }
+    while (Raster::space() < size_t(count)) {
+        protocol_auto_cycle_start();  // Let the scanlines ahead of it run
+        protocol_execute_realtime();
+        if (sys.abort) {
+            return Error::Reset;
+        }
+    }
+    plan_sync_raster(pixels, count);
+    return Error::Ok;
+}
+
+static void dumpStepperTrace(Channel& out) {
+    size_t n = Stepper::trace_count();
+    if (n == 0) {
+        log_stream(out, "[Stepper trace empty]");
+        return;
+    }
+    Stepper::TraceEntry newest;
+    Stepper::get_trace_entry(n - 1, newest);
+    auto n_axis = Axes::_numberAxis;
+    for (size_t i = 0; i < n; i++) {
+        Stepper::TraceEntry entry;
+        if (!Stepper::get_trace_entry(i, entry)) {
+            break;
+        }
+        // Times are relative to the newest entry, which is exact for a trace shorter than the
+        // wrap time of the cycle counter.
+        int32_t   us = int32_t(entry.time - newest.time) / int32_t(ticks_per_us);
+        LogStream msg(out, MsgLevelNone);
+        msg << "[TRACE seg:" << entry.segment << " t:" << us << "us ln:" << entry.line_number << " steps:";
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            if (axis) {
+                msg << ",";
+            }
+            msg << entry.steps[axis];
+        }
+        msg << "]";
+    }
+}
+
+// $Stepper/Trace shows the segment trace, $Stepper/Trace=clear restarts it, and
+// $Stepper/Trace=<file> writes it to a file, for example /sd/trace.txt after an alarm.
+static Error showStepperTrace(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (Stepping::_traceSegments == 0) {
+        log_error_to(out, "stepping/trace_segments is 0");
+        return Error::InvalidValue;
+    }
+    if (!value || !*value) {
+        dumpStepperTrace(out);
+        return Error::Ok;
+    }
+    if (strcasecmp(value, "clear") == 0) {
+        Stepper::reset_trace();
+        return Error::Ok;
+    }
+    try {
+        FileStream file(value, "w");
+        dumpStepperTrace(file);
+        log_info_to(out, "Wrote " << Stepper::trace_count() << " trace entries to " << file.path());
+    } catch (...) {
+        log_error_to(out, "Cannot open " << value);
+        return Error::FsFailedCreateFile;
+    }
+    return Error::Ok;
+}
+
+// $HeightMap/Probe=<x0>,<y0>,<x1>,<y1>,<nx>,<ny>,<depth>,<clearance>,<feed> probes a grid
+// over the rectangle in work coordinates, see HeightMap::probe().
+static Error probeHeightMap(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (state_is(State::Alarm) || state_is(State::ConfigAlarm)) {
+        return Error::SystemGcLock;
+    }
+    const int        n_args = 9;
+    float            args[n_args];
+    std::string_view rest(value ? value : "");
+    int              n = 0;
+    std::string_view token;
+    while (n < n_args && string_util::split_prefix(rest, token, ',')) {
+        if (!string_util::from_float(string_util::trim(token), args[n])) {
+            return Error::BadNumberFormat;
+        }
+        ++n;
+    }
+    if (n < n_args || !rest.empty()) {
+        log_error_to(out, "Usage: $HeightMap/Probe=x0,y0,x1,y1,nx,ny,depth,clearance,feed");
+        return Error::InvalidValue;
+    }
+    return HeightMap::probe(out, args[0], args[1], args[2], args[3], int(args[4]), int(args[5]), args[6], args[7], args[8]);
+}
+
+static Error showHeightMap(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    HeightMap::show(out);
+    return Error::Ok;
+}
+
+// $HeightMap/Enable=on|off turns compensation on or off; without a value it shows the state.
+static Error enableHeightMap(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (!value || !*value) {
+        log_stream(out, "[HEIGHTMAP " << (HeightMap::active() ? "on" : "off") << "]");
+        return Error::Ok;
+    }
+    if (string_util::equal_ignore_case(value, "on")) {
+        if (!HeightMap::loaded()) {
+            log_error_to(out, "No height map");
+            return Error::InvalidStatement;
+        }
+        HeightMap::enable(true);
+    } else if (string_util::equal_ignore_case(value, "off")) {
+        HeightMap::enable(false);
+    } else {
+        return Error::InvalidValue;
+    }
+    return Error::Ok;
+}
+
+static Error saveHeightMap(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    return HeightMap::save(value && *value ? value : HeightMap::DEFAULT_FILE, out);
+}
+
+static Error loadHeightMap(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    return HeightMap::load(value && *value ? value : HeightMap::DEFAULT_FILE, out);
+}
+
+static Error clearHeightMap(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    HeightMap::clear();
+    return Error::Ok;
+}
+
+static Error showTools(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    ToolTable::show(out);
+    return Error::Ok;
+}
+
+// $Tools/Set=T<n> L<length> D<diameter> X<x> Y<y> Z<z> adds or replaces a tool, see ToolTable.h
+static Error setTool(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    ToolTable::Tool tool;
+    if (!value || !ToolTable::parse_line(value, tool) || !tool.number) {
+        log_error_to(out, "Usage: $Tools/Set=T<n> L<length> D<diameter> X<x> Y<y> Z<z>");
+        return Error::InvalidValue;
+    }
+    ToolTable::table.set(tool);
+    return ToolTable::save(ToolTable::DEFAULT_FILE, out);
+}
+
+// $Tools/Forget=<n> removes a tool, so that a tool changer measures it again
+static Error forgetTool(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    uint32_t number;
+    if (!value || !string_util::from_decimal(value, number)) {
+        return Error::BadNumberFormat;
+    }
+    if (!ToolTable::table.erase(number)) {
+        log_error_to(out, "Tool " << number << " is not in the table");
+        return Error::InvalidValue;
+    }
+    return ToolTable::save(ToolTable::DEFAULT_FILE, out);
+}
+
+// $Tools/Measured=<n> records the machine Z of the last probe as the length of tool n.
+// Tool changer macros issue it after probing the tool setter.
+static Error measuredTool(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    uint32_t number;
+    if (!value || !string_util::from_decimal(value, number) || !number) {
+        return Error::BadNumberFormat;
+    }
+    if (!probe_succeeded) {
+        log_error_to(out, "No probe contact for tool " << number);
+        return Error::InvalidStatement;
+    }
+    float probe_position[MAX_N_AXIS];
+    probe_steps_to_mpos(probe_position);
+    ToolTable::set_length(number, probe_position[Z_AXIS]);
+    return Error::Ok;
+}
+
+static Error saveTools(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    return ToolTable::save(value && *value ? value : ToolTable::DEFAULT_FILE, out);
+}
+
+static Error loadTools(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    return ToolTable::load(value && *value ? value : ToolTable::DEFAULT_FILE, out);
+}
+
+// $Jog/Velocity=X1 Y-1 F1000 jogs by velocity, see jog_velocity() in Jog.h
+static Error velocityJog(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    return jog_velocity(value ? value : "", out);
+}
+
+static Error showPowerLoss(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    PowerLoss::show(out);
+    return Error::Ok;
+}
+
+// $PowerLoss/Resume homes, since the position was lost with the power, and starts the
+// unfinished job at the line after the last record, see PowerLoss.h
+static Error resumePowerLoss(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    PowerLoss::Record record;
+    std::string       path;
+    if (!PowerLoss::pending(record, path)) {
+        log_error_to(out, "No unfinished job");
+        return Error::InvalidStatement;
+    }
+    if (Machine::Axes::homingMask) {
+        Error err = home(Machine::Homing::AllCycles, out);
+        if (err != Error::Ok) {
+            return err;
+        }
+        if (!state_is(State::Idle)) {
+            return Error::IdleError;
+        }
+    }
+    return startFile("", path.c_str(), record.line + 1, 0, out);
+}
+
+static Error clearPowerLoss(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    PowerLoss::clear();
     return Error::Ok;
 }
 
@@ -899,7 +1819,10 @@ void make_user_commands() {
     new UserCommand("GD", "GPIO/Dump", showGPIOs, anyState);
 
     new UserCommand("CI", "Channel/Info", showChannelInfo, anyState);
+    new UserCommand("", "Channels/Stats", showChannelStats, anyState);
+    new UserCommand("", "Channel/Bench", benchChannel, anyState);
     new UserCommand("CD", "Config/Dump", dump_config, anyState);
+    new UserCommand("", "Config/Flash", flash_config, notIdleOrAlarm, WA);
     new UserCommand("", "Help", show_help, anyState);
     new UserCommand("T", "State", showState, anyState);
 
@@ -912,6 +1835,7 @@ void make_user_commands() {
     new UserCommand("A", "Alarms/List", listAlarms, anyState);
     new UserCommand("E", "Errors/List", listErrors, anyState);
     new UserCommand("C", "GCode/Check", toggle_check_mode, anyState);
+    new UserCommand("CS", "GCode/Simulate", toggle_simulation, anyState);
     new UserCommand("X", "Alarm/Disable", disable_alarm_lock, anyState);
     new UserCommand("NVX", "Settings/Erase", Setting::eraseNVS, notIdleOrAlarm, WA);
     new UserCommand("V", "Settings/Stats", Setting::report_nvs_stats, notIdleOrAlarm);
@@ -942,19 +1866,60 @@ void make_user_commands() {
     new UserCommand("SLP", "System/Sleep", go_to_sleep, notIdleOrAlarm);
     new UserCommand("I", "Build/Info", get_report_build_info, notIdleOrAlarm);
     new UserCommand("RST", "Settings/Restore", restore_settings, notIdleOrAlarm, WA);
+    new UserCommand("SL", "Settings/Load", load_settings_file, notIdleOrAlarm, WA);
 
     new UserCommand("SA", "Alarm/Send", sendAlarm, anyState);
     new UserCommand("Heap", "Heap/Show", showHeap, anyState);
+    new UserCommand("", "Heap/Stats", showHeapStats, anyState);
+    new UserCommand("", "Tasks", showTasks, anyState);
+    new UserCommand("", "IRAM/Profile", showIramProfile, anyState);
+    new UserCommand("", "Profile/Start", startPcProfile, anyState);
+    new UserCommand("", "Profile/Stop", stopPcProfile, anyState);
+    new UserCommand("", "Profile/Dump", dumpPcProfile, anyState);
+    new UserCommand("SCC", "SCurve/Cache", showSCurveCache, anyState);
+    new UserCommand("STS", "Stepper/Stats", showStepperStats, anyState);
+    new UserCommand("EVS", "Events/Stats", showEventStats, anyState);
+    new UserCommand("", "Line/Latency", showLineLatency, anyState);
+    new UserCommand("", "Planner/Stats", showPlannerStats, anyState);
+    new UserCommand("", "GCode/Bench", benchGCode, anyState);
+    new UserCommand("", "Stepping/Bench", benchStepping, anyState);
+    new UserCommand("STT", "Stepper/Trace", showStepperTrace, anyState);
+    new UserCommand("MLS", "Motors/Stream", streamMotors, anyState);
+    new UserCommand("SPS", "Spindle/Stats", showSpindleStats, anyState);
+    new UserCommand("", "ModbusIO/Stats", ModbusIO::show_stats, anyState);
+    new UserCommand("RL", "Laser/Raster", queueRaster, anyState);
+    new UserCommand("HMP", "HeightMap/Probe", probeHeightMap, notIdleOrAlarm);
+    new UserCommand("HM", "HeightMap/Show", showHeightMap, anyState);
+    new UserCommand("HME", "HeightMap/Enable", enableHeightMap, notIdleOrAlarm);
+    new UserCommand("HMS", "HeightMap/Save", saveHeightMap, notIdleOrAlarm);
+    new UserCommand("HML", "HeightMap/Load", loadHeightMap, notIdleOrAlarm);
+    new UserCommand("HMC", "HeightMap/Clear", clearHeightMap, notIdleOrAlarm);
+    new UserCommand("TLS", "Tools/Show", showTools, anyState);
+    new UserCommand("TLT", "Tools/Set", setTool, notIdleOrAlarm);
+    new UserCommand("TLF", "Tools/Forget", forgetTool, notIdleOrAlarm);
+    new UserCommand("", "Tools/Measured", measuredTool, anyState);
+    new UserCommand("TLW", "Tools/Save", saveTools, notIdleOrAlarm);
+    new UserCommand("TLL", "Tools/Load", loadTools, notIdleOrAlarm);
+    new UserCommand("PLS", "PowerLoss/Show", showPowerLoss, anyState);
+    new UserCommand("PLR", "PowerLoss/Resume", resumePowerLoss, notIdleOrAlarm);
+    new UserCommand("PLC", "PowerLoss/Clear", clearPowerLoss, notIdleOrAlarm);
     new UserCommand("SS", "Startup/Show", showStartupLog, anyState);
+    new UserCommand("", "Crash/Show", CrashRecord::show, anyState);
+    new UserCommand("", "Crash/Save", CrashRecord::save, anyState);
+    new UserCommand("", "Crash/Clear", CrashRecord::clear, anyState);
     new UserCommand("UP", "Uart/Passthrough", uartPassthrough, notIdleOrAlarm);
 
     new UserCommand("RI", "Report/Interval", setReportInterval, anyState);
+    new UserCommand("AB", "Report/AckBatch", setAckBatch, anyState);
+    new UserCommand("RF", "Report/Frames", setFrameInterval, anyState);
+    new UserCommand("RD", "Report/Delta", setReportDelta, anyState);
 
     new UserCommand("13", "Report/Inches", switchInchMM, notIdleOrAlarm);
 
     new UserCommand("GS", "GRBL/Show", report_init_message_cmd, notIdleOrAlarm);
 
     new AsyncUserCommand("J", "Jog", doJog, notIdleOrJog);
+    new AsyncUserCommand("JV", "Jog/Velocity", velocityJog, notIdleOrJog);
     new AsyncUserCommand("G", "GCode/Modes", report_gcode, anyState);
 };
 
@@ -969,21 +1934,18 @@ Error do_command_or_setting(std::string_view key, std::string_view value, Authen
     // Try to execute a command.  Commands handle values internally;
     // you cannot determine whether to set or display solely based on
     // the presence of a value.
-    for (Command* cp : Command::List) {
-        if (string_util::equal_ignore_case(cp->getName(), key) ||
-            (cp->getGrblName() && string_util::equal_ignore_case(cp->getGrblName(), key))) {
-            if (auth_failed(cp, value, auth_level)) {
-                return Error::AuthenticationFailed;
-            }
-            if (cp->synchronous()) {
-                protocol_buffer_synchronize();
-            }
-            if (value.empty()) {
-                return cp->action(nullptr, auth_level, out);
-            }
-            std::string s(value);
-            return cp->action(s.c_str(), auth_level, out);
+    if (Command* cp = command_index.find(Command::List, key)) {
+        if (auth_failed(cp, value, auth_level)) {
+            return Error::AuthenticationFailed;
+        }
+        if (cp->synchronous()) {
+            protocol_buffer_synchronize();
+        }
+        if (value.empty()) {
+            return cp->action(nullptr, auth_level, out);
         }
+        std::string s(value);
+        return cp->action(s.c_str(), auth_level, out);
     }
 
     // First search the yaml settings by name. If found, set a new
@@ -1007,6 +1969,17 @@ Error do_command_or_setting(std::string_view key, std::string_view value, Authen
                 Configuration::AfterParse afterParseHandler;
                 config->afterParse();
                 config->group(afterParseHandler);
+
+                // Rederive the state of the changed subtree, innermost section first,
+                // so that the change takes effect without a restart
+                if (state_is(State::Idle) || state_is(State::Alarm)) {
+                    for (auto section : rts.changed_) {
+                        section->reload();
+                    }
+                } else if (!rts.changed_.empty()) {
+                    log_warn_to(out, "Machine is busy; the change takes effect after a restart");
+                }
+                invalidate_mpos_cache();  // steps_per_mm or the kinematics may have changed
             }
             return Error::Ok;
         }
@@ -1020,36 +1993,32 @@ Error do_command_or_setting(std::string_view key, std::string_view value, Authen
 
     // Next search the settings list by text name. If found, set a new
     // value if one is given, otherwise display the current value
-    for (Setting* s : Setting::List) {
-        if (string_util::equal_ignore_case(s->getName(), key)) {
+    if (Setting* s = setting_index.find(Setting::List, key)) {
 #if 0
-            if (auth_failed(s, value, auth_level)) {
-                return Error::AuthenticationFailed;
-            }
+        if (auth_failed(s, value, auth_level)) {
+            return Error::AuthenticationFailed;
+        }
 #endif
-            if (value.empty()) {
-                show_setting(s->getName(), s->getStringValue(), NULL, out);
-                return Error::Ok;
-            }
-            return s->setStringValue(uriDecode(value));
+        if (value.empty()) {
+            show_setting(s->getName(), s->getStringValue(), NULL, out);
+            return Error::Ok;
         }
+        return s->setStringValue(uriDecode(value));
     }
 
     // Then search the setting list by compatible name.  If found, set a new
     // value if one is given, otherwise display the current value in compatible mode
-    for (Setting* s : Setting::List) {
-        if (s->getGrblName() && string_util::equal_ignore_case(s->getGrblName(), key)) {
+    if (Setting* s = grbl_setting_index.find(Setting::List, key)) {
 #if 0
-            if (auth_failed(s, value, auth_level)) {
-                return Error::AuthenticationFailed;
-            }
+        if (auth_failed(s, value, auth_level)) {
+            return Error::AuthenticationFailed;
+        }
 #endif
-            if (value.empty()) {
-                show_setting(s->getGrblName(), s->getCompatibleValue(), NULL, out);
-                return Error::Ok;
-            }
-            return s->setStringValue(uriDecode(value));
+        if (value.empty()) {
+            show_setting(s->getGrblName(), s->getCompatibleValue(), NULL, out);
+            return Error::Ok;
         }
+        return s->setStringValue(uriDecode(value));
     }
 
     // If we did not find an exact match and there is no value,
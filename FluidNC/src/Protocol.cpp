@@ -16,17 +16,23 @@
 #include "Limits.h"         // limits_get_state, soft_limit
 #include "Planner.h"        // plan_get_current_block
 #include "MotionControl.h"  // PARKING_MOTION_LINE_NUMBER
+#include "Simulation.h"     // Simulation::drain
+#include "LineLatency.h"    // LineLatency::received
+#include "PlannerStats.h"   // PlannerStats::draining
+#include "JobStats.h"       // JobStats::line, poll
 
 #include "SettingsDefinitions.h"  // gcode_echo
 #include "Machine/LimitPin.h"
 #include "Job.h"
+#include "JobQueue.h"   // JobQueue::prefetch, start_next
+#include "PowerLoss.h"  // PowerLoss::job_done
 #include "Driver/restart.h"
 
 volatile ExecAlarm lastAlarm;  // The most recent alarm code
 
 volatile const char* unwind_cause = nullptr;
 
-const std::map<ExecAlarm, const char*> AlarmNames = {
+static constexpr auto alarm_names = sorted_table<ExecAlarm, const char*>({
     { ExecAlarm::None, "None" },
     { ExecAlarm::HardLimit, "Hard Limit" },
     { ExecAlarm::SoftLimit, "Soft Limit" },
@@ -45,7 +51,11 @@ const std::map<ExecAlarm, const char*> AlarmNames = {
     { ExecAlarm::Init, "Init" },
     { ExecAlarm::ExpanderReset, "Expander Reset" },
     { ExecAlarm::GCodeError, "GCode Error" },
-};
+    { ExecAlarm::MotorStall, "Motor Stall" },
+    { ExecAlarm::FollowingError, "Following Error" },
+    { ExecAlarm::SecondaryFault, "Secondary Fault" },
+});
+const FlatMap<ExecAlarm, const char*> AlarmNames(alarm_names);
 
 const char* alarmString(ExecAlarm alarmNumber) {
     auto it = AlarmNames.find(alarmNumber);
@@ -75,11 +85,16 @@ union SpindleStop {
 
 static SpindleStop spindle_stop_ovr;
 
+// Spindle override requests are coalesced and applied by protocol_ramp_spindle_override()
+static int        spindleOvrTarget = -1;  // < 0 when no change is pending
+static TickType_t spindleOvrLast   = 0;   // When the override was last applied
+
 void protocol_reset() {
     probing                = false;
     soft_limit             = false;
     rtSafetyDoor           = false;
     spindle_stop_ovr.value = 0;
+    spindleOvrTarget       = -1;
 }
 
 static int32_t idleEndTime = 0;
@@ -106,13 +121,16 @@ void output_loop(void* unused) {
         // Block until a message is received
         LogMessage message;
         if (xQueueReceive(message_queue, &message, portMAX_DELAY)) {
-            if (message.isString) {
+            if (message.record.format) {
+                print_log_record(*message.channel, message.level, message.record);
+            } else if (message.isString) {
                 std::string* s = static_cast<std::string*>(message.line);
                 message.channel->print_msg(message.level, s->c_str());
                 delete s;
             } else {
                 const char* cp = static_cast<const char*>(message.line);
                 message.channel->print_msg(message.level, cp);
+                release_log_line(cp);
             }
         }
     }
@@ -125,9 +143,45 @@ TaskHandle_t pollingTask = nullptr;
 char activeLine[Channel::maxLine];
 
 bool pollingPaused = false;
+
+// When a pass over the input sources finds nothing to do, the polling task sleeps until
+// protocol_wake_polling() is called or pollIdleTicks have passed.  Channels whose input
+// arrives by interrupt or callback wake it at once; the others, and the modules, are
+// serviced at least once per tick.
+static const TickType_t pollIdleTicks = 1;
+
+void protocol_wake_polling() {
+    if (pollingTask) {
+        xTaskNotifyGive(pollingTask);
+    }
+}
+
+void IRAM_ATTR protocol_wake_polling_from_ISR() {
+    if (pollingTask) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(pollingTask, &woken);
+        if (woken) {
+            portYIELD_FROM_ISR();
+        }
+    }
+}
+
+static void polling_wait(bool busy) {
+    if (busy) {
+        vTaskDelay(0);
+    } else {
+        ulTaskNotifyTake(pdTRUE, pollIdleTicks);
+    }
+}
+
 void polling_loop(void* unused) {
+    Channel* jobChannel = nullptr;  // Set when activeChannel is the job channel that supplied the line
+    bool     busy       = false;    // Set when the last pass found a line or job event
+
     // Poll the input sources waiting for a complete line to arrive
-    for (; true; /*feedLoopWDT(), */ vTaskDelay(0)) {
+    for (; true; /*feedLoopWDT(), */ polling_wait(busy)) {
+        busy = false;
+
         // Polling is paused when xmodem is using a channel for binary upload
         if (pollingPaused) {
             vTaskDelay(100);
@@ -139,21 +193,40 @@ void polling_loop(void* unused) {
         // returns a line-oriented command if one is ready.
         pollChannels();
         for (auto const& module : Modules()) {
+            if (module->ready()) {
+                module->poll();
+            }
+        }
+        for (auto const& module : ConfigurableModules()) {
             module->poll();
         }
+        JobStats::poll();
 
         // If activeChannel is non-null, it means that we have recieved a line
         // but the task running protocol_main_loop() has not yet picked it up.
         // activeChannel is thus a form of flow control between the protocol
         // task that processes GCode lines and other events and this task that
         // handles IO from channels.
-        if (!activeChannel) {
+        if (activeChannel) {
+            // While a job line executes, let the job read ahead.  The job stack is not
+            // consulted here because the line might be changing it; a job channel stops
+            // reading ahead by itself after a line that could do that.
+            if (activeChannel == jobChannel) {
+                jobChannel->prefetch();
+                JobQueue::prefetch();
+            }
+        } else {
+            jobChannel = nullptr;
             // Job channels have priority
             if (!Job::active()) {
                 unwind_cause = nullptr;
                 // No job channel is active, so poll all of the serial-style
                 // channels to see if one has a line ready.
                 activeChannel = pollChannels(activeLine);
+                busy          = activeChannel != nullptr;
+                if (busy) {
+                    LineLatency::received();
+                }
             } else {
                 if (state_is(State::Alarm) || state_is(State::ConfigAlarm) || state_is(State::Critical)) {
                     log_debug("Unwinding from Alarm");
@@ -170,17 +243,36 @@ void polling_loop(void* unused) {
                 // from the job channel on top of the job stack.
                 auto channel = Job::channel();
                 auto status  = channel->pollLine(activeLine);
+                busy         = status != Error::NoData;
                 switch (status) {
                     case Error::Ok:
+                        LineLatency::received();
+                        JobStats::line();
+                        jobChannel    = channel;
                         activeChannel = channel;
                         break;
                     case Error::NoData:
                         break;
-                    case Error::Eof:
-                        notifyf("Job done", "%s job sent", channel->name());
-                        log_debug(channel->name() << " job sent");
+                    case Error::Eof: {
+                        std::string name(channel->name());
+                        log_debug(name << " job sent");
                         Job::unnest();
-                        break;
+                        if (Job::active()) {
+                            notifyf("Job done", "%s job sent", name.c_str());
+                            break;
+                        }
+                        PlannerStats::Stats total, job;
+                        PlannerStats::get(total, job);
+                        notifyf("Job done",
+                                "%s job sent, planner blocked:%u starved:%u",
+                                name.c_str(),
+                                unsigned(job.blocked),
+                                unsigned(job.starved));
+                        log_info("Job planner " << PlannerStats::occupancy(job.planner_ticks));
+                        log_info("Job segments " << PlannerStats::occupancy(job.segment_ticks));
+                        PowerLoss::job_done();
+                        JobQueue::start_next();
+                    } break;
                     default:
                         if (Job::leader) {
                             log_error_to(*Job::leader,
@@ -205,23 +297,9 @@ void start_polling() {
     if (pollingTask) {
         vTaskResume(pollingTask);
     } else {
-        xTaskCreatePinnedToCore(polling_loop,      // task
-                                "poller",          // name for task
-                                8192,              // size of task stack
-                                0,                 // parameters
-                                1,                 // priority
-                                &pollingTask,      // task handle
-                                SUPPORT_TASK_CORE  // core
-        );
-        xTaskCreatePinnedToCore(output_loop,  // task
-                                "output",     // name for task
-                                16000,
-                                // 8192,              // size of task stack
-                                0,                 // parameters
-                                2,                 // priority
-                                &outputTask,       // task handle
-                                SUPPORT_TASK_CORE  // core
-        );
+        auto& tasks = Machine::Tasks::get();
+        tasks._poller.create(polling_loop, nullptr, &pollingTask);
+        tasks._output.create(output_loop, nullptr, &outputTask);
     }
 }
 
@@ -289,6 +367,7 @@ void protocol_main_loop() {
 
             Channel* out_channel = Job::leader ? Job::leader : activeChannel;
             Error    status_code = execute_line(activeLine, *out_channel, AuthenticationLevel::LEVEL_GUEST);
+            LineLatency::executed();
 
             // Tell the channel that the line has been processed.
             // If the line was aborted, the channel could be invalid
@@ -299,6 +378,7 @@ void protocol_main_loop() {
             // Tell the input polling task that the line has been processed,
             // so it can give us another one when available
             activeChannel = nullptr;
+            protocol_wake_polling();
         }
 
         // Auto-cycle start any queued moves.
@@ -349,14 +429,19 @@ void protocol_main_loop() {
 // Block until all buffered steps are executed or in a cycle state. Works with feed hold
 // during a synchronize call, if it should happen. Also, waits for clean cycle end.
 void protocol_buffer_synchronize() {
+    if (Simulation::active()) {
+        Simulation::drain();  // Simulated blocks finish instantly
+    }
+    PlannerStats::draining(true);  // The planner running empty now is not starvation
     do {
         // Restart motion if there are blocks in the planner queue
         protocol_auto_cycle_start();
         protocol_execute_realtime();  // Check and execute run-time commands
         if (sys.abort) {
-            return;  // Check for system abort
+            break;  // Check for system abort
         }
     } while (plan_get_current_block() || state_is(State::Cycle));
+    PlannerStats::draining(false);
 }
 
 // Auto-cycle start triggers when there is a motion ready to execute and if the main program is not
@@ -467,6 +552,7 @@ static void protocol_do_start() {
 
 static void protocol_do_alarm(void* alarmVoid) {
     lastAlarm = (ExecAlarm)((int)alarmVoid);
+    Stepper::freeze_trace();  // Keep the motion that led up to the alarm for $Stepper/Trace
     if (spindle->_off_on_alarm) {
         spindle->stop();
     }
@@ -479,7 +565,8 @@ static void protocol_do_alarm(void* alarmVoid) {
         report_error_message(Message::MustReboot);
         return;
     }
-    if (lastAlarm == ExecAlarm::HardLimit || lastAlarm == ExecAlarm::HardStop) {
+    if (lastAlarm == ExecAlarm::HardLimit || lastAlarm == ExecAlarm::HardStop || lastAlarm == ExecAlarm::MotorStall ||
+        lastAlarm == ExecAlarm::FollowingError) {
         protocol_disable_steppers();
         Homing::set_all_axes_unhomed();
         set_state(State::Critical);  // Set system alarm state
@@ -500,6 +587,7 @@ static void protocol_do_alarm(void* alarmVoid) {
 static void protocol_start_holding() {
     if (!(sys.suspend.bit.motionCancel || sys.suspend.bit.jogCancel)) {  // Block, if already holding.
         sys.step_control = {};
+        Stepper::rewind_for_hold();
         Stepper::update_plan_block_parameters();
         sys.step_control.executeHold = true;  // Initiate suspend state with active flag.
     }
@@ -508,6 +596,7 @@ static void protocol_start_holding() {
 static void protocol_cancel_jogging() {
     if (!(sys.suspend.bit.motionCancel || sys.suspend.bit.jogCancel)) {  // Block, if already holding.
         sys.step_control = {};
+        Stepper::rewind_for_hold();
         Stepper::update_plan_block_parameters();
         sys.step_control.executeHold = true;  // Initiate suspend state with active flag.
         sys.suspend.bit.jogCancel    = true;
@@ -813,7 +902,9 @@ void protocol_do_cycle_stop() {
         case State::Jog:
             // Motion complete. Includes CYCLE/JOG/HOMING states and jog cancel/motion cancel/soft limit events.
             // NOTE: Motion and jog cancel both immediately return to idle after the hold completes.
-            if (sys.suspend.bit.jogCancel) {  // For jog cancel, flush buffers and sync positions.
+            // For jog cancel, flush buffers and sync positions. A velocity jog moved the motors
+            // without the planner, so it needs the same.
+            if (sys.suspend.bit.jogCancel || Stepper::end_velocity_jog()) {
                 sys.step_control = {};
                 plan_reset();
                 Stepper::reset();
@@ -826,6 +917,10 @@ void protocol_do_cycle_stop() {
                 set_state(State::SafetyDoor);
             } else {
                 sys.suspend.value = 0;
+                if (Machine::MotorEncoder::correct_drift()) {
+                    plan_sync_position();
+                    gc_sync_position();
+                }
                 set_state(State::Idle);
             }
             break;
@@ -835,9 +930,73 @@ void protocol_do_cycle_stop() {
     }
 }
 
+// Feed and rapid override changes are coalesced, so that a burst of increments from a pendant
+// knob causes one replan instead of one per increment.  The replan happens once no change has
+// arrived for OverrideSettleMs, or OverrideMaxDelayMs after the first change of the burst.
+// New blocks use the new override as soon as it is set.
+const int32_t  OverrideSettleMs     = 50;
+const int32_t  OverrideMaxDelayMs   = 200;
+static int32_t overrideSettleTime   = 0;  // Zero when no replan is pending
+static int32_t overrideDeadlineTime = 0;
+
 static void update_velocities() {
     report_ovr_counter = 0;  // Set to report change immediately
-    plan_update_velocity_profile_parameters();
+    if (overrideSettleTime == 0) {
+        overrideDeadlineTime = usToEndTicks(OverrideMaxDelayMs * 1000);
+    }
+    overrideSettleTime = usToEndTicks(OverrideSettleMs * 1000);
+    if (overrideSettleTime == 0) {
+        overrideSettleTime = 1;
+    }
+}
+
+// Replans the buffered blocks for the current overrides once a burst of changes has ended.
+static void protocol_apply_overrides() {
+    if (overrideSettleTime == 0) {
+        return;
+    }
+    int32_t now = getCpuTicks();
+    if ((now - overrideSettleTime) > 0 || (now - overrideDeadlineTime) > 0) {
+        overrideSettleTime = 0;
+        plan_update_velocity_profile_parameters();
+    }
+}
+
+// Moves the spindle override toward the requested value.  The spindle sets the
+// interval between updates, so that a VFD is not sent a Modbus command for each
+// override keypress, and override_ramp_ms limits the change at each update.
+static void protocol_ramp_spindle_override() {
+    if (spindleOvrTarget < 0) {
+        return;
+    }
+    TickType_t now     = xTaskGetTickCount();
+    uint32_t   elapsed = (now - spindleOvrLast) * portTICK_PERIOD_MS;
+    if (elapsed < spindle->override_interval_ms()) {
+        return;
+    }
+
+    int percent = spindleOvrTarget;
+    if (spindle->_override_ramp_ms) {
+        int step = MAX(1, int(elapsed * 100 / spindle->_override_ramp_ms));
+        percent  = myConstrain(percent, sys.spindle_speed_ovr - step, sys.spindle_speed_ovr + step);
+    }
+    if (percent == spindleOvrTarget) {
+        spindleOvrTarget = -1;
+    }
+    spindleOvrLast = now;
+
+    if (percent != sys.spindle_speed_ovr) {
+        sys.spindle_speed_ovr               = percent;
+        sys.step_control.updateSpindleSpeed = true;
+        gc_ovr_changed();
+
+        // If spindle is on, tell it the RPM has been overridden
+        // When moving, the override is handled by the stepping code
+        if (gc_state.modal.spindle != SpindleState::Disable && !inMotionState()) {
+            spindle->setState(gc_state.modal.spindle, gc_state.spindle_speed);
+            gc_ovr_changed();
+        }
+    }
 }
 
 // This is the final phase of the shutdown activity for a reset
@@ -865,6 +1024,8 @@ void protocol_exec_rt_system() {
     }
 
     protocol_handle_events();
+    protocol_apply_overrides();
+    protocol_ramp_spindle_override();
 
     // Reload step segment buffer
     switch (sys.state) {
@@ -879,7 +1040,11 @@ void protocol_exec_rt_system() {
         case State::SafetyDoor:
         case State::Homing:
         case State::Jog:
-            Stepper::prep_buffer();
+            if (Stepper::prep_task_enabled()) {
+                Stepper::wake_prep_task();
+            } else {
+                Stepper::prep_buffer();
+            }
             break;
     }
 }
@@ -1020,6 +1185,15 @@ static void protocol_do_feed_override(void* incrementvp) {
     }
 }
 
+// Sent by a spindle that reduces the feed while its load is high
+static void protocol_do_adaptive_feed(void* percentvp) {
+    int percent = int(percentvp);
+    if (percent != sys.f_adaptive) {
+        sys.f_adaptive = percent;
+        update_velocities();
+    }
+}
+
 static void protocol_do_rapid_override(void* percentvp) {
     int percent = int(percentvp);
     if (percent != sys.r_override) {
@@ -1029,30 +1203,24 @@ static void protocol_do_rapid_override(void* percentvp) {
     }
 }
 
+// Records the requested override; protocol_ramp_spindle_override() applies it
 static void protocol_do_spindle_override(void* incrementvp) {
     int percent;
     int increment = int(incrementvp);
+    int current   = spindleOvrTarget < 0 ? sys.spindle_speed_ovr : spindleOvrTarget;
     if (increment == SpindleSpeedOverride::Default) {
         percent = SpindleSpeedOverride::Default;
     } else {
-        percent = sys.spindle_speed_ovr + increment;
+        percent = current + increment;
         if (percent > SpindleSpeedOverride::Max) {
             percent = SpindleSpeedOverride::Max;
         } else if (percent < SpindleSpeedOverride::Min) {
             percent = SpindleSpeedOverride::Min;
         }
     }
-    if (percent != sys.spindle_speed_ovr) {
-        sys.spindle_speed_ovr               = percent;
-        sys.step_control.updateSpindleSpeed = true;
-        gc_ovr_changed();
-
-        // If spindle is on, tell it the RPM has been overridden
-        // When moving, the override is handled by the stepping code
-        if (gc_state.modal.spindle != SpindleState::Disable && !inMotionState()) {
-            spindle->setState(gc_state.modal.spindle, gc_state.spindle_speed);
-            gc_ovr_changed();
-        }
+    if (percent != current) {
+        spindleOvrTarget   = percent;
+        report_ovr_counter = 0;  // Set to report change immediately
     }
 }
 
@@ -1109,6 +1277,22 @@ static void protocol_do_fault_pin(void* arg) {
     ControlPin* pin = (ControlPin*)arg;
     log_info("Stopped by " << pin->legend());
 }
+// Sent by the Trinamic load stream when a motor's stallguard value crosses the threshold
+static void protocol_do_stall(void* arg) {
+    if (inMotionState()) {
+        mc_critical(ExecAlarm::MotorStall);
+    }
+}
+// Sent by the step ISR when a motor encoder disagrees with the step count.  The position
+// is lost, so the comparison starts over from wherever the motor is now.
+static void protocol_do_following_error(void* arg) {
+    auto encoder = static_cast<Machine::MotorEncoder*>(arg);
+    if (inMotionState()) {
+        mc_critical(ExecAlarm::FollowingError);
+        log_info("Following error of " << encoder->error_mm() << "mm on " << Axes::axisName(encoder->axis()) << (encoder->motor() ? "2" : ""));
+    }
+    Machine::MotorEncoder::resync(encoder->axis());
+}
 void protocol_do_rt_reset() {
     if (state_is(State::Homing)) {
         Machine::Homing::fail(ExecAlarm::HomingFailReset);
@@ -1128,30 +1312,41 @@ void protocol_do_rt_reset() {
     protocol_send_event(&restartEvent);
 }
 
-void protocol_do_pin_active(void* vpEventPin) {
-    auto eventPin = static_cast<EventPin*>(vpEventPin);
-    if (eventPin) {  // Safety check; null eventPin should not happen
-        eventPin->trigger(true);
+// Pin events come from any InputPin registered with registerEvent(), not only EventPins
+void protocol_do_pin_active(void* vpInputPin) {
+    auto inputPin = static_cast<InputPin*>(vpInputPin);
+    if (inputPin) {  // Safety check; null inputPin should not happen
+        inputPin->trigger(true);
     }
 }
-void protocol_do_pin_inactive(void* vpEventPin) {
-    auto eventPin = static_cast<EventPin*>(vpEventPin);
-    if (eventPin) {  // Safety check; null eventPin should not happen
-        eventPin->trigger(false);
+void protocol_do_pin_inactive(void* vpInputPin) {
+    auto inputPin = static_cast<InputPin*>(vpInputPin);
+    if (inputPin) {  // Safety check; null inputPin should not happen
+        inputPin->trigger(false);
     }
 }
 
-const ArgEvent feedOverrideEvent { protocol_do_feed_override };
-const ArgEvent rapidOverrideEvent { protocol_do_rapid_override };
-const ArgEvent spindleOverrideEvent { protocol_do_spindle_override };
+// A burst of override keys from a pendant takes one slot: increments add up and run once, and
+// a reset to the default discards the increments before it
+const ArgEvent feedOverrideEvent { protocol_do_feed_override, Event::Queue::Increment, FeedOverride::Default };
+const ArgEvent rapidOverrideEvent { protocol_do_rapid_override, Event::Queue::Latest };
+const ArgEvent adaptiveFeedEvent { protocol_do_adaptive_feed, Event::Queue::Latest };
+const ArgEvent spindleOverrideEvent { protocol_do_spindle_override, Event::Queue::Increment, SpindleSpeedOverride::Default };
 const ArgEvent accessoryOverrideEvent { protocol_do_accessory_override };
-const ArgEvent limitEvent { protocol_do_limit };
-const ArgEvent faultPinEvent { protocol_do_fault_pin };
+
+// Events that stop the machine go ahead of the others.  Feed hold does not, so that it is
+// never handled before a cycle start that was sent first.
+const ArgEvent limitEvent { protocol_do_limit, Event::Queue::Urgent };
+const ArgEvent faultPinEvent { protocol_do_fault_pin, Event::Queue::Urgent };
+const ArgEvent stallEvent { protocol_do_stall, Event::Queue::Urgent };
+const ArgEvent followingErrorEvent { protocol_do_following_error, Event::Queue::Urgent };
 const ArgEvent reportStatusEvent { (void (*)(void*))report_realtime_status };
 const ArgEvent pinActiveEvent { protocol_do_pin_active };
 const ArgEvent pinInactiveEvent { protocol_do_pin_inactive };
+static const ArgEvent urgentPinActiveEvent { protocol_do_pin_active, Event::Queue::Urgent };
+static const ArgEvent urgentPinInactiveEvent { protocol_do_pin_inactive, Event::Queue::Urgent };
 
-const NoArgEvent safetyDoorEvent { request_safety_door };
+const NoArgEvent safetyDoorEvent { request_safety_door, Event::Queue::Urgent };
 const NoArgEvent feedHoldEvent { protocol_do_feedhold };
 const NoArgEvent cycleStartEvent { protocol_do_cycle_start };
 const NoArgEvent cycleStopEvent { protocol_do_cycle_stop };
@@ -1164,32 +1359,207 @@ const NoArgEvent fullResetEvent { restart };
 const NoArgEvent runStartupLinesEvent { protocol_run_startup_lines };
 const NoArgEvent homingButtonEvent { protocol_do_start_homing };
 
-const NoArgEvent rtResetEvent { protocol_do_rt_reset };
+const NoArgEvent rtResetEvent { protocol_do_rt_reset, Event::Queue::Urgent };
 
 // The problem is that report_realtime_status needs a channel argument
 // Event statusReportEvent { protocol_do_status_report(XXX) };
-const ArgEvent alarmEvent { (void (*)(void*))protocol_do_alarm };
+const ArgEvent alarmEvent { (void (*)(void*))protocol_do_alarm, Event::Queue::Urgent };
+
+xQueueHandle        event_queue;
+static xQueueHandle urgent_queue;
+
+static volatile EventQueueStats event_queue_stats  = { 0, 0, 0 };
+static uint32_t                 reported_overflows = 0;
+
+// Event::_merged bits; the rest is the arg or the sum, signed
+static const uint32_t MergedWaiting = 1u << 31;  // A send is in the queue
+static const uint32_t MergedReset   = 1u << 30;  // Event::_reset was sent
+static const uint32_t MergedValue   = MergedReset - 1;
 
-xQueueHandle event_queue;
+static int32_t handling_ticks = 0;  // Send time of the event being handled
+
+static TaskHandle_t volatile event_waiter = nullptr;  // The task in protocol_wait_for_event()
 
 void protocol_init() {
-    event_queue   = xQueueCreate(10, sizeof(EventItem));
+    event_queue   = xQueueCreate(EVENT_QUEUE_SIZE, sizeof(EventItem));
+    urgent_queue  = xQueueCreate(EVENT_URGENT_QUEUE_SIZE, sizeof(EventItem));
     message_queue = xQueueCreate(10, sizeof(LogMessage));
 }
 
+static inline void IRAM_ATTR note_event_queue_depth(UBaseType_t waiting) {
+    if (waiting > event_queue_stats.peak) {
+        event_queue_stats.peak = waiting;
+    }
+}
+
+static inline bool IRAM_ATTR is_merged(const Event* evt) {
+    return evt->_queue == Event::Queue::Latest || evt->_queue == Event::Queue::Increment;
+}
+
+static inline int32_t IRAM_ATTR merged_value(uint32_t merged) {
+    return int32_t(merged << 2) >> 2;
+}
+
+// Merges a send of a Latest or Increment event into the waiting one.  Returns false if none
+// is waiting, in which case the send must be queued.
+static bool IRAM_ATTR merge_event(const Event* evt, void* arg) {
+    if (!is_merged(evt)) {
+        return false;
+    }
+    int32_t  value  = int32_t(reinterpret_cast<intptr_t>(arg));
+    uint32_t merged = evt->_merged.load();
+    uint32_t next;
+    do {
+        uint32_t reset = merged & MergedReset;
+        int32_t  sum   = value;
+        if (evt->_queue == Event::Queue::Increment) {
+            if (value == evt->_reset) {
+                reset = MergedReset;
+                sum   = 0;
+            } else {
+                sum += merged_value(merged);
+            }
+        }
+        next = MergedWaiting | reset | (uint32_t(sum) & MergedValue);
+    } while (!evt->_merged.compare_exchange_weak(merged, next));
+    if (merged & MergedWaiting) {
+        ++event_queue_stats.merged;
+        return true;
+    }
+    return false;
+}
+
+// A merged event whose send was lost must not wait for it
+static void IRAM_ATTR lost_event(const Event* evt) {
+    ++event_queue_stats.overflows;
+    if (is_merged(evt)) {
+        evt->_merged.store(0);
+    }
+}
+
 void IRAM_ATTR protocol_send_event_from_ISR(const Event* evt, void* arg) {
-    EventItem item { evt, arg };
-    xQueueSendFromISR(event_queue, &item, NULL);
+    if (merge_event(evt, arg)) {
+        return;
+    }
+    EventItem    item { evt, arg, getCpuTicks(), nullptr };
+    xQueueHandle queue = evt->_queue == Event::Queue::Urgent ? urgent_queue : event_queue;
+    if (xQueueSendFromISR(queue, &item, NULL) != pdTRUE) {
+        lost_event(evt);
+        return;
+    }
+    note_event_queue_depth(uxQueueMessagesWaitingFromISR(queue));
+    if (event_waiter) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(event_waiter, &woken);
+        if (woken) {
+            portYIELD_FROM_ISR();
+        }
+    }
+}
+// Both changes of a pin go to the same queue, so they stay in order
+static inline const Event* IRAM_ATTR pin_event(InputPin* pin, bool active) {
+    if (pin->urgent()) {
+        return active ? &urgentPinActiveEvent : &urgentPinInactiveEvent;
+    }
+    return active ? &pinActiveEvent : &pinInactiveEvent;
+}
+void IRAM_ATTR protocol_send_pin_event_from_ISR(InputPin* pin, bool active) {
+    protocol_send_event_from_ISR(pin_event(pin, active), pin);
+}
+static void send_event_item(const EventItem& item) {
+    if (merge_event(item.event, item.arg)) {
+        return;
+    }
+    xQueueHandle queue = item.event->_queue == Event::Queue::Urgent ? urgent_queue : event_queue;
+    if (xQueueSend(queue, &item, 0) != pdTRUE) {
+        lost_event(item.event);
+        return;
+    }
+    note_event_queue_depth(uxQueueMessagesWaiting(queue));
+    if (event_waiter) {
+        xTaskNotifyGive(event_waiter);
+    }
 }
 void protocol_send_event(const Event* evt, void* arg) {
-    EventItem item { evt, arg };
-    xQueueSend(event_queue, &item, 0);
+    send_event_item({ evt, arg, getCpuTicks(), nullptr });
+}
+void protocol_send_pin_event(InputPin* pin, bool active) {
+    protocol_send_event(pin_event(pin, active), pin);
 }
+void protocol_forward_event(const Event* evt, void* arg, EventLatency* latency) {
+    send_event_item({ evt, arg, handling_ticks, latency });
+}
+static void run_event(const EventItem& item) {
+    if (item.latency) {
+        item.latency->record(getCpuTicks() - item.ticks);
+    }
+    handling_ticks = item.ticks;
+    auto evt       = item.event;
+    if (!is_merged(evt)) {
+        evt->run(item.arg);
+        return;
+    }
+    // Sends after this are queued anew
+    uint32_t merged = evt->_merged.exchange(0);
+    void*    value  = reinterpret_cast<void*>(intptr_t(merged_value(merged)));
+    if (evt->_queue == Event::Queue::Latest) {
+        evt->run(value);
+        return;
+    }
+    if (merged & MergedReset) {
+        evt->run(reinterpret_cast<void*>(intptr_t(evt->_reset)));
+    }
+    if (value) {
+        evt->run(value);
+    }
+}
+
+// A send after event_waiter is set either finds it or queues before the check, and a
+// notification left over from an earlier wait only makes this one return early
+void protocol_wait_for_event(TickType_t ticks) {
+    event_waiter = xTaskGetCurrentTaskHandle();
+    if (!uxQueueMessagesWaiting(urgent_queue) && !uxQueueMessagesWaiting(event_queue)) {
+        ulTaskNotifyTake(pdTRUE, ticks);
+    }
+    event_waiter = nullptr;
+}
+
+// The urgent queue is checked before each normal event
 void protocol_handle_events() {
     EventItem item;
-    while (xQueueReceive(event_queue, &item, 0)) {
-        item.event->run(item.arg);
+    while (xQueueReceive(urgent_queue, &item, 0) || xQueueReceive(event_queue, &item, 0)) {
+        run_event(item);
+    }
+    uint32_t overflows = event_queue_stats.overflows;
+    if (overflows != reported_overflows) {
+        log_warn("Event queue full, " << overflows - reported_overflows << " events lost");
+        reported_overflows = overflows;
+    }
+}
+
+void protocol_get_event_queue_stats(EventQueueStats& stats) {
+    stats.peak      = event_queue_stats.peak;
+    stats.overflows = event_queue_stats.overflows;
+    stats.merged    = event_queue_stats.merged;
+}
+void protocol_reset_event_queue_stats() {
+    event_queue_stats.peak      = 0;
+    event_queue_stats.overflows = 0;
+    event_queue_stats.merged    = 0;
+    reported_overflows          = 0;
+}
+
+void EventLatency::record(uint32_t ticks) {
+    if (ticks > max_ticks) {
+        max_ticks = ticks;
+    }
+    uint32_t us  = ticks / ticks_per_us;
+    int      bin = 0;
+    while (bin < n_bins - 1 && us >= (uint32_t(bin0_max) << bin)) {
+        ++bin;
     }
+    ++histogram[bin];
+    ++count;
 }
 void send_alarm(ExecAlarm alarm) {
     protocol_send_event(&alarmEvent, (void*)alarm);
@@ -70,12 +70,15 @@ enum class ExecAlarm : uint8_t {
     Init                  = 15,
     ExpanderReset         = 16,
     GCodeError            = 17,
+    MotorStall            = 18,
+    FollowingError        = 19,
+    SecondaryFault        = 20,
 };
 
 extern volatile ExecAlarm lastAlarm;
 
-#include <map>
-extern const std::map<ExecAlarm, const char*> AlarmNames;
+#include "FlatMap.h"
+extern const FlatMap<ExecAlarm, const char*> AlarmNames;
 
 const char* alarmString(ExecAlarm alarmNumber);
 
@@ -88,10 +91,13 @@ enum AccessoryOverride {
 
 extern const ArgEvent feedOverrideEvent;
 extern const ArgEvent rapidOverrideEvent;
+extern const ArgEvent adaptiveFeedEvent;
 extern const ArgEvent spindleOverrideEvent;
 extern const ArgEvent accessoryOverrideEvent;
 extern const ArgEvent limitEvent;
 extern const ArgEvent faultPinEvent;
+extern const ArgEvent stallEvent;
+extern const ArgEvent followingErrorEvent;
 extern const ArgEvent pinActiveEvent;
 extern const ArgEvent pinInactiveEvent;
 
@@ -119,14 +125,39 @@ extern xQueueHandle event_queue;
 
 extern bool pollingPaused;
 
+// Wakes the input polling task, which sleeps while no input arrives
+void protocol_wake_polling();
+void protocol_wake_polling_from_ISR();
+
 struct EventItem {
-    const Event* event;
-    void*        arg;
+    const Event*  event;
+    void*         arg;
+    int32_t       ticks;    // CPU cycle counter when the event was sent
+    EventLatency* latency;  // Receives the time from ticks to the run of the event, if not null
 };
 
+// Queues an event for protocol_handle_events(), as its Event::Queue says
 void protocol_send_event(const Event*, void* arg = 0);
 void protocol_handle_events();
 
+// Sleeps until an event is queued or ticks pass, for a single task that waits on something
+// that events change, such as M66 on a pin.  The caller handles the events.
+void protocol_wait_for_event(TickType_t ticks);
+
+// Sends an event with the send time of the event that is being handled, so latency
+// covers the whole path from the first send.  EventPin uses it to measure the time
+// from a pin change to the action on it.
+void protocol_forward_event(const Event* evt, void* arg, EventLatency* latency);
+
+// Event queue statistics, reported by $Events/Stats
+struct EventQueueStats {
+    uint32_t peak;       // Most events waiting at once
+    uint32_t overflows;  // Events lost to a full queue
+    uint32_t merged;     // Sends merged into a waiting one, see Event::Queue
+};
+void protocol_get_event_queue_stats(EventQueueStats& stats);
+void protocol_reset_event_queue_stats();
+
 void send_alarm(ExecAlarm alarm);
 void send_alarm_from_ISR(ExecAlarm alarm);
 
@@ -136,6 +167,13 @@ inline void protocol_send_event(const Event* evt, int arg) {
 
 void protocol_send_event_from_ISR(const Event* evt, void* arg = 0);
 
+// Sends pinActiveEvent or pinInactiveEvent for a change of an input pin.  The changes of
+// pins whose action is urgent, such as limits and the fault pin, go to the urgent queue,
+// so a burst of normal events cannot keep them waiting.
+class InputPin;
+void protocol_send_pin_event(InputPin* pin, bool active);
+void protocol_send_pin_event_from_ISR(InputPin* pin, bool active);
+
 void drain_messages();
 
 extern uint32_t heapLowWater;
@@ -0,0 +1,27 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Raster.h"
+
+namespace Raster {
+    uint8_t*          buffer = nullptr;
+    volatile uint32_t head   = 0;
+    volatile uint32_t tail   = 0;
+
+    void reset() {
+        head = 0;
+        tail = 0;
+    }
+
+    void append(const uint8_t* pixels, size_t count) {
+        if (!buffer) {
+            // Allocated by the first scanline, so that machines without a laser do not pay for it
+            buffer = new uint8_t[BUFFER_SIZE];
+        }
+        uint32_t position = head;
+        for (size_t i = 0; i < count; i++) {
+            buffer[(position + i) & (BUFFER_SIZE - 1)] = pixels[i];
+        }
+        head = position + count;
+    }
+}
@@ -0,0 +1,35 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include <esp_attr.h>  // IRAM_ATTR
+#include <cstddef>
+#include <cstdint>
+
+// Grayscale scanlines for raster engraving.  $Laser/Raster queues pixels, and the next
+// linear feed motion takes all of the pixels queued since the previous one as its
+// scanline.  The stepper ISR spreads the pixels evenly along the block and scales the
+// laser power of the block by each pixel in turn, 0 for off and 255 for full power.
+//
+// The pixels wait in a ring addressed by positions that only increase.  A planner
+// block records the position and the length of its scanline, and the stepper ISR
+// releases the space of the scanlines before the block it is executing.
+namespace Raster {
+    const uint32_t BUFFER_SIZE = 8192;  // Power of two
+
+    extern uint8_t*          buffer;
+    extern volatile uint32_t head;  // Position after the last queued pixel
+    extern volatile uint32_t tail;  // Position of the first pixel that might still be executed
+
+    void reset();
+
+    // Free space in the ring
+    inline size_t space() { return BUFFER_SIZE - (head - tail); }
+
+    // Queues pixels, which must fit in space()
+    void append(const uint8_t* pixels, size_t count);
+
+    inline uint8_t IRAM_ATTR pixel(uint32_t position) { return buffer[position & (BUFFER_SIZE - 1)]; }
+    inline void IRAM_ATTR    release(uint32_t position) { tail = position; }
+}
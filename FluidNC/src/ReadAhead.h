@@ -0,0 +1,216 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  ReadAhead.h - double buffer that is refilled ahead of a reader
+
+  A file that is read a line at a time is read through two large blocks.  While the
+  reader consumes one block, a background task fills the other with the data that
+  follows it, so a slow SD or flash access delays the background task instead of the
+  G-code parser.  Blocks are always filled in file order: _next_fill names the block
+  that receives the next data, and whoever claims it first, the background task or
+  a reader that has caught up with it, fills it.  It is header-only so that it can be
+  tested on the host.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+class ReadAhead {
+public:
+    // Reads up to length bytes of the file into buffer, returning fewer at the end of the file
+    using Source = size_t (*)(void* arg, char* buffer, size_t length);
+
+    // Called while waiting for the background task to finish a block
+    using Wait = void (*)();
+
+    struct Stats {
+        uint32_t fills        = 0;  // Blocks read from the file
+        uint32_t ahead        = 0;  // Blocks that the background task filled before they were needed
+        uint32_t stalls       = 0;  // Times the reader had to wait for a block
+        uint32_t max_fill_us  = 0;
+        uint64_t sum_fill_us  = 0;
+        uint32_t timed_fills  = 0;
+        uint32_t mean_fill_us() const { return timed_fills ? uint32_t(sum_fill_us / timed_fills) : 0; }
+    };
+
+private:
+    enum : uint8_t { Empty, Filling, Full };
+
+    struct Block {
+        char*                data;
+        size_t               length = 0;
+        std::atomic<uint8_t> state { Empty };
+    };
+
+    Block  _blocks[2];
+    size_t _block_size;
+    Source _source;
+    void*  _arg;
+    Wait   _wait;
+
+    std::atomic<uint8_t> _next_fill { 0 };
+    std::atomic<bool>    _enabled { true };
+    std::atomic<bool>    _eof { false };  // A short block has been read, so there is nothing more to fill
+
+    // Used only by the reader
+    uint8_t _current  = 0;
+    size_t  _pos      = 0;  // In the current block
+    size_t  _position = 0;  // In the file
+
+    Stats _stats;
+
+    bool claim(uint8_t i) {
+        uint8_t expected = Empty;
+        return _blocks[i].state.compare_exchange_strong(expected, Filling);
+    }
+
+    void fill(uint8_t i) {
+        Block& block = _blocks[i];
+        block.length = _source(_arg, block.data, _block_size);
+        if (block.length < _block_size) {
+            _eof = true;
+        }
+        ++_stats.fills;
+        _next_fill = i ^ 1;
+        block.state.store(Full, std::memory_order_release);
+    }
+
+    // The block that holds the next byte, or nullptr if there is none
+    Block* current() {
+        Block&  block = _blocks[_current];
+        uint8_t state = block.state.load(std::memory_order_acquire);
+        if (state == Full) {
+            return &block;
+        }
+        if (!_enabled) {
+            return nullptr;
+        }
+        if (state == Empty) {
+            if (_eof || _next_fill != _current) {
+                return nullptr;
+            }
+            if (claim(_current)) {
+                ++_stats.stalls;
+                fill(_current);
+                return &block;
+            }
+        }
+        ++_stats.stalls;
+        while (block.state.load(std::memory_order_acquire) != Full) {
+            _wait();
+        }
+        return &block;
+    }
+
+public:
+    // storage must hold 2 * block_size bytes
+    ReadAhead(char* storage, size_t block_size, Source source, void* arg, Wait wait) :
+        _block_size(block_size), _source(source), _arg(arg), _wait(wait) {
+        _blocks[0].data = storage;
+        _blocks[1].data = storage + block_size;
+    }
+
+    ReadAhead(const ReadAhead&)            = delete;
+    ReadAhead& operator=(const ReadAhead&) = delete;
+
+    // Reader side
+
+    size_t read(char* buffer, size_t length) {
+        size_t count = 0;
+        while (count < length) {
+            Block* block = current();
+            if (!block) {
+                break;
+            }
+            if (_pos == block->length) {
+                if (block->length < _block_size) {
+                    break;  // End of file
+                }
+                // Hand the block back to be refilled and move on to the other one
+                block->state.store(Empty, std::memory_order_release);
+                _current ^= 1;
+                _pos = 0;
+                continue;
+            }
+            size_t n = std::min(length - count, block->length - _pos);
+            memcpy(buffer + count, block->data + _pos, n);
+            _pos += n;
+            _position += n;
+            count += n;
+        }
+        return count;
+    }
+
+    int read() {
+        char c;
+        return read(&c, 1) == 1 ? uint8_t(c) : -1;
+    }
+
+    size_t position() const { return _position; }
+
+    // True if a block is waiting for the background task
+    bool wants_fill() const { return _enabled && !_eof && _blocks[_next_fill].state.load(std::memory_order_acquire) == Empty; }
+
+    // Stops background fills and waits for one in progress, so that the file can be
+    // moved or closed.  Reads return nothing more until reset().
+    void suspend() {
+        _enabled = false;
+        for (auto& block : _blocks) {
+            while (block.state.load(std::memory_order_acquire) == Filling) {
+                _wait();
+            }
+        }
+    }
+
+    // Discards the buffered data after the file has been moved to position
+    void reset(size_t position) {
+        suspend();
+        for (auto& block : _blocks) {
+            block.state.store(Empty, std::memory_order_release);
+        }
+        _next_fill = 0;
+        _eof       = false;
+        _current   = 0;
+        _pos       = 0;
+        _position  = position;
+        _enabled   = true;
+    }
+
+    // Background side
+
+    // Fills the next block if it is empty, returning true if it did
+    bool fill_ahead() {
+        if (_eof) {
+            return false;
+        }
+        uint8_t i = _next_fill;
+        if (!claim(i)) {
+            return false;
+        }
+        if (!_enabled) {
+            // suspend() started after the claim
+            _blocks[i].state.store(Empty, std::memory_order_release);
+            return false;
+        }
+        ++_stats.ahead;
+        fill(i);
+        return true;
+    }
+
+    // Statistics
+
+    // Called by the source with the time that a fill took
+    void record_fill_time(uint32_t us) {
+        _stats.max_fill_us = std::max(_stats.max_fill_us, us);
+        _stats.sum_fill_us += us;
+        ++_stats.timed_fills;
+    }
+
+    const Stats& stats() const { return _stats; }
+};
@@ -30,10 +30,14 @@
 #include "WebUI/NotificationsService.h"  // WebUI::notificationsService
 #include "InputFile.h"
 #include "Job.h"
+#include "LineBuilder.h"
+#include "StatusFrame.h"
+#include "FlatMap.h"
 
-#include <map>
+#include <algorithm>
 #include <freertos/task.h>
 #include <cstring>
+#include <mutex>
 #include <cstdio>
 #include <cstdarg>
 #include <sstream>
@@ -45,7 +49,8 @@ EspClass esp;
 
 volatile bool protocol_pin_changed = false;
 
-std::string report_pin_string;
+uint32_t report_pin_mask                                     = 0;
+char     report_pin_string[sizeof(StatusFrame::pin_letters)] = "";
 
 portMUX_TYPE mmux = portMUX_INITIALIZER_UNLOCKED;
 
@@ -56,7 +61,7 @@ void notifyf(const char* title, const char* format, ...) {
     va_list copy;
     va_start(arg, format);
     va_copy(copy, arg);
-    size_t len = vsnprintf(NULL, 0, format, arg);
+    size_t len = vsnprintf(NULL, 0, format, copy);
     va_end(copy);
     if (len >= sizeof(loc_buf)) {
         temp = new char[len + 1];
@@ -79,10 +84,9 @@ Counter report_wco_counter = 0;
 static const int coordStringLen = 20;
 static const int axesStringLen  = coordStringLen * MAX_N_AXIS;
 
-// Sends the axis values to the output channel
-static std::string report_util_axis_values(const float* axis_value) {
-    std::ostringstream msg;
-    auto               n_axis = Axes::_numberAxis;
+// Formats the axis values into line
+static void report_util_axis_values(LineBuilder& line, const float* axis_value) {
+    auto n_axis = Axes::_numberAxis;
     for (size_t idx = 0; idx < n_axis; idx++) {
         int   decimals;
         float value = axis_value[idx];
@@ -100,15 +104,21 @@ static std::string report_util_axis_values(const float* axis_value) {
                 decimals = 3;  // Report mm to 3 decimal places
             }
         }
-        msg << std::fixed << std::setprecision(decimals) << value;
+        line.fixed(value, decimals);
         if (idx < (n_axis - 1)) {
-            msg << ",";
+            line << ',';
         }
     }
-    return msg.str();
 }
 
-std::map<Message, const char*> MessageText = {
+static std::string report_util_axis_values(const float* axis_value) {
+    char        buffer[axesStringLen];
+    LineBuilder line(buffer, sizeof(buffer));
+    report_util_axis_values(line, axis_value);
+    return std::string(line.view());
+}
+
+static constexpr auto message_texts = sorted_table<Message, const char*>({
     { Message::CriticalEvent, "Reset to continue" },
     { Message::AlarmLock, "'$H'|'$X' to unlock" },
     { Message::AlarmUnlock, "Caution: Unlocked" },
@@ -125,7 +135,8 @@ std::map<Message, const char*> MessageText = {
     // Handled separately due to numeric argument
     // { Message::FileQuit, "Reset during file job at line: %d" },
     { Message::MustReboot, "Reboot FluidNC" },
-};
+});
+static const FlatMap<Message, const char*> MessageText(message_texts);
 
 // Prints feedback messages. This serves as a centralized method to provide additional
 // user feedback for things that are not of the status/alarm message protocol. These are
@@ -199,7 +210,7 @@ void report_probe_parameters(Channel& channel) {
     // Report in terms of machine position.
     // get the machine position and put them into a string and append to the probe report
     float print_position[MAX_N_AXIS];
-    motor_steps_to_mpos(print_position, probe_steps);
+    probe_steps_to_mpos(print_position);
 
     log_stream(channel, "[PRB:" << report_util_axis_values(print_position) << ":" << probe_succeeded);
 }
@@ -255,6 +266,15 @@ void report_gcode_modes(Channel& channel) {
         case Motion::CcwArc:
             msg << "G3";
             break;
+        case Motion::CubicSpline:
+            msg << "G5";
+            break;
+        case Motion::QuadraticSpline:
+            msg << "G5.1";
+            break;
+        case Motion::SpindleSync:
+            msg << "G33";
+            break;
         case Motion::ProbeToward:
             msg << "G38.2";
             break;
@@ -317,6 +337,15 @@ void report_gcode_modes(Channel& channel) {
             break;
     }
 
+    switch (gc_state.modal.control) {
+        case ControlMode::ExactPath:
+            msg << " G61";
+            break;
+        case ControlMode::Continuous:
+            msg << " G64";
+            break;
+    }
+
     // Coordinate rotation state (G68/G69)
     switch (gc_state.modal.coord_rotation) {
         case CoordinateRotation::Enabled:
@@ -422,7 +451,9 @@ void report_build_info(const char* line, Channel& channel) {
     log_msg_to(channel, "Machine: " << config->_name);
 
     for (auto const& module : Modules()) {
-        module->build_info(channel);
+        if (module->ready()) {
+            module->build_info(channel);
+        }
     }
 }
 
@@ -480,13 +511,15 @@ const char* state_name() {
     return "";
 }
 
+// Pin events update the mask, which the reports compare, and the text
+// is rebuilt only on the events that change it
 void report_recompute_pin_string() {
-    report_pin_string.clear();
+    uint32_t mask = 0;
     if (config->_probe->probePin().get()) {
-        report_pin_string += 'P';
+        mask |= StatusFrame::pin_bit('P');
     }
     if (config->_probe->toolsetterPin().get()) {
-        report_pin_string += 'T';
+        mask |= StatusFrame::pin_bit('T');
     }
 
     MotorMask lim_pin_state = limits_get_state();
@@ -495,14 +528,16 @@ void report_recompute_pin_string() {
         for (size_t axis = 0; axis < n_axis; axis++) {
             if (bitnum_is_true(lim_pin_state, Machine::Axes::motor_bit(axis, 0)) ||
                 bitnum_is_true(lim_pin_state, Machine::Axes::motor_bit(axis, 1))) {
-                report_pin_string += Axes::axisName(axis);
+                mask |= StatusFrame::pin_bit(Axes::axisName(axis));
             }
         }
     }
 
-    std::string ctrl_pin_report = config->_control->report_status();
-    if (ctrl_pin_report.length()) {
-        report_pin_string += ctrl_pin_report;
+    mask |= config->_control->pin_mask();
+
+    if (mask != report_pin_mask) {
+        StatusFrame::pin_string(mask, report_pin_string);
+        report_pin_mask = mask;
     }
 }
 
@@ -515,44 +550,42 @@ void report_realtime_debug() {}
 // requires as it minimizes the computational overhead to keep running smoothly,
 // especially during g-code programs with fast, short line segments and high frequency reports (5-20Hz).
 void report_realtime_status(Channel& channel) {
-    LogStream msg(channel, "<");
-    msg << state_name();
+    // Built in a stack buffer because senders poll it many times a second
+    char        buffer[256];
+    LineBuilder msg(buffer, sizeof(buffer));
+    StatusSnapshot             snapshot = status_snapshot();
+    const StatusFrame::Fields& fields   = snapshot.fields;
+    msg << '<' << snapshot.state_name;
 
     // Report position
-    float* print_position = get_mpos();
-    if (bits_are_true(status_mask->get(), RtStatus::Position)) {
-        msg << "|MPos:";
-    } else {
-        msg << "|WPos:";
-        mpos_to_wpos(print_position);
-    }
-    msg << report_util_axis_values(print_position).c_str();
+    msg << ((fields.flags & StatusFrame::WorkPosition) ? "|WPos:" : "|MPos:");
+    report_util_axis_values(msg, fields.position);
 
     // Returns planner and serial read buffer states.
 
     if (bits_are_true(status_mask->get(), RtStatus::Buffer)) {
-        msg << "|Bf:" << plan_get_block_buffer_available() << "," << channel.rx_buffer_available();
+        msg << "|Bf:" << int32_t(fields.planner_free) << ',' << int32_t(channel.rx_buffer_available());
     }
 
-    if (config->_useLineNumbers) {
-        // Report current line number
-        plan_block_t* cur_block = plan_get_current_block();
-        if (cur_block != NULL) {
-            uint32_t ln = cur_block->line_number;
-            if (ln > 0) {
-                msg << "|Ln:" << ln;
-            }
-        }
+    // Report current line number
+    if (fields.line_number > 0) {
+        msg << "|Ln:" << fields.line_number;
     }
 
     // Report realtime feed speed
-    float rate = Stepper::get_realtime_rate();
+    float rate = snapshot.feed_rate;
     if (config->_reportInches) {
         rate /= MM_PER_INCH;
     }
-    msg << "|FS:" << setprecision(0) << rate << "," << sys.spindle_speed;
+    msg << "|FS:";
+    msg.fixed(rate, 0) << ',' << fields.spindle_speed;
+
+    // Spindle load and the feed percentage it allows
+    if (snapshot.spindle_load >= 0) {
+        msg << "|SL:" << snapshot.spindle_load << ',' << int32_t(snapshot.f_adaptive);
+    }
 
-    if (report_pin_string.length()) {
+    if (fields.pins) {
         msg << "|Pn:" << report_pin_string;
     }
 
@@ -573,7 +606,8 @@ void report_realtime_status(Channel& channel) {
         if (report_ovr_counter == 0) {
             report_ovr_counter = 1;  // Set override on next report.
         }
-        msg << "|WCO:" << report_util_axis_values(get_wco()).c_str();
+        msg << "|WCO:";
+        report_util_axis_values(msg, get_wco());
     }
 
     if (report_ovr_counter > 0) {
@@ -591,44 +625,186 @@ void report_realtime_status(Channel& channel) {
                 break;
         }
 
-        msg << "|Ov:" << int(sys.f_override) << "," << int(sys.r_override) << "," << int(sys.spindle_speed_ovr);
-        SpindleState sp_state      = spindle->get_state();
-        CoolantState coolant_state = config->_coolant->get_state();
-        if (sp_state != SpindleState::Disable || coolant_state.Mist || coolant_state.Flood) {
+        msg << "|Ov:" << int32_t(fields.feed_override) << ',' << int32_t(fields.rapid_override) << ','
+            << int32_t(fields.spindle_override);
+        if (fields.accessories) {
             msg << "|A:";
-            switch (sp_state) {
-                case SpindleState::Disable:
-                    break;
-                case SpindleState::Cw:
-                    msg << "S";
-                    break;
-                case SpindleState::Ccw:
-                    msg << "C";
-                    break;
-                case SpindleState::Unknown:
-                    break;
+            if (fields.accessories & StatusFrame::SpindleCw) {
+                msg << 'S';
             }
-
-            auto coolant = coolant_state;
-            if (coolant.Flood) {
-                msg << "F";
+            if (fields.accessories & StatusFrame::SpindleCcw) {
+                msg << 'C';
+            }
+            if (fields.accessories & StatusFrame::Flood) {
+                msg << 'F';
             }
-            if (coolant.Mist) {
-                msg << "M";
+            if (fields.accessories & StatusFrame::Mist) {
+                msg << 'M';
             }
         }
     }
     if (Job::active()) {
-        msg << "|" << Job::channel()->_progress;
+        msg << '|' << Job::channel()->_progress;
     }
 #ifdef DEBUG_STEPPER_ISR
-    msg << "|ISRs:" << Stepper::isr_count;
+    msg << "|ISRs:" << uint32_t(Stepper::isr_count);
 #endif
 #ifdef DEBUG_REPORT_HEAP
-    msg << "|Heap:" << xPortGetFreeHeapSize();
+    msg << "|Heap:" << uint32_t(xPortGetFreeHeapSize());
 #endif
-    msg << ">";
-    // The destructor sends the line when msg goes out of scope
+    msg << '>';
+    log_stream(channel, msg.view());
+}
+
+// The last capture of the status.  The polling task, the WebUI and the protocol task all
+// make reports, so the capture is guarded.
+static std::mutex     status_snapshot_mutex;
+static StatusSnapshot last_snapshot;
+
+static void capture_status(StatusSnapshot& snapshot) {
+    static_assert(MAX_N_AXIS <= StatusFrame::max_axes, "StatusFrame has too few axes");
+
+    StatusFrame::Fields& fields = snapshot.fields;
+    fields                      = {};
+
+    fields.state        = uint8_t(sys.state);
+    snapshot.state_name = state_name();
+    fields.n_axis       = Axes::_numberAxis;
+
+    float* position = get_mpos();
+    if (!bits_are_true(status_mask->get(), RtStatus::Position)) {
+        fields.flags |= StatusFrame::WorkPosition;
+        mpos_to_wpos(position);
+    }
+    for (size_t axis = 0; axis < fields.n_axis; axis++) {
+        fields.position[axis] = position[axis];
+    }
+
+    fields.planner_free = plan_get_block_buffer_available();
+
+    plan_block_t* cur_block = plan_get_current_block();
+    if (config->_useLineNumbers && cur_block != NULL) {
+        fields.line_number = plan_get_block_aux(cur_block)->line_number;
+    }
+
+    snapshot.feed_rate      = Stepper::get_realtime_rate();
+    fields.feed_rate        = uint32_t(snapshot.feed_rate + 0.5f);
+    fields.spindle_speed    = sys.spindle_speed;
+    fields.feed_override    = sys.f_override;
+    fields.rapid_override   = sys.r_override;
+    fields.spindle_override = sys.spindle_speed_ovr;
+    snapshot.spindle_load   = spindle->load_percent();
+    snapshot.f_adaptive     = sys.f_adaptive;
+
+    SpindleState sp_state = spindle->get_state();
+    if (sp_state == SpindleState::Cw) {
+        fields.accessories |= StatusFrame::SpindleCw;
+    } else if (sp_state == SpindleState::Ccw) {
+        fields.accessories |= StatusFrame::SpindleCcw;
+    }
+    CoolantState coolant = config->_coolant->get_state();
+    if (coolant.Flood) {
+        fields.accessories |= StatusFrame::Flood;
+    }
+    if (coolant.Mist) {
+        fields.accessories |= StatusFrame::Mist;
+    }
+
+    fields.pins = report_pin_mask;
+}
+
+// Every report in the same tick uses the same capture
+StatusSnapshot status_snapshot() {
+    std::lock_guard<std::mutex> lock(status_snapshot_mutex);
+    TickType_t                  now = xTaskGetTickCount();
+    if (!last_snapshot.sequence || last_snapshot.tick != now) {
+        capture_status(last_snapshot);
+        last_snapshot.tick = now;
+        ++last_snapshot.sequence;
+    }
+    return last_snapshot;
+}
+
+// The binary counterpart of report_realtime_status(), without the parts that are
+// only sent occasionally in the text report
+void report_status_fields(Channel& channel, StatusFrame::Fields& fields) {
+    fields         = status_snapshot().fields;
+    fields.rx_free = std::min(channel.rx_buffer_available(), 0xffff);
+}
+
+static int32_t micrometers(float mm) {
+    return int32_t(mm < 0 ? mm * 1000.0f - 0.5f : mm * 1000.0f + 0.5f);
+}
+
+// The delta form of the auto report, for clients that ask for it with $Report/Delta.
+// The state is always sent so the line is recognizable as a status report, but the
+// other fields are sent only when their values differ from the last report, and
+// nothing is sent when none of them changed.  The values are compared as numbers,
+// positions to the micrometer, before anything is formatted.
+bool report_realtime_delta(Channel& channel, const StatusFrame::Fields& now, const StatusFrame::Fields& last, bool state_changed) {
+    bool moved = now.flags != last.flags;
+    for (size_t axis = 0; axis < now.n_axis && !moved; axis++) {
+        moved = micrometers(now.position[axis]) != micrometers(last.position[axis]);
+    }
+    bool buffer      = bits_are_true(status_mask->get(), RtStatus::Buffer) &&
+                  (now.planner_free != last.planner_free || now.rx_free != last.rx_free);
+    bool line        = now.line_number != last.line_number;
+    bool speeds      = now.feed_rate != last.feed_rate || now.spindle_speed != last.spindle_speed;
+    bool pins        = now.pins != last.pins;
+    bool overrides   = now.feed_override != last.feed_override || now.rapid_override != last.rapid_override ||
+                     now.spindle_override != last.spindle_override;
+    bool accessories = now.accessories != last.accessories;
+
+    if (!(state_changed || moved || buffer || line || speeds || pins || overrides || accessories)) {
+        return false;
+    }
+
+    char        text[256];
+    LineBuilder msg(text, sizeof(text));
+    msg << '<' << state_name();
+    if (moved) {
+        msg << ((now.flags & StatusFrame::WorkPosition) ? "|WPos:" : "|MPos:");
+        report_util_axis_values(msg, now.position);
+    }
+    if (buffer) {
+        msg << "|Bf:" << int32_t(now.planner_free) << ',' << int32_t(now.rx_free);
+    }
+    if (line) {
+        msg << "|Ln:" << now.line_number;
+    }
+    if (speeds) {
+        float rate = now.feed_rate;
+        if (config->_reportInches) {
+            rate /= MM_PER_INCH;
+        }
+        msg << "|FS:";
+        msg.fixed(rate, 0) << ',' << now.spindle_speed;
+    }
+    if (pins) {
+        // An empty Pn: tells the client that the last pins were released
+        msg << "|Pn:" << report_pin_string;
+    }
+    if (overrides) {
+        msg << "|Ov:" << int32_t(now.feed_override) << ',' << int32_t(now.rapid_override) << ',' << int32_t(now.spindle_override);
+    }
+    if (accessories) {
+        msg << "|A:";
+        if (now.accessories & StatusFrame::SpindleCw) {
+            msg << 'S';
+        }
+        if (now.accessories & StatusFrame::SpindleCcw) {
+            msg << 'C';
+        }
+        if (now.accessories & StatusFrame::Flood) {
+            msg << 'F';
+        }
+        if (now.accessories & StatusFrame::Mist) {
+            msg << 'M';
+        }
+    }
+    msg << '>';
+    log_stream(channel, msg.view());
+    return true;
 }
 
 void hex_msg(uint8_t* buf, const char* prefix, int len) {
@@ -653,4 +829,62 @@ void reportTaskStackSize(UBaseType_t& saved) {
 #endif
 }
 
+void report_tasks(Channel& channel) {
+#if configUSE_TRACE_FACILITY
+    // Run times of the previous call, by task number, for the sampling window
+    static std::vector<std::pair<UBaseType_t, uint32_t>> last_runtimes;
+    static uint32_t                                      last_total = 0;
+
+    // Room for tasks that start while the states are collected
+    UBaseType_t               n_tasks = uxTaskGetNumberOfTasks() + 4;
+    std::vector<TaskStatus_t> tasks(n_tasks);
+    uint32_t                  total = 0;
+    n_tasks                         = uxTaskGetSystemState(tasks.data(), n_tasks, &total);
+    tasks.resize(n_tasks);
+    std::sort(tasks.begin(), tasks.end(), [](const TaskStatus_t& a, const TaskStatus_t& b) {
+        return a.uxCurrentPriority != b.uxCurrentPriority ? a.uxCurrentPriority > b.uxCurrentPriority : a.xTaskNumber < b.xTaskNumber;
+    });
+
+#    if configGENERATE_RUN_TIME_STATS
+    uint32_t window = total - last_total;
+#    endif
+    for (auto& task : tasks) {
+        LogStream msg(channel, "[Task ");
+        msg << task.pcTaskName;
+        BaseType_t core = xTaskGetAffinity(task.xHandle);
+        if (core == tskNO_AFFINITY) {
+            msg << " core:any";
+        } else {
+            msg << " core:" << int(core);
+        }
+        msg << " priority:" << task.uxCurrentPriority;
+        msg << " stack_free:" << task.usStackHighWaterMark;
+#    if configGENERATE_RUN_TIME_STATS
+        uint32_t last = 0;
+        for (auto& [number, runtime] : last_runtimes) {
+            if (number == task.xTaskNumber) {
+                last = runtime;
+                break;
+            }
+        }
+        if (window) {
+            msg << " cpu:" << setprecision(1) << (task.ulRunTimeCounter - last) * 100.0f / window << "%";
+        }
+#    endif
+        msg << "]";
+    }
+
+    last_runtimes.clear();
+    for (auto& task : tasks) {
+        last_runtimes.emplace_back(task.xTaskNumber, task.ulRunTimeCounter);
+    }
+    last_total = total;
+#    if !configGENERATE_RUN_TIME_STATS
+    log_info_to(channel, "CPU use needs a build with FreeRTOS run time stats");
+#    endif
+#else
+    log_error_to(channel, "Task list needs a build with the FreeRTOS trace facility");
+#endif
+}
+
 void WEAK_LINK notify(const char* title, const char* msg) {}
@@ -10,7 +10,8 @@
 
 #include "Error.h"
 #include "Config.h"
-#include "Serial.h"  // CLIENT_xxx
+#include "Serial.h"       // CLIENT_xxx
+#include "StatusFrame.h"  // StatusFrame::Fields
 
 #include <cstdint>
 #include <freertos/FreeRTOS.h>  // UBaseType_t
@@ -47,7 +48,7 @@ typedef uint8_t Counter;  // Report interval
 extern Counter report_ovr_counter;
 extern Counter report_wco_counter;
 
-//function to notify
+// Notifications are queued and sent in the background, so these return at once
 void notify(const char* title, const char* msg);
 void notifyf(const char* title, const char* format, ...);
 
@@ -64,6 +65,28 @@ void report_echo_line_received(const char* line, Channel& channel);
 // Prints realtime status report
 void report_realtime_status(Channel& channel);
 
+// The realtime status as one capture, which status_snapshot() makes at most once per tick and
+// shares among the reports of every channel, so they all show the same values and the
+// positions and rates are computed once however many clients poll
+struct StatusSnapshot {
+    uint32_t            sequence = 0;  // Counts the captures, so a consumer can tell a new one
+    TickType_t          tick     = 0;  // When it was captured
+    StatusFrame::Fields fields;        // Everything but rx_free, which depends on the channel
+
+    const char* state_name   = "";    // As in the text report, see state_name()
+    float       feed_rate    = 0;     // mm/min, before fields.feed_rate is rounded
+    int         spindle_load = -1;    // Percent, or -1 if the spindle does not report its load
+    uint8_t     f_adaptive   = 100;   // Feed percent allowed by the spindle load
+};
+
+StatusSnapshot status_snapshot();
+
+// Collects the realtime status for a binary status frame
+void report_status_fields(Channel& channel, StatusFrame::Fields& fields);
+
+// Prints a status report with only the fields that differ between now and last
+bool report_realtime_delta(Channel& channel, const StatusFrame::Fields& now, const StatusFrame::Fields& last, bool state_changed);
+
 // Prints recorded probe position
 void report_probe_parameters(Channel& channel);
 
@@ -82,6 +105,12 @@ void report_realtime_debug();
 
 void reportTaskStackSize(UBaseType_t& saved);
 
+// Lists the FreeRTOS tasks with their core, priority and stack high-water mark.
+// When the build has run time stats, it also shows the share of a core that each
+// task used since the previous call, or since boot for the first call, so two
+// calls bracket the sampling window without blocking the caller.
+void report_tasks(Channel& channel);
+
 void hex_msg(uint8_t* buf, const char* prefix, int len);
 
 #include "MyIOStream.h"
@@ -95,5 +124,6 @@ extern const char* git_url;
 
 extern bool readyNext;
 
-extern std::string report_pin_string;
-void               report_recompute_pin_string();
+extern uint32_t report_pin_mask;      // Active pins as in StatusFrame::pin_bits()
+extern char     report_pin_string[];  // The letters of report_pin_mask, for |Pn:
+void            report_recompute_pin_string();
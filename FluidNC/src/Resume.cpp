@@ -0,0 +1,207 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Resume.h"
+
+#include "Machine/MachineConfig.h"  // config, Axes
+#include "GCode.h"                  // gc_state, gc_execute_line, gc_sync_position
+#include "MotionControl.h"          // mc_linear
+#include "Protocol.h"               // protocol_buffer_synchronize
+#include "InputFile.h"
+#include "SettingsDefinitions.h"  // sd_checkpoint_lines
+#include "Logging.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace Resume {
+    // The index is "magic version state_size file_size" followed by checkpoints, binary.
+    // The parser state is stored as it is in memory, so the index is only good for the
+    // firmware that wrote it; the version and size fields detect most mismatches.
+    static const uint32_t magic   = 0x504b4346;  // "FCKP"
+    static const uint16_t version = 1;
+
+    struct Header {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t state_size;
+        uint32_t file_size;
+    };
+
+    struct Checkpoint {
+        uint32_t       line;
+        uint32_t       offset;  // File position after the line
+        parser_state_t state;
+    };
+
+    static std::string index_path(InputFile& file) {
+        return file.path() + ".ckp";
+    }
+
+    // The file whose index is being written, only compared, and the last line checkpointed
+    static const InputFile* writing      = nullptr;
+    static size_t           written_line = 0;
+
+    void line_done(InputFile& file, size_t line_number, size_t end) {
+        int interval = sd_checkpoint_lines->get();
+        if (interval == 0 || line_number % interval || state_is(State::CheckMode)) {
+            return;
+        }
+        // A new job starts a new index
+        bool start   = &file != writing || line_number <= written_line;
+        writing      = &file;
+        written_line = line_number;
+
+        Checkpoint checkpoint;
+        checkpoint.line   = line_number;
+        checkpoint.offset = end;
+        checkpoint.state  = gc_state;
+        try {
+            FileStream index(index_path(file), start ? "w" : "a", "");
+            if (start) {
+                Header header { magic, version, uint16_t(sizeof(parser_state_t)), uint32_t(file.size()) };
+                index.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+            }
+            index.write(reinterpret_cast<const uint8_t*>(&checkpoint), sizeof(checkpoint));
+        } catch (...) {
+            log_debug("Cannot write " << index_path(file));
+            writing = nullptr;
+        }
+    }
+
+    // The last checkpoint before the start, if the file has a good index
+    static bool find_checkpoint(InputFile& file, size_t start_line, size_t start_offset, Checkpoint& best) {
+        bool found = false;
+        try {
+            FileStream index(index_path(file), "r", "");
+            Header     header;
+            if (index.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header) || header.magic != magic ||
+                header.version != version || header.state_size != sizeof(parser_state_t) || header.file_size != file.size()) {
+                log_info("Ignoring stale " << index.path());
+                return false;
+            }
+            Checkpoint checkpoint;
+            while (index.read(reinterpret_cast<char*>(&checkpoint), sizeof(checkpoint)) == sizeof(checkpoint)) {
+                if (start_line ? checkpoint.line >= start_line : checkpoint.offset > start_offset) {
+                    break;
+                }
+                best  = checkpoint;
+                found = true;
+            }
+        } catch (...) {}
+        return found;
+    }
+
+    // Runs the lines before the start in check mode
+    static Error reconstruct(InputFile& file, size_t start_line, size_t start_offset, Channel& out) {
+        char  line[Channel::maxLine];
+        Error err = Error::Ok;
+        set_state(State::CheckMode);
+        while (start_line ? file.lineNumber() + 1 < start_line : file.position() < start_offset) {
+            if ((err = file.readLine(line, Channel::maxLine)) != Error::Ok) {
+                break;
+            }
+            const char* p = line;
+            while (isspace(*p)) {
+                ++p;
+            }
+            if (*p == '$') {
+                err = Error::InvalidStatement;
+            } else if ((err = gc_execute_line(line)) == Error::GcodeUnsupportedCommand) {
+                err = Error::Ok;  // As when the file runs
+            }
+            if (err != Error::Ok) {
+                log_error_to(out, "Cannot resume past line " << file.lineNumber() << ": " << line);
+                break;
+            }
+        }
+        set_state(State::Idle);
+        if (err == Error::Eof) {
+            log_error_to(out, "The start is beyond the end of " << file.path());
+        }
+        return err;
+    }
+
+    static void move(float* target, plan_line_data_t& pl_data) {
+        if (!sys.abort) {
+            mc_linear(target, &pl_data, gc_state.position);
+            copyAxes(gc_state.position, target);
+        }
+    }
+
+    // Moves the machine, which is where gc_state.position is, to program with the spindle
+    // and coolant as gc_state has them; see Resume.h.
+    static void approach(const float* program, SpindleState spindle_state, CoolantState coolant) {
+        auto  n_axis = Axes::_numberAxis;
+        float target[MAX_N_AXIS];
+
+        plan_line_data_t pl_data;
+        memset(&pl_data, 0, sizeof(pl_data));
+        pl_data.motion.rapidMotion = 1;
+
+        copyAxes(target, gc_state.position);
+        target[Z_AXIS] = std::max(target[Z_AXIS], program[Z_AXIS]);
+        move(target, pl_data);
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            if (axis != Z_AXIS) {
+                target[axis] = program[axis];
+            }
+        }
+        move(target, pl_data);
+        protocol_buffer_synchronize();
+
+        gc_state.modal.spindle = spindle_state;
+        gc_state.modal.coolant = coolant;
+        if (!spindle->isRateAdjusted()) {
+            spindle->setState(spindle_state, uint32_t(gc_state.spindle_speed));
+        }
+        config->_coolant->set_state(coolant);
+        gc_ovr_changed();
+
+        // Down at the program feed rate when it has one in mm/min
+        if (gc_state.modal.feed_rate == FeedRate::UnitsPerMin && gc_state.feed_rate > 0.0f) {
+            pl_data.motion.rapidMotion = 0;
+            pl_data.feed_rate          = gc_state.feed_rate;
+        }
+        pl_data.spindle       = spindle_state;
+        pl_data.spindle_speed = gc_state.spindle_speed;
+        pl_data.coolant       = coolant;
+        target[Z_AXIS]        = program[Z_AXIS];
+        move(target, pl_data);
+    }
+
+    Error seek(InputFile& file, size_t start_line, size_t start_offset, Channel& out) {
+        if (!state_is(State::Idle)) {
+            return Error::IdleError;
+        }
+        parser_state_t before = gc_state;
+
+        Checkpoint checkpoint;
+        if (find_checkpoint(file, start_line, start_offset, checkpoint)) {
+            file.set_position(checkpoint.offset);
+            file.setLineNumber(checkpoint.line);
+            gc_state = checkpoint.state;
+            log_info_to(out, "Resuming from the checkpoint at line " << checkpoint.line);
+        }
+        Error err = reconstruct(file, start_line, start_offset, out);
+        if (err != Error::Ok) {
+            gc_state = before;
+            gc_sync_position();
+            return err;
+        }
+
+        // Check mode leaves the spindle and coolant as they were, off
+        float program[MAX_N_AXIS];
+        copyAxes(program, gc_state.position);
+        auto spindle_state     = gc_state.modal.spindle;
+        auto coolant           = gc_state.modal.coolant;
+        gc_state.modal.spindle = SpindleState::Disable;
+        gc_state.modal.coolant = {};
+        gc_sync_position();  // The machine has not moved
+
+        log_info_to(out, "Starting " << file.path() << " at line " << file.lineNumber() + 1 << " with tool " << gc_state.current_tool);
+        approach(program, spindle_state, coolant);
+        return sys.abort ? Error::Reset : Error::Ok;
+    }
+}
@@ -0,0 +1,42 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  Resume.h - starting a file job partway through
+
+  While a file job runs, every $SD/CheckpointLines lines a checkpoint is appended to an index
+  next to the file, <file>.ckp: the line number, the file position after the line, and the
+  G-code parser state - modes, feed, spindle speed, tool, offsets and position - after it
+  executed.
+
+  $SD/Run=<path> line=<n> starts the file at line n, and offset=<n> at the first line that
+  starts at or after the byte offset n.  The file is positioned at the last checkpoint before
+  the start with set_position(), the parser state is restored from it, and the lines from there
+  to the start are run in check mode, which updates the modes without moving.  Without an index
+  they are run from the top of the file.  Flow control and $ commands cannot be run that way,
+  so a start after them is refused.
+
+  The machine then goes to where the program was: up to the higher of the current and the
+  program Z, across at that height, and down at the program feed rate once the spindle and
+  coolant are back on as the program had them.  Numbered and named parameters are not in the
+  checkpoints.
+*/
+
+#include "Error.h"
+
+#include <cstddef>
+
+class Channel;
+class InputFile;
+
+namespace Resume {
+    // Called by InputFile::ack() after a line of the file job executes; end is the file
+    // position after the line.
+    void line_done(InputFile& file, size_t line_number, size_t end);
+
+    // Positions file to start at start_line, or at start_offset if start_line is 0, and
+    // moves the machine to where the program is there.
+    Error seek(InputFile& file, size_t start_line, size_t start_offset, Channel& out);
+}
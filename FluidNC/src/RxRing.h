@@ -0,0 +1,104 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  RxRing.h - fixed-capacity receive buffer for channel input
+
+  A single-producer, single-consumer byte ring.  The producer (the code that receives
+  bytes from a connection) and the consumer (pollLine()) may run in different tasks without
+  a lock: each side writes only its own index, and the indices run freely, wrapping through
+  the power-of-two capacity.  Storage is allocated on the first push, so channels that never
+  queue input cost nothing, and is never reallocated.  The consumer can read the queued
+  bytes in place a contiguous span at a time.  It is header-only so that it can be tested
+  on the host.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+class RxRing {
+    uint8_t*            _data     = nullptr;
+    size_t              _capacity = 0;  // A power of two
+    std::atomic<size_t> _head { 0 };    // Advanced by the producer
+    std::atomic<size_t> _tail { 0 };    // Advanced by the consumer
+
+public:
+    explicit RxRing(size_t capacity) { set_capacity(capacity); }
+    RxRing(const RxRing&)            = delete;
+    RxRing& operator=(const RxRing&) = delete;
+    ~RxRing() { delete[] _data; }
+
+    // Rounds up to a power of two.  Only valid before the first push.
+    void set_capacity(size_t capacity) {
+        _capacity = 1;
+        while (_capacity < capacity) {
+            _capacity <<= 1;
+        }
+    }
+
+    size_t capacity() const { return _capacity; }
+    size_t size() const { return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire); }
+    bool   empty() const { return size() == 0; }
+
+    // Producer side.  Stores as much of data as fits and returns the number of bytes stored.
+    size_t push(const uint8_t* data, size_t length) {
+        if (!_data) {
+            _data = new uint8_t[_capacity];
+        }
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t room = _capacity - (head - _tail.load(std::memory_order_acquire));
+        if (length > room) {
+            length = room;
+        }
+        size_t offset = head & (_capacity - 1);
+        size_t first  = _capacity - offset;
+        if (first > length) {
+            first = length;
+        }
+        memcpy(_data + offset, data, first);
+        memcpy(_data, data + first, length - first);
+        _head.store(head + length, std::memory_order_release);
+        return length;
+    }
+    bool push(uint8_t c) { return push(&c, 1) == 1; }
+
+    // Consumer side.  peek() points data at the oldest queued bytes and returns how many of
+    // them are contiguous; consume() then releases the first n of them.
+    size_t peek(const uint8_t*& data) const {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        size_t used = _head.load(std::memory_order_acquire) - tail;
+        if (!used) {
+            return 0;
+        }
+        size_t offset = tail & (_capacity - 1);
+        data          = _data + offset;
+        return used < _capacity - offset ? used : _capacity - offset;
+    }
+    void consume(size_t n) { _tail.store(_tail.load(std::memory_order_relaxed) + n, std::memory_order_release); }
+
+    // Copies up to length queued bytes to buffer and returns the number copied.
+    size_t read(uint8_t* buffer, size_t length) {
+        size_t copied = 0;
+        while (copied < length) {
+            const uint8_t* data;
+            size_t         n = peek(data);
+            if (!n) {
+                break;
+            }
+            if (n > length - copied) {
+                n = length - copied;
+            }
+            memcpy(buffer + copied, data, n);
+            consume(n);
+            copied += n;
+        }
+        return copied;
+    }
+
+    // Consumer side.  Discards everything queued.
+    void clear() { _tail.store(_head.load(std::memory_order_acquire), std::memory_order_release); }
+};
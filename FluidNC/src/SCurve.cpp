@@ -256,6 +256,100 @@ SCurveProfile calculate_s_curve_fast(float distance,
                                    max_velocity, max_acceleration, max_jerk);
 }
 
+// Profile cache.  Open-addressed with a short linear probe; when every probed
+// slot is taken by another key, the home slot is overwritten.
+static const uint32_t scurve_cache_entries = 32;  // Must be a power of 2
+static const uint32_t scurve_cache_probes  = 4;
+
+struct SCurveCacheEntry {
+    int32_t       key[6];
+    bool          used;
+    SCurveProfile profile;
+};
+
+static SCurveCacheEntry scurve_cache[scurve_cache_entries];
+static uint32_t         scurve_cache_hits   = 0;
+static uint32_t         scurve_cache_misses = 0;
+
+// Quantization steps: 0.1 um distance, 0.01 mm/min speeds, 0.01 mm/s^2 acceleration, 0.1 mm/s^3 jerk
+static void scurve_cache_key(int32_t* key,
+                             bool     fast,
+                             float    distance,
+                             float    entry_speed,
+                             float    exit_speed,
+                             float    max_velocity,
+                             float    max_acceleration,
+                             float    max_jerk) {
+    key[0] = int32_t(lroundf(distance * 10000.0f)) ^ (fast ? INT32_MIN : 0);
+    key[1] = int32_t(lroundf(entry_speed * 100.0f));
+    key[2] = int32_t(lroundf(exit_speed * 100.0f));
+    key[3] = int32_t(lroundf(max_velocity * 100.0f));
+    key[4] = int32_t(lroundf(max_acceleration * 100.0f));
+    key[5] = int32_t(lroundf(max_jerk * 10.0f));
+}
+
+static uint32_t scurve_cache_hash(const int32_t* key) {
+    // FNV-1a over the quantized key words
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < 6; i++) {
+        h ^= uint32_t(key[i]);
+        h *= 16777619u;
+    }
+    return h ^ (h >> 16);
+}
+
+SCurveProfile calculate_s_curve_cached(bool  fast,
+                                       float distance,
+                                       float entry_speed,
+                                       float exit_speed,
+                                       float max_velocity,
+                                       float max_acceleration,
+                                       float max_jerk) {
+    int32_t key[6];
+    scurve_cache_key(key, fast, distance, entry_speed, exit_speed, max_velocity, max_acceleration, max_jerk);
+
+    uint32_t home = scurve_cache_hash(key) & (scurve_cache_entries - 1);
+    uint32_t slot = home;
+    for (uint32_t probe = 0; probe < scurve_cache_probes; probe++) {
+        SCurveCacheEntry& entry = scurve_cache[(home + probe) & (scurve_cache_entries - 1)];
+        if (!entry.used) {
+            slot = (home + probe) & (scurve_cache_entries - 1);
+            break;
+        }
+        if (std::equal(key, key + 6, entry.key)) {
+            ++scurve_cache_hits;
+            return entry.profile;
+        }
+    }
+
+    ++scurve_cache_misses;
+    SCurveProfile profile = fast ? calculate_s_curve_fast(distance, entry_speed, exit_speed, max_velocity, max_acceleration, max_jerk)
+                                 : calculate_s_curve_profile(distance, entry_speed, exit_speed, max_velocity, max_acceleration, max_jerk);
+
+    SCurveCacheEntry& entry = scurve_cache[slot];
+    std::copy(key, key + 6, entry.key);
+    entry.used    = true;
+    entry.profile = profile;
+    return profile;
+}
+
+SCurveCacheStats s_curve_cache_stats() {
+    SCurveCacheStats stats;
+    stats.hits     = scurve_cache_hits;
+    stats.misses   = scurve_cache_misses;
+    stats.entries  = uint32_t(std::count_if(scurve_cache, scurve_cache + scurve_cache_entries, [](const SCurveCacheEntry& e) { return e.used; }));
+    stats.capacity = scurve_cache_entries;
+    return stats;
+}
+
+void s_curve_cache_reset() {
+    for (auto& entry : scurve_cache) {
+        entry.used = false;
+    }
+    scurve_cache_hits   = 0;
+    scurve_cache_misses = 0;
+}
+
 float calculate_s_curve_junction_velocity(float distance1, float distance2,
                                          float max_acceleration,
                                          float max_jerk,
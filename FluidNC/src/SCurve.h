@@ -75,6 +75,29 @@ SCurveProfile calculate_s_curve_fast(float distance,
                                    float max_acceleration,
                                    float max_jerk);
 
+// Memoized front end for calculate_s_curve_fast() / calculate_s_curve_profile().
+// Moves are keyed on their quantized parameters, so streams of identical CAM
+// micro-segments reuse one computed profile instead of recomputing it.
+SCurveProfile calculate_s_curve_cached(bool  fast,
+                                       float distance,
+                                       float entry_speed,
+                                       float exit_speed,
+                                       float max_velocity,
+                                       float max_acceleration,
+                                       float max_jerk);
+
+struct SCurveCacheStats {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t entries;   // Slots currently holding a profile
+    uint32_t capacity;  // Total number of slots
+};
+
+SCurveCacheStats s_curve_cache_stats();
+
+// Empties the cache and zeroes the counters
+void s_curve_cache_reset();
+
 // Junction velocity calculation for S-curve planning
 float calculate_s_curve_junction_velocity(float distance1, float distance2,
                                          float max_acceleration,
@@ -42,7 +42,8 @@ private:
     Pin   _cardDetect;
     Pin   _cs;
 
-    uint32_t _frequency_hz = 8000000;  // Set to nonzero to override the default
+    uint32_t _frequency_hz     = 8000000;  // Set to nonzero to override the default
+    uint32_t _min_frequency_hz = 4000000;  // Lowest clock to fall back to after errors
 
 public:
     SDCard();
@@ -61,7 +62,8 @@ public:
     void group(Configuration::HandlerBase& handler) override {
         handler.item("cs_pin", _cs);
         handler.item("card_detect_pin", _cardDetect);
-        handler.item("frequency_hz", _frequency_hz, 400000, 20000000);
+        handler.item("frequency_hz", _frequency_hz, 400000, 40000000);
+        handler.item("min_frequency_hz", _min_frequency_hz, 400000, 40000000);
     }
 
     ~SDCard();
@@ -4,6 +4,8 @@
 #include <OLEDDisplay.h>
 #include "Machine/I2CBus.h"
 #include <algorithm>
+#include <cstring>
+#include <vector>
 
 using namespace Machine;
 
@@ -14,6 +16,9 @@ private:
     int     _frequency;
     bool    _error = false;
 
+    std::vector<uint8_t> _sent;  // The frame that the display holds
+    bool                 _sent_valid = false;
+
 public:
     SSD1306_I2C(uint8_t address, OLEDDISPLAY_GEOMETRY g, I2CBus* i2c, int frequency) :
         _address(address), _i2c(i2c), _frequency(frequency), _error(false) {
@@ -82,38 +87,72 @@ public:
             *start = save;
         }
 #else
-
-        sendCommand(COLUMNADDR);
-        sendCommand(x_offset);                        // column start address (0 = reset)
-        sendCommand(x_offset + (this->width() - 1));  // column end address (127 = reset)
-
-        sendCommand(PAGEADDR);
-        sendCommand(0x0);  // page start address (0 = reset)
-
-        if (geometry == GEOMETRY_128_64) {
-            sendCommand(0x7);
-        } else if (geometry == GEOMETRY_128_32) {
-            sendCommand(0x3);
+        // Send only the columns that changed in each page, against a copy of what the
+        // display holds, so that a status update that changes a few DRO digits costs a
+        // few dozen bytes of I2C traffic instead of the whole frame
+        const int width = this->width();
+        const int pages = this->height() / 8;
+        if (_sent.size() != displayBufferSize) {
+            _sent.assign(displayBufferSize, 0);
+            _sent_valid = false;
         }
-
-        buffer[-1] = 0x40;  // control
-        _i2c->write(_address, (char*)&buffer[-1], displayBufferSize + 1);
+        for (int page = 0; page < pages; page++) {
+            const uint8_t* row   = &buffer[page * width];
+            uint8_t*       sent  = &_sent[page * width];
+            int            first = 0;
+            int            last  = width - 1;
+            if (_sent_valid) {
+                while (first < width && row[first] == sent[first]) {
+                    ++first;
+                }
+                if (first == width) {
+                    continue;
+                }
+                while (row[last] == sent[last]) {
+                    --last;
+                }
+            }
+            int length = last - first + 1;
+
+            // The bus task sends the window and the data after this returns
+            uint8_t window[] = {
+                0x00,  // control, a command list
+                COLUMNADDR, uint8_t(x_offset + first), uint8_t(x_offset + last), PAGEADDR, uint8_t(page), uint8_t(page),
+            };
+            uint8_t data[128 + 1];
+            data[0] = 0x40;  // control
+            memcpy(&data[1], &row[first], length);
+            if (!queue(window, sizeof(window)) || !queue(data, length + 1)) {
+                _sent_valid = false;  // Send everything next time
+                return;
+            }
+            memcpy(&sent[first], &row[first], length);
+        }
+        _sent_valid = !_error;
 #endif
     }
 
 private:
     int getBufferOffset(void) { return 0; }
 
-    inline void sendCommand(uint8_t command) __attribute__((always_inline)) {
-        if (_error) {
-            return;
+    static void done(void* arg, int result) {
+        auto display = static_cast<SSD1306_I2C*>(arg);
+        if (result < 0 && !display->_error) {
+            log_error("OLED is not responding");
+            display->_error = true;
         }
+    }
+
+    // Transfers go through the bus queue, so that a display update does not hold up the
+    // caller, and in order, so that commands and data cannot overtake each other
+    bool queue(const uint8_t* data, size_t count) {
+        return !_error && _i2c->queue_write(_address, data, count, I2CBus::Priority::Display, done, this);
+    }
+
+    inline void sendCommand(uint8_t command) __attribute__((always_inline)) {
         uint8_t _data[2];
         _data[0] = 0x80;  // control
         _data[1] = command;
-        if (_i2c->write(_address, _data, sizeof(_data)) < 0) {
-            log_error("OLED is not responding");
-            _error = true;
-        }
+        queue(_data, sizeof(_data));
     }
 };
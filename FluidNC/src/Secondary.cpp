@@ -0,0 +1,125 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Secondary.h"
+
+#include "Machine/MachineConfig.h"  // config->_uarts, Axes
+#include "MotionControl.h"          // mc_critical
+#include "Protocol.h"               // protocol_send_event, ExecAlarm
+#include "Event.h"
+#include "Uart.h"
+#include "xmodem.h"               // crc16_ccitt()
+#include "Driver/fluidnc_gpio.h"  // gpio_write()
+#include "Logging.h"
+
+#include <esp_attr.h>  // IRAM_ATTR
+
+namespace {
+    const uint8_t SegmentFrame = 0xA5;
+    const uint8_t RewindFrame  = 0xA6;
+    const uint8_t ResetFrame   = 0xA7;
+}
+
+// Faults stop the machine at once, so they skip the normal events
+static ArgEvent faultEvent { Secondary::fault_event, Event::Queue::Urgent };
+
+void Secondary::init() {
+    _uart = config->_uarts[_uart_num];
+    if (!_uart) {
+        log_error("Secondary: Missing uart" << _uart_num << " section");
+        return;
+    }
+    if (!Axes::namesToMask(_axes.c_str(), axes)) {
+        axes = 0;
+        return;
+    }
+    for (size_t axis = 0; axis < Axes::_numberAxis; axis++) {
+        auto a = config->_axes->_axis[axis];
+        if (bitnum_is_true(axes, axis) && a && (a->_motors[0] || a->_motors[1])) {
+            log_warn("Secondary: axis " << Axes::axisName(axis) << " also has motors here");
+        }
+    }
+    _sync_pin.setAttr(Pin::Attr::Output);
+    _sync_gpio = _sync_pin.getNative(Pin::Capabilities::Output | Pin::Capabilities::Native);
+    gpio_write(_sync_gpio, 0);
+
+    reset();
+    Stepper::set_mirror(this);
+    log_info("Secondary uart" << _uart_num << " Sync:" << _sync_pin.name() << " Axes:" << Axes::maskToNames(axes));
+}
+
+void Secondary::send(uint8_t* frame, size_t length) {
+    uint16_t crc      = crc16_ccitt(frame, length);
+    frame[length]     = crc & 0xff;
+    frame[length + 1] = crc >> 8;
+    _uart->write(frame, length + 2);
+}
+
+void Secondary::segment(uint32_t sequence, uint32_t period, uint32_t ticks, uint8_t dir_bits, const uint16_t* steps) {
+    uint8_t frame[7 + 2 * MAX_N_AXIS + 2];
+    size_t  n = 0;
+    frame[n++] = SegmentFrame;
+    frame[n++] = uint8_t(sequence);
+    frame[n++] = ticks & 0xff;
+    frame[n++] = ticks >> 8;
+    frame[n++] = period & 0xff;
+    frame[n++] = period >> 8;
+    frame[n++] = dir_bits;
+    for (size_t axis = 0; axis < Axes::_numberAxis; axis++) {
+        if (bitnum_is_true(axes, axis)) {
+            frame[n++] = *steps & 0xff;
+            frame[n++] = *steps++ >> 8;
+        }
+    }
+    send(frame, n);
+}
+
+void Secondary::rewind(uint32_t sequence) {
+    uint8_t frame[4] = { RewindFrame, uint8_t(sequence) };
+    send(frame, 2);
+}
+
+void Secondary::reset() {
+    uint8_t frame[3] = { ResetFrame };
+    send(frame, 1);
+}
+
+// An edge of either direction starts a segment
+void IRAM_ATTR Secondary::start() {
+    _sync_high = !_sync_high;
+    gpio_write(_sync_gpio, _sync_high);
+}
+
+void Secondary::poll() {
+    if (!_uart) {
+        return;
+    }
+    // One alarm is enough, whatever else follows the first code
+    int code = _uart->read();
+    if (code >= 0) {
+        _uart->flushRx();
+        protocol_send_event(&faultEvent, code);
+    }
+}
+
+void Secondary::fault_event(void* arg) {
+    int code = int(reinterpret_cast<intptr_t>(arg));
+    log_error("Secondary fault " << code << (code == 1 ? ", bad frame" : code == 2 ? ", missing segment" : ""));
+    mc_critical(ExecAlarm::SecondaryFault);
+}
+
+void Secondary::validate() {
+    Assert(_uart_num >= 1 && _uart_num < MAX_N_UARTS, "Secondary uart_num must be 1 or 2");
+    Assert(_sync_pin.defined(), "Secondary sync_pin must be configured");
+    Assert(!_axes.empty(), "Secondary axes must be configured");
+}
+
+void Secondary::group(Configuration::HandlerBase& handler) {
+    handler.item("uart_num", _uart_num);
+    handler.item("sync_pin", _sync_pin);
+    handler.item("axes", _axes);
+}
+
+namespace {
+    ConfigurableModuleFactory::InstanceBuilder<Secondary> registration("secondary");
+}
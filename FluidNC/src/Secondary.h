@@ -0,0 +1,96 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  Secondary.h - axes stepped by a second controller in lockstep with this one
+
+  One ESP32 runs out of step outputs long before the planner runs out of axes.  With a
+  secondary: section, the axes it lists have no motors here; another controller steps them
+  from the segments of this one.  The planner and the step ISR handle them as any other axis,
+  so their motion is planned, limited and reported with the rest.
+
+  The segment data and its timing go separately:
+
+  - As the segment generator queues each segment, a frame with its step counts for the
+    listed axes goes over the UART.  The segment buffer is several segments ahead of the
+    motion, so the frames arrive well before they are needed.
+  - As the step ISR starts each segment, it toggles sync_pin.  The secondary starts its next
+    segment on each edge, so both controllers share the time base of the step timer, and the
+    crystals of the two can only drift apart within a segment.
+
+  Frames, little-endian, each ending with the CRC-16/CCITT (as XModem's) of the bytes before it:
+
+    0xA5 seq ticks:2 period:2 dir steps:2...   a segment; seq counts the segments, modulo 256
+    0xA6 seq                                   drop the queued segments from seq on
+    0xA7                                       drop all queued segments; the next seq is 0
+
+  A segment runs ticks ISR ticks of period step timer ticks, at 20 MHz, and outputs steps for
+  each listed axis, in axis order, spread over them as by the Bresenham algorithm, in the
+  directions of the bits of dir, indexed by axis.  The step counts are those that the step
+  ISR here outputs for the axes, so the positions agree exactly at the end of each segment.
+  A feed hold drops queued segments to decelerate sooner, and a reset drops all of them.  The
+  secondary needs room for the stepping/segments queued segments.  At 1000000 baud a frame
+  for three axes takes 150 us, far less than the shortest segment.
+
+  The secondary sends a byte only when something is wrong: 1 for a frame with a bad CRC or out
+  of sequence, 2 for an edge without a segment.  Either is a SecondaryFault alarm, since the
+  axes of the secondary no longer are where this controller thinks they are.
+
+  The axes cannot be the torch height controlled Z axis: the offset is stepped here only.
+
+  secondary:
+    uart_num: 2
+    sync_pin: gpio.33
+    axes: ABC
+
+  with the UART in a uart2: section.
+*/
+
+#include "Module.h"
+#include "Pin.h"
+#include "Stepper.h"  // Stepper::SegmentMirror
+
+#include <cstdint>
+#include <string>
+
+class Uart;
+
+class Secondary : public ConfigurableModule, public Stepper::SegmentMirror {
+    int         _uart_num = -1;
+    Pin         _sync_pin;
+    std::string _axes;
+
+    Uart*    _uart      = nullptr;
+    pinnum_t _sync_gpio = 0;
+    bool     _sync_high = false;
+
+    void send(uint8_t* frame, size_t length);  // Appends the CRC
+
+public:
+    Secondary(const char* name) : ConfigurableModule(name) {}
+
+    Secondary(const Secondary&)            = delete;
+    Secondary(Secondary&&)                 = delete;
+    Secondary& operator=(const Secondary&) = delete;
+    Secondary& operator=(Secondary&&)      = delete;
+
+    virtual ~Secondary() = default;
+
+    void init() override;
+    void poll() override;
+
+    // Stepper::SegmentMirror
+    void segment(uint32_t sequence, uint32_t period, uint32_t ticks, uint8_t dir_bits, const uint16_t* steps) override;
+    void rewind(uint32_t sequence) override;
+    void reset() override;
+    void start() override;
+
+    // Runs in the executor for the fault code sent by the secondary
+    static void fault_event(void* arg);
+
+    // Configuration handlers:
+    void validate() override;
+    void group(Configuration::HandlerBase& handler) override;
+};
@@ -0,0 +1,87 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  SegmentTiming.h - step count and step period of one prepped segment
+
+  Stepper::prep_buffer() ends every segment by converting the remaining block distance
+  into whole steps and turning the segment duration into a step timer period.  That is
+  where the per-segment float divides and ceilf() calls are, so it is split out here in a
+  float form and a fixed-point form.  Both take and return the same state, so they can be
+  swapped by USE_FIXED_POINT_SEGMENTS in Config.h and compared against each other on the
+  host.  The functions are inline so that ticks_per_minute, which is a constant at the call
+  site, folds into the fixed-point path and leaves it with no float divide at all.
+*/
+
+#include <cstdint>
+#include <cmath>
+
+struct SegmentTiming {
+    uint16_t n_step;           // Whole steps to execute in this segment
+    uint32_t timer_ticks;      // Step period in timer ticks, before AMASS scaling
+    float    steps_remaining;  // Whole steps remaining in the block after this segment
+    float    dt_remainder;     // Time to execute the unexecuted partial step (min)
+};
+
+// steps_remaining is the previous segment's value, step_dist_remaining the fractional step
+// distance left after this segment, dt the segment time in minutes including the previous
+// dt_remainder, and ticks_per_minute the step timer frequency times 60.
+
+// Reference implementation, identical to the historical Grbl arithmetic.
+inline void segment_timing_float(float steps_remaining, float step_dist_remaining, float dt, uint32_t ticks_per_minute, SegmentTiming& out) {
+    float n_steps_remaining      = ceilf(step_dist_remaining);  // Round-up current steps remaining
+    float last_n_steps_remaining = ceilf(steps_remaining);      // Round-up last steps remaining
+    out.n_step                   = uint16_t(last_n_steps_remaining - n_steps_remaining);
+
+    // dt is in minutes so inv_rate is in minutes
+    float inv_rate      = dt / (last_n_steps_remaining - step_dist_remaining);  // Compute adjusted step rate inverse
+    out.timer_ticks     = uint32_t(ceilf(float(ticks_per_minute) * inv_rate));  // (timerTicks/step)
+    out.steps_remaining = n_steps_remaining;
+    out.dt_remainder    = (n_steps_remaining - step_dist_remaining) * inv_rate;
+}
+
+// Same result with step distances in Q24.8 and the rate computed by integer division, which
+// the ESP32 does in hardware.  Step counts match the float path exactly; the step period and
+// partial step time agree to within a timer tick.  Segments outside the fixed-point ranges -
+// blocks of more than 2^23 steps, or segments longer than 2^24 ticks, which only happen while
+// crawling to a stop - use the float path.
+inline void segment_timing_fixed(float steps_remaining, float step_dist_remaining, float dt, uint32_t ticks_per_minute, SegmentTiming& out) {
+    const int      frac_bits = 8;
+    const uint32_t one       = 1 << frac_bits;
+    const float    max_steps = float(1 << (31 - frac_bits));
+    const float    max_ticks = float(1 << (32 - frac_bits));
+
+    float dt_ticks_f = dt * float(ticks_per_minute);
+    if (!(steps_remaining < max_steps) || !(dt_ticks_f < max_ticks)) {
+        segment_timing_float(steps_remaining, step_dist_remaining, dt, ticks_per_minute, out);
+        return;
+    }
+
+    // Exact ceil() without the libm call: the float to integer conversion truncates.
+    uint32_t n_steps = uint32_t(step_dist_remaining);
+    if (float(n_steps) < step_dist_remaining) {
+        ++n_steps;
+    }
+    uint32_t last_n_steps = uint32_t(steps_remaining);
+    if (float(last_n_steps) < steps_remaining) {
+        ++last_n_steps;
+    }
+
+    uint32_t dist_q    = uint32_t(step_dist_remaining * float(one) + 0.5f);
+    uint32_t partial_q = (last_n_steps << frac_bits) - dist_q;  // Distance covered by this segment, in 1/256 steps
+    if (partial_q == 0) {
+        // Less than 1/512 step; only the float path can represent the resulting rate.
+        segment_timing_float(steps_remaining, step_dist_remaining, dt, ticks_per_minute, out);
+        return;
+    }
+
+    uint32_t dt_ticks = uint32_t(dt_ticks_f);
+    uint32_t frac_q   = (n_steps << frac_bits) - dist_q;  // Unexecuted partial step, at most one step
+
+    out.n_step          = uint16_t(last_n_steps - n_steps);
+    out.timer_ticks     = ((dt_ticks << frac_bits) + partial_q - 1) / partial_q;  // Rounded up, like ceilf()
+    out.steps_remaining = float(n_steps);
+    out.dt_remainder    = float((frac_q * dt_ticks) / partial_q) * (1.0f / float(ticks_per_minute));
+}
@@ -47,8 +47,10 @@
 #include "InputFile.h"
 #include "Main.h"        // display()
 #include "StartupLog.h"  // startupLog
+#include "JSONEncoder.h"  // JSONencoder
 
 #include "Driver/fluidnc_gpio.h"
+#include "Driver/heap.h"  // heap_region_stats()
 
 #include <atomic>
 #include <cstring>
@@ -68,7 +70,9 @@ void heapCheckTask(void* pvParameters) {
         uint32_t newHeapSize = xPortGetFreeHeapSize();
         if (newHeapSize != heapSize) {
             heapSize = newHeapSize;
-            log_info("heap " << heapSize);
+            heap_region_stats_t stats;
+            heap_region_stats(HEAP_INTERNAL, stats);
+            log_info("heap " << heapSize << " largest block " << stats.largest_block);
         }
         vTaskDelay(3000 / portTICK_RATE_MS);  // Yield to other tasks
 
@@ -115,7 +119,53 @@ void AllChannels::listChannels(Channel& out) {
     _mutex_general.lock();
     std::string retval;
     for (auto channel : _channelq) {
-        log_stream(out, channel->name());
+        LogStream msg(out, MsgLevelNone);
+        msg << channel->name();
+        channel->printStats(msg);
+    }
+    _mutex_general.unlock();
+}
+
+static std::string statsString(const Channel::Stats& stats) {
+    char buf[200];
+    snprintf(buf,
+             sizeof(buf),
+             "rx:%u lines:%u realtime:%u dropped:%u tx:%u lines:%u acks:%u ack_mean:%uus ack_max:%uus connects:%u",
+             unsigned(stats.rx_bytes),
+             unsigned(stats.rx_lines),
+             unsigned(stats.realtime),
+             unsigned(stats.dropped),
+             unsigned(stats.tx_bytes),
+             unsigned(stats.tx_lines),
+             unsigned(stats.acks),
+             unsigned(stats.acks ? stats.ack_total_us / stats.acks : 0),
+             unsigned(stats.ack_max_us),
+             unsigned(stats.connects));
+    return buf;
+}
+
+void AllChannels::listStats(Channel& out) {
+    _mutex_general.lock();
+    for (auto channel : _channelq) {
+        log_stream(out, "[Channel " << channel->name() << " " << statsString(channel->stats()) << "]");
+    }
+    _mutex_general.unlock();
+}
+
+void AllChannels::statsJSON(JSONencoder& j) {
+    _mutex_general.lock();
+    for (auto channel : _channelq) {
+        std::string id("Channel ");
+        id += channel->name();
+        j.id_value_object(id.c_str(), statsString(channel->stats()));
+    }
+    _mutex_general.unlock();
+}
+
+void AllChannels::resetStats() {
+    _mutex_general.lock();
+    for (auto channel : _channelq) {
+        channel->resetStats();
     }
     _mutex_general.unlock();
 }
@@ -167,10 +217,30 @@ size_t AllChannels::write(const uint8_t* buffer, size_t length) {
     _mutex_general.unlock();
     return length;
 }
+// A broadcast message is formatted once, with its newline, and then handed to
+// each channel whose message level accepts it as a single write, instead of each
+// channel being asked to filter and format its own copy.
 void AllChannels::print_msg(MsgLevel level, const char* msg) {
+    size_t      length = strlen(msg);
+    char        stack_line[maxLine + 2];
+    std::string long_line;
+    const char* line;
+    if (length + 1 <= sizeof(stack_line)) {
+        memcpy(stack_line, msg, length);
+        stack_line[length] = '\n';
+        line               = stack_line;
+    } else {
+        long_line = msg;
+        long_line += '\n';
+        line = long_line.c_str();
+    }
+    ++length;
+
     _mutex_general.lock();
     for (auto channel : _channelq) {
-        channel->print_msg(level, msg);
+        if (channel->_message_level >= level) {
+            channel->print_line(line, length);
+        }
     }
     _mutex_general.unlock();
 }
@@ -23,6 +23,8 @@ void channel_init();
 
 Channel* pollChannels(char* line = nullptr);
 
+class JSONencoder;
+
 class AllChannels : public Channel {
     std::vector<Channel*> _channelq;
 
@@ -55,6 +57,11 @@ public:
 
     void listChannels(Channel& out);
 
+    // Traffic counters of each channel, for $Channels/Stats and the WebUI system status
+    void listStats(Channel& out);
+    void statsJSON(JSONencoder& j);
+    void resetStats();
+
     Channel* find(const std::string& name);
     Channel* poll(char* line);
 };
@@ -101,6 +101,88 @@ Error Setting::check_state() {
 
 nvs_handle Setting::_handle = 0;
 
+int Setting::_transaction_depth = 0;
+
+struct StagedWrite {
+    enum { Erase, I32, I8, Str } op;
+    int32_t     number;
+    std::string text;
+};
+static std::map<std::string, StagedWrite> staged_writes;
+
+static esp_err_t stage(const char* key, StagedWrite write) {
+    staged_writes[key] = std::move(write);
+    return ESP_OK;
+}
+
+esp_err_t Setting::erase_key(const char* key) {
+    if (_transaction_depth) {
+        return stage(key, { StagedWrite::Erase, 0, "" });
+    }
+    return nvs_erase_key(_handle, key);
+}
+esp_err_t Setting::set_i32(const char* key, int32_t value) {
+    if (_transaction_depth) {
+        return stage(key, { StagedWrite::I32, value, "" });
+    }
+    return nvs_set_i32(_handle, key, value);
+}
+esp_err_t Setting::set_i8(const char* key, int8_t value) {
+    if (_transaction_depth) {
+        return stage(key, { StagedWrite::I8, value, "" });
+    }
+    return nvs_set_i8(_handle, key, value);
+}
+esp_err_t Setting::set_str(const char* key, const char* value) {
+    if (_transaction_depth) {
+        return stage(key, { StagedWrite::Str, 0, value });
+    }
+    return nvs_set_str(_handle, key, value);
+}
+
+Setting::Transaction::Transaction() {
+    ++_transaction_depth;
+}
+
+Setting::Transaction::~Transaction() {
+    if (--_transaction_depth) {
+        return;
+    }
+    if (staged_writes.empty()) {
+        return;
+    }
+    size_t failed = 0;
+    for (auto const& [key, write] : staged_writes) {
+        esp_err_t err = ESP_OK;
+        switch (write.op) {
+            case StagedWrite::Erase:
+                err = nvs_erase_key(_handle, key.c_str());
+                if (err == ESP_ERR_NVS_NOT_FOUND) {
+                    err = ESP_OK;  // Already at the default
+                }
+                break;
+            case StagedWrite::I32:
+                err = nvs_set_i32(_handle, key.c_str(), write.number);
+                break;
+            case StagedWrite::I8:
+                err = nvs_set_i8(_handle, key.c_str(), int8_t(write.number));
+                break;
+            case StagedWrite::Str:
+                err = nvs_set_str(_handle, key.c_str(), write.text.c_str());
+                break;
+        }
+        if (err) {
+            log_error("NVS write of " << key << " failed with error " << err);
+            ++failed;
+        }
+    }
+    if (esp_err_t err = nvs_commit(_handle)) {
+        log_error("NVS commit failed with error " << err);
+    }
+    log_debug("Wrote " << staged_writes.size() - failed << " settings to NVS");
+    staged_writes.clear();
+}
+
 void Setting::init() {
     if (!_handle) {
         if (esp_err_t err = nvs_open("FluidNC", NVS_READWRITE, &_handle)) {
@@ -136,11 +218,11 @@ void IntSetting::load() {
 
 void IntSetting::setDefault() {
     if (_currentIsNvm) {
-        nvs_erase_key(_handle, _keyName);
+        erase_key(_keyName);
     } else {
         _currentValue = _defaultValue;
         if (_storedValue != _currentValue) {
-            nvs_erase_key(_handle, _keyName);
+            erase_key(_keyName);
         }
     }
 }
@@ -167,9 +249,9 @@ Error IntSetting::setStringValue(std::string_view s) {
 
     if (_storedValue != convertedValue) {
         if (convertedValue == _defaultValue) {
-            nvs_erase_key(_handle, _keyName);
+            erase_key(_keyName);
         } else {
-            if (nvs_set_i32(_handle, _keyName, convertedValue)) {
+            if (set_i32(_keyName, convertedValue)) {
                 return Error::NvsSetFailed;
             }
             _storedValue = convertedValue;
@@ -247,7 +329,7 @@ void StringSetting::load() {
 void StringSetting::setDefault() {
     _currentValue = _defaultValue;
     if (_storedValue != _currentValue) {
-        nvs_erase_key(_handle, _keyName);
+        erase_key(_keyName);
     }
 }
 
@@ -263,10 +345,10 @@ Error StringSetting::setStringValue(std::string_view s) {
     _currentValue = s;
     if (_storedValue != _currentValue) {
         if (_currentValue == _defaultValue) {
-            nvs_erase_key(_handle, _keyName);
+            erase_key(_keyName);
             _storedValue = _defaultValue;
         } else {
-            if (nvs_set_str(_handle, _keyName, _currentValue.c_str())) {
+            if (set_str(_keyName, _currentValue.c_str())) {
                 return Error::NvsSetFailed;
             }
             _storedValue = _currentValue;
@@ -318,7 +400,7 @@ void EnumSetting::load() {
 void EnumSetting::setDefault() {
     _currentValue = _defaultValue;
     if (_storedValue != _currentValue) {
-        nvs_erase_key(_handle, _keyName);
+        erase_key(_keyName);
     }
 }
 
@@ -361,9 +443,9 @@ Error EnumSetting::setStringValue(std::string_view s) {
     _currentValue = it->second;
     if (_storedValue != _currentValue) {
         if (_currentValue == _defaultValue) {
-            nvs_erase_key(_handle, _keyName);
+            erase_key(_keyName);
         } else {
-            if (nvs_set_i8(_handle, _keyName, _currentValue)) {
+            if (set_i8(_keyName, _currentValue)) {
                 return Error::NvsSetFailed;
             }
             _storedValue = _currentValue;
@@ -481,7 +563,7 @@ void IPaddrSetting::load() {
 void IPaddrSetting::setDefault() {
     _currentValue = _defaultValue;
     if (_storedValue != _currentValue) {
-        nvs_erase_key(_handle, _keyName);
+        erase_key(_keyName);
     }
 }
 
@@ -498,9 +580,9 @@ Error IPaddrSetting::setStringValue(std::string_view s) {
     _currentValue = ipaddr;
     if (_storedValue != _currentValue) {
         if (_currentValue == _defaultValue) {
-            nvs_erase_key(_handle, _keyName);
+            erase_key(_keyName);
         } else {
-            if (nvs_set_i32(_handle, _keyName, (int32_t)_currentValue)) {
+            if (set_i32(_keyName, (int32_t)_currentValue)) {
                 return Error::NvsSetFailed;
             }
             _storedValue = _currentValue;
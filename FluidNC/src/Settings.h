@@ -111,15 +111,33 @@ public:
 
 class Setting : public Word {
 private:
+    static int _transaction_depth;
+
 protected:
     // group_t _group;
     axis_t      _axis = NO_AXIS;
     const char* _keyName;
 
+    // NVS writes of the settings, which are staged while a Transaction exists
+    static esp_err_t erase_key(const char* key);
+    static esp_err_t set_i32(const char* key, int32_t value);
+    static esp_err_t set_i8(const char* key, int8_t value);
+    static esp_err_t set_str(const char* key, const char* value);
+
 public:
     static nvs_handle _handle;
     static void       init();
 
+    // While a Transaction exists, setting changes update the values in memory
+    // and stage their NVS writes, keeping only the last write to each key.  When
+    // the outermost Transaction ends, each staged key is written once and NVS is
+    // committed once, so a bulk change does not write the flash many times.
+    class Transaction {
+    public:
+        Transaction();
+        ~Transaction();
+    };
+
     // Setting::List is a vector of all settings,
     // so common code can enumerate them.
     static std::vector<Setting*> List;
@@ -18,6 +18,12 @@ IntSetting* status_mask;
 
 IntSetting* sd_fallback_cs;
 
+IntSetting*  sd_read_ahead;
+EnumSetting* sd_read_ahead_psram;
+IntSetting*  sd_checkpoint_lines;
+IntSetting*  power_loss_interval;
+IntSetting*  jog_velocity_timeout;
+
 EnumSetting* message_level;
 
 const enum_opt_t messageLevels = {
@@ -87,6 +93,15 @@ void make_settings() {
 
     sd_fallback_cs = new IntSetting("SD CS pin if not configured", EXTENDED, WG, NULL, "SD/FallbackCS", -1, -1, 40);
 
+    sd_read_ahead       = new IntSetting("Job file read-ahead block size in KiB, 0 to disable", EXTENDED, WG, NULL, "SD/ReadAhead", 4, 0, 64);
+    sd_read_ahead_psram = new EnumSetting("Job file read-ahead in PSRAM", EXTENDED, WG, NULL, "SD/ReadAheadPSRAM", 0, &onoffOptions);
+    sd_checkpoint_lines =
+        new IntSetting("Job file lines between resume checkpoints, 0 to disable", EXTENDED, WG, NULL, "SD/CheckpointLines", 10000, 0, 1000000);
+    power_loss_interval =
+        new IntSetting("Seconds between power loss recovery records, 0 to disable", EXTENDED, WG, NULL, "PowerLoss/Interval", 0, 0, 3600);
+    jog_velocity_timeout =
+        new IntSetting("Milliseconds a velocity jog runs without an update, 0 for no limit", EXTENDED, WG, NULL, "Jog/VelocityTimeout", 500, 0, 10000);
+
     build_info = new StringSetting("OEM build info for $I command", EXTENDED, WG, NULL, "Firmware/Build", "", 0, 20);
 
     start_message =
@@ -12,6 +12,12 @@ extern IntSetting* status_mask;
 
 extern IntSetting* sd_fallback_cs;
 
+extern IntSetting*  sd_read_ahead;
+extern EnumSetting* sd_read_ahead_psram;
+extern IntSetting*  sd_checkpoint_lines;
+extern IntSetting*  power_loss_interval;
+extern IntSetting*  jog_velocity_timeout;
+
 extern EnumSetting* message_level;
 
 extern EnumSetting* gcode_echo;
@@ -0,0 +1,292 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Simulation.h"
+
+#include "SCurve.h"      // calculate_s_curve_profile
+#include "State.h"       // State
+#include "System.h"      // state_is
+#include "Stepper.h"     // Stepper::run_virtual
+#include "Stepping.h"    // Stepping::fStepperTimer
+#include "FileStream.h"  // FileStream
+#include "Machine/Axes.h"
+#include "Logging.h"
+
+#include <cmath>
+#include <cstdio>  // snprintf
+
+namespace Simulation {
+    const int MAX_LIMITED_LINES = 10;  // Lookahead-limited lines listed in the report
+
+    static bool     enabled = false;
+    static double   motion_seconds;
+    static double   dwell_seconds;
+    static double   distance;
+    static uint32_t blocks;
+    static float    max_speed;  // mm/min
+    static int32_t  max_speed_line;
+    static uint32_t limited_blocks;  // Blocks that lookahead kept below their nominal speed
+    static int32_t  limited_lines[MAX_LIMITED_LINES];
+    static int      n_limited_lines;
+
+    // Writes the step timeline of $CS=<file>, see Simulation.h
+    class Timeline : public Stepper::VirtualSink {
+        FileStream* _file;
+        size_t      _n_axis;
+        uint64_t    _segment_time  = 0;  // Start of the current segment
+        uint32_t    _segment_ticks = 0;  // Length of the current segment in timer ticks
+        int32_t     _steps[MAX_N_AXIS] {};
+        float       _velocity[MAX_N_AXIS] {};
+        float       _acceleration[MAX_N_AXIS] {};
+        uint64_t    _last_step[MAX_N_AXIS] {};
+        uint32_t    _min_interval[MAX_N_AXIS];  // Shortest time between two steps of an axis
+        bool        _stepped[MAX_N_AXIS] {};
+
+        void write(const char* line, int length) {
+            if (length > 0) {
+                _file->write(reinterpret_cast<const uint8_t*>(line), length);
+            }
+        }
+
+        // Writes the T line of the segment that just ended
+        void end_segment() {
+            if (!_segment_ticks) {
+                return;
+            }
+            const float seconds = float(_segment_ticks) / Machine::Stepping::fStepperTimer;
+            float       jerk[MAX_N_AXIS];
+            for (size_t axis = 0; axis < _n_axis; axis++) {
+                float velocity      = _steps[axis] / seconds;
+                float acceleration  = (velocity - _velocity[axis]) / seconds;
+                jerk[axis]          = (acceleration - _acceleration[axis]) / seconds;
+                _velocity[axis]     = velocity;
+                _acceleration[axis] = acceleration;
+                _steps[axis]        = 0;
+            }
+            char line[32 + 3 * MAX_N_AXIS * 16];
+            int  length = snprintf(line, sizeof(line), "T,%llu,%u", (unsigned long long)_segment_time, unsigned(_segment_ticks));
+            const float* columns[] = { _velocity, _acceleration, jerk };
+            for (const float* values : columns) {
+                for (size_t axis = 0; axis < _n_axis; axis++) {
+                    length += snprintf(line + length, sizeof(line) - length, ",%.1f", values[axis]);
+                }
+            }
+            length += snprintf(line + length, sizeof(line) - length, "\n");
+            write(line, length);
+            _segment_ticks = 0;
+        }
+
+    public:
+        uint64_t time  = 0;
+        uint64_t steps = 0;
+
+        explicit Timeline(FileStream* file) : _file(file), _n_axis(Machine::Axes::_numberAxis) {
+            for (auto& interval : _min_interval) {
+                interval = UINT32_MAX;
+            }
+            char line[80];
+            write(line, snprintf(line, sizeof(line), "# FluidNC step timeline, times in %u Hz ticks\n", unsigned(Machine::Stepping::fStepperTimer)));
+        }
+
+        ~Timeline() {
+            end_segment();
+            delete _file;
+        }
+
+        void segment(uint64_t start, uint32_t period, uint32_t ticks) override {
+            end_segment();
+            _segment_time  = start;
+            _segment_ticks = period * ticks;
+        }
+
+        void step(uint64_t at, uint8_t step_bits, uint8_t dir_bits) override {
+            for (size_t axis = 0; axis < _n_axis; axis++) {
+                if (!bitnum_is_true(step_bits, axis)) {
+                    continue;
+                }
+                bool negative = bitnum_is_true(dir_bits, axis);
+                _steps[axis] += negative ? -1 : 1;
+                ++steps;
+                if (_stepped[axis] && at - _last_step[axis] < _min_interval[axis]) {
+                    _min_interval[axis] = uint32_t(at - _last_step[axis]);
+                }
+                _stepped[axis]   = true;
+                _last_step[axis] = at;
+
+                char line[40];
+                write(line, snprintf(line, sizeof(line), "S,%llu,%c,%c\n", (unsigned long long)at, Machine::Axes::axisName(axis), negative ? '-' : '+'));
+            }
+        }
+
+        // Highest step rate of the axis in steps/s, zero if it never took two steps
+        uint32_t max_rate(size_t axis) const {
+            return _min_interval[axis] == UINT32_MAX ? 0 : Machine::Stepping::fStepperTimer / _min_interval[axis];
+        }
+
+        std::string path() { return _file->path(); }
+    };
+    static Timeline* timeline = nullptr;
+
+    bool active() { return enabled && state_is(State::CheckMode); }
+
+    void start(FileStream* file) {
+        delete timeline;
+        timeline        = file ? new Timeline(file) : nullptr;
+        enabled         = true;
+        motion_seconds  = 0.0;
+        dwell_seconds   = 0.0;
+        distance        = 0.0;
+        blocks          = 0;
+        max_speed       = 0.0f;
+        max_speed_line  = 0;
+        limited_blocks  = 0;
+        n_limited_lines = 0;
+    }
+
+    void stop() {
+        enabled = false;
+        delete timeline;
+        timeline = nullptr;
+    }
+
+    // Returns the time in seconds to run the block from its entry speed to exit_speed_sqr,
+    // and sets peak to the highest speed in mm/min.
+    static float block_seconds(plan_block_t* block, float exit_speed_sqr, float& peak) {
+        float nominal = plan_compute_profile_nominal_speed(block);
+        float entry   = sqrtf(block->entry_speed_sqr);
+        float exit    = sqrtf(exit_speed_sqr);
+        float accel   = block->acceleration;  // mm/min^2
+        float mm      = block->millimeters;
+
+        if (block->use_s_curve) {
+            // Each block is timed on its own; a run of S-curve blocks is not timed as one profile
+            SCurveProfile profile = calculate_s_curve_profile(mm, entry, exit, nominal, accel / 3600.0f, block->max_jerk / 216000.0f);
+            if (profile.valid) {
+                peak = profile.cruise_velocity;
+                return profile.total_time;
+            }
+        }
+
+        float accel_mm = (nominal * nominal - block->entry_speed_sqr) / (2.0f * accel);
+        float decel_mm = (nominal * nominal - exit_speed_sqr) / (2.0f * accel);
+        float minutes;
+        if (accel_mm + decel_mm <= mm) {
+            peak    = nominal;
+            minutes = (nominal - entry) / accel + (nominal - exit) / accel + (mm - accel_mm - decel_mm) / nominal;
+        } else {
+            // Triangle profile: accelerate until it is time to decelerate
+            float peak_sqr = (2.0f * accel * mm + block->entry_speed_sqr + exit_speed_sqr) / 2.0f;
+            peak           = sqrtf(fmaxf(peak_sqr, fmaxf(block->entry_speed_sqr, exit_speed_sqr)));
+            minutes        = (peak - entry) / accel + (peak - exit) / accel;
+        }
+        return minutes * 60.0f;
+    }
+
+    // Times and discards the oldest block.  lookahead_limited is true when the block runs
+    // while the planner is full, so a stop at the end of the queue only looks ahead as far as
+    // the queued distance.
+    static void run_block(bool lookahead_limited) {
+        plan_block_t* block = plan_get_current_block();
+        if (!block) {
+            return;
+        }
+        float queued_mm = plan_get_queued_mm();
+        float peak;
+        float seconds = block_seconds(block, plan_get_exec_block_exit_speed_sqr(), peak);
+        auto  line    = plan_get_block_aux(block)->line_number;
+
+        motion_seconds += seconds;
+        distance += block->millimeters;
+        ++blocks;
+        if (peak > max_speed) {
+            max_speed      = peak;
+            max_speed_line = line;
+        }
+
+        float nominal = plan_compute_profile_nominal_speed(block);
+        if (lookahead_limited && peak < 0.99f * nominal && queued_mm < nominal * nominal / (2.0f * block->acceleration)) {
+            ++limited_blocks;
+            if (n_limited_lines < MAX_LIMITED_LINES && (n_limited_lines == 0 || limited_lines[n_limited_lines - 1] != line)) {
+                limited_lines[n_limited_lines++] = line;
+            }
+        }
+        plan_discard_current_block();
+    }
+
+    // Lets the segment generator fill the segment buffer and runs the segments on the virtual
+    // clock.  Returns false if there were no segments to run.
+    static bool run_segments() {
+        Stepper::prep_buffer();
+        return Stepper::run_virtual(timeline->time, *timeline) != 0;
+    }
+
+    void make_room(plan_index_t needed) {
+        while (plan_get_block_buffer_available() < needed && plan_get_current_block()) {
+            // A block that the segment generator cannot take is timed from its profile instead
+            if (!timeline || !run_segments()) {
+                run_block(true);
+            }
+        }
+    }
+
+    void drain() {
+        while (plan_get_current_block()) {
+            if (!timeline || !run_segments()) {
+                run_block(false);
+            }
+        }
+        if (timeline) {
+            while (run_segments()) {}  // The input shaper finishes after the last block
+        }
+    }
+
+    void dwell(float seconds) {
+        drain();
+        dwell_seconds += seconds;
+    }
+
+    static const char* hms(double seconds, char* buf, size_t len) {
+        uint32_t s = uint32_t(seconds + 0.5);
+        snprintf(buf, len, "%u:%02u:%02u", unsigned(s / 3600), unsigned(s / 60 % 60), unsigned(s % 60));
+        return buf;
+    }
+
+    void report(Channel& out) {
+        drain();
+
+        if (timeline) {
+            char total[16];
+            log_stream(out,
+                       "[Simulation timeline:" << timeline->path() << " time:"
+                                               << hms(double(timeline->time) / Machine::Stepping::fStepperTimer, total, sizeof(total))
+                                               << " steps:" << timeline->steps << "]");
+            LogStream msg(out, MsgLevelNone);
+            msg << "[Simulation max step rate";
+            for (size_t axis = 0; axis < Machine::Axes::_numberAxis; axis++) {
+                msg << " " << Machine::Axes::axisName(axis) << ":" << timeline->max_rate(axis);
+            }
+            msg << "Hz]";
+        }
+
+        char total[16];
+        char motion[16];
+        log_stream(out,
+                   "[Simulation time:" << hms(motion_seconds + dwell_seconds, total, sizeof(total)) << " motion:"
+                                       << hms(motion_seconds, motion, sizeof(motion)) << " blocks:" << blocks << " distance:"
+                                       << setprecision(1) << distance << "mm]");
+        log_stream(out, "[Simulation max speed:" << setprecision(0) << max_speed << "mm/min line:" << max_speed_line << "]");
+
+        LogStream msg(out, MsgLevelNone);
+        msg << "[Simulation lookahead limited blocks:" << limited_blocks;
+        if (n_limited_lines) {
+            msg << " lines:";
+            for (int i = 0; i < n_limited_lines; i++) {
+                msg << (i ? "," : "") << limited_lines[i];
+            }
+            if (limited_blocks > uint32_t(n_limited_lines)) {
+                msg << ",...";
+            }
+        }
+        msg << "]";
+    }
+}
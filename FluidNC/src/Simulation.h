@@ -0,0 +1,54 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  Simulation.h - timed dry run of G-code in check mode
+
+  Plain check mode ($C) parses G-code without planning it.  A simulation ($CS) is check mode
+  in which motions are planned as usual, but instead of being driven by the steppers, each
+  block is timed from its planned velocity profile and discarded as soon as the planner needs
+  room.  Blocks are therefore planned with the same lookahead as in a real run, and the run
+  goes as fast as the parser and planner allow.  The totals are reported when the simulation
+  ends: estimated cycle time, the highest speed reached, and the lines where lookahead was
+  too short for a block to reach its programmed speed.
+
+  $CS=<file> also writes a step timeline to the file.  Instead of being timed from its profile,
+  each block then goes through the segment generator, and the segments are run by a virtual
+  step ISR (Stepper::run_virtual()) on a virtual clock, so the timeline shows what the motors
+  would do, including S-curves and input shaping.  Times are in stepper timer ticks from the
+  start of the simulation.  The lines are:
+
+    S,<time>,<axis>,<+ or ->                           a step
+    T,<time>,<ticks>,<velocity>...,<accel>...,<jerk>...  a segment, with one value per axis
+
+  where the velocity, acceleration and jerk of a segment in steps/s, steps/s^2 and steps/s^3
+  are derived from its steps and those of the segments before it.  The report then gives the
+  simulated time and the highest step rate of each axis.
+*/
+
+#include "Planner.h"  // plan_index_t
+
+class Channel;
+class FileStream;
+
+namespace Simulation {
+    // True in check mode entered with start().
+    bool active();
+
+    // Clears the totals.  Call when entering check mode.  With a timeline file, which the
+    // simulation then owns, the step timeline is written to it.
+    void start(FileStream* timeline = nullptr);
+    void stop();
+
+    // Runs the oldest planned blocks until at least needed blocks are free.
+    void make_room(plan_index_t needed);
+
+    // Runs every planned block, as the machine would before a synchronized command.
+    void drain();
+
+    void dwell(float seconds);
+
+    void report(Channel& out);
+}
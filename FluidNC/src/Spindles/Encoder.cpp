@@ -0,0 +1,114 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Encoder.h"
+
+#include "../Logging.h"
+#include "Driver/fluidnc_gpio.h"   // gpio_add_interrupt
+#include "Driver/pulse_counter.h"  // pulse_counter_init, pulse_counter_read
+
+#include <esp_timer.h>
+
+namespace Spindles {
+    void Encoder::init() {
+        _index_pin.setAttr(Pin::Attr::Input);
+        if (_a_pin.defined()) {
+            _a_pin.setAttr(Pin::Attr::Input);
+            pinnum_t b_pin = 255;
+            if (_b_pin.defined()) {
+                _b_pin.setAttr(Pin::Attr::Input);
+                b_pin = _b_pin.getNative(Pin::Capabilities::Input | Pin::Capabilities::Native);
+            }
+            _counts_per_rev = _ppr * (_b_pin.defined() ? 4 : 2);
+            pulse_counter_init(PCNT_UNIT, _a_pin.getNative(Pin::Capabilities::Input | Pin::Capabilities::Native), b_pin, _counts_per_rev);
+        }
+        gpio_add_interrupt(
+            _index_pin.getNative(Pin::Capabilities::Input | Pin::Capabilities::Native | Pin::Capabilities::ISR), Pin::RISING_EDGE, index_isr, this);
+
+        log_info("Spindle encoder Index:" << _index_pin.name() << (_a_pin.defined() ? " A:" + _a_pin.name() : "")
+                                          << (_b_pin.defined() ? " B:" + _b_pin.name() : "") << " PPR:" << _ppr);
+    }
+
+    void IRAM_ATTR Encoder::index_isr(void* arg) {
+        Encoder* e   = static_cast<Encoder*>(arg);
+        uint32_t now = uint32_t(esp_timer_get_time());
+        if (e->_index_time) {
+            e->_period = now - e->_index_time;
+        }
+        e->_index_time = now;
+        if (e->_counts_per_rev) {
+            e->_index_count = pulse_counter_read(PCNT_UNIT);
+        }
+        if (e->_armed) {
+            e->_revs      = 0;
+            e->_sync_time = now;
+            e->_synced    = e->_armed;
+            e->_armed     = 0;
+        } else {
+            ++e->_revs;
+        }
+    }
+
+    float Encoder::revolutions(uint8_t id, float& elapsed) {
+        uint32_t revs, index_time, sync_time, now;
+        int16_t  index_count, count = 0;
+        do {
+            revs        = _revs;
+            index_time  = _index_time;
+            sync_time   = _sync_time;
+            index_count = _index_count;
+            if (_counts_per_rev) {
+                count = pulse_counter_read(PCNT_UNIT);
+            }
+            now = uint32_t(esp_timer_get_time());
+        } while (revs != _revs || index_time != _index_time);  // An index pulse came in meanwhile
+
+        if (_synced != id) {
+            elapsed = 0.0f;
+            return 0.0f;
+        }
+        elapsed = (now - sync_time) * 1e-6f;
+
+        uint32_t since_index = now - index_time;
+        float    fraction;
+        if (_counts_per_rev) {
+            int32_t counts = (int32_t(count) - index_count) % int32_t(_counts_per_rev);
+            if (counts < 0) {
+                counts += _counts_per_rev;
+            }
+            fraction = float(counts) / _counts_per_rev;
+            // The count passes the index position a moment before the index ISR runs
+            if (_period && fraction < 0.5f && since_index > _period / 2) {
+                fraction += 1.0f;
+            }
+        } else {
+            fraction = _period ? float(since_index) / _period : 0.0f;
+            if (fraction > 1.0f) {
+                fraction = 1.0f;  // Slowing down; the next index pulse is late
+            }
+        }
+        return revs + fraction;
+    }
+
+    float Encoder::revs_per_sec() {
+        uint32_t period = _period;
+        if (!period || uint32_t(esp_timer_get_time()) - _index_time > 2 * period) {
+            return 0.0f;
+        }
+        return 1e6f / period;
+    }
+
+    void Encoder::validate() {
+        Assert(_index_pin.defined(), "Spindle encoder index_pin must be configured");
+        if (_a_pin.defined()) {
+            Assert(_ppr > 0, "Spindle encoder ppr must be set when a_pin is configured");
+        }
+    }
+
+    void Encoder::group(Configuration::HandlerBase& handler) {
+        handler.item("index_pin", _index_pin);
+        handler.item("a_pin", _a_pin);
+        handler.item("b_pin", _b_pin);
+        handler.item("ppr", _ppr, 0, 8191);  // 4 * ppr must fit in the 16-bit pulse counter
+    }
+}
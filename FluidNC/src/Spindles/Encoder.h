@@ -0,0 +1,68 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include "../Configuration/Configurable.h"
+#include "../Pin.h"
+
+#include <esp_attr.h>  // IRAM_ATTR
+#include <cstdint>
+
+namespace Spindles {
+    // A spindle encoder for spindle-synchronized motion (G33).  The index pin
+    // gives one pulse per revolution.  The optional a_pin, and b_pin of a
+    // quadrature encoder, add ppr pulses per revolution that a hardware pulse
+    // counter tracks between index pulses.  Without them, the position within
+    // a revolution is interpolated from the time between index pulses.
+    //
+    // Synchronized motion starts at an index pulse: the stepper ISR arms the
+    // encoder with the id of the motion and holds it until synced() says that
+    // the index pulse after arming has been seen.  revolutions() then measures
+    // the spindle travel from that pulse.
+    class Encoder : public Configuration::Configurable {
+        Pin      _a_pin;
+        Pin      _b_pin;
+        Pin      _index_pin;
+        uint32_t _ppr = 0;
+
+        static const int PCNT_UNIT = 0;
+
+        uint32_t _counts_per_rev = 0;  // Both edges of A and B are counted
+
+        // Updated by the index ISR
+        volatile uint32_t _index_time  = 0;  // esp_timer time of the last index pulse (us)
+        volatile uint32_t _period      = 0;  // Time between the last two index pulses (us)
+        volatile int16_t  _index_count = 0;  // Pulse counter at the last index pulse
+        volatile uint32_t _revs        = 0;  // Index pulses since the synchronizing one
+        volatile uint32_t _sync_time   = 0;  // esp_timer time of the synchronizing index pulse (us)
+        volatile uint8_t  _armed       = 0;
+        volatile uint8_t  _synced      = 0;
+
+        static void IRAM_ATTR index_isr(void* arg);
+
+    public:
+        Encoder() = default;
+
+        void init();
+
+        // Called by the stepper ISR
+        void IRAM_ATTR arm(uint8_t id) {
+            if (_synced != id) {
+                _armed = id;
+            }
+        }
+        bool IRAM_ATTR synced(uint8_t id) { return _synced == id; }
+
+        // Revolutions since the index pulse that synchronized id, and the seconds since
+        // that pulse in elapsed.  Both are zero until there is one.
+        float revolutions(uint8_t id, float& elapsed);
+
+        // Speed from the time between index pulses, zero if the spindle is stopped
+        float revs_per_sec();
+
+        // Configuration handlers:
+        void validate() override;
+        void group(Configuration::HandlerBase& handler) override;
+    };
+}
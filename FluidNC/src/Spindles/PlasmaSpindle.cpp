@@ -14,6 +14,15 @@ PlasmaSpindle:
   off_on_alarm: true
   atc:
   m6_macro:
+  thc:
+    arc_voltage_pin: gpio.36
+    divider: 50
+    target_v: 0
+    kp: 0.1
+    max_rate_mm_per_sec: 5
+    max_correction_mm: 5
+    anti_dive_percent: 90
+    delay_ms: 500
 
 Ideas:
 
@@ -39,6 +48,9 @@ namespace Spindles {
             linearSpeeds(1, 100.0f);
         }
         setupSpeeds(1);
+        if (_thc) {
+            _thc->init();
+        }
         init_atc();
         config_message();
     }
@@ -59,6 +71,9 @@ namespace Spindles {
             _arc_on = false;
             set_enable(false);
             sys.spindle_speed = 0.0;
+            if (_thc) {
+                _thc->stop();
+            }
         } else {
             sys.spindle_speed = speed;
 
@@ -80,7 +95,18 @@ namespace Spindles {
                 return;
             }
             _arc_on = true;
+            if (_thc) {
+                _thc->start();
+            }
+        }
+    }
+
+    void PlasmaSpindle::print_stats(Channel& out, bool reset) {
+        if (!_thc) {
+            Spindle::print_stats(out, reset);
+            return;
         }
+        _thc->print_stats(out, reset);
     }
 
     bool IRAM_ATTR PlasmaSpindle::wait_for_arc_ok() {
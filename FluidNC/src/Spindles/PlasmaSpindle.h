@@ -8,6 +8,7 @@
 */
 
 #include "Spindle.h"
+#include "Thc.h"
 #include "esp32-hal.h"          // millis()
 #include "src/MotionControl.h"  // mc_critical
 
@@ -43,6 +44,7 @@ namespace Spindles {
             handler.item("enable_pin", _enable_pin);
             handler.item("arc_ok_pin", _arcOkEventPin);
             handler.item("arc_wait_ms", _max_arc_wait, 0, 3000);
+            handler.section("thc", _thc);
             Spindle::group(handler);
         }
 
@@ -59,6 +61,7 @@ namespace Spindles {
         void setSpeedfromISR(uint32_t dev_speed) override;
         void setState(SpindleState state, SpindleSpeed speed) override;
         void config_message() override;
+        void print_stats(Channel& out, bool reset) override;
 
         // Methods introduced by this base clase
         virtual void set_direction(bool Clockwise);
@@ -78,6 +81,8 @@ namespace Spindles {
 
         uint32_t _max_arc_wait = 1000;
 
+        Thc* _thc = nullptr;  // Torch height control
+
         // TO DO. These are not used in the class
         // _disable_with_zero_speed forces a disable when speed is 0
         bool _disable_with_zero_speed = false;
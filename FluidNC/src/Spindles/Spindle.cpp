@@ -9,6 +9,8 @@
 #include "../System.h"  //sys.spindle_speed_ovr
 #include "src/UartChannel.h"
 
+#include <algorithm>
+
 Spindles::Spindle* spindle = nullptr;
 
 namespace Spindles {
@@ -64,6 +66,8 @@ namespace Spindles {
     }
 
     void Spindle::setupSpeeds(uint32_t max_dev_speed) {
+        _max_dev_speed = max_dev_speed;
+
         int nsegments = _speeds.size() - 1;
         if (nsegments < 1) {
             return;
@@ -95,6 +99,18 @@ namespace Spindles {
         _speeds[i].offset = offset;
         scaler            = 0;
         _speeds[i].scale  = scaler;
+
+        // Sample the map for mapSpeed().  Entry 0 is the map just above speed 0,
+        // since speed 0 itself is handled separately as off.
+        SpindleSpeed max_speed = maxSpeed();
+        if (max_speed == 0) {
+            return;
+        }
+        for (i = 0; i <= SPEED_LUT_SIZE; i++) {
+            _speed_lut[i] = walkSpeeds(SpindleSpeed(uint64_t(max_speed) * i / SPEED_LUT_SIZE));
+        }
+        _lut_scale     = uint32_t((uint64_t(SPEED_LUT_SIZE) << 16) / max_speed);
+        _lut_max_speed = max_speed;
     }
 
     void Spindle::validate() {
@@ -110,6 +126,21 @@ namespace Spindles {
         }
     }
 
+    // A new speed map is applied with the device range of the last init().  The
+    // default map of an empty speed_map depends on the spindle type, so that one
+    // needs the init() of a restart.
+    void Spindle::reload() {
+        if (!_max_dev_speed) {
+            return;  // Not initialized
+        }
+        if (_speeds.size() < 2) {
+            log_warn(name() << " default speed map takes effect after a restart");
+            return;
+        }
+        setupSpeeds(_max_dev_speed);
+        log_info(name() << " speed map reloaded, max speed " << maxSpeed());
+    }
+
     void Spindle::linearSpeeds(SpindleSpeed maxSpeed, float maxPercent) {
         _speeds.clear();
         _speeds.push_back({ 0, 0.0f });
@@ -159,24 +190,11 @@ namespace Spindles {
         }
     }
 
-    uint32_t IRAM_ATTR Spindle::mapSpeed(SpindleState state, SpindleSpeed speed) {
-        speed             = speed * sys.spindle_speed_ovr / 100;
-        sys.spindle_speed = speed;
-        if (state == SpindleState::Disable) {  // Halt or set spindle direction and speed.
-            if (_zero_speed_with_disable) {
-                sys.spindle_speed = 0.0;
-                return 0;
-            }
-        }
-        if (_speeds.size() == 0) {
-            return 0;
-        }
+    // Device speed of a speed by the speed map segments.  Used to fill the lookup table.
+    uint32_t Spindle::walkSpeeds(SpindleSpeed speed) {
         if (speed < _speeds[0].speed) {
             return _speeds[0].offset;
         }
-        if (speed == 0) {
-            return _speeds[0].offset;
-        }
         int num_segments = _speeds.size() - 1;
         int i;
         for (i = 0; i < num_segments; i++) {
@@ -195,9 +213,34 @@ namespace Spindles {
         if (i < num_segments) {
             dev_speed += uint32_t((((speed - _speeds[i].speed) * uint64_t(_speeds[i].scale)) >> 16));
         }
+        return dev_speed;
+    }
+
+    uint32_t IRAM_ATTR Spindle::mapSpeed(SpindleState state, SpindleSpeed speed) {
+        speed             = speed * sys.spindle_speed_ovr / 100;
+        sys.spindle_speed = speed;
+        if (state == SpindleState::Disable) {  // Halt or set spindle direction and speed.
+            if (_zero_speed_with_disable) {
+                sys.spindle_speed = 0.0;
+                return 0;
+            }
+        }
+        if (_speeds.size() == 0) {
+            return 0;
+        }
+        if (speed == 0 || speed < _speeds[0].speed) {
+            return _speeds[0].offset;
+        }
+        if (speed >= _lut_max_speed) {
+            return _speed_lut[SPEED_LUT_SIZE];
+        }
+        uint32_t position = speed * _lut_scale;  // At most SPEED_LUT_SIZE << 16
+        uint32_t i        = position >> 16;
+        uint32_t fraction = position & 0xffff;
+        int64_t  delta    = int64_t(_speed_lut[i + 1]) - int64_t(_speed_lut[i]);
 
         // log_debug("rpm " << speed << " speed " << dev_speed); // This will spew quite a bit of data on your output
-        return dev_speed;
+        return _speed_lut[i] + int32_t((delta * fraction) >> 16);
     }
     void Spindle::spindleDelay(SpindleState state, SpindleSpeed speed) {
         uint32_t up = 0, down = 0;
@@ -260,12 +303,34 @@ namespace Spindles {
                 }
         }
         if (down) {
-            dwell_ms(down < maxSpeed() ? _spindown_ms * down / maxSpeed() : _spindown_ms, DwellMode::SysSuspend);
+            spinWait(down < maxSpeed() ? _spindown_ms * down / maxSpeed() : _spindown_ms);
         }
         if (up) {
-            dwell_ms(up < maxSpeed() ? _spinup_ms * up / maxSpeed() : _spinup_ms, DwellMode::SysSuspend);
+            spinWait(up < maxSpeed() ? _spinup_ms * up / maxSpeed() : _spinup_ms);
         }
         _current_state = state;
         _current_speed = speed;
     }
+
+    void Spindle::print_stats(Channel& out, bool reset) {
+        log_stream(out, "[" << name() << " spindle has no statistics]");
+    }
+
+    // Dwells for ms, or less if the spindle reports that it has reached its speed
+    bool Spindle::spinWait(uint32_t ms) {
+        if (!hasSpeedFeedback()) {
+            return dwell_ms(ms, DwellMode::SysSuspend);
+        }
+        const uint32_t check_ms = 10;
+        for (uint32_t waited = 0; waited < ms; waited += check_ms) {
+            if (atSpeed()) {
+                log_debug(name() << ": at speed after " << waited << " of " << ms << " ms");
+                return true;
+            }
+            if (!dwell_ms(std::min(check_ms, ms - waited), DwellMode::SysSuspend)) {
+                return false;
+            }
+        }
+        return true;
+    }
 }
@@ -14,6 +14,7 @@
 #include "src/GCode.h"  // MaxToolNumber
 #include "src/Module.h"
 #include "src/ToolChangers/atc.h"
+#include "Encoder.h"
 
 // ===============  No floats! ===========================
 // ================ NO FLOATS! ==========================
@@ -50,10 +51,12 @@ namespace Spindles {
         void     setupSpeeds(uint32_t max_dev_speed);
         void     shelfSpeeds(SpindleSpeed min, SpindleSpeed max);
         void     linearSpeeds(SpindleSpeed maxSpeed, float maxPercent);
+        uint32_t walkSpeeds(SpindleSpeed speed);
 
         static void switchSpindle(uint32_t new_tool, SpindleList spindles, Spindle*& spindle, bool& stop_spindle, bool& new_spindle);
 
         void         spindleDelay(SpindleState state, SpindleSpeed speed);
+        bool         spinWait(uint32_t ms);
         virtual void init() = 0;  // not in constructor because this also gets called when $$ settings change
         virtual void init_atc();
         std::string  atc_info() { return _atc_info; };
@@ -65,6 +68,25 @@ namespace Spindles {
         virtual void    config_message() = 0;
         virtual bool    isRateAdjusted();
         virtual bool    use_delay_settings() const { return true; }
+
+        // Spindles that can measure their speed, such as VFDs that report it or
+        // spindles with an encoder, override these so that spindleDelay() stops
+        // waiting as soon as atSpeed() says the speed set by the last setState()
+        // has been reached.  spinup_ms and spindown_ms are then the longest waits.
+        virtual bool hasSpeedFeedback() { return false; }
+
+        // Spindle load in percent of the rated load, or -1 if unknown
+        virtual int load_percent() { return -1; }
+        virtual bool atSpeed() { return false; }
+
+        // Shortest time between spindle override updates.  Spindles that are
+        // commanded over a slow link raise it so that override keypresses are
+        // coalesced into fewer speed commands.
+        virtual uint32_t override_interval_ms() { return OVERRIDE_INTERVAL_MS; }
+
+        // Reports communication statistics for spindles that have them, such
+        // as VFDs.  reset clears them after reporting.
+        virtual void print_stats(Channel& out, bool reset);
         virtual uint8_t get_current_tool_num() { return _current_tool; }
         virtual bool    tool_change(uint32_t tool_number, bool pre_select, bool set_tool);
 
@@ -81,12 +103,36 @@ namespace Spindles {
         uint32_t _spinup_ms   = 0;
         uint32_t _spindown_ms = 0;
 
+        // Time for the spindle override to ramp by 100 percent; 0 changes it in one step
+        uint32_t _override_ramp_ms = 0;
+
+        static const uint32_t OVERRIDE_INTERVAL_MS = 20;
+
         int _tool = -1;
 
         std::vector<Configuration::speedEntry> _speeds;
 
+        // setupSpeeds() samples the speed map at SPEED_LUT_SIZE + 1 evenly spaced speeds
+        // from 0 to the map's maximum, so mapSpeed() interpolates between two table
+        // entries instead of searching the map segments.
+        static const int SPEED_LUT_BITS = 8;
+        static const int SPEED_LUT_SIZE = 1 << SPEED_LUT_BITS;
+
+        uint32_t     _speed_lut[SPEED_LUT_SIZE + 1] = { 0 };  // Device speeds
+        SpindleSpeed _lut_max_speed                 = 0;      // Speed of the last entry; 0 until setupSpeeds()
+        uint32_t     _lut_scale                     = 0;      // Entries per unit of speed, 16.16 fixed point
+        uint32_t     _max_dev_speed                 = 0;      // Argument of the last setupSpeeds(), for reload()
+
         bool _off_on_alarm = false;
 
+        // An S word on a line with motion goes to the planner with the motion and takes effect
+        // when the block starts, as it does in laser mode, instead of stopping the motion to
+        // change the speed and wait for it with spinup_ms or atSpeed().  A line with an S word
+        // and no motion still waits.
+        bool _queued_speed_changes = false;
+
+        Encoder* _encoder = nullptr;  // For spindle-synchronized motion
+
         Macro       _m6_macro;
         std::string _atc_name = "";
 
@@ -96,6 +142,7 @@ namespace Spindles {
         // Configuration handlers:
         void validate() override;
         void afterParse() override;
+        void reload() override;
 
         void group(Configuration::HandlerBase& handler) override {
             if (use_delay_settings()) {
@@ -104,10 +151,13 @@ namespace Spindles {
             }
             handler.item("tool_num", _tool, 0, MaxToolNumber);
             handler.item("speed_map", _speeds);
+            handler.item("override_ramp_ms", _override_ramp_ms, 0, 60000);
             handler.item("off_on_alarm", _off_on_alarm);
             handler.item("atc", _atc_name);
             handler.item("m6_macro", _m6_macro);
             handler.item("s0_with_disable", _zero_speed_with_disable);
+            handler.item("queued_speed_changes", _queued_speed_changes);
+            handler.section("encoder", _encoder);
         }
 
         // Virtual base classes require a virtual destructor.
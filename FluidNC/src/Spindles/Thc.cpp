@@ -0,0 +1,140 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Thc.h"
+
+#include "../Logging.h"
+#include "../Config.h"                 // Z_AXIS
+#include "../Machine/MachineConfig.h"  // config
+#include "../Stepper.h"                // Stepper::set_z_offset()
+#include "../Stepping.h"               // Stepping::fStepperTimer
+#include "../Planner.h"                // plan_sync_position()
+#include "../GCode.h"                  // gc_sync_position()
+#include "../System.h"                 // sys.abort, state_is()
+#include "Driver/adc.h"                // adc_init(), adc_read_mv()
+
+#include <cmath>
+
+namespace Spindles {
+    void Thc::init() {
+        _arc_voltage_pin.setAttr(Pin::Attr::Input);
+        _adc_pin = _arc_voltage_pin.getNative(Pin::Capabilities::Input | Pin::Capabilities::Native);
+        if (!adc_init(_adc_pin)) {
+            return;
+        }
+        if (!_task) {
+            Machine::Tasks::get()._thc.create(thc_task, this, &_task);
+        }
+        log_info("THC Arc voltage:" << _arc_voltage_pin.name() << " Divider:" << _divider << " Target:" << _target_v << "V");
+    }
+
+    void Thc::start() {
+        _offset = 0.0f;
+        _arc_on = true;
+        ++_cuts;
+    }
+
+    // Called with the motion stopped.  The correction stays where it is, so the planner
+    // and the parser take over the current Z position.
+    void Thc::stop() {
+        _arc_on = false;
+        if (Stepper::get_z_offset()) {
+            Stepper::clear_z_offset();
+            plan_sync_position();
+            gc_sync_position();
+        }
+    }
+
+    void Thc::thc_task(void* pvParameters) {
+        Thc*       thc        = static_cast<Thc*>(pvParameters);
+        TickType_t wake       = xTaskGetTickCount();
+        TickType_t arc_time   = 0;
+        bool       was_on     = false;
+        float      integral   = 0.0f;
+        float      last_error = 0.0f;
+        while (true) {
+            vTaskDelayUntil(&wake, MAX(pdMS_TO_TICKS(thc->_sample_ms), 1));
+            thc->_voltage = adc_read_mv(thc->_adc_pin) / 1000.0f * thc->_divider;
+            if (sys.abort || state_is(State::Alarm)) {
+                thc->_arc_on = false;  // The reset clears the offset, and setState() is not called
+            }
+            if (!thc->_arc_on) {
+                was_on = false;
+                continue;
+            }
+            if (!was_on) {
+                was_on       = true;
+                arc_time     = xTaskGetTickCount();
+                integral     = 0.0f;
+                last_error   = 0.0f;
+                thc->_target = 0.0f;
+            }
+            thc->control(integral, last_error, arc_time);
+        }
+    }
+
+    void Thc::control(float& integral, float& last_error, TickType_t arc_time) {
+        if ((xTaskGetTickCount() - arc_time) < pdMS_TO_TICKS(_delay_ms)) {
+            return;  // The arc is still settling after the pierce
+        }
+        if (_target == 0.0f) {
+            _target = _target_v > 0.0f ? _target_v : _voltage;
+        }
+
+        float programmed = Stepper::get_programmed_rate();
+        _holding         = programmed > 0.0f && Stepper::get_realtime_rate() < programmed * _anti_dive_percent / 100.0f;
+        if (_holding) {
+            return;
+        }
+
+        float dt    = _sample_ms / 1000.0f;
+        float error = _voltage - _target;  // Positive when the torch is too high
+        if (fabsf(error) < _deadband_v) {
+            error = 0.0f;
+        }
+        integral += error * dt;
+        if (_ki > 0.0f) {
+            integral = myConstrain(integral, -_max_rate / _ki, _max_rate / _ki);  // Anti-windup
+        }
+        float rate = -(_kp * error + _ki * integral + _kd * (error - last_error) / dt);
+        last_error = error;
+
+        rate    = myConstrain(rate, -_max_rate, _max_rate);
+        _offset = myConstrain(_offset + rate * dt, -_max_correction, _max_correction);
+        if (fabsf(_offset) > _max_seen) {
+            _max_seen = fabsf(_offset);
+        }
+
+        float steps_per_mm = config->_axes->_axis[Z_AXIS]->_stepsPerMm;
+        Stepper::set_z_offset(lroundf(_offset * steps_per_mm), uint32_t(Machine::Stepping::fStepperTimer / (_max_rate * steps_per_mm)));
+    }
+
+    void Thc::print_stats(Channel& out, bool reset) {
+        log_stream(out,
+                   "[THC arc:" << _voltage << "V target:" << _target << "V offset:" << _offset << "mm" << (_holding ? " holding" : "")
+                               << " cuts:" << _cuts << " max_offset:" << _max_seen << "mm]");
+        if (reset) {
+            _cuts     = 0;
+            _max_seen = 0.0f;
+        }
+    }
+
+    void Thc::validate() {
+        Assert(_arc_voltage_pin.defined(), "THC arc_voltage_pin must be configured");
+    }
+
+    void Thc::group(Configuration::HandlerBase& handler) {
+        handler.item("arc_voltage_pin", _arc_voltage_pin);
+        handler.item("divider", _divider, 1.0f, 1000.0f);
+        handler.item("target_v", _target_v, 0.0f, 300.0f);
+        handler.item("deadband_v", _deadband_v, 0.0f, 20.0f);
+        handler.item("kp", _kp, 0.0f, 10.0f);
+        handler.item("ki", _ki, 0.0f, 10.0f);
+        handler.item("kd", _kd, 0.0f, 10.0f);
+        handler.item("max_rate_mm_per_sec", _max_rate, 0.1f, 50.0f);
+        handler.item("max_correction_mm", _max_correction, 0.0f, 50.0f);
+        handler.item("anti_dive_percent", _anti_dive_percent, 0.0f, 100.0f);
+        handler.item("sample_ms", _sample_ms, 1, 100);
+        handler.item("delay_ms", _delay_ms, 0, 5000);
+    }
+}
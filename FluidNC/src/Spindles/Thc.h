@@ -0,0 +1,69 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include "../Configuration/Configurable.h"
+#include "../Pin.h"
+#include "../Channel.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <cstdint>
+
+namespace Spindles {
+    // Torch height control for a plasma spindle.  A task samples the arc voltage
+    // through a voltage divider on an ADC1 pin every sample_ms, and a PID loop turns
+    // the difference from the target voltage into a Z velocity.  The resulting
+    // height offset goes straight to the step ISR, see Stepper::set_z_offset(), so
+    // it takes effect without waiting for the planned motion.
+    //
+    // Control starts delay_ms after arc OK.  With target_v 0, the target is the arc
+    // voltage at that moment.  The correction is held while the machine runs slower
+    // than anti_dive_percent of the programmed feed rate, as it does in corners, where
+    // the voltage rises without the torch being higher.
+    class Thc : public Configuration::Configurable {
+        Pin   _arc_voltage_pin;
+        float _divider           = 50.0f;  // Arc volts per volt at the pin
+        float _target_v          = 0.0f;
+        float _deadband_v        = 1.0f;
+        float _kp                = 0.1f;  // mm/s per volt of error
+        float _ki                = 0.0f;  // mm/s per volt second
+        float _kd                = 0.0f;  // mm/s per volt/s
+        float _max_rate          = 5.0f;  // mm/s
+        float _max_correction    = 5.0f;  // mm
+        float _anti_dive_percent = 90.0f;
+        int   _sample_ms         = 5;
+        int   _delay_ms          = 500;
+
+        pinnum_t     _adc_pin = 0;
+        TaskHandle_t _task    = nullptr;
+
+        // Shared with the task
+        volatile bool  _arc_on   = false;
+        volatile float _voltage  = 0.0f;   // Last arc voltage
+        volatile float _target   = 0.0f;   // Target voltage of the current cut
+        volatile bool  _holding  = false;  // Held by the anti-dive check
+        volatile float _offset   = 0.0f;   // Correction of the current cut (mm)
+        uint32_t       _cuts     = 0;
+        float          _max_seen = 0.0f;  // Largest correction since the statistics were reset (mm)
+
+        static void thc_task(void* pvParameters);
+        void        control(float& integral, float& last_error, TickType_t arc_time);
+
+    public:
+        Thc() = default;
+
+        void init();
+
+        // Called by the plasma spindle when the arc is established and when it is turned off
+        void start();
+        void stop();
+
+        void print_stats(Channel& out, bool reset);
+
+        // Configuration handlers
+        void validate() override;
+        void group(Configuration::HandlerBase& handler) override;
+    };
+}
@@ -10,176 +10,53 @@
 
 namespace Spindles {
     namespace VFD {
-        void GenericProtocol::scale(uint32_t& n, std::string_view scale_str, uint32_t maxRPM) {
-            int32_t divider = 1;
-            if (scale_str.empty()) {
-                return;
-            }
-            if (scale_str[0] == '%') {
-                scale_str.remove_prefix(1);
-                n *= 100;
-                divider *= maxRPM;
-            }
-            if (scale_str[0] == '*') {
-                std::string_view numerator_str;
-                scale_str = scale_str.substr(1);
-                string_util::split_prefix(scale_str, numerator_str, '/');
-                uint32_t numerator;
-                if (string_util::from_decimal(numerator_str, numerator)) {
-                    n *= numerator;
-                } else {
-                    log_error(spindle->name() << ": bad decimal number " << numerator_str);
-                    return;
-                }
-                if (!scale_str.empty()) {
-                    uint32_t denominator;
-                    if (string_util::from_decimal(scale_str, denominator)) {
-                        divider *= denominator;
-                    } else {
-                        log_error(spindle->name() << ": bad decimal number " << scale_str);
-                        return;
-                    }
-                }
-            } else if (scale_str[0] == '/') {
-                std::string_view denominator_str(scale_str.substr(1));
-                uint32_t         denominator;
-                if (string_util::from_decimal(denominator_str, denominator)) {
-                    divider *= denominator;
-                } else {
-                    log_error(spindle->name() << ": bad decimal number " << scale_str);
-                    return;
-                }
-            }
-
-            n /= divider;
-        }
-
-        bool GenericProtocol::set_data(std::string_view token, std::basic_string_view<uint8_t>& response_view, const char* name, uint32_t& data) {
-            if (string_util::starts_with_ignore_case(token, name)) {
-                uint32_t rval  = (response_view[0] << 8) + (response_view[1] & 0xff);
-                uint32_t orval = rval;
-                scale(rval, token.substr(strlen(name)), 1);
-                data = rval;
-                response_view.remove_prefix(2);
+        bool GenericProtocol::parser(const uint8_t* response, VFDSpindle* spindle, GenericProtocol* instance) {
+            if (_response == nullptr) {
                 return true;
             }
-            return false;
-        }
-        bool GenericProtocol::parser(const uint8_t* response, VFDSpindle* spindle, GenericProtocol* instance) {
-            // This routine does not know the actual length of the response array
-            std::basic_string_view<uint8_t> response_view(response, VFD_RS485_MAX_MSG_SIZE);
-            response_view.remove_prefix(1);  // Remove the modbus ID which has already been checked
-
-            std::string_view token;
-            std::string_view format(_response_format);
-            while (string_util::split_prefix(format, token, ' ')) {
-                uint8_t val;
-                if (token == "") {
-                    // Ignore repeated blanks
-                    continue;
-                }
-
-                // Sync must be in a temporary because it's volatile!
-                uint32_t sync = spindle->_sync_dev_speed;
-                if (set_data(token, response_view, "rpm", sync)) {
-                    spindle->_sync_dev_speed = sync;
-                    continue;
-                }
-                uint32_t ignore;
-                if (set_data(token, response_view, "ignore", ignore)) {
-                    continue;
-                }
-                if (set_data(token, response_view, "minrpm", instance->_minRPM)) {
-                    log_debug(spindle->name() << ": got minRPM " << instance->_minRPM);
-                    continue;
-                }
-                if (set_data(token, response_view, "maxrpm", instance->_maxRPM)) {
-                    log_debug(spindle->name() << ": got maxRPM " << instance->_maxRPM);
-                    continue;
-                }
-                if (string_util::from_hex(token, val)) {
-                    if (val != response_view[0]) {
-                        log_debug(spindle->name() << ": response mismatch - expected " << to_hex(val) << " got " << to_hex(response_view[0]));
-                        return false;
-                    }
-                    response_view.remove_prefix(1);
-                    continue;
-                }
-                log_error(spindle->name() << ": bad response token " << token);
+            ModbusTemplate::Values values;
+            if (!_response->match(response + 1, values)) {  // Skip the modbus ID which has already been checked
+                log_debug(spindle->name() << ": response mismatch");
                 return false;
             }
-            return true;
-        }
-        void GenericProtocol::send_vfd_command(const std::string cmd, ModbusCommand& data, uint32_t out) {
-            data.tx_length = 1;
-            data.rx_length = 1;
-            if (cmd.empty()) {
-                return;
+            if (values.has_rpm) {
+                spindle->_sync_dev_speed = values.rpm;
             }
-
-            std::string_view out_view;
-            std::string_view in_view(cmd);
-            string_util::split_prefix(in_view, out_view, '>');
-            _response_format = in_view;  // Remember the response format for the parser
-
-            std::string_view token;
-            while (data.tx_length < (VFD_RS485_MAX_MSG_SIZE - 3) && string_util::split_prefix(out_view, token, ' ')) {
-                if (token == "") {
-                    // Ignore repeated blanks
-                    continue;
-                }
-                if (string_util::starts_with_ignore_case(token, "rpm")) {
-                    uint32_t oout = out;
-                    scale(out, token.substr(strlen("rpm")), _maxRPM);
-                    data.msg[data.tx_length++] = out >> 8;
-                    data.msg[data.tx_length++] = out & 0xff;
-                } else if (string_util::from_hex(token, data.msg[data.tx_length])) {
-                    ++data.tx_length;
-                } else {
-                    log_error(spindle->name() << ":Bad hex number " << token);
-                    return;
-                }
+            if (values.has_min_rpm) {
+                instance->_minRPM = values.min_rpm;
+                log_debug(spindle->name() << ": got minRPM " << instance->_minRPM);
             }
-            while (data.rx_length < (VFD_RS485_MAX_MSG_SIZE - 3) && string_util::split_prefix(in_view, token, ' ')) {
-                if (token == "") {
-                    // Ignore repeated spaces
-                    continue;
-                }
-                uint8_t x;
-                if (string_util::equal_ignore_case(token, "echo")) {
-                    data.rx_length = data.tx_length;
-                    break;
-                }
-                if (string_util::starts_with_ignore_case(token, "rpm") || string_util::starts_with_ignore_case(token, "minrpm") ||
-                    string_util::starts_with_ignore_case(token, "maxrpm") || string_util::starts_with_ignore_case(token, "ignore")) {
-                    data.rx_length += 2;
-                } else if (string_util::from_hex(token, x)) {
-                    ++data.rx_length;
-                } else {
-                    log_error(spindle->name() << ": bad hex number " << token);
-                }
+            if (values.has_max_rpm) {
+                instance->_maxRPM = values.max_rpm;
+                log_debug(spindle->name() << ": got maxRPM " << instance->_maxRPM);
             }
+            return true;
+        }
+        void GenericProtocol::send_vfd_command(const ModbusTemplate::Command& cmd, ModbusCommand& data, uint32_t out) {
+            data.tx_length = cmd.build(data.msg, out, _maxRPM);
+            data.rx_length = cmd.rx_length;
+            _response      = &cmd;  // Remember the response format for the parser
         }
         void GenericProtocol::direction_command(SpindleState mode, ModbusCommand& data) {
             switch (mode) {
                 case SpindleState::Cw:
-                    send_vfd_command(_cw_cmd, data, 0);
+                    send_vfd_command(_cw, data, 0);
                     break;
                 case SpindleState::Ccw:
-                    send_vfd_command(_ccw_cmd, data, 0);
+                    send_vfd_command(_ccw, data, 0);
                     break;
                 default:  // SpindleState::Disable
-                    send_vfd_command(_off_cmd, data, 0);
+                    send_vfd_command(_off, data, 0);
                     break;
             }
         }
 
         void GenericProtocol::set_speed_command(uint32_t speed, ModbusCommand& data) {
-            send_vfd_command(_set_rpm_cmd, data, speed);
+            send_vfd_command(_set_rpm, data, speed);
         }
 
         VFDProtocol::response_parser GenericProtocol::get_current_speed(ModbusCommand& data) {
-            send_vfd_command(_get_rpm_cmd, data, 0);
+            send_vfd_command(_get_rpm, data, 0);
             return [](const uint8_t* response, VFDSpindle* spindle, VFDProtocol* protocol) -> bool {
                 auto instance = static_cast<GenericProtocol*>(protocol);
                 return instance->parser(response, spindle, instance);
@@ -204,15 +81,15 @@ namespace Spindles {
             // something changed?
 
             this->spindle = vfd;
-            if (_maxRPM == 0xffffffff && !_get_max_rpm_cmd.empty()) {
-                send_vfd_command(_get_max_rpm_cmd, data, 0);
+            if (_maxRPM == 0xffffffff && !_get_max_rpm.empty) {
+                send_vfd_command(_get_max_rpm, data, 0);
                 return [](const uint8_t* response, VFDSpindle* spindle, VFDProtocol* protocol) -> bool {
                     auto instance = static_cast<GenericProtocol*>(protocol);
                     return instance->parser(response, spindle, instance);
                 };
             }
-            if (_minRPM == 0xffffffff && !_get_min_rpm_cmd.empty()) {
-                send_vfd_command(_get_min_rpm_cmd, data, 0);
+            if (_minRPM == 0xffffffff && !_get_min_rpm.empty) {
+                send_vfd_command(_get_min_rpm, data, 0);
                 return [](const uint8_t* response, VFDSpindle* spindle, VFDProtocol* protocol) -> bool {
                     auto instance = static_cast<GenericProtocol*>(protocol);
                     return instance->parser(response, spindle, instance);
@@ -310,7 +187,26 @@ namespace Spindles {
                 "",
             },
         };
+        void GenericProtocol::compile(const char* name, const std::string& str, ModbusTemplate::Command& cmd) {
+            std::string_view bad;
+            if (!ModbusTemplate::compile(str, cmd, bad)) {
+                log_error("ModbusVFD " << name << ": bad token " << bad << " in " << str);
+            }
+        }
+
         void GenericProtocol::afterParse() {
+            set_model_defaults();
+
+            compile("cw_cmd", _cw_cmd, _cw);
+            compile("ccw_cmd", _ccw_cmd, _ccw);
+            compile("off_cmd", _off_cmd, _off);
+            compile("set_rpm_cmd", _set_rpm_cmd, _set_rpm);
+            compile("get_min_rpm_cmd", _get_min_rpm_cmd, _get_min_rpm);
+            compile("get_max_rpm_cmd", _get_max_rpm_cmd, _get_max_rpm);
+            compile("get_rpm_cmd", _get_rpm_cmd, _get_rpm);
+        }
+
+        void GenericProtocol::set_model_defaults() {
             for (auto const& vfd : VFDtypes) {
                 if (string_util::equal_ignore_case(_model, vfd.name)) {
                     log_debug("Using predefined ModbusVFD " << vfd.name);
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "VFDProtocol.h"
+#include "ModbusTemplate.h"
 #include <string_view>
 
 namespace Spindles {
@@ -11,10 +12,6 @@ namespace Spindles {
 
     namespace VFD {
         class GenericProtocol : public VFDProtocol, Configuration::Configurable {
-        private:
-            void scale(uint32_t& n, std::string_view scale_str, uint32_t maxRPM);
-            bool set_data(std::string_view token, std::basic_string_view<uint8_t>& response_view, const char* name, uint32_t& data);
-
         protected:
             void direction_command(SpindleState mode, ModbusCommand& data) override;
             void set_speed_command(uint32_t dev_speed, ModbusCommand& data) override;
@@ -37,16 +34,27 @@ namespace Spindles {
 
         private:
             std::string _model;  // VFD Model name
-            uint32_t*   _response_data;
             uint32_t    _minRPM = 0xffffffff;
             uint32_t    _maxRPM = 0xffffffff;
 
             VFDSpindle* spindle;
 
-            bool        parser(const uint8_t* response, VFDSpindle* spindle, GenericProtocol* protocol);
-            void        send_vfd_command(const std::string cmd, ModbusCommand& data, uint32_t out);
-            std::string _response_format;
-            void        setup_speeds(VFDSpindle* vfd);
+            // The command strings compiled by afterParse()
+            ModbusTemplate::Command _cw;
+            ModbusTemplate::Command _ccw;
+            ModbusTemplate::Command _off;
+            ModbusTemplate::Command _set_rpm;
+            ModbusTemplate::Command _get_min_rpm;
+            ModbusTemplate::Command _get_max_rpm;
+            ModbusTemplate::Command _get_rpm;
+
+            const ModbusTemplate::Command* _response = nullptr;  // The command whose response is expected next
+
+            bool parser(const uint8_t* response, VFDSpindle* spindle, GenericProtocol* protocol);
+            void send_vfd_command(const ModbusTemplate::Command& cmd, ModbusCommand& data, uint32_t out);
+            void compile(const char* name, const std::string& str, ModbusTemplate::Command& cmd);
+            void setup_speeds(VFDSpindle* vfd);
+            void set_model_defaults();
 
         public:
             void afterParse() override;
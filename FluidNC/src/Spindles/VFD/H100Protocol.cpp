@@ -171,6 +171,24 @@ namespace Spindles {
             };
         }
 
+        VFDProtocol::response_parser H100Protocol::get_current_load(ModbusCommand& data) {
+            // [01] [04] [0002] [0001] -- output current
+            data.tx_length = 6;
+            data.rx_length = 5;
+
+            data.msg[1] = 0x04;
+            data.msg[2] = 0x00;
+            data.msg[3] = 0x02;  // Output current
+            data.msg[4] = 0x00;
+            data.msg[5] = 0x01;
+
+            return [](const uint8_t* response, VFDSpindle* vfd, VFDProtocol* detail) -> bool {
+                // 01 04 02 [current 16, 0.1 A] [crc16]
+                vfd->set_output_current((uint16_t(response[3]) << 8) | uint16_t(response[4]));
+                return true;
+            };
+        }
+
         // Configuration registration
         namespace {
             SpindleFactory::DependentInstanceBuilder<VFDSpindle, H100Protocol> registration("H100");
@@ -391,6 +391,23 @@ namespace Spindles {
             };
         }
 
+        VFDProtocol::response_parser HuanyangProtocol::get_current_load(ModbusCommand& data) {
+            data.tx_length = 6;
+            data.rx_length = 6;
+
+            data.msg[1] = 0x04;
+            data.msg[2] = 0x03;
+            data.msg[3] = 0x02;  // Output current
+            data.msg[4] = 0x00;
+            data.msg[5] = 0x00;
+
+            return [](const uint8_t* response, VFDSpindle* vfd, VFDProtocol* detail) -> bool {
+                // 01 04 03 02 [current 16, 0.1 A] [crc16]
+                vfd->set_output_current((response[4] << 8) | response[5]);
+                return true;
+            };
+        }
+
         // Configuration registration
         namespace {
             SpindleFactory::DependentInstanceBuilder<VFDSpindle, HuanyangProtocol> registration("Huanyang");
@@ -0,0 +1,370 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "ModbusBus.h"
+
+#include "../VFDSpindle.h"
+#include "../../MotionControl.h"  // mc_critical
+#include "../../Uart.h"
+#include "../../Machine/Tasks.h"  // Machine::Tasks::get()
+
+#include <algorithm>
+#include <cstring>
+
+namespace Spindles {
+    namespace VFD {
+        const int        RESPONSE_WAIT_MS = 1000;                                   // how long to wait for a response
+        const TickType_t response_ticks   = RESPONSE_WAIT_MS / portTICK_PERIOD_MS;  // in milliseconds between commands
+
+        std::vector<ModbusBus*> ModbusBus::_buses;
+
+        // Spindle init can happen many times, so the buses are never deleted
+        ModbusBus* ModbusBus::get(Uart* uart) {
+            for (auto bus : _buses) {
+                if (bus->_uart == uart) {
+                    return bus;
+                }
+            }
+            auto bus = new ModbusBus(uart);
+            _buses.push_back(bus);
+            return bus;
+        }
+
+        ModbusBus::Device* ModbusBus::find(VFDSpindle* spindle) {
+            int n = _n_devices.load(std::memory_order_acquire);
+            for (int i = 0; i < n; i++) {
+                if (_devices[i].spindle == spindle) {
+                    return &_devices[i];
+                }
+            }
+            return nullptr;
+        }
+
+        void ModbusBus::attach(VFDSpindle* spindle) {
+            if (find(spindle)) {
+                return;
+            }
+            int n = _n_devices.load();
+            if (n == MAX_DEVICES) {
+                log_error(spindle->name() << ": too many devices on one RS485 bus");
+                return;
+            }
+            for (int i = 0; i < n; i++) {
+                if (_devices[i].spindle->_modbus_id == spindle->_modbus_id) {
+                    log_error(spindle->name() << ": modbus_id " << int(spindle->_modbus_id) << " is also used by " << _devices[i].spindle->name());
+                }
+            }
+            if (n) {
+                log_info(spindle->name() << " shares the RS485 bus of " << _devices[0].spindle->name());
+            }
+
+            _devices[n].spindle   = spindle;
+            _devices[n].next_poll = xTaskGetTickCount();
+            _n_devices.store(n + 1, std::memory_order_release);
+
+            if (!_queue) {
+                _queue = xQueueCreate(QUEUE_SIZE, sizeof(Action));
+                Machine::Tasks::get()._modbus.create(bus_task, this, &_task);
+            }
+        }
+
+        void ModbusBus::reset(VFDSpindle* spindle) {
+            if (_n_devices.load() > 1) {
+                return;
+            }
+            if (!xQueueReset(_queue)) {
+                log_info(spindle->name() << " spindle off, queue could not be reset");
+            }
+        }
+
+        ModbusBus::Priority ModbusBus::poll_priority(const Device& dev) {
+            auto spindle = dev.spindle;
+            if (dev.pollidx < 0 || spindle->_syncing) {
+                return Priority::Safety;
+            }
+            bool changing = spindle->_speed_feedback && spindle->_sync_dev_speed != dev.last_speed;
+            if (changing || !spindle->detail_->safety_polling()) {
+                return Priority::Telemetry;
+            }
+            return dev.pollidx == 1 && spindle->_speed_feedback ? Priority::Telemetry : Priority::Safety;
+        }
+
+        // Returns the device whose poll should go next, or nullptr if none is due,
+        // in which case wait is set to the time until the next one is
+        ModbusBus::Device* ModbusBus::due_poll(TickType_t& wait) {
+            TickType_t now           = xTaskGetTickCount();
+            Device*    best          = nullptr;
+            Priority   best_priority = Priority::Telemetry;
+            wait                     = portMAX_DELAY;
+
+            int n = _n_devices.load(std::memory_order_acquire);
+            for (int i = 0; i < n; i++) {
+                Device&    dev   = _devices[i];
+                TickType_t until = dev.next_poll - now;
+                if (int32_t(until) > 0) {
+                    wait = std::min(wait, until);
+                    continue;
+                }
+                Priority priority = poll_priority(dev);
+                if (!best || priority < best_priority || (priority == best_priority && int32_t(dev.next_poll - best->next_poll) < 0)) {
+                    best          = &dev;
+                    best_priority = priority;
+                }
+            }
+            return best;
+        }
+
+        void ModbusBus::bus_task(void* pvParameters) {
+            ModbusBus* bus = static_cast<ModbusBus*>(pvParameters);
+
+            while (true) {
+                std::atomic_thread_fence(std::memory_order::memory_order_seq_cst);  // read fence for settings
+
+                TickType_t wait;
+                Device*    dev = bus->due_poll(wait);
+
+                // Queued commands go first, so the queue is only waited on when no poll is due
+                Action action;
+                if (xQueueReceive(bus->_queue, &action, dev ? 0 : wait)) {
+                    Device* target = bus->find(action.spindle);
+                    if (target) {
+                        bus->command(*target, action);
+                    }
+                } else if (dev) {
+                    bus->poll(*dev);
+                }
+            }
+        }
+
+        // Runs the whole initialization sequence, because commands can depend on
+        // the values that it reads from the VFD
+        void ModbusBus::initialize(Device& dev) {
+            VFDProtocol::ModbusCommand cmd;
+            while (dev.pollidx < 0) {
+                cmd.critical = false;
+                auto parser  = dev.spindle->detail_->initialization_sequence(dev.pollidx, cmd, dev.spindle);
+                if (parser == nullptr) {
+                    dev.pollidx = 1;  // Done with initialization. Main sequence.
+                    return;
+                }
+                if (!transact(dev, cmd, parser, false, 0)) {
+                    return;
+                }
+            }
+        }
+
+        bool ModbusBus::command(Device& dev, const Action& action) {
+            auto spindle = dev.spindle;
+            auto impl    = spindle->detail_;
+
+            // An unresponsive device is not initialized first, because that would
+            // hold up the other devices for every initialization step
+            if (dev.pollidx < 0 && !dev.unresponsive) {
+                initialize(dev);
+            }
+
+            VFDProtocol::ModbusCommand cmd;
+            switch (action.action) {
+                case actionSetSpeed:
+                    if (!impl->prepareSetSpeedCommand(action.arg, cmd, spindle)) {
+                        // prepareSetSpeedCommand() can return false if the speed
+                        // change is unnecessary - already at that speed.
+                        // In that case we just discard the command.
+                        return true;
+                    }
+                    // Follow the ramp from the start
+                    dev.next_poll = xTaskGetTickCount() + FAST_POLL_MS / portTICK_PERIOD_MS;
+                    break;
+                case actionSetMode:
+                    if (!impl->prepareSetModeCommand(SpindleState(action.arg), cmd, spindle)) {
+                        return true;
+                    }
+                    break;
+            }
+            cmd.critical = action.critical;
+            return transact(dev, cmd, nullptr, true, action.queued);
+        }
+
+        void ModbusBus::poll(Device& dev) {
+            auto spindle = dev.spindle;
+            auto impl    = spindle->detail_;
+
+            VFDProtocol::ModbusCommand   cmd;
+            VFDProtocol::response_parser parser = nullptr;
+            cmd.critical                        = false;
+
+            // First check if we should ask the VFD for the speed parameters as part of the initialization.
+            if (dev.pollidx < 0) {
+                if ((parser = impl->initialization_sequence(dev.pollidx, cmd, spindle)) == nullptr) {
+                    dev.pollidx = 1;  // Done with initialization. Main sequence.
+                }
+            }
+
+            bool fast      = spindle->_speed_feedback && (spindle->_syncing || spindle->_sync_dev_speed != dev.last_speed);
+            dev.last_speed = spindle->_sync_dev_speed;
+            dev.next_poll  = xTaskGetTickCount() + (fast ? FAST_POLL_MS : spindle->_poll_ms) / portTICK_PERIOD_MS;
+
+            if (parser == nullptr) {
+                // We poll in a cycle. Note that the switch will fall through unless we encounter a hit.
+                // The weakest form here is 'get_status_ok' which should be implemented if the rest fails.
+                if (fast) {
+                    parser = impl->get_current_speed(cmd);
+                } else if (impl->safety_polling()) {
+                    switch (dev.pollidx) {
+                        case 1:
+                            parser = impl->get_current_speed(cmd);
+                            if (parser) {
+                                dev.pollidx = 2;
+                                break;
+                            }
+                            // fall through if get_current_speed did not return a parser
+                        case 2:
+                            parser = impl->get_current_direction(cmd);
+                            if (parser) {
+                                dev.pollidx = 3;
+                                break;
+                            }
+                            // fall through if get_current_direction did not return a parser
+                        case 3:
+                            parser = impl->get_current_load(cmd);
+                            if (parser) {
+                                dev.pollidx = 4;
+                                break;
+                            }
+                            // fall through if get_current_load did not return a parser
+                        case 4:
+                        default:
+                            parser      = impl->get_status_ok(cmd);
+                            dev.pollidx = 1;
+
+                            // we could complete this in case parser == nullptr with some ifs, but let's
+                            // just keep it easy and wait an iteration.
+                            break;
+                    }
+                } else {
+                    parser = impl->get_current_load(cmd);  // Telemetry only
+                }
+
+                // If we have no parser, that means get_status_ok is not implemented
+                if (parser == nullptr) {
+                    return;
+                }
+            }
+            transact(dev, cmd, parser, false, 0);
+        }
+
+        // Sends cmd and checks the response, retrying up to the device's retry
+        // count.  Returns true if a valid response was received and parsed.
+        bool ModbusBus::transact(
+            Device& dev, VFDProtocol::ModbusCommand& cmd, VFDProtocol::response_parser parser, bool command, TickType_t queued) {
+            auto    instance = dev.spindle;
+            auto    impl     = instance->detail_;
+            auto&   uart     = *_uart;
+            uint8_t rx_message[VFDProtocol::VFD_RS485_MAX_MSG_SIZE];
+
+            // Fill in the fields that are the same for all protocol variants
+            cmd.msg[0] = instance->_modbus_id;
+
+            // Grabbed the command. Add the CRC16 checksum:
+            auto crc16               = VFDProtocol::ModRTU_CRC(cmd.msg, cmd.tx_length);
+            cmd.msg[cmd.tx_length++] = (crc16 & 0xFF);
+            cmd.msg[cmd.tx_length++] = (crc16 & 0xFF00) >> 8;
+            cmd.rx_length += 2;
+
+            if (instance->_debug > 2) {
+                hex_msg(cmd.msg, "RS485 Tx: ", cmd.tx_length);
+            }
+
+            // Assume for the worst, and retry...
+            for (uint32_t retry_count = 0; retry_count < instance->_retries; ++retry_count) {
+                // Flush the UART and write the data:
+                uart.flush();
+                TickType_t sent = xTaskGetTickCount();
+                uart.write(cmd.msg, cmd.tx_length);
+                uart.flushTxTimed(response_ticks);
+
+                // Read the response
+                size_t read_length  = 0;
+                size_t current_read = uart.timedReadBytes(rx_message, cmd.rx_length, response_ticks);
+                read_length += current_read;
+
+                // Apparently some Huanyang report modbus errors in the correct way, and the rest not. Sigh.
+                // Let's just check for the condition, and truncate the first byte.
+                if (read_length > 0 && instance->_modbus_id != 0 && rx_message[0] == 0) {
+                    log_debug("Huanyang workaround");
+                    memmove(rx_message + 1, rx_message, read_length - 1);
+                }
+
+                while (read_length < cmd.rx_length && current_read > 0) {
+                    // Try to read more; we're not there yet...
+                    current_read = uart.timedReadBytes(rx_message + read_length, cmd.rx_length - read_length, response_ticks);
+                    read_length += current_read;
+                }
+
+                // Generate crc16 for the response:
+                auto crc16response = VFDProtocol::ModRTU_CRC(rx_message, cmd.rx_length - 2);
+
+                if (read_length == cmd.rx_length &&                                  // check expected length
+                    rx_message[0] == instance->_modbus_id &&                         // check address
+                    rx_message[read_length - 1] == (crc16response & 0xFF00) >> 8 &&  // check CRC byte 1
+                    rx_message[read_length - 2] == (crc16response & 0xFF)) {         // check CRC byte 1
+
+                    // Success
+                    instance->_stats.response(sent);
+                    if (command) {
+                        instance->_stats.command(queued);
+                    }
+                    dev.unresponsive = false;
+                    if (instance->_debug > 2) {
+                        hex_msg(rx_message, "RS485 Rx: ", read_length);
+                    }
+                    // Should we parse this?
+                    if (parser != nullptr) {
+                        if (!parser(rx_message, instance, impl)) {
+                            // Parsing failed
+                            if (instance->_debug) {
+                                VFDProtocol::reportParsingErrors(cmd, rx_message, read_length);
+                            }
+
+                            // If we were initializing, move back to where we started.
+                            dev.unresponsive = true;
+                            dev.pollidx      = -1;  // Re-initializing the VFD seems like a plan
+                            log_info(instance->name() << " RS485 did not give a satisfying response");
+                            return false;
+                        }
+                        // If we're initializing, move to the next initialization command:
+                        if (dev.pollidx < 0) {
+                            --dev.pollidx;
+                        }
+                    }
+                    return true;
+                }
+
+                if (instance->_debug) {
+                    VFDProtocol::reportCmdErrors(cmd, rx_message, read_length, instance->_modbus_id);
+                }
+                ++instance->_stats.timeouts;
+
+                // Wait a bit before we retry.
+                delay_ms(instance->_poll_ms);
+
+#ifdef DEBUG_TASK_STACK
+                static UBaseType_t uxHighWaterMark = 0;
+                reportTaskStackSize(uxHighWaterMark);
+#endif
+            }
+
+            ++instance->_stats.failures;
+            if (!dev.unresponsive) {
+                log_info(instance->name() << " RS485 Unresponsive");
+                dev.unresponsive = true;
+                dev.pollidx      = -1;
+            }
+            if (cmd.critical) {
+                mc_critical(ExecAlarm::SpindleControl);
+                log_error("Critical VFD RS485 Unresponsive");
+            }
+            return false;
+        }
+    }
+}
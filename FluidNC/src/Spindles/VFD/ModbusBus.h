@@ -0,0 +1,96 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include "VFDProtocol.h"  // ModbusCommand, response_parser
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <atomic>
+#include <vector>
+
+class Uart;
+
+namespace Spindles {
+    class VFDSpindle;
+
+    namespace VFD {
+        // One RS485 line with one or more Modbus devices on it.  VFD spindles
+        // that use the same UART share the bus, and a single task arbitrates
+        // the transactions among them:
+        //   1. queued speed and mode commands, in the order they were queued
+        //   2. safety polls - initialization, direction and status checks,
+        //      and speed polls while setState() is waiting for the speed
+        //   3. telemetry - the other speed polls
+        // Within a class, the device whose poll has been due the longest goes
+        // first.  A command therefore waits for at most the transaction that
+        // is already on the wire.
+        class ModbusBus {
+        public:
+            enum ActionType : uint8_t { actionSetSpeed, actionSetMode };
+
+            struct Action {
+                VFDSpindle* spindle;
+                ActionType  action;
+                bool        critical;
+                uint32_t    arg;
+                TickType_t  queued;  // For the command latency statistics
+            };
+
+            // Finds or creates the bus for a UART
+            static ModbusBus* get(Uart* uart);
+
+            // Adds a device to the bus, starting the bus task with the first one.
+            // A device that is already attached is not added again.
+            void attach(VFDSpindle* spindle);
+
+            bool send(const Action& action) { return xQueueSend(_queue, &action, 0) == pdTRUE; }
+            void sendFromISR(const Action& action) { xQueueSendFromISR(_queue, &action, 0); }
+
+            // Discards the queued commands when a spindle is turned off, unless
+            // other devices share the bus, in which case they might be theirs
+            void reset(VFDSpindle* spindle);
+
+        private:
+            static const int MAX_DEVICES = 8;
+            static const int QUEUE_SIZE  = 10;
+
+            // While the speed is changing it is polled every FAST_POLL_MS, so that spindle
+            // sync and the at-speed check see it promptly.  Once it stops changing, the
+            // device is polled every poll_ms.
+            static const uint32_t FAST_POLL_MS = 50;
+
+            enum class Priority : uint8_t { Safety, Telemetry };
+
+            struct Device {
+                VFDSpindle* spindle      = nullptr;
+                int         pollidx      = -1;     // < 0 while initializing
+                bool        unresponsive = false;  // to pop off a message once each time it becomes unresponsive
+                TickType_t  next_poll    = 0;
+                uint32_t    last_speed   = UINT32_MAX;  // _sync_dev_speed at the previous poll
+            };
+
+            static std::vector<ModbusBus*> _buses;
+
+            Uart*            _uart;
+            QueueHandle_t    _queue = nullptr;
+            TaskHandle_t     _task  = nullptr;
+            Device           _devices[MAX_DEVICES];
+            std::atomic<int> _n_devices { 0 };  // Devices are only added, so the task can read the array without a lock
+
+            ModbusBus(Uart* uart) : _uart(uart) {}
+
+            static void bus_task(void* pvParameters);
+
+            Device*  find(VFDSpindle* spindle);
+            Priority poll_priority(const Device& dev);
+            Device*  due_poll(TickType_t& wait);
+            void     initialize(Device& dev);
+            void     poll(Device& dev);
+            bool     command(Device& dev, const Action& action);
+            bool     transact(Device& dev, VFDProtocol::ModbusCommand& cmd, VFDProtocol::response_parser parser, bool command, TickType_t queued);
+        };
+    }
+}
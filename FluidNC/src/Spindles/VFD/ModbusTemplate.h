@@ -0,0 +1,212 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include "src/string_util.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+// Compiled form of a ModbusVFD command string such as
+//   "06 20 01 rpm*10/60 > echo"
+// The part before '>' is the request: hex bytes and at most one rpm
+// placeholder.  The part after is the expected response: hex bytes that
+// must match, rpm / minrpm / maxrpm / ignore fields of two bytes each, or
+// "echo" for a response that repeats the request.  Each field can have a
+// scale suffix - %, *N, /D or *N/D - where % scales by 100 / max RPM.
+//
+// Strings are compiled once when the configuration is parsed, so building a
+// request is a copy of the bytes plus the scaled speed, and checking a
+// response does not parse text.
+namespace ModbusTemplate {
+    static const int MAX_MSG_SIZE = 16;  // Same as VFDProtocol::VFD_RS485_MAX_MSG_SIZE
+    static const int MAX_DATA     = MAX_MSG_SIZE - 3;  // Room for the address and the CRC
+
+    struct Scale {
+        bool     percent     = false;
+        uint32_t numerator   = 1;
+        uint32_t denominator = 1;
+
+        uint32_t apply(uint32_t n, uint32_t maxRPM) const {
+            uint32_t divider = denominator;
+            if (percent) {
+                n *= 100;
+                divider *= maxRPM;
+            }
+            n *= numerator;
+            return n / divider;
+        }
+    };
+
+    struct Field {
+        enum Kind : uint8_t { Byte, Rpm, MinRpm, MaxRpm, Ignore } kind = Byte;
+        uint8_t value = 0;  // For Byte
+        Scale   scale;
+    };
+
+    // The values that a response carried
+    struct Values {
+        bool     has_rpm     = false;
+        bool     has_min_rpm = false;
+        bool     has_max_rpm = false;
+        uint32_t rpm         = 0;
+        uint32_t min_rpm     = 0;
+        uint32_t max_rpm     = 0;
+    };
+
+    struct Command {
+        bool               empty      = true;
+        uint8_t            tx_length  = 1;  // msg[0] is the Modbus address, filled in when sending
+        uint8_t            rx_length  = 1;
+        int8_t             rpm_offset = -1;
+        Scale              rpm_scale;
+        uint8_t            msg[MAX_MSG_SIZE] = { 0 };
+        std::vector<Field> response;
+
+        // Fills in a request; returns its length without the CRC
+        uint8_t build(uint8_t* out, uint32_t rpm, uint32_t maxRPM) const {
+            memcpy(out, msg, tx_length);
+            if (rpm_offset >= 0) {
+                uint32_t value      = rpm_scale.apply(rpm, maxRPM);
+                out[rpm_offset]     = value >> 8;
+                out[rpm_offset + 1] = value & 0xff;
+            }
+            return tx_length;
+        }
+
+        // Checks a response, starting after its address byte, and collects its values
+        bool match(const uint8_t* response_data, Values& values) const {
+            for (auto& field : response) {
+                uint32_t word = (uint32_t(response_data[0]) << 8) + response_data[1];
+                switch (field.kind) {
+                    case Field::Byte:
+                        if (*response_data != field.value) {
+                            return false;
+                        }
+                        ++response_data;
+                        continue;
+                    case Field::Rpm:
+                        values.has_rpm = true;
+                        values.rpm     = field.scale.apply(word, 1);
+                        break;
+                    case Field::MinRpm:
+                        values.has_min_rpm = true;
+                        values.min_rpm     = field.scale.apply(word, 1);
+                        break;
+                    case Field::MaxRpm:
+                        values.has_max_rpm = true;
+                        values.max_rpm     = field.scale.apply(word, 1);
+                        break;
+                    case Field::Ignore:
+                        break;
+                }
+                response_data += 2;
+            }
+            return true;
+        }
+    };
+
+    inline bool compile_scale(std::string_view str, Scale& scale) {
+        scale = Scale();
+        if (!str.empty() && str[0] == '%') {
+            scale.percent = true;
+            str.remove_prefix(1);
+        }
+        if (str.empty()) {
+            return true;
+        }
+        if (str[0] == '*') {
+            std::string_view numerator;
+            str.remove_prefix(1);
+            string_util::split_prefix(str, numerator, '/');
+            if (!string_util::from_decimal(numerator, scale.numerator)) {
+                return false;
+            }
+            return str.empty() || string_util::from_decimal(str, scale.denominator);
+        }
+        if (str[0] == '/') {
+            return string_util::from_decimal(str.substr(1), scale.denominator);
+        }
+        return false;
+    }
+
+    // Returns false, with the offending token in bad, if str is malformed
+    inline bool compile(std::string_view str, Command& cmd, std::string_view& bad) {
+        cmd = Command();
+        if (str.empty()) {
+            return true;
+        }
+        cmd.empty = false;
+
+        std::string_view request;
+        std::string_view token;
+        string_util::split_prefix(str, request, '>');
+
+        while (string_util::split_prefix(request, token, ' ')) {
+            if (token.empty()) {
+                continue;  // Ignore repeated blanks
+            }
+            if (string_util::starts_with_ignore_case(token, "rpm")) {
+                if (cmd.rpm_offset >= 0 || cmd.tx_length + 2 > MAX_DATA || !compile_scale(token.substr(3), cmd.rpm_scale)) {
+                    bad = token;
+                    return false;
+                }
+                cmd.rpm_offset = cmd.tx_length;
+                cmd.tx_length += 2;
+            } else if (cmd.tx_length >= MAX_DATA || !string_util::from_hex(token, cmd.msg[cmd.tx_length])) {
+                bad = token;
+                return false;
+            } else {
+                ++cmd.tx_length;
+            }
+        }
+
+        static const struct {
+            const char* name;
+            Field::Kind kind;
+        } words[] = {
+            { "rpm", Field::Rpm }, { "minrpm", Field::MinRpm }, { "maxrpm", Field::MaxRpm }, { "ignore", Field::Ignore }
+        };
+        while (string_util::split_prefix(str, token, ' ')) {
+            if (token.empty()) {
+                continue;  // Ignore repeated blanks
+            }
+            if (string_util::equal_ignore_case(token, "echo")) {
+                cmd.rx_length = cmd.tx_length;
+                cmd.response.clear();
+                return true;
+            }
+            Field field;
+            bool  named = false;
+            for (auto& word : words) {
+                if (string_util::starts_with_ignore_case(token, word.name)) {
+                    field.kind = word.kind;
+                    if (!compile_scale(token.substr(strlen(word.name)), field.scale)) {
+                        bad = token;
+                        return false;
+                    }
+                    named = true;
+                    break;
+                }
+            }
+            if (!named) {
+                field.kind = Field::Byte;
+                if (!string_util::from_hex(token, field.value)) {
+                    bad = token;
+                    return false;
+                }
+            }
+            int length = field.kind == Field::Byte ? 1 : 2;
+            if (cmd.rx_length + length > MAX_DATA) {
+                bad = token;
+                return false;
+            }
+            cmd.rx_length += length;
+            cmd.response.push_back(field);
+        }
+        return true;
+    }
+}
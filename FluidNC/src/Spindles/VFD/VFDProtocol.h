@@ -7,6 +7,8 @@ namespace Spindles {
     class VFDSpindle;
 
     namespace VFD {
+        class ModbusBus;
+
         // VFDProtocol resides in a separate class because it doesn't need to be in IRAM. This contains all the
         // VFD specific code, which is called from a separate task.
         class VFDProtocol {
@@ -38,33 +40,14 @@ namespace Spindles {
             virtual response_parser initialization_sequence(int index, ModbusCommand& data, VFDSpindle* vfd) { return nullptr; }
             virtual response_parser get_current_speed(ModbusCommand& data) { return nullptr; }
             virtual response_parser get_current_direction(ModbusCommand& data) { return nullptr; }
+            virtual response_parser get_current_load(ModbusCommand& data) { return nullptr; }  // Output current
             virtual response_parser get_status_ok(ModbusCommand& data) = 0;
             virtual bool            safety_polling() const { return true; }
 
         private:
             friend class Spindles::VFDSpindle;  // For ISR related things.
+            friend class ModbusBus;             // Runs the transactions
 
-            enum VFDactionType : uint8_t { actionSetSpeed, actionSetMode };
-
-            struct VFDaction {
-                VFDactionType action;
-                bool          critical;
-                uint32_t      arg;
-            };
-
-            // Careful observers will notice that these *shouldn't* be static, but they are. The reason is
-            // hard to track down. In the spindle class, you can find:
-            //
-            // 'virtual void init() = 0;  // not in constructor because this also gets called when $$ settings change'
-            //
-            // With init being called multiple times, static suddenly makes more sense - especially since there is
-            // no de-init. Oh well...
-
-            static QueueHandle_t vfd_cmd_queue;
-            static TaskHandle_t  vfd_cmdTaskHandle;
-            static void          vfd_cmd_task(void* pvParameters);
-
-            static uint16_t ModRTU_CRC(uint8_t* buf, int msg_len);
             bool            prepareSetModeCommand(SpindleState mode, ModbusCommand& data, VFDSpindle* spindle);
             bool            prepareSetSpeedCommand(uint32_t speed, ModbusCommand& data, VFDSpindle* spindle);
 
@@ -72,6 +55,9 @@ namespace Spindles {
             static void reportCmdErrors(ModbusCommand cmd, uint8_t* rx_message, size_t read_length, uint8_t id);
 
         public:
+            // The CRC of a Modbus RTU message, which is sent low byte first
+            static uint16_t ModRTU_CRC(uint8_t* buf, int msg_len);
+
             VFDProtocol() {}
             VFDProtocol(const VFDProtocol&)            = delete;
             VFDProtocol(VFDProtocol&&)                 = delete;
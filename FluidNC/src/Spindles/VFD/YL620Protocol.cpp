@@ -205,6 +205,24 @@ namespace Spindles {
             };
         }
 
+        VFDProtocol::response_parser YL620Protocol::get_current_load(ModbusCommand& data) {
+            data.tx_length = 6;
+            data.rx_length = 5;
+
+            // Send: 01 03 200C 0001
+            data.msg[1] = 0x03;
+            data.msg[2] = 0x20;
+            data.msg[3] = 0x0C;  // Output current
+            data.msg[4] = 0x00;
+            data.msg[5] = 0x01;
+
+            //  Recv: 01 03 02 [current 16, 0.1 A] xx xx
+            return [](const uint8_t* response, VFDSpindle* vfd, VFDProtocol* detail) -> bool {
+                vfd->set_output_current((uint16_t(response[3]) << 8) | uint16_t(response[4]));
+                return true;
+            };
+        }
+
         VFDProtocol::response_parser YL620Protocol::get_current_direction(ModbusCommand& data) {
             data.tx_length = 6;
             data.rx_length = 5;
@@ -20,6 +20,7 @@
 */
 #include "VFDSpindle.h"
 #include "VFD/VFDProtocol.h"
+#include "VFD/ModbusBus.h"
 
 #include "../Machine/MachineConfig.h"
 #include "../Protocol.h"  // rtAlarm
@@ -30,11 +31,9 @@
 #include <freertos/task.h>
 #include <freertos/queue.h>
 #include <atomic>
+#include <algorithm>
 
 namespace Spindles {
-    // number of commands that can be queued up.
-    const int VFD_RS485_QUEUE_SIZE = 10;
-
     // ================== Class methods ==================================
 
     void VFDSpindle::init() {
@@ -65,18 +64,14 @@ namespace Spindles {
 
         _current_state = SpindleState::Disable;
 
-        // Initialization is complete, so now it's okay to run the queue task:
-        if (!VFD::VFDProtocol::vfd_cmd_queue) {  // init can happen many times, we only want to start one task
-            VFD::VFDProtocol::vfd_cmd_queue = xQueueCreate(VFD_RS485_QUEUE_SIZE, sizeof(VFD::VFDProtocol::VFDaction));
-            xTaskCreatePinnedToCore(VFD::VFDProtocol::vfd_cmd_task,  // task
-                                    "vfd_cmdTaskHandle",             // name for task
-                                    2048,                            // size of task stack
-                                    this,                            // parameters
-                                    1,                               // priority
-                                    &VFD::VFDProtocol::vfd_cmdTaskHandle,
-                                    SUPPORT_TASK_CORE  // core
-            );
-        }
+        VFD::VFDProtocol::ModbusCommand probe;
+        _speed_feedback = detail_->get_current_speed(probe) != nullptr;
+
+        // Initialization is complete, so now it's okay to run the bus task.
+        // VFDs that use the same UART share one bus and one task; attach()
+        // ignores repeated calls, since init can happen many times.
+        _bus = VFD::ModbusBus::get(_uart);
+        _bus->attach(this);
 
         init_atc();
         config_message();
@@ -92,19 +87,21 @@ namespace Spindles {
 
     void VFDSpindle::set_mode(SpindleState mode, bool critical) {
         _last_override_value = sys.spindle_speed_ovr;  // sync these on mode changes
-        if (VFD::VFDProtocol::vfd_cmd_queue) {
-            VFD::VFDProtocol::VFDaction action;
-            action.action   = VFD::VFDProtocol::actionSetMode;
+        if (_bus) {
+            VFD::ModbusBus::Action action;
+            action.spindle  = this;
+            action.action   = VFD::ModbusBus::actionSetMode;
             action.arg      = uint32_t(mode);
             action.critical = critical;
-            if (xQueueSend(VFD::VFDProtocol::vfd_cmd_queue, &action, 0) != pdTRUE) {
+            action.queued   = xTaskGetTickCount();
+            if (!_bus->send(action)) {
                 log_info("VFD Queue Full");
             }
         }
     }
 
     void VFDSpindle::setState(SpindleState state, SpindleSpeed speed) {
-        log_debug(name() << ": setState:" << uint8_t(state) << " SpindleSpeed:" << speed);
+        log_debug_deferred("{}: setState:{} SpindleSpeed:{}", name(), int(state), speed);
         if (sys.abort) {
             return;  // Block during abort.
         }
@@ -126,7 +123,12 @@ namespace Spindles {
             }
         }
         if (detail_->use_delay_settings()) {
+            // With speed feedback, the delay is cut short when the VFD reports
+            // the speed, so it is polled for the speed while waiting.
+            _target_dev_speed = state == SpindleState::Disable ? 0 : dev_speed;
+            _syncing          = _speed_feedback;
             spindleDelay(state, speed);
+            _syncing = false;
         } else {
             // _sync_dev_speed is set by a callback that handles
             // responses from periodic get_current_speed() requests.
@@ -137,34 +139,34 @@ namespace Spindles {
             auto minSpeedAllowed = dev_speed > _slop ? (dev_speed - _slop) : 0;
             auto maxSpeedAllowed = dev_speed + _slop;
 
-            int       unchanged = 0;
-            const int limit     = 20;  // 20 * 0.5s = 10 sec
-            auto      last      = _sync_dev_speed;
+            // The protocol task polls quickly while syncing, so the speed is
+            // checked often and the wait ends within one poll of reaching it.
+            // It fails if the speed stays the same for as long as 20 slow polls.
+            const TickType_t limit       = 20 * _poll_ms / portTICK_PERIOD_MS;
+            TickType_t       last_change = xTaskGetTickCount();
+            bool             stalled     = false;
+            auto             last        = _sync_dev_speed;
 
             while ((_last_override_value == sys.spindle_speed_ovr) &&  // skip if the override changes
-                   ((_sync_dev_speed < minSpeedAllowed || _sync_dev_speed > maxSpeedAllowed) && unchanged < limit)) {
-                delay_ms(_poll_ms);
-                if (_debug > 1) {
-                    log_debug("Syncing speed. Requested: " << int(dev_speed) << " current:" << int(_sync_dev_speed));
+                   ((_sync_dev_speed < minSpeedAllowed || _sync_dev_speed > maxSpeedAllowed) && !stalled)) {
+                delay_ms(SYNC_CHECK_MS);
+                if (_sync_dev_speed != last) {
+                    if (_debug > 1) {
+                        log_debug_deferred("Syncing speed. Requested: {} current:{}", int(dev_speed), int(_sync_dev_speed));
+                    }
+                    last        = _sync_dev_speed;
+                    last_change = xTaskGetTickCount();
+                } else {
+                    stalled = (xTaskGetTickCount() - last_change) >= limit;
                 }
-                // if (!mc_dwell(500)) {
-                //     // Something happened while we were dwelling, like a safety door.
-                //     unchanged = limit;
-                //     last      = _sync_dev_speed;
-                //     break;
-                // }
-
-                // unchanged counts the number of consecutive times that we see the same speed
-                unchanged = (_sync_dev_speed == last) ? unchanged + 1 : 0;
-                last      = _sync_dev_speed;
             }
             _last_override_value = sys.spindle_speed_ovr;
 
             if (_debug > 1) {
-                log_debug("Synced speed. Requested:" << int(dev_speed) << " current:" << int(_sync_dev_speed));
+                log_debug_deferred("Synced speed. Requested:{} current:{}", int(dev_speed), int(_sync_dev_speed));
             }
 
-            if (unchanged == limit) {
+            if (stalled) {
                 mc_critical(ExecAlarm::SpindleControl);
                 log_error(name() << ": spindle did not reach device units " << dev_speed << ". Reported value is " << _sync_dev_speed);
             }
@@ -177,6 +179,81 @@ namespace Spindles {
         //        }
     }
 
+    // _sync_dev_speed is UINT32_MAX from a speed change until the VFD has been asked
+    // for its speed again, so a report from before the change cannot end the wait.
+    bool VFDSpindle::atSpeed() {
+        uint32_t reported = _sync_dev_speed;
+        if (reported == UINT32_MAX) {
+            return false;
+        }
+        return reported + _slop >= _target_dev_speed && reported <= _target_dev_speed + _slop;
+    }
+
+    void VFDSpindle::Stats::response(TickType_t sent) {
+        uint32_t ms = (xTaskGetTickCount() - sent) * portTICK_PERIOD_MS;
+        ++transactions;
+        rtt_total_ms += ms;
+        rtt_max_ms = std::max(rtt_max_ms, ms);
+    }
+
+    void VFDSpindle::Stats::command(TickType_t queued) {
+        uint32_t ms = (xTaskGetTickCount() - queued) * portTICK_PERIOD_MS;
+        ++commands;
+        latency_total += ms;
+        latency_max = std::max(latency_max, ms);
+    }
+
+    void VFDSpindle::print_stats(Channel& out, bool reset) {
+        Stats s = _stats;
+        if (reset) {
+            _stats = Stats();
+        }
+        log_stream(out,
+                   "[" << name() << " transactions:" << s.transactions << " timeouts:" << s.timeouts << " failures:" << s.failures
+                       << " rtt_avg:" << (s.transactions ? s.rtt_total_ms / s.transactions : 0) << "ms rtt_max:" << s.rtt_max_ms
+                       << "ms commands:" << s.commands << " latency_avg:" << (s.commands ? s.latency_total / s.commands : 0)
+                       << "ms latency_max:" << s.latency_max << "ms]");
+        if (_has_current) {
+            log_stream(out, "[" << name() << " current:" << _output_current / 10 << '.' << _output_current % 10 << "A load:" << load_percent()
+                                << "% feed:" << int(_adaptive_feed) << "%]");
+        }
+    }
+
+    int VFDSpindle::load_percent() {
+        if (!_has_current || _rated_current <= 0.0f) {
+            return -1;
+        }
+        return int(_output_current * 10.0f / _rated_current + 0.5f);
+    }
+
+    void VFDSpindle::set_output_current(uint32_t deciamps) {
+        _output_current = deciamps;
+        _has_current    = true;
+        if (_load_limit_percent) {
+            adapt_feed();
+        }
+    }
+
+    // The load follows the feed, so the feed that puts the load at the limit is the present
+    // feed scaled by limit / load.  The feed moves half way there at each poll, so that one
+    // noisy reading does not jerk it, and recovers the same way once the load drops.
+    void VFDSpindle::adapt_feed() {
+        int target = 100;
+        int load   = load_percent();
+        if (load > 0 && state_is(State::Cycle) && get_state() != SpindleState::Disable) {
+            target = _adaptive_feed * _load_limit_percent / load;
+            target = myConstrain(target, _min_feed_percent, 100);
+        }
+        int step = (target - int(_adaptive_feed)) / 2;
+        if (step == 0) {
+            step = target - int(_adaptive_feed);
+        }
+        if (step) {
+            _adaptive_feed += step;
+            protocol_send_event(&adaptiveFeedEvent, int(_adaptive_feed));
+        }
+    }
+
     void IRAM_ATTR VFDSpindle::setSpeedfromISR(uint32_t dev_speed) {
         if (_current_dev_speed == dev_speed || _last_speed == dev_speed) {
             return;
@@ -184,24 +261,28 @@ namespace Spindles {
 
         _last_speed = dev_speed;
 
-        if (VFD::VFDProtocol::vfd_cmd_queue) {
-            VFD::VFDProtocol::VFDaction action;
-            action.action   = VFD::VFDProtocol::actionSetSpeed;
+        if (_bus) {
+            VFD::ModbusBus::Action action;
+            action.spindle  = this;
+            action.action   = VFD::ModbusBus::actionSetSpeed;
             action.arg      = dev_speed;
             action.critical = (dev_speed == 0);
+            action.queued   = xTaskGetTickCountFromISR();
             // Ignore errors because reporting is not safe from an ISR.
             // Perhaps set a flag instead?
-            xQueueSendFromISR(VFD::VFDProtocol::vfd_cmd_queue, &action, 0);
+            _bus->sendFromISR(action);
         }
     }
 
     void VFDSpindle::setSpeed(uint32_t dev_speed) {
-        if (VFD::VFDProtocol::vfd_cmd_queue) {
-            VFD::VFDProtocol::VFDaction action;
-            action.action   = VFD::VFDProtocol::actionSetSpeed;
+        if (_bus) {
+            VFD::ModbusBus::Action action;
+            action.spindle  = this;
+            action.action   = VFD::ModbusBus::actionSetSpeed;
             action.arg      = dev_speed;
             action.critical = dev_speed == 0;
-            if (xQueueSend(VFD::VFDProtocol::vfd_cmd_queue, &action, 0) != pdTRUE) {
+            action.queued   = xTaskGetTickCount();
+            if (!_bus->send(action)) {
                 log_info("VFD Queue Full");
             }
         }
@@ -231,6 +312,9 @@ namespace Spindles {
         handler.item("debug", _debug, 0, 5);
         handler.item("poll_ms", _poll_ms, 250, 20000);
         handler.item("retries", _retries);
+        handler.item("rated_current_a", _rated_current, 0.0f, 500.0f);
+        handler.item("load_limit_percent", _load_limit_percent, 0, 200);
+        handler.item("min_feed_percent", _min_feed_percent, 10, 100);
 
         Spindle::group(handler);
         detail_->group(handler);
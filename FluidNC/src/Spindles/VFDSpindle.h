@@ -15,14 +15,17 @@ namespace Spindles {
         // VFDProtocol resides in a separate class because it doesn't need to be in IRAM. This contains all the
         // VFD specific code, which is called from a separate task.
         class VFDProtocol;
+        class ModbusBus;
     }
 
     // VFD base class. Called by the stepper engine. Normally you don't want to touch this.
     class VFDSpindle : public Spindle {
     private:
         friend class Spindles::VFD::VFDProtocol;
+        friend class Spindles::VFD::ModbusBus;
 
         VFD::VFDProtocol* detail_ = nullptr;
+        VFD::ModbusBus*   _bus    = nullptr;  // Shared by the VFDs on the same UART
 
         int32_t  _current_dev_speed   = -1;
         uint32_t _last_speed          = 0;
@@ -43,6 +46,46 @@ namespace Spindles {
 
         volatile bool _syncing;
 
+        static const uint32_t SYNC_CHECK_MS = 10;  // How often setState() checks the synced speed
+
+        // Each override update is a Modbus command, so updates are spaced out
+        // to leave the bus time for the status and speed polls
+        static const uint32_t VFD_OVERRIDE_INTERVAL_MS = 200;
+
+        // Updated by the protocol task.  A timeout is an attempt that got no
+        // valid response; a failure is a transaction that ran out of retries.
+        // Latency is from queueing a command to the VFD acknowledging it.
+        struct Stats {
+            uint32_t transactions  = 0;
+            uint32_t timeouts      = 0;
+            uint32_t failures      = 0;
+            uint32_t rtt_total_ms  = 0;
+            uint32_t rtt_max_ms    = 0;
+            uint32_t commands      = 0;
+            uint32_t latency_total = 0;  // ms
+            uint32_t latency_max   = 0;  // ms
+
+            void response(TickType_t sent);
+            void command(TickType_t queued);
+        } _stats;
+
+        // The protocol can report the speed, so the spinup/spindown delays end
+        // when the reported speed is within _slop of _target_dev_speed
+        bool     _speed_feedback   = false;
+        uint32_t _target_dev_speed = 0;
+
+        // Spindle load, for protocols that read the output current.  With rated_current_a
+        // set, the load is reported in the status, and with load_limit_percent set as well,
+        // the feed is reduced while the load is above the limit, down to min_feed_percent.
+        float             _rated_current      = 0.0f;  // A
+        int               _load_limit_percent = 0;
+        int               _min_feed_percent   = 50;
+        volatile uint32_t _output_current     = 0;  // 0.1 A
+        volatile bool     _has_current        = false;
+        Percent           _adaptive_feed      = 100;
+
+        void adapt_feed();
+
     public:
         VFDSpindle(const char* name, VFD::VFDProtocol* detail) : Spindle(name), detail_(detail) {}
         VFDSpindle(const VFDSpindle&)            = delete;
@@ -55,9 +98,18 @@ namespace Spindles {
         void setState(SpindleState state, SpindleSpeed speed);
         void setSpeedfromISR(uint32_t dev_speed) override;
 
+        bool     hasSpeedFeedback() override { return _speed_feedback; }
+        uint32_t override_interval_ms() override { return VFD_OVERRIDE_INTERVAL_MS; }
+        int      load_percent() override;
+
+        // Called by the protocol parsers with the output current in 0.1 A
+        void set_output_current(uint32_t deciamps);
+        bool atSpeed() override;
+        void print_stats(Channel& out, bool reset) override;
+
         // volatile uint32_t _sync_dev_speed;
         uint32_t     _sync_dev_speed;
-        SpindleSpeed _slop;
+        SpindleSpeed _slop = 0;
 
         // Configuration handlers:
         void validate() override;
@@ -16,6 +16,10 @@ public:
 
     static void init();
     static void dump(Channel& channel);
+
+    // Ends a stage of startup that began at the previous stage() call, or at init(),
+    // recording its time and the heap that it consumed for dump().  name must be static.
+    static void stage(const char* name);
 };
 
 extern StartupLog startupLog;
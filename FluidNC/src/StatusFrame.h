@@ -0,0 +1,128 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  StatusFrame.h - compact binary form of the realtime status report
+
+  Clients that display the machine state many times a second can subscribe to status
+  frames ($RF=<ms>) instead of polling and parsing the text report.  A frame holds the
+  same information as a text report in fixed binary fields, all little-endian:
+
+    offset  size  field
+         0     1  magic, 0xFE, which cannot begin a UTF-8 text line
+         1     1  version, 1
+         2     1  state, the State enum value
+         3     1  number of axes, N
+         4     1  flags: bit 0 set if positions are work positions, clear if machine positions
+         5     1  free planner blocks
+         6     2  free receive buffer bytes, as in |Bf:
+         8     4  feed rate in mm/min
+        12     4  spindle speed
+        16     1  feed override percent
+        17     1  rapid override percent
+        18     1  spindle override percent
+        19     1  accessories: bit 0 spindle CW, bit 1 spindle CCW, bit 2 flood, bit 3 mist
+        20     4  active pins, one bit per letter of pin_letters, as in |Pn:
+        24     4  line number, or 0
+        28    4N  positions in micrometers, signed
+
+  It is header-only so that it can be tested on the host.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace StatusFrame {
+    const uint8_t magic    = 0xFE;
+    const uint8_t version  = 1;
+    const size_t  max_axes = 9;
+    const size_t  max_size = 28 + 4 * max_axes;
+
+    // Bit n of the pins field is set when pin_letters[n] appears in the |Pn: report
+    const char pin_letters[] = "PTXYZABCUVWDRHS0123FEO";
+
+    const uint8_t WorkPosition = 1 << 0;
+
+    const uint8_t SpindleCw  = 1 << 0;
+    const uint8_t SpindleCcw = 1 << 1;
+    const uint8_t Flood      = 1 << 2;
+    const uint8_t Mist       = 1 << 3;
+
+    struct Fields {
+        uint8_t  state            = 0;
+        uint8_t  n_axis           = 0;
+        uint8_t  flags            = 0;
+        uint8_t  planner_free     = 0;
+        uint16_t rx_free          = 0;
+        uint32_t feed_rate        = 0;
+        uint32_t spindle_speed    = 0;
+        uint8_t  feed_override    = 100;
+        uint8_t  rapid_override   = 100;
+        uint8_t  spindle_override = 100;
+        uint8_t  accessories      = 0;
+        uint32_t pins             = 0;
+        uint32_t line_number      = 0;
+        float    position[max_axes] {};  // mm
+    };
+
+    inline uint32_t pin_bits(std::string_view pins) {
+        uint32_t bits = 0;
+        for (char c : pins) {
+            if (const char* p = strchr(pin_letters, c); p && c) {
+                bits |= 1u << (p - pin_letters);
+            }
+        }
+        return bits;
+    }
+
+    inline uint32_t pin_bit(char c) {
+        return pin_bits(std::string_view(&c, 1));
+    }
+
+    // The inverse of pin_bits(), in pin_letters order.  out needs sizeof(pin_letters) bytes.
+    inline void pin_string(uint32_t bits, char* out) {
+        for (const char* p = pin_letters; *p; ++p) {
+            if (bits & (1u << (p - pin_letters))) {
+                *out++ = *p;
+            }
+        }
+        *out = '\0';
+    }
+
+    inline uint8_t* put(uint8_t* p, uint32_t value, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            *p++ = uint8_t(value >> (8 * i));
+        }
+        return p;
+    }
+
+    // Writes the frame to out, which must hold max_size bytes, and returns its length
+    inline size_t encode(const Fields& fields, uint8_t* out) {
+        uint8_t* p = out;
+        *p++       = magic;
+        *p++       = version;
+        *p++       = fields.state;
+        size_t n   = fields.n_axis < max_axes ? fields.n_axis : max_axes;
+        *p++       = uint8_t(n);
+        *p++       = fields.flags;
+        *p++       = fields.planner_free;
+        p          = put(p, fields.rx_free, 2);
+        p          = put(p, fields.feed_rate, 4);
+        p          = put(p, fields.spindle_speed, 4);
+        *p++       = fields.feed_override;
+        *p++       = fields.rapid_override;
+        *p++       = fields.spindle_override;
+        *p++       = fields.accessories;
+        p          = put(p, fields.pins, 4);
+        p          = put(p, fields.line_number, 4);
+        for (size_t i = 0; i < n; i++) {
+            float um = fields.position[i] * 1000.0f;
+            p        = put(p, uint32_t(int32_t(um < 0 ? um - 0.5f : um + 0.5f)), 4);
+        }
+        return p - out;
+    }
+}
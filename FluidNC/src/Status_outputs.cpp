@@ -8,6 +8,7 @@
 */
 #include "Status_outputs.h"
 #include "Machine/MachineConfig.h"
+#include "System.h"  // sys
 
 void Status_Outputs::init() {
     if (_Idle_pin.defined()) {
@@ -32,54 +33,29 @@ void Status_Outputs::init() {
     }
 
     log_info("Status outputs"
-             << " Interval:" << _report_interval_ms << " Idle:" << _Idle_pin.name() << " Cycle:" << _Run_pin.name()
-             << " Hold:" << _Hold_pin.name() << " Alarm:" << _Alarm_pin.name()<< "Door:" << _Door_pin.name()) ;
-
-    allChannels.registration(this);
-    setReportInterval(_report_interval_ms);
+             << " Idle:" << _Idle_pin.name() << " Cycle:" << _Run_pin.name() << " Hold:" << _Hold_pin.name()
+             << " Alarm:" << _Alarm_pin.name() << " Door:" << _Door_pin.name());
 }
 
-void Status_Outputs::parse_report() {
-    if (_report.rfind("<", 0) == 0) {
-        parse_status_report();
+// The pins used to be set by parsing the state out of status reports sent to this as a
+// channel every report_interval_ms.  Now the polling loop compares the state that the
+// pins show with sys.state, so a change shows at once and no change costs only the compare.
+void Status_Outputs::poll() {
+    State state      = sys.state;
+    bool  jog_cancel = sys.suspend.bit.jogCancel;  // A hold that cancels a jog reports as Jog
+    if (_shown && state == _state && jog_cancel == _jog_cancel) {
         return;
     }
-}
-
-// This is how the OLED driver receives channel data
-size_t Status_Outputs::write(uint8_t data) {
-    char c = data;
-    if (c == '\r') {
-        return 1;
-    }
-    if (c == '\n') {
-        parse_report();
-        _report = "";
-        return 1;
-    }
-    _report += c;
-    return 1;
-}
-
-Error Status_Outputs::pollLine(char* line) {
-    autoReport();
-    return Error::NoData;
-}
-
-void Status_Outputs::parse_status_report() {
-    if (_report.back() == '>') {
-        _report.pop_back();
-    }
-    // Now the string is a sequence of field|field|field
-    size_t pos     = 0;
-    auto   nextpos = _report.find_first_of("|", pos);
-    _state         = _report.substr(pos + 1, nextpos - pos - 1);
+    _shown      = true;
+    _state      = state;
+    _jog_cancel = jog_cancel;
 
-    _Idle_pin.write(_state == "Idle");
-    _Run_pin.write(_state == "Run");
-    _Hold_pin.write(_state.substr(0, 4) == "Hold");
-    _Alarm_pin.write(_state == "Alarm");
-    _Door_pin.write(_state.substr(0,4) == "Door");
+    // The same states as the names in the status report, see state_name()
+    _Idle_pin.write(state == State::Idle);
+    _Run_pin.write(state == State::Cycle);
+    _Hold_pin.write(state == State::Hold && !jog_cancel);
+    _Alarm_pin.write(state == State::Alarm || state == State::ConfigAlarm || state == State::Critical);
+    _Door_pin.write(state == State::SafetyDoor);
 }
 
 // Configuration registration
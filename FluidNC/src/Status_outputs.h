@@ -2,27 +2,25 @@
 
 #include "src/Config.h"
 #include "src/Module.h"
-#include "src/Channel.h"
+#include "src/Pin.h"
+#include "src/State.h"
 
-class Status_Outputs : public Channel, public ConfigurableModule {
+class Status_Outputs : public ConfigurableModule {
     Pin _Idle_pin;
     Pin _Run_pin;
     Pin _Hold_pin;
     Pin _Alarm_pin;
     Pin _Door_pin;
 
-public:
-private:
-    std::string _report;
-    std::string _state;
-
-    int _report_interval_ms = 500;
+    // The state that the pins show
+    bool  _shown      = false;
+    State _state      = State::Idle;
+    bool  _jog_cancel = false;
 
-    void parse_report();
-    void parse_status_report();
+    int _report_interval_ms = 500;  // No longer used, the pins follow the state as it changes
 
 public:
-    Status_Outputs(const char* name) : Channel(name), ConfigurableModule(name) {}
+    Status_Outputs(const char* name) : ConfigurableModule(name) {}
 
     Status_Outputs(const Status_Outputs&)            = delete;
     Status_Outputs(Status_Outputs&&)                 = delete;
@@ -32,14 +30,7 @@ public:
     virtual ~Status_Outputs() = default;
 
     void init() override;
-
-    size_t write(uint8_t data) override;
-
-    Error pollLine(char* line) override;
-    void  flushRx() override {}
-
-    bool   lineComplete(char*, char) override { return false; }
-    size_t timedReadBytes(char* buffer, size_t length, TickType_t timeout) override { return 0; }
+    void poll() override;
 
     // Configuration handlers:
     void validate() override {}
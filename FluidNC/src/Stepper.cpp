@@ -14,8 +14,20 @@
 #include "Stepping.h"
 #include "StepperPrivate.h"
 #include "Planner.h"
+#include "InputShaper.h"
+#include "SegmentTiming.h"
 #include "Protocol.h"
+#include "Raster.h"
+#include "LineLatency.h"
+#include "PlannerStats.h"
+#include "Limits.h"        // limitsMinPosition(), limitsMaxPosition()
+#include "Motors/Servo.h"  // Servo::segment_boundary()
+#include "Driver/fluidnc_gpio.h"  // gpio_sample_fast()
+#include "Driver/heap.h"          // heap_region_calloc()
 #include <esp_attr.h>  // IRAM_ATTR
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
 #include <cmath>
 
 using namespace Stepper;
@@ -33,9 +45,54 @@ struct st_block_t {
     uint32_t step_event_count;
     uint8_t  direction_bits;
     bool     is_pwm_rate_adjusted;  // Tracks motions that require constant laser power/rate
+    uint8_t  amass_max_level;       // Highest AMASS level any axis of the block needs. Used by prep only.
+    AxisMask backlash_negative;     // Backlash state once the block runs, see Stepping::backlash_negative
+    bool     has_io;                // Apply the block's entry in st_block_io when it starts
+    int32_t  line_number;           // For the segment trace
+    uint8_t  sync_id;               // Nonzero for a spindle-synchronized block, which starts at an index pulse
+    uint32_t raster_start;          // Raster position of the block's scanline
+    uint32_t raster_length;         // Pixels in the scanline, zero for none
+    bool     latency_traced;        // Report the first step to LineLatency
 };
 static volatile st_block_t* st_block_buffer = nullptr;
 
+// Synchronized output changes, parallel to st_block_buffer. Kept apart because few blocks have them.
+static plan_io_t* st_block_io = nullptr;
+
+// Torch height control offset, see Stepper::set_z_offset()
+static volatile int32_t  z_offset_target    = 0;
+static volatile int32_t  z_offset           = 0;  // Steps applied so far
+static volatile uint32_t z_offset_min_ticks = 0;
+static uint32_t          z_offset_ticks     = 0;  // Timer ticks since the last offset step
+
+// Velocity mode jogging, see Stepper::velocity_jog() and Stepper::follow_jog().  The speeds
+// and positions are those at the end of the last queued segment.
+struct velocity_jog_t {
+    bool         active;
+    bool         ran;                    // Since the last end_velocity_jog()
+    bool         follow;                 // Steered by goal instead of target
+    float        goal[MAX_N_AXIS];       // Cartesian position to follow (mm)
+    float        target[MAX_N_AXIS];     // Commanded velocity (mm/min)
+    float        speed[MAX_N_AXIS];      // Velocity (mm/min)
+    float        position[MAX_N_AXIS];   // Cartesian position (mm)
+    int32_t      emitted[MAX_N_AXIS];    // Motor position (steps)
+    TickType_t   timeout;                // Ticks without a new velocity before stopping, 0 for never
+    TickType_t   updated;                // When the velocity was last set
+    AxisMask     backlash_negative;      // Not compensated while jogging by velocity
+    uint32_t     raster_start;           // Where the last scanline ended
+    SpindleState spindle;                // As the parser has it when the jog starts
+    SpindleSpeed spindle_speed;
+};
+static velocity_jog_t vjog;
+
+// Segment trace ring, allocated when stepping/trace_segments is nonzero.
+static Stepper::TraceEntry* trace_buffer  = nullptr;
+static size_t               trace_size    = 0;
+static volatile size_t      trace_head    = 0;  // Next entry to write
+static volatile size_t      trace_used    = 0;
+static volatile uint32_t    trace_segment = 0;
+static volatile bool        trace_frozen  = false;
+
 // Primary stepper segment ring buffer. Contains small, short line segments for the stepper
 // algorithm to execute, which are "checked-out" incrementally from the first block in the
 // planner buffer. Once "checked-out", the steps in the segments buffer cannot be modified by
@@ -47,18 +104,95 @@ struct segment_t {
     uint8_t      amass_level;        // AMASS level for the ISR to execute this segment
     uint32_t     spindle_dev_speed;  // Spindle speed scaled to the device
     SpindleSpeed spindle_speed;      // Spindle speed in GCode units
+    uint32_t     raster_pos;         // Scanline pixel at the start of the segment, 16.16 fixed point
+    uint32_t     raster_step;        // Increase of raster_pos per ISR tick
+    uint8_t      phase;              // Stepper::MotionPhase of the ramp the segment belongs to
 };
 static segment_t* segment_buffer = nullptr;
 
+// Receives the segments of the axes that another controller steps
+static Stepper::SegmentMirror* mirror = nullptr;
+
+// Ramp phase of the executing segment, published by the step ISR for motor drivers
+static volatile uint8_t exec_phase = uint8_t(Stepper::MotionPhase::Idle);
+
+// Optional segment preparation task, enabled by stepping/prep_task. The mutex serializes it
+// against the protocol loop wherever planner blocks or prep state are changed.
+static TaskHandle_t      prepTask      = nullptr;
+static SemaphoreHandle_t prepMutex     = nullptr;
+static uint32_t          prepLowWater  = 0;  // Wake the task when fewer segments than this are queued
+static uint32_t          prepHighWater = 0;  // Stop preparing when this many segments are queued
+
+static void fill_segment_buffer();
+static void alloc_rewind_points();
+static void init_shaper();
+
+static void prep_loop(void* unused) {
+    while (true) {
+        // Woken by the step ISR when the segment buffer runs low, and by the protocol
+        // loop whenever the machine state allows segments to be prepared.
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        Stepper::prep_buffer();
+    }
+}
+
 void Stepper::init() {
     if (st_block_buffer) {
         delete[] st_block_buffer;
     }
     st_block_buffer = new st_block_t[Stepping::_segments - 1];
-    if (segment_buffer) {
-        delete[] segment_buffer;
+    if (st_block_io) {
+        delete[] st_block_io;
+    }
+    st_block_io = new plan_io_t[Stepping::_segments - 1];
+    if (Stepping::_traceSegments && !trace_buffer) {
+        trace_size   = Stepping::_traceSegments;
+        trace_buffer = new Stepper::TraceEntry[trace_size];
+    }
+    // The step ISR reads the segments, so they must be in internal RAM, where an ISR can
+    // reach them while the flash cache is off
+    heap_region_free(segment_buffer);
+    segment_buffer = static_cast<segment_t*>(heap_region_calloc(HEAP_INTERNAL, Stepping::_segments * sizeof(segment_t)));
+    Assert(segment_buffer, "No memory for %d stepping segments", int(Stepping::_segments));
+    alloc_rewind_points();
+    set_prep_watermarks();
+
+    if (Stepping::_prepTask && !prepTask) {
+        prepMutex = xSemaphoreCreateRecursiveMutex();
+        auto& task = Machine::Tasks::get()._prep;
+        task.create(prep_loop, nullptr, &prepTask);
+        log_info("Segment prep task on core " << task._core);
+    }
+
+    init_shaper();
+}
+
+void Stepper::set_prep_watermarks() {
+    uint32_t capacity = Stepping::_segments - 1;
+    uint32_t high     = Stepping::_prepHighWater ? std::min<uint32_t>(Stepping::_prepHighWater, capacity) : capacity;
+    uint32_t low      = Stepping::_prepLowWater ? Stepping::_prepLowWater : Stepping::_segments / 2;
+    prepHighWater     = std::max<uint32_t>(high, 2);
+    prepLowWater      = std::min(low, prepHighWater);
+}
+
+bool Stepper::prep_task_enabled() {
+    return prepTask != nullptr;
+}
+
+void Stepper::wake_prep_task() {
+    xTaskNotifyGive(prepTask);
+}
+
+void Stepper::prep_lock() {
+    if (prepMutex) {
+        xSemaphoreTakeRecursive(prepMutex, portMAX_DELAY);
+    }
+}
+
+void Stepper::prep_unlock() {
+    if (prepMutex) {
+        xSemaphoreGiveRecursive(prepMutex);
     }
-    segment_buffer = new segment_t[Stepping::_segments];
 }
 
 // Stepper ISR data struct. Contains the running data for the main stepper ISR.
@@ -77,6 +211,11 @@ typedef struct {
     uint8_t              exec_block_index;  // Tracks the current st_block index. Change indicates new block.
     volatile st_block_t* exec_block;        // Pointer to the block data for the segment being executed
     volatile segment_t*  exec_segment;      // Pointer to the segment being executed
+    uint8_t              sync_id;           // Last synchronized block whose index pulse has been seen
+
+    uint32_t raster_pos;    // Scanline pixel of the next tick, 16.16 fixed point
+    uint32_t raster_next;   // raster_pos where the next pixel starts
+    uint32_t raster_power;  // Laser power of the current pixel in device units
 } stepper_t;
 static stepper_t st;
 
@@ -117,6 +256,8 @@ typedef struct {
 
     float        inv_rate;  // Used by PWM laser mode to speed up segment calculations.
     SpindleSpeed current_spindle_speed;
+    SpindleState spindle;        // Spindle state of the prepped block. Copied from the planner side table.
+    SpindleSpeed spindle_speed;  // Programmed spindle speed of the prepped block.
 
     // S-curve acceleration support
     bool  use_s_curve;           // True if current block uses S-curve profile
@@ -126,9 +267,102 @@ typedef struct {
     float s_curve_distances[7];  // Distance of each S-curve phase
     float current_jerk;          // Current jerk value for S-curve calculations
 
+    // Native arc support.  A kinematic line is stepped the same way, from the motor positions
+    // that the kinematics give for points along it.
+    bool       arc;                    // True if the prepped block is a native arc or a kinematic line
+    bool       last_arc;               // Saved across a parking motion
+    bool       kinematic;              // True if the prepped block is a kinematic line
+    bool       last_kinematic;         // Saved across a parking motion
+    plan_arc_t arc_geometry;           // Copied from the planner side table
+    float      arc_length;             // Total length of the arc (mm)
+    int32_t    arc_steps[MAX_N_AXIS];  // Position reached by the arc segments prepped so far
+
+    bool st_block_used;  // True once a published segment refers to st_prep_block
+
+    // Spindle-synchronized motion, see sync_segment()
+    uint8_t sync_id;          // Nonzero if the prepped block is synchronized
+    float   sync_per_rev;     // Path distance per spindle revolution (mm)
+    float   sync_length;      // Length of the block (mm)
+    float   sync_time;        // End of the last prepped segment since the index pulse (min)
+    float   sync_speed;       // Speed that follows the spindle (mm/min)
+    float   sync_accel_time;  // Time to reach sync_speed from rest (min)
+    float   sync_lag;         // Distance lost to the spindle while accelerating (mm)
+    bool    sync_decel;       // Decelerating to the end of the block
+
+    float raster_mm;  // Length of the block that the scanline is spread over
+
+    uint32_t dwell_remaining;  // Of the prepped dwell block, not yet in segments (ms)
+
+    // The step ISR's Bresenham state at the end of the published segments, for the axes of
+    // the segment mirror.  Part of prep, so a rewind for a hold takes it back too.
+    uint8_t  mirror_block_index;
+    uint32_t mirror_counter[MAX_N_AXIS];
+    uint32_t mirror_sequence;  // Of the next published segment
+
 } st_prep_t;
 static st_prep_t prep;
 
+// Segment generator state after each queued segment, parallel to segment_buffer. A feed hold
+// uses it to drop the queued segments of the block being prepped and replan the deceleration
+// from the segment that is about to execute, instead of from the end of the buffer.
+typedef struct {
+    uint32_t  block_count;  // prep_block_count when the segment was prepared
+    float     millimeters;  // Remaining distance of the planner block after the segment
+    st_prep_t prep;
+} rewind_point_t;
+static rewind_point_t* rewind_points    = nullptr;
+static uint32_t        prep_block_count = 0;  // Counts planner blocks loaded into the segment generator
+static uint8_t         last_sync_id     = 0;  // Id of the last synchronized block loaded
+
+// Only the tasks use the rewind points, so they go in PSRAM if there is some, which leaves
+// the internal RAM for the segments of a large buffer
+static void alloc_rewind_points() {
+    heap_region_free(rewind_points);
+    size_t size   = Stepping::_segments * sizeof(rewind_point_t);
+    rewind_points = static_cast<rewind_point_t*>(heap_region_calloc(HEAP_PSRAM, size));
+    if (!rewind_points) {
+        rewind_points = static_cast<rewind_point_t*>(heap_region_calloc(HEAP_INTERNAL, size));
+    }
+    Assert(rewind_points, "No memory for %d stepping segments", int(Stepping::_segments));
+}
+
+// Input shaping, see InputShaper.h. The segment generator traces the unshaped motion as usual and
+// records it in the history. Each segment then carries its own stepper block that moves the motors
+// to the shaped position, the way arc segments do. When the unshaped motion comes to rest, further
+// segments are generated until the shaped motion has caught up with it.
+const int SHAPER_HISTORY_SIZE = 128;  // Covers a 10 Hz ZVD shaper at 1 ms per segment
+
+typedef struct {
+    ShaperImpulses impulses[MAX_N_AXIS];
+    uint32_t       max_delay;  // Longest delay of any axis in timer ticks. Zero when shaping is off.
+    bool           sync;       // Restart from the motor position when the next block is loaded
+    bool           stopping;   // The unshaped motion ended a feed hold; end it once the shaped one has
+    uint32_t       idle;       // Ticks since the unshaped position last changed
+
+    int32_t block_start[MAX_N_AXIS];  // Unshaped position at the start of the prepped block (steps)
+    int32_t block_end[MAX_N_AXIS];    // Unshaped position at the end of the prepped block (steps)
+    float   position[MAX_N_AXIS];     // Unshaped position at the end of the last segment (steps)
+    int32_t emitted[MAX_N_AXIS];      // Motor position at the end of the last segment (steps)
+
+    ShaperHistory<SHAPER_HISTORY_SIZE, MAX_N_AXIS> history;
+} shaper_t;
+static shaper_t shaper;
+
+static void init_shaper() {
+    shaper.max_delay = 0;
+    auto n_axis      = Axes::_numberAxis;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        auto  a        = config->_axes->_axis[axis];
+        auto& impulses = shaper.impulses[axis];
+        shaper_impulses(a->_shaper, a->_shaperFrequency, a->_shaperDamping, Stepping::fStepperTimer, impulses);
+        shaper.max_delay = MAX(shaper.max_delay, impulses.delay[impulses.count - 1]);
+    }
+}
+
+void Stepper::reload_shaper() {
+    init_shaper();
+}
+
 /* "The Stepper Driver Interrupt" - This timer interrupt is the workhorse, employing
    the venerable Bresenham line algorithm to manage and exactly synchronize multi-axis moves.
    Unlike the popular DDA algorithm, the Bresenham algorithm is not susceptible to numerical
@@ -193,6 +427,252 @@ void IRAM_ATTR Stepper::stop_stepping() {
 uint32_t Stepper::isr_count;  // for debugging only
 #endif
 
+// Step ISR timing, in CPU cycles, and segment buffer underruns. Reported by $Stepper/Stats.
+static IsrStats isr_stats = { 0, UINT32_MAX };
+
+static volatile int32_t isr_tick_time = 0;  // CPU cycle counter at the last pulse_func() tick
+
+static inline void IRAM_ATTR record_isr_time(int32_t start_ticks, uint32_t io_ticks) {
+    uint32_t ticks = getCpuTicks() - start_ticks;
+    if (ticks < isr_stats.min_ticks) {
+        isr_stats.min_ticks = ticks;
+    }
+    if (ticks > isr_stats.max_ticks) {
+        isr_stats.max_ticks = ticks;
+    }
+    if (io_ticks > isr_stats.max_io_ticks) {
+        isr_stats.max_io_ticks = io_ticks;
+    }
+    // Bin 0 is under 1 us, bin n is [2^(n-1), 2^n) us, and the last bin is everything longer.
+    uint32_t us  = ticks / ticks_per_us;
+    int      bin = us ? 32 - __builtin_clz(us) : 0;
+    if (bin >= IsrStats::n_bins) {
+        bin = IsrStats::n_bins - 1;
+    }
+    ++isr_stats.histogram[bin];
+    ++isr_stats.count;
+}
+
+void Stepper::get_isr_stats(IsrStats& stats) {
+    stats = isr_stats;
+}
+
+void Stepper::reset_isr_stats() {
+    isr_stats           = {};
+    isr_stats.min_ticks = UINT32_MAX;
+}
+
+static inline void IRAM_ATTR record_trace(size_t n_axis) {
+    if (!trace_buffer || trace_frozen) {
+        return;
+    }
+    Stepper::TraceEntry& entry = trace_buffer[trace_head];
+    entry.time                 = getCpuTicks();
+    entry.segment              = trace_segment++;
+    entry.line_number          = st.exec_block->line_number;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        entry.steps[axis] = Stepping::getSteps(axis);
+    }
+    trace_head = trace_head + 1 == trace_size ? 0 : trace_head + 1;
+    if (trace_used < trace_size) {
+        ++trace_used;
+    }
+}
+
+size_t Stepper::trace_count() {
+    return trace_used;
+}
+
+bool Stepper::get_trace_entry(size_t i, TraceEntry& entry) {
+    size_t used = trace_used;
+    if (i >= used) {
+        return false;
+    }
+    size_t index = trace_head + trace_size - used + i;
+    entry        = trace_buffer[index >= trace_size ? index - trace_size : index];
+    return true;
+}
+
+// Only freezes a trace that has recorded something, so that an alarm at startup, such as
+// for unhomed axes, does not stop the trace before any motion.
+void Stepper::freeze_trace() {
+    if (trace_used) {
+        trace_frozen = true;
+    }
+}
+
+void Stepper::reset_trace() {
+    trace_frozen  = true;
+    trace_used    = 0;
+    trace_head    = 0;
+    trace_segment = 0;
+    trace_frozen  = false;
+}
+
+int32_t Stepper::executing_line() {
+    auto block = st.exec_block;
+    return st.exec_segment && block ? block->line_number : 0;
+}
+
+// Sets the laser power for the scanline pixel at st.raster_pos: the power of the segment
+// scaled by the pixel.  The spindle is only told about changes.
+static inline void IRAM_ATTR raster_pixel() {
+    uint32_t pixel  = MIN(st.raster_pos >> 16, st.exec_block->raster_length - 1);
+    uint32_t power  = st.exec_segment->spindle_dev_speed * Raster::pixel(st.exec_block->raster_start + pixel) / 255;
+    st.raster_next  = (pixel + 1) << 16;
+    if (power != st.raster_power) {
+        st.raster_power = power;
+        spindle->setSpeedfromISR(power);
+    }
+}
+
+// Advances the scanline of a raster block by ticks ISR ticks of the current segment.
+static inline void IRAM_ATTR raster_advance(uint32_t ticks) {
+    st.raster_pos += st.exec_segment->raster_step * ticks;
+    if (st.raster_pos >= st.raster_next) {
+        raster_pixel();
+    }
+}
+
+// Loads the next step segment from the segment buffer. Returns false if the buffer is empty.
+static inline bool IRAM_ATTR load_segment(size_t n_axis) {
+    // Anything in the buffer? If so, load and initialize next step segment.
+    if (segment_buffer_head == segment_buffer_tail) {
+        return false;
+    }
+    // Initialize new step segment and load number of steps to execute
+    st.exec_segment = &segment_buffer[segment_buffer_tail];
+    exec_phase      = st.exec_segment->phase;
+    Machine::MotorEncoder::check_all();
+    MotorDrivers::Servo::segment_boundary();  // RC servos follow the motion segment by segment
+    if (mirror) {
+        mirror->start();
+    }
+    // Initialize step segment timing per step and load number of steps to execute.
+    Stepping::setTimerPeriod(st.exec_segment->isrPeriod);
+    st.step_count = st.exec_segment->n_step;  // NOTE: Can sometimes be zero when moving slow.
+    // If the new segment starts a new planner block, initialize stepper variables and counters.
+    // NOTE: When the segment data index changes, this indicates a new planner block.
+    if (st.exec_block_index != st.exec_segment->st_block_index) {
+        st.exec_block_index = st.exec_segment->st_block_index;
+        st.exec_block       = &st_block_buffer[st.exec_block_index];
+        // Reported positions take the backlash of the new block into account from its start
+        Stepping::backlash_negative = st.exec_block->backlash_negative;
+        if (st.exec_block->has_io) {
+            config->_userOutputs->setFromISR(st_block_io[st.exec_block_index]);
+        }
+        // The scanlines before this block are done with
+        Raster::release(st.exec_block->raster_start);
+        if (st.exec_block->latency_traced) {
+            LineLatency::first_step(isr_tick_time);
+        }
+        // Initialize Bresenham line and distance counters
+        for (int axis = 0; axis < n_axis; axis++) {
+            st.counter[axis] = st.exec_block->step_event_count >> 1;
+        }
+    }
+    record_trace(n_axis);
+
+    st.dir_outbits = st.exec_block->direction_bits;
+    // Adjust Bresenham axis increment counters according to AMASS level.
+    for (int axis = 0; axis < n_axis; axis++) {
+        st.steps[axis] = st.exec_block->steps[axis] >> st.exec_segment->amass_level;
+    }
+    // Set real-time spindle output as segment is loaded, just prior to the first step.
+    if (st.exec_block->raster_length) {
+        st.raster_pos   = st.exec_segment->raster_pos;
+        st.raster_power = UINT32_MAX;
+        raster_pixel();
+    } else {
+        spindle->setSpeedfromISR(st.exec_segment->spindle_dev_speed);
+    }
+    return true;
+}
+
+// A spindle-synchronized block starts at the first spindle index pulse after it reaches
+// the ISR.  Until then, the ISR keeps ticking without loading its first segment.  Returns
+// true while waiting.
+static inline bool IRAM_ATTR sync_wait() {
+    if (segment_buffer_head == segment_buffer_tail) {
+        return false;
+    }
+    uint8_t id = st_block_buffer[segment_buffer[segment_buffer_tail].st_block_index].sync_id;
+    if (id == 0 || id == st.sync_id) {
+        return false;
+    }
+    Spindles::Encoder* encoder = spindle->_encoder;
+    if (encoder && !encoder->synced(id)) {
+        encoder->arm(id);
+        Stepping::setTimerPeriod(SYNC_WAIT_TICKS);
+        return true;
+    }
+    st.sync_id = id;
+    return false;
+}
+
+// Takes a height control step toward z_offset_target in a tick of ticks timer ticks, if the
+// segment has no Z steps and the last offset step was long enough ago.  Returns true with
+// the step added to step_bits and the Z direction set in st.dir_outbits.
+static inline bool IRAM_ATTR z_offset_step(uint8_t& step_bits, uint32_t ticks) {
+    z_offset_ticks += ticks;
+    if (z_offset_ticks < z_offset_min_ticks || st.steps[Z_AXIS] != 0) {
+        return false;
+    }
+    z_offset_ticks = 0;
+    set_bitnum(step_bits, Z_AXIS);
+    if (z_offset_target > z_offset) {
+        clear_bitnum(st.dir_outbits, Z_AXIS);
+        ++z_offset;
+    } else {
+        set_bitnum(st.dir_outbits, Z_AXIS);
+        --z_offset;
+    }
+    return true;
+}
+
+// Shuts down stepping when the segment buffer is empty.
+static void IRAM_ATTR run_dry() {
+    stop_stepping();
+    if (!state_is(State::Jog)) {  // added to prevent ... jog after probing crash
+        // Ensure pwm is set properly upon completion of rate-controlled motion.
+        if (st.exec_block != NULL && st.exec_block->is_pwm_rate_adjusted) {
+            spindle->setSpeedfromISR(0);
+        }
+    }
+    if (st.exec_block != NULL) {
+        Raster::release(st.exec_block->raster_start + st.exec_block->raster_length);
+    }
+
+    // Running dry while the segment generator still has a block in hand means
+    // prep did not keep up, as opposed to the normal end of a motion.
+    if (state_is(State::Cycle) && pl_block != NULL && !sys.step_control.endMotion) {
+        ++isr_stats.underruns;
+    }
+
+    protocol_send_event_from_ISR(&cycleStopEvent);
+    exec_phase = uint8_t(Stepper::MotionPhase::Idle);
+    awake      = false;
+    Stepping::unstep();
+}
+
+// Discards the executed segment and wakes the prep task if the segment buffer is running low.
+static inline void IRAM_ATTR end_segment() {
+    st.exec_segment     = NULL;
+    segment_buffer_tail = segment_buffer_tail >= (Stepping::_segments - 1) ? 0 : segment_buffer_tail + 1;
+
+    if (prepTask) {
+        uint32_t queued = segment_buffer_head >= segment_buffer_tail ? segment_buffer_head - segment_buffer_tail
+                                                                      : segment_buffer_head + Stepping::_segments - segment_buffer_tail;
+        if (queued < prepLowWater) {
+            BaseType_t higherPriorityTaskWoken = pdFALSE;
+            vTaskNotifyGiveFromISR(prepTask, &higherPriorityTaskWoken);
+            if (higherPriorityTaskWoken) {
+                portYIELD_FROM_ISR();
+            }
+        }
+    }
+}
+
 /**
  * This phase of the ISR should ONLY create the pulses for the steppers.
  * This prevents jitter caused by the interval between the start of the
@@ -202,6 +682,8 @@ uint32_t Stepper::isr_count;  // for debugging only
  * Returns true if step interrupts should continue
  */
 bool IRAM_ATTR Stepper::pulse_func() {
+    int32_t isr_start = getCpuTicks();
+    isr_tick_time     = isr_start;
 #ifdef DEBUG_STEPPER_ISR
     isr_count++;
 #endif
@@ -212,48 +694,21 @@ bool IRAM_ATTR Stepper::pulse_func() {
     auto n_axis = Axes::_numberAxis;
 
     Stepping::step(st.step_outbits, st.dir_outbits);
-    st.step_outbits = 0;
+    uint32_t io_ticks = getCpuTicks() - isr_start;
+    st.step_outbits   = 0;
+
+    gpio_sample_fast();  // Limit switches take effect at the next step
 
     // If there is no step segment, attempt to pop one from the stepper buffer
     if (st.exec_segment == NULL) {
-        // Anything in the buffer? If so, load and initialize next step segment.
-        if (segment_buffer_head != segment_buffer_tail) {
-            // Initialize new step segment and load number of steps to execute
-            st.exec_segment = &segment_buffer[segment_buffer_tail];
-            // Initialize step segment timing per step and load number of steps to execute.
-            Stepping::setTimerPeriod(st.exec_segment->isrPeriod);
-            st.step_count = st.exec_segment->n_step;  // NOTE: Can sometimes be zero when moving slow.
-            // If the new segment starts a new planner block, initialize stepper variables and counters.
-            // NOTE: When the segment data index changes, this indicates a new planner block.
-            if (st.exec_block_index != st.exec_segment->st_block_index) {
-                st.exec_block_index = st.exec_segment->st_block_index;
-                st.exec_block       = &st_block_buffer[st.exec_block_index];
-                // Initialize Bresenham line and distance counters
-                for (int axis = 0; axis < n_axis; axis++) {
-                    st.counter[axis] = st.exec_block->step_event_count >> 1;
-                }
-            }
-
-            st.dir_outbits = st.exec_block->direction_bits;
-            // Adjust Bresenham axis increment counters according to AMASS level.
-            for (int axis = 0; axis < n_axis; axis++) {
-                st.steps[axis] = st.exec_block->steps[axis] >> st.exec_segment->amass_level;
-            }
-            // Set real-time spindle output as segment is loaded, just prior to the first step.
-            spindle->setSpeedfromISR(st.exec_segment->spindle_dev_speed);
-        } else {
+        if (sync_wait()) {
+            record_isr_time(isr_start, io_ticks);
+            return true;
+        }
+        if (!load_segment(n_axis)) {
             // Segment buffer empty. Shutdown.
-            stop_stepping();
-            if (!state_is(State::Jog)) {  // added to prevent ... jog after probing crash
-                // Ensure pwm is set properly upon completion of rate-controlled motion.
-                if (st.exec_block != NULL && st.exec_block->is_pwm_rate_adjusted) {
-                    spindle->setSpeedfromISR(0);
-                }
-            }
-
-            protocol_send_event_from_ISR(&cycleStopEvent);
-            awake = false;
-            Stepping::unstep();
+            run_dry();
+            record_isr_time(isr_start, io_ticks);
             return false;  // Nothing to do but exit.
         }
     }
@@ -266,15 +721,184 @@ bool IRAM_ATTR Stepper::pulse_func() {
             st.counter[axis] -= st.exec_block->step_event_count;
         }
     }
+    if (st.exec_block->raster_length) {
+        raster_advance(1);
+    }
+    if (z_offset != z_offset_target && n_axis > Z_AXIS) {
+        z_offset_step(st.step_outbits, st.exec_segment->isrPeriod);
+    }
 
     st.step_count--;  // Decrement step events count
     if (st.step_count == 0) {
         // Segment is complete. Discard current segment and advance segment indexing.
-        st.exec_segment     = NULL;
-        segment_buffer_tail = segment_buffer_tail >= (Stepping::_segments - 1) ? 0 : segment_buffer_tail + 1;
+        end_segment();
     }
 
+    int32_t unstep_start = getCpuTicks();
     Stepping::unstep();
+    Stepping::prepare_directions(st.dir_outbits);
+    io_ticks += getCpuTicks() - unstep_start;
+    record_isr_time(isr_start, io_ticks);
+    return true;
+}
+
+size_t Stepper::run_virtual(uint64_t& time, VirtualSink& sink) {
+    auto   n_axis = Axes::_numberAxis;
+    size_t count  = 0;
+    while (segment_buffer_head != segment_buffer_tail) {
+        // As load_segment(), without the outputs
+        volatile segment_t* segment = &segment_buffer[segment_buffer_tail];
+        if (st.exec_block_index != segment->st_block_index) {
+            st.exec_block_index = segment->st_block_index;
+            st.exec_block       = &st_block_buffer[st.exec_block_index];
+            Raster::release(st.exec_block->raster_start);
+            for (int axis = 0; axis < n_axis; axis++) {
+                st.counter[axis] = st.exec_block->step_event_count >> 1;
+            }
+        }
+        for (int axis = 0; axis < n_axis; axis++) {
+            st.steps[axis] = st.exec_block->steps[axis] >> segment->amass_level;
+        }
+        uint32_t period = segment->isrPeriod;
+        sink.segment(time, period, segment->n_step);
+        // As pulse_func(), one ISR tick at a time
+        for (uint32_t tick = 0; tick < segment->n_step; tick++) {
+            uint8_t step_bits = 0;
+            for (int axis = 0; axis < n_axis; axis++) {
+                st.counter[axis] += st.steps[axis];
+                if (st.counter[axis] > st.exec_block->step_event_count) {
+                    set_bitnum(step_bits, axis);
+                    st.counter[axis] -= st.exec_block->step_event_count;
+                }
+            }
+            time += period;
+            if (step_bits) {
+                sink.step(time, step_bits, st.exec_block->direction_bits);
+            }
+        }
+        segment_buffer_tail = segment_buffer_tail >= (Stepping::_segments - 1) ? 0 : segment_buffer_tail + 1;
+        ++count;
+    }
+    return count;
+}
+
+// The position between steps follows from the Bresenham state. After k ticks of a block, the
+// counter of an axis is event_count/2 + k*increment - steps*event_count, so the exact position
+// is steps + (counter - event_count/2)/event_count. pulse_func() runs the Bresenham algorithm for
+// the next tick ahead of it, with its steps pending in step_outbits. With pulse trains there is
+// no per-tick state, so the position is not interpolated.
+void IRAM_ATTR Stepper::latch_position(PositionLatch& latch) {
+    int32_t now     = getCpuTicks();
+    auto    n_axis  = Axes::_numberAxis;
+    auto    segment = st.exec_segment;
+
+    latch.event_count = 0;
+    if (awake && segment != NULL && !Stepping::_pulseTrains) {
+        latch.event_count = st.exec_block->step_event_count;
+        latch.step_bits   = st.step_outbits;
+        latch.dir_bits    = st.dir_outbits;
+        latch.elapsed     = now - isr_tick_time;
+        latch.period      = segment->isrPeriod * ticks_per_us / (Stepping::fStepperTimer / 1000000);
+    }
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        latch.steps[axis]     = Stepping::getSteps(axis);
+        latch.counter[axis]   = st.counter[axis];
+        latch.increment[axis] = st.steps[axis];
+    }
+}
+
+void Stepper::interpolate_latch(const PositionLatch& latch, float* fraction) {
+    auto n_axis = Axes::_numberAxis;
+    if (!latch.event_count) {
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            fraction[axis] = 0.0f;
+        }
+        return;
+    }
+    float tick  = latch.period ? MIN(float(latch.elapsed) / float(latch.period), 1.0f) : 0.0f;  // Part of the current tick done
+    float count = float(latch.event_count);
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        // The counter is one tick ahead; take back the part of that tick that has not elapsed yet.
+        float f = (float(latch.counter[axis]) - float(latch.event_count >> 1) - (1.0f - tick) * float(latch.increment[axis])) / count;
+        if (bitnum_is_true(latch.step_bits, axis)) {
+            f += 1.0f;
+        }
+        f              = MAX(MIN(f, 1.0f), -1.0f);
+        fraction[axis] = bitnum_is_true(latch.dir_bits, axis) ? -f : f;
+    }
+}
+
+// The ISR used instead of pulse_func() when the stepping engine times pulse trains in hardware
+// (stepping/pulse_trains). Every call traces up to STEP_TRAIN_MAX_TICKS ISR ticks of the current
+// segment with the same Bresenham algorithm, hands the resulting step times to the engine, and
+// sets the timer to the end of the train. The step rate is constant within a segment, so the
+// train has the same timing as stepping once per tick, with one interrupt per train.
+// NOTE: Limit switches and motor blocking take effect at the next train, at most
+// STEP_TRAIN_MAX_US later.
+bool IRAM_ATTR Stepper::pulse_train_func() {
+    int32_t isr_start = getCpuTicks();
+#ifdef DEBUG_STEPPER_ISR
+    isr_count++;
+#endif
+    if (!awake) {
+        return false;
+    }
+    auto n_axis = Axes::_numberAxis;
+
+    gpio_sample_fast();
+
+    if (st.exec_segment == NULL) {
+        if (sync_wait()) {
+            record_isr_time(isr_start, 0);
+            return true;
+        }
+        if (!load_segment(n_axis)) {
+            run_dry();
+            record_isr_time(isr_start, 0);
+            return false;
+        }
+    }
+
+    uint32_t period    = st.exec_segment->isrPeriod;
+    uint32_t max_ticks = STEP_TRAIN_MAX_US * (Machine::Stepping::fStepperTimer / 1000000) / period;
+    uint32_t ticks     = MIN(uint32_t(st.step_count), uint32_t(STEP_TRAIN_MAX_TICKS));
+    ticks              = MAX(uint32_t(1), MIN(ticks, max_ticks));
+
+    uint8_t offsets[MAX_N_AXIS][STEP_TRAIN_MAX_TICKS];
+    int     counts[MAX_N_AXIS] = { 0 };
+    for (uint32_t tick = 0; tick < ticks; tick++) {
+        for (int axis = 0; axis < n_axis; axis++) {
+            st.counter[axis] += st.steps[axis];
+            if (st.counter[axis] > st.exec_block->step_event_count) {
+                offsets[axis][counts[axis]++] = tick;
+                st.counter[axis] -= st.exec_block->step_event_count;
+            }
+        }
+    }
+
+    if (z_offset != z_offset_target && n_axis > Z_AXIS) {
+        uint8_t z_bits = 0;
+        if (z_offset_step(z_bits, ticks * period)) {
+            offsets[Z_AXIS][0] = 0;
+            counts[Z_AXIS]     = 1;
+        }
+    }
+
+    Stepping::setTimerPeriod(ticks * period);
+    int32_t io_start = getCpuTicks();
+    Stepping::step_train(offsets, counts, st.dir_outbits, period);
+    uint32_t io_ticks = getCpuTicks() - io_start;
+
+    // Within a train, the laser power follows the scanline at train granularity
+    if (st.exec_block->raster_length) {
+        raster_advance(ticks);
+    }
+
+    st.step_count -= ticks;
+    if (st.step_count == 0) {
+        end_segment();
+    }
+    record_isr_time(isr_start, io_ticks);
     return true;
 }
 
@@ -294,13 +918,16 @@ void Stepper::wake_up() {
 }
 
 void Stepper::go_idle() {
-    awake = false;
+    awake      = false;
+    exec_phase = uint8_t(MotionPhase::Idle);
     stop_stepping();
     protocol_disable_steppers();
 }
 
 // Reset and clear stepper subsystem variables
 void Stepper::reset() {
+    prep_lock();
+    LineLatency::abandon();  // The traced block will not step
     // Initialize Stepping driver idle state.
     Stepping::reset();
 
@@ -309,6 +936,10 @@ void Stepper::reset() {
     // Initialize stepper algorithm variables.
     memset(&prep, 0, sizeof(st_prep_t));
     memset(&st, 0, sizeof(stepper_t));
+    memset(&vjog, 0, sizeof(vjog));
+    if (mirror) {
+        mirror->reset();
+    }
     st.exec_segment     = NULL;
     pl_block            = NULL;  // Planner block pointer used by segment buffer
     segment_buffer_tail = 0;
@@ -316,7 +947,50 @@ void Stepper::reset() {
     segment_next_head   = 1;
     st.step_outbits     = 0;
     st.dir_outbits      = 0;  // Initialize direction bits to default.
+    shaper.sync         = true;
+    shaper.stopping     = false;
+    shaper.idle         = shaper.max_delay;
+    Stepper::clear_z_offset();  // The planner position is taken from the motors after a reset
     // TODO do we need to turn step pins off?
+    prep_unlock();
+}
+
+static uint32_t next_segment_index(uint32_t index) {
+    return index >= (Stepping::_segments - 1) ? 0 : index + 1;
+}
+
+// Called when a feed hold or jog cancel starts, before update_plan_block_parameters(). Drops the
+// queued segments that come after the next one, if they all belong to the block being prepped,
+// and rewinds the segment generator to the end of the next segment. The deceleration then begins
+// within two segments, however deep the buffer is. Segments of earlier blocks, which the planner
+// has already discarded, cannot be replanned and still run at their queued speed.
+bool Stepper::rewind_for_hold() {
+    prep_lock();
+    bool rewound = false;
+    // The shaped motion lags the queued segments, and system motions are not held. A synchronized
+    // block holds at its end, see sync_segment().
+    if (pl_block != NULL && !shaper.max_delay && !sys.step_control.executeSysMotion && !prep.recalculate_flag.parking && !prep.sync_id) {
+        // The step ISR only advances the tail, one segment at a time, so keeping the executing segment
+        // and the one after it leaves far more time than it takes to move the head back.
+        uint32_t keep = next_segment_index(segment_buffer_tail);
+        uint32_t head = segment_buffer_head;
+        if (segment_buffer_tail != head && keep != head && next_segment_index(keep) != head) {
+            const rewind_point_t& point = rewind_points[keep];
+            if (point.block_count == prep_block_count) {
+                segment_buffer_head   = next_segment_index(keep);
+                segment_next_head     = next_segment_index(segment_buffer_head);
+                prep                  = point.prep;
+                pl_block->millimeters = point.millimeters;
+                st_prep_block         = &st_block_buffer[prep.st_block_index];
+                rewound               = true;
+                if (mirror) {
+                    mirror->rewind(prep.mirror_sequence);
+                }
+            }
+        }
+    }
+    prep_unlock();
+    return rewound;
 }
 
 // Called by planner_recalculate() when the executing block is updated by the new plan.
@@ -332,21 +1006,26 @@ bool Stepper::update_plan_block_parameters() {
 
 // Changes the run state of the step segment buffer to execute the special parking motion.
 void Stepper::parking_setup_buffer() {
+    prep_lock();
     // Store step execution data of partially completed block, if necessary.
     if (prep.recalculate_flag.holdPartialBlock) {
         prep.last_st_block_index  = prep.st_block_index;
         prep.last_steps_remaining = prep.steps_remaining;
         prep.last_dt_remainder    = prep.dt_remainder;
         prep.last_step_per_mm     = prep.step_per_mm;
+        prep.last_arc             = prep.arc;
+        prep.last_kinematic       = prep.kinematic;
     }
     // Set flags to execute a parking motion
     prep.recalculate_flag.parking     = 1;
     prep.recalculate_flag.recalculate = 0;
     pl_block                          = NULL;  // Always reset parking motion to reload new block.
+    prep_unlock();
 }
 
 // Restores the step segment buffer to the normal run state after a parking motion.
 void Stepper::parking_restore_buffer() {
+    prep_lock();
     // Restore step execution data and flags of partially completed block, if necessary.
     if (prep.recalculate_flag.holdPartialBlock) {
         st_prep_block                          = &st_block_buffer[prep.last_st_block_index];
@@ -354,6 +1033,9 @@ void Stepper::parking_restore_buffer() {
         prep.steps_remaining                   = prep.last_steps_remaining;
         prep.dt_remainder                      = prep.last_dt_remainder;
         prep.step_per_mm                       = prep.last_step_per_mm;
+        prep.arc                               = prep.last_arc;
+        prep.kinematic                         = prep.last_kinematic;
+        prep.st_block_used                     = true;
         prep.recalculate_flag.holdPartialBlock = 1;
         prep.recalculate_flag.recalculate      = 1;
         prep.req_mm_increment                  = REQ_MM_INCREMENT_SCALAR / prep.step_per_mm;  // Recompute this value.
@@ -362,6 +1044,27 @@ void Stepper::parking_restore_buffer() {
     }
 
     pl_block = NULL;  // Set to reload next block.
+    prep_unlock();
+}
+
+// Maps an S-curve phase index to the ramp state that executes it.
+static uint8_t s_curve_ramp_type(int phase) {
+    switch (phase) {
+        case 0:
+            return RAMP_ACCEL_JERK_UP;
+        case 1:
+            return RAMP_ACCEL;
+        case 2:
+            return RAMP_ACCEL_JERK_DOWN;
+        case 3:
+            return RAMP_CRUISE;
+        case 4:
+            return RAMP_DECEL_JERK_UP;
+        case 5:
+            return RAMP_DECEL;
+        default:
+            return RAMP_DECEL_JERK_DOWN;
+    }
 }
 
 // Increments the step segment buffer block data ring buffer.
@@ -370,6 +1073,569 @@ static uint8_t next_block_index(uint8_t block_index) {
     return block_index == (Stepping::_segments - 1) ? 0 : block_index;
 }
 
+// Returns the highest AMASS level that any axis of a block with the given step counts, not
+// shifted by maxAmassLevel, needs. See amassJitterShift.
+static uint8_t amass_max_level(const uint32_t* steps, uint32_t step_event_count) {
+    uint8_t max_level = 0;
+    auto    n_axis    = Axes::_numberAxis;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        uint32_t axis_steps = steps[axis];
+        if (axis_steps == 0 || axis_steps == step_event_count) {
+            continue;  // Never steps between dominant axis steps
+        }
+        uint8_t level = max_level;
+        while (level < maxAmassLevel && (uint64_t(axis_steps) << amassJitterShift) > (uint64_t(step_event_count) << level)) {
+            level++;
+        }
+        max_level = level;
+    }
+    return max_level;
+}
+
+// Computes the motor position in steps at a fraction of the way along the prepped kinematic
+// line. Axes that the kinematics do not transform move with the cartesian position. A point
+// that the kinematics cannot reach leaves the motors where they are.
+static void kinematic_position_steps(float fraction, int32_t* steps) {
+    plan_kinematic_t& line = plan_get_block_aux(pl_block)->kinematic;
+    float             cartesian[MAX_N_AXIS], motors[MAX_N_AXIS];
+    auto              n_axis = Axes::_numberAxis;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        cartesian[axis] = line.start[axis] + fraction * (line.end[axis] - line.start[axis]);
+        motors[axis]    = cartesian[axis];
+    }
+    if (!config->_kinematics->transform_cartesian_to_motors(motors, cartesian)) {
+        copyAxes(steps, prep.arc_steps);
+        return;
+    }
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        steps[axis] = mpos_to_steps(motors[axis], axis);
+    }
+}
+
+// Computes the machine position in steps at a fraction of the way along the prepped arc.
+static void arc_position_steps(float fraction, int32_t* steps) {
+    plan_arc_t& arc = prep.arc_geometry;
+    if (fraction >= 1.0f) {
+        copyAxes(steps, arc.end_steps);
+        return;
+    }
+    if (prep.kinematic) {
+        kinematic_position_steps(fraction, steps);
+        return;
+    }
+    auto n_axis = Axes::_numberAxis;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        steps[axis] = arc.start_steps[axis] + lroundf(fraction * (arc.end_steps[axis] - arc.start_steps[axis]));
+    }
+    float angle       = arc.start_angle + fraction * arc.angular_travel;
+    steps[arc.axis_0] = mpos_to_steps(arc.center[0] + arc.radius * cosf(angle), arc.axis_0);
+    steps[arc.axis_1] = mpos_to_steps(arc.center[1] + arc.radius * sinf(angle), arc.axis_1);
+}
+
+// Points the segment at a stepper block of its own that executes steps, the absolute step counts
+// per axis, in the given directions. The block loaded for the planner block is reused if no
+// segment has been published with it, so the block ring, which has room for one block per
+// segment in the segment buffer, cannot overrun.
+static void segment_st_block(volatile segment_t* prep_segment, const uint32_t* steps, uint32_t step_event_count, uint8_t direction_bits) {
+    if (prep.st_block_used) {
+        bool     is_pwm_rate_adjusted       = st_prep_block->is_pwm_rate_adjusted;
+        AxisMask backlash_negative          = st_prep_block->backlash_negative;
+        int32_t  line_number                = st_prep_block->line_number;
+        uint32_t raster_start               = st_prep_block->raster_start;
+        uint32_t raster_length              = st_prep_block->raster_length;
+        prep.st_block_index                 = next_block_index(prep.st_block_index);
+        st_prep_block                       = &st_block_buffer[prep.st_block_index];
+        st_prep_block->is_pwm_rate_adjusted = is_pwm_rate_adjusted;
+        st_prep_block->backlash_negative    = backlash_negative;
+        st_prep_block->line_number          = line_number;
+        st_prep_block->raster_start         = raster_start;  // The segments of the planner block share its scanline
+        st_prep_block->raster_length        = raster_length;
+        st_prep_block->has_io               = false;  // Outputs change once, at the start of the planner block
+        st_prep_block->latency_traced       = false;  // So does the first step
+        prep.st_block_used                  = false;
+    }
+    auto n_axis = Axes::_numberAxis;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        st_prep_block->steps[axis] = steps[axis] << maxAmassLevel;
+    }
+    st_prep_block->step_event_count = step_event_count << maxAmassLevel;
+    st_prep_block->direction_bits   = direction_bits;
+    st_prep_block->amass_max_level  = amass_max_level(steps, step_event_count);
+    prep_segment->st_block_index    = prep.st_block_index;
+}
+
+// Computes the steps and step rate of an arc segment that ends mm_remaining from the end of
+// the arc. Each arc segment is a short line with its own Bresenham data, from the position
+// reached by the previous segment to the point on the arc, so the arc is traced exactly at
+// segment resolution. A segment too short to contain a step is not executed; its time is
+// returned as dt_remainder and carried into the next one. When shaping, the shaper sets up
+// the stepper block instead.
+static void arc_segment_timing(float mm_remaining, float dt, volatile segment_t* prep_segment, SegmentTiming& timing, bool shaped) {
+    int32_t target[MAX_N_AXIS];
+    arc_position_steps(1.0f - mm_remaining / prep.arc_length, target);
+
+    uint32_t steps[MAX_N_AXIS];
+    uint32_t step_event_count = 0;
+    uint8_t  direction_bits   = 0;
+    auto     n_axis           = Axes::_numberAxis;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        int32_t delta    = target[axis] - prep.arc_steps[axis];
+        steps[axis]      = labs(delta);
+        step_event_count = MAX(step_event_count, steps[axis]);
+        if (delta < 0) {
+            direction_bits |= bitnum_to_mask(axis);
+        }
+    }
+
+    timing.steps_remaining = 0.0f;
+    if (step_event_count == 0) {
+        timing.n_step       = 0;
+        timing.timer_ticks  = 0;
+        timing.dt_remainder = dt;
+        return;
+    }
+    timing.n_step       = step_event_count;
+    timing.timer_ticks  = uint32_t(ceilf(float(Machine::Stepping::fStepperTimer * 60) * dt / step_event_count));
+    timing.dt_remainder = 0.0f;
+
+    if (!shaped) {
+        segment_st_block(prep_segment, steps, step_event_count, direction_bits);
+    }
+    copyAxes(prep.arc_steps, target);
+}
+
+// Restarts the shaper at rest at the motor position. The segment buffer must be empty. For a new
+// block, the unshaped block position is taken from the motors as well; a partially completed
+// block keeps the position it was held at. Blocks carry physical steps, including backlash
+// compensation, so this uses the physical position rather than get_motor_steps().
+static void shaper_sync(bool new_block) {
+    auto n_axis = Axes::_numberAxis;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        int32_t motor         = Stepping::getSteps(axis);
+        shaper.emitted[axis]  = motor;
+        shaper.position[axis] = float(motor);
+        if (new_block) {
+            shaper.block_end[axis] = motor;
+        }
+    }
+    shaper.history.reset(0, shaper.position, n_axis);
+    shaper.idle = shaper.max_delay;
+    shaper.sync = false;
+}
+
+// Notes the unshaped start and end positions of a newly loaded planner block.
+static void shaper_load_block(plan_block_t* block) {
+    auto n_axis = Axes::_numberAxis;
+    copyAxes(shaper.block_start, shaper.block_end);
+    if (block->is_arc || block->is_kinematic) {
+        copyAxes(shaper.block_end, plan_get_block_aux(block)->arc.end_steps);
+        return;
+    }
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        if (bitnum_is_true(block->direction_bits, axis)) {
+            shaper.block_end[axis] -= block->steps[axis];
+        } else {
+            shaper.block_end[axis] += block->steps[axis];
+        }
+    }
+}
+
+// Puts the shaper at rest at the end of the newly loaded block, for a block that moves the
+// motors there without shaping.
+static void shaper_skip_block() {
+    auto n_axis = Axes::_numberAxis;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        shaper.emitted[axis]  = shaper.block_end[axis];
+        shaper.position[axis] = float(shaper.block_end[axis]);
+    }
+    shaper.history.reset(0, shaper.position, n_axis);
+    shaper.idle = shaper.max_delay;
+}
+
+// Unshaped position, in steps, at the end of the segment just timed.
+static void shaper_target(const SegmentTiming& timing, float* target) {
+    auto n_axis = Axes::_numberAxis;
+    if (prep.arc) {
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            target[axis] = float(prep.arc_steps[axis]);
+        }
+        return;
+    }
+    float fraction = timing.steps_remaining / float(pl_block->step_event_count);  // Of the block still to go
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        target[axis] = shaper.block_end[axis] - fraction * float(shaper.block_end[axis] - shaper.block_start[axis]);
+    }
+}
+
+// Records a segment of duration timer ticks that ends at the unshaped position target, and sets
+// up the segment to move the motors to the shaped position instead. Every shaped segment lasts
+// its full duration, even if no motor steps in it, so its ISR ticks may be stepless.
+static void shaper_segment(const float* target, uint32_t duration, volatile segment_t* prep_segment, SegmentTiming& timing) {
+    auto n_axis = Axes::_numberAxis;
+    bool moved  = false;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        if (target[axis] != shaper.position[axis]) {
+            shaper.position[axis] = target[axis];
+            moved                 = true;
+        }
+    }
+    shaper.idle = moved ? 0 : shaper.idle + duration;
+    shaper.history.push(duration, shaper.position);
+
+    uint32_t steps[MAX_N_AXIS];
+    uint32_t step_event_count = 0;
+    uint8_t  direction_bits   = 0;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        // Once the unshaped motion has been at rest for the longest delay, every axis is there.
+        float   shaped = shaper.idle >= shaper.max_delay ? shaper.position[axis] : shaper.history.shaped(axis, shaper.impulses[axis]);
+        int32_t motor  = lroundf(shaped);
+        int32_t delta  = motor - shaper.emitted[axis];
+        steps[axis]    = labs(delta);
+        if (delta < 0) {
+            direction_bits |= bitnum_to_mask(axis);
+        }
+        step_event_count     = MAX(step_event_count, steps[axis]);
+        shaper.emitted[axis] = motor;
+    }
+
+    // Enough step events that the step period fits in isrPeriod at the highest AMASS level.
+    const uint32_t max_period = uint32_t(0xffff) << maxAmassLevel;
+    step_event_count          = MAX(step_event_count, (duration + max_period - 1) / max_period);
+    step_event_count          = MAX(step_event_count, uint32_t(1));
+
+    timing.n_step      = step_event_count;
+    timing.timer_ticks = (duration + step_event_count - 1) / step_event_count;
+    segment_st_block(prep_segment, steps, step_event_count, direction_bits);
+}
+
+// Sets the AMASS level and ISR period of a segment with the given step period.
+static void set_segment_rate(volatile segment_t* prep_segment, uint32_t timerTicks) {
+    int level;
+    int max_level = st_prep_block->amass_max_level;
+
+    // Compute step timing and multi-axis smoothing level. Levels beyond what the axes need are
+    // still used when the step period would not otherwise fit in isrPeriod.
+    for (level = 0; level < maxAmassLevel; level++) {
+        if (timerTicks <= 0xffff && (timerTicks < amassThreshold || level >= max_level)) {
+            break;
+        }
+        timerTicks >>= 1;
+    }
+    prep_segment->amass_level = level;
+    prep_segment->n_step <<= level;
+    // isrPeriod is stored as 16 bits, so limit timerTicks to the
+    // largest value that will fit in a uint16_t.
+    prep_segment->isrPeriod = timerTicks > 0xffff ? 0xffff : timerTicks;
+}
+
+// Spreads the scanline of a raster block evenly along the block: sets the pixel at the start
+// of a segment that runs from mm_start to mm_end before the end of the block, and the pixels
+// per ISR tick, both in 16.16 fixed point.
+static void raster_segment(volatile segment_t* prep_segment, float mm_start, float mm_end) {
+    float pixels_per_mm       = float(st_prep_block->raster_length) / prep.raster_mm;
+    float start               = (prep.raster_mm - mm_start) * pixels_per_mm;
+    float end                 = (prep.raster_mm - mm_end) * pixels_per_mm;
+    prep_segment->raster_pos  = uint32_t(MAX(start, 0.0f) * 65536.0f);
+    prep_segment->raster_step = prep_segment->n_step ? uint32_t(MAX(end - start, 0.0f) * 65536.0f / prep_segment->n_step) : 0;
+}
+
+// Maps a ramp state to the motion phase reported to the motor drivers.  A synchronized block
+// has no velocity profile of its own, so it counts as cruising.
+static uint8_t segment_phase(uint8_t ramp_type) {
+    switch (ramp_type) {
+        case RAMP_ACCEL:
+        case RAMP_ACCEL_JERK_UP:
+        case RAMP_ACCEL_JERK_DOWN:
+            return uint8_t(Stepper::MotionPhase::Accel);
+        case RAMP_DECEL:
+        case RAMP_DECEL_OVERRIDE:
+        case RAMP_DECEL_JERK_UP:
+        case RAMP_DECEL_JERK_DOWN:
+            return uint8_t(Stepper::MotionPhase::Decel);
+        default:
+            return uint8_t(Stepper::MotionPhase::Cruise);
+    }
+}
+
+Stepper::MotionPhase Stepper::motion_phase() {
+    return MotionPhase(exec_phase);
+}
+
+void Stepper::set_mirror(SegmentMirror* segment_mirror) {
+    mirror = segment_mirror;
+}
+
+// Runs the Bresenham algorithm of the step ISR over the segment for the axes of the mirror.
+// Each ISR tick adds the increment to the counter and steps when it exceeds the event count,
+// so after the ticks of the segment the steps are the times the sum has passed it.
+static void mirror_segment(const volatile segment_t& segment) {
+    auto&    block       = st_block_buffer[segment.st_block_index];
+    uint32_t event_count = block.step_event_count;
+    auto     n_axis      = Axes::_numberAxis;
+    if (segment.st_block_index != prep.mirror_block_index) {
+        prep.mirror_block_index = segment.st_block_index;
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            prep.mirror_counter[axis] = event_count >> 1;
+        }
+    }
+    uint16_t steps[MAX_N_AXIS];
+    size_t   n = 0;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        if (!bitnum_is_true(mirror->axes, axis)) {
+            continue;
+        }
+        uint64_t sum   = prep.mirror_counter[axis] + uint64_t(segment.n_step) * (block.steps[axis] >> segment.amass_level);
+        uint32_t count = sum && event_count ? uint32_t((sum - 1) / event_count) : 0;
+        prep.mirror_counter[axis] = uint32_t(sum - uint64_t(count) * event_count);
+        steps[n++]                = uint16_t(count);
+    }
+    mirror->segment(prep.mirror_sequence++, segment.isrPeriod, segment.n_step, block.direction_bits, steps);
+}
+
+// Segment complete! Increment segment buffer indices, so stepper ISR can immediately execute it.
+static void publish_segment() {
+    if (mirror) {
+        mirror_segment(segment_buffer[segment_buffer_head]);
+    }
+    auto lastseg        = segment_next_head;
+    segment_next_head   = segment_next_head >= (Stepping::_segments - 1) ? 0 : segment_next_head + 1;
+    segment_buffer_head = lastseg;
+    prep.st_block_used  = true;
+}
+
+// Generates a segment that lets the shaped motion catch up with the unshaped motion, which has
+// come to rest. Returns false, without generating one, if there is nothing left to catch up.
+static bool shaper_tail_segment() {
+    if (shaper.max_delay == 0 || shaper.sync || shaper.idle >= shaper.max_delay) {
+        return false;
+    }
+    volatile segment_t* prep_segment = &segment_buffer[segment_buffer_head];
+
+    const uint32_t dt_ticks = uint32_t(DT_SEGMENT_RAMP * Machine::Stepping::fStepperTimer * 60);
+    SegmentTiming  timing;
+    shaper_segment(shaper.position, MIN(dt_ticks, shaper.max_delay - shaper.idle), prep_segment, timing);
+
+    prep_segment->n_step            = timing.n_step;
+    prep_segment->spindle_speed     = prep.current_spindle_speed;
+    prep_segment->spindle_dev_speed = spindle->mapSpeed(prep.spindle, prep.current_spindle_speed);
+    prep_segment->phase             = uint8_t(Stepper::MotionPhase::Decel);
+    set_segment_rate(prep_segment, timing.timer_ticks);
+    publish_segment();
+    return true;
+}
+
+// Generates the next segment of a dwell block, which waits without steps.  Segments are no
+// longer than cruise segments, so the queued ones do not hold up a feed hold.  The motion is
+// at rest, so a hold takes effect at once and the rest of the dwell runs after the resume.
+// Returns false, without a segment, if the segment generator has to stop for a hold.
+static bool dwell_segment() {
+    if (sys.step_control.executeHold) {
+        if (!(prep.recalculate_flag.parking)) {
+            prep.recalculate_flag.holdPartialBlock = 1;
+        }
+        sys.step_control.endMotion = true;
+        return false;
+    }
+    volatile segment_t* prep_segment = &segment_buffer[segment_buffer_head];
+    uint32_t            ms           = MIN(prep.dwell_remaining, uint32_t(1000 / CRUISE_TICKS_PER_SECOND));
+
+    // A rate adjusted laser is off at rest, as it is when the motion ends
+    SpindleSpeed speed = st_prep_block->is_pwm_rate_adjusted ? 0 : prep.spindle_speed;
+    if (prep.spindle == SpindleState::Disable) {
+        sys.spindle_speed = 0;
+        speed             = 0;
+    }
+    prep.current_spindle_speed          = speed;
+    sys.step_control.updateSpindleSpeed = false;
+
+    prep_segment->st_block_index    = prep.st_block_index;
+    prep_segment->n_step            = ms;
+    prep_segment->spindle_speed     = speed;
+    prep_segment->spindle_dev_speed = spindle->mapSpeed(prep.spindle, speed);
+    prep_segment->phase             = uint8_t(Stepper::MotionPhase::Idle);
+    set_segment_rate(prep_segment, DWELL_TICKS);
+
+    uint32_t segment_index = segment_buffer_head;
+    publish_segment();
+    prep.dwell_remaining -= ms;
+
+    rewind_point_t& point = rewind_points[segment_index];
+    point.block_count     = prep_block_count;
+    point.millimeters     = 0.0f;
+    point.prep            = prep;
+    if (prep.dwell_remaining == 0) {
+        pl_block = NULL;
+        plan_discard_current_block();
+    }
+    return true;
+}
+
+// Generates the next segment of a velocity jog, unless enough are queued.  Each axis moves
+// toward its commanded velocity at its acceleration, and toward zero when moving on would
+// not leave room to stop before a soft limit.  When following, the commanded velocity is the
+// fastest from which the axis can still stop at the goal.  The cartesian position is transformed
+// to the motors at the end of each segment, as for a kinematic line.  Returns false without a
+// segment; once the motion has come to rest with nothing more commanded, the jog ends.
+static bool velocity_segment() {
+    uint32_t tail = segment_buffer_tail;
+    if (segment_buffer_head != tail && next_segment_index(tail) != segment_buffer_head) {
+        return false;
+    }
+    bool stop = sys.step_control.executeHold || (vjog.timeout && xTaskGetTickCount() - vjog.updated > vjog.timeout);
+
+    auto  n_axis = Axes::_numberAxis;
+    float dt     = DT_SEGMENT_RAMP;
+    bool  moving = false;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        auto  a      = config->_axes->_axis[axis];
+        float accel  = a->_acceleration * 60.0f * 60.0f;  // mm/min^2
+        float speed  = vjog.speed[axis];
+        float target = stop ? 0.0f : vjog.target[axis];
+        float error  = vjog.goal[axis] - vjog.position[axis];
+        if (vjog.follow && !stop) {
+            target = copysignf(MIN(a->_maxRate, sqrtf(2.0f * accel * fabsf(error))), error);
+        }
+        if (a->_softLimits) {
+            // Where the axis would come to rest if it started braking after this segment
+            float rest = vjog.position[axis] + speed * dt + copysignf(0.5f * speed * speed / accel, speed);
+            if ((speed > 0.0f && rest >= limitsMaxPosition(axis)) || (target > 0.0f && vjog.position[axis] >= limitsMaxPosition(axis))) {
+                target = MIN(target, 0.0f);
+            }
+            if ((speed < 0.0f && rest <= limitsMinPosition(axis)) || (target < 0.0f && vjog.position[axis] <= limitsMinPosition(axis))) {
+                target = MAX(target, 0.0f);
+            }
+        }
+        float dv   = accel * dt;
+        float end  = target > speed ? MIN(speed + dv, target) : MAX(speed - dv, target);
+        float move = 0.5f * (speed + end) * dt;
+        if (vjog.follow && !stop && fabsf(move) >= fabsf(error) && (error == 0.0f || (move > 0.0f) == (error > 0.0f))) {
+            // Arrives within this segment; what is left of the speed is less than one
+            // segment of deceleration, so it stops there
+            move   = error;
+            end    = 0.0f;
+            target = 0.0f;
+        }
+        vjog.position[axis] += move;
+        if (a->_softLimits) {
+            vjog.position[axis] = MIN(MAX(vjog.position[axis], limitsMinPosition(axis)), limitsMaxPosition(axis));
+        }
+        vjog.speed[axis] = end;
+        moving           = moving || end != 0.0f || target != 0.0f;
+    }
+    if (!moving) {
+        vjog.active = false;
+        if (sys.step_control.executeHold) {
+            sys.step_control.endMotion = true;
+        }
+        return false;
+    }
+
+    // A point that the kinematics cannot reach stops the jog where it is
+    float cartesian[MAX_N_AXIS], motors[MAX_N_AXIS];
+    copyAxes(cartesian, vjog.position);
+    copyAxes(motors, vjog.position);
+    if (!config->_kinematics->transform_cartesian_to_motors(motors, cartesian)) {
+        vjog.active = false;
+        return false;
+    }
+    uint32_t steps[MAX_N_AXIS];
+    uint32_t step_event_count = 0;
+    uint8_t  direction_bits   = 0;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        int32_t motor = mpos_to_steps(motors[axis], axis);
+        int32_t delta = motor - vjog.emitted[axis];
+        steps[axis]   = labs(delta);
+        if (delta < 0) {
+            direction_bits |= bitnum_to_mask(axis);
+        }
+        step_event_count    = MAX(step_event_count, steps[axis]);
+        vjog.emitted[axis] = motor;
+    }
+
+    // As for a shaped segment, enough step events that the step period fits in isrPeriod
+    const uint32_t duration   = uint32_t(dt * Machine::Stepping::fStepperTimer * 60);
+    const uint32_t max_period = uint32_t(0xffff) << maxAmassLevel;
+    step_event_count          = MAX(step_event_count, (duration + max_period - 1) / max_period);
+    step_event_count          = MAX(step_event_count, uint32_t(1));
+
+    volatile segment_t* prep_segment = &segment_buffer[segment_buffer_head];
+    prep.st_block_used               = true;  // Every segment has a stepper block of its own
+    segment_st_block(prep_segment, steps, step_event_count, direction_bits);
+    st_prep_block->is_pwm_rate_adjusted = false;
+    st_prep_block->backlash_negative    = vjog.backlash_negative;
+    st_prep_block->line_number          = 0;
+    st_prep_block->raster_start         = vjog.raster_start;
+    st_prep_block->raster_length        = 0;
+    st_prep_block->sync_id              = 0;
+
+    prep_segment->n_step            = step_event_count;
+    prep_segment->spindle_speed     = vjog.spindle_speed;
+    prep_segment->spindle_dev_speed = spindle->mapSpeed(vjog.spindle, vjog.spindle_speed);
+    prep_segment->phase             = uint8_t(Stepper::MotionPhase::Cruise);
+    set_segment_rate(prep_segment, (duration + step_event_count - 1) / step_event_count);
+    publish_segment();
+    return true;
+}
+
+// Spindle-synchronized motion (G33). The block starts at a spindle index pulse, so each point
+// of its timeline, in minutes since that pulse, corresponds to a spindle position. The motion
+// accelerates until it moves at the feed per revolution, then follows the spindle with a fixed
+// lag: the distance lost while accelerating. The lag is the same for every pass at the same
+// spindle speed, so repeated passes cut the same thread. The spindle position at the end of
+// each segment is predicted from the position and speed that the encoder measures now, so each
+// segment corrects for speed changes since the previous one. Near the end of the block, the
+// motion decelerates to a stop.
+// Returns the distance from the end of the block time_var minutes later, shortening time_var
+// if the block ends sooner.
+static float sync_segment(float& time_var, float mm_remaining) {
+    Spindles::Encoder* encoder = spindle->_encoder;
+    float              accel   = pl_block->acceleration;
+    float              done    = prep.sync_length - mm_remaining;
+    float              rps     = encoder->revs_per_sec();
+    if (rps == 0.0f) {
+        rps = prep.spindle_speed / 60.0f;  // Not measured yet, so assume the programmed speed
+    }
+    if (prep.sync_speed == 0.0f) {
+        prep.sync_speed      = prep.sync_per_rev * rps * 60.0f;
+        prep.sync_accel_time = prep.sync_speed / accel;
+        prep.sync_lag        = 0.5f * prep.sync_speed * prep.sync_accel_time;
+    }
+
+    float end_time = prep.sync_time + time_var;
+    if (!prep.sync_decel) {
+        float target;
+        if (end_time < prep.sync_accel_time) {
+            target = 0.5f * accel * end_time * end_time;
+        } else {
+            float elapsed;  // Seconds since the index pulse, zero until the ISR has seen it
+            float revs = encoder->revolutions(prep.sync_id, elapsed);
+            target     = prep.sync_per_rev * (revs + rps * (end_time * 60.0f - elapsed)) - prep.sync_lag;
+        }
+        target = fmaxf(target, done);  // The spindle does not reverse, but its prediction can
+        if (prep.sync_length - target > prep.current_speed * prep.current_speed * 0.5f / accel) {
+            prep.current_speed = (target - done) / time_var;
+            prep.sync_time     = end_time;
+            return prep.sync_length - target;
+        }
+        prep.sync_decel = true;
+    }
+
+    float speed_var = accel * time_var;
+    if (prep.current_speed > speed_var) {
+        float target = done + time_var * (prep.current_speed - 0.5f * speed_var);
+        if (target < prep.sync_length) {
+            prep.current_speed -= speed_var;
+            prep.sync_time = end_time;
+            return prep.sync_length - target;
+        }
+    }
+    // At the end of the block
+    time_var           = 2.0f * mm_remaining / fmaxf(prep.current_speed, float(MINIMUM_FEED_RATE));
+    prep.current_speed = 0.0f;
+    prep.sync_time += time_var;
+    return 0.0f;
+}
+
 /* Prepares step segment buffer. Continuously called from main program.
 
    The segment buffer is an intermediary buffer interface between the execution of steps
@@ -384,12 +1650,47 @@ static uint8_t next_block_index(uint8_t block_index) {
    NOTE: Computation units are in steps, millimeters, and minutes.
 */
 void Stepper::prep_buffer() {
+    prep_lock();
+    fill_segment_buffer();
+    uint32_t head           = segment_buffer_head;
+    uint32_t tail           = segment_buffer_tail;
+    uint32_t segments_used  = head >= tail ? head - tail : head + Stepping::_segments - tail;
+    uint32_t planner_size   = config->_planner_blocks - 1;
+    PlannerStats::sample(planner_size - plan_get_block_buffer_available(), planner_size, segments_used, Stepping::_segments - 1);
+    prep_unlock();
+}
+
+static void fill_segment_buffer() {
     // Block step prep buffer, while in a suspend state and there is no suspend motion to execute.
     if (sys.step_control.endMotion) {
         return;
     }
 
-    while (segment_buffer_tail != segment_next_head) {  // Check if we need to fill the buffer.
+    // Fill the buffer up to the high watermark
+    while (segment_buffer_tail != segment_next_head) {
+        uint32_t head = segment_buffer_head;
+        uint32_t tail = segment_buffer_tail;
+        if ((head >= tail ? head - tail : head + Stepping::_segments - tail) >= prepHighWater) {
+            return;
+        }
+        if (vjog.active) {
+            if (!velocity_segment()) {
+                return;
+            }
+            continue;
+        }
+
+        if (shaper.stopping) {
+            // A feed hold has brought the unshaped motion to rest. End the motion once the shaped
+            // motion has come to rest too.
+            if (!shaper_tail_segment()) {
+                shaper.stopping            = false;
+                sys.step_control.endMotion = true;
+                return;
+            }
+            continue;
+        }
+
         // Determine if we need to load a new planner block or if the block needs to be recomputed.
         if (pl_block == NULL) {
             // Query planner for a queued block
@@ -400,8 +1701,30 @@ void Stepper::prep_buffer() {
             }
 
             if (pl_block == NULL) {
+                if (shaper_tail_segment()) {
+                    continue;  // The shaped motion is still catching up.
+                }
+                PlannerStats::starved();
                 return;  // No planner blocks. Exit.
             }
+            PlannerStats::fed();
+
+            // Pull in the per-block data that the segment loop needs, so that it does not have to
+            // reach into the planner side table for every segment.
+            plan_block_aux_t* pl_aux = plan_get_block_aux(pl_block);
+            prep.spindle             = pl_aux->spindle;
+            prep.spindle_speed       = pl_aux->spindle_speed;
+
+            if (sys.step_control.executeSysMotion) {
+                shaper.sync = true;  // Homing and parking are not shaped, and move the motors under the shaper.
+            } else if (shaper.sync && shaper.max_delay) {
+                shaper_sync(!prep.recalculate_flag.recalculate);
+            } else if ((pl_aux->spindle_sync > 0.0f || pl_block->is_dwell) && !prep.recalculate_flag.recalculate && shaper_tail_segment()) {
+                // Synchronized motion is not shaped either. It starts once the shaped motion has come to rest,
+                // as does a dwell.
+                pl_block = NULL;
+                continue;
+            }
 
             // Check if we need to only recompute the velocity profile or load a new block.
             if (prep.recalculate_flag.recalculate) {
@@ -412,6 +1735,7 @@ void Stepper::prep_buffer() {
                 }
             } else {
                 // Load the Bresenham stepping data for the block.
+                ++prep_block_count;
                 prep.st_block_index = next_block_index(prep.st_block_index);
                 // Prepare and copy Bresenham algorithm segment data from the new planner block, so that
                 // when the segment buffer completes the planner block, it may be discarded when the
@@ -427,32 +1751,77 @@ void Stepper::prep_buffer() {
                 for (idx = 0; idx < n_axis; idx++) {
                     st_prep_block->steps[idx] = pl_block->steps[idx] << maxAmassLevel;
                 }
-                st_prep_block->step_event_count = pl_block->step_event_count << maxAmassLevel;
+                st_prep_block->step_event_count  = pl_block->step_event_count << maxAmassLevel;
+                st_prep_block->amass_max_level   = amass_max_level(pl_block->steps, pl_block->step_event_count);
+                st_prep_block->backlash_negative = pl_aux->backlash_negative;
+                st_prep_block->line_number       = pl_aux->line_number;
+                st_prep_block->has_io            = pl_aux->io.digital_on || pl_aux->io.digital_off || pl_aux->io.analog;
+                if (st_prep_block->has_io) {
+                    st_block_io[prep.st_block_index] = pl_aux->io;
+                }
+                st_prep_block->raster_start   = pl_aux->raster.start;
+                st_prep_block->raster_length  = pl_aux->raster.length;
+                st_prep_block->latency_traced = pl_aux->latency_traced;
+                prep.raster_mm               = pl_aux->raster.millimeters;
+                prep.st_block_used = false;
+                if (shaper.max_delay && !sys.step_control.executeSysMotion) {
+                    shaper_load_block(pl_block);
+                    if (pl_aux->spindle_sync > 0.0f || pl_block->is_dwell) {
+                        shaper_skip_block();
+                    }
+                }
 
                 // Initialize segment buffer data for generating the segments.
-                prep.steps_remaining  = (float)pl_block->step_event_count;
-                prep.step_per_mm      = prep.steps_remaining / pl_block->millimeters;
-                prep.req_mm_increment = REQ_MM_INCREMENT_SCALAR / prep.step_per_mm;
-                prep.dt_remainder     = 0.0;  // Reset for new segment block
-                if ((sys.step_control.executeHold) || prep.recalculate_flag.decelOverride) {
-                    // New block loaded mid-hold. Override planner block entry speed to enforce deceleration.
-                    prep.current_speed                  = prep.exit_speed;
-                    pl_block->entry_speed_sqr           = prep.exit_speed * prep.exit_speed;
+                if (pl_block->is_dwell) {
+                    // At rest, whatever the block before planned to leave behind
+                    prep.dwell_remaining                = pl_aux->dwell_ms;
+                    prep.current_speed                  = 0.0f;
                     prep.recalculate_flag.decelOverride = 0;
                 } else {
-                    prep.current_speed = sqrtf(pl_block->entry_speed_sqr);
+                    prep.steps_remaining  = (float)pl_block->step_event_count;
+                    prep.step_per_mm      = prep.steps_remaining / pl_block->millimeters;
+                    prep.req_mm_increment = REQ_MM_INCREMENT_SCALAR / prep.step_per_mm;
+                    prep.dt_remainder     = 0.0;  // Reset for new segment block
+                    if ((sys.step_control.executeHold) || prep.recalculate_flag.decelOverride) {
+                        // New block loaded mid-hold. Override planner block entry speed to enforce deceleration.
+                        prep.current_speed                  = prep.exit_speed;
+                        pl_block->entry_speed_sqr           = prep.exit_speed * prep.exit_speed;
+                        prep.recalculate_flag.decelOverride = 0;
+                    } else {
+                        prep.current_speed = sqrtf(pl_block->entry_speed_sqr);
+                    }
                 }
 
                 // prep.inv_rate is only used if is_pwm_rate_adjusted is true
                 st_prep_block->is_pwm_rate_adjusted = false;  // set default value
 
                 if (spindle->isRateAdjusted()) {
-                    if (pl_block->spindle == SpindleState::Ccw) {
+                    if (prep.spindle == SpindleState::Ccw) {
                         // Pre-compute inverse programmed rate to speed up PWM updating per step segment.
                         prep.inv_rate                       = 1.0f / pl_block->programmed_rate;
                         st_prep_block->is_pwm_rate_adjusted = true;
                     }
                 }
+
+                prep.arc       = pl_block->is_arc || pl_block->is_kinematic;
+                prep.kinematic = pl_block->is_kinematic;
+                if (prep.arc) {
+                    prep.arc_geometry = pl_aux->arc;
+                    prep.arc_length   = pl_block->millimeters;
+                    copyAxes(prep.arc_steps, prep.arc_geometry.start_steps);
+                }
+
+                prep.sync_id = 0;
+                if (pl_aux->spindle_sync > 0.0f) {
+                    last_sync_id      = last_sync_id == UINT8_MAX ? 1 : last_sync_id + 1;
+                    prep.sync_id      = last_sync_id;
+                    prep.sync_per_rev = pl_aux->spindle_sync;
+                    prep.sync_length  = pl_block->millimeters;
+                    prep.sync_time    = 0.0f;
+                    prep.sync_speed   = 0.0f;  // Set when the first segment is prepped
+                    prep.sync_decel   = false;
+                }
+                st_prep_block->sync_id = prep.sync_id;
             }
             /* ---------------------------------------------------------------------------------
              Compute the velocity profile of a new planner block based on its entry and exit
@@ -462,7 +1831,14 @@ void Stepper::prep_buffer() {
             */
             prep.mm_complete  = 0.0;  // Default velocity profile complete at 0.0mm from end of block.
             float inv_2_accel = 0.5f / pl_block->acceleration;
-            if (sys.step_control.executeHold) {  // [Forced Deceleration to Zero Velocity]
+            if (pl_block->is_dwell) {  // [Dwell]
+                // No velocity profile; see dwell_segment()
+                prep.exit_speed = 0.0;
+            } else if (prep.sync_id) {  // [Spindle-Synchronized Motion]
+                // A feed hold takes effect at the end of the block, so as not to ruin the thread.
+                prep.ramp_type  = RAMP_SYNC;
+                prep.exit_speed = 0.0;
+            } else if (sys.step_control.executeHold) {  // [Forced Deceleration to Zero Velocity]
                 // Compute velocity profile parameters for a feed hold in-progress. This profile overrides
                 // the planner block profile, enforcing a deceleration to zero speed.
                 prep.ramp_type = RAMP_DECEL;
@@ -476,26 +1852,34 @@ void Stepper::prep_buffer() {
                     prep.exit_speed  = 0.0;
                 }
             } else {  // [Normal Operation]
-                // Initialize S-curve profile data
-                prep.use_s_curve = pl_block->use_s_curve;
-                prep.s_curve_phase = 0;
-                prep.s_curve_phase_time = 0.0f;
+                // Initialize S-curve profile data.  A block that continues an S-curve run keeps the
+                // phase state reached at the end of the previous block and picks up the run profile,
+                // which the planner has extended to cover this block.
+                bool continue_run = pl_block->use_s_curve && pl_block->s_curve_run && prep.use_s_curve && prep.s_curve_phase < 7;
+                prep.use_s_curve  = pl_block->use_s_curve;
+                if (!continue_run) {
+                    prep.s_curve_phase      = 0;
+                    prep.s_curve_phase_time = 0.0f;
+                }
                 prep.current_jerk = 0.0f;
                 if (prep.use_s_curve) {
                     for (int i = 0; i < 7; i++) {
-                        prep.s_curve_phases[i] = pl_block->s_curve_phases[i];
-                        prep.s_curve_distances[i] = pl_block->s_curve_distances[i];
+                        prep.s_curve_phases[i]    = pl_aux->s_curve_phases[i];
+                        prep.s_curve_distances[i] = pl_aux->s_curve_distances[i];
                     }
                     prep.current_jerk = pl_block->max_jerk;
                 }
-                
+
                 // Compute or recompute velocity profile parameters of the prepped planner block.
-                prep.ramp_type        = prep.use_s_curve ? RAMP_ACCEL_JERK_UP : RAMP_ACCEL;  // Initialize as acceleration ramp.
+                // Initialize as acceleration ramp.
+                prep.ramp_type        = prep.use_s_curve ? s_curve_ramp_type(prep.s_curve_phase) : RAMP_ACCEL;
                 prep.accelerate_until = pl_block->millimeters;
                 float exit_speed_sqr;
                 float nominal_speed;
                 if (sys.step_control.executeSysMotion) {
-                    prep.exit_speed = exit_speed_sqr = 0.0;  // Enforce stop at end of system motion.
+                    // Stop at the end of a system motion, unless its sequence goes on
+                    exit_speed_sqr  = plan_get_system_motion_exit_speed_sqr();
+                    prep.exit_speed = sqrtf(exit_speed_sqr);
                 } else {
                     exit_speed_sqr  = plan_get_exec_block_exit_speed_sqr();
                     prep.exit_speed = sqrtf(exit_speed_sqr);
@@ -555,40 +1939,56 @@ void Stepper::prep_buffer() {
             sys.step_control.updateSpindleSpeed = true;  // Force update whenever updating block.
         }
 
+        if (pl_block->is_dwell) {
+            if (!dwell_segment()) {
+                return;
+            }
+            continue;
+        }
+
         // Initialize new segment
         volatile segment_t* prep_segment = &segment_buffer[segment_buffer_head];
+        bool                shaped       = shaper.max_delay && !sys.step_control.executeSysMotion && !prep.sync_id;
 
         // Set new segment to point to the current segment data block.
         prep_segment->st_block_index = prep.st_block_index;
 
         /*------------------------------------------------------------------------------------
             Compute the average velocity of this new segment by determining the total distance
-          traveled over the segment time DT_SEGMENT. The following code first attempts to create
+          traveled over the segment time dt_max. The following code first attempts to create
           a full segment based on the current ramp conditions. If the segment time is incomplete
           when terminating at a ramp state change, the code will continue to loop through the
           progressing ramp states to fill the remaining segment execution time. However, if
           an incomplete segment terminates at the end of the velocity profile, the segment is
-          considered completed despite having a truncated execution time less than DT_SEGMENT.
+          considered completed despite having a truncated execution time less than dt_max.
+            The segment time is DT_SEGMENT_CRUISE for segments that start cruising and
+          DT_SEGMENT_RAMP otherwise. A cruise segment that reaches a ramp is shortened to
+          DT_SEGMENT_RAMP, so ramps are always traced at the finer time resolution. Shaped
+          motion always uses DT_SEGMENT_RAMP, since the shaped ramps lag the unshaped ones.
             The velocity profile is always assumed to progress through the ramp sequence:
           acceleration ramp, cruising state, and deceleration ramp. Each ramp's travel distance
           may range from zero to the length of the block. Velocity profiles can end either at
           the end of planner block (typical) or mid-block at the end of a forced deceleration,
           such as from a feed hold.
         */
-        float dt_max   = DT_SEGMENT;                                // Maximum segment time
-        float dt       = 0.0;                                       // Initialize segment time
-        float time_var = dt_max;                                    // Time worker variable
-        float mm_var;                                               // mm-Distance worker variable
-        float speed_var;                                            // Speed worker variable
-        float mm_remaining = pl_block->millimeters;                 // New segment distance from end of block.
-        float minimum_mm   = mm_remaining - prep.req_mm_increment;  // Guarantee at least one step.
+        float dt_max   = prep.ramp_type == RAMP_CRUISE && !shaped ? DT_SEGMENT_CRUISE : DT_SEGMENT_RAMP;  // Maximum segment time
+        float dt       = 0.0;                                                                             // Initialize segment time
+        float time_var = dt_max;                                                                          // Time worker variable
+        float mm_var;                                                                                     // mm-Distance worker variable
+        float speed_var;                                                                                  // Speed worker variable
+        float mm_remaining = pl_block->millimeters;                                                       // New segment distance from end of block.
+        float minimum_mm   = mm_remaining - prep.req_mm_increment;                                        // Guarantee at least one step.
 
         if (minimum_mm < 0.0) {
             minimum_mm = 0.0;
         }
 
         do {
+            bool jerk_ramp = prep.ramp_type >= RAMP_ACCEL_JERK_UP && prep.ramp_type <= RAMP_DECEL_JERK_DOWN;
             switch (prep.ramp_type) {
+                case RAMP_SYNC:
+                    mm_remaining = sync_segment(time_var, mm_remaining);
+                    break;
                 case RAMP_DECEL_OVERRIDE:
                     speed_var = pl_block->acceleration * time_var;
                     mm_var    = time_var * (prep.current_speed - 0.5f * speed_var);
@@ -758,7 +2158,21 @@ void Stepper::prep_buffer() {
                     prep.current_speed = prep.exit_speed;
             }
 
+            if (jerk_ramp && mm_remaining < prep.mm_complete) {
+                // Jerk ramps advance on phase time and can step past the end of the block. Give the
+                // overshoot back so that the rest of the phase carries into the next block of the run.
+                float overshoot_time    = (prep.mm_complete - mm_remaining) / fmaxf(prep.current_speed, float(MINIMUM_FEED_RATE));
+                time_var                = fmaxf(0.0f, time_var - overshoot_time);
+                prep.s_curve_phase_time = fmaxf(0.0f, prep.s_curve_phase_time - overshoot_time);
+                mm_remaining            = prep.mm_complete;
+            }
+
             dt += time_var;  // Add computed ramp time to total segment time.
+            if (prep.ramp_type != RAMP_CRUISE && dt_max > DT_SEGMENT_RAMP) {
+                // A long cruise segment ran into a ramp. Finish it at the ramp segment time, or
+                // right here if it is already longer, so the ramp is traced at the finer resolution.
+                dt_max = fmaxf(dt, DT_SEGMENT_RAMP);
+            }
             if (dt < dt_max) {
                 time_var = dt_max - dt;  // **Incomplete** At ramp junction.
             } else {
@@ -777,8 +2191,8 @@ void Stepper::prep_buffer() {
           Compute spindle speed PWM output for step segment
         */
         if (st_prep_block->is_pwm_rate_adjusted || sys.step_control.updateSpindleSpeed) {
-            if (pl_block->spindle != SpindleState::Disable) {
-                float speed = pl_block->spindle_speed;
+            if (prep.spindle != SpindleState::Disable) {
+                float speed = prep.spindle_speed;
                 // NOTE: Feed and rapid overrides are independent of PWM value and do not alter laser power/rate.
                 if (st_prep_block->is_pwm_rate_adjusted) {
                     speed *= (prep.current_speed * prep.inv_rate);
@@ -796,7 +2210,8 @@ void Stepper::prep_buffer() {
             sys.step_control.updateSpindleSpeed = false;
         }
         prep_segment->spindle_speed     = prep.current_spindle_speed;
-        prep_segment->spindle_dev_speed = spindle->mapSpeed(pl_block->spindle, prep.current_spindle_speed);  // Reload segment PWM value
+        prep_segment->spindle_dev_speed = spindle->mapSpeed(prep.spindle, prep.current_spindle_speed);  // Reload segment PWM value
+        prep_segment->phase             = segment_phase(prep.ramp_type);
 
         /* -----------------------------------------------------------------------------------
            Compute segment step rate, steps to execute, and apply necessary rate corrections.
@@ -808,65 +2223,82 @@ void Stepper::prep_buffer() {
            Fortunately, this scenario is highly unlikely and unrealistic in typical DIY CNC
            machines (i.e. exceeding 10 meters axis travel at 200 step/mm).
         */
-        float step_dist_remaining    = prep.step_per_mm * mm_remaining;                       // Convert mm_remaining to steps
-        float n_steps_remaining      = ceilf(step_dist_remaining);                            // Round-up current steps remaining
-        float last_n_steps_remaining = ceilf(prep.steps_remaining);                           // Round-up last steps remaining
-        prep_segment->n_step         = uint16_t(last_n_steps_remaining - n_steps_remaining);  // Compute number of steps to execute.
+        // Compute segment step rate. Since steps are integers and mm distances traveled are not,
+        // the end of every segment can have a partial step of varying magnitudes that are not
+        // executed, because the stepper ISR requires whole steps due to the AMASS algorithm. To
+        // compensate, we track the time to execute the previous segment's partial step and simply
+        // apply it with the partial step distance to the current segment, so that it minutely
+        // adjusts the whole segment rate to keep step output exact. These rate adjustments are
+        // typically very small and do not adversely effect performance, but ensures that the
+        // system outputs the exact acceleration and velocity profiles computed by the planner.
+        //
+        // fStepperTimer is in units of timerTicks/sec, so the dimensional analysis for the step
+        // period is timerTicks/sec * 60 sec/minute * minutes = timerTicks
+        float         step_dist_remaining = prep.step_per_mm * mm_remaining;  // Convert mm_remaining to steps
+        SegmentTiming timing;
+        dt += prep.dt_remainder;  // Apply previous segment partial step execute time
+        if (prep.arc) {
+            arc_segment_timing(mm_remaining, dt, prep_segment, timing, shaped);
+        } else if (USE_FIXED_POINT_SEGMENTS) {
+            segment_timing_fixed(prep.steps_remaining, step_dist_remaining, dt, Machine::Stepping::fStepperTimer * 60, timing);
+        } else {
+            segment_timing_float(prep.steps_remaining, step_dist_remaining, dt, Machine::Stepping::fStepperTimer * 60, timing);
+        }
+        prep_segment->n_step = timing.n_step;  // Compute number of steps to execute.
 
         // Bail if we are at the end of a feed hold and don't have a step to execute.
         if (prep_segment->n_step == 0) {
             if (sys.step_control.executeHold) {
                 // Less than one step to decelerate to zero speed, but already very close. AMASS
                 // requires full steps to execute. So, just bail.
-                sys.step_control.endMotion = true;
                 if (!(prep.recalculate_flag.parking)) {
                     prep.recalculate_flag.holdPartialBlock = 1;
                 }
+                if (shaped) {
+                    shaper.stopping = true;
+                    continue;  // Let the shaped motion come to rest first.
+                }
+                sys.step_control.endMotion = true;
                 return;  // Segment not generated, but current step data still retained.
             }
         }
-
-        // Compute segment step rate. Since steps are integers and mm distances traveled are not,
-        // the end of every segment can have a partial step of varying magnitudes that are not
-        // executed, because the stepper ISR requires whole steps due to the AMASS algorithm. To
-        // compensate, we track the time to execute the previous segment's partial step and simply
-        // apply it with the partial step distance to the current segment, so that it minutely
-        // adjusts the whole segment rate to keep step output exact. These rate adjustments are
-        // typically very small and do not adversely effect performance, but ensures that the
-        // system outputs the exact acceleration and velocity profiles computed by the planner.
-
-        dt += prep.dt_remainder;  // Apply previous segment partial step execute time
-        // dt is in minutes so inv_rate is in minutes
-        float inv_rate = dt / (last_n_steps_remaining - step_dist_remaining);  // Compute adjusted step rate inverse
-
-        // Compute CPU cycles per step for the prepped segment.
-        // fStepperTimer is in units of timerTicks/sec, so the dimensional analysis is
-        // timerTicks/sec * 60 sec/minute * minutes = timerTicks
-        uint32_t timerTicks = uint32_t(ceilf((Machine::Stepping::fStepperTimer * 60) * inv_rate));  // (timerTicks/step)
-        int      level;
-
-        // Compute step timing and multi-axis smoothing level.
-        for (level = 0; level < maxAmassLevel; level++) {
-            if (timerTicks < amassThreshold) {
-                break;
+        // An arc segment without steps is not executed; its time carries into the next segment.
+        bool publish = prep_segment->n_step != 0 || !prep.arc;
+        if (shaped) {
+            // Likewise a shaped segment without time, whose steps carry into the next segment.
+            uint32_t duration = timing.n_step * timing.timer_ticks;
+            if (prep.arc) {
+                duration = timing.n_step ? uint32_t(dt * float(Machine::Stepping::fStepperTimer * 60)) : 0;
+            }
+            publish = duration != 0;
+            if (publish) {
+                float target[MAX_N_AXIS];
+                shaper_target(timing, target);
+                shaper_segment(target, duration, prep_segment, timing);
+                prep_segment->n_step = timing.n_step;
             }
-            timerTicks >>= 1;
         }
-        prep_segment->amass_level = level;
-        prep_segment->n_step <<= level;
-        // isrPeriod is stored as 16 bits, so limit timerTicks to the
-        // largest value that will fit in a uint16_t.
-        prep_segment->isrPeriod = timerTicks > 0xffff ? 0xffff : timerTicks;
 
-        // Segment complete! Increment segment buffer indices, so stepper ISR can immediately execute it.
-        auto lastseg        = segment_next_head;
-        segment_next_head   = segment_next_head >= (Stepping::_segments - 1) ? 0 : segment_next_head + 1;
-        segment_buffer_head = lastseg;
+        set_segment_rate(prep_segment, timing.timer_ticks);  // (timerTicks/step)
+        if (st_prep_block->raster_length) {
+            raster_segment(prep_segment, pl_block->millimeters, mm_remaining);
+        }
+
+        uint32_t segment_index = segment_buffer_head;
+        if (publish) {
+            publish_segment();
+        }
 
         // Update the appropriate planner and segment data.
         pl_block->millimeters = mm_remaining;
-        prep.steps_remaining  = n_steps_remaining;
-        prep.dt_remainder     = (n_steps_remaining - step_dist_remaining) * inv_rate;
+        prep.steps_remaining  = timing.steps_remaining;
+        prep.dt_remainder     = timing.dt_remainder;
+        if (publish) {
+            rewind_point_t& point = rewind_points[segment_index];
+            point.block_count     = prep_block_count;
+            point.millimeters     = mm_remaining;
+            point.prep            = prep;
+        }
         // Check for exit conditions and flag to load next planner block.
         if (mm_remaining == prep.mm_complete) {
             // End of planner block or forced-termination. No more distance to be executed.
@@ -874,19 +2306,33 @@ void Stepper::prep_buffer() {
                 // Reset prep parameters for resuming and then bail. Allow the stepper ISR to complete
                 // the segment queue, where realtime protocol will set new state upon receiving the
                 // cycle stop flag from the ISR. Prep_segment is blocked until then.
-                sys.step_control.endMotion = true;
                 if (!(prep.recalculate_flag.parking)) {
                     prep.recalculate_flag.holdPartialBlock = 1;
                 }
+                if (shaped) {
+                    shaper.stopping = true;
+                    continue;  // Let the shaped motion come to rest first.
+                }
+                sys.step_control.endMotion = true;
                 return;  // Bail!
             } else {     // End of planner block
                 // The planner block is complete. All steps are set to be executed in the segment buffer.
                 if (sys.step_control.executeSysMotion) {
+                    if (!sys.step_control.executeHold && plan_next_system_motion_block()) {
+                        pl_block = NULL;
+                        continue;
+                    }
                     sys.step_control.endMotion = true;
                     return;
                 }
                 pl_block = NULL;  // Set pointer to indicate check and load next planner block.
                 plan_discard_current_block();
+                if (prep.sync_id && sys.step_control.executeHold) {
+                    // A feed hold during synchronized motion ends here, at rest.
+                    prep.sync_id               = 0;
+                    sys.step_control.endMotion = true;
+                    return;
+                }
             }
         }
     }
@@ -896,6 +2342,94 @@ void Stepper::prep_buffer() {
 // however is not exactly the current speed, but the speed computed in the last step segment
 // in the segment buffer. It will always be behind by up to the number of segment blocks (-1)
 // divided by the ACCELERATION TICKS PER SECOND in seconds.
+float Stepper::get_programmed_rate() {
+    plan_block_t* block = pl_block;
+    return block ? block->programmed_rate : 0.0f;
+}
+
+// Starts from rest, with the planner empty
+static void start_velocity_jog() {
+    memset(&vjog, 0, sizeof(vjog));
+    copyAxes(vjog.position, get_mpos());
+    get_motor_steps(vjog.emitted);
+    vjog.backlash_negative = Stepping::backlash_negative;
+    if (!st_prep_block) {
+        st_prep_block = &st_block_buffer[prep.st_block_index];
+    } else {
+        vjog.raster_start = st_prep_block->raster_start + st_prep_block->raster_length;
+    }
+    // A laser would burn along the path, so only a spindle that is not rate adjusted stays on
+    vjog.spindle       = spindle->isRateAdjusted() ? SpindleState::Disable : gc_state.modal.spindle;
+    vjog.spindle_speed = vjog.spindle == SpindleState::Disable ? 0 : SpindleSpeed(gc_state.spindle_speed);
+    shaper.sync        = true;  // The motors move under the shaper, as for homing
+    vjog.active        = true;
+    vjog.ran           = true;
+}
+
+void Stepper::velocity_jog(const float* velocity, uint32_t timeout_ms) {
+    prep_lock();
+    if (!vjog.active) {
+        start_velocity_jog();
+    }
+    auto n_axis = Axes::_numberAxis;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        vjog.target[axis] = velocity[axis];
+    }
+    vjog.timeout = timeout_ms / portTICK_PERIOD_MS;
+    vjog.updated = xTaskGetTickCount();
+    prep_unlock();
+}
+
+bool Stepper::follow_jog(const float* distance, bool start) {
+    prep_lock();
+    if (vjog.active ? !vjog.follow : !start) {
+        prep_unlock();
+        return false;
+    }
+    if (!vjog.active) {
+        start_velocity_jog();
+        vjog.follow = true;
+        copyAxes(vjog.goal, vjog.position);
+    }
+    auto n_axis = Axes::_numberAxis;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        vjog.goal[axis] += distance[axis];
+        if (config->_axes->_axis[axis]->_softLimits) {
+            vjog.goal[axis] = MIN(MAX(vjog.goal[axis], limitsMinPosition(axis)), limitsMaxPosition(axis));
+        }
+    }
+    prep_unlock();
+    return true;
+}
+
+bool Stepper::velocity_jog_active() {
+    return vjog.active;
+}
+
+bool Stepper::end_velocity_jog() {
+    prep_lock();
+    bool ran    = vjog.ran;
+    vjog.active = false;
+    vjog.ran    = false;
+    prep_unlock();
+    return ran;
+}
+
+void Stepper::set_z_offset(int32_t offset, uint32_t min_ticks) {
+    z_offset_min_ticks = min_ticks;
+    z_offset_target    = offset;
+}
+
+int32_t Stepper::get_z_offset() {
+    return z_offset;
+}
+
+void Stepper::clear_z_offset() {
+    z_offset_target = 0;
+    z_offset        = 0;
+    z_offset_ticks  = 0;
+}
+
 float Stepper::get_realtime_rate() {
     switch (sys.state) {
         case State::Cycle:
@@ -10,6 +10,8 @@
 */
 
 #include "EnumItem.h"
+#include "Config.h"  // MAX_N_AXIS
+#include "Types.h"   // AxisMask
 
 #include <cstdint>
 
@@ -17,6 +19,7 @@ namespace Stepper {
     void init();
 
     bool pulse_func();
+    bool pulse_train_func();  // Replaces pulse_func() when stepping/pulse_trains is set
 
     // Enable steppers, but cycle does not start unless called by motion control or realtime command.
     void wake_up();
@@ -30,6 +33,10 @@ namespace Stepper {
     // Reset the stepper subsystem variables
     void reset();
 
+    // Recomputes the input shaper impulses after an axis shaper setting changed.
+    // Only call it with the motion stopped.
+    void reload_shaper();
+
     // Changes the run state of the step segment buffer to execute the special parking motion.
     void parking_setup_buffer();
 
@@ -39,11 +46,138 @@ namespace Stepper {
     // Reloads step segment buffer. Called continuously by realtime execution system.
     void prep_buffer();
 
+    // True if segments are prepared by a dedicated task (stepping/prep_task).
+    bool prep_task_enabled();
+
+    // Asks the prep task to refill the segment buffer.
+    void wake_prep_task();
+
+    // Applies stepping/prep_high_water and prep_low_water.
+    void set_prep_watermarks();
+
+    // Serializes changes to planner blocks and prep state against the prep task.
+    // Recursive, and does nothing when the prep task is disabled.
+    void prep_lock();
+    void prep_unlock();
+
     // Called by planner_recalculate() when the executing block is updated by the new plan.
     bool update_plan_block_parameters();
 
+    // Called when a feed hold starts. Drops queued segments so that the deceleration begins with
+    // the segment after the executing one. Returns true if any segments were dropped.
+    bool rewind_for_hold();
+
     // Called by realtime status reporting if realtime rate reporting is enabled in config.h.
     float get_realtime_rate();
 
+    // Programmed rate of the block being prepped, zero if none (mm/min).
+    float get_programmed_rate();
+
+    // Ramp phase of the executing segment, so that motor drivers can change their current
+    // with it.  Idle when no segment is executing.
+    enum class MotionPhase : uint8_t { Idle, Accel, Cruise, Decel };
+    MotionPhase motion_phase();
+
+    // Torch height control.  The step ISR moves the Z motors toward offset steps from
+    // the planned position, at most one step per min_ticks stepper timer ticks, while
+    // the executing segment has no Z steps of its own.  The planner does not know about
+    // the offset: once it no longer applies, with the motion stopped, clear it and sync
+    // the planner and the parser to the motor position.
+    void    set_z_offset(int32_t offset, uint32_t min_ticks);
+    int32_t get_z_offset();
+    void    clear_z_offset();
+
+    // Velocity mode jogging, see jog_velocity().  While it is active the segment generator
+    // ignores the planner and ramps each axis toward velocity, in mm/min, at the axis
+    // acceleration, slowing down in time to stop at the soft limits.  At most two segments
+    // are queued, so a new velocity takes effect within a segment of the executing one.  It
+    // stops when the velocity is zero, on a feed hold or jog cancel, or when timeout_ms
+    // passes without a new velocity, unless timeout_ms is 0.
+    void velocity_jog(const float* velocity, uint32_t timeout_ms);
+    // Steers a velocity jog by position instead, for a handwheel: distance, in mm, is added to
+    // the position it goes to, and each axis moves there as fast as its max rate and acceleration
+    // allow, and stops.  With start, a jog starts if none is active.  Returns false if a jog that
+    // is steered by velocity is active, or without start if no jog is.
+    bool follow_jog(const float* distance, bool start);
+    bool velocity_jog_active();
+    // Called when the motion stops.  Ends the velocity jog, if one ran, and returns true if
+    // so, in which case the planner and parser positions must be synced to the motors.
+    bool end_velocity_jog();
+
+    // Step ISR timing and segment buffer statistics, in CPU cycles.
+    struct IsrStats {
+        static const int n_bins = 8;
+
+        uint32_t count;              // Measured calls of pulse_func()
+        uint32_t min_ticks;          // Shortest pulse_func() call
+        uint32_t max_ticks;          // Longest pulse_func() call
+        uint32_t max_io_ticks;       // Longest time spent in Stepping::step() and unstep()
+        uint32_t histogram[n_bins];  // pulse_func() durations in power-of-two microsecond bins
+        uint32_t underruns;          // Segment buffer ran empty in Cycle state with a block still in prep
+    };
+    void get_isr_stats(IsrStats& stats);
+    void reset_isr_stats();
+
+    // Segment trace for post-mortem analysis, recorded by the step ISR as each segment starts when
+    // stepping/trace_segments is nonzero. An alarm freezes it, so that it still holds the motion
+    // that led up to the alarm, until it is reset.
+    struct TraceEntry {
+        uint32_t time;               // CPU cycle counter
+        uint32_t segment;            // Count of segments executed since the trace was reset
+        int32_t  line_number;        // GCode line of the block the segment belongs to
+        int32_t  steps[MAX_N_AXIS];  // Motor positions at the start of the segment
+    };
+    size_t trace_count();
+    bool   get_trace_entry(size_t i, TraceEntry& entry);  // 0 is the oldest
+    void   freeze_trace();
+    void   reset_trace();
+
+    // GCode line of the block whose segment is executing, or 0 when none is, for the crash record
+    int32_t executing_line();
+
+    // Runs the queued segments the way the step ISR would, but on a virtual clock instead of
+    // the step timer and without driving the motors, for the step timeline of a simulation.
+    // time is in stepper timer ticks and is advanced by each ISR tick.  A step is reported at
+    // the tick that outputs it, one ISR tick after the tick that computes it.  Only call it
+    // while the step ISR is not running.  Returns the number of segments run.
+    class VirtualSink {
+    public:
+        virtual void segment(uint64_t time, uint32_t period, uint32_t ticks)  = 0;  // Start of a segment
+        virtual void step(uint64_t time, uint8_t step_bits, uint8_t dir_bits) = 0;
+    };
+    size_t run_virtual(uint64_t& time, VirtualSink& sink);
+
+    // Receives the segments of the axes that another controller steps, see Secondary.h.  The
+    // segment generator calls segment() as it queues each segment, with the steps that the
+    // step ISR will output in it for each axis of axes, in axis order, and rewind() and
+    // reset() as it drops queued segments.  The step ISR calls start() as each segment begins.
+    class SegmentMirror {
+    public:
+        AxisMask axes = 0;
+
+        virtual void segment(uint32_t sequence, uint32_t period, uint32_t ticks, uint8_t dir_bits, const uint16_t* steps) = 0;
+        virtual void rewind(uint32_t sequence) = 0;  // Drops the segments from sequence on
+        virtual void reset()                   = 0;  // Drops all segments; the next sequence is 0
+        virtual void start()                   = 0;  // In the step ISR
+    };
+    void set_mirror(SegmentMirror* mirror);
+
+    // Motor state captured by latch_position(), from which the position between steps is
+    // interpolated afterwards.  Raw integers, so that it can be taken in an ISR.
+    struct PositionLatch {
+        int32_t  steps[MAX_N_AXIS];      // Physical motor steps, as Stepping::getSteps()
+        uint32_t counter[MAX_N_AXIS];    // Bresenham counters
+        uint32_t increment[MAX_N_AXIS];  // Bresenham counter increment per ISR tick
+        uint32_t event_count;            // Bresenham step event count, zero if not interpolated
+        uint8_t  step_bits;              // Steps due at the next ISR tick
+        uint8_t  dir_bits;
+        uint32_t elapsed;                // CPU cycles since the last ISR tick
+        uint32_t period;                 // CPU cycles between ISR ticks
+    };
+    // Captures the motor position at the moment of the call. Can be called from an ISR.
+    void IRAM_ATTR latch_position(PositionLatch& latch);
+    // Returns in fraction the part of a step beyond latch.steps that each motor had moved.
+    void interpolate_latch(const PositionLatch& latch, float* fraction);
+
     extern uint32_t isr_count;
 }
@@ -5,6 +5,8 @@
 
 // Some useful constants.
 const float DT_SEGMENT              = (1.0f / (float(ACCELERATION_TICKS_PER_SECOND) * 60.0f));  // min/segment
+const float DT_SEGMENT_RAMP         = (1.0f / (float(RAMP_TICKS_PER_SECOND) * 60.0f));          // min/segment while accelerating
+const float DT_SEGMENT_CRUISE       = (1.0f / (float(CRUISE_TICKS_PER_SECOND) * 60.0f));        // min/segment while cruising
 const float REQ_MM_INCREMENT_SCALAR = 1.25f;
 const int   RAMP_ACCEL              = 0;
 const int   RAMP_CRUISE             = 1;
@@ -15,6 +17,15 @@ const int   RAMP_ACCEL_JERK_UP      = 4;  // Jerk-limited acceleration start
 const int   RAMP_ACCEL_JERK_DOWN    = 5;  // Jerk-limited acceleration end
 const int   RAMP_DECEL_JERK_UP      = 6;  // Jerk-limited deceleration start
 const int   RAMP_DECEL_JERK_DOWN    = 7;  // Jerk-limited deceleration end
+// Spindle-synchronized motion (G33), which follows the spindle instead of a velocity profile
+const int RAMP_SYNC = 8;
+
+// While a synchronized block waits for its spindle index pulse, the stepper ISR checks for
+// it this often, in timer ticks.  This is the uncertainty of the start of the motion.
+const uint32_t SYNC_WAIT_TICKS = Machine::Stepping::fStepperTimer / 100000;  // 10 us
+
+// A dwell block is timed by ISR ticks of a millisecond, without steps
+const uint32_t DWELL_TICKS = Machine::Stepping::fStepperTimer / 1000;
 
 struct PrepFlag {
     uint8_t recalculate : 1;
@@ -36,3 +47,10 @@ struct PrepFlag {
 
 const uint32_t amassThreshold = Machine::Stepping::fStepperTimer / 8000;
 const int      maxAmassLevel  = 3;  // Each level increase doubles the threshold
+
+// AMASS is decided per axis. Smoothing only helps an axis that steps in between the dominant axis
+// steps, and only while the one-tick jitter of its steps is a noticeable part of its own step
+// period. An axis that is stationary, steps with the dominant axis, or moves slowly relative to it
+// needs no smoothing, so a block is smoothed only up to the highest level any of its axes needs.
+// An axis needs a level while its step rate is above 1/2^amassJitterShift of the ISR rate.
+const int amassJitterShift = 3;
@@ -2,12 +2,19 @@
 #include "EnumItem.h"
 #include "Stepping.h"
 #include "Machine/MachineConfig.h"  // config
+#include "Driver/delay_usecs.h"     // getCpuTicks()
 
 #include <atomic>
+#include <algorithm>  // std::max
 
 step_engine_t* step_engines = NULL;  // Linked list of stepping engines
 
 step_engine_t* find_engine(const char* name) {
+    for (step_engine_t* p = step_engines; p; p = p->link) {
+        if (strcmp(name, p->name) == 0) {
+            return p;
+        }
+    }
     for (step_engine_t* p = step_engines; p; p = p->link) {
         // Initial substring match, handles different forms of I2S
         if (strncmp(name, p->name, strlen(p->name)) == 0) {
@@ -28,6 +35,11 @@ namespace Machine {
 
     bool   Stepping::_switchedStepper = false;
     size_t Stepping::_segments        = 12;
+    size_t Stepping::_prepHighWater   = 0;
+    size_t Stepping::_prepLowWater    = 0;
+    bool   Stepping::_prepTask        = false;
+    bool   Stepping::_pulseTrains     = false;
+    size_t Stepping::_traceSegments   = 0;
 
     uint32_t Stepping::_idleMsecs           = 255;
     uint32_t Stepping::_pulseUsecs          = 4;
@@ -42,18 +54,55 @@ namespace Machine {
                                    { Stepping::I2S_STREAM, "I2S_STREAM" },
                                    EnumItem(Stepping::RMT_ENGINE) };
 
+    // The settings that init() applied to the step engine and the step buffers.
+    // The buffers are sized by segments and the engine sets up its pins with the
+    // pulse timing, so changing them takes a restart.
+    static struct {
+        bool     valid;
+        int      engine;
+        uint32_t pulse_us;
+        uint32_t dir_delay_us;
+        size_t   segments;
+        bool     prep_task;
+        bool     pulse_trains;
+        size_t   trace_segments;
+    } applied;
+
     void Stepping::afterParse() {
+        if (applied.valid) {
+            // A runtime setting; idle_ms and disable_delay_us are read where they are used
+            if (_engine != applied.engine || _pulseUsecs != applied.pulse_us || _directionDelayUsecs != applied.dir_delay_us ||
+                _segments != applied.segments || _prepTask != applied.prep_task || _pulseTrains != applied.pulse_trains ||
+                _traceSegments != applied.trace_segments) {
+                _engine              = applied.engine;
+                _pulseUsecs          = applied.pulse_us;
+                _directionDelayUsecs = applied.dir_delay_us;
+                _segments            = applied.segments;
+                _prepTask            = applied.prep_task;
+                _pulseTrains         = applied.pulse_trains;
+                _traceSegments       = applied.trace_segments;
+                log_warn("Change stepping engine, timing, segments and trace in the config file; they take effect after a restart");
+            }
+            Stepper::set_prep_watermarks();
+            return;
+        }
+
         const char* name = stepTypes[_engine].name;
         step_engine      = find_engine(name);
         Assert(step_engine, "Cannot find stepping engine for %s", name);
         Assert(strcmp("I2S", name) || config->_i2so, "I2SO bus must be configured for this stepping type");
+        if (_pulseTrains && !step_engine->step_train) {
+            log_warn("Stepping engine " << name << " does not support pulse_trains");
+            _pulseTrains = false;
+        }
     }
 
     void Stepping::init() {
         log_info("Stepping:" << stepTypes[_engine].name << " Pulse:" << _pulseUsecs << "us Dsbl Delay:" << _disableDelayUsecs
                              << "us Dir Delay:" << _directionDelayUsecs << "us Idle Delay:" << _idleMsecs << "ms");
 
-        uint32_t actual = step_engine->init(_directionDelayUsecs, _pulseUsecs, fStepperTimer, Stepper::pulse_func);
+        auto     isr    = _pulseTrains ? Stepper::pulse_train_func : Stepper::pulse_func;
+        uint32_t actual = step_engine->init(_directionDelayUsecs, _pulseUsecs, fStepperTimer, isr);
         if (actual != _pulseUsecs) {
             log_warn("stepping/pulse_us adjusted to " << actual);
         }
@@ -63,23 +112,38 @@ namespace Machine {
         //        i2s_out_set_pulse_callback(Stepper::pulse_func);
 
         Stepper::init();
+
+        applied = { true, _engine, _pulseUsecs, _directionDelayUsecs, _segments, _prepTask, _pulseTrains, _traceSegments };
     }
 
 }
 
 Stepping::motor_t* Stepping::axis_motors[MAX_N_AXIS][MAX_MOTORS_PER_AXIS] = { nullptr };
 
+Stepping::motor_t  Stepping::_motors[MAX_MOTORS];
+int                Stepping::_n_motors = 0;
+Stepping::motor_t* Stepping::_stepping[MAX_MOTORS];
+int                Stepping::_n_stepping      = 0;
+volatile bool      Stepping::_steppingChanged = false;
+bool               Stepping::_dirPending      = false;
+
 void Stepping::assignMotor(int axis, int motor, int step_pin, bool step_invert, int dir_pin, bool dir_invert) {
     step_pin = step_engine->init_step_pin(step_pin, step_invert);
 
-    motor_t* m               = new motor_t;
-    axis_motors[axis][motor] = m;
-    m->step_pin              = step_pin;
-    m->step_invert           = step_invert;
-    m->dir_pin               = dir_pin;
-    m->dir_invert            = dir_invert;
-    m->blocked               = false;
-    m->limited               = false;
+    motor_t* m = axis_motors[axis][motor];
+    if (!m) {
+        m                        = &_motors[_n_motors++];
+        axis_motors[axis][motor] = m;
+    }
+    m->step_pin    = step_pin;
+    m->step_invert = step_invert;
+    m->dir_pin     = dir_pin;
+    m->dir_invert  = dir_invert;
+    m->axis        = axis;
+    m->blocked     = false;
+    m->limited     = false;
+
+    _steppingChanged = true;
 
     if (motor == 0 && dir_invert) {
         set_bitnum(direction_mask, axis);
@@ -88,39 +152,55 @@ void Stepping::assignMotor(int axis, int motor, int step_pin, bool step_invert,
 
 int Stepping::axis_steps[MAX_N_AXIS] = { 0 };
 
-bool* Stepping::limit_var(int axis, int motor) {
-    auto m = axis_motors[axis][motor];
-    return m ? &(m->limited) : nullptr;
-}
+volatile AxisMask Stepping::backlash_negative = 0;
 
+// The flag is set after the motor state, and cleared by rebuildStepping() before it reads
+// any, so a change made during a rebuild is picked up by the next one.
 void Stepping::block(int axis, int motor) {
     auto m = axis_motors[axis][motor];
     if (m) {
-        m->blocked = true;
+        m->blocked       = true;
+        _steppingChanged = true;
     }
 }
 
 void Stepping::unblock(int axis, int motor) {
     auto m = axis_motors[axis][motor];
     if (m) {
-        m->blocked = false;
+        m->blocked       = false;
+        _steppingChanged = true;
     }
 }
 
-void Stepping::limit(int axis, int motor) {
+void IRAM_ATTR Stepping::limit(int axis, int motor) {
     auto m = axis_motors[axis][motor];
     if (m) {
-        m->limited = true;
+        m->limited       = true;
+        _steppingChanged = true;
     }
 }
-void Stepping::unlimit(int axis, int motor) {
+void IRAM_ATTR Stepping::unlimit(int axis, int motor) {
     auto m = axis_motors[axis][motor];
     if (m) {
-        m->limited = false;
+        m->limited       = false;
+        _steppingChanged = true;
     }
 }
 
-void IRAM_ATTR Stepping::step(uint8_t step_mask, uint8_t dir_mask) {
+// Only called by the step ISR, which is the only reader of the list
+void IRAM_ATTR Stepping::rebuildStepping() {
+    _steppingChanged = false;
+    int n            = 0;
+    for (int i = 0; i < _n_motors; i++) {
+        motor_t* m = &_motors[i];
+        if (!m->blocked && !m->limited) {
+            _stepping[n++] = m;
+        }
+    }
+    _n_stepping = n;
+}
+
+void IRAM_ATTR Stepping::set_directions(uint8_t dir_mask) {
     // Set the direction pins, but optimize for the common
     // situation where the direction bits haven't changed.
     static uint8_t previous_dir_mask = 255;  // should never be this value
@@ -141,28 +221,75 @@ void IRAM_ATTR Stepping::step(uint8_t step_mask, uint8_t dir_mask) {
                     }
                 }
             }
-            // Some stepper drivers need time between changing direction and doing a pulse.
-            step_engine->finish_dir();
         }
+        // Some stepper drivers need time between changing direction and doing a pulse.
+        step_engine->finish_dir();
+        _dirPending       = step_engine->wait_dir != NULL;
         previous_dir_mask = dir_mask;
     }
+}
+
+// With an engine that can wait for the rest of the direction delay later, the direction
+// pins for the next pulse change right after the previous pulse, so the delay runs
+// during the time between them instead of in front of the next pulse.
+void IRAM_ATTR Stepping::prepare_directions(uint8_t dir_mask) {
+    if (step_engine->wait_dir) {
+        set_directions(dir_mask);
+    }
+}
 
+void IRAM_ATTR Stepping::wait_directions() {
+    if (_dirPending) {
+        _dirPending = false;
+        step_engine->wait_dir();
+    }
+}
+
+void IRAM_ATTR Stepping::step(uint8_t step_mask, uint8_t dir_mask) {
+    set_directions(dir_mask);
+    wait_directions();
+
+    if (_steppingChanged) {
+        rebuildStepping();
+    }
     step_engine->start_step();
 
     // Turn on step pulses for motors that are supposed to step now
+    for (int i = 0; i < _n_stepping; i++) {
+        auto m = _stepping[i];
+        if (bitnum_is_true(step_mask, m->axis)) {
+            step_engine->set_step_pin(m->step_pin, !m->step_invert);
+        }
+    }
+    step_engine->finish_step();
+
     for (size_t axis = 0; axis < Axes::_numberAxis; axis++) {
         if (bitnum_is_true(step_mask, axis)) {
-            auto increment = bitnum_is_true(dir_mask, axis) ? -1 : 1;
-            axis_steps[axis] += increment;
-            for (size_t motor = 0; motor < MAX_MOTORS_PER_AXIS; motor++) {
-                auto m = axis_motors[axis][motor];
-                if (m && !m->blocked && !m->limited) {
-                    step_engine->set_step_pin(m->step_pin, !m->step_invert);
-                }
-            }
+            axis_steps[axis] += bitnum_is_true(dir_mask, axis) ? -1 : 1;
         }
     }
-    step_engine->finish_step();
+}
+
+// Emit the step pulses of one pulse train. For each axis, offsets holds counts[axis] step
+// times in units of tick_period timer ticks from now.
+void IRAM_ATTR Stepping::step_train(const uint8_t offsets[][STEP_TRAIN_MAX_TICKS], const int* counts, uint8_t dir_mask, uint32_t tick_period) {
+    set_directions(dir_mask);
+    wait_directions();
+    if (_steppingChanged) {
+        rebuildStepping();
+    }
+
+    for (int i = 0; i < _n_stepping; i++) {
+        auto m     = _stepping[i];
+        int  count = counts[m->axis];
+        if (count) {
+            step_engine->step_train(m->step_pin, offsets[m->axis], count, tick_period);
+        }
+    }
+    for (size_t axis = 0; axis < Axes::_numberAxis; axis++) {
+        int count = counts[axis];
+        axis_steps[axis] += bitnum_is_true(dir_mask, axis) ? -count : count;
+    }
 }
 
 // Turn all stepper pins off
@@ -170,20 +297,34 @@ void IRAM_ATTR Stepping::unstep() {
     if (step_engine->start_unstep()) {
         return;
     }
-    for (size_t axis = 0; axis < Axes::_numberAxis; axis++) {
-        for (size_t motor = 0; motor < MAX_MOTORS_PER_AXIS; motor++) {
-            auto m = axis_motors[axis][motor];
-            if (m) {
-                step_engine->set_step_pin(m->step_pin, m->step_invert);
-            }
-        }
+    for (int i = 0; i < _n_motors; i++) {
+        auto m = &_motors[i];
+        step_engine->set_step_pin(m->step_pin, m->step_invert);
     }
     step_engine->finish_unstep();
 }
 
 void Stepping::reset() {}
-void Stepping::beginLowLatency() {}
-void Stepping::endLowLatency() {}
+
+// Homing and probing stop on a switch, so the time that a step spends between the
+// stepper ISR and the pin is distance travelled after the switch trips.  Engines
+// with deep output buffers can shorten it meanwhile, without restarting.
+void Stepping::beginLowLatency() {
+    if (_switchedStepper || !step_engine->set_low_latency) {
+        return;
+    }
+    uint32_t latency_us = step_engine->set_low_latency(true);
+    _switchedStepper    = true;
+    log_debug("Stepping: low latency " << latency_us << "us");
+}
+void Stepping::endLowLatency() {
+    if (!_switchedStepper) {
+        return;
+    }
+    uint32_t latency_us = step_engine->set_low_latency(false);
+    _switchedStepper    = false;
+    log_debug("Stepping: latency " << latency_us << "us");
+}
 
 // Called only from Stepper::pulse_func when a new segment is loaded
 // The argument is in units of ticks of the timer that generates ISRs
@@ -207,9 +348,48 @@ void Stepping::group(Configuration::HandlerBase& handler) {
     handler.item("pulse_us", _pulseUsecs, 0, 30);
     handler.item("dir_delay_us", _directionDelayUsecs, 0, 10);
     handler.item("disable_delay_us", _disableDelayUsecs, 0, 1000000);  // max 1 second
-    handler.item("segments", _segments, 6, 20);
+    handler.item("segments", _segments, 6, 255);
+    handler.item("prep_high_water", _prepHighWater, 0, 255);
+    handler.item("prep_low_water", _prepLowWater, 0, 255);
+    handler.item("prep_task", _prepTask);
+    handler.item("pulse_trains", _pulseTrains);
+    handler.item("trace_segments", _traceSegments, 0, 1024);
 }
 
 uint32_t Stepping::maxPulsesPerSec() {
     return step_engine->max_pulses_per_sec();
 }
+
+// Pin writes are left out because an RMT channel fires a pulse on any write, so the
+// result is the engine overhead and pulse timing that every step event pays.  The
+// events keep their schedule when one is late, so an engine that cannot keep up
+// falls further behind and every later event counts as an overrun.
+void Stepping::bench(uint32_t rate, uint32_t events, BenchStats& stats) {
+    stats        = {};
+    stats.events = events;
+
+    int32_t  period     = int32_t(uint64_t(ticks_per_us) * 1000000 / rate);
+    uint64_t total      = 0;
+    int32_t  next_event = getCpuTicks() + period;
+
+    for (uint32_t i = 0; i < events; i++, next_event += period) {
+        int32_t now;
+        while ((now = getCpuTicks()) - next_event < 0) {}
+
+        step_engine->start_step();
+        step_engine->finish_step();
+        if (!step_engine->start_unstep()) {
+            step_engine->finish_unstep();
+        }
+
+        uint32_t late = now - next_event;
+        uint32_t cost = getCpuTicks() - now;
+        total += cost;
+        stats.max_ticks      = std::max(stats.max_ticks, cost);
+        stats.max_late_ticks = std::max(stats.max_late_ticks, late);
+        if (int32_t(late + cost) > period) {
+            ++stats.overruns;
+        }
+    }
+    stats.mean_ticks = events ? uint32_t(total / events) : 0;
+}
@@ -13,24 +13,40 @@ namespace Machine {
         // fStepperTimer should be an integer divisor of the bus speed, i.e. of fTimers
         static const uint32_t fStepperTimer = 20000000;  // frequency of step pulse timer
     private:
-        static bool    _switchedStepper;
+        static bool    _switchedStepper;  // In low latency mode for homing or probing
         static int32_t _stepPulseEndTime;
         static int     _i2sPulseCounts;
 
         static const int MAX_MOTORS_PER_AXIS = 2;
+        static const int MAX_MOTORS          = MAX_N_AXIS * MAX_MOTORS_PER_AXIS;
         struct motor_t {
-            int  step_pin;
-            int  dir_pin;
-            bool step_invert;
-            bool dir_invert;
-            bool blocked;
-            bool limited;
+            int           step_pin;
+            int           dir_pin;
+            bool          step_invert;
+            bool          dir_invert;
+            uint8_t       axis;
+            volatile bool blocked;
+            volatile bool limited;
         };
         static motor_t* axis_motors[MAX_N_AXIS][MAX_MOTORS_PER_AXIS];
         static int      _n_active_axes;
 
+        // The motors in the order they were assigned, and those of them that are neither
+        // blocked nor limited, which step() and step_train() walk.  Blocking and limiting set
+        // _steppingChanged, and the step ISR rebuilds the list before its next pulse, so the
+        // list only changes in the ISR and the pulses do not test every motor.
+        static motor_t       _motors[MAX_MOTORS];
+        static int           _n_motors;
+        static motor_t*      _stepping[MAX_MOTORS];
+        static int           _n_stepping;
+        static volatile bool _steppingChanged;
+
+        static void rebuildStepping();
+
         static void    startPulseTimer();
-        static void    waitDirection();  // Wait for direction delay
+        static void    set_directions(uint8_t dir_mask);
+        static void    wait_directions();  // For the rest of the direction delay, see step_engine_t::wait_dir
+        static bool    _dirPending;        // The engine has a direction delay to wait out
         static int32_t axis_steps[MAX_N_AXIS];
 
         static step_engine_t* step_engine;
@@ -47,13 +63,37 @@ namespace Machine {
 
         // _segments is the number of entries in the step segment buffer between the step execution algorithm
         // and the planner blocks. Each segment is set of steps executed at a constant velocity over a
-        // fixed time defined by ACCELERATION_TICKS_PER_SECOND. They are computed such that the planner
-        // block velocity profile is traced exactly. The size of this buffer governs how much step
-        // execution lead time there is for other processes to run.  The latency for a feedhold or other
-        // override is roughly 10 ms times _segments.
+        // time defined by RAMP_TICKS_PER_SECOND or CRUISE_TICKS_PER_SECOND. They are computed such that
+        // the planner block velocity profile is traced exactly. The size of this buffer governs how much
+        // step execution lead time there is for other processes to run.  A feedhold drops the queued
+        // segments of the executing block and starts decelerating within two segments; the latency of
+        // other overrides is roughly the cruise segment time (20 ms) times _prepHighWater.
+        // The ring that the step ISR reads is kept in internal RAM; the feedhold rewind state
+        // that goes with each segment, which is much larger, is put in PSRAM if there is some.
 
         static size_t _segments;
 
+        // Segment preparation stops when _prepHighWater segments are queued, which bounds the
+        // override latency of a large buffer, and the prep task is woken when fewer than
+        // _prepLowWater are.  0 means the defaults, a full buffer and half of it.  They are
+        // runtime settings.
+        static size_t _prepHighWater;
+        static size_t _prepLowWater;
+
+        // When _prepTask is set, segments are prepared by a dedicated task that the step ISR
+        // wakes whenever the segment buffer drops below the low watermark, instead of only
+        // from the protocol loop.
+        static bool _prepTask;
+
+        // When _pulseTrains is set and the engine supports it, the step ISR runs once per train
+        // of up to STEP_TRAIN_MAX_TICKS step events, which the engine times in hardware, instead
+        // of once per step event.
+        static bool _pulseTrains;
+
+        // _traceSegments is the number of entries in the segment trace, see $Stepper/Trace.
+        // Each entry takes 12 bytes plus 4 per axis; 0 disables the trace.
+        static size_t _traceSegments;
+
         static uint32_t _idleMsecs;
         static uint32_t _pulseUsecs;
         static uint32_t _directionDelayUsecs;
@@ -64,6 +104,11 @@ namespace Machine {
         // Interfaces to stepping engine
         static void init();
 
+        // Backlash state of the block being executed, see plan_buffer_line(). The motors of
+        // these axes last moved in the negative direction, so they are the backlash behind
+        // the logical position.
+        static volatile AxisMask backlash_negative;
+
         static uint32_t getSteps(int axis) { return axis_steps[axis]; }
         static void     setSteps(int axis, uint32_t steps) { axis_steps[axis] = steps; }
 
@@ -75,11 +120,12 @@ namespace Machine {
 
         static void step(uint8_t step_mask, uint8_t dir_mask);
         static void unstep();
+        static void prepare_directions(uint8_t dir_mask);  // For the next step(), after unstep()
+        static void step_train(const uint8_t offsets[][STEP_TRAIN_MAX_TICKS], const int* counts, uint8_t dir_mask, uint32_t tick_period);
 
-        // Used to stop a motor quickly when a limit switch is hit
-        static bool* limit_var(int axis, int motor);
-        static void  limit(int axis, int motor);
-        static void  unlimit(int axis, int motor);
+        // Used to stop a motor quickly when a limit switch is hit.  Safe to call from an ISR.
+        static void limit(int axis, int motor);
+        static void unlimit(int axis, int motor);
 
         // Used to stop a motor during ganged homint
         static void block(int axis, int motor);
@@ -87,6 +133,19 @@ namespace Machine {
 
         static uint32_t maxPulsesPerSec();
 
+        // Result of bench(), in CPU ticks
+        struct BenchStats {
+            uint32_t events;
+            uint32_t mean_ticks;      // Engine work per step event
+            uint32_t max_ticks;       // Most engine work for one event
+            uint32_t max_late_ticks;  // Worst delay of an event past its scheduled time
+            uint32_t overruns;        // Events that did not finish within their period
+        };
+
+        // Runs the engine's per-event work for events step events paced at rate events per
+        // second, in the calling task, without asserting any step pin.  The motion must be idle.
+        static void bench(uint32_t rate, uint32_t events, BenchStats& stats);
+
         static AxisMask direction_mask;
 
         // Timers
@@ -14,10 +14,12 @@
 
 #include <cstring>  // memset
 #include <cmath>    // roundf
+#include <mutex>
 
 // Declare system global variable structure
 system_t sys;
-int32_t  probe_steps[MAX_N_AXIS];  // Last probe position in steps.
+int32_t  probe_steps[MAX_N_AXIS];     // Last probe position in steps.
+float    probe_fraction[MAX_N_AXIS];  // Part of a step beyond probe_steps
 
 void system_reset() {
     // Reset system variables.
@@ -27,9 +29,11 @@ void system_reset() {
     set_state(prior_state);
     sys.abort             = prior_abort;
     sys.f_override        = FeedOverride::Default;          // Set to 100%
+    sys.f_adaptive        = 100;                            // No reduction
     sys.r_override        = RapidOverride::Default;         // Set to 100%
     sys.spindle_speed_ovr = SpindleSpeedOverride::Default;  // Set to 100%
     memset(probe_steps, 0, sizeof(probe_steps));            // Clear probe position.
+    memset(probe_fraction, 0, sizeof(probe_fraction));
     report_ovr_counter = 0;
     report_wco_counter = 0;
 }
@@ -51,8 +55,15 @@ void motor_steps_to_mpos(float* position, int32_t* steps) {
     config->_kinematics->motors_to_cartesian(position, motor_mpos, n_axis);
 }
 
+// Motor steps are logical positions. The motors of axes whose backlash is taken up in the
+// negative direction are physically the backlash behind them.
+static int32_t backlash_offset(size_t axis) {
+    return bitnum_is_true(Stepping::backlash_negative, axis) ? Axes::_axis[axis]->backlashSteps() : 0;
+}
+
 void set_motor_steps(size_t axis, int32_t steps) {
-    Stepping::setSteps(axis, steps);
+    Stepping::setSteps(axis, steps - backlash_offset(axis));
+    Machine::MotorEncoder::resync(axis);
 }
 
 void set_motor_steps_from_mpos(float* mpos) {
@@ -65,14 +76,30 @@ void set_motor_steps_from_mpos(float* mpos) {
 }
 
 int32_t get_axis_motor_steps(size_t axis) {
-    return Stepping::getSteps(axis);
+    return Stepping::getSteps(axis) + backlash_offset(axis);
+}
+
+void physical_to_motor_steps(int32_t* steps) {
+    auto n_axis = Axes::_numberAxis;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        steps[axis] += backlash_offset(axis);
+    }
+}
+
+void probe_steps_to_mpos(float* position) {
+    float motor_mpos[MAX_N_AXIS];
+    auto  n_axis = Axes::_numberAxis;
+    for (size_t idx = 0; idx < n_axis; idx++) {
+        motor_mpos[idx] = (float(probe_steps[idx]) + probe_fraction[idx]) / Axes::_axis[idx]->_stepsPerMm;
+    }
+    config->_kinematics->motors_to_cartesian(position, motor_mpos, n_axis);
 }
 
 void get_motor_steps(int32_t* motor_steps) {
     auto axes   = config->_axes;
     auto n_axis = axes->_numberAxis;
     for (size_t axis = 0; axis < n_axis; axis++) {
-        motor_steps[axis] = Stepping::getSteps(axis);
+        motor_steps[axis] = Stepping::getSteps(axis) + backlash_offset(axis);
     }
 }
 int32_t* get_motor_steps() {
@@ -82,10 +109,34 @@ int32_t* get_motor_steps() {
     return motor_steps;
 }
 
+// The machine position of the motor steps that get_mpos() last converted. Status reports and
+// parameter reads repeat while the motors are at rest, so they reuse it instead of running the
+// forward kinematics again. The status report and the main loop call get_mpos() from
+// different tasks.
+static std::mutex mpos_cache_mutex;
+static bool       mpos_cache_valid = false;
+static int32_t    mpos_cache_steps[MAX_N_AXIS];
+static float      mpos_cache[MAX_N_AXIS];
+
+void invalidate_mpos_cache() {
+    std::lock_guard<std::mutex> lock(mpos_cache_mutex);
+    mpos_cache_valid = false;
+}
+
 float* get_mpos() {
     static float position[MAX_N_AXIS];
 
-    motor_steps_to_mpos(position, get_motor_steps());
+    int32_t steps[MAX_N_AXIS];
+    get_motor_steps(steps);
+
+    std::lock_guard<std::mutex> lock(mpos_cache_mutex);
+    if (!mpos_cache_valid || memcmp(steps, mpos_cache_steps, Axes::_numberAxis * sizeof(int32_t))) {
+        motor_steps_to_mpos(mpos_cache, steps);
+        copyAxes(mpos_cache_steps, steps);
+        mpos_cache_valid = true;
+    }
+    // Callers may change the returned position, so the cache is copied
+    copyAxes(position, mpos_cache);
     return position;
 };
 
@@ -102,7 +153,7 @@ float* get_wco() {
     return wco;
 }
 
-const std::map<State, const char*> StateName = {
+static constexpr auto state_names = sorted_table<State, const char*>({
     { State::Idle, "Idle" },
     { State::Alarm, "Alarm" },
     { State::CheckMode, "CheckMode" },
@@ -114,7 +165,8 @@ const std::map<State, const char*> StateName = {
     { State::Sleep, "Sleep" },
     { State::ConfigAlarm, "ConfigAlarm" },
     { State::Critical, "Critical" },
-};
+});
+const FlatMap<State, const char*> StateName(state_names);
 
 void set_state(State s) {
     sys.state = s;
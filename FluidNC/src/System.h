@@ -8,9 +8,9 @@
 #include "State.h"
 #include "Probe.h"
 #include "Config.h"  // MAX_N_AXIS
-#include <map>
+#include "FlatMap.h"
 
-extern const std::map<State, const char*> StateName;
+extern const FlatMap<State, const char*> StateName;
 
 // Step segment generator state flags.
 struct StepControl {
@@ -45,6 +45,7 @@ struct system_t {
     Percent        f_override;         // Feed rate override value in percent
     Percent        r_override;         // Rapids override value in percent
     Percent        spindle_speed_ovr;  // Spindle speed value in percent
+    Percent        f_adaptive;         // Feed reduction for the spindle load, in percent
     Override       override_ctrl;      // Tracks override control states.
     SpindleSpeed   spindle_speed;
 };
@@ -52,7 +53,8 @@ extern system_t sys;
 
 // NOTE: These position variables may need to be declared as volatiles, if problems arise.
 extern int32_t motor_steps[MAX_N_AXIS];  // Real-time machine (aka home) position vector in steps.
-extern int32_t probe_steps[MAX_N_AXIS];  // Last probe position in machine coordinates and steps.
+extern int32_t probe_steps[MAX_N_AXIS];     // Last probe position in machine coordinates and steps.
+extern float   probe_fraction[MAX_N_AXIS];  // Part of a step beyond probe_steps, when latched between steps
 
 void system_reset();
 
@@ -65,10 +67,20 @@ void     set_motor_steps_from_mpos(float* mpos);
 int32_t* get_motor_steps();
 void     get_motor_steps(int32_t* steps);
 
+// Converts physical motor steps, as Stepping::getSteps(), to motor steps in place
+void physical_to_motor_steps(int32_t* steps);
+
 // Updates a machine position array from a steps array
 void motor_steps_to_mpos(float* position, int32_t* steps);
 
+// Machine position of the last probe contact, from probe_steps and probe_fraction
+void probe_steps_to_mpos(float* position);
+
+// Machine position of the motors. The result is cached until the motor steps change, so a
+// change to anything else that the position depends on, such as steps_per_mm or the
+// kinematics, must call invalidate_mpos_cache().
 float* get_mpos();
+void   invalidate_mpos_cache();
 float* get_wco();
 
 bool inMotionState();  // True if moving, i.e. the stepping engine is active
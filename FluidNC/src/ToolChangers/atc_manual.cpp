@@ -3,6 +3,7 @@
 
 #include "atc_manual.h"
 #include "../Machine/MachineConfig.h"
+#include "../ToolTable.h"  // ToolTable::known_length
 #include <cstdio>
 #include <iostream>
 
@@ -12,6 +13,10 @@
 
   ets_mpos_mm: The X and Y location are the XY center of the toolsetter. The Z is the lowest the Z should go before we fail due to missing bit.
 
+  use_tool_table: Record each tool length measured at the toolsetter in the tool table, and skip
+  the toolsetter for a tool whose length is there.  Use it only with holders that seat a tool at
+  the same length every time, see ToolTable.h.  $Tools/Forget=<n> makes a tool be measured again.
+
   How do you tell FNC you already have a tool number installed before starting a job.
 
   How do you tell it you want to install a tool before a job.
@@ -42,6 +47,7 @@ tool_changer:
   probe_feed_rate_mm_per_min: 80.000000
   change_mpos_mm: 80.000 0.000 -1.000
   ets_mpos_mm: 5.000 -17.000 -40.000
+  use_tool_table: false
 */
 
 namespace ATCs {
@@ -57,6 +63,7 @@ namespace ATCs {
 
         protocol_buffer_synchronize();  // wait for all motion to complete
         _macro.erase();                 // clear previous gcode
+        _at_safe_z = false;
 
         // This is for M61. The ATC does nothing.
         if (set_tool) {
@@ -98,7 +105,8 @@ namespace ATCs {
                 return true;
             }
 
-            _prev_tool = new_tool;
+            uint8_t old_tool = _prev_tool;
+            _prev_tool       = new_tool;
 
             // save current location, so we can return after the tool change.
             _macro.addf("#<start_x >= #<_x>");
@@ -113,11 +121,18 @@ namespace ATCs {
                 _macro.addf("M5");
             }
 
-            // if we have not determined the tool setter offset yet, we need to do that.
+            // if we have not determined the tool setter offset yet, we need to do that,
+            // unless the tool table knows the length of the tool in the spindle.
+            float length;
             if (!_have_tool_setter_offset) {
-                move_over_toolsetter();
-                ets_probe();
-                _macro.addf("#<_ets_tool1_z>=[#5063]");  // save the value of the tool1 ETS Z
+                if (_use_tool_table && ToolTable::known_length(old_tool, length)) {
+                    _macro.addf("#<_ets_tool1_z>=%0.3f", length);
+                } else {
+                    move_over_toolsetter();
+                    ets_probe();
+                    _macro.addf("#<_ets_tool1_z>=[#5063]");  // save the value of the tool1 ETS Z
+                    record_length(old_tool);
+                }
                 _have_tool_setter_offset = true;
             }
 
@@ -127,13 +142,15 @@ namespace ATCs {
             _macro.addf("(MSG: Install tool #%d then resume to continue)", new_tool);
             _macro.addf("M0");
 
-            // probe the new tool
-            move_to_safe_z();
-            move_over_toolsetter();
-            ets_probe();
-
             // TLO is simply the difference between the tool1 probe and the new tool probe.
-            _macro.addf("#<_my_tlo_z >=[#5063 - #<_ets_tool1_z>]");
+            if (_use_tool_table && ToolTable::known_length(new_tool, length)) {
+                _macro.addf("#<_my_tlo_z >=[%0.3f - #<_ets_tool1_z>]", length);
+            } else {
+                move_over_toolsetter();
+                ets_probe();
+                _macro.addf("#<_my_tlo_z >=[#5063 - #<_ets_tool1_z>]");
+                record_length(new_tool);
+            }
             _macro.addf("G43.1Z#<_my_tlo_z>");
 
             move_to_safe_z();
@@ -141,6 +158,7 @@ namespace ATCs {
             // return to location before the tool change
             _macro.addf("G0X#<start_x>Y#<start_y>");
             _macro.addf("G0Z#<start_z>");
+            _at_safe_z = false;
 
             if (spindle_was_on) {
                 _macro.addf("M3");  // spindle should handle spinup delay
@@ -169,10 +187,16 @@ namespace ATCs {
     void Manual_ATC::move_to_change_location() {
         move_to_safe_z();
         _macro.addf("G53G0X%0.3fY%0.3fZ%0.3f", _change_mpos[0], _change_mpos[1], _change_mpos[2]);
+        _at_safe_z = false;
     }
 
+    // The moves of a change are queued without waiting for each other, so the planner blends
+    // them.  _at_safe_z leaves out the moves to safe Z that would not move.
     void Manual_ATC::move_to_safe_z() {
-        _macro.addf("G53G0Z%0.3f", _safe_z);
+        if (!_at_safe_z) {
+            _macro.addf("G53G0Z%0.3f", _safe_z);
+            _at_safe_z = true;
+        }
     }
 
     void Manual_ATC::move_over_toolsetter() {
@@ -191,6 +215,14 @@ namespace ATCs {
 
         // do the feed rate probe
         _macro.addf("G53 G38.2 Z%0.3f F%0.3f", _ets_mpos[2], _probe_feed_rate);
+        _at_safe_z = false;
+    }
+
+    // The length is the Z of the probe that the macro has just made, see ToolTable.h
+    void Manual_ATC::record_length(uint8_t tool) {
+        if (_use_tool_table && tool) {
+            _macro.addf("$Tools/Measured=%d", tool);
+        }
     }
 
     namespace {
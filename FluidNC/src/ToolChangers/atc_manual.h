@@ -32,17 +32,20 @@ namespace ATCs {
         std::vector<float> _ets_mpos         = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
         std::vector<float> _change_mpos      = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };  // manual tool change location
         float              _ets_rapid_z_mpos = 0;
+        bool               _use_tool_table   = false;
 
         bool    _is_OK                   = false;
         uint8_t _prev_tool               = 0;  // TODO This could be a NV setting
         bool    _have_tool_setter_offset = false;
         float   _tool_setter_offset      = 0.0;  // have we established an offset.
         float   _tool_setter_position[MAX_N_AXIS];
+        bool    _at_safe_z               = false;  // The macro so far ends at safe Z
 
         void move_to_change_location();
         void move_to_safe_z();
         void move_over_toolsetter();
         void ets_probe();
+        void record_length(uint8_t tool);
         void reset();
 
         Macro _macro;
@@ -61,6 +64,7 @@ namespace ATCs {
             handler.item("change_mpos_mm", _change_mpos);
             handler.item("ets_mpos_mm", _ets_mpos);
             handler.item("ets_rapid_z_mpos_mm", _ets_rapid_z_mpos);
+            handler.item("use_tool_table", _use_tool_table);
         }
     };
 }
@@ -0,0 +1,98 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "ToolTable.h"
+
+#include "FileStream.h"
+#include "Serial.h"  // allChannels
+#include "Logging.h"
+
+#include <memory>
+
+namespace ToolTable {
+    Table table;
+
+    bool known_length(uint32_t number, float& length) {
+        auto tool = table.find(number);
+        if (!tool || !tool->has_length) {
+            return false;
+        }
+        length = tool->length;
+        return true;
+    }
+
+    // Measurements are saved as they are made, so they survive a reboot
+    void set_length(uint32_t number, float length) {
+        auto& tool = table.get(number);
+        if (tool.has_length && tool.length == length) {
+            return;
+        }
+        tool.has_length = true;
+        tool.length     = length;
+        save(DEFAULT_FILE, allChannels);
+    }
+
+    void show(Channel& out) {
+        char line[100];
+        for (auto const& tool : table.tools()) {
+            format_line(line, sizeof(line), tool);
+            log_stream(out, "[TOOL " << line << "]");
+        }
+    }
+
+    Error save(std::string_view filename, Channel& out) {
+        try {
+            FileStream file(std::string { filename }, "w", "");
+            char       line[100];
+            for (auto const& tool : table.tools()) {
+                format_line(line, sizeof(line), tool);
+                log_stream(file, line);
+            }
+            log_debug_to(out, "Tool table saved to " << file.path());
+        } catch (...) {
+            log_error_to(out, "Cannot open " << filename);
+            return Error::FsFailedCreateFile;
+        }
+        return Error::Ok;
+    }
+
+    static Error read(std::string_view filename, Channel& out, bool must_exist) {
+        std::unique_ptr<char[]> buffer;
+        size_t                  filesize;
+        try {
+            FileStream file(std::string { filename }, "r", "");
+            filesize = file.size();
+            buffer   = std::make_unique<char[]>(filesize + 1);
+            if (file.read(buffer.get(), filesize) != filesize) {
+                return Error::FsFailedRead;
+            }
+        } catch (...) {
+            if (must_exist) {
+                log_error_to(out, "Cannot open " << filename);
+            }
+            return Error::FsFailedOpenFile;
+        }
+
+        Table            loaded;
+        std::string_view rest(buffer.get(), filesize);
+        std::string_view line;
+        for (int line_number = 1; string_util::split_prefix(rest, line, '\n'); ++line_number) {
+            Tool tool;
+            if (!parse_line(line, tool)) {
+                log_error_to(out, filename << " line " << line_number << " is bad: " << line);
+                return Error::InvalidValue;
+            }
+            if (tool.number) {
+                loaded.set(tool);
+            }
+        }
+        table = std::move(loaded);
+        log_info_to(out, "Tool table " << filename << " has " << table.tools().size() << " tools");
+        return Error::Ok;
+    }
+
+    Error load(std::string_view filename, Channel& out) { return read(filename, out, true); }
+
+    // A machine without a tool table file starts with an empty table
+    void init() { read(DEFAULT_FILE, allChannels, false); }
+}
@@ -0,0 +1,195 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  ToolTable.h - known tool lengths, diameters and rack pockets
+
+  A table of the tools a machine uses, loaded from DEFAULT_FILE on the local filesystem at boot.
+  A tool changer looks a tool up before measuring it, and a tool whose length is known needs no
+  trip to the tool setter.
+
+  The length of a tool is the machine Z at which its tip triggers the tool setter, as G38.2
+  leaves it in #5063, so the tool length offset from one tool to another is the difference of
+  their lengths.  The pocket is the machine position of the tool in a rack, for changers that
+  have one.
+
+  The file has one tool per line, with G-code style words and comments:
+
+    T3 L-42.125 D6.35 X100 Y20 Z-30 (6mm end mill)
+
+  T is required, the rest are optional.  Lines without a T word are ignored.  The table itself
+  is header-only so that it can be tested on the host; the file and the commands that use it are
+  in ToolTable.cpp.
+*/
+
+#include "Error.h"
+#include "string_util.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+#include <vector>
+
+class Channel;
+
+namespace ToolTable {
+    const char* const DEFAULT_FILE = "tooltable.txt";
+
+    struct Tool {
+        uint32_t number     = 0;
+        bool     has_length = false;
+        bool     has_pocket = false;
+        float    length     = 0.0f;  // Machine Z at the tool setter, see above
+        float    diameter   = 0.0f;
+        float    pocket[3]  = { 0.0f, 0.0f, 0.0f };  // Machine XYZ
+    };
+
+    // Parses a line of the file into tool.  Returns false for a malformed word.  A line without
+    // a T word leaves tool.number 0.
+    inline bool parse_line(std::string_view line, Tool& tool) {
+        tool = Tool();
+        for (size_t pos = 0; pos < line.length();) {
+            char c = line[pos];
+            if (isspace(c)) {
+                ++pos;
+                continue;
+            }
+            if (c == ';') {
+                break;
+            }
+            if (c == '(') {
+                pos = line.find(')', pos);
+                if (pos == std::string_view::npos) {
+                    return false;
+                }
+                ++pos;
+                continue;
+            }
+            char letter = toupper(c);
+            if (!isalpha(c)) {
+                return false;
+            }
+            size_t end = ++pos;
+            while (end < line.length() && (isdigit(line[end]) || line[end] == '.' || line[end] == '-' || line[end] == '+')) {
+                ++end;
+            }
+            auto number = line.substr(pos, end - pos);
+            pos         = end;
+            if (number.empty()) {
+                return false;
+            }
+
+            float value;
+            switch (letter) {
+                case 'T':
+                    if (!string_util::from_decimal(number, tool.number) || tool.number == 0) {
+                        return false;
+                    }
+                    continue;
+                case 'L':
+                    tool.has_length = true;
+                    if (!string_util::from_float(number, tool.length)) {
+                        return false;
+                    }
+                    continue;
+                case 'D':
+                    if (!string_util::from_float(number, tool.diameter)) {
+                        return false;
+                    }
+                    continue;
+                case 'X':
+                case 'Y':
+                case 'Z':
+                    if (!string_util::from_float(number, value)) {
+                        return false;
+                    }
+                    tool.has_pocket           = true;
+                    tool.pocket[letter - 'X'] = value;
+                    continue;
+                default:
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // Formats tool as parse_line() reads it, returning the length as snprintf() does
+    inline int format_line(char* buffer, size_t size, const Tool& tool) {
+        int  len = snprintf(buffer, size, "T%u", unsigned(tool.number));
+        auto add = [&](const char* fmt, float value) {
+            if (len >= 0 && size_t(len) < size) {
+                len += snprintf(buffer + len, size - len, fmt, value);
+            }
+        };
+        if (tool.has_length) {
+            add(" L%.3f", tool.length);
+        }
+        if (tool.diameter != 0.0f) {
+            add(" D%.3f", tool.diameter);
+        }
+        if (tool.has_pocket) {
+            add(" X%.3f", tool.pocket[0]);
+            add(" Y%.3f", tool.pocket[1]);
+            add(" Z%.3f", tool.pocket[2]);
+        }
+        return len;
+    }
+
+    // The tools, in number order
+    class Table {
+        std::vector<Tool> _tools;
+
+        std::vector<Tool>::iterator lower(uint32_t number) {
+            return std::lower_bound(_tools.begin(), _tools.end(), number, [](const Tool& t, uint32_t n) { return t.number < n; });
+        }
+
+    public:
+        const Tool* find(uint32_t number) {
+            auto it = lower(number);
+            return it != _tools.end() && it->number == number ? &*it : nullptr;
+        }
+
+        // The tool, added without a length if it is not in the table
+        Tool& get(uint32_t number) {
+            auto it = lower(number);
+            if (it == _tools.end() || it->number != number) {
+                Tool tool;
+                tool.number = number;
+                it          = _tools.insert(it, tool);
+            }
+            return *it;
+        }
+
+        void set(const Tool& tool) { get(tool.number) = tool; }
+
+        bool erase(uint32_t number) {
+            auto it = lower(number);
+            if (it == _tools.end() || it->number != number) {
+                return false;
+            }
+            _tools.erase(it);
+            return true;
+        }
+
+        void clear() { _tools.clear(); }
+
+        const std::vector<Tool>& tools() const { return _tools; }
+    };
+
+    // The table of the machine, and its file and commands, in ToolTable.cpp
+    extern Table table;
+
+    // Loads DEFAULT_FILE if there is one, at boot
+    void init();
+
+    // The length of the tool, if it is known
+    bool  known_length(uint32_t number, float& length);
+    void  set_length(uint32_t number, float length);
+    void  show(Channel& out);
+    Error save(std::string_view filename, Channel& out);
+    Error load(std::string_view filename, Channel& out);
+}
@@ -2,7 +2,6 @@
 // Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
 
 #define PASS_THROUGH_80_BF
-// #define TEST_UTF8
 
 #include "UTF8.h"
 
@@ -69,115 +68,41 @@ int UTF8::decode(uint8_t ch, uint32_t& value) {
     // i.e. ch between 0x80 and 0xbf, when not in the midst of a sequence
     return -1;
 }
-bool UTF8::decode(const std::vector<uint8_t>& input, uint32_t& value) {
-    int len = input.size();
-    for (auto const& ch : input) {
-        --len;
-        int result = decode(ch, value);
+bool UTF8::decode(const uint8_t* in, size_t length, uint32_t& value) {
+    while (length--) {
+        int result = decode(*in++, value);
         if (result == -1) {
             return false;
         }
         if (result == 1) {
-            return len == 0;  // Error if there are more bytes in the input
+            return length == 0;  // Error if there are more bytes in the input
         }
     }
     // Reached end of input without finishing the decode
     return false;
 }
-// cppcheck-suppress unusedFunction
-std::vector<uint8_t> UTF8::encode(const uint32_t value) {
-    std::vector<uint8_t> output;
+size_t UTF8::encode(const uint32_t value, uint8_t* out) {
     if (value >= 0x110000) {
-        // In this case, the returned vector will be empty
-        return output;
+        return 0;
     }
     if (value >= 0x10000) {
-        output.push_back(0xf0 | ((value >> 18) & 0x07));
-        output.push_back(0x80 | ((value >> 12) & 0x3f));
-        output.push_back(0x80 | ((value >> 6) & 0x3f));
-        output.push_back(0x80 | (value & 0x3f));
-        return output;
+        out[0] = 0xf0 | ((value >> 18) & 0x07);
+        out[1] = 0x80 | ((value >> 12) & 0x3f);
+        out[2] = 0x80 | ((value >> 6) & 0x3f);
+        out[3] = 0x80 | (value & 0x3f);
+        return 4;
     }
     if (value >= 0x800) {
-        output.push_back(0xe0 | ((value >> 12) & 0x0f));
-        output.push_back(0x80 | ((value >> 6) & 0x3f));
-        output.push_back(0x80 | (value & 0x3f));
-        return output;
+        out[0] = 0xe0 | ((value >> 12) & 0x0f);
+        out[1] = 0x80 | ((value >> 6) & 0x3f);
+        out[2] = 0x80 | (value & 0x3f);
+        return 3;
     }
     if (value >= 0x80) {
-        output.push_back(0xc0 | ((value >> 6) & 0x01f));
-        output.push_back(0x80 | (value & 0x3f));
-        return output;
-    }
-    output.push_back(value);
-    return output;
-}
-
-#ifdef TEST_UTF8
-#    include <cstdio>
-
-static bool decode_test(UTF8* utf8, std::vector<uint8_t> input, uint32_t& value) {
-    for (auto& ch : input) {
-        printf("%x ", ch);
-    }
-    printf("-> ");
-    auto res = utf8->decode(input, value);
-    if (res) {
-        printf("%x\n", value);
-    } else {
-        printf("ERROR\n");
-    }
-    return res;
-}
-
-static bool encode_test(UTF8* utf8, uint32_t value) {
-    auto encoded = utf8->encode(value);
-    printf("%x -> ", value);
-    if (encoded.size()) {
-        uint32_t out_value;
-        bool     res = decode_test(utf8, encoded, out_value);
-        if (!res) {
-            return false;
-        }
-        if (out_value != value) {
-            printf(" -- Incorrect value\n");
-            return false;
-        }
-        return true;
-    } else {
-        printf("ERROR\n");
-        return false;
+        out[0] = 0xc0 | ((value >> 6) & 0x01f);
+        out[1] = 0x80 | (value & 0x3f);
+        return 2;
     }
+    out[0] = value;
+    return 1;
 }
-
-void test_UTF8() {
-    UTF8* utf8 = new UTF8();
-    encode_test(utf8, 0x7f);
-    encode_test(utf8, 0x80);
-    encode_test(utf8, 0x90);
-    encode_test(utf8, 0xa0);
-    encode_test(utf8, 0xbf);
-    encode_test(utf8, 0x100);
-    encode_test(utf8, 0x13f);
-    encode_test(utf8, 0x140);
-    encode_test(utf8, 0x17f);
-    encode_test(utf8, 0x1ff);
-    encode_test(utf8, 0x200);
-    encode_test(utf8, 0x2ff);
-    encode_test(utf8, 0x7ff);
-    encode_test(utf8, 0x800);
-    encode_test(utf8, 0xffff);
-    encode_test(utf8, 0x100000);
-    encode_test(utf8, 0x10ffff);
-    encode_test(utf8, 0x110000);
-    uint32_t out_value;
-    decode_test(utf8, std::vector<uint8_t> { 0x80 }, out_value);              // continuation byte outside
-    decode_test(utf8, std::vector<uint8_t> { 0xc0 }, out_value);              // Incomplete sequence
-    decode_test(utf8, std::vector<uint8_t> { 0xc0, 0x30 }, out_value);        // Non-continuation inside
-    decode_test(utf8, std::vector<uint8_t> { 0xc0, 0x80, 0x30 }, out_value);  // Extra bytes
-    delete utf8;
-}
-#else
-// cppcheck-suppress unusedFunction
-void test_UTF8() {}
-#endif
@@ -3,8 +3,8 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
-#include <vector>
 
 class UTF8 {
 private:
@@ -15,12 +15,13 @@ public:
     // Byte-at-a-time decoder.  Returns -1 for error, 1 for okay, 0 for keep trying
     int decode(uint8_t ch, uint32_t& value);
 
-    // Vector-of-bytes decoder.  Returns true if the vector contains
-    // a well-formed UTF8 sequence.
-    bool decode(const std::vector<uint8_t>& in, uint32_t& value);
+    // Buffer decoder.  Returns true if the length bytes at in are exactly
+    // one well-formed UTF8 sequence.
+    bool decode(const uint8_t* in, size_t length, uint32_t& value);
 
-    // Encode to vector
-    std::vector<uint8_t> encode(const uint32_t value);
-};
+    // Longest encoding of one value
+    static const size_t max_length = 4;
 
-void test_UTF8();
+    // Encode to a buffer with room for max_length bytes.  Returns the length, 0 for an invalid value
+    static size_t encode(const uint32_t value, uint8_t* out);
+};
@@ -8,6 +8,9 @@
 #include "Uart.h"
 #include <Driver/fluidnc_uart.h>
 
+#include <algorithm>
+#include <cstring>
+
 std::string encodeUartMode(UartData wordLength, UartParity parity, UartStop stopBits) {
     std::string s;
     s += std::to_string(int(wordLength) - int(UartData::Bits5) + 5);
@@ -128,15 +131,19 @@ void Uart::begin() {
     config_message("UART", std::to_string(_uart_num).c_str());
 }
 
+// Takes whatever the driver has, up to a chunk, without waiting
+bool Uart::fill_rx_chunk() {
+    int res       = uart_read(_uart_num, _rx_chunk, RX_CHUNK_SIZE, 0);
+    _rx_chunk_pos = 0;
+    _rx_chunk_len = res < 0 ? 0 : res;
+    return _rx_chunk_len != 0;
+}
+
 int Uart::read() {
-    if (_pushback != -1) {
-        int ret   = _pushback;
-        _pushback = -1;
-        return ret;
+    if (_rx_chunk_pos == _rx_chunk_len && !fill_rx_chunk()) {
+        return -1;
     }
-    uint8_t c;
-    int     res = uart_read(_uart_num, &c, 1, 0);
-    return res == 1 ? c : -1;
+    return _rx_chunk[_rx_chunk_pos++];
 }
 
 size_t Uart::write(uint8_t c) {
@@ -153,10 +160,17 @@ size_t Uart::write(const uint8_t* buffer, size_t length) {
 // }
 
 size_t Uart::timedReadBytes(char* buffer, size_t len, TickType_t timeout) {
-    int res = uart_read(_uart_num, (uint8_t*)buffer, len, timeout);
+    size_t chunked = std::min(len, size_t(_rx_chunk_len - _rx_chunk_pos));
+    memcpy(buffer, _rx_chunk + _rx_chunk_pos, chunked);
+    _rx_chunk_pos += chunked;
+    if (chunked == len) {
+        return len;
+    }
+
+    int res = uart_read(_uart_num, (uint8_t*)buffer + chunked, len - chunked, timeout);
     // If res < 0, no bytes were read
 
-    return res < 0 ? 0 : res;
+    return chunked + (res < 0 ? 0 : res);
 }
 
 void Uart::forceXon() {
@@ -197,23 +211,19 @@ int Uart::rx_buffer_available(void) {
 }
 
 int Uart::peek() {
-    if (_pushback != -1) {
-        return _pushback;
-    }
-    int ch = read();
-    if (ch == -1) {
+    if (_rx_chunk_pos == _rx_chunk_len && !fill_rx_chunk()) {
         return -1;
     }
-    _pushback = ch;
-    return ch;
+    return _rx_chunk[_rx_chunk_pos];
 }
 
 int Uart::available() {
-    return uart_buflen(_uart_num) + (_pushback != -1);
+    return uart_buflen(_uart_num) + (_rx_chunk_len - _rx_chunk_pos);
 }
 
 void Uart::flushRx() {
-    _pushback = -1;
+    _rx_chunk_pos = 0;
+    _rx_chunk_len = 0;
     uart_discard_input(_uart_num);
 }
 
@@ -12,12 +12,19 @@
 
 class Uart : public Stream, public Configuration::Configurable {
 private:
-    // One character of pushback for implementing peek().
-    // We cannot use the queue for this because the queue
-    // is after the check for realtime characters, whereas
-    // peek() deals with characters before realtime ones
+    // Received bytes are taken from the driver a chunk at a time, because
+    // each call into the driver costs far more than copying a byte.  This
+    // also provides the lookahead for peek().  We cannot use the channel
+    // queue for that because the queue is after the check for realtime
+    // characters, whereas peek() deals with characters before realtime ones
     // are handled.
-    int _pushback = -1;
+    static const int RX_CHUNK_SIZE = 64;
+
+    uint8_t _rx_chunk[RX_CHUNK_SIZE];
+    int     _rx_chunk_pos = 0;
+    int     _rx_chunk_len = 0;
+
+    bool fill_rx_chunk();
 
     bool setPins(int tx_pin, int rx_pin, int rts_pin = -1, int cts_pin = -1);
 
@@ -4,6 +4,7 @@
 #include "UartChannel.h"
 #include "Machine/MachineConfig.h"  // config
 #include "Serial.h"                 // allChannels
+#include "string_util.h"            // printable_run()
 
 UartChannel::UartChannel(int num, bool addCR) : Channel("uart_channel", num, addCR) {
     _lineedit = new Lineedit(this, _line, Channel::maxLine - 1);
@@ -113,6 +114,15 @@ bool UartChannel::lineComplete(char* line, char c) {
     return false;
 }
 
+size_t UartChannel::appendRun(const uint8_t* data, size_t length) {
+    if (_lineedit->is_editing()) {
+        return 0;
+    }
+    size_t run = string_util::printable_run(data, length);
+    _lineedit->append(reinterpret_cast<const char*>(data), run);
+    return run;
+}
+
 int UartChannel::read() {
     int c = _uart->read();
     if (c == 0x11) {
@@ -129,13 +139,14 @@ void UartChannel::flushRx() {
 }
 
 size_t UartChannel::timedReadBytes(char* buffer, size_t length, TickType_t timeout) {
-    // It is likely that _queue will be empty because timedReadBytes() is only
+    // It is likely that _rx will be empty because timedReadBytes() is only
     // used in situations where the UART is not receiving GCode commands
     // and Grbl realtime characters.
-    size_t remlen = length;
-    while (remlen && _queue.size()) {
-        *buffer++ = _queue.front();
-        _queue.pop();
+    size_t queued = _rx.read(reinterpret_cast<uint8_t*>(buffer), length);
+    buffer += queued;
+    size_t remlen = length - queued;
+    if (!remlen) {
+        return length;
     }
 
     int res = _uart->timedReadBytes(buffer, remlen, timeout);
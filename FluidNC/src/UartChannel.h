@@ -39,6 +39,7 @@ public:
     size_t timedReadBytes(uint8_t* buffer, size_t length, TickType_t timeout) { return timedReadBytes((char*)buffer, length, timeout); };
     bool   realtimeOkay(char c) override;
     bool   lineComplete(char* line, char c) override;
+    size_t appendRun(const uint8_t* data, size_t length) override;
     int    uart_num() { return _uart_num; }
     Uart*  uart() { return _uart; }
 
@@ -0,0 +1,177 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Ethernet.h"
+
+#include "src/JSONEncoder.h"
+#include "src/Channel.h"
+
+#include <ETH.h>
+
+namespace WebUI {
+    static const enum_opt_t ethPhyOptions = {
+        { "LAN8720", ETH_PHY_LAN8720 }, { "TLK110", ETH_PHY_TLK110 },   { "RTL8201", ETH_PHY_RTL8201 },
+        { "DP83848", ETH_PHY_DP83848 }, { "KSZ8041", ETH_PHY_KSZ8041 }, { "KSZ8081", ETH_PHY_KSZ8081 },
+    };
+
+    // Where the 50 MHz RMII reference clock comes from
+    static const enum_opt_t ethClockOptions = {
+        { "GPIO0_IN", ETH_CLOCK_GPIO0_IN },
+        { "GPIO0_OUT", ETH_CLOCK_GPIO0_OUT },
+        { "GPIO16_OUT", ETH_CLOCK_GPIO16_OUT },
+        { "GPIO17_OUT", ETH_CLOCK_GPIO17_OUT },
+    };
+
+    static constexpr int ETH_DHCP_MODE   = 0;
+    static constexpr int ETH_STATIC_MODE = 1;
+
+    static const enum_opt_t ethIPModeOptions = {
+        { "DHCP", ETH_DHCP_MODE },
+        { "Static", ETH_STATIC_MODE },
+    };
+
+    static EnumSetting*   eth_enable;
+    static EnumSetting*   eth_phy;
+    static IntSetting*    eth_phy_addr;
+    static IntSetting*    eth_power_pin;
+    static IntSetting*    eth_mdc_pin;
+    static IntSetting*    eth_mdio_pin;
+    static EnumSetting*   eth_clock;
+    static EnumSetting*   eth_ip_mode;
+    static IPaddrSetting* eth_ip;
+    static IPaddrSetting* eth_gateway;
+    static IPaddrSetting* eth_netmask;
+
+    bool EthernetConfig::_started = false;
+    bool EthernetConfig::_link_up = false;
+
+    bool network_off() {
+        return WiFi.getMode() == WIFI_OFF && !EthernetConfig::isOn();
+    }
+
+    // A wired address is preferred because a client that can use either
+    // interface gets the lower latency
+    IPAddress network_ip() {
+        if (EthernetConfig::isOn() && uint32_t(ETH.localIP())) {
+            return ETH.localIP();
+        }
+        return WiFi.getMode() == WIFI_STA ? WiFi.localIP() : WiFi.softAPIP();
+    }
+
+    IPAddress EthernetConfig::localIP() {
+        return ETH.localIP();
+    }
+
+    void EthernetConfig::EthEvent(WiFiEvent_t event) {
+        switch (event) {
+            case ARDUINO_EVENT_ETH_CONNECTED:
+                _link_up = true;
+                log_info("Ethernet link up " << ETH.linkSpeed() << "Mbps " << (ETH.fullDuplex() ? "full" : "half") << " duplex");
+                break;
+            case ARDUINO_EVENT_ETH_GOT_IP:
+                log_info("Ethernet IP is " << IP_string(ETH.localIP()));
+                break;
+            case ARDUINO_EVENT_ETH_DISCONNECTED:
+                _link_up = false;
+                log_info("Ethernet link down");
+                break;
+            default:
+                break;
+        }
+    }
+
+    void EthernetConfig::init_settings() {
+        eth_enable    = new EnumSetting("Ethernet Enable", WEBSET, WA, NULL, "Ethernet/Enable", DEFAULT_ETH_STATE, &onoffOptions);
+        eth_phy       = new EnumSetting("Ethernet PHY", WEBSET, WA, NULL, "Ethernet/PHY", ETH_PHY_LAN8720, &ethPhyOptions);
+        eth_phy_addr  = new IntSetting("Ethernet PHY Address", WEBSET, WA, NULL, "Ethernet/PhyAddr", DEFAULT_PHY_ADDR, 0, MAX_PHY_ADDR);
+        eth_power_pin = new IntSetting("Ethernet PHY Power GPIO, -1 for none", WEBSET, WA, NULL, "Ethernet/PowerPin", -1, -1, MAX_GPIO);
+        eth_mdc_pin   = new IntSetting("Ethernet MDC GPIO", WEBSET, WA, NULL, "Ethernet/MDCPin", DEFAULT_MDC_PIN, 0, MAX_GPIO);
+        eth_mdio_pin  = new IntSetting("Ethernet MDIO GPIO", WEBSET, WA, NULL, "Ethernet/MDIOPin", DEFAULT_MDIO_PIN, 0, MAX_GPIO);
+        eth_clock     = new EnumSetting("Ethernet RMII Clock", WEBSET, WA, NULL, "Ethernet/Clock", ETH_CLOCK_GPIO0_IN, &ethClockOptions);
+        eth_ip_mode   = new EnumSetting("Ethernet IP Mode", WEBSET, WA, NULL, "Ethernet/IPMode", ETH_DHCP_MODE, &ethIPModeOptions);
+        eth_ip        = new IPaddrSetting("Ethernet Static IP", WEBSET, WA, NULL, "Ethernet/IP", "0.0.0.0");
+        eth_gateway   = new IPaddrSetting("Ethernet Static Gateway", WEBSET, WA, NULL, "Ethernet/Gateway", "0.0.0.0");
+        eth_netmask   = new IPaddrSetting("Ethernet Static Mask", WEBSET, WA, NULL, "Ethernet/Netmask", "0.0.0.0");
+    }
+
+    void EthernetConfig::init() {
+        if (!eth_enable->get()) {
+            return;
+        }
+
+        // Cumulative, like the WiFi event handler, so it is only done once
+        static bool events_registered = false;
+        if (!events_registered) {
+            WiFi.onEvent(EthEvent);
+            events_registered = true;
+        }
+
+        if (!ETH.begin(uint8_t(eth_phy_addr->get()),
+                       eth_power_pin->get(),
+                       eth_mdc_pin->get(),
+                       eth_mdio_pin->get(),
+                       eth_phy_type_t(eth_phy->get()),
+                       eth_clock_mode_t(eth_clock->get()))) {
+            log_error("Ethernet failed to start");
+            return;
+        }
+        _started = true;
+
+        // The WiFi module sets the hostname whether or not WiFi is on
+        ETH.setHostname(WiFi.getHostname());
+        if (eth_ip_mode->get() == ETH_STATIC_MODE) {
+            ETH.config(IPAddress(eth_ip->get()), IPAddress(eth_gateway->get()), IPAddress(eth_netmask->get()));
+        }
+
+        log_info("Ethernet " << eth_phy->getStringValue() << " started");
+
+        // The services that start next do not need an address, because they
+        // listen on every interface, but waiting briefly lets the address be
+        // reported with the startup messages
+        for (int ms = 0; ms < IP_WAIT_MS && !uint32_t(ETH.localIP()); ms += 100) {
+            delay_ms(100);
+        }
+        if (!uint32_t(ETH.localIP())) {
+            log_info("Ethernet has no address yet");
+        }
+    }
+
+    void EthernetConfig::deinit() {
+        // The Arduino ETH driver cannot be stopped once it has been started
+        _started = false;
+    }
+
+    void EthernetConfig::build_info(Channel& channel) {
+        if (!_started) {
+            return;
+        }
+        std::string result("Mode=Ethernet:IP=");
+        result += IP_string(ETH.localIP());
+        result += ":MAC=";
+        result += ETH.macAddress().c_str();
+        result += ":Status=";
+        if (_link_up) {
+            result += std::to_string(ETH.linkSpeed());
+            result += ETH.fullDuplex() ? "Mbps full duplex" : "Mbps half duplex";
+        } else {
+            result += "No link";
+        }
+        log_msg_to(channel, result);
+    }
+
+    void EthernetConfig::wifi_stats(JSONencoder& j) {
+        if (!_started) {
+            return;
+        }
+        j.id_value_object("Ethernet", std::string("Wired (") + ETH.macAddress().c_str() + ")");
+        j.id_value_object("Ethernet link", _link_up ? std::to_string(ETH.linkSpeed()) + " Mbps" : std::string("Down"));
+        j.id_value_object("Ethernet IP", IP_string(ETH.localIP()));
+    }
+
+    EthernetConfig::~EthernetConfig() {
+        deinit();
+    }
+
+    // After the WiFi module, which sets the hostname, and before the services
+    ModuleFactory::InstanceBuilder<EthernetConfig> __attribute__((init_priority(106))) ethernet_module("ethernet", true);
+}
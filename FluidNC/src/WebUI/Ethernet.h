@@ -0,0 +1,55 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include "src/Module.h"  // Module
+#include "src/Settings.h"
+
+#include <WiFi.h>  // WiFiEvent_t, IPAddress
+
+namespace WebUI {
+    // A wired RMII Ethernet interface, for shops where WiFi latency is too
+    // irregular for streaming.  The network services - WebUI, WebSocket,
+    // Telnet, UDP status and MQTT - listen on every interface, so they serve
+    // Ethernet clients through the same channel classes as WiFi clients.
+    // They start when either interface is on, so WiFi/Mode can be Off on a
+    // wired machine.
+    class EthernetConfig : public Module {
+        static const int DEFAULT_ETH_STATE = 0;
+
+        static const int DEFAULT_PHY_ADDR = 0;
+        static const int MAX_PHY_ADDR     = 31;
+        static const int DEFAULT_MDC_PIN  = 23;
+        static const int DEFAULT_MDIO_PIN = 18;
+        static const int MAX_GPIO         = 39;
+
+        static const int IP_WAIT_MS = 5000;  // How long init() waits for a DHCP address
+
+        static bool _started;
+        static bool _link_up;
+
+        static void EthEvent(WiFiEvent_t event);
+
+    public:
+        EthernetConfig(const char* name) : Module(name) {}
+
+        static bool      isOn() { return _started; }
+        static IPAddress localIP();
+
+        void init_settings() override;
+        void init() override;
+        void deinit() override;
+        bool deferred_init() override { return true; }
+        void build_info(Channel& out) override;
+        void wifi_stats(JSONencoder& j) override;
+
+        ~EthernetConfig();
+    };
+
+    // True if neither WiFi nor Ethernet is on, so there is no network to serve
+    bool network_off();
+
+    // The address that clients on the network use to reach us
+    IPAddress network_ip();
+}
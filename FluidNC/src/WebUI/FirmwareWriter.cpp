@@ -0,0 +1,193 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "FirmwareWriter.h"
+
+#include "src/Logging.h"
+#include "src/RxRing.h"
+#include "src/Inflate.h"
+#include "src/Machine/Tasks.h"
+#include "src/SettingsDefinitions.h"  // sd_read_ahead_psram
+#include "Driver/psram.h"             // psram_malloc()
+#include "src/NutsBolts.h"            // delay_ms()
+
+#include <Update.h>
+#include <Arduino.h>  // millis()
+#include <cstdlib>
+
+namespace WebUI {
+    // 8 KiB is several network packets, and about the time of one flash sector erase
+    // at WiFi rates
+    static const size_t ringSize   = 8 * 1024;
+    static const size_t bufferSize = 4 * 1024;  // Bytes handed to Update.write() at a time
+
+    static TaskHandle_t _task = nullptr;
+
+    static RxRing*  _ring   = nullptr;
+    static uint8_t* _buffer = nullptr;
+
+    static bool          _gzip     = false;
+    static bool          _started  = false;  // The first write has decided _gzip
+    static volatile bool _running  = false;  // The task is writing an image
+    static volatile bool _eof      = false;  // Everything has been queued
+    static volatile bool _aborting = false;
+    static volatile bool _ok       = false;
+
+    static uint32_t _startMs;
+    static uint32_t _received;
+    static uint32_t _written;
+    static uint32_t _stalls;  // Writes that waited for the task
+
+    // Inflater source and plain copy alike: waits for bytes, returning 0 at the end
+    static size_t pull(void* unused, uint8_t* data, size_t length) {
+        while (true) {
+            bool   eof = _eof;
+            size_t n   = _ring->read(data, length);
+            if (n) {
+                return n;
+            }
+            if (eof || _aborting) {
+                return 0;
+            }
+            ulTaskNotifyTake(pdTRUE, 1);
+        }
+    }
+
+    static bool flash(const uint8_t* data, size_t length) {
+        if (Update.write(const_cast<uint8_t*>(data), length) != length) {
+            log_error("Update write failed");
+            return false;
+        }
+        _written += length;
+        return true;
+    }
+
+    static bool copy_image() {
+        size_t n;
+        while ((n = pull(nullptr, _buffer, bufferSize)) != 0) {
+            if (!flash(_buffer, n)) {
+                return false;
+            }
+        }
+        return !_aborting;
+    }
+
+    static bool inflate_image() {
+        uint8_t* window = nullptr;
+        if (sd_read_ahead_psram->get()) {
+            window = static_cast<uint8_t*>(psram_malloc(Inflater::window_size));
+        }
+        if (!window) {
+            window = static_cast<uint8_t*>(malloc(Inflater::window_size));
+        }
+        if (!window) {
+            log_error("No memory to decompress the update");
+            return false;
+        }
+        bool     ok = true;
+        Inflater inflater(pull, nullptr, window);
+        size_t   n;
+        while (ok && (n = inflater.read(_buffer, bufferSize)) != 0) {
+            ok = flash(_buffer, n);
+        }
+        if (ok && !inflater.done()) {
+            log_error("Update is not valid gzip data");
+            ok = false;
+        }
+        free(window);
+        return ok && !_aborting;
+    }
+
+    static void writer_loop(void* unused) {
+        while (true) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            if (!_running) {
+                continue;  // A data notification from after the last image
+            }
+            _ok = _gzip ? inflate_image() : copy_image();
+            if (!_ok) {
+                // Let the receiver go on without waiting for room
+                _ring->clear();
+            }
+            _running = false;
+        }
+    }
+
+    bool FirmwareWriter::begin() {
+        if (!_task && !Machine::Tasks::get()._firmwareWriter.create(writer_loop, nullptr, &_task)) {
+            _task = nullptr;
+            return false;
+        }
+        _ring   = new RxRing(ringSize);
+        _buffer = new uint8_t[bufferSize];
+
+        _started  = false;
+        _eof      = false;
+        _aborting = false;
+        _ok       = false;
+        _received = 0;
+        _written  = 0;
+        _stalls   = 0;
+        _startMs  = millis();
+        return true;
+    }
+
+    bool FirmwareWriter::active() {
+        return _ring != nullptr;
+    }
+
+    bool FirmwareWriter::write(const uint8_t* data, size_t length) {
+        if (!_started) {
+            if (length < 2) {
+                return length == 0;
+            }
+            _gzip    = data[0] == 0x1f && data[1] == 0x8b;
+            _started = true;
+            _running = true;
+            log_info("Update image is " << (_gzip ? "gzip-compressed" : "uncompressed"));
+        }
+        _received += length;
+        while (length) {
+            if (!_running) {
+                return false;  // The task stopped early, so the write failed
+            }
+            size_t n = _ring->push(data, length);
+            data += n;
+            length -= n;
+            xTaskNotifyGive(_task);
+            if (length) {
+                ++_stalls;
+                delay_ms(1);
+            }
+        }
+        return true;
+    }
+
+    static void wait_done() {
+        while (_running) {
+            xTaskNotifyGive(_task);
+            delay_ms(1);
+        }
+        delete _ring;
+        _ring = nullptr;
+        delete[] _buffer;
+        _buffer = nullptr;
+    }
+
+    bool FirmwareWriter::finish() {
+        _eof = true;
+        wait_done();
+        uint32_t ms = millis() - _startMs;
+        log_info("Update wrote " << _written << " bytes from " << _received << " in " << ms << " ms, "
+                                 << (ms ? _received / ms : 0) << " KB/s, " << _stalls << " waits for flash");
+        return _ok;
+    }
+
+    void FirmwareWriter::abort() {
+        if (!_ring) {
+            return;
+        }
+        _aborting = true;
+        wait_done();
+    }
+}
@@ -0,0 +1,33 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace WebUI {
+    // Writes a firmware image that arrives over HTTP to the OTA partition from its own
+    // task, so that receiving the next packets overlaps the flash writes.  The received
+    // bytes go through a ring; the task takes them out, inflates them if the image is
+    // gzip-compressed, and hands them to Update.write().  Update.begin() and Update.end()
+    // stay with the caller.
+    class FirmwareWriter {
+    public:
+        // Returns false if there is no memory for the ring or the task
+        static bool begin();
+
+        // Queues received bytes, waiting for room if the flash is behind.  The first call
+        // decides whether the image is gzip-compressed.  Returns false once writing failed.
+        static bool write(const uint8_t* data, size_t length);
+
+        // Waits until everything queued has been written, returning true if all of it was
+        // and, for a compressed image, the gzip data was complete and intact
+        static bool finish();
+
+        // Discards the rest of the image
+        static void abort();
+
+        static bool active();
+    };
+}
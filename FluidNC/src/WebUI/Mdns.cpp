@@ -3,15 +3,18 @@
 
 #include "src/Module.h"
 #include "Mdns.h"
+#include "Ethernet.h"  // EthernetConfig::isOn()
 #include <WiFi.h>
 
 namespace WebUI {
     EnumSetting* Mdns::_enable;
 
-    void Mdns::init() {
+    void Mdns::init_settings() {
         _enable = new EnumSetting("mDNS enable", WEBSET, WA, NULL, "MDNS/Enable", true, &onoffOptions);
+    }
 
-        if (WiFi.getMode() == WIFI_STA && _enable->get()) {
+    void Mdns::init() {
+        if ((WiFi.getMode() == WIFI_STA || EthernetConfig::isOn()) && _enable->get()) {
             if (mdns_init()) {
                 log_error("Cannot start mDNS");
                 return;
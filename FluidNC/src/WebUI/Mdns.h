@@ -13,8 +13,10 @@ namespace WebUI {
     public:
         Mdns(const char* name) : Module(name) {}
 
+        void        init_settings() override;
         void        init() override;
         void        deinit() override;
+        bool        deferred_init() override { return true; }
         static void add(const char* service, const char* proto, int port);
         static void remove(const char* service, const char* proto);
         ~Mdns() {}
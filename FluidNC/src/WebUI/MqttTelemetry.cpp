@@ -0,0 +1,254 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "MqttTelemetry.h"
+#include "Ethernet.h"  // network_off()
+
+#include "src/Machine/MachineConfig.h"  // Axes
+#include "src/MqttPacket.h"
+#include "src/Protocol.h"     // lastAlarm
+#include "src/Report.h"       // state_name(), report_status_fields()
+#include "src/StatusFrame.h"  // StatusFrame::Fields
+#include "src/JSONEncoder.h"
+#include "src/Serial.h"  // allChannels
+#include "src/Job.h"
+
+namespace WebUI {
+    EnumSetting*   mqtt_enable;
+    StringSetting* mqtt_broker;
+    IntSetting*    mqtt_port;
+    StringSetting* mqtt_topic;
+    StringSetting* mqtt_user;
+    StringSetting* mqtt_password;
+    IntSetting*    mqtt_interval;
+
+    static bool elapsed(int32_t time) {
+        return (int32_t(xTaskGetTickCount()) - time) >= 0;
+    }
+
+    void MqttTelemetry::init_settings() {
+        mqtt_enable   = new EnumSetting("MQTT Enable", WEBSET, WA, NULL, "MQTT/Enable", DEFAULT_MQTT_STATE, &onoffOptions);
+        mqtt_broker   = new StringSetting("MQTT Broker", WEBSET, WA, NULL, "MQTT/Broker", "", 0, 64);
+        mqtt_port     = new IntSetting("MQTT Port", WEBSET, WA, NULL, "MQTT/Port", DEFAULT_MQTT_PORT, MIN_MQTT_PORT, MAX_MQTT_PORT);
+        mqtt_topic    = new StringSetting("MQTT Topic Prefix, default fluidnc/<hostname>", WEBSET, WA, NULL, "MQTT/Topic", "", 0, 64);
+        mqtt_user     = new StringSetting("MQTT User", WEBSET, WA, NULL, "MQTT/User", "", 0, 64);
+        mqtt_password = new StringSetting("MQTT Password", WEBSET, WA, NULL, "MQTT/Password", "", 0, 64);
+        mqtt_interval =
+            new IntSetting("MQTT Metrics Interval", WEBSET, WA, NULL, "MQTT/IntervalMs", DEFAULT_MQTT_INTERVAL, MIN_MQTT_INTERVAL, MAX_MQTT_INTERVAL);
+    }
+
+    void MqttTelemetry::init() {
+        if (network_off()) {
+            return;
+        }
+
+        if (!mqtt_enable->get() || !*mqtt_broker->get()) {
+            return;
+        }
+
+        _topic = mqtt_topic->get();
+        if (_topic.empty()) {
+            _topic = "fluidnc/";
+            _topic += WiFi.getHostname();
+        }
+        _connect_time = int32_t(xTaskGetTickCount());
+        _started      = true;
+        log_info("MQTT telemetry to " << mqtt_broker->get() << ":" << mqtt_port->get() << " as " << _topic);
+    }
+
+    void MqttTelemetry::deinit() {
+        if (_started) {
+            disconnect();
+            _started = false;
+        }
+    }
+
+    // Connecting blocks the polling task for up to CONNECT_TIMEOUT, so it is not
+    // attempted while the machine is running a program
+    void MqttTelemetry::try_connect() {
+        if (!elapsed(_connect_time) || state_is(State::Cycle) || state_is(State::Jog) || state_is(State::Homing)) {
+            return;
+        }
+        _connect_time = xTaskGetTickCount() + RECONNECT_DELAY;
+
+        if (!_client.connect(mqtt_broker->get(), mqtt_port->get(), CONNECT_TIMEOUT)) {
+            ++_connect_failures;
+            return;
+        }
+        _client.setNoDelay(true);
+
+        std::string packet;
+        Mqtt::connect(packet, WiFi.getHostname(), KEEPALIVE_S, mqtt_user->get(), mqtt_password->get());
+        _client.write(reinterpret_cast<const uint8_t*>(packet.data()), packet.length());
+        _connecting   = true;
+        _connect_time = xTaskGetTickCount() + CONNACK_TIMEOUT;
+    }
+
+    void MqttTelemetry::check_connack() {
+        if (_client.available() >= 4) {
+            uint8_t reply[4];
+            _client.read(reply, sizeof(reply));
+            int code    = Mqtt::connack(reply, sizeof(reply));
+            _connecting = false;
+            if (code != 0) {
+                log_warn("MQTT broker refused the connection, code " << code);
+                disconnect();
+                return;
+            }
+            _connected    = true;
+            _last_state   = "";  // Publish the state at once
+            _next_metrics = xTaskGetTickCount();
+            _last_send    = xTaskGetTickCount();
+            log_info("MQTT connected");
+            return;
+        }
+        if (elapsed(_connect_time) || !_client.connected()) {
+            ++_connect_failures;
+            disconnect();
+        }
+    }
+
+    void MqttTelemetry::disconnect() {
+        if (_connected) {
+            std::string packet;
+            Mqtt::disconnect(packet);
+            _client.write(reinterpret_cast<const uint8_t*>(packet.data()), packet.length());
+        }
+        _client.stop();
+        _connected    = false;
+        _connecting   = false;
+        _connect_time = xTaskGetTickCount() + RECONNECT_DELAY;
+        _pending.clear();
+    }
+
+    void MqttTelemetry::publish(const char* subtopic, const std::string& payload, bool retain) {
+        if (_pending.length() > MAX_PENDING_BYTES) {
+            return;  // The broker is not keeping up, so telemetry is dropped
+        }
+        std::string topic(_topic);
+        topic += '/';
+        topic += subtopic;
+        Mqtt::publish(_pending, topic, payload, retain);
+        ++_messages_sent;
+    }
+
+    // Collects the publishes for this poll from the same data as the status report
+    void MqttTelemetry::collect() {
+        const char* state = state_name();
+        if (state != _last_state) {
+            publish("state", state, true);
+            _last_state = state;
+        }
+
+        uint8_t alarm = state_is(State::Alarm) ? uint8_t(lastAlarm) : 0;
+        if (alarm != _last_alarm) {
+            if (alarm) {
+                std::string payload(std::to_string(alarm));
+                payload += ' ';
+                payload += alarmString(ExecAlarm(alarm));
+                publish("alarm", payload);
+            }
+            _last_alarm = alarm;
+        }
+
+        bool idle = state_is(State::Idle);
+        if (!idle && !_in_cycle && state_is(State::Cycle)) {
+            _in_cycle    = true;
+            _cycle_start = xTaskGetTickCount();
+        } else if (idle && _in_cycle) {
+            _in_cycle = false;
+            publish("cycle", std::to_string((int32_t(xTaskGetTickCount()) - _cycle_start) / configTICK_RATE_HZ));
+        }
+
+        if (elapsed(_next_metrics)) {
+            _next_metrics = xTaskGetTickCount() + mqtt_interval->get();
+
+            StatusFrame::Fields fields;
+            report_status_fields(allChannels, fields);
+
+            std::string payload;
+            JSONencoder j(&payload);
+            j.begin();
+            j.member("state", state);
+            j.begin_member_object((fields.flags & StatusFrame::WorkPosition) ? "wpos_um" : "mpos_um");
+            for (size_t axis = 0; axis < fields.n_axis; axis++) {
+                char name[2] = { Axes::axisName(axis), '\0' };
+                j.member(name, int(fields.position[axis] * 1000.0f));
+            }
+            j.end_object();
+            j.member("feed", int(fields.feed_rate));
+            j.member("spindle", int(fields.spindle_speed));
+            j.member("feed_override", fields.feed_override);
+            j.member("rapid_override", fields.rapid_override);
+            j.member("spindle_override", fields.spindle_override);
+            if (fields.line_number) {
+                j.member("line", int(fields.line_number));
+            }
+            if (Job::active()) {
+                j.member("job", Job::channel()->_progress);
+            }
+            j.end();
+            publish("metrics", payload);
+        }
+    }
+
+    void MqttTelemetry::send_pending() {
+        if (_pending.empty()) {
+            if (elapsed(_last_send + KEEPALIVE_S * configTICK_RATE_HZ / 2)) {
+                Mqtt::pingreq(_pending);
+            } else {
+                return;
+            }
+        }
+        size_t written = _client.write(reinterpret_cast<const uint8_t*>(_pending.data()), _pending.length());
+        if (written != _pending.length()) {
+            log_debug("MQTT write failed");
+            disconnect();
+            return;
+        }
+        _pending.clear();
+        _last_send = xTaskGetTickCount();
+    }
+
+    void MqttTelemetry::poll() {
+        if (!_started) {
+            return;
+        }
+        if (_connecting) {
+            check_connack();
+            return;
+        }
+        if (!_connected) {
+            try_connect();
+            return;
+        }
+        if (!_client.connected()) {
+            log_info("MQTT connection lost");
+            disconnect();
+            return;
+        }
+        // Discard PINGRESPs; nothing else is subscribed to
+        while (_client.available()) {
+            _client.read();
+        }
+        collect();
+        send_pending();
+    }
+
+    void MqttTelemetry::wifi_stats(JSONencoder& j) {
+        if (!_started) {
+            return;
+        }
+        std::string status(_connected ? "Connected to " : "Not connected to ");
+        status += mqtt_broker->get();
+        status += " messages:" + std::to_string(_messages_sent);
+        status += " failed connects:" + std::to_string(_connect_failures);
+        j.id_value_object("MQTT", status);
+    }
+
+    MqttTelemetry::~MqttTelemetry() {
+        deinit();
+    }
+
+    ModuleFactory::InstanceBuilder<MqttTelemetry> __attribute__((init_priority(112))) mqtt_module("mqtt_telemetry", true);
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include "src/Module.h"  // Module
+#include "src/Settings.h"
+
+#include <WiFi.h>
+#include <string>
+
+namespace WebUI {
+    // Publishes machine telemetry to an MQTT broker, so that a shop's MES can
+    // collect it without a bridge that polls each machine over a WebSocket.
+    // Under the topic prefix, it publishes
+    //   state   the state name, retained, whenever it changes
+    //   alarm   the alarm number and name, when an alarm is raised
+    //   cycle   the seconds from leaving Idle to returning to it
+    //   metrics a JSON object with position, speeds, overrides and job progress,
+    //           every MQTT/IntervalMs
+    // All messages are QoS 0.  The publishes collected during one poll are sent
+    // to the broker in a single write.
+    class MqttTelemetry : public Module {
+        static const int DEFAULT_MQTT_STATE = 0;
+        static const int DEFAULT_MQTT_PORT  = 1883;
+
+        static const int MIN_MQTT_PORT = 1;
+        static const int MAX_MQTT_PORT = 65535;
+
+        static const int DEFAULT_MQTT_INTERVAL = 5000;
+        static const int MIN_MQTT_INTERVAL     = 500;
+        static const int MAX_MQTT_INTERVAL     = 3600000;
+
+        static const int KEEPALIVE_S       = 60;
+        static const int CONNECT_TIMEOUT   = 500;   // ms; the connection is made on the polling task
+        static const int RECONNECT_DELAY   = 10000;  // ms
+        static const int CONNACK_TIMEOUT   = 5000;   // ms
+        static const int MAX_PENDING_BYTES = 4096;
+
+        WiFiClient  _client;
+        bool        _started    = false;
+        bool        _connected  = false;  // CONNACK received
+        bool        _connecting = false;  // CONNECT sent, waiting for CONNACK
+        int32_t     _connect_time = 0;
+        int32_t     _next_metrics = 0;
+        int32_t     _last_send    = 0;
+        std::string _topic;
+        std::string _pending;  // Packets collected during this poll
+
+        const char* _last_state       = "";
+        uint8_t     _last_alarm       = 0;
+        bool        _in_cycle         = false;
+        int32_t     _cycle_start      = 0;
+        uint32_t    _messages_sent    = 0;
+        uint32_t    _connect_failures = 0;
+
+        void try_connect();
+        void check_connack();
+        void collect();
+        void publish(const char* subtopic, const std::string& payload, bool retain = false);
+        void send_pending();
+        void disconnect();
+
+    public:
+        MqttTelemetry(const char* name) : Module(name) {}
+
+        void init_settings() override;
+        void init() override;
+        void deinit() override;
+        bool deferred_init() override { return true; }
+        void poll() override;
+        void wifi_stats(JSONencoder& j) override;
+
+        ~MqttTelemetry();
+    };
+}
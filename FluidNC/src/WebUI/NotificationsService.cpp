@@ -16,6 +16,7 @@
 #include "NotificationsService.h"
 
 #include "src/Machine/MachineConfig.h"
+#include "src/JSONEncoder.h"
 
 #include <WiFiClientSecure.h>
 #include <base64.h>
@@ -55,6 +56,12 @@ namespace WebUI {
     std::string NotificationsService::_serveraddress;
     uint16_t    NotificationsService::_port;
 
+    QueueHandle_t NotificationsService::_queue   = nullptr;
+    TaskHandle_t  NotificationsService::_task    = nullptr;
+    uint32_t      NotificationsService::_sent    = 0;
+    uint32_t      NotificationsService::_failed  = 0;
+    uint32_t      NotificationsService::_dropped = 0;
+
     const enum_opt_t notificationOptions = {
         { "NONE", 0 },
         { "LINE", 3 },
@@ -72,7 +79,8 @@ namespace WebUI {
             log_stream(out, notification_type->getStringValue() << " " << notification_ts->getStringValue());
             return Error::Ok;
         }
-        std::string s;
+        std::string          s;
+        Setting::Transaction transaction;
 
         if (!get_param(parameter, "type=", s)) {
             return Error::InvalidValue;
@@ -115,7 +123,7 @@ namespace WebUI {
             return Error::InvalidValue;
         }
         if (!sendMSG("GRBL Notification", parameter)) {
-            log_string(out, "Cannot send message!");
+            log_string(out, "Cannot queue message!");
             return Error::MessageFailed;
         }
         return Error::Ok;
@@ -170,28 +178,64 @@ namespace WebUI {
     }
 
     bool NotificationsService::sendMSG(const char* title, const char* message) {
-        if (!_started) {
+        if (!_started || !_queue || ((strlen(title) == 0) && (strlen(message) == 0))) {
             return false;
         }
-        if (!((strlen(title) == 0) && (strlen(message) == 0))) {
-            switch (_notificationType) {
-                case PUSHOVER_NOTIFICATION:
-                    return sendPushoverMSG(title, message);
-                    break;
-                case EMAIL_NOTIFICATION:
-                    return sendEmailMSG(title, message);
-                    break;
-                case LINE_NOTIFICATION:
-                    return sendLineMSG(title, message);
-                    break;
-                case TELEGRAM_NOTIFICATION:
-                    return sendTelegramMSG(title, message);
-                    break;
-                default:
+        auto msg = new Message { title, message };
+        if (!xQueueSend(_queue, &msg, 0)) {
+            // The server is slower than the messages are coming
+            delete msg;
+            ++_dropped;
+            log_debug("Notification queue full, dropped " << title);
+            return false;
+        }
+        return true;
+    }
+
+    // A send can take seconds when a server is slow, so it is done here rather
+    // than on the polling task that raised the notification
+    void NotificationsService::notify_loop(void* unused) {
+        while (true) {
+            Message* msg;
+            if (!xQueueReceive(_queue, &msg, portMAX_DELAY)) {
+                continue;
+            }
+            TickType_t retry_delay = RETRY_DELAY;
+            bool       sent        = false;
+            for (int attempt = 1; _started && attempt <= SEND_ATTEMPTS; ++attempt) {
+                if (deliver(msg->title.c_str(), msg->text.c_str())) {
+                    sent = true;
                     break;
+                }
+                if (attempt < SEND_ATTEMPTS) {
+                    log_debug("Notification failed, retrying in " << retry_delay << " ms");
+                    vTaskDelay(retry_delay / portTICK_PERIOD_MS);
+                    retry_delay *= 4;
+                }
+            }
+            if (sent) {
+                ++_sent;
+            } else {
+                ++_failed;
+                log_info("Cannot send notification " << msg->title);
             }
+            delete msg;
+        }
+    }
+
+    bool NotificationsService::deliver(const char* title, const char* message) {
+        switch (_notificationType) {
+            case PUSHOVER_NOTIFICATION:
+                return sendPushoverMSG(title, message);
+            case EMAIL_NOTIFICATION:
+                return sendEmailMSG(title, message);
+            case LINE_NOTIFICATION:
+                return sendLineMSG(title, message);
+            case TELEGRAM_NOTIFICATION:
+                return sendTelegramMSG(title, message);
+            default:
+                return false;
         }
-        return false;
     }
 
     //Messages are currently limited to 1024 4-byte UTF-8 characters
@@ -427,9 +471,7 @@ namespace WebUI {
         return true;
     }
 
-    void NotificationsService::init() {
-        deinit();
-
+    void NotificationsService::init_settings() {
         new WebCommand(
             "TYPE=NONE|PUSHOVER|EMAIL|LINE T1=token1 T2=token2 TS=settings", WEBCMD, WA, "ESP610", "Notification/Setup", showSetNotification);
         notification_ts = new StringSetting(
@@ -453,6 +495,10 @@ namespace WebUI {
         notification_type =
             new EnumSetting("Notification type", WEBSET, WA, NULL, "Notification/Type", DEFAULT_NOTIFICATION_TYPE, &notificationOptions);
         new WebCommand("message", WEBCMD, WU, "ESP600", "Notification/Send", sendMessage);
+    }
+
+    void NotificationsService::init() {
+        deinit();
 
         _notificationType = notification_type->get();
         switch (_notificationType) {
@@ -492,10 +538,27 @@ namespace WebUI {
         }
         if (!res) {
             deinit();
+            return;
+        }
+        if (!_task) {
+            _queue = xQueueCreate(QUEUE_LENGTH, sizeof(Message*));
+            Machine::Tasks::get()._notifications.create(notify_loop, nullptr, &_task);
         }
         _started = res;
     }
 
+    void NotificationsService::wifi_stats(JSONencoder& j) {
+        if (!_started) {
+            return;
+        }
+        std::string status(getTypeString());
+        status += " sent:" + std::to_string(_sent);
+        status += " failed:" + std::to_string(_failed);
+        status += " dropped:" + std::to_string(_dropped);
+        status += " queued:" + std::to_string(uxQueueMessagesWaiting(_queue));
+        j.id_value_object("Notifications", status);
+    }
+
     void NotificationsService::deinit() {
         if (!_started) {
             return;
@@ -7,6 +7,9 @@
 #include "src/WebUI/Authentication.h"
 
 #include <cstdint>
+#include <string>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
 
 namespace WebUI {
     class NotificationsService : public Module {
@@ -19,12 +22,17 @@ namespace WebUI {
             _settings         = "";
         }
 
+        // Queues the message for the notification task, so the caller is not
+        // held up by the server.  Returns false if it could not be queued.
         static bool        sendMSG(const char* title, const char* message);
         static const char* getTypeString();
         static bool        started();
 
+        void init_settings() override;
         void init() override;
         void deinit() override;
+        bool deferred_init() override { return true; }
+        void wifi_stats(JSONencoder& j) override;
 
         ~NotificationsService();
 
@@ -37,6 +45,25 @@ namespace WebUI {
         static std::string _serveraddress;
         static uint16_t    _port;
 
+        // Messages wait here for the notification task, which sends them one at a
+        // time, retrying a failed send after a growing delay
+        struct Message {
+            std::string title;
+            std::string text;
+        };
+        static const int QUEUE_LENGTH  = 8;
+        static const int SEND_ATTEMPTS = 3;
+        static const int RETRY_DELAY   = 2000;  // ms, multiplied by 4 after each failure
+
+        static QueueHandle_t _queue;
+        static TaskHandle_t  _task;
+        static uint32_t      _sent;
+        static uint32_t      _failed;
+        static uint32_t      _dropped;
+
+        static void notify_loop(void* unused);
+        static bool deliver(const char* title, const char* message);
+
         static Error sendMessage(const char* parameter, AuthenticationLevel auth_level, Channel& out);
         static bool  sendPushoverMSG(const char* title, const char* message);
         static bool  sendEmailMSG(const char* title, const char* message);
@@ -4,6 +4,7 @@
 #include "src/Module.h"
 
 #include "src/Logging.h"
+#include "Ethernet.h"  // network_off()
 #include <WiFi.h>
 #include "Driver/localfs.h"
 #include <ArduinoOTA.h>
@@ -12,8 +13,10 @@ class OTA : public Module {
 public:
     OTA(const char* name) : Module(name) {}
 
+    bool deferred_init() override { return true; }
+
     void init() override {
-        if (WiFi.getMode() == WIFI_OFF) {
+        if (WebUI::network_off()) {
             return;
         }
 
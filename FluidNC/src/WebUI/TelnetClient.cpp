@@ -5,11 +5,38 @@
 #include "TelnetServer.h"
 
 #include <WiFi.h>
+#include <algorithm>
 
 namespace WebUI {
-    TelnetClient::TelnetClient(WiFiClient* wifiClient) : Channel("telnet"), _wifiClient(wifiClient) {}
+    TelnetClient::TelnetClient(WiFiClient* wifiClient) : Channel("telnet"), _wifiClient(wifiClient) {
+        setRxWindow(telnet_rx_window->get());
+    }
+
+    void TelnetClient::handle() {
+        if (_state == -1) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(_output_mutex);
+            if (_output_length && (int32_t(xTaskGetTickCount()) - _output_time) >= telnet_flush_ms->get()) {
+                sendOutput();
+            }
+        }
 
-    void TelnetClient::handle() {}
+        // Drain the socket into the queue so the sender's whole window can be in flight
+        uint8_t buffer[READ_CHUNK_SIZE];
+        while (size_t room = std::min(_rx.capacity() - _rx.size(), sizeof(buffer))) {
+            int avail = _wifiClient->available();
+            if (avail <= 0) {
+                break;
+            }
+            int n = _wifiClient->read(buffer, std::min(room, size_t(avail)));
+            if (n <= 0) {
+                break;
+            }
+            push(buffer, n);
+        }
+    }
 
     void TelnetClient::closeOnDisconnect() {
         if (_state != -1 && !_wifiClient->connected()) {
@@ -27,44 +54,72 @@ namespace WebUI {
     }
 
     size_t TelnetClient::write(const uint8_t* buffer, size_t length) {
-        // Replace \n with \r\n
-        size_t  rem      = length;
-        uint8_t lastchar = '\0';
-        size_t  j        = 0;
-        while (rem) {
-            const int bufsize = 128;
-            uint8_t   modbuf[bufsize];
-            // bufsize-1 in case the last character is \n
-            size_t k = 0;
-            while (rem && k < (bufsize - 1)) {
-                uint8_t c = buffer[j++];
-                if (c == '\n' && lastchar != '\r') {
-                    modbuf[k++] = '\r';
-                }
-                lastchar    = c;
-                modbuf[k++] = c;
-                --rem;
+        std::lock_guard<std::mutex> lock(_output_mutex);
+        for (size_t i = 0; i < length; i++) {
+            // Room for \r\n
+            if (_output_length + 2 > OUTPUT_BUFFER_SIZE) {
+                sendOutput();
+            }
+            if (!_output_length) {
+                _output_time = int32_t(xTaskGetTickCount());
             }
-            if (k) {
-                auto nWritten = _wifiClient->write(modbuf, k);
-                if (nWritten == 0) {
-                    closeOnDisconnect();
-                }
+            uint8_t c = buffer[i];
+            if (c == '\n' && _lastchar != '\r') {
+                _output[_output_length++] = '\r';
             }
+            _output[_output_length++] = c;
+            _lastchar                 = c;
+        }
+
+        // The end of a batch of queued messages, or a steady stream of output.
+        // Output that stops short of the deadline is sent by handle().
+        int32_t flush_ms = telnet_flush_ms->get();
+        if (flush_ms) {
+            if ((int32_t(xTaskGetTickCount()) - _output_time) >= flush_ms) {
+                sendOutput();
+            }
+        } else if (length && buffer[length - 1] == '\n' && !uxQueueMessagesWaiting(message_queue)) {
+            sendOutput();
         }
         return length;
     }
 
+    void TelnetClient::flush() {
+        std::lock_guard<std::mutex> lock(_output_mutex);
+        sendOutput();
+    }
+
+    // The caller holds _output_mutex
+    void TelnetClient::sendOutput() {
+        if (!_output_length) {
+            return;
+        }
+        if (_state != -1) {
+            auto nWritten = _wifiClient->write(_output, _output_length);
+            if (nWritten == 0) {
+                closeOnDisconnect();
+            } else {
+                ++_segments_sent;
+                _bytes_sent += nWritten;
+            }
+        }
+        _output_length = 0;
+    }
+
+    void TelnetClient::printStats(Print& out) {
+        out << " writes:" << _segments_sent << " bytes:" << _bytes_sent;
+    }
+
     int TelnetClient::peek(void) {
         return _wifiClient->peek();
     }
 
     int TelnetClient::available() {
-        return _wifiClient->available();
+        return _rx.size() + _wifiClient->available();
     }
 
     int TelnetClient::rx_buffer_available() {
-        return WIFI_CLIENT_READ_BUFFER_SIZE - available();
+        return std::max(0, _rx_window - available());
     }
 
     int TelnetClient::read(void) {
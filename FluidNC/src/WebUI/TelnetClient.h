@@ -6,23 +6,39 @@
 #include "src/Channel.h"
 
 #include <WiFi.h>
+#include <mutex>
 
 namespace WebUI {
     class TelnetClient : public Channel {
         WiFiClient* _wifiClient;
 
-        // The default value of the rx buffer in WiFiClient.cpp is 1436 which is
-        // related to the network frame size minus TCP/IP header sizes.
-        // The WiFiClient API has no way to override or query it.
-        // We use a smaller value for safety.  There is little advantage
-        // to sending too many GCode lines at once, especially since the
-        // common serial communication case is typically limited to 128 bytes.
-        static const int WIFI_CLIENT_READ_BUFFER_SIZE = 1200;
+        // Received data is moved from the WiFiClient into _rx as it arrives, so the
+        // window advertised to senders is not limited by the WiFiClient rx buffer,
+        // which is only 1436 bytes and cannot be changed or queried.
+        static const int READ_CHUNK_SIZE = 256;
 
         static const int DISCONNECT_CHECK_COUNTS = 1000;
 
         int _state = 0;
 
+        // Output is collected here, with \n expanded to \r\n, and written to the socket
+        // in one piece when the buffer fills or the oldest byte in it is Telnet/FlushMs
+        // old.  With a zero deadline it is also written when the output queue empties.
+        // The server disables Nagle's algorithm, so without this each "ok" would be a
+        // TCP segment of its own.
+        static const size_t OUTPUT_BUFFER_SIZE = 1024;
+
+        std::mutex _output_mutex;
+        uint8_t    _output[OUTPUT_BUFFER_SIZE];
+        size_t     _output_length = 0;
+        int32_t    _output_time   = 0;  // When the oldest byte in _output was added
+        uint8_t    _lastchar      = '\0';
+
+        uint32_t _segments_sent = 0;
+        uint32_t _bytes_sent    = 0;
+
+        void sendOutput();
+
     public:
         TelnetClient(WiFiClient* wifiClient);
 
@@ -32,12 +48,13 @@ namespace WebUI {
         int    read(void) override;
         int    peek(void) override;
         int    available() override;
-        void   flush() override {}
+        void   flush() override;
         void   flushRx() override;
 
         void closeOnDisconnect();
 
         void handle() override;
+        void printStats(Print& out) override;
 
         ~TelnetClient();
     };
@@ -4,6 +4,7 @@
 #include "src/Machine/MachineConfig.h"
 #include "TelnetClient.h"
 #include "TelnetServer.h"
+#include "Ethernet.h"  // network_off()
 
 #include "Mdns.h"
 #include "src/Report.h"  // report_init_message()
@@ -14,23 +15,33 @@ namespace WebUI {
 
     EnumSetting* telnet_enable;
     IntSetting*  telnet_port;
+    IntSetting*  telnet_rx_window;
+    IntSetting*  telnet_flush_ms;
 
     uint16_t TelnetServer::_port = 0;
 
     std::queue<TelnetClient*> TelnetServer::_disconnected;
 
+    void TelnetServer::init_settings() {
+        telnet_port =
+            new IntSetting("Telnet Port", WEBSET, WA, "ESP131", "Telnet/Port", DEFAULT_TELNETSERVER_PORT, MIN_TELNET_PORT, MAX_TELNET_PORT);
+
+        telnet_enable = new EnumSetting("Telnet Enable", WEBSET, WA, "ESP130", "Telnet/Enable", DEFAULT_TELNET_STATE, &onoffOptions);
+
+        telnet_rx_window = new IntSetting(
+            "Telnet Receive Window", WEBSET, WA, NULL, "Telnet/RxWindow", DEFAULT_TELNET_RX_WINDOW, MIN_TELNET_RX_WINDOW, MAX_TELNET_RX_WINDOW);
+
+        telnet_flush_ms =
+            new IntSetting("Telnet Output Flush Deadline", WEBSET, WA, NULL, "Telnet/FlushMs", DEFAULT_TELNET_FLUSH_MS, 0, MAX_TELNET_FLUSH_MS);
+    }
+
     void TelnetServer::init() {
-        if (WiFi.getMode() == WIFI_OFF) {
+        if (network_off()) {
             return;
         }
 
         deinit();
 
-        telnet_port =
-            new IntSetting("Telnet Port", WEBSET, WA, "ESP131", "Telnet/Port", DEFAULT_TELNETSERVER_PORT, MIN_TELNET_PORT, MAX_TELNET_PORT);
-
-        telnet_enable = new EnumSetting("Telnet Enable", WEBSET, WA, "ESP130", "Telnet/Enable", DEFAULT_TELNET_STATE, &onoffOptions);
-
         if (!WebUI::telnet_enable->get()) {
             return;
         }
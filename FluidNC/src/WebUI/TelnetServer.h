@@ -13,6 +13,9 @@
 class TelnetClient;
 
 namespace WebUI {
+    extern IntSetting* telnet_rx_window;
+    extern IntSetting* telnet_flush_ms;
+
     class TelnetServer : public Module {
         static const int DEFAULT_TELNET_STATE      = 1;
         static const int DEFAULT_TELNETSERVER_PORT = 23;
@@ -22,6 +25,13 @@ namespace WebUI {
 
         static const int MAX_TLNT_CLIENTS = 2;
 
+        static const int DEFAULT_TELNET_RX_WINDOW = 4096;
+        static const int MIN_TELNET_RX_WINDOW     = 256;
+        static const int MAX_TELNET_RX_WINDOW     = 16384;
+
+        static const int DEFAULT_TELNET_FLUSH_MS = 2;
+        static const int MAX_TELNET_FLUSH_MS     = 100;
+
         static const int FLUSHTIMEOUT = 500;
 
     public:
@@ -31,8 +41,10 @@ namespace WebUI {
 
         static std::queue<TelnetClient*> _disconnected;
 
+        void init_settings() override;
         void init() override;
         void deinit() override;
+        bool deferred_init() override { return true; }
         void poll() override;
         void status_report(Channel& out) override;
 
@@ -0,0 +1,123 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "UdpStatus.h"
+#include "Ethernet.h"  // network_off()
+
+#include "src/Serial.h"  // allChannels
+#include "src/Report.h"  // report_realtime_status()
+
+#include <WiFi.h>
+
+namespace WebUI {
+    EnumSetting*   udp_status_enable;
+    IPaddrSetting* udp_status_address;
+    IntSetting*    udp_status_port;
+    IntSetting*    udp_status_interval;
+
+    void UdpStatus::init_settings() {
+        udp_status_enable = new EnumSetting("UDP Status Enable", WEBSET, WA, NULL, "UDPStatus/Enable", DEFAULT_UDP_STATUS_STATE, &onoffOptions);
+
+        // A multicast group like 239.x.x.x reaches only the monitors that join it;
+        // the broadcast address reaches every host on the local network.
+        udp_status_address = new IPaddrSetting("UDP Status Address", WEBSET, WA, NULL, "UDPStatus/Address", "239.255.70.78");
+
+        udp_status_port = new IntSetting(
+            "UDP Status Port", WEBSET, WA, NULL, "UDPStatus/Port", DEFAULT_UDP_STATUS_PORT, MIN_UDP_STATUS_PORT, MAX_UDP_STATUS_PORT);
+
+        udp_status_interval = new IntSetting("UDP Status Interval",
+                                             WEBSET,
+                                             WA,
+                                             NULL,
+                                             "UDPStatus/IntervalMs",
+                                             DEFAULT_UDP_STATUS_INTERVAL,
+                                             MIN_UDP_STATUS_INTERVAL,
+                                             MAX_UDP_STATUS_INTERVAL);
+    }
+
+    void UdpStatus::init() {
+        if (network_off()) {
+            return;
+        }
+
+        if (!udp_status_enable->get()) {
+            return;
+        }
+
+        _address  = IPAddress(udp_status_address->get());
+        _port     = udp_status_port->get();
+        _interval = udp_status_interval->get();
+        _nextTime = int32_t(xTaskGetTickCount());
+
+        if (!_udp.begin(_port)) {
+            log_error("UDP status cannot open port " << _port);
+            return;
+        }
+        _started = true;
+
+        // Only status reports are sent, so the channel takes no log messages
+        _message_level = MsgLevelNone;
+        allChannels.registration(this);
+
+        log_info("UDP status to " << IP_string(_address) << ":" << _port << " every " << _interval << " ms");
+    }
+
+    void UdpStatus::deinit() {
+        if (_started) {
+            allChannels.deregistration(this);
+            _udp.stop();
+            _started = false;
+        }
+    }
+
+    // The report arrives one piece at a time through the Print interface.  Only
+    // complete status reports are sent, one line per packet.
+    size_t UdpStatus::write(uint8_t data) {
+        return write(&data, 1);
+    }
+
+    size_t UdpStatus::write(const uint8_t* buffer, size_t length) {
+        for (size_t i = 0; i < length; i++) {
+            char c = buffer[i];
+            if (c == '\r') {
+                continue;
+            }
+            if (c == '\n') {
+                if (_length && _packet[0] == '<' && _started) {
+                    _udp.beginPacket(_address, _port);
+                    _udp.write(reinterpret_cast<const uint8_t*>(_packet), _length);
+                    if (_udp.endPacket()) {
+                        ++_packets_sent;
+                    }
+                }
+                _length = 0;
+                continue;
+            }
+            if (_length < MAX_PACKET) {
+                _packet[_length++] = c;
+            }
+        }
+        return length;
+    }
+
+    // The report is produced here, on the polling task, at the configured rate
+    // whether or not anything changed, so a monitor that starts listening is
+    // brought up to date within one interval.
+    Error UdpStatus::pollLine(char* line) {
+        if (_started && (int32_t(xTaskGetTickCount()) - _nextTime) >= 0) {
+            _nextTime = xTaskGetTickCount() + _interval;
+            report_realtime_status(*this);
+        }
+        return Error::NoData;
+    }
+
+    void UdpStatus::printStats(Print& out) {
+        out << " packets:" << _packets_sent;
+    }
+
+    UdpStatus::~UdpStatus() {
+        deinit();
+    }
+
+    ModuleFactory::InstanceBuilder<UdpStatus> __attribute__((init_priority(111))) udp_status_module("udp_status", true);
+}
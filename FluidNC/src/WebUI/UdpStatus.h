@@ -0,0 +1,69 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include "src/Module.h"   // Module
+#include "src/Channel.h"  // Channel
+
+#include "src/Settings.h"
+
+#include <WiFiUdp.h>
+
+namespace WebUI {
+    // Sends a status report to a UDP multicast or broadcast address at a fixed
+    // rate, for displays that only watch the machine.  Any number of them can
+    // listen to the same packets, where each WebSocket or Telnet monitor would
+    // cost a channel and a poll of its own.  The packet payload is the text of
+    // the status report, without the newline.
+    class UdpStatus : public Channel, public Module {
+        static const int DEFAULT_UDP_STATUS_STATE = 0;
+        static const int DEFAULT_UDP_STATUS_PORT  = 24681;
+
+        static const int MIN_UDP_STATUS_PORT = 1;
+        static const int MAX_UDP_STATUS_PORT = 65535;
+
+        static const int DEFAULT_UDP_STATUS_INTERVAL = 250;
+        static const int MIN_UDP_STATUS_INTERVAL     = 50;
+        static const int MAX_UDP_STATUS_INTERVAL     = 10000;
+
+        static const size_t MAX_PACKET = 256;
+
+        WiFiUDP   _udp;
+        IPAddress _address;
+        uint16_t  _port     = 0;
+        uint32_t  _interval = 0;
+        int32_t   _nextTime = 0;
+        bool      _started  = false;
+
+        // The report being collected from write()
+        char   _packet[MAX_PACKET];
+        size_t _length = 0;
+
+        uint32_t _packets_sent = 0;
+
+    public:
+        UdpStatus(const char* name) : Channel(name), Module(name) {}
+
+        UdpStatus(const UdpStatus&)            = delete;
+        UdpStatus& operator=(const UdpStatus&) = delete;
+
+        void init_settings() override;
+        void init() override;
+        void deinit() override;
+        bool deferred_init() override { return true; }
+
+        size_t write(uint8_t data) override;
+        size_t write(const uint8_t* buffer, size_t length) override;
+
+        Error pollLine(char* line) override;
+        void  flushRx() override {}
+
+        bool   lineComplete(char*, char) override { return false; }
+        size_t timedReadBytes(char* buffer, size_t length, TickType_t timeout) override { return 0; }
+
+        void printStats(Print& out) override;
+
+        ~UdpStatus();
+    };
+}
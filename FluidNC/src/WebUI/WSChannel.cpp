@@ -8,12 +8,23 @@
 #include <WebSocketsServer.h>
 #include <WiFi.h>
 
-#include "src/Serial.h"  // is_realtime_command
+#include "src/Serial.h"   // is_realtime_command
+#include "src/Report.h"   // report_status_fields
+#include "src/HeapTag.h"  // HeapTag
 
 namespace WebUI {
     class WSChannels;
 
-    WSChannel::WSChannel(WebSocketsServer* server, uint8_t clientNum) : Channel("websocket"), _server(server), _clientNum(clientNum) {}
+    // A WebSocket message is queued whole, and senders may put many lines in one
+    static const size_t rx_capacity = 2048;
+
+    static HeapTag heap_tag("WebSocket");
+
+    WSChannel::WSChannel(WebSocketsServer* server, uint8_t clientNum) : Channel("websocket"), _server(server), _clientNum(clientNum) {
+        _rx.set_capacity(rx_capacity);
+        setRxWindow(websocket_rx_window->get());
+        heap_tag.allocated(this, sizeof(WSChannel) + rx_capacity);
+    }
 
     int WSChannel::read() {
         if (!_active) {
@@ -40,39 +51,72 @@ namespace WebUI {
         if (buffer == NULL || !_active || !size) {
             return 0;
         }
-
-        bool complete_line = buffer[size - 1] == '\n';
-
-        const uint8_t* out;
-        size_t         outlen;
-        if (_output_line.length() == 0 && complete_line) {
-            // Avoid the overhead of std::string if the
-            // input is a complete line and nothing is pending.
-            out    = buffer;
-            outlen = size;
-        } else {
-            // Otherwise collect input until we have line.
-            _output_line.append((char*)buffer, size);
-            if (!complete_line) {
+        std::lock_guard<std::mutex> lock(_output_mutex);
+
+        if (_output_length + size > OUTPUT_BUFFER_SIZE) {
+            sendLines();
+            if (_output_length + size > OUTPUT_BUFFER_SIZE) {
+                // Too long to collect, so send it along with any partial line before it
+                if (_output_length && !sendMessage(_output, _output_length)) {
+                    return 0;
+                }
+                _output_length = 0;
+                sendMessage(buffer, size);
                 return size;
             }
+        }
 
-            out    = (uint8_t*)_output_line.c_str();
-            outlen = _output_line.length();
+        memcpy(_output + _output_length, buffer, size);
+        _output_length += size;
+        for (size_t i = size; i; --i) {
+            if (buffer[i - 1] == '\n') {
+                if (!_output_lines) {
+                    _output_time = int32_t(xTaskGetTickCount());
+                }
+                _output_lines = _output_length - (size - i);
+                break;
+            }
         }
-        int stat = _server->canSend(_clientNum);
-        if (stat < 0) {
-            _active = false;
-            return 0;
+
+        // The end of a batch of queued messages
+        if (_output_lines && !uxQueueMessagesWaiting(message_queue)) {
+            sendLines();
         }
-        if (!_server->sendBIN(_clientNum, out, outlen)) {
-            _active = false;
+        return size;
+    }
+
+    void WSChannel::flush() {
+        std::lock_guard<std::mutex> lock(_output_mutex);
+        sendLines();
+    }
+
+    // Sends the complete lines in _output.  The caller holds _output_mutex.
+    void WSChannel::sendLines() {
+        if (!_output_lines) {
+            return;
+        }
+        sendMessage(_output, _output_lines);
+        _output_length -= _output_lines;
+        memmove(_output, _output + _output_lines, _output_length);
+        _output_lines = 0;
+    }
+
+    bool WSChannel::sendMessage(const uint8_t* data, size_t length) {
+        if (!_active) {
+            return false;
         }
-        if (_output_line.length()) {
-            _output_line = "";
+        int stat = _server->canSend(_clientNum);
+        if (stat < 0 || !_server->sendBIN(_clientNum, data, length)) {
+            _active = false;
+            return false;
         }
+        ++_messages_sent;
+        _bytes_sent += length;
+        return true;
+    }
 
-        return size;
+    void WSChannel::printStats(Print& out) {
+        out << " messages:" << _messages_sent << " bytes:" << _bytes_sent;
     }
 
     bool WSChannel::sendTXT(std::string& s) {
@@ -101,57 +145,86 @@ namespace WebUI {
             return;
         }
 
+        {
+            std::lock_guard<std::mutex> lock(_output_mutex);
+            if (_output_lines && (int32_t(xTaskGetTickCount()) - _output_time) >= int32_t(OUTPUT_FLUSH_MS)) {
+                sendLines();
+            }
+        }
+
         Channel::autoReport();
+        if (_frameInterval && (int32_t(xTaskGetTickCount()) - _nextFrameTime) >= 0) {
+            _nextFrameTime = xTaskGetTickCount() + _frameInterval;
+            sendFrame();
+        }
     }
 
-    WSChannel::~WSChannel() {}
+    bool WSChannel::setFrameInterval(uint32_t ms) {
+        if (ms) {
+            ms = std::max(ms, MIN_FRAME_INTERVAL);
+        }
+        _frameInterval   = ms;
+        _nextFrameTime   = int32_t(xTaskGetTickCount());
+        _lastFrameLength = 0;  // Send the first frame even if nothing changes
+        return true;
+    }
 
-    std::map<uint8_t, WSChannel*> WSChannels::_wsChannels;
-    std::list<WSChannel*>         WSChannels::_webWsChannels;
+    void WSChannel::sendFrame() {
+        StatusFrame::Fields fields;
+        report_status_fields(*this, fields);
 
-    WSChannel* WSChannels::_lastWSChannel = nullptr;
+        uint8_t frame[StatusFrame::max_size];
+        size_t  length = StatusFrame::encode(fields, frame);
 
-    WSChannel* WSChannels::getWSChannel(int pageid) {
-        WSChannel* wsChannel = nullptr;
-        if (pageid != -1) {
-            try {
-                wsChannel = _wsChannels.at(pageid);
-            } catch (std::out_of_range& oor) {}
-        } else {
-            // If there is no PAGEID URL argument, it is an old version of WebUI
-            // that does not supply PAGEID in all cases.  In that case, we use
-            // the most recently used websocket if it is still in the list.
-            for (auto it = _wsChannels.begin(); it != _wsChannels.end(); ++it) {
-                if (it->second == _lastWSChannel) {
-                    wsChannel = _lastWSChannel;
-                    break;
-                }
-            }
+        // A machine at rest would send the same frame over and over
+        if (length == _lastFrameLength && !memcmp(frame, _lastFrame, length)) {
+            return;
+        }
+        if (!_server->sendBIN(_clientNum, frame, length)) {
+            _active = false;
+            return;
         }
-        _lastWSChannel = wsChannel;
+        memcpy(_lastFrame, frame, length);
+        _lastFrameLength = length;
+    }
+
+    WSChannel::~WSChannel() {
+        heap_tag.freed(this, sizeof(WSChannel) + rx_capacity);
+    }
+
+    static_assert(WEBSOCKETS_SERVER_CLIENT_MAX <= WSChannels::MAX_CLIENTS, "WSChannels table too small");
+
+    WSChannel* WSChannels::_wsChannels[MAX_CLIENTS]    = {};
+    bool       WSChannels::_webWsChannels[MAX_CLIENTS] = {};
+
+    int WSChannels::_lastWSChannel = -1;
+
+    WSChannel* WSChannels::getWSChannel(int pageid) {
+        // If there is no PAGEID URL argument, it is an old version of WebUI
+        // that does not supply PAGEID in all cases.  In that case, we use
+        // the most recently used websocket if it is still connected.
+        WSChannel* wsChannel = channel(pageid == -1 ? _lastWSChannel : pageid);
+        _lastWSChannel       = wsChannel ? wsChannel->id() : -1;
         return wsChannel;
     }
 
     void WSChannels::removeChannel(uint8_t num) {
-        try {
-            WSChannel* wsChannel = _wsChannels.at(num);
-            _webWsChannels.remove(wsChannel);
+        WSChannel* wsChannel = channel(num);
+        if (wsChannel) {
+            _webWsChannels[num] = false;
             allChannels.kill(wsChannel);
-            _wsChannels.erase(num);
-        } catch (std::out_of_range& oor) {}
+            _wsChannels[num] = nullptr;
+        }
     }
 
-    void WSChannels::removeChannel(WSChannel* channel) {
-        _lastWSChannel = nullptr;
-        _webWsChannels.remove(channel);
-        allChannels.kill(channel);
-        for (auto it = _wsChannels.cbegin(); it != _wsChannels.cend();) {
-            if (it->second == channel) {
-                it = _wsChannels.erase(it);
-            } else {
-                ++it;
-            }
+    void WSChannels::removeChannel(WSChannel* wsChannel) {
+        _lastWSChannel = -1;
+        int num        = wsChannel->id();
+        if (channel(num) == wsChannel) {
+            _webWsChannels[num] = false;
+            _wsChannels[num]    = nullptr;
         }
+        allChannels.kill(wsChannel);
     }
 
     bool WSChannels::runGCode(int pageid, std::string_view cmd) {
@@ -182,7 +255,11 @@ namespace WebUI {
         return true;
     }
     void WSChannels::sendPing() {
-        for (WSChannel* wsChannel : _webWsChannels) {
+        for (int num = 0; num < MAX_CLIENTS; num++) {
+            if (!_webWsChannels[num]) {
+                continue;
+            }
+            WSChannel*  wsChannel = _wsChannels[num];
             std::string s("PING:");
             s += std::to_string(wsChannel->id());
             // sendBIN would be okay too because the string contains only
@@ -207,7 +284,7 @@ namespace WebUI {
                     IPAddress ip = server->remoteIP(num);
                     log_debug_to(Uart0, "WebSocket " << num << " from " << ip << " uri " << uri);
 
-                    _lastWSChannel = wsChannel;
+                    _lastWSChannel = num;
                     allChannels.registration(wsChannel);
                     _wsChannels[num] = wsChannel;
 
@@ -215,7 +292,7 @@ namespace WebUI {
                         std::string s("CURRENT_ID:");
                         s += std::to_string(num);
                         // send message to client
-                        _webWsChannels.push_front(wsChannel);
+                        _webWsChannels[num] = true;
                         wsChannel->sendTXT(s);
                         s = "ACTIVE_ID:";
                         s += std::to_string(wsChannel->id());
@@ -225,9 +302,9 @@ namespace WebUI {
             } break;
             case WStype_TEXT:
             case WStype_BIN:
-                try {
-                    _wsChannels.at(num)->push(payload, length);
-                } catch (std::out_of_range& oor) {}
+                if (WSChannel* wsChannel = channel(num)) {
+                    wsChannel->push(payload, length);
+                }
                 break;
             default:
                 break;
@@ -251,7 +328,7 @@ namespace WebUI {
                     IPAddress ip = server->remoteIP(num);
                     log_debug_to(Uart0, "WebSocket " << num << " from " << ip << " uri " << uri);
 
-                    _lastWSChannel = wsChannel;
+                    _lastWSChannel = num;
                     allChannels.registration(wsChannel);
                     _wsChannels[num] = wsChannel;
 
@@ -259,7 +336,7 @@ namespace WebUI {
                         std::string s("currentID:");
                         s += std::to_string(num);
                         // send message to client
-                        _webWsChannels.push_front(wsChannel);
+                        _webWsChannels[num] = true;
                         wsChannel->sendTXT(s);
                         s = "activeID:";
                         s += std::to_string(wsChannel->id());
@@ -273,19 +350,19 @@ namespace WebUI {
                 }
             } break;
             case WStype_TEXT:
-                try {
+                if (WSChannel* wsChannel = channel(num)) {
                     std::string msg = (const char*)payload;
                     if (msg.rfind("PING:", 0) == 0) {
                         std::string response("PING:60000:60000");
-                        _wsChannels.at(num)->sendTXT(response);
+                        wsChannel->sendTXT(response);
                     } else
-                        _wsChannels.at(num)->push(payload, length);
-                } catch (std::out_of_range& oor) {}
+                        wsChannel->push(payload, length);
+                }
                 break;
             case WStype_BIN:
-                try {
-                    _wsChannels.at(num)->push(payload, length);
-                } catch (std::out_of_range& oor) {}
+                if (WSChannel* wsChannel = channel(num)) {
+                    wsChannel->push(payload, length);
+                }
                 break;
             default:
                 break;
@@ -5,12 +5,12 @@
 
 #include <cstdint>
 #include <cstring>
-#include <list>
-#include <map>
+#include <mutex>
 
 class WebSocketsServer;
 
 #include "src/Channel.h"
+#include "src/StatusFrame.h"
 
 namespace WebUI {
     class WSChannel : public Channel {
@@ -28,43 +28,78 @@ namespace WebUI {
         inline size_t write(unsigned int n) { return write((uint8_t)n); }
         inline size_t write(int n) { return write((uint8_t)n); }
 
-        void flush(void) override {}
+        void flush(void) override;
 
         int id() { return _clientNum; }
 
-        int rx_buffer_available() override { return std::max(0, 256 - int(_queue.size())); }
-
         operator bool() const;
 
         ~WSChannel();
 
         int read() override;
-        int available() override { return _queue.size() + (_rtchar > -1); }
+        int available() override { return _rx.size() + (_rtchar > -1); }
 
         void autoReport() override;
+        void printStats(Print& out) override;
+
+        bool     setFrameInterval(uint32_t ms) override;
+        uint32_t getFrameInterval() override { return _frameInterval; }
 
     private:
         WebSocketsServer* _server;
         uint8_t           _clientNum;
 
-        std::string _output_line;
+        // Output is collected here and sent as one WebSocket message per batch of
+        // lines: when the output queue empties, when the buffer fills, or when the
+        // oldest unsent line is OUTPUT_FLUSH_MS old.  A partial line is held back
+        // until it is complete.
+        static const size_t   OUTPUT_BUFFER_SIZE = 1024;
+        static const uint32_t OUTPUT_FLUSH_MS    = 10;
+
+        std::mutex _output_mutex;
+        uint8_t    _output[OUTPUT_BUFFER_SIZE];
+        size_t     _output_length = 0;
+        size_t     _output_lines  = 0;  // Length of the complete lines in _output
+        int32_t    _output_time   = 0;  // When the first of those lines was completed
+
+        uint32_t _messages_sent = 0;
+        uint32_t _bytes_sent    = 0;
+
+        void sendLines();
+        bool sendMessage(const uint8_t* data, size_t length);
 
         // Instead of queueing realtime characters, we put them here
         // so they can be processed immediately during operations like
         // homing where GCode handling is blocked.
         int _rtchar = -1;
+
+        // Binary status frames
+        static const uint32_t MIN_FRAME_INTERVAL = 20;  // 50 Hz
+
+        uint32_t _frameInterval   = 0;
+        int32_t  _nextFrameTime   = 0;
+        uint8_t  _lastFrame[StatusFrame::max_size];
+        size_t   _lastFrameLength = 0;
+
+        void sendFrame();
     };
 
+    // The channels are kept in tables indexed by WebSocket client number, so an event finds its
+    // channel directly and connecting or disconnecting allocates nothing besides the channel
     class WSChannels {
+    public:
+        static const int MAX_CLIENTS = 16;  // At least WEBSOCKETS_SERVER_CLIENT_MAX
+
     private:
-        static std::map<uint8_t, WSChannel*> _wsChannels;
-        static std::list<WSChannel*>         _webWsChannels;
+        static WSChannel* _wsChannels[MAX_CLIENTS];
+        static bool       _webWsChannels[MAX_CLIENTS];  // Clients of the WebUI page, which get pings
 
-        static WSChannel* _lastWSChannel;
+        static int        _lastWSChannel;  // Client number of the most recently used channel, or -1
         static WSChannel* getWSChannel(int pageid);
+        static WSChannel* channel(int num) { return (num >= 0 && num < MAX_CLIENTS) ? _wsChannels[num] : nullptr; }
 
     public:
-        static void removeChannel(WSChannel* channel);
+        static void removeChannel(WSChannel* wsChannel);
         static void removeChannel(uint8_t num);
 
         static bool runGCode(int pageid, std::string_view cmd);
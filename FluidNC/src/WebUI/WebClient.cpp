@@ -64,6 +64,7 @@ namespace WebUI {
 
     void WebClient::sendLine(MsgLevel level, const char* line) {
         print_msg(level, line);
+        release_log_line(line);
     }
     void WebClient::sendLine(MsgLevel level, const std::string* line) {
         print_msg(level, line->c_str());
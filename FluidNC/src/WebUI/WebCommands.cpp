@@ -13,6 +13,7 @@
 #include "src/Configuration/JsonGenerator.h"
 #include "src/Uart.h"    // Uart0.baud
 #include "src/Report.h"  // git_info
+#include "src/Serial.h"  // allChannels
 
 #include <Esp.h>
 
@@ -93,9 +94,13 @@ namespace WebUI {
             j.id_value_object("Flash Size", formatBytes(ESP.getFlashChipSize()));
 
             for (auto const& module : ModuleFactory::objects()) {
-                module->wifi_stats(j);
+                if (module->ready()) {
+                    module->wifi_stats(j);
+                }
             }
 
+            allChannels.statsJSON(j);
+
             std::string s("FluidNC ");
             s += git_info;
             j.id_value_object("FW version", s);
@@ -129,12 +134,15 @@ namespace WebUI {
             log_stream(out, "Free memory: " << formatBytes(ESP.getFreeHeap()));
             log_stream(out, "SDK: " << ESP.getSdkVersion());
             log_stream(out, "Flash Size: " << formatBytes(ESP.getFlashChipSize()));
+            allChannels.listStats(out);
 
             // Round baudRate to nearest 100 because ESP32 can say e.g. 115201
             //        log_stream(out, "Baud rate: " << ((Uart0.baud / 100) * 100));
 
             for (auto const& module : Modules()) {
-                module->build_info(out);
+                if (module->ready()) {
+                    module->build_info(out);
+                }
             }
 
             log_stream(out, "FW version: FluidNC " << git_info);
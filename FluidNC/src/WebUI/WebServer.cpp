@@ -4,10 +4,12 @@
 #include "src/Machine/MachineConfig.h"
 #include "src/Serial.h"    // is_realtime_command()
 #include "src/Settings.h"  // settings_execute_line()
+#include "src/Machine/Tasks.h"
 
 #include "WebServer.h"
 
 #include "Mdns.h"
+#include "Ethernet.h"  // network_off(), network_ip()
 
 #include <WebSocketsServer.h>
 #include <WiFi.h>
@@ -21,13 +23,17 @@
 #include "WSChannel.h"
 
 #include "WebClient.h"
+#include "FirmwareWriter.h"
 
 #include "src/Protocol.h"  // protocol_send_event
 #include "src/FluidPath.h"
 #include "src/JSONEncoder.h"
 
 #include "src/HashFS.h"
+#include "src/DirIndex.h"  // DirIndex::
+#include "src/string_util.h"
 #include <list>
+#include <iomanip>
 
 namespace WebUI {
     const byte DNS_PORT = 53;
@@ -59,20 +65,30 @@ namespace WebUI {
     WebSocketsServer* Web_Server::_socket_server   = NULL;
     WebSocketsServer* Web_Server::_socket_serverv3 = NULL;
 #ifdef ENABLE_AUTHENTICATION
-    AuthenticationIP* Web_Server::_head  = NULL;
-    uint8_t           Web_Server::_nb_ip = 0;
-    const int         MAX_AUTH_IP        = 10;
+    AuthenticationIP Web_Server::_sessions[MAX_AUTH_IP];
 #endif
-    FileStream* Web_Server::_uploadFile = nullptr;
+    FileStream* Web_Server::_uploadFile  = nullptr;
+    uint32_t    Web_Server::_uploadStart = 0;
+
+    TaskHandle_t        Web_Server::_commandTask = nullptr;
+    char                Web_Server::_commandLine[256];
+    AuthenticationLevel Web_Server::_commandAuth  = AuthenticationLevel::LEVEL_GUEST;
+    Error               Web_Server::_commandError = Error::Ok;
+    volatile bool       Web_Server::_commandDone  = true;
+
+    // Uploads are collected into blocks of this size that a background task writes to
+    // the file while the next block is being received
+    static const size_t uploadBlockSize = 32 * 1024;
 
     EnumSetting *http_enable, *http_block_during_motion;
     IntSetting*  http_port;
+    IntSetting*  websocket_rx_window;
 
     Web_Server::~Web_Server() {
         deinit();
     }
 
-    void Web_Server::init() {
+    void Web_Server::init_settings() {
         http_port   = new IntSetting("HTTP Port", WEBSET, WA, "ESP121", "HTTP/Port", DEFAULT_HTTP_PORT, MIN_HTTP_PORT, MAX_HTTP_PORT);
         http_enable = new EnumSetting("HTTP Enable", WEBSET, WA, "ESP120", "HTTP/Enable", DEFAULT_HTTP_STATE, &onoffOptions);
         http_block_during_motion = new EnumSetting("Block serving HTTP content during motion",
@@ -82,10 +98,20 @@ namespace WebUI {
                                                    "HTTP/BlockDuringMotion",
                                                    DEFAULT_HTTP_BLOCKED_DURING_MOTION,
                                                    &onoffOptions);
+        websocket_rx_window      = new IntSetting("WebSocket Receive Window",
+                                                  WEBSET,
+                                                  WA,
+                                                  NULL,
+                                                  "WebSocket/RxWindow",
+                                                  DEFAULT_WEBSOCKET_RX_WINDOW,
+                                                  MIN_WEBSOCKET_RX_WINDOW,
+                                                  MAX_WEBSOCKET_RX_WINDOW);
+    }
 
+    void Web_Server::init() {
         _setupdone = false;
 
-        if (WiFi.getMode() == WIFI_OFF || !http_enable->get()) {
+        if (network_off() || !http_enable->get()) {
             return;
         }
 
@@ -216,15 +242,51 @@ namespace WebUI {
         }
 
 #ifdef ENABLE_AUTHENTICATION
-        while (_head) {
-            AuthenticationIP* current = _head;
-            _head                     = _head->_next;
-            delete current;
+        for (auto& session : _sessions) {
+            session.in_use = false;
         }
-        _nb_ip = 0;
 #endif
     }
 
+    // True if the browser's If-None-Match header names etag.  The header can be a
+    // comma-separated list, and weak validators (W/"...") match for GET requests.
+    bool Web_Server::etagMatches(const std::string& etag) {
+        if (!etag.length()) {
+            return false;
+        }
+        std::string      header(_webserver->header("If-None-Match").c_str());
+        std::string_view rest(header);
+        std::string_view tag;
+        while (string_util::split_prefix(rest, tag, ',')) {
+            tag = string_util::trim(tag);
+            if (string_util::starts_with_ignore_case(tag, "W/")) {
+                tag.remove_prefix(2);
+            }
+            if (tag == "*" || tag == etag) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Files are identified by the hash of their content.  The URL of a file like
+    // index.html does not change when WebUI is updated, so browsers must revalidate
+    // it, which costs only a 304 response when it is unchanged.  A URL that is
+    // versioned with ?v=... names one particular content, so it can be cached for good.
+    void Web_Server::sendCacheHeaders(const std::string& etag) {
+        _webserver->sendHeader("ETag", etag.c_str());
+        if (_webserver->hasArg("v")) {
+            _webserver->sendHeader("Cache-Control", "public, max-age=31536000, immutable");
+        } else {
+            _webserver->sendHeader("Cache-Control", "no-cache");
+        }
+    }
+
+    void Web_Server::sendNotModified(const std::string& etag) {
+        sendCacheHeaders(etag);
+        _webserver->send(304);
+    }
+
     // Send a file, either the specified path or path.gz
     bool Web_Server::myStreamFile(const char* path, bool download) {
         std::error_code ec;
@@ -251,8 +313,8 @@ namespace WebUI {
                 hash = HashFS::hash(gzpath, true);
             }
 
-            if (hash.length() && std::string(_webserver->header("If-None-Match").c_str()) == hash) {
-                _webserver->send(304);
+            if (etagMatches(hash)) {
+                sendNotModified(hash);
                 return true;
             }
 
@@ -260,7 +322,7 @@ namespace WebUI {
             return true;
         }
 
-        // Check for brower cache match
+        // Check for browser cache match before opening the file
         hash = HashFS::hash(fpath);
         if (!hash.length()) {
             std::filesystem::path gzpath(fpath);
@@ -268,8 +330,8 @@ namespace WebUI {
             hash = HashFS::hash(gzpath);
         }
 
-        if (hash.length() && std::string(_webserver->header("If-None-Match").c_str()) == hash) {
-            _webserver->send(304);
+        if (etagMatches(hash)) {
+            sendNotModified(hash);
             return true;
         }
 
@@ -292,7 +354,7 @@ namespace WebUI {
             _webserver->sendHeader("Content-Disposition", "attachment");
         }
         if (hash.length()) {
-            _webserver->sendHeader("ETag", hash.c_str());
+            sendCacheHeaders(hash);
         }
         _webserver->setContentLength(file->size());
         if (isGzip) {
@@ -310,7 +372,7 @@ namespace WebUI {
         return true;
     }
     void Web_Server::sendWithOurAddress(const char* content, int code) {
-        auto        ip    = WiFi.getMode() == WIFI_STA ? WiFi.localIP() : WiFi.softAPIP();
+        auto        ip    = network_ip();
         std::string ipstr = IP_string(ip);
         if (_port != 80) {
             ipstr += ":";
@@ -355,7 +417,23 @@ namespace WebUI {
             }
         }
 
-        // If we did not send index.html, send the default content that provides simple localfs file management
+        // If we did not send index.html, send the default content that provides simple localfs file management.
+        // The page is gzipped, so the CRC and length in its gzip trailer identify its content.
+        static std::string nofilesTag;
+        if (!nofilesTag.length()) {
+            const uint8_t* trailer = reinterpret_cast<const uint8_t*>(PAGE_NOFILES) + PAGE_NOFILES_SIZE - 8;
+            nofilesTag             = "\"";
+            for (int i = 7; i >= 0; i--) {
+                nofilesTag += "0123456789ABCDEF"[trailer[i] >> 4];
+                nofilesTag += "0123456789ABCDEF"[trailer[i] & 0xf];
+            }
+            nofilesTag += '"';
+        }
+        if (etagMatches(nofilesTag)) {
+            sendNotModified(nofilesTag);
+            return;
+        }
+        sendCacheHeaders(nofilesTag);
         _webserver->sendHeader("Content-Encoding", "gzip");
         _webserver->send_P(200, "text/html", PAGE_NOFILES, PAGE_NOFILES_SIZE);
     }
@@ -450,10 +528,10 @@ namespace WebUI {
             _webserver->send(503, "text/plain", "Try again when not moving\n");
             return;
         }
-        char line[256];
-        strncpy(line, cmd, 255);
+        strncpy(_commandLine, cmd, sizeof(_commandLine) - 1);
+        _commandLine[sizeof(_commandLine) - 1] = '\0';
         webClient.attachWS(_webserver, silent);
-        Error err = settings_execute_line(line, webClient, auth_level);
+        Error err = runCommand(auth_level);
         if (err != Error::Ok) {
             std::string answer = "Error: ";
             const char* msg    = errorString(err);
@@ -470,6 +548,42 @@ namespace WebUI {
         }
         webClient.detachWS();
     }
+    void Web_Server::command_loop(void* unused) {
+        while (true) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            _commandError = settings_execute_line(_commandLine, webClient, _commandAuth);
+            _commandDone  = true;
+        }
+    }
+
+    // Commands like $SD/List or $Settings/List can take seconds, and the HTTP
+    // handler runs in the polling task, so running them there would stop the
+    // websockets and channel polling too.  The command instead runs in its own
+    // task, and its output streams into the chunked HTTP response as it arrives.
+    // Meanwhile the handler keeps servicing the websockets and the realtime
+    // input and auto reports of all of the channels.  The web server handles
+    // one request at a time, so there is never more than one such command.
+    Error Web_Server::runCommand(AuthenticationLevel auth_level) {
+        if (!_commandTask && !Machine::Tasks::get()._webCommands.create(command_loop, nullptr, &_commandTask)) {
+            _commandTask = nullptr;
+            return settings_execute_line(_commandLine, webClient, auth_level);
+        }
+        _commandAuth = auth_level;
+        _commandDone = false;
+        xTaskNotifyGive(_commandTask);
+        while (!_commandDone) {
+            vTaskDelay(1);
+            if (_socket_server) {
+                _socket_server->loop();
+            }
+            if (_socket_serverv3) {
+                _socket_serverv3->loop();
+            }
+            pollChannels();
+        }
+        return _commandError;
+    }
+
     void Web_Server::websocketCommand(const char* cmd, int pageid, AuthenticationLevel auth_level) {
         if (auth_level == AuthenticationLevel::LEVEL_GUEST) {
             _webserver->send(401, "text/plain", "Authentication failed\n");
@@ -608,15 +722,10 @@ namespace WebUI {
                 }
                 //create Session
                 if ((current_auth_level != auth_level) || (auth_level == AuthenticationLevel::LEVEL_GUEST)) {
-                    AuthenticationIP* current_auth = new AuthenticationIP;
-                    current_auth->level            = current_auth_level;
-                    current_auth->ip               = _webserver->client().remoteIP();
-                    strcpy(current_auth->sessionID, create_session_ID());
-                    strcpy(current_auth->userID, sUser.c_str());
-                    current_auth->last_time = millis();
-                    if (AddAuthIP(current_auth)) {
+                    AuthenticationIP* current_auth = AddAuthIP(_webserver->client().remoteIP(), current_auth_level, sUser.c_str());
+                    if (current_auth) {
                         std::string tmps = "ESPSESSIONID=";
-                        tmps += current_auth->sessionID.c_str();
+                        tmps += current_auth->sessionID;
                         _webserver->sendHeader("Set-Cookie", tmps);
                         _webserver->sendHeader("Cache-Control", "no-cache");
                         switch (current_auth->level) {
@@ -631,7 +740,6 @@ namespace WebUI {
                                 break;
                         }
                     } else {
-                        delete current_auth;
                         msg_alert_error = true;
                         code            = 500;
                         smsg            = "Error: Too many connections";
@@ -797,6 +905,22 @@ namespace WebUI {
         _webserver->send(200, "application/json", s);
     }
 
+    // Large JSON responses like file listings are sent with chunked transfer
+    // encoding as they are encoded, instead of being collected in memory first
+    void Web_Server::beginJSONChunks(int code) {
+        _webserver->setContentLength(CONTENT_LENGTH_UNKNOWN);
+        _webserver->sendHeader("Cache-Control", "no-cache");
+        _webserver->send(code, "application/json", "");
+    }
+
+    void Web_Server::sendJSONChunk(const std::string& s) {
+        _webserver->sendContent(s.c_str(), s.length());
+    }
+
+    void Web_Server::endJSONChunks() {
+        _webserver->sendContent("");
+    }
+
     void Web_Server::sendAuth(const char* status, const char* level, const char* user) {
         std::string s;
         JSONencoder j(&s);
@@ -896,6 +1020,10 @@ namespace WebUI {
                             _upload_status = UploadStatus::FAILED;
                             log_info("Update cancelled");
                             pushError(ESP_ERROR_NOT_ENOUGH_SPACE, "Upload rejected, not enough space");
+                        } else if (!FirmwareWriter::begin()) {
+                            _upload_status = UploadStatus::FAILED;
+                            log_info("Update cancelled");
+                            pushError(ESP_ERROR_UPLOAD, "Upload rejected, no memory");
                         } else {
                             log_info("Update 0%");
                         }
@@ -903,7 +1031,6 @@ namespace WebUI {
                     //Upload write
                     //**************
                 } else if (upload.status == UPLOAD_FILE_WRITE) {
-                    delay_ms(1);
                     //check if no error
                     if (_upload_status == UploadStatus::ONGOING) {
                         if (((100 * upload.totalSize) / maxSketchSpace) != last_upload_update) {
@@ -915,7 +1042,8 @@ namespace WebUI {
 
                             log_info("Update " << last_upload_update << "%");
                         }
-                        if (Update.write(upload.buf, upload.currentSize) != upload.currentSize) {
+                        // A firmware writer task writes the flash while the next packets arrive
+                        if (!FirmwareWriter::write(upload.buf, upload.currentSize)) {
                             _upload_status = UploadStatus::FAILED;
                             log_info("Update write failed");
                             pushError(ESP_ERROR_FILE_WRITE, "File write failed");
@@ -924,7 +1052,7 @@ namespace WebUI {
                     //Upload end
                     //**************
                 } else if (upload.status == UPLOAD_FILE_END) {
-                    if (Update.end(true)) {  //true to set the size to the current progress
+                    if (FirmwareWriter::finish() && Update.end(true)) {  //true to set the size to the current progress
                         //Now Reboot
                         log_info("Update 100%");
                         _upload_status = UploadStatus::SUCCESSFUL;
@@ -935,6 +1063,7 @@ namespace WebUI {
                     }
                 } else if (upload.status == UPLOAD_FILE_ABORTED) {
                     log_info("Update failed");
+                    FirmwareWriter::abort();
                     _upload_status = UploadStatus::FAILED;
                     return;
                 }
@@ -942,6 +1071,7 @@ namespace WebUI {
         }
 
         if (_upload_status == UploadStatus::FAILED) {
+            FirmwareWriter::abort();
             cancelUpload();
             Update.end();
         }
@@ -993,6 +1123,7 @@ namespace WebUI {
             if (action == "delete") {
                 if (stdfs::remove(fpath / filename, ec)) {
                     sstatus = filename + " deleted";
+                    DirIndex::invalidate(fpath);
                     HashFS::delete_file(fpath / filename);
                 } else {
                     sstatus = "Cannot delete ";
@@ -1004,6 +1135,7 @@ namespace WebUI {
                 int count = stdfs::remove_all(dirpath, ec);
                 if (count > 0) {
                     sstatus = filename + " deleted";
+                    DirIndex::invalidate(fpath);
                     HashFS::report_change();
                 } else {
                     log_debug("remove_all returned " << count);
@@ -1013,6 +1145,7 @@ namespace WebUI {
             } else if (action == "createdir") {
                 if (stdfs::create_directory(fpath / filename, ec)) {
                     sstatus = filename + " created";
+                    DirIndex::invalidate(fpath);
                     HashFS::report_change();
                 } else {
                     sstatus = "Cannot create ";
@@ -1029,6 +1162,7 @@ namespace WebUI {
                         sstatus += filename + " " + ec.message();
                     } else {
                         sstatus = filename + " renamed to " + newname;
+                        DirIndex::invalidate(fpath);
                         HashFS::rename_file(fpath / filename, fpath / newname);
                     }
                 }
@@ -1040,23 +1174,46 @@ namespace WebUI {
             list_files = false;
         }
 
-        std::string s;
-        JSONencoder j(&s);
+        // A directory with many files is listed a page at a time with offset=N&limit=M;
+        // when more entries follow the page, "next" is the offset of the next page
+        size_t offset = 0;
+        size_t limit  = 0;  // No limit
+        if (_webserver->hasArg("offset")) {
+            offset = atoi(_webserver->arg("offset").c_str());
+        }
+        if (_webserver->hasArg("limit")) {
+            limit = atoi(_webserver->arg("limit").c_str());
+        }
+
+        beginJSONChunks(200);
+        JSONencoder j(sendJSONChunk);
         j.begin();
 
         if (list_files) {
-            auto iter = stdfs::directory_iterator { fpath, ec };
-            if (!ec) {
+            auto listing = DirIndex::list(fpath, ec);
+            if (listing) {
+                size_t index = 0;
+                bool   more  = false;
                 j.begin_array("files");
-                for (auto const& dir_entry : iter) {
+                for (auto const& entry : listing->entries) {
+                    if (index++ < offset) {
+                        continue;
+                    }
+                    if (limit && index > offset + limit) {
+                        more = true;
+                        break;
+                    }
                     j.begin_object();
-                    j.member("name", dir_entry.path().filename());
-                    j.member("shortname", dir_entry.path().filename());
-                    j.member("size", dir_entry.is_directory() ? -1 : dir_entry.file_size());
+                    j.member("name", listing->name(entry));
+                    j.member("shortname", listing->name(entry));
+                    j.member("size", entry.is_dir ? -1 : int(entry.size));
                     j.member("datetime", "");
                     j.end_object();
                 }
                 j.end_array();
+                if (more) {
+                    j.member("next", offset + limit);
+                }
             }
         }
 
@@ -1073,7 +1230,7 @@ namespace WebUI {
         j.member("occupation", percent);
         j.member("status", sstatus);
         j.end();
-        sendJSON(200, s);
+        endJSONChunks();
     }
 
     void Web_Server::handle_direct_SDFileList() {
@@ -1113,6 +1270,8 @@ namespace WebUI {
             try {
                 _uploadFile    = new FileStream(fpath, "w");
                 _upload_status = UploadStatus::ONGOING;
+                _uploadStart   = millis();
+                _uploadFile->enable_write_behind(uploadBlockSize, true);
             } catch (const Error err) {
                 _uploadFile    = nullptr;
                 _upload_status = UploadStatus::FAILED;
@@ -1123,7 +1282,9 @@ namespace WebUI {
     }
 
     void Web_Server::uploadWrite(uint8_t* buffer, size_t length) {
-        delay_ms(1);
+        if (!(_uploadFile && _uploadFile->writes_behind())) {
+            delay_ms(1);
+        }
         if (_uploadFile && _upload_status == UploadStatus::ONGOING) {
             //no error write post data
             if (length != _uploadFile->write(buffer, length)) {
@@ -1145,10 +1306,24 @@ namespace WebUI {
             // _uploadFile = nullptr;
 
             std::string pathname = _uploadFile->fpath();
+            bool        written  = _uploadFile->finish_writes();
+            size_t      bytes    = _uploadFile->position();
+            if (!written) {
+                _upload_status = UploadStatus::FAILED;
+                log_info("Upload failed - file write failed");
+                pushError(ESP_ERROR_FILE_WRITE, "File write failed");
+            }
             delete _uploadFile;
             _uploadFile = nullptr;
             log_debug("pathname " << pathname);
 
+            uint32_t ms = millis() - _uploadStart;
+            if (ms == 0) {
+                ms = 1;
+            }
+            log_info("Uploaded " << bytes << " bytes in " << ms << " ms, " << std::fixed << std::setprecision(2) << (bytes / 1000.0 / ms)
+                                 << " MB/s");
+
             FluidPath filepath { pathname, "" };
 
             HashFS::rehash_file(filepath);
@@ -1197,6 +1372,7 @@ namespace WebUI {
                 delete _uploadFile;
                 _uploadFile = nullptr;
                 stdfs::remove(filepath, error_code);
+                DirIndex::invalidate(filepath);
                 HashFS::rehash_file(filepath);
             }
         }
@@ -1287,115 +1463,74 @@ namespace WebUI {
 
 #ifdef ENABLE_AUTHENTICATION
 
-    //add the information in the linked list if possible
-    bool Web_Server::AddAuthIP(AuthenticationIP* item) {
-        if (_nb_ip > MAX_AUTH_IP) {
-            return false;
+    // Takes a free or expired entry of the session table for a new session, whose ID
+    // starts with the index of the entry and continues with the IP address and the time
+    AuthenticationIP* Web_Server::AddAuthIP(IPAddress ip, AuthenticationLevel level, const char* userID) {
+        uint32_t now = millis();
+        for (int i = 0; i < MAX_AUTH_IP; i++) {
+            AuthenticationIP& session = _sessions[i];
+            if (session.in_use && (now - session.last_time) <= AUTH_TIMEOUT_MS) {
+                continue;
+            }
+            session.in_use    = true;
+            session.ip        = ip;
+            session.level     = level;
+            session.last_time = now;
+            strncpy(session.userID, userID, sizeof(session.userID) - 1);
+            session.userID[sizeof(session.userID) - 1] = '\0';
+            snprintf(session.sessionID,
+                     sizeof(session.sessionID),
+                     "%02X%02X%02X%02X%02X%06X",
+                     i,
+                     ip[0],
+                     ip[1],
+                     ip[2],
+                     ip[3],
+                     unsigned(now & 0xffffff));
+            return &session;
         }
-        item->_next = _head;
-        _head       = item;
-        _nb_ip++;
-        return true;
+        return NULL;
     }
 
-    //Session ID based on IP and time using 16 char
-    const char* Web_Server::create_session_ID() {
-        static char sessionID[17];
-        //reset SESSIONID
-        for (int i = 0; i < 17; i++) {
-            sessionID[i] = '\0';
+    // The live session with this ID, found from the table index at the start of the ID.
+    // An expired session is released here.
+    AuthenticationIP* Web_Server::FindAuth(const char* sessionID) {
+        unsigned index;
+        if (sscanf(sessionID, "%2X", &index) != 1 || index >= MAX_AUTH_IP) {
+            return NULL;
         }
-        //get time
-        uint32_t now = millis();
-        //get remote IP
-        IPAddress remoteIP = _webserver->client().remoteIP();
-        //generate SESSIONID
-        if (0 > sprintf(sessionID,
-                        "%02X%02X%02X%02X%02X%02X%02X%02X",
-                        remoteIP[0],
-                        remoteIP[1],
-                        remoteIP[2],
-                        remoteIP[3],
-                        (uint8_t)((now >> 0) & 0xff),
-                        (uint8_t)((now >> 8) & 0xff),
-                        (uint8_t)((now >> 16) & 0xff),
-                        (uint8_t)((now >> 24) & 0xff))) {
-            strcpy(sessionID, "NONE");
-        }
-        return sessionID;
+        AuthenticationIP& session = _sessions[index];
+        if (!session.in_use || strcmp(sessionID, session.sessionID) != 0) {
+            return NULL;
+        }
+        if ((millis() - session.last_time) > AUTH_TIMEOUT_MS) {
+            session.in_use = false;
+            return NULL;
+        }
+        return &session;
     }
 
     bool Web_Server::ClearAuthIP(IPAddress ip, const char* sessionID) {
-        AuthenticationIP* current  = _head;
-        AuthenticationIP* previous = NULL;
-        bool              done     = false;
-        while (current) {
-            if ((ip == current->ip) && (strcmp(sessionID, current->sessionID) == 0)) {
-                //remove
-                done = true;
-                if (current == _head) {
-                    _head = current->_next;
-                    _nb_ip--;
-                    delete current;
-                    current = _head;
-                } else {
-                    previous->_next = current->_next;
-                    _nb_ip--;
-                    delete current;
-                    current = previous->_next;
-                }
-            } else {
-                previous = current;
-                current  = current->_next;
-            }
+        AuthenticationIP* session = FindAuth(sessionID);
+        if (session && session->ip == ip) {
+            session->in_use = false;
+            return true;
         }
-        return done;
+        return false;
     }
 
     //Get info
     AuthenticationIP* Web_Server::GetAuth(IPAddress ip, const char* sessionID) {
-        AuthenticationIP* current = _head;
-        //AuthenticationIP * previous = NULL;
-        while (current) {
-            if (ip == current->ip) {
-                if (strcmp(sessionID, current->sessionID) == 0) {
-                    //found
-                    return current;
-                }
-            }
-            //previous = current;
-            current = current->_next;
-        }
-        return NULL;
+        AuthenticationIP* session = FindAuth(sessionID);
+        return (session && session->ip == ip) ? session : NULL;
     }
 
-    //Review all IP to reset timers
+    // The level of the session, whose timeout restarts
     AuthenticationLevel Web_Server::ResetAuthIP(IPAddress ip, const char* sessionID) {
-        AuthenticationIP* current  = _head;
-        AuthenticationIP* previous = NULL;
-        while (current) {
-            if ((millis() - current->last_time) > 360000) {
-                //remove
-                if (current == _head) {
-                    _head = current->_next;
-                    _nb_ip--;
-                    delete current;
-                    current = _head;
-                } else {
-                    previous->_next = current->_next;
-                    _nb_ip--;
-                    delete current;
-                    current = previous->_next;
-                }
-            } else {
-                if (ip == current->ip && strcmp(sessionID, current->sessionID) == 0) {
-                    //reset time
-                    current->last_time = millis();
-                    return (AuthenticationLevel)current->level;
-                }
-                previous = current;
-                current  = current->_next;
-            }
+        AuthenticationIP* session = GetAuth(ip, sessionID);
+        if (session) {
+            session->last_time = millis();
+            return session->level;
         }
         return AuthenticationLevel::LEVEL_GUEST;
     }
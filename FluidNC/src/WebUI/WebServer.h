@@ -21,17 +21,24 @@ namespace WebUI {
     static const int MIN_HTTP_PORT = 1;
     static const int MAX_HTTP_PORT = 65001;
 
+    static const int DEFAULT_WEBSOCKET_RX_WINDOW = 4096;
+    static const int MIN_WEBSOCKET_RX_WINDOW     = 256;
+    static const int MAX_WEBSOCKET_RX_WINDOW     = 16384;
+
     extern EnumSetting* http_enable;
     extern IntSetting*  http_port;
+    extern IntSetting*  websocket_rx_window;
 
 #ifdef ENABLE_AUTHENTICATION
+    // A login session.  The sessions are kept in a fixed table, and the first two characters
+    // of a session ID are the index of its entry, so a request finds its session directly.
     struct AuthenticationIP {
+        bool                in_use = false;
         IPAddress           ip;
         AuthenticationLevel level;
         char                userID[17];
         char                sessionID[17];
         uint32_t            last_time;
-        AuthenticationIP*   _next;
     };
 #endif
 
@@ -42,8 +49,10 @@ namespace WebUI {
     public:
         Web_Server(const char* name) : Module(name) {}
 
+        void init_settings() override;
         void init() override;
         void deinit() override;
+        bool deferred_init() override { return true; }
         void poll() override;
 
         static long     get_client_ID();
@@ -59,15 +68,17 @@ namespace WebUI {
         static uint16_t          _port;
         static UploadStatus      _upload_status;
         static FileStream*       _uploadFile;
+        static uint32_t          _uploadStart;
 
         static const char* getContentType(const char* filename);
 
         static AuthenticationLevel is_authenticated();
 #ifdef ENABLE_AUTHENTICATION
-        static AuthenticationIP*   _head;
-        static uint8_t             _nb_ip;
-        static bool                AddAuthIP(AuthenticationIP* item);
-        static const char*         create_session_ID();
+        static const int           MAX_AUTH_IP     = 10;
+        static const uint32_t      AUTH_TIMEOUT_MS = 360000;
+        static AuthenticationIP    _sessions[MAX_AUTH_IP];
+        static AuthenticationIP*   AddAuthIP(IPAddress ip, AuthenticationLevel level, const char* userID);
+        static AuthenticationIP*   FindAuth(const char* sessionID);
         static bool                ClearAuthIP(IPAddress ip, const char* sessionID);
         static AuthenticationIP*   GetAuth(IPAddress ip, const char* sessionID);
         static AuthenticationLevel ResetAuthIP(IPAddress ip, const char* sessionID);
@@ -96,6 +107,9 @@ namespace WebUI {
         static void WebUpdateUpload();
 
         static bool myStreamFile(const char* path, bool download = false);
+        static bool etagMatches(const std::string& etag);
+        static void sendCacheHeaders(const std::string& etag);
+        static void sendNotModified(const std::string& etag);
 
         static void pushError(int code, const char* st, bool web_error = 500, uint16_t timeout = 1000);
 
@@ -113,11 +127,24 @@ namespace WebUI {
         static void synchronousCommand(const char* cmd, bool silent, AuthenticationLevel auth_level);
         static void websocketCommand(const char* cmd, int pageid, AuthenticationLevel auth_level);
 
+        // Commands whose output is the HTTP response run in their own task, see runCommand()
+        static TaskHandle_t        _commandTask;
+        static char                _commandLine[256];
+        static AuthenticationLevel _commandAuth;
+        static Error               _commandError;
+        static volatile bool       _commandDone;
+
+        static void  command_loop(void* unused);
+        static Error runCommand(AuthenticationLevel auth_level);
+
         static void sendFSError(Error err);
         static void sendJSON(int code, const char* s);
         static void sendJSON(int code, const std::string& s) {
             sendJSON(code, s.c_str());
         }
+        static void beginJSONChunks(int code);
+        static void sendJSONChunk(const std::string& s);
+        static void endJSONChunks();
         static void sendAuth(const char* status, const char* level, const char* user);
         static void sendAuthFailed();
         static void sendStatus(int code, const char* str);
@@ -12,10 +12,14 @@
 #include "Authentication.h"  // AuthenticationLevel
 
 #include "src/Main.h"
+#include "src/State.h"  // state_is()
+#include "src/Job.h"    // Job::active()
+#include "src/string_util.h"
 
 #include "WebServer.h"             // Web_Server::port()
 #include "TelnetServer.h"          // TelnetServer::port()
 #include "NotificationsService.h"  // notificationsservice
+#include "Ethernet.h"              // network_off(), network_ip()
 
 #include <WiFi.h>
 #include <esp_wifi.h>
@@ -24,6 +28,7 @@
 #include <cstring>
 
 #include <esp_ota_ops.h>
+#include <ping/ping_sock.h>
 
 namespace WebUI {
     enum WiFiStartupMode {
@@ -178,13 +183,14 @@ namespace WebUI {
     static EnumSetting*     _sta_min_security;
     static PasswordSetting* _sta_password;
     static EnumSetting*     _wifi_ps_mode;
+    static EnumSetting*     _low_latency;
 
     class WiFiConfig : public Module {
     private:
         static void print_mac(Channel& out, const char* prefix, const char* mac) { log_stream(out, prefix << " (" << mac << ")"); }
 
         static Error showIP(const char* parameter, AuthenticationLevel auth_level, Channel& out) {  // ESP111
-            log_stream(out, parameter << IP_string(WiFi.getMode() == WIFI_STA ? WiFi.localIP() : WiFi.softAPIP()));
+            log_stream(out, parameter << IP_string(network_ip()));
             return Error::Ok;
         }
 
@@ -200,7 +206,8 @@ namespace WebUI {
                 return Error::InvalidValue;
             }
 
-            Error err = _sta_ip->setStringValue(ip);
+            Setting::Transaction transaction;
+            Error                err = _sta_ip->setStringValue(ip);
             if (err == Error::Ok) {
                 err = _sta_netmask->setStringValue(netmask);
             }
@@ -213,7 +220,7 @@ namespace WebUI {
         void wifi_stats(JSONencoder& j) {
             j.id_value_object("Sleep mode", WiFi.getSleep() ? "Modem" : "None");
             int mode = WiFi.getMode();
-            if (mode != WIFI_OFF) {
+            if (!network_off()) {
                 //Is OTA available ?
                 size_t flashsize = 0;
                 if (esp_ota_get_running_partition()) {
@@ -476,6 +483,122 @@ namespace WebUI {
             }
         }
 
+        // Low latency mode.  With modem sleep, the AP holds packets for the
+        // station until its next beacon, which adds 100 ms or more to a Telnet
+        // or WebSocket round trip.  While a job, jog or stream is running the
+        // power saving mode is set to None, and WiFi/PsMode is restored when
+        // the machine is idle again.
+        static bool _ps_suspended;
+
+        static bool streaming() { return state_is(State::Cycle) || state_is(State::Hold) || state_is(State::Jog) || Job::active(); }
+
+        static void update_power_save() {
+            if (!_low_latency->get() || _wifi_ps_mode->get() == WIFI_PS_NONE || WiFi.getMode() != WIFI_STA) {
+                return;
+            }
+            bool busy = streaming();
+            if (busy != _ps_suspended) {
+                esp_wifi_set_ps(busy ? WIFI_PS_NONE : static_cast<wifi_ps_type_t>(_wifi_ps_mode->get()));
+                _ps_suspended = busy;
+                log_debug("WiFi power saving " << (busy ? "suspended" : "restored"));
+            }
+        }
+
+        // In low latency mode the gateway is pinged once a second, and the round
+        // trip times are collected separately for when power saving is on and
+        // off, so $WiFi/RTT shows what modem sleep costs on this network.
+        struct RttStats {
+            uint32_t count    = 0;
+            uint32_t lost     = 0;
+            uint32_t min_ms   = 0;
+            uint32_t max_ms   = 0;
+            uint32_t total_ms = 0;
+
+            void add(uint32_t ms) {
+                if (!count || ms < min_ms) {
+                    min_ms = ms;
+                }
+                if (ms > max_ms) {
+                    max_ms = ms;
+                }
+                total_ms += ms;
+                ++count;
+            }
+        };
+        static RttStats          _rtt[2];  // Indexed by whether power saving is on
+        static esp_ping_handle_t _ping;
+
+        static RttStats& rtt_bucket() {
+            wifi_ps_type_t ps;
+            esp_wifi_get_ps(&ps);
+            return _rtt[ps != WIFI_PS_NONE];
+        }
+
+        static void ping_success(esp_ping_handle_t handle, void* args) {
+            uint32_t elapsed;
+            esp_ping_get_profile(handle, ESP_PING_PROF_TIMEGAP, &elapsed, sizeof(elapsed));
+            rtt_bucket().add(elapsed);
+        }
+
+        static void ping_timeout(esp_ping_handle_t handle, void* args) { ++rtt_bucket().lost; }
+
+        static void stop_ping() {
+            if (_ping) {
+                esp_ping_stop(_ping);
+                esp_ping_delete_session(_ping);
+                _ping = nullptr;
+            }
+        }
+
+        static void start_ping() {
+            stop_ping();
+            if (!_low_latency->get()) {
+                return;
+            }
+            esp_ping_config_t config           = ESP_PING_DEFAULT_CONFIG();
+            config.target_addr.type            = IPADDR_TYPE_V4;
+            config.target_addr.u_addr.ip4.addr = uint32_t(WiFi.gatewayIP());
+            config.count                       = ESP_PING_COUNT_INFINITE;
+            config.interval_ms                 = 1000;
+            config.timeout_ms                  = 1000;
+
+            esp_ping_callbacks_t callbacks = {};
+            callbacks.on_ping_success      = ping_success;
+            callbacks.on_ping_timeout      = ping_timeout;
+            if (esp_ping_new_session(&config, &callbacks, &_ping) != ESP_OK) {
+                _ping = nullptr;
+                return;
+            }
+            esp_ping_start(_ping);
+        }
+
+        static void print_rtt(Channel& out, const char* label, const RttStats& s) {
+            LogStream msg(out, "RTT ");
+            msg << label << ": samples:" << s.count << " lost:" << s.lost;
+            if (s.count) {
+                msg << " min:" << s.min_ms << " avg:" << (s.total_ms / s.count) << " max:" << s.max_ms << " ms";
+            }
+        }
+
+        static Error showRTT(const char* parameter, AuthenticationLevel auth_level, Channel& out) {  // $WiFi/RTT
+            if (string_util::equal_ignore_case(parameter, "reset")) {
+                _rtt[0] = RttStats();
+                _rtt[1] = RttStats();
+                return Error::Ok;
+            }
+            if (*parameter) {
+                return Error::InvalidValue;
+            }
+            if (!_ping) {
+                log_string(out, "No RTT measurements; they need WiFi/LowLatency=On and a STA connection");
+                return Error::Ok;
+            }
+            log_stream(out, "RTT to gateway " << IP_string(WiFi.gatewayIP()));
+            print_rtt(out, "power saving off", _rtt[0]);
+            print_rtt(out, "power saving on", _rtt[1]);
+            return Error::Ok;
+        }
+
         static const char* modeName() {
             switch (WiFi.getMode()) {
                 case WIFI_OFF:
@@ -645,8 +768,10 @@ namespace WebUI {
             static bool disconnect_seen = false;
             switch (event) {
                 case SYSTEM_EVENT_STA_GOT_IP:
+                    start_ping();  // The gateway can change with the address
                     break;
                 case SYSTEM_EVENT_STA_DISCONNECTED:
+                    stop_ping();
                     if (!disconnect_seen) {
                         log_info_to(Uart0, "WiFi Disconnected");
                         disconnect_seen = true;
@@ -922,7 +1047,7 @@ namespace WebUI {
     public:
         WiFiConfig(const char* name) : Module(name) {}
 
-        void init() {
+        void init_settings() override {
             _sta_ssid    = new StringSetting("Station SSID", WEBSET, WA, "ESP100", "Sta/SSID", "", MIN_SSID_LENGTH, MAX_SSID_LENGTH);
             _hostname    = new HostnameSetting("Hostname", "ESP112", "Hostname", "fluidnc");
             _ap_channel  = new IntSetting("AP Channel", WEBSET, WA, "ESP108", "AP/Channel", 1, 1, 14);
@@ -941,16 +1066,25 @@ namespace WebUI {
 
             _mode         = new EnumSetting("WiFi mode", WEBSET, WA, "ESP116", "WiFi/Mode", WiFiFallback, &wifiModeOptions);
             _wifi_ps_mode = new EnumSetting("WiFi power saving mode", WEBSET, WA, NULL, "WiFi/PsMode", WIFI_PS_NONE, &wifiPsModeOptions);
+            _low_latency  = new EnumSetting("WiFi power saving off while running", WEBSET, WA, NULL, "WiFi/LowLatency", true, &onoffOptions);
 
             new WebCommand(NULL, WEBCMD, WU, "ESP410", "WiFi/ListAPs", listAPs);
             new WebCommand(NULL, WEBCMD, WG, "ESP800", "Firmware/Info", showFwInfo, anyState);
 
             new WebCommand(NULL, WEBCMD, WG, "ESP111", "System/IP", showIP);
             new WebCommand("IP=ipaddress MSK=netmask GW=gateway", WEBCMD, WA, "ESP103", "Sta/Setup", showSetStaParams);
+            new WebCommand("reset", WEBCMD, WG, NULL, "WiFi/RTT", showRTT, anyState);
+        }
+
+        bool deferred_init() override { return true; }
 
+        void init() {
             //stop active services
             // wifi_services.end();
 
+            // Even with WiFi off, so that Ethernet and the services use it
+            WiFi.setHostname(_hostname->get());
+
             switch (_mode->get()) {
                 case WiFiOff:
                     log_info("WiFi is disabled");
@@ -1013,6 +1147,8 @@ namespace WebUI {
         }
 
         void poll() {
+            update_power_save();
+
             //to avoid mixed mode due to scan network
             if (WiFi.getMode() == WIFI_AP_STA) {
                 // In principle it should be sufficient to check for != WIFI_SCAN_RUNNING,
@@ -1033,5 +1169,9 @@ namespace WebUI {
         }
     };
 
+    bool                 WiFiConfig::_ps_suspended = false;
+    WiFiConfig::RttStats WiFiConfig::_rtt[2];
+    esp_ping_handle_t    WiFiConfig::_ping = nullptr;
+
     ModuleFactory::InstanceBuilder<WiFiConfig> __attribute__((init_priority(105))) wifi_module("wifi", true);
 }
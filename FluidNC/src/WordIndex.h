@@ -0,0 +1,82 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// WordIndex is a case-insensitive sorted index into Setting::List or Command::List,
+// so that $name lookups do not compare the key to every setting and command.
+// It can index the new-style names, the Grbl and ESP names, or both.  When several
+// words have the same name, find() returns the one that is first in the list, as
+// a search through the list would.
+//
+// The lists only grow, so the index is rebuilt when the size of the list changes.
+//
+// It is header-only, and uses only getName() and getGrblName(), so that it can be
+// tested on the host.
+
+#include "string_util.h"
+
+#include <algorithm>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+template <typename T>
+class WordIndex {
+    struct Entry {
+        std::string_view name;
+        T*               word;
+    };
+
+    static int compare(std::string_view a, std::string_view b) {
+        size_t n = std::min(a.size(), b.size());
+        for (size_t i = 0; i < n; i++) {
+            char ca = string_util::tolower(a[i]);
+            char cb = string_util::tolower(b[i]);
+            if (ca != cb) {
+                return ca < cb ? -1 : 1;
+            }
+        }
+        return a.size() == b.size() ? 0 : (a.size() < b.size() ? -1 : 1);
+    }
+
+    std::vector<Entry> _entries;
+    size_t             _indexed = 0;  // Size of the list when the index was built
+    bool               _built   = false;
+    bool               _names;
+    bool               _grbl_names;
+    std::mutex         _mutex;
+
+    void build(const std::vector<T*>& list) {
+        _entries.clear();
+        for (T* word : list) {
+            if (_names) {
+                _entries.push_back({ word->getName(), word });
+            }
+            if (_grbl_names && word->getGrblName()) {
+                _entries.push_back({ word->getGrblName(), word });
+            }
+        }
+        // Stable, so that equal names stay in list order
+        std::stable_sort(_entries.begin(), _entries.end(), [](const Entry& a, const Entry& b) { return compare(a.name, b.name) < 0; });
+        _indexed = list.size();
+        _built   = true;
+    }
+
+public:
+    WordIndex(bool names, bool grbl_names) : _names(names), _grbl_names(grbl_names) {}
+
+    // Returns the first word in list with the name key, ignoring case, or nullptr
+    T* find(const std::vector<T*>& list, std::string_view key) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_built || list.size() != _indexed) {
+            build(list);
+        }
+        auto it = std::lower_bound(
+            _entries.begin(), _entries.end(), key, [](const Entry& e, std::string_view k) { return compare(e.name, k) < 0; });
+        if (it == _entries.end() || compare(it->name, key) != 0) {
+            return nullptr;
+        }
+        return it->word;
+    }
+};
@@ -0,0 +1,160 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  WriteBehind.h - double buffer that is written out behind a writer
+
+  A file that is written in many small pieces, like an upload arriving one network
+  packet at a time, is collected into two large blocks.  While the writer fills one
+  block, a background task writes the other to the file, so receiving and writing
+  overlap and the file sees a few large writes instead of many small ones.  Blocks
+  are written in the order they were filled, and only by the background task.  It is
+  header-only so that it can be tested on the host.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+class WriteBehind {
+public:
+    // Writes length bytes from buffer to the file, returning the number written
+    using Sink = size_t (*)(void* arg, const char* buffer, size_t length);
+
+    // Called while waiting for the background task to write a block
+    using Wait = void (*)();
+
+    struct Stats {
+        uint32_t writes       = 0;  // Blocks written to the file
+        uint32_t stalls       = 0;  // Times the writer had to wait for a block
+        uint64_t bytes        = 0;
+        uint32_t max_write_us = 0;
+        uint64_t sum_write_us = 0;
+        uint32_t timed_writes = 0;
+        uint32_t mean_write_us() const { return timed_writes ? uint32_t(sum_write_us / timed_writes) : 0; }
+    };
+
+private:
+    enum : uint8_t { Empty, Full };
+
+    struct Block {
+        char*                data;
+        size_t               length = 0;
+        std::atomic<uint8_t> state { Empty };
+    };
+
+    Block  _blocks[2];
+    size_t _block_size;
+    Sink   _sink;
+    void*  _arg;
+    Wait   _wait;
+
+    std::atomic<bool> _failed { false };  // A write came up short, so the rest are discarded
+
+    std::atomic<uint8_t> _next_write { 0 };  // Changed only by the background task
+
+    // Used only by the writer
+    uint8_t _current = 0;
+
+    Stats _stats;
+
+    void wait_empty(Block& block) {
+        if (block.state.load(std::memory_order_acquire) != Empty) {
+            ++_stats.stalls;
+            while (block.state.load(std::memory_order_acquire) != Empty) {
+                _wait();
+            }
+        }
+    }
+
+    void hand_off(Block& block) {
+        block.state.store(Full, std::memory_order_release);
+        _current ^= 1;
+    }
+
+public:
+    // storage must hold 2 * block_size bytes
+    WriteBehind(char* storage, size_t block_size, Sink sink, void* arg, Wait wait) :
+        _block_size(block_size), _sink(sink), _arg(arg), _wait(wait) {
+        _blocks[0].data = storage;
+        _blocks[1].data = storage + block_size;
+    }
+
+    WriteBehind(const WriteBehind&)            = delete;
+    WriteBehind& operator=(const WriteBehind&) = delete;
+
+    // Writer side
+
+    // Returns false once a write to the file has failed
+    bool write(const char* data, size_t length) {
+        while (length && !_failed) {
+            Block& block = _blocks[_current];
+            wait_empty(block);
+            size_t n = std::min(length, _block_size - block.length);
+            memcpy(block.data + block.length, data, n);
+            block.length += n;
+            data += n;
+            length -= n;
+            if (block.length == _block_size) {
+                hand_off(block);
+            }
+        }
+        return !_failed;
+    }
+
+    // Hands off a partly filled block and waits until everything has been written,
+    // returning false if any write failed
+    bool finish() {
+        Block& block = _blocks[_current];
+        wait_empty(block);
+        if (block.length) {
+            hand_off(block);
+        }
+        for (auto& b : _blocks) {
+            wait_empty(b);
+        }
+        return !_failed;
+    }
+
+    bool failed() const { return _failed; }
+
+    // True if a block is waiting for the background task
+    bool wants_write() const { return _blocks[_next_write].state.load(std::memory_order_acquire) == Full; }
+
+    // Background side
+
+    // Writes the next block if it is full, returning true if it did
+    bool write_behind() {
+        Block& block = _blocks[_next_write];
+        if (block.state.load(std::memory_order_acquire) != Full) {
+            return false;
+        }
+        if (!_failed) {
+            if (_sink(_arg, block.data, block.length) != block.length) {
+                _failed = true;
+            } else {
+                ++_stats.writes;
+                _stats.bytes += block.length;
+            }
+        }
+        block.length = 0;
+        _next_write = _next_write ^ 1;
+        block.state.store(Empty, std::memory_order_release);
+        return true;
+    }
+
+    // Statistics
+
+    // Called by the sink with the time that a write took
+    void record_write_time(uint32_t us) {
+        _stats.max_write_us = std::max(_stats.max_write_us, us);
+        _stats.sum_write_us += us;
+        ++_stats.timed_writes;
+    }
+
+    const Stats& stats() const { return _stats; }
+};
@@ -3,70 +3,182 @@
 
 #include "lineedit.h"
 
+#include <algorithm>
+#include <cstring>  // memcpy
+
 Lineedit::Lineedit(Print* _out, char* line, int linelen) : out(_out), needs_reecho(false), startaddr(line), maxaddr(line + linelen) {
     restart();
 }
 
 #define CTRL(c) (c & 0x1f)
 
+// The output of a keystroke is collected and sent with one write, so that a slow
+// link sends it as one burst instead of a write per character.
 void Lineedit::emit(char c) {
-    out->write(c);
+    if (outlen == sizeof(outbuf)) {
+        flush();
+    }
+    outbuf[outlen++] = c;
 }
 
-void Lineedit::echo_line() {
-    for (const char* p = startaddr; p < endaddr; ++p) {
-        emit(*p);
+void Lineedit::emit(const char* s, int n) {
+    while (n-- > 0) {
+        emit(*s++);
     }
-    for (const char* p = endaddr; p > thisaddr; --p) {
-        emit('\b');
+}
+
+void Lineedit::flush() {
+    if (outlen) {
+        out->write(reinterpret_cast<const uint8_t*>(outbuf), outlen);
+        outlen = 0;
     }
 }
 
-void Lineedit::addchar(char c, bool echo) {
-    if (thisaddr < maxaddr) {
-        char* p;
-        if (endaddr < maxaddr) {
-            ++endaddr;
-        }
-        for (p = endaddr; --p >= thisaddr + 1;) {
-            *p = *(p - 1);
-        }
-        *thisaddr++ = c;
-        if (echo) {
-            emit(c);
-        }
-        for (++p; p < endaddr; p++) {
-            emit(*p);
+// The display is changed with the ANSI sequences for cursor motion and for inserting
+// and deleting characters, when they are shorter than rewriting the rest of the line.
+// The keys already arrive as ANSI sequences, so the terminal understands them.
+static int csi_length(int n) {
+    return n == 1 ? 3 : n < 10 ? 4 : n < 100 ? 5 : 6;
+}
+
+// ESC [ n cmd, with n omitted when it is 1
+void Lineedit::csi(int n, char cmd) {
+    emit(0x1b);
+    emit('[');
+    if (n != 1) {
+        char digits[4];
+        int  len = 0;
+        do {
+            digits[len++] = '0' + n % 10;
+            n /= 10;
+        } while (n && len < 4);
+        while (len) {
+            emit(digits[--len]);
         }
-        for (; p > thisaddr; --p) {
+    }
+    emit(cmd);
+}
+
+void Lineedit::cursor_left(int n) {
+    if (n <= 0) {
+        return;
+    }
+    if (n <= csi_length(n)) {
+        while (n--) {
             emit('\b');
         }
+    } else {
+        csi(n, 'D');
     }
 }
 
-void Lineedit::erase_char() {
-    if (thisaddr > startaddr) {
-        --thisaddr;
-        --endaddr;
-        emit('\b');
-        char* p;
-        for (p = thisaddr; p < endaddr; p++) {
-            *p = *(p + 1);
-            emit(*p);
+// Moves the cursor over the n characters at thisaddr
+void Lineedit::cursor_right(int n) {
+    if (n <= 0) {
+        return;
+    }
+    if (n <= csi_length(n)) {
+        emit(thisaddr, n);
+    } else {
+        csi(n, 'C');
+    }
+}
+
+void Lineedit::echo_line() {
+    emit(startaddr, endaddr - startaddr);
+    cursor_left(endaddr - thisaddr);
+}
+
+// Inserts n characters before the cursor.  If the line is full, the characters at
+// its end are lost.
+void Lineedit::insert(const char* s, int n, bool echo) {
+    n = std::min(n, int(maxaddr - thisaddr));
+    if (n <= 0) {
+        return;
+    }
+    int  old_tail = endaddr - thisaddr;
+    int  tail     = std::min(old_tail, int(maxaddr - thisaddr) - n);
+    bool dropped  = tail < old_tail;
+    memmove(thisaddr + n, thisaddr, tail);
+    memcpy(thisaddr, s, n);
+    endaddr = thisaddr + n + tail;
+    if (echo) {
+        if (tail && !dropped && csi_length(n) < 2 * tail) {
+            // The terminal moves the rest of the line over
+            csi(n, '@');
+            emit(s, n);
+        } else {
+            // The new characters and the rest of the line cover all of the old line
+            emit(thisaddr, n + tail);
+            thisaddr += n + tail;
+            cursor_left(tail);
+            thisaddr -= tail;
+            return;
         }
+    }
+    thisaddr += n;
+}
+
+void Lineedit::addchar(char c, bool echo) {
+    insert(&c, 1, echo);
+}
+
+// Without editing, the cursor is always at the end of the line
+void Lineedit::append(const char* s, size_t length) {
+    size_t n = std::min(length, size_t(maxaddr - endaddr));
+    memcpy(endaddr, s, n);
+    endaddr += n;
+    thisaddr = endaddr;
+}
+
+// Deletes the n characters before the cursor
+void Lineedit::erase_back(int n) {
+    n = std::min(n, int(thisaddr - startaddr));
+    if (n <= 0) {
+        return;
+    }
+    int tail = endaddr - thisaddr;
+    memmove(thisaddr - n, thisaddr, tail);
+    thisaddr -= n;
+    endaddr -= n;
+    cursor_left(n);
+    erase_display(n, tail);
+}
+
+// Deletes the n characters at the cursor
+void Lineedit::erase_forward(int n) {
+    n = std::min(n, int(endaddr - thisaddr));
+    if (n <= 0) {
+        return;
+    }
+    int tail = endaddr - thisaddr - n;
+    memmove(thisaddr, thisaddr + n, tail);
+    endaddr -= n;
+    erase_display(n, tail);
+}
+
+// Removes n characters at the cursor from the display, where tail characters follow them
+void Lineedit::erase_display(int n, int tail) {
+    if (tail) {
+        csi(n, 'P');
+    } else if (2 * n <= 3) {
         emit(' ');
-        for (++p; p > thisaddr; --p) {
-            emit('\b');
-        }
+        emit('\b');
+    } else {
+        csi(1, 'K');  // Erase to the end of the line
     }
 }
 
+void Lineedit::erase_char() {
+    erase_back(1);
+}
+
 void Lineedit::erase_line() {
-    for (; thisaddr < endaddr; ++thisaddr)
-        emit(*thisaddr);
-    while (thisaddr > startaddr)
-        erase_char();
-    endaddr = startaddr;
+    if (startaddr < endaddr) {
+        cursor_left(thisaddr - startaddr);
+        csi(1, 'K');
+    }
+    endaddr = thisaddr = startaddr;
 }
 
 void Lineedit::validate_history() {
@@ -181,12 +293,8 @@ bool Lineedit::get_history(int history_num) {
     }
 
     erase_line();
-    for (i = 0; i < maxaddr - startaddr - 1; i++) {
-        if (*p == '\0') {
-            break;
-        }
-        addchar(*p++);
-    }
+    for (i = 0; i < maxaddr - startaddr - 1 && p[i] != '\0'; i++) {}
+    insert(p, i);
 
     return true;
 }
@@ -205,65 +313,65 @@ void Lineedit::forward_char() {
     }
 }
 
+void Lineedit::move_to(char* addr) {
+    if (addr < thisaddr) {
+        cursor_left(thisaddr - addr);
+    } else {
+        cursor_right(addr - thisaddr);
+    }
+    thisaddr = addr;
+}
+
 bool Lineedit::is_word_delim(char c) {
     return c == ' ' || c == '/' || c == '=' || c == ',';
 }
 
 void Lineedit::forward_word() {
+    char* p = thisaddr;
     // Skip delimiters that we are already on
-    while ((thisaddr < endaddr) && is_word_delim(*thisaddr)) {
-        emit(*thisaddr);
-        ++thisaddr;
+    while ((p < endaddr) && is_word_delim(*p)) {
+        ++p;
     }
     // Find the next delimiter
-    while ((thisaddr < endaddr) && !is_word_delim(*thisaddr)) {
-        emit(*thisaddr);
-        ++thisaddr;
+    while ((p < endaddr) && !is_word_delim(*p)) {
+        ++p;
     }
     // Skip to the next non-delimiter
-    while ((thisaddr < endaddr) && is_word_delim(*thisaddr)) {
-        emit(*thisaddr);
-        ++thisaddr;
+    while ((p < endaddr) && is_word_delim(*p)) {
+        ++p;
     }
+    move_to(p);
 }
 
+// Words longer than killbuf are cut, but are still removed from the line
 void Lineedit::kill_forward() {
-    char* p = killbuf;
-    while (thisaddr < endaddr) {
-        *p++ = *thisaddr;
-        forward_char();
-        erase_char();
+    size_t n = std::min(size_t(endaddr - thisaddr), sizeof(killbuf) - 1);
+    memcpy(killbuf, thisaddr, n);
+    killbuf[n] = '\0';
+    if (thisaddr < endaddr) {
+        erase_display(endaddr - thisaddr, 0);
+        endaddr = thisaddr;
     }
-    *p = '\0';
 }
 void Lineedit::yank() {
-    for (const char* p = killbuf; *p; ++p) {
-        addchar(*p);
-    }
+    insert(killbuf, strlen(killbuf));
 }
 
 void Lineedit::backward_word() {
     if (startaddr >= endaddr) {
         return;
     }
+    char* p = thisaddr;
 
     // Skip over delimiters
-    while ((thisaddr > startaddr) && is_word_delim(thisaddr[-1])) {
-        emit('\b');
-        --thisaddr;
+    while ((p > startaddr) && is_word_delim(p[-1])) {
+        --p;
     }
     // Scan backward over non-delimiters
-    while ((thisaddr > startaddr) && !is_word_delim(thisaddr[-1])) {
-        emit('\b');
-        --thisaddr;
+    while ((p > startaddr) && !is_word_delim(p[-1])) {
+        --p;
     }
-#if 0
-    // Scan backward to a non-space just after a space
-    while ((thisaddr > startaddr) && !is_word_delim(thisaddr[-1])) {
-        emit('\b');
-        --thisaddr;
-    }
-#endif
+    move_to(p);
 }
 
 #ifndef NO_COMPLETION
@@ -283,11 +391,12 @@ bool Lineedit::find_word_under_cursor() {
         theWord[i++] = *addr++;
     }
     // Move to the end of the item name
-    while (thisaddr < endaddr && i < (100 - 1) && *thisaddr != '=') {
-        emit(*thisaddr);
-        theWord[i++] = *thisaddr++;
+    char* p = thisaddr;
+    while (p < endaddr && i < (100 - 1) && *p != '=') {
+        theWord[i++] = *p++;
     }
     theWord[i] = '\0';
+    move_to(p);
     return true;
 }
 
@@ -296,9 +405,7 @@ extern int num_initial_matches(const char* key, int keylen, int matchnum, char*
 void Lineedit::color(const char* s) {
     emit(0x1b);
     emit('[');
-    while (*s) {
-        emit(*s++);
-    }
+    emit(s, strlen(s));
     emit('m');
 }
 void Lineedit::cyan() {
@@ -330,27 +437,26 @@ void Lineedit::complete_word() {
     }
     matchlen = strlen(name);
     if (nmatches == 1) {
-        while (len < matchlen) {
-            addchar(name[len++]);
-        }
+        insert(name + len, matchlen - len);
         nmatches = 0;
         return;
     }
 
-    while (len < matchlen) {
-        theWord[len] = name[len];
-        if (nmatches != num_initial_matches(theWord, len + 1, 0, nullptr)) {
+    // The prefix common to all the matches
+    int common = len;
+    while (common < matchlen) {
+        theWord[common] = name[common];
+        if (nmatches != num_initial_matches(theWord, common + 1, 0, nullptr)) {
             break;
         }
-        addchar(theWord[len++]);
+        ++common;
     }
-    theWord[len] = '\0';
+    theWord[common] = '\0';
+    insert(name + len, common - len);
 
     thismatch = 0;
     highlight();
-    while (len < matchlen) {
-        addchar(name[len++]);
-    }
+    insert(name + common, matchlen - common);
     lowlight();
 }
 
@@ -364,28 +470,20 @@ void Lineedit::propose_word() {
     nmatches        = num_initial_matches(theWord, len, thismatch, name);
     int newmatchlen = strlen(name);
 
-    while (matchlen > len) {
-        erase_char();
-        --matchlen;
-    }
+    erase_back(matchlen - len);
     highlight();
-    while (matchlen < newmatchlen) {
-        addchar(name[matchlen++]);
-    }
+    insert(name + len, newmatchlen - len);
+    matchlen = newmatchlen;
     lowlight();
 }
 void Lineedit::accept_word() {
-    int len = strlen(theWord);
-    int i;
-    for (i = matchlen; i > len; --i) {
-        emit('\b');
-        --thisaddr;
-    }
+    // Rewrite the proposed part of the word in the normal color
+    int n = matchlen - strlen(theWord);
+    cursor_left(n);
+    thisaddr -= n;
     lowlight();
-    while (i < matchlen) {
-        emit(*thisaddr++);
-        ++i;
-    }
+    emit(thisaddr, n);
+    thisaddr += n;
 }
 #endif
 
@@ -401,9 +499,7 @@ void Lineedit::show_realtime_command(const char* s) {
         emit('\n');
     }
     if (*s) {
-        while (*s) {
-            emit(*s++);
-        }
+        emit(s, strlen(s));
         emit('\n');
         echo_line();
     } else {
@@ -455,12 +551,19 @@ bool Lineedit::realtime(int c) {
             show_realtime_command("[Reset]");
             break;
     }
+    flush();
     return true;
 }
 
 // Returns true when the line is complete
 // cppcheck-suppress unusedFunction
 bool Lineedit::step(int c) {
+    bool done = edit(c);
+    flush();
+    return done;
+}
+
+bool Lineedit::edit(int c) {
     // Regardless of editing mode, ^L turns off editing/echoing
     if (c == CTRL('l')) {
         editing = false;
@@ -593,13 +696,11 @@ bool Lineedit::step(int c) {
             return true;
         case 127:  // Delete
         case '\b':
-            if (thisaddr > startaddr)
-                erase_char();
+            erase_char();
             break;
         case CTRL('a'):
         case SPECIAL_HOME:
-            while (thisaddr > startaddr)
-                backward_char();
+            move_to(startaddr);
             break;
         case CTRL('b'):
         case SPECIAL_LEFT:
@@ -607,15 +708,11 @@ bool Lineedit::step(int c) {
             break;
         case CTRL('d'):
         case SPECIAL_DELETE:
-            if (thisaddr < endaddr) {
-                forward_char();
-                erase_char();
-            }
+            erase_forward(1);
             break;
         case CTRL('e'):
         case SPECIAL_END:
-            while (thisaddr < endaddr)
-                forward_char();
+            move_to(endaddr);
             break;
         case CTRL('f'):
         case SPECIAL_RIGHT:
@@ -640,12 +737,15 @@ bool Lineedit::step(int c) {
             if (get_history(history_num - 1))
                 --history_num;
             break;
-        case CTRL('w'):
-            while (thisaddr > startaddr && is_word_delim(thisaddr[-1]))
-                erase_char();
-            while (thisaddr > startaddr && !is_word_delim(thisaddr[-1]))
-                erase_char();
+        case CTRL('w'): {
+            char* p = thisaddr;
+            while (p > startaddr && is_word_delim(p[-1]))
+                --p;
+            while (p > startaddr && !is_word_delim(p[-1]))
+                --p;
+            erase_back(thisaddr - p);
             break;
+        }
 
         default:
             if (c >= ' ')
@@ -51,10 +51,24 @@ private:
     int escaping;
     int history_num = -1;
 
+    // Output is collected here and written once per key
+    char outbuf[64];
+    int  outlen = 0;
+
     void emit(char c);
+    void emit(const char* s, int n);
+    void flush();
+    void csi(int n, char cmd);
+    void cursor_left(int n);
+    void cursor_right(int n);
+    void move_to(char* addr);
 
     void echo_line();
+    void insert(const char* s, int n, bool echo = true);
     void addchar(char c, bool echo = true);
+    void erase_back(int n);
+    void erase_forward(int n);
+    void erase_display(int n, int tail);
     void erase_char();
     void erase_line();
     void validate_history();
@@ -80,6 +94,7 @@ private:
     void accept_word();
     void restart();
     void show_realtime_command(const char* s);
+    bool edit(int c);
 
 public:
     Lineedit(Print* out, char* line, int linelen);
@@ -88,4 +103,11 @@ public:
     int  finish();
     bool step(int c);
     bool realtime(int c);
+
+    // True once a control character has turned on interactive editing
+    bool is_editing() const { return editing; }
+
+    // Adds characters that step() would add one at a time, without echo, when
+    // not editing.  Characters that do not fit are dropped.
+    void append(const char* s, size_t length);
 };
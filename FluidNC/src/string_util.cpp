@@ -3,6 +3,7 @@
 #include <cstdlib>
 #include <cctype>
 #include <charconv>
+#include <cstring>
 
 namespace string_util {
     char tolower(char c) {
@@ -125,4 +126,98 @@ namespace string_util {
         }
         return true;
     }
+
+    static int base64_value(char c) {
+        if (c >= 'A' && c <= 'Z') {
+            return c - 'A';
+        }
+        if (c >= 'a' && c <= 'z') {
+            return c - 'a' + 26;
+        }
+        if (isdigit(c)) {
+            return c - '0' + 52;
+        }
+        if (c == '+') {
+            return 62;
+        }
+        if (c == '/') {
+            return 63;
+        }
+        return -1;
+    }
+
+    int from_base64(std::string_view str, uint8_t* out, size_t max) {
+        while (!str.empty() && str.back() == '=') {
+            str.remove_suffix(1);
+        }
+        if (str.size() % 4 == 1) {
+            return -1;
+        }
+        size_t   length = 0;
+        uint32_t bits   = 0;
+        int      n_bits = 0;
+        for (char c : str) {
+            int value = base64_value(c);
+            if (value < 0) {
+                return -1;
+            }
+            bits = (bits << 6) | value;
+            n_bits += 6;
+            if (n_bits >= 8) {
+                n_bits -= 8;
+                if (length == max) {
+                    return -1;
+                }
+                out[length++] = (bits >> n_bits) & 0xff;
+            }
+        }
+        return length;
+    }
+
+    size_t printable_run(const uint8_t* data, size_t length) {
+        size_t run = 0;
+        // A byte below 0x20 borrows into its top bit, and one above 0x7f has it set.
+        // Borrows can also mark later bytes, so the word is rescanned a byte at a time.
+        while (run + sizeof(uint32_t) <= length) {
+            uint32_t word;
+            memcpy(&word, data + run, sizeof(word));
+            if (((word - 0x20202020) | word) & 0x80808080) {
+                break;
+            }
+            run += sizeof(word);
+        }
+        while (run < length && data[run] >= 0x20 && data[run] < 0x80) {
+            ++run;
+        }
+        return run;
+    }
+
+    // Each '*' only needs to be retried from just after the most recent one, because
+    // a later star can absorb anything an earlier one could, so there is no recursion
+    // and the time is at most the product of the lengths.
+    bool glob_match(std::string_view pattern, std::string_view text, bool case_sensitive) {
+        size_t p      = 0;
+        size_t t      = 0;
+        size_t star   = std::string_view::npos;  // Position in pattern after the last '*'
+        size_t resume = 0;                       // Position in text where that '*' stopped
+        while (t < text.size()) {
+            if (p < pattern.size() && pattern[p] == '*') {
+                star   = ++p;
+                resume = t;
+            } else if (p < pattern.size() &&
+                       (pattern[p] == '?' || (case_sensitive ? pattern[p] == text[t] : tolower(pattern[p]) == tolower(text[t])))) {
+                ++p;
+                ++t;
+            } else if (star != std::string_view::npos) {
+                p = star;
+                t = ++resume;
+            } else {
+                return false;
+            }
+        }
+        while (p < pattern.size() && pattern[p] == '*') {
+            ++p;
+        }
+        return p == pattern.size();
+    }
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <string_view>
 
@@ -16,4 +17,16 @@ namespace string_util {
     bool from_float(std::string_view str, float& value);
     bool split(std::string_view& input, std::string_view& next, char delim);
     bool split_prefix(std::string_view& rest, std::string_view& prefix, char delim);
+
+    // Decodes base64, with or without '=' padding, into out.  Returns the number of
+    // bytes decoded, or -1 if str is malformed or does not fit in max bytes.
+    int from_base64(std::string_view str, uint8_t* out, size_t max);
+
+    // Returns the length of the run of printable ASCII characters, 0x20 to 0x7f,
+    // at the start of data.  Testing a word at a time makes long runs cheap.
+    size_t printable_run(const uint8_t* data, size_t length);
+
+    // Returns true if all of text matches the filename wildcard pattern, in which
+    // '*' matches any run of characters and '?' matches any one character.
+    bool glob_match(std::string_view pattern, std::string_view text, bool case_sensitive = false);
 }
@@ -33,6 +33,12 @@
  */
 
 #include "xmodem.h"
+#include "HeapTag.h"  // HeapTag
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
 
 static Channel* serialPort;
 static Print*   file;
@@ -114,6 +120,39 @@ static void flushinput(void) {
         ;
 }
 
+// Received data is gathered into a large buffer and written to the
+// file in multiples of the SD sector size, so the filesystem sees one
+// long multi-sector write every few packets instead of a partial-sector
+// write for every packet.  If the buffer cannot be allocated, packets
+// are written directly.
+static const size_t WRITE_BUFFER_SIZE = 8192;
+static uint8_t*     write_buffer;
+static size_t       write_buffer_len;
+static HeapTag      heap_tag("XModem");
+
+static void flush_write_buffer() {
+    if (write_buffer_len > 0) {
+        file->write(write_buffer, write_buffer_len);
+        write_buffer_len = 0;
+    }
+}
+static void write_bytes(const uint8_t* buf, size_t len) {
+    if (!write_buffer) {
+        file->write(buf, len);
+        return;
+    }
+    while (len > 0) {
+        size_t count = std::min(len, WRITE_BUFFER_SIZE - write_buffer_len);
+        memcpy(write_buffer + write_buffer_len, buf, count);
+        write_buffer_len += count;
+        buf += count;
+        len -= count;
+        if (write_buffer_len == WRITE_BUFFER_SIZE) {
+            flush_write_buffer();
+        }
+    }
+}
+
 // We delay writing each packet until the next one arrives
 // so that we can remove trailing control-Z's in only the
 // last one.  The Xmodem protocol has no good way to denote
@@ -124,44 +163,87 @@ static void flushinput(void) {
 // fails with binary files that are supposed to have trailing
 // control-Z's.  Doing the control-Z removal only on the final
 // packet avoids removing interior control-Z's that happen to
-// land at the end of a packet.
+// land at the end of a packet.  YMODEM senders announce the
+// size in the header block, in which case the padding is cut
+// at exactly that size instead.
 static uint8_t held_packet[1024];
 static size_t  held_packet_len;
-static void    flush_packet(size_t packet_len, size_t& total_len) {
+static int32_t file_size;  // From the YMODEM header, or -1
+
+static size_t limit_to_size(size_t count, size_t total_len) {
+    if (file_size >= 0) {
+        size_t remaining = total_len < size_t(file_size) ? size_t(file_size) - total_len : 0;
+        count            = std::min(count, remaining);
+    }
+    return count;
+}
+static void flush_packet(size_t packet_len, size_t& total_len) {
     if (held_packet_len > 0) {
-        // Remove trailing ctrl-z's on the final packet
         size_t count;
-        for (count = held_packet_len; count > 0; --count) {
-            if (held_packet[count - 1] != CTRLZ) {
-                break;
+        if (file_size >= 0) {
+            count = limit_to_size(held_packet_len, total_len);
+        } else {
+            // Remove trailing ctrl-z's on the final packet
+            for (count = held_packet_len; count > 0; --count) {
+                if (held_packet[count - 1] != CTRLZ) {
+                    break;
+                }
             }
         }
-        file->write(held_packet, count);
+        write_bytes(held_packet, count);
         total_len += count;
         held_packet_len = 0;
     }
 }
 static void write_packet(uint8_t* buf, size_t packet_len, size_t& total_len) {
     if (held_packet_len > 0) {
-        file->write(held_packet, held_packet_len);
-        total_len += held_packet_len;
+        size_t count = limit_to_size(held_packet_len, total_len);
+        write_bytes(held_packet, count);
+        total_len += count;
         held_packet_len = 0;
     }
     memcpy(held_packet, buf, packet_len);
     held_packet_len = packet_len;
 }
-int xmodemReceive(Channel* serial, FileStream* out) {
-    serialPort      = serial;
-    file            = out;
-    held_packet_len = 0;
 
+// Reads the rest of a packet in as few calls as possible, failing
+// only if the line goes quiet for a second
+static bool _inbytes(uint8_t* buf, size_t len) {
+    while (len > 0) {
+        size_t count = serialPort->timedReadBytes(buf, len, DLY_1S);
+        if (count == 0) {
+            return false;
+        }
+        buf += count;
+        len -= count;
+    }
+    return true;
+}
+
+static void cancel() {
+    flushinput();
+    _outbyte(CAN);
+    _outbyte(CAN);
+    _outbyte(CAN);
+}
+
+// The receiver starts with 'G' for streaming YMODEM-g, 'C' for CRC
+// or NAK for checksums, falling back to the next one if the sender
+// does not respond.  YMODEM batches begin with a header block 0
+// carrying the file name and size; after the EOT the sender offers
+// the next file with another header, which is empty at the end of
+// the batch.  Only one file is received per transfer.  In streaming
+// mode data blocks are not acknowledged, so the sender can keep the
+// link full, and any error cancels the transfer.
+static int receive(bool streaming) {
     uint8_t  xbuff[1030]; /* 1024 for XModem 1k + 3 head chars + 2 crc + nul */
-    uint8_t* p;
     int      bufsz = 0, crc = 0;
-    uint8_t  trychar  = 'C';
+    uint8_t  trychar  = streaming ? 'G' : 'C';
     uint8_t  packetno = 1;
-    int      i, c           = 0;
+    int      c        = 0;
     int      retry, retrans = MAXRETRANS;
+    bool     ymodem = false;
+    bool     ending = false;  // Waiting for the header that follows the file
 
     size_t len = 0;
 
@@ -180,13 +262,19 @@ int xmodemReceive(Channel* serial, FileStream* out) {
                     case EOT:
                         flush_packet(bufsz, len);
                         _outbyte(ACK);
-                        flushinput();
-                        return len; /* normal end */
+                        if (!ymodem) {
+                            flushinput();
+                            return len; /* normal end */
+                        }
+                        ending  = true;
+                        trychar = streaming ? 'G' : 'C';
+                        retry   = 0;
+                        continue;
                     case CAN:
                         if ((c = _inbyte(DLY_1S)) == CAN) {
                             flushinput();
                             _outbyte(ACK);
-                            return -1; /* canceled by remote */
+                            return ending ? len : -1; /* canceled by remote */
                         }
                         break;
                     default:
@@ -194,26 +282,52 @@ int xmodemReceive(Channel* serial, FileStream* out) {
                 }
             }
         }
+        if (ending) {
+            // The sender did not offer another file
+            flushinput();
+            return len;
+        }
+        if (trychar == 'G') {
+            trychar   = 'C';
+            streaming = false;
+            continue;
+        }
         if (trychar == 'C') {
             trychar = NAK;
             continue;
         }
-        flushinput();
-        _outbyte(CAN);
-        _outbyte(CAN);
-        _outbyte(CAN);
+        cancel();
         return -2; /* sync error */
 
     start_recv:
-        if (trychar == 'C')
+        if (trychar == 'C' || trychar == 'G')
             crc = 1;
-        trychar = 0;
-        p       = xbuff;
-        *p++    = c;
-        for (i = 0; i < (bufsz + (crc ? 1 : 0) + 3); ++i) {
-            if ((c = _inbyte(DLY_1S)) < 0)
-                goto reject;
-            *p++ = c;
+        trychar  = 0;
+        xbuff[0] = c;
+        if (!_inbytes(&xbuff[1], bufsz + (crc ? 1 : 0) + 3))
+            goto reject;
+
+        if (xbuff[1] == (uint8_t)(~xbuff[2]) && xbuff[1] == 0 && (packetno == 1 || ending) && check(crc, &xbuff[3], bufsz)) {
+            // YMODEM header: the file name, NUL, then the size in decimal
+            const char* name = (const char*)&xbuff[3];
+            xbuff[3 + bufsz] = '\0';
+            if (ending || !*name) {
+                if (!streaming)
+                    _outbyte(ACK);
+                if (*name) {
+                    cancel(); /* a second file */
+                } else {
+                    flushinput();
+                }
+                return len;
+            }
+            const char* size = name + strlen(name) + 1;
+            file_size        = size < name + bufsz && isdigit(*size) ? strtol(size, nullptr, 10) : -1;
+            ymodem           = true;
+            if (!streaming)
+                _outbyte(ACK);
+            trychar = streaming ? 'G' : 'C';
+            continue;
         }
 
         if (xbuff[1] == (uint8_t)(~xbuff[2]) && (xbuff[1] == packetno || xbuff[1] == packetno - 1) && check(crc, &xbuff[3], bufsz)) {
@@ -223,21 +337,40 @@ int xmodemReceive(Channel* serial, FileStream* out) {
                 retrans = MAXRETRANS + 1;
             }
             if (--retrans <= 0) {
-                flushinput();
-                _outbyte(CAN);
-                _outbyte(CAN);
-                _outbyte(CAN);
+                cancel();
                 return -3; /* too many retry error */
             }
-            _outbyte(ACK);
+            if (!streaming)
+                _outbyte(ACK);
             continue;
         }
     reject:
+        if (streaming) {
+            cancel();
+            return -3; /* no retransmission in streaming mode */
+        }
         flushinput();
         _outbyte(NAK);
     }
 }
 
+int xmodemReceive(Channel* serial, FileStream* out, bool streaming) {
+    serialPort       = serial;
+    file             = out;
+    held_packet_len  = 0;
+    file_size        = -1;
+    write_buffer_len = 0;
+    write_buffer     = heap_tag.allocated(static_cast<uint8_t*>(malloc(WRITE_BUFFER_SIZE)), WRITE_BUFFER_SIZE);
+
+    int len = receive(streaming);
+
+    flush_write_buffer();
+    heap_tag.freed(write_buffer, WRITE_BUFFER_SIZE);
+    free(write_buffer);
+    write_buffer = nullptr;
+    return len;
+}
+
 int xmodemTransmit(Channel* serial, FileStream* infile) {
     serialPort = serial;
 
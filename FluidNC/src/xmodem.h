@@ -3,5 +3,9 @@
 #include "Channel.h"
 #include "FileStream.h"
 
-int xmodemReceive(Channel* serial, FileStream* outfile);
+// With streaming, the receiver asks for YMODEM-g, which only suits error-free links
+int xmodemReceive(Channel* serial, FileStream* outfile, bool streaming = false);
 int xmodemTransmit(Channel* serial, FileStream* infile);
+
+// CRC-16/XMODEM, also used to check records stored in NVS
+uint16_t crc16_ccitt(const uint8_t* buf, size_t len);
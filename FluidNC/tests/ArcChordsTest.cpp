@@ -0,0 +1,121 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/ArcChords.h"
+
+#include <vector>
+
+static const int correction = 12;  // N_ARC_CORRECTION
+
+// The point loop of mc_arc() before ArcChords, for comparison
+static void reference_chords(float r0, float r1, float theta, int segments, std::vector<float>& xs, std::vector<float>& ys) {
+    float radii[2] = { r0, r1 };
+    float cos_T    = 2.0f - theta * theta;
+    float sin_T    = theta * 0.16666667f * (cos_T + 4.0f);
+    cos_T *= 0.5;
+    size_t count = 0;
+    for (uint16_t i = 1; i < segments; i++) {
+        if (count < correction) {
+            float ri = radii[0] * sin_T + radii[1] * cos_T;
+            radii[0] = radii[0] * cos_T - radii[1] * sin_T;
+            radii[1] = ri;
+            count++;
+        } else {
+            float cos_Ti = cosf(i * theta);
+            float sin_Ti = sinf(i * theta);
+            radii[0]     = r0 * cos_Ti - r1 * sin_Ti;
+            radii[1]     = r0 * sin_Ti + r1 * cos_Ti;
+            count        = 0;
+        }
+        xs.push_back(radii[0]);
+        ys.push_back(radii[1]);
+    }
+}
+
+TEST(ArcChords, SameAsReference) {
+    const int          segments = 200;
+    const float        theta    = 6.2831853f / segments;
+    std::vector<float> xs, ys;
+    reference_chords(-3.0f, 4.0f, theta, segments, xs, ys);
+
+    // Batch sizes that do and do not divide the correction interval
+    for (int batch : { 1, 7, 13, 16, 64 }) {
+        ArcChords chords(-3.0f, 4.0f, theta, correction);
+        float     r0[64], r1[64];
+        for (int i = 0; i < segments - 1;) {
+            int n = std::min(batch, segments - 1 - i);
+            chords.next(n, r0, r1);
+            for (int k = 0; k < n; k++, i++) {
+                EXPECT_EQ(r0[k], xs[i]) << "batch " << batch << " point " << i;
+                EXPECT_EQ(r1[k], ys[i]) << "batch " << batch << " point " << i;
+            }
+        }
+    }
+}
+
+TEST(ArcChords, StaysOnCircle) {
+    const int   segments = 1000;
+    const float theta    = -12.566371f / segments;  // Two clockwise turns
+    ArcChords   chords(10.0f, 0.0f, theta, correction);
+    for (int i = 1; i < segments; i++) {
+        float r0, r1;
+        chords.next(1, &r0, &r1);
+        EXPECT_NEAR(r0, 10.0f * cosf(i * theta), 1e-4f);
+        EXPECT_NEAR(r1, 10.0f * sinf(i * theta), 1e-4f);
+    }
+}
+
+// The largest distance between the chords of fit and the arc, sampled along each chord in
+// double precision
+static double fit_deviation(float angular_travel, float radius, const ArcFit& fit) {
+    double theta = double(angular_travel) / fit.segments;
+    double worst = 0;
+    for (int i = 0; i < fit.segments; i++) {
+        double r0 = i == 0 ? radius : fit.radius;
+        double r1 = i == fit.segments - 1 ? radius : fit.radius;
+        double x0 = r0 * cos(i * theta), y0 = r0 * sin(i * theta);
+        double x1 = r1 * cos((i + 1) * theta), y1 = r1 * sin((i + 1) * theta);
+        for (int k = 0; k <= 64; k++) {
+            double t = k / 64.0;
+            worst    = std::max(worst, fabs(hypot(x0 + t * (x1 - x0), y0 + t * (y1 - y0)) - radius));
+        }
+    }
+    return worst;
+}
+
+// The chord count of mc_arc() from arc_tolerance
+static uint16_t tolerance_segments(float angular_travel, float radius, float tolerance) {
+    return uint16_t(floorf(fabsf(0.5f * angular_travel * radius) / sqrtf(tolerance * (2 * radius - tolerance))));
+}
+
+TEST(ArcChords, SlowArcUnchanged) {
+    float    tolerance = 0.002f;
+    uint16_t segments  = tolerance_segments(3.1415927f, 20.0f, tolerance);
+    ArcFit   fit       = arc_fit(3.1415927f, 20.0f, tolerance, 500.0f * (1.0f / 6000.0f), segments);
+    EXPECT_EQ(fit.segments, segments);
+    EXPECT_EQ(fit.radius, 20.0f);
+}
+
+TEST(ArcChords, FastArcFewerChords) {
+    float tolerance = 0.002f;
+    for (float radius : { 0.5f, 2.0f, 10.0f, 50.0f }) {
+        for (float feed : { 2000.0f, 6000.0f, 20000.0f }) {
+            for (float angle : { 1.0f, -6.2831853f, 31.415927f }) {
+                uint16_t segments = tolerance_segments(angle, radius, tolerance);
+                ArcFit   fit      = arc_fit(angle, radius, tolerance, feed * (1.0f / 6000.0f), segments);
+                EXPECT_LE(fit.segments, segments);
+                EXPECT_GE(fit.segments, std::min(segments, uint16_t(2)));
+                // The floorf() in the tolerance count can exceed the tolerance a little by itself,
+                // and the fit is computed in float, so it is exact to about an ulp of the radius
+                double limit = std::max(double(tolerance), fit_deviation(angle, radius, { segments, radius })) + radius * 1e-6;
+                EXPECT_LE(fit_deviation(angle, radius, fit), limit) << radius << " " << feed << " " << angle;
+            }
+        }
+    }
+    // A small fast circle needs at least an eighth fewer chords
+    uint16_t segments = tolerance_segments(6.2831853f, 2.0f, tolerance);
+    ArcFit   fit      = arc_fit(6.2831853f, 2.0f, tolerance, 6000.0f * (1.0f / 6000.0f), segments);
+    EXPECT_LT(fit.segments, segments * 7 / 8);
+    EXPECT_GT(fit.radius, 2.0f);
+}
@@ -0,0 +1,36 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/string_util.h"
+
+#include <string>
+
+static std::string decode(std::string_view str, size_t max = 64) {
+    uint8_t out[64];
+    int     length = string_util::from_base64(str, out, max);
+    if (length < 0) {
+        return "<bad>";
+    }
+    return std::string(out, out + length);
+}
+
+TEST(Base64, Decode) {
+    EXPECT_EQ(decode(""), "");
+    EXPECT_EQ(decode("Zg=="), "f");
+    EXPECT_EQ(decode("Zm8="), "fo");
+    EXPECT_EQ(decode("Zm9v"), "foo");
+    EXPECT_EQ(decode("Zm9vYg"), "foob");
+    EXPECT_EQ(decode("Zm9vYmE"), "fooba");
+    EXPECT_EQ(decode("Zm9vYmFy"), "foobar");
+    EXPECT_EQ(decode("AP8="), std::string("\x00\xff", 2));
+    EXPECT_EQ(decode("+/+/"), std::string("\xfb\xff\xbf", 3));
+}
+
+TEST(Base64, Errors) {
+    EXPECT_EQ(decode("Z"), "<bad>");
+    EXPECT_EQ(decode("Zm9v!"), "<bad>");
+    EXPECT_EQ(decode("Zm 9v"), "<bad>");
+    EXPECT_EQ(decode("Zm9vYmFy", 5), "<bad>");
+    EXPECT_EQ(decode("Zm9vYmFy", 6), "foobar");
+}
@@ -0,0 +1,68 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/Configuration/ConfigCache.h"
+
+#include <string>
+
+using namespace Configuration::ConfigCache;
+
+static std::string sample(uint32_t key) {
+    Writer writer(key);
+    writer.add({ 1, 0, "name", "Test machine" });
+    writer.add({ 3, 2, "x", "" });
+    writer.add({ 4, 4, "steps_per_mm", "80.000" });
+    EXPECT_TRUE(writer.ok());
+    return writer.blob();
+}
+
+TEST(ConfigCache, RoundTrip) {
+    std::string blob = sample(1234);
+    Reader      reader(blob, 1234);
+    ASSERT_TRUE(reader.valid());
+
+    Token token;
+    ASSERT_TRUE(reader.next(token));
+    EXPECT_EQ(token.line, 1);
+    EXPECT_EQ(token.indent, 0);
+    EXPECT_EQ(token.key, "name");
+    EXPECT_EQ(token.value, "Test machine");
+    ASSERT_TRUE(reader.next(token));
+    EXPECT_EQ(token.indent, 2);
+    EXPECT_EQ(token.key, "x");
+    EXPECT_EQ(token.value, "");
+    ASSERT_TRUE(reader.next(token));
+    EXPECT_EQ(token.line, 4);
+    EXPECT_EQ(token.value, "80.000");
+    EXPECT_FALSE(reader.next(token));
+    EXPECT_TRUE(reader.valid());
+}
+
+TEST(ConfigCache, Invalid) {
+    std::string blob = sample(1234);
+    EXPECT_FALSE(Reader(blob, 4321).valid());
+    EXPECT_FALSE(Reader(blob.substr(0, blob.size() - 1), 1234).valid());
+    EXPECT_FALSE(Reader(blob.substr(0, 5), 1234).valid());
+    EXPECT_FALSE(Reader("", 1234).valid());
+
+    blob[0] = 'X';
+    EXPECT_FALSE(Reader(blob, 1234).valid());
+}
+
+TEST(ConfigCache, Limits) {
+    Writer writer(0);
+    writer.add({ 0x10000, 0, "a", "b" });
+    EXPECT_FALSE(writer.ok());
+
+    Writer longValue(0);
+    longValue.add({ 1, 0, "a", std::string(0x10000, 'v') });
+    EXPECT_FALSE(longValue.ok());
+}
+
+TEST(ConfigCache, Hash) {
+    uint32_t seed = hash("v3.9.1");
+    EXPECT_NE(hash("name: a\n", seed), hash("name: b\n", seed));
+    EXPECT_NE(hash("name: a\n", seed), hash("name: a\n", hash("v3.9.2")));
+    EXPECT_EQ(hash("name: a\n", seed), hash("name: a\n", hash("v3.9.1")));
+}
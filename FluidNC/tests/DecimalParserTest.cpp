@@ -0,0 +1,148 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/DecimalParser.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+static float parse(const char* text, size_t expected_length) {
+    size_t pos = 0;
+    float  value;
+    EXPECT_TRUE(parse_decimal(text, pos, value)) << text;
+    EXPECT_EQ(pos, expected_length) << text;
+    return value;
+}
+
+// parse_decimal() must round exactly as strtof() does, which rounds correctly.
+static void expect_exact(const char* text) {
+    size_t pos = 0;
+    float  value;
+    ASSERT_TRUE(parse_decimal(text, pos, value)) << text;
+    ASSERT_EQ(pos, strlen(text)) << text;
+    ASSERT_EQ(value, strtof(text, nullptr)) << text;
+}
+
+TEST(DecimalParser, Forms) {
+    EXPECT_EQ(parse("0", 1), 0.0f);
+    EXPECT_EQ(parse("12", 2), 12.0f);
+    EXPECT_EQ(parse("-12.5", 5), -12.5f);
+    EXPECT_EQ(parse("+.5", 3), 0.5f);
+    EXPECT_EQ(parse("7.", 2), 7.0f);
+    EXPECT_EQ(parse("007.250", 7), 7.25f);
+    EXPECT_EQ(parse("-0.000", 6), 0.0f);
+    EXPECT_EQ(parse("1.5Y2", 3), 1.5f);
+    EXPECT_EQ(parse("1.2.3", 3), 1.2f);  // A second point ends the number
+    EXPECT_EQ(parse("1E3", 1), 1.0f);    // E is a word letter, not an exponent
+}
+
+TEST(DecimalParser, NoDigits) {
+    for (const char* text : { "", "-", "+", ".", "-.", "X1" }) {
+        size_t pos   = 0;
+        float  value = 42.0f;
+        EXPECT_FALSE(parse_decimal(text, pos, value)) << text;
+        EXPECT_EQ(pos, 0u) << text;
+        EXPECT_EQ(value, 42.0f) << text;
+    }
+}
+
+TEST(DecimalParser, StartsAtPos) {
+    size_t pos = 1;
+    float  value;
+    EXPECT_TRUE(parse_decimal("X-3.25Y", pos, value));
+    EXPECT_EQ(value, -3.25f);
+    EXPECT_EQ(pos, 6u);
+}
+
+TEST(DecimalParser, HardCases) {
+    // Values whose nearest float is hard to reach with repeated scaling
+    for (const char* text : { "0.1", "0.3", "0.7", "1.1", "16777217", "16777216.5", "3.4028234", "0.0001", "0.00001234", "123456.7",
+                              "9999999", "0.1000000", "25.4", "1.0000001", "340282350000000000000000000000000000000" }) {
+        expect_exact(text);
+    }
+}
+
+TEST(DecimalParser, GCodeRange) {
+    // A sample of the values with up to 7 significant digits and up to 4 decimals
+    for (int decimals = 0; decimals <= 4; decimals++) {
+        for (uint32_t m = 0; m < 10000000; m += 997) {
+            std::string text = std::to_string(m);
+            if (decimals) {
+                while (int(text.size()) <= decimals) {
+                    text.insert(0, "0");
+                }
+                text.insert(text.size() - decimals, ".");
+            }
+            expect_exact(text.c_str());
+        }
+    }
+}
+
+TEST(DecimalParser, Random) {
+    std::mt19937_64                    rng(1234);
+    std::uniform_int_distribution<int> digit(0, 9);
+    std::uniform_int_distribution<int> length(1, 24);
+    for (int i = 0; i < 200000; i++) {
+        std::string text = (i & 1) ? "-" : "";
+        int         n    = length(rng);
+        int         dot  = std::uniform_int_distribution<int>(0, n)(rng);
+        for (int k = 0; k < n; k++) {
+            if (k == dot) {
+                text += '.';
+            }
+            text += char('0' + digit(rng));
+        }
+        size_t pos = 0;
+        float  value;
+        ASSERT_TRUE(parse_decimal(text.c_str(), pos, value)) << text;
+        float expected = strtof(text.c_str(), nullptr);
+        if (n - (text[0] == '-') <= 15) {
+            // Exact in double before the single rounding, which can only differ at a tie
+            ASSERT_NEAR(value, expected, std::abs(expected) * 1.2e-7f) << text;
+        } else {
+            ASSERT_NEAR(value, expected, std::abs(expected) * 2.4e-7f) << text;
+        }
+    }
+}
+
+// Not a check, but reports the conversion rate for typical G-code numbers.
+TEST(DecimalParser, Throughput) {
+    std::vector<std::string> numbers;
+    std::mt19937             rng(42);
+    char                     text[16];
+    for (int i = 0; i < 1000; i++) {
+        snprintf(text, sizeof(text), "%.3f", std::uniform_real_distribution<float>(-500.0f, 500.0f)(rng));
+        numbers.push_back(text);
+    }
+    const int rounds = 2000;
+
+    auto   start = std::chrono::steady_clock::now();
+    double sum   = 0;
+    for (int r = 0; r < rounds; r++) {
+        for (auto& number : numbers) {
+            size_t pos = 0;
+            float  value;
+            parse_decimal(number.c_str(), pos, value);
+            sum += value;
+        }
+    }
+    auto mid = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (auto& number : numbers) {
+            sum -= strtof(number.c_str(), nullptr);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double count    = double(rounds) * numbers.size();
+    double parse_s  = std::chrono::duration<double>(mid - start).count();
+    double strtof_s = std::chrono::duration<double>(end - mid).count();
+    printf("parse_decimal: %.1f M numbers/s, strtof: %.1f M numbers/s\n", count / parse_s / 1e6, count / strtof_s / 1e6);
+    EXPECT_NEAR(sum, 0.0, 1.0);
+}
@@ -0,0 +1,51 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/FlatMap.h"
+
+#include <string_view>
+
+enum class Color { Red = 3, Green = 1, Blue = 7 };
+
+static constexpr auto color_table = sorted_table<Color, const char*>({
+    { Color::Red, "red" },
+    { Color::Green, "green" },
+    { Color::Blue, "blue" },
+});
+static const FlatMap<Color, const char*> ColorNames(color_table);
+
+static constexpr auto word_table = sorted_table<std::string_view, int>({
+    { "IF", 1 },
+    { "ELSE", 2 },
+    { "ENDIF", 3 },
+    { "DO", 4 },
+});
+static constexpr FlatMap<std::string_view, int> Words(word_table);
+
+static_assert(Words.find(std::string_view("DO"))->second == 4, "find is constexpr");
+
+TEST(FlatMap, EnumKeys) {
+    ASSERT_EQ(ColorNames.size(), 3u);
+    EXPECT_STREQ(ColorNames.find(Color::Red)->second, "red");
+    EXPECT_STREQ(ColorNames.find(Color::Blue)->second, "blue");
+    EXPECT_EQ(ColorNames.find(Color(5)), ColorNames.end());
+}
+
+TEST(FlatMap, Iteration) {
+    // In key order, as with std::map
+    auto it = ColorNames.begin();
+    EXPECT_EQ(it++->first, Color::Green);
+    EXPECT_EQ(it++->first, Color::Red);
+    EXPECT_EQ(it++->first, Color::Blue);
+    EXPECT_EQ(it, ColorNames.end());
+}
+
+TEST(FlatMap, StringKeys) {
+    EXPECT_EQ(Words.find(std::string_view("IF"))->second, 1);
+    EXPECT_EQ(Words.find(std::string_view("ENDIF"))->second, 3);
+    EXPECT_EQ(Words.find(std::string_view("ELSE"))->second, 2);
+    EXPECT_EQ(Words.find(std::string_view("END")), Words.end());
+    EXPECT_EQ(Words.find(std::string_view("")), Words.end());
+    EXPECT_EQ(Words.find(std::string_view("ZZZ")), Words.end());
+}
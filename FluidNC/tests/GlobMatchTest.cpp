@@ -0,0 +1,45 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/string_util.h"
+
+#include <string>
+
+using string_util::glob_match;
+
+TEST(GlobMatch, Literal) {
+    EXPECT_TRUE(glob_match("", ""));
+    EXPECT_TRUE(glob_match("part.nc", "part.nc"));
+    EXPECT_FALSE(glob_match("part.nc", "part.ncc"));
+    EXPECT_FALSE(glob_match("part.nc", "apart.nc"));
+    EXPECT_FALSE(glob_match("", "x"));
+}
+
+TEST(GlobMatch, Wildcards) {
+    EXPECT_TRUE(glob_match("*", ""));
+    EXPECT_TRUE(glob_match("*", "anything"));
+    EXPECT_TRUE(glob_match("*.nc", "part.nc"));
+    EXPECT_TRUE(glob_match("*.nc", ".nc"));
+    EXPECT_FALSE(glob_match("*.nc", "part.ngc"));
+    EXPECT_TRUE(glob_match("part?.nc", "part1.nc"));
+    EXPECT_FALSE(glob_match("part?.nc", "part.nc"));
+    EXPECT_TRUE(glob_match("*a*b*c", "xxaxbxxbcxc"));
+    EXPECT_FALSE(glob_match("*a*b*c", "xxaxbxxbcx"));
+    EXPECT_TRUE(glob_match("**.g*", "tool.gcode"));
+    EXPECT_TRUE(glob_match("*?", "x"));
+    EXPECT_FALSE(glob_match("*?", ""));
+}
+
+TEST(GlobMatch, Case) {
+    EXPECT_TRUE(glob_match("*.NC", "part.nc"));
+    EXPECT_FALSE(glob_match("*.NC", "part.nc", true));
+    EXPECT_TRUE(glob_match("Part*", "Part.nc", true));
+}
+
+TEST(GlobMatch, LongBacktrack) {
+    std::string text(2000, 'a');
+    EXPECT_FALSE(glob_match("*a*a*a*a*a*b", text));
+    text += 'b';
+    EXPECT_TRUE(glob_match("*a*a*a*a*a*b", text));
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/HeapTag.h"
+
+#include <cstring>
+
+static HeapTag first_tag("First");
+static HeapTag second_tag("Second");
+
+TEST(HeapTag, Counts) {
+    HeapTag& tag = first_tag;
+    char     a[16];
+    char     b[32];
+
+    EXPECT_EQ(tag.allocated(a, sizeof(a)), a);
+    EXPECT_EQ(tag.allocated(b, sizeof(b)), b);
+    EXPECT_EQ(tag.bytes(), 48u);
+    EXPECT_EQ(tag.in_use(), 2u);
+
+    tag.freed(a, sizeof(a));
+    EXPECT_EQ(tag.bytes(), 32u);
+    EXPECT_EQ(tag.peak(), 48u);
+    EXPECT_EQ(tag.allocs(), 2u);
+    EXPECT_EQ(tag.frees(), 1u);
+
+    tag.freed(b, sizeof(b));
+    EXPECT_EQ(tag.bytes(), 0u);
+    EXPECT_EQ(tag.in_use(), 0u);
+    EXPECT_EQ(tag.peak(), 48u);
+}
+
+TEST(HeapTag, FailedAllocation) {
+    HeapTag& tag = second_tag;
+    char*    p   = nullptr;
+
+    EXPECT_EQ(tag.allocated(p, 100), nullptr);
+    tag.freed(p, 100);
+    EXPECT_EQ(tag.allocs(), 0u);
+    EXPECT_EQ(tag.frees(), 0u);
+    EXPECT_EQ(tag.bytes(), 0u);
+}
+
+TEST(HeapTag, List) {
+    bool first  = false;
+    bool second = false;
+    for (auto tag = HeapTag::first(); tag; tag = tag->next()) {
+        first |= strcmp(tag->name(), "First") == 0;
+        second |= strcmp(tag->name(), "Second") == 0;
+    }
+    EXPECT_TRUE(first);
+    EXPECT_TRUE(second);
+}
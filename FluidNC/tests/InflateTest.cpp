@@ -0,0 +1,202 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/Inflate.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Made with Python's zlib.compressobj(level, DEFLATED, 31, 8, strategy) from G-code lines:
+// dynamic_gz at level 9, fixed_gz with Z_FIXED, stored_gz at level 0
+static const uint8_t dynamic_gz[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xed, 0xd4, 0xb1, 0x51, 0x00, 0x31,
+    0x0c, 0x44, 0xd1, 0x9c, 0x62, 0x6e, 0x2c, 0x59, 0x12, 0x50, 0x01, 0x2d, 0x70, 0xfd, 0x37, 0xc2,
+    0xf8, 0x6e, 0x76, 0x2b, 0x20, 0xfc, 0x99, 0x12, 0xaf, 0x5f, 0xf4, 0x7f, 0xe2, 0x77, 0x5d, 0xeb,
+    0x5e, 0x1f, 0x3f, 0xf1, 0x1b, 0x57, 0xdc, 0x71, 0x8e, 0xbc, 0xf2, 0xce, 0x73, 0xec, 0x6b, 0xdf,
+    0xfb, 0x1c, 0x75, 0xd5, 0x5d, 0xe7, 0xe8, 0xab, 0xef, 0x3e, 0xc7, 0x5c, 0x73, 0xcf, 0x39, 0x3e,
+    0xaf, 0xcf, 0xf7, 0xf9, 0xd7, 0xf5, 0xf5, 0x3e, 0xff, 0xbe, 0xbe, 0xdf, 0xe7, 0x71, 0xa6, 0x9f,
+    0xf7, 0x71, 0xb6, 0x9f, 0x81, 0x38, 0xe3, 0xcf, 0x42, 0x9c, 0xf5, 0x67, 0x22, 0xce, 0xfc, 0x4b,
+    0x38, 0xfb, 0xcf, 0x48, 0x9c, 0x0f, 0xde, 0x95, 0xf3, 0xc3, 0xbb, 0x72, 0xbe, 0x78, 0x57, 0xce,
+    0x1f, 0xcf, 0xca, 0xf9, 0x62, 0xa4, 0x5f, 0xd2, 0x87, 0xf4, 0x29, 0xfd, 0x96, 0xbe, 0xa4, 0x6f,
+    0xe9, 0x47, 0xfa, 0x25, 0x7d, 0x58, 0x9f, 0xd6, 0x6f, 0xeb, 0xcb, 0xfa, 0xb6, 0x7e, 0xac, 0x5f,
+    0xd6, 0x87, 0xf5, 0x69, 0xfd, 0xb6, 0xbe, 0xa4, 0x6f, 0xe9, 0x47, 0xfa, 0x25, 0x7d, 0x48, 0x9f,
+    0xd2, 0x6f, 0xe9, 0x4b, 0xfa, 0x96, 0x7e, 0xa4, 0x5f, 0xd6, 0x87, 0xf5, 0x69, 0xfd, 0xb6, 0xbe,
+    0xac, 0x6f, 0xeb, 0xc7, 0xfa, 0x65, 0x7d, 0x58, 0x9f, 0xd6, 0x6f, 0xe9, 0x4b, 0xfa, 0x96, 0x7e,
+    0xa4, 0x5f, 0xd2, 0x87, 0xf4, 0x29, 0xfd, 0x96, 0xbe, 0xa4, 0x6f, 0xe9, 0xc7, 0xfa, 0x65, 0x7d,
+    0x58, 0x9f, 0xd6, 0x6f, 0xeb, 0xcb, 0xfa, 0xb6, 0x7e, 0xac, 0x5f, 0xd6, 0x87, 0xf5, 0x29, 0xfd,
+    0x96, 0xbe, 0xa4, 0x6f, 0xe9, 0x47, 0xfa, 0x25, 0x7d, 0x48, 0x9f, 0xd2, 0x6f, 0xe9, 0x4b, 0xfa,
+    0xb6, 0x7e, 0xac, 0x5f, 0xd6, 0x87, 0xf5, 0x69, 0xfd, 0xb6, 0xbe, 0xac, 0x6f, 0xeb, 0xc7, 0xfa,
+    0x65, 0x7d, 0x48, 0x9f, 0xd2, 0x6f, 0xe9, 0x4b, 0xfa, 0x96, 0x7e, 0xa4, 0x5f, 0xd2, 0x87, 0xf4,
+    0x29, 0xfd, 0x96, 0xbe, 0xac, 0x6f, 0xeb, 0xc7, 0xfa, 0x65, 0x7d, 0x58, 0x9f, 0xd6, 0x6f, 0xeb,
+    0xcb, 0xfa, 0xb6, 0x7e, 0xac, 0x5f, 0xd2, 0x87, 0xf4, 0x29, 0xfd, 0x96, 0xbe, 0xa4, 0x6f, 0xe9,
+    0x47, 0xfa, 0x25, 0x7d, 0x48, 0x9f, 0xd2, 0x6f, 0xeb, 0xcb, 0xfa, 0xb6, 0x7e, 0xac, 0x5f, 0xd6,
+    0x87, 0xf5, 0x69, 0xfd, 0xb6, 0xbe, 0xac, 0x6f, 0xeb, 0x47, 0x7a, 0x8a, 0x49, 0x31, 0x29, 0x26,
+    0xc5, 0xa4, 0x98, 0x14, 0x93, 0x62, 0x52, 0x4c, 0x8a, 0x49, 0x31, 0x29, 0x26, 0xc5, 0xa4, 0x98,
+    0x14, 0x93, 0x62, 0x52, 0x4c, 0x8a, 0x49, 0x31, 0x29, 0x26, 0xc5, 0xa4, 0x98, 0x14, 0x93, 0x62,
+    0x52, 0x4c, 0x8a, 0x49, 0x31, 0x29, 0x26, 0xc5, 0xa4, 0x98, 0x14, 0x93, 0x62, 0x52, 0x4c, 0x8a,
+    0x49, 0x31, 0x29, 0x26, 0xc5, 0xa4, 0x98, 0x14, 0x93, 0x62, 0x52, 0x4c, 0x8a, 0x49, 0x31, 0x29,
+    0x26, 0xc5, 0xa4, 0x98, 0x14, 0x93, 0x62, 0x52, 0x4c, 0x8a, 0x49, 0x31, 0x29, 0x26, 0xc5, 0xa4,
+    0x98, 0x14, 0x93, 0x62, 0x52, 0x4c, 0x8a, 0x49, 0x31, 0x29, 0x26, 0xc5, 0xa4, 0x98, 0x14, 0x93,
+    0x62, 0x52, 0x4c, 0x8a, 0x49, 0x31, 0x29, 0x26, 0xc5, 0xa4, 0x98, 0x14, 0x93, 0x62, 0x52, 0x4c,
+    0x8a, 0x49, 0x31, 0x29, 0x26, 0xc5, 0xa4, 0x98, 0x14, 0x93, 0x62, 0x52, 0x4c, 0x8a, 0x49, 0x31,
+    0x29, 0x26, 0xc5, 0xa4, 0x98, 0x14, 0x93, 0x62, 0x52, 0x4c, 0x8a, 0x49, 0x31, 0x29, 0x26, 0xc5,
+    0xa4, 0x98, 0x14, 0x93, 0x62, 0x52, 0x4c, 0x8a, 0x49, 0x31, 0x29, 0x26, 0xc5, 0xa4, 0x98, 0x14,
+    0x93, 0x62, 0x52, 0x4c, 0x8a, 0xf9, 0x6f, 0xc5, 0xfc, 0x03, 0x85, 0x54, 0x8e, 0x6d, 0x54, 0x6f,
+    0x00, 0x00,
+};
+
+static const uint8_t fixed_gz[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x03, 0x73, 0x37, 0x8c, 0x30, 0xd0, 0x33,
+    0x88, 0x34, 0xe0, 0x72, 0x37, 0x8c, 0x30, 0xd4, 0x33, 0x8c, 0x34, 0x04, 0x31, 0x8c, 0xf4, 0x8c,
+    0x22, 0x8d, 0x40, 0x0c, 0x63, 0x3d, 0xe3, 0x48, 0x63, 0x10, 0xc3, 0x44, 0xcf, 0x24, 0xd2, 0x04,
+    0xc4, 0x30, 0xd5, 0x33, 0x8d, 0x34, 0x05, 0x31, 0xcc, 0xf4, 0xcc, 0x22, 0xcd, 0x40, 0x0c, 0x73,
+    0x3d, 0x73, 0x88, 0x76, 0x0b, 0x3d, 0x0b, 0x88, 0x76, 0x4b, 0x3d, 0x4b, 0x88, 0x76, 0x43, 0x90,
+    0xd1, 0x60, 0xfd, 0x86, 0x20, 0xb3, 0xc1, 0x06, 0x18, 0x82, 0x0c, 0x07, 0x9b, 0x60, 0x08, 0x32,
+    0x1d, 0x6c, 0x84, 0x21, 0xc8, 0x78, 0x88, 0x13, 0x40, 0xe6, 0x83, 0x0d, 0x31, 0x04, 0x59, 0x00,
+    0x31, 0x05, 0x64, 0x03, 0xc4, 0x14, 0x90, 0x15, 0x10, 0x53, 0x40, 0x76, 0x80, 0x4d, 0x01, 0x59,
+    0x61, 0x06, 0x73, 0xbd, 0x01, 0xcc, 0xf5, 0x86, 0x30, 0xd7, 0x1b, 0xc1, 0x5c, 0x6f, 0x0c, 0x73,
+    0xbd, 0x09, 0xcc, 0xf5, 0xa6, 0x30, 0xd7, 0x9b, 0xc1, 0x5c, 0x6f, 0x00, 0x73, 0xbd, 0x21, 0xdc,
+    0xf5, 0x46, 0x70, 0xd7, 0x1b, 0xc3, 0x5d, 0x6f, 0x02, 0x77, 0xbd, 0x29, 0xdc, 0xf5, 0x66, 0x70,
+    0xd7, 0x1b, 0xc0, 0x5d, 0x6f, 0x08, 0x77, 0xbd, 0x11, 0xdc, 0xf5, 0xc6, 0x70, 0xd7, 0x9b, 0xc0,
+    0x5c, 0x6f, 0x0a, 0x73, 0xbd, 0x19, 0xcc, 0xf5, 0x06, 0x30, 0xd7, 0x1b, 0xc2, 0x5c, 0x6f, 0x04,
+    0x73, 0xbd, 0x31, 0xcc, 0xf5, 0x26, 0x30, 0xd7, 0x9b, 0xc2, 0x5c, 0x6f, 0x06, 0x73, 0xbd, 0x01,
+    0xdc, 0xf5, 0x86, 0x70, 0xd7, 0x1b, 0xc1, 0x5d, 0x6f, 0x0c, 0x77, 0xbd, 0x09, 0xdc, 0xf5, 0xa6,
+    0x70, 0xd7, 0x9b, 0xc1, 0x5d, 0x6f, 0x00, 0x77, 0xbd, 0x21, 0xdc, 0xf5, 0x46, 0x70, 0xd7, 0x1b,
+    0xc3, 0x5c, 0x6f, 0x02, 0x73, 0xbd, 0x29, 0xcc, 0xf5, 0x66, 0x30, 0xd7, 0x1b, 0xc0, 0x5c, 0x6f,
+    0x08, 0x73, 0xbd, 0x11, 0xcc, 0xf5, 0xc6, 0x30, 0xd7, 0x9b, 0xc0, 0x5c, 0x6f, 0x0a, 0x73, 0xbd,
+    0x19, 0xdc, 0xf5, 0x06, 0x70, 0xd7, 0x1b, 0xc2, 0x5d, 0x6f, 0x04, 0x77, 0xbd, 0x31, 0xdc, 0xf5,
+    0x26, 0x70, 0xd7, 0x9b, 0xc2, 0x5d, 0x6f, 0x06, 0x77, 0xbd, 0x01, 0xdc, 0xf5, 0x86, 0x70, 0xd7,
+    0x1b, 0xc1, 0x5c, 0x6f, 0x0c, 0x73, 0xbd, 0x09, 0xcc, 0xf5, 0xa6, 0x30, 0xd7, 0x9b, 0xc1, 0x5c,
+    0x6f, 0x00, 0x73, 0xbd, 0x21, 0xcc, 0xf5, 0x46, 0x30, 0xd7, 0x1b, 0xc3, 0x5c, 0x6f, 0x02, 0x73,
+    0xbd, 0x29, 0xdc, 0xf5, 0x66, 0x70, 0xd7, 0x1b, 0xc0, 0x5d, 0x6f, 0x08, 0x77, 0xbd, 0x11, 0xdc,
+    0xf5, 0xc6, 0x70, 0xd7, 0x9b, 0xc0, 0x5d, 0x6f, 0x0a, 0x77, 0xbd, 0x19, 0xdc, 0xf5, 0x06, 0x70,
+    0xd7, 0x1b, 0xc2, 0x5c, 0x6f, 0x04, 0x73, 0xbd, 0x31, 0xcc, 0xf5, 0x26, 0x30, 0xd7, 0x9b, 0xc2,
+    0x5c, 0x6f, 0x06, 0x73, 0xbd, 0x01, 0xcc, 0xf5, 0x86, 0x30, 0xd7, 0x1b, 0xc1, 0x5c, 0x6f, 0x0c,
+    0x73, 0xbd, 0x09, 0xdc, 0xf5, 0xa6, 0x70, 0xd7, 0x9b, 0xc1, 0x5d, 0x6f, 0x00, 0x77, 0xbd, 0x21,
+    0xdc, 0xf5, 0x46, 0x70, 0xd7, 0x1b, 0xc3, 0x5d, 0x6f, 0x02, 0x77, 0xbd, 0x29, 0xdc, 0xf5, 0x66,
+    0x70, 0xd7, 0x1b, 0xc0, 0x5c, 0x6f, 0x08, 0x73, 0xbd, 0x11, 0xcc, 0xf5, 0xc6, 0x30, 0xd7, 0x9b,
+    0xc0, 0x5c, 0x6f, 0x0a, 0x73, 0xbd, 0x19, 0xcc, 0xf5, 0x06, 0x30, 0xd7, 0x1b, 0xc2, 0x5c, 0x6f,
+    0x04, 0x73, 0xbd, 0x31, 0xdc, 0xf5, 0x26, 0x70, 0xd7, 0x9b, 0xc2, 0x5d, 0x6f, 0x06, 0x77, 0xbd,
+    0x01, 0xdc, 0xf5, 0x86, 0x70, 0xd7, 0x1b, 0xc1, 0x5d, 0x6f, 0x0c, 0x77, 0xbd, 0x09, 0xdc, 0xf5,
+    0xa6, 0x70, 0xd7, 0x9b, 0xc1, 0x5c, 0x3f, 0x5a, 0x62, 0x8e, 0x96, 0x98, 0xa3, 0x25, 0xe6, 0x68,
+    0x89, 0x09, 0x77, 0xfd, 0x68, 0x89, 0x39, 0x5a, 0x62, 0xc2, 0x5c, 0x3f, 0x5a, 0x62, 0xc2, 0x5c,
+    0x3f, 0x5a, 0x62, 0x8e, 0x96, 0x98, 0xa3, 0x25, 0xe6, 0x68, 0x89, 0x39, 0x5a, 0x62, 0x8e, 0x96,
+    0x98, 0xa3, 0x25, 0xe6, 0x68, 0x89, 0x39, 0x5a, 0x62, 0xc2, 0x5c, 0x3f, 0x5a, 0x62, 0x8e, 0x96,
+    0x98, 0xa3, 0x25, 0xe6, 0x68, 0x89, 0x39, 0x5a, 0x62, 0x8e, 0x96, 0x98, 0xa3, 0x25, 0xe6, 0x68,
+    0x89, 0x39, 0x5a, 0x62, 0x8e, 0x96, 0x98, 0xa3, 0x25, 0xe6, 0x68, 0x89, 0x09, 0x73, 0xfd, 0x68,
+    0x89, 0x09, 0x73, 0xfd, 0x68, 0x89, 0x39, 0x5a, 0x62, 0x8e, 0x96, 0x98, 0xa3, 0x25, 0xe6, 0x68,
+    0x89, 0x39, 0x5a, 0x62, 0x8e, 0x96, 0x98, 0xa3, 0x25, 0xe6, 0x68, 0x89, 0x09, 0x73, 0xfd, 0x68,
+    0x89, 0x39, 0x5a, 0x62, 0x8e, 0x96, 0x98, 0xa3, 0x25, 0xe6, 0x68, 0x89, 0x39, 0x5a, 0x62, 0x8e,
+    0x96, 0x98, 0xa3, 0x25, 0xe6, 0x68, 0x89, 0x39, 0x5a, 0x62, 0x8e, 0x96, 0x98, 0xa3, 0x25, 0x26,
+    0xcc, 0xf5, 0xa3, 0x25, 0x26, 0xcc, 0xf5, 0xa3, 0x25, 0xe6, 0x68, 0x89, 0x39, 0x5a, 0x62, 0x8e,
+    0x96, 0x98, 0xa3, 0x25, 0xe6, 0x68, 0x89, 0x39, 0x5a, 0x62, 0x8e, 0x96, 0x98, 0xa3, 0x25, 0x26,
+    0xcc, 0xf5, 0xa3, 0x25, 0xe6, 0x68, 0x89, 0x39, 0x5a, 0x62, 0x8e, 0x96, 0x98, 0xa3, 0x25, 0xe6,
+    0x68, 0x89, 0x39, 0x5a, 0x62, 0x8e, 0x96, 0x98, 0xa3, 0x25, 0xe6, 0x68, 0x89, 0x39, 0x5a, 0x62,
+    0x8e, 0x96, 0x98, 0x30, 0xd7, 0x8f, 0x96, 0x98, 0x30, 0xd7, 0x8f, 0x96, 0x98, 0xa3, 0x25, 0xe6,
+    0x68, 0x89, 0x39, 0x5a, 0x62, 0x8e, 0x96, 0x98, 0xa3, 0x25, 0xe6, 0x68, 0x89, 0x39, 0x5a, 0x62,
+    0x8e, 0x96, 0x98, 0x30, 0xd7, 0x8f, 0x96, 0x98, 0xa3, 0x25, 0xe6, 0x68, 0x89, 0x39, 0x5a, 0x62,
+    0x8e, 0x96, 0x98, 0xa3, 0x25, 0xe6, 0x68, 0x89, 0x39, 0x5a, 0x62, 0x8e, 0x96, 0x98, 0xa3, 0x25,
+    0xe6, 0x68, 0x89, 0x39, 0x5a, 0x62, 0xc2, 0x5c, 0x3f, 0x5a, 0x62, 0xc2, 0x5c, 0x3f, 0x5a, 0x62,
+    0x8e, 0x96, 0x98, 0xa3, 0x25, 0xe6, 0x68, 0x89, 0x39, 0x5a, 0x62, 0x8e, 0x96, 0x98, 0xa3, 0x25,
+    0xe6, 0x68, 0x89, 0x39, 0x5a, 0x62, 0xc2, 0x5c, 0x3f, 0x7c, 0x4a, 0x4c, 0x00, 0x85, 0x54, 0x8e,
+    0x6d, 0x54, 0x6f, 0x00, 0x00,
+};
+
+static const uint8_t stored_gz[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x03, 0x01, 0x0d, 0x00, 0xf2, 0xff, 0x47,
+    0x30, 0x58, 0x31, 0x0a, 0x28, 0x68, 0x65, 0x6c, 0x6c, 0x6f, 0x29, 0x0a, 0x1b, 0x75, 0x18, 0x0b,
+    0x0d, 0x00, 0x00, 0x00,
+};
+
+static std::string gcode_text() {
+    std::string text;
+    char        line[32];
+    for (int i = 0; i < 3000; i++) {
+        snprintf(line, sizeof(line), "G1X%d.%dY%d\n", i % 20, i % 10, i % 7);
+        text += line;
+    }
+    return text;
+}
+
+struct Input {
+    std::vector<uint8_t> data;
+    size_t               pos   = 0;
+    size_t               chunk = 1000;
+};
+
+static size_t input_read(void* arg, uint8_t* buffer, size_t length) {
+    auto*  in = static_cast<Input*>(arg);
+    size_t n  = std::min({ length, in->chunk, in->data.size() - in->pos });
+    memcpy(buffer, in->data.data() + in->pos, n);
+    in->pos += n;
+    return n;
+}
+
+static uint8_t window[Inflater::window_size];
+
+static std::string inflate(Input& in, size_t out_chunk, bool* failed = nullptr) {
+    Inflater    inflater(input_read, &in, window);
+    std::string result;
+    uint8_t     buffer[512];
+    while (size_t n = inflater.read(buffer, std::min(out_chunk, sizeof(buffer)))) {
+        result.append(reinterpret_cast<char*>(buffer), n);
+    }
+    if (failed) {
+        *failed = inflater.failed();
+    } else {
+        EXPECT_TRUE(inflater.done());
+    }
+    return result;
+}
+
+template <size_t N>
+static Input input(const uint8_t (&data)[N], size_t chunk = 1000) {
+    Input in;
+    in.data.assign(data, data + N);
+    in.chunk = chunk;
+    return in;
+}
+
+TEST(Inflate, Dynamic) {
+    for (size_t chunk : { 1, 7, 1000 }) {
+        Input in = input(dynamic_gz, chunk);
+        EXPECT_EQ(inflate(in, 37), gcode_text());
+    }
+}
+
+TEST(Inflate, Fixed) {
+    Input in = input(fixed_gz);
+    EXPECT_EQ(inflate(in, 1), gcode_text());
+}
+
+TEST(Inflate, Stored) {
+    Input in = input(stored_gz);
+    EXPECT_EQ(inflate(in, 512), "G0X1\n(hello)\n");
+}
+
+TEST(Inflate, Members) {
+    Input in = input(stored_gz);
+    in.data.insert(in.data.end(), std::begin(dynamic_gz), std::end(dynamic_gz));
+    EXPECT_EQ(inflate(in, 100), "G0X1\n(hello)\n" + gcode_text());
+}
+
+TEST(Inflate, Corrupt) {
+    bool  failed;
+    Input in = input(dynamic_gz);
+    in.data[200] ^= 0x10;
+    inflate(in, 512, &failed);
+    EXPECT_TRUE(failed);
+
+    in = input(dynamic_gz);
+    in.data.resize(in.data.size() - 3);  // Truncated trailer
+    inflate(in, 512, &failed);
+    EXPECT_TRUE(failed);
+
+    in         = input(stored_gz);
+    in.data[0] = 'G';  // Not gzip
+    EXPECT_EQ(inflate(in, 512, &failed), "");
+    EXPECT_TRUE(failed);
+}
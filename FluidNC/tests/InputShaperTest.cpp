@@ -0,0 +1,102 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/InputShaper.h"
+
+static const uint32_t ticks_per_second = 20000000;
+
+TEST(InputShaper, AmplitudesSumToOne) {
+    for (int type : { SHAPER_ZV, SHAPER_ZVD, SHAPER_MZV }) {
+        ShaperImpulses impulses;
+        shaper_impulses(type, 40.0f, 0.1f, ticks_per_second, impulses);
+        float sum = 0.0f;
+        for (int i = 0; i < impulses.count; i++) {
+            EXPECT_GT(impulses.amplitude[i], 0.0f);
+            sum += impulses.amplitude[i];
+        }
+        EXPECT_NEAR(sum, 1.0f, 1e-6f);
+        EXPECT_EQ(impulses.delay[0], 0u);
+    }
+}
+
+TEST(InputShaper, NoneIsIdentity) {
+    ShaperImpulses impulses;
+    shaper_impulses(SHAPER_NONE, 40.0f, 0.1f, ticks_per_second, impulses);
+    EXPECT_EQ(impulses.count, 1);
+    EXPECT_EQ(impulses.amplitude[0], 1.0f);
+}
+
+TEST(InputShaper, UndampedZV) {
+    // Two equal impulses half a period apart.
+    ShaperImpulses impulses;
+    shaper_impulses(SHAPER_ZV, 50.0f, 0.0f, ticks_per_second, impulses);
+    ASSERT_EQ(impulses.count, 2);
+    EXPECT_NEAR(impulses.amplitude[0], 0.5f, 1e-6f);
+    EXPECT_NEAR(impulses.amplitude[1], 0.5f, 1e-6f);
+    EXPECT_EQ(impulses.delay[1], ticks_per_second / 100);
+}
+
+TEST(InputShaper, CancelsRinging) {
+    // The residual vibration of an undamped oscillator after each shaper is zero at its frequency.
+    const float pi = 3.14159265f;
+    float       f  = 40.0f;
+    for (int type : { SHAPER_ZV, SHAPER_ZVD, SHAPER_MZV }) {
+        ShaperImpulses impulses;
+        shaper_impulses(type, f, 0.0f, ticks_per_second, impulses);
+        float c = 0.0f, s = 0.0f;
+        for (int i = 0; i < impulses.count; i++) {
+            float t = float(impulses.delay[i]) / ticks_per_second;
+            c += impulses.amplitude[i] * cosf(2 * pi * f * t);
+            s += impulses.amplitude[i] * sinf(2 * pi * f * t);
+        }
+        EXPECT_NEAR(sqrtf(c * c + s * s), 0.0f, 1e-3f) << "shaper " << type;
+    }
+}
+
+TEST(InputShaper, HistoryInterpolates) {
+    ShaperHistory<8, 2> history;
+    float               position[2] = { 0.0f, 10.0f };
+    history.reset(0, position, 2);
+    position[0] = 100.0f;
+    history.push(1000, position);
+    position[0] = 100.0f;
+    history.push(1000, position);
+
+    EXPECT_EQ(history.now(), 2000u);
+    EXPECT_FLOAT_EQ(history.sample(0, 0), 100.0f);
+    EXPECT_FLOAT_EQ(history.sample(0, 1000), 100.0f);
+    EXPECT_FLOAT_EQ(history.sample(0, 1500), 50.0f);
+    EXPECT_FLOAT_EQ(history.sample(0, 5000), 0.0f);  // Older than the history
+    EXPECT_FLOAT_EQ(history.sample(1, 1500), 10.0f);
+}
+
+TEST(InputShaper, StepResponseSettles) {
+    // A step move through a ZV shaper reaches the target after the last delay, and is the
+    // weighted sum of the impulses before that.
+    ShaperImpulses impulses;
+    shaper_impulses(SHAPER_ZV, 50.0f, 0.0f, ticks_per_second, impulses);
+
+    ShaperHistory<64, 1> history;
+    float                position = 0.0f;
+    history.reset(0, &position, 1);
+    position = 1000.0f;
+    history.push(1, &position);
+    history.push(impulses.delay[1] / 2, &position);
+    EXPECT_NEAR(history.shaped(0, impulses), 500.0f, 0.01f);
+    history.push(impulses.delay[1], &position);
+    EXPECT_FLOAT_EQ(history.shaped(0, impulses), 1000.0f);
+}
+
+TEST(InputShaper, HistoryWraps) {
+    ShaperHistory<4, 1> history;
+    float               position = 0.0f;
+    history.reset(0xfffff000, &position, 1);
+    for (int i = 1; i <= 10; i++) {
+        position = float(i);
+        history.push(0x800, &position);
+    }
+    EXPECT_FLOAT_EQ(history.sample(0, 0x400), 9.5f);
+    EXPECT_FLOAT_EQ(history.sample(0, 0x1800), 7.0f);
+    EXPECT_FLOAT_EQ(history.sample(0, 0x10000), 7.0f);  // Oldest retained sample
+}
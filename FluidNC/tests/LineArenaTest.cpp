@@ -0,0 +1,52 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/LineArena.h"
+
+#include <cstdint>
+#include <vector>
+
+TEST(LineArena, BumpAndReset) {
+    StaticArena<64> arena;
+
+    void* a = arena.allocate(3, 1);
+    void* b = arena.allocate(8, 8);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % 8, 0u);
+    EXPECT_EQ(arena.used(), 16u);
+    EXPECT_TRUE(arena.owns(a));
+
+    EXPECT_EQ(arena.allocate(64, 1), nullptr);
+    EXPECT_EQ(arena.overflows(), 1u);
+
+    arena.reset();
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_EQ(arena.high_water(), 16u);
+    EXPECT_EQ(arena.allocate(3, 1), a);
+}
+
+TEST(LineArena, Container) {
+    StaticArena<256> arena;
+
+    std::vector<int, ArenaAllocator<int>> v { ArenaAllocator<int>(arena) };
+    for (int i = 0; i < 8; ++i) {
+        v.push_back(i);
+    }
+    EXPECT_TRUE(arena.owns(v.data()));
+    EXPECT_EQ(v[7], 7);
+    EXPECT_EQ(arena.overflows(), 0u);
+}
+
+TEST(LineArena, HeapFallback) {
+    StaticArena<16> arena;
+
+    std::vector<int, ArenaAllocator<int>> v { ArenaAllocator<int>(arena) };
+    for (int i = 0; i < 100; ++i) {
+        v.push_back(i);
+    }
+    EXPECT_FALSE(arena.owns(v.data()));
+    EXPECT_EQ(v[99], 99);
+    EXPECT_GT(arena.overflows(), 0u);
+}
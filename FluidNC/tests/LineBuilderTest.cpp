@@ -0,0 +1,68 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/LineBuilder.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+static std::string fixed(float value, int decimals) {
+    char        buffer[64];
+    LineBuilder line(buffer, sizeof(buffer));
+    line.fixed(value, decimals);
+    return std::string(line.view());
+}
+
+static std::string printf_fixed(float value, int decimals) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", decimals, double(value));
+    return buffer;
+}
+
+TEST(LineBuilder, Text) {
+    char        buffer[32];
+    LineBuilder line(buffer, sizeof(buffer));
+    line << "<Idle" << '|' << "Bf:" << int32_t(15) << ',' << uint32_t(4096) << ',' << int32_t(-7) << '>';
+    EXPECT_EQ(line.view(), "<Idle|Bf:15,4096,-7>");
+    EXPECT_STREQ(line.c_str(), "<Idle|Bf:15,4096,-7>");
+}
+
+TEST(LineBuilder, Truncates) {
+    char        buffer[8];
+    LineBuilder line(buffer, sizeof(buffer));
+    line << "abcde" << uint32_t(12345);
+    EXPECT_EQ(line.length(), 7);
+    EXPECT_STREQ(buffer, "abcde12");
+    line << 'x';
+    EXPECT_STREQ(buffer, "abcde12");
+}
+
+TEST(LineBuilder, Fixed) {
+    EXPECT_EQ(fixed(0.0f, 3), "0.000");
+    EXPECT_EQ(fixed(-0.0001f, 3), "-0.000");
+    EXPECT_EQ(fixed(12.3456f, 3), "12.346");
+    EXPECT_EQ(fixed(-250.5f, 4), "-250.5000");
+    EXPECT_EQ(fixed(1499.6f, 0), "1500");
+    EXPECT_EQ(fixed(INFINITY, 3), printf_fixed(INFINITY, 3));
+    EXPECT_EQ(fixed(1e20f, 3), printf_fixed(1e20f, 3));
+}
+
+TEST(LineBuilder, MatchesPrintf) {
+    std::mt19937                          rng(42);
+    std::uniform_real_distribution<float> dist(-2000.0f, 2000.0f);
+    int                                   mismatches = 0;
+    for (int i = 0; i < 200000; i++) {
+        float value    = dist(rng);
+        int   decimals = i % 5;
+        if (fixed(value, decimals) != printf_fixed(value, decimals)) {
+            // printf rounds exact binary ties to even
+            double scaled = std::fabs(double(value)) * std::pow(10.0, decimals);
+            if (scaled - std::floor(scaled) != 0.5) {
+                ++mismatches;
+            }
+        }
+    }
+    EXPECT_EQ(mismatches, 0);
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/LinePool.h"
+
+#include <set>
+#include <thread>
+#include <vector>
+
+TEST(LinePool, Exhaustion) {
+    LinePool<4, 16> pool;
+    std::set<char*> lines;
+    for (int i = 0; i < 4; i++) {
+        char* line = pool.acquire();
+        ASSERT_NE(line, nullptr);
+        EXPECT_TRUE(pool.owns(line));
+        lines.insert(line);
+    }
+    EXPECT_EQ(lines.size(), 4);
+    EXPECT_EQ(pool.in_use(), 4);
+
+    EXPECT_EQ(pool.acquire(), nullptr);
+    EXPECT_EQ(pool.misses(), 1);
+
+    char* line = *lines.begin();
+    pool.release(line);
+    EXPECT_EQ(pool.in_use(), 3);
+    EXPECT_EQ(pool.acquire(), line);
+}
+
+TEST(LinePool, IgnoresForeignLines) {
+    LinePool<32, 8> pool;
+    const char*     fixed = "ok";
+    EXPECT_FALSE(pool.owns(fixed));
+    pool.release(fixed);
+    EXPECT_EQ(pool.in_use(), 0);
+
+    for (int i = 0; i < 32; i++) {
+        EXPECT_NE(pool.acquire(), nullptr);
+    }
+    EXPECT_EQ(pool.acquire(), nullptr);
+}
+
+TEST(LinePool, TwoTasks) {
+    LinePool<8, 32> pool;
+    const int       total = 100000;
+
+    // Buffers acquired by the main thread are released by the other one, as the output task does
+    std::atomic<char*> handoff { nullptr };
+    std::thread        consumer([&] {
+        for (int received = 0; received < total;) {
+            if (char* line = handoff.exchange(nullptr)) {
+                pool.release(line);
+                ++received;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    for (int sent = 0; sent < total;) {
+        char* line = pool.acquire();
+        if (!line) {
+            std::this_thread::yield();
+            continue;
+        }
+        while (handoff.load() != nullptr) {
+            std::this_thread::yield();
+        }
+        handoff.store(line);
+        ++sent;
+    }
+    consumer.join();
+    EXPECT_EQ(pool.in_use(), 0);
+}
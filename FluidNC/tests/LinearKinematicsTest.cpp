@@ -0,0 +1,66 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/Kinematics/LinearKinematics.h"
+
+using namespace Kinematics;
+
+// CoreXY::transform_cartesian_to_motors() with a runtime axis count
+static void corexy_to_motors(float* motors, const float* cartesian, float x_scaler, size_t n_axis) {
+    motors[0] = (x_scaler * cartesian[0]) + cartesian[1];
+    motors[1] = (x_scaler * cartesian[0]) - cartesian[1];
+    for (size_t axis = 2; axis < n_axis; axis++) {
+        motors[axis] = cartesian[axis];
+    }
+}
+
+static float distance(const float* a, const float* b, size_t n_axis) {
+    float sum = 0;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        sum += (a[axis] - b[axis]) * (a[axis] - b[axis]);
+    }
+    return sqrtf(sum);
+}
+
+TEST(LinearKinematics, CoreXYMatchesRuntimeTransform) {
+    const float x_scalers[] = { 1.0f, 2.0f };  // CoreXY, Midtbot
+    for (float x_scaler : x_scalers) {
+        float cartesian[3] = { 12.5f, -40.25f, 3.0f };
+        float fast[3], slow[3], back[3];
+        Linear<LinearKind::CoreXY, 3>::to_motors(fast, cartesian, x_scaler);
+        corexy_to_motors(slow, cartesian, x_scaler, 3);
+        for (size_t axis = 0; axis < 3; axis++) {
+            EXPECT_FLOAT_EQ(fast[axis], slow[axis]);
+        }
+        Linear<LinearKind::CoreXY, 3>::to_cartesian(back, fast, x_scaler);
+        for (size_t axis = 0; axis < 3; axis++) {
+            EXPECT_NEAR(back[axis], cartesian[axis], 1e-4f);
+        }
+    }
+}
+
+TEST(LinearKinematics, FeedScaleIsMotorToCartesianDistance) {
+    float position[4] = { 1.0f, 2.0f, 3.0f, 0.0f };
+    float target[4]   = { 11.0f, -5.0f, 4.0f, 90.0f };
+    float motor_position[4], motor_target[4];
+    corexy_to_motors(motor_position, position, 2.0f, 4);
+    corexy_to_motors(motor_target, target, 2.0f, 4);
+    float expected = distance(motor_target, motor_position, 4) / distance(target, position, 4);
+    EXPECT_NEAR((Linear<LinearKind::CoreXY, 4>::feed_scale(target, position, 2.0f)), expected, 1e-5f);
+
+    // A move without length leaves the feed rate alone
+    EXPECT_EQ((Linear<LinearKind::CoreXY, 4>::feed_scale(position, position, 2.0f)), 1.0f);
+    EXPECT_EQ((Linear<LinearKind::Cartesian, 4>::feed_scale(target, position, 1.0f)), 1.0f);
+}
+
+TEST(LinearKinematics, CartesianIsIdentity) {
+    float cartesian[6] = { 1, 2, 3, 4, 5, 6 };
+    float motors[6], back[6];
+    Linear<LinearKind::Cartesian, 6>::to_motors(motors, cartesian, 1.0f);
+    Linear<LinearKind::Cartesian, 6>::to_cartesian(back, motors, 1.0f);
+    for (size_t axis = 0; axis < 6; axis++) {
+        EXPECT_EQ(motors[axis], cartesian[axis]);
+        EXPECT_EQ(back[axis], cartesian[axis]);
+    }
+}
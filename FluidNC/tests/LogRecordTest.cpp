@@ -0,0 +1,36 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/LogRecord.h"
+
+#include <string>
+
+static std::string format(const LogRecord& record) {
+    char        buffer[64];
+    LineBuilder line(buffer, sizeof(buffer));
+    record.format_to(line);
+    return std::string(line.view());
+}
+
+enum class Color { Red, Green };
+
+TEST(LogRecord, Arguments) {
+    EXPECT_EQ(format(make_log_record("[MSG:DBG: ", "Homing done")), "[MSG:DBG: Homing done]");
+    EXPECT_EQ(format(make_log_record("[MSG:DBG: ", "{} and {}", -5, 7u)), "[MSG:DBG: -5 and 7]");
+    EXPECT_EQ(format(make_log_record("[MSG:DBG: ", "At {},{} @ {}", 1.5f, -0.25, 1000.0f)), "[MSG:DBG: At 1.500,-0.250 @ 1000.000]");
+    EXPECT_EQ(format(make_log_record("[MSG:INFO: ", "{}: {}", "VFD", Color::Green)), "[MSG:INFO: VFD: 1]");
+    EXPECT_EQ(format(make_log_record("", "{}", uint8_t(200))), "200");
+}
+
+TEST(LogRecord, MissingArguments) {
+    // Placeholders without an argument are kept as text
+    EXPECT_EQ(format(make_log_record("[MSG:", "{} {} {", 1)), "[MSG:1 {} {]");
+}
+
+TEST(LogRecord, Truncates) {
+    std::string long_text(100, 'x');
+    std::string text = format(make_log_record("[MSG:", "{}", long_text.c_str()));
+    EXPECT_EQ(text.size(), 63);
+    EXPECT_EQ(text.substr(0, 6), "[MSG:x");
+}
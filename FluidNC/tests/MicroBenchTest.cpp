@@ -0,0 +1,224 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// Host micro-benchmarks of the per-line and per-block work that can run without a machine
+// config: the S-curve profile calculations, the parameter tables behind get_param() and
+// set_param(), the kinematics of a line, and the chords of an arc.  The parser itself - expression(), collapseGCode() and gc_execute_line() -
+// needs the firmware, so $GCode/Bench times it on the controller with the same output.
+//
+// Each case prints one JSON object per line, prefixed with "BENCH ", and appends it to the
+// file named by MICRO_BENCH_OUTPUT if that is set, so that runs can be collected for trend
+// tracking.  For numbers, run the bench environment, which optimizes and runs longer:
+//
+//   pio test -e bench -a "--gtest_filter=MicroBench.*"
+
+#include "gtest/gtest.h"
+#include "src/ParamTable.h"
+#include "src/SCurve.h"
+#include "src/Kinematics/LinearKinematics.h"
+#include "src/ArcChords.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifndef MICRO_BENCH_REPEAT
+#    define MICRO_BENCH_REPEAT 1
+#endif
+
+// Times ops iterations of fn, reports them, and returns nanoseconds per iteration
+template <typename Fn>
+static double bench(const char* name, size_t ops, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ops; i++) {
+        fn(i);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ops;
+
+    char line[160];
+    snprintf(line, sizeof(line), "{\"name\":\"%s\",\"iterations\":%zu,\"ns_per_op\":%.1f}", name, ops, ns);
+    printf("BENCH %s\n", line);
+    if (const char* path = getenv("MICRO_BENCH_OUTPUT")) {
+        if (FILE* out = fopen(path, "a")) {
+            fprintf(out, "%s\n", line);
+            fclose(out);
+        }
+    }
+    return ns;
+}
+
+struct Move {
+    float distance, entry, exit, velocity;
+};
+
+// CAM micro-segments at speed, corners, and long rapids, in mm and mm/min
+static std::vector<Move> bench_moves() {
+    std::vector<Move> moves;
+    for (int i = 0; i < 64; i++) {
+        float f = 1.0f + i * 0.01f;
+        moves.push_back({ 0.05f * f, 1500.0f, 1500.0f, 1500.0f });  // Chord of a curve
+        moves.push_back({ 0.5f * f, 900.0f * f, 300.0f, 1500.0f });  // Into a corner
+        moves.push_back({ 5.0f * f, 0.0f, 0.0f, 3000.0f });          // Feed from rest
+        moves.push_back({ 100.0f * f, 0.0f, 0.0f, 6000.0f });        // Rapid
+    }
+    return moves;
+}
+
+// As plan_compute_s_curve() passes them
+static const float acceleration = 1000.0f;   // mm/s^2
+static const float max_jerk     = 20000.0f;  // mm/s^3
+
+TEST(MicroBench, SCurve) {
+    auto         moves = bench_moves();
+    const size_t ops   = 200000 * MICRO_BENCH_REPEAT;
+    volatile float sink = 0;
+
+    auto run = [&](auto calculate) {
+        return [&, calculate](size_t i) {
+            auto& m = moves[i % moves.size()];
+            sink    = calculate(m.distance, m.entry, m.exit, m.velocity, acceleration, max_jerk).total_time;
+        };
+    };
+    bench("s_curve_profile", ops, run(calculate_s_curve_profile));
+    bench("s_curve_fast", ops, run(calculate_s_curve_fast));
+    s_curve_cache_reset();
+    bench("s_curve_cached", ops, [&](size_t i) {
+        auto& m = moves[i % moves.size()];
+        sink    = calculate_s_curve_cached(true, m.distance, m.entry, m.exit, m.velocity, acceleration, max_jerk).total_time;
+    });
+
+    // The moves outnumber the cache slots, so this is its cost when it mostly misses
+    auto stats = s_curve_cache_stats();
+    EXPECT_EQ(stats.hits + stats.misses, ops);
+}
+
+TEST(MicroBench, Params) {
+    const size_t ops = 1000000 * MICRO_BENCH_REPEAT;
+
+    // Names and numbers as macros use them
+    std::vector<std::string> names;
+    for (int i = 0; i < 32; i++) {
+        names.push_back("_TOOL_OFFSET_" + std::to_string(i));
+    }
+    NamedParams    named;
+    NumberedParams numbered;
+    for (int i = 0; i < 32; i++) {
+        named.set(names[i], float(i));
+        numbered.set(5000 + i, float(i));
+    }
+
+    volatile float sink = 0;
+    bench("named_param_get", ops, [&](size_t i) {
+        float value;
+        named.get(names[i & 31], value);
+        sink = value;
+    });
+    bench("named_param_set", ops, [&](size_t i) { named.set(names[i & 31], float(i)); });
+    bench("numbered_param_get", ops, [&](size_t i) {
+        float value;
+        numbered.get(5000 + int(i & 31), value);
+        sink = value;
+    });
+    bench("numbered_param_set", ops, [&](size_t i) { numbered.set(5000 + int(i & 31), float(i)); });
+
+    float value = 0;
+    EXPECT_TRUE(named.get("_TOOL_OFFSET_3", value));
+    EXPECT_EQ(named.size(), 32);
+    EXPECT_EQ(numbered.size(), 32);
+}
+
+// The per-line work of CoreXY::cartesian_to_motors() before mc_move_motors(), through a virtual
+// call with a runtime axis count as the generic kinematics path does it
+struct GenericKinematics {
+    virtual void transform(float* motors, const float* cartesian) = 0;
+    virtual ~GenericKinematics() {}
+
+    float line(float* motors, const float* target, const float* position, float feed_rate) {
+        transform(motors, target);
+        float last_motors[n_axis];
+        transform(last_motors, position);
+        float cartesian = 0, motor = 0;
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            cartesian += (target[axis] - position[axis]) * (target[axis] - position[axis]);
+            motor += (motors[axis] - last_motors[axis]) * (motors[axis] - last_motors[axis]);
+        }
+        return feed_rate * sqrtf(motor) / sqrtf(cartesian);
+    }
+    size_t n_axis   = 3;
+    float  x_scaler = 1.0f;
+};
+
+struct GenericCoreXY : public GenericKinematics {
+    void transform(float* motors, const float* cartesian) override {
+        motors[0] = (x_scaler * cartesian[0]) + cartesian[1];
+        motors[1] = (x_scaler * cartesian[0]) - cartesian[1];
+        for (size_t axis = 2; axis < n_axis; axis++) {
+            motors[axis] = cartesian[axis];
+        }
+    }
+};
+
+TEST(MicroBench, Kinematics) {
+    using Fast       = Kinematics::Linear<Kinematics::LinearKind::CoreXY, 3>;
+    const size_t ops = 2000000 * MICRO_BENCH_REPEAT;
+
+    std::vector<float> points;  // A polyline of short CAM moves
+    for (int i = 0; i < 256; i++) {
+        points.push_back(10.0f * cosf(i * 0.1f));
+        points.push_back(10.0f * sinf(i * 0.1f));
+        points.push_back(0.01f * i);
+    }
+    GenericCoreXY               corexy;
+    GenericKinematics* volatile generic = &corexy;  // Not devirtualized
+    volatile float              sink    = 0;
+
+    float generic_motors[3], fast_motors[3];
+    bench("corexy_line_virtual", ops, [&](size_t i) {
+        const float* position = &points[(i & 127) * 3];
+        sink                  = generic->line(generic_motors, position + 3, position, 1000.0f);
+    });
+    bench("corexy_line_specialized", ops, [&](size_t i) {
+        const float* position = &points[(i & 127) * 3];
+        Fast::to_motors(fast_motors, position + 3, 1.0f);
+        sink = 1000.0f * Fast::feed_scale(position + 3, position, 1.0f);
+    });
+
+    // Both paths give the same motors and feed rate
+    const float* position     = &points[30];
+    float        generic_feed = generic->line(generic_motors, position + 3, position, 1000.0f);
+    Fast::to_motors(fast_motors, position + 3, 1.0f);
+    for (size_t axis = 0; axis < 3; axis++) {
+        EXPECT_FLOAT_EQ(fast_motors[axis], generic_motors[axis]);
+    }
+    EXPECT_NEAR(1000.0f * Fast::feed_scale(position + 3, position, 1.0f), generic_feed, 0.01f);
+}
+
+// The chord end points of mc_arc(), one at a time as it used to compute them between
+// planner calls, and in the batches it computes them in now
+TEST(MicroBench, ArcChords) {
+    const int    segments = 1024;
+    const size_t ops      = 2000 * MICRO_BENCH_REPEAT;
+    const float  theta    = 6.2831853f / segments;
+    float        r0[segments], r1[segments];
+    volatile float sink = 0;
+
+    bench("arc_chords_single", ops, [&](size_t) {
+        ArcChords chords(-3.0f, 4.0f, theta, 12);
+        for (int i = 0; i < segments; i++) {
+            chords.next(1, &r0[i], &r1[i]);
+            sink = r0[i];
+        }
+    });
+    bench("arc_chords_batch16", ops, [&](size_t) {
+        ArcChords chords(-3.0f, 4.0f, theta, 12);
+        for (int i = 0; i < segments; i += 16) {
+            chords.next(16, &r0[i], &r1[i]);
+        }
+        sink = r0[segments - 1];
+    });
+    EXPECT_NEAR(r0[segments - 1], -3.0f, 1e-3f);
+    EXPECT_NEAR(r1[segments - 1], 4.0f, 1e-3f);
+}
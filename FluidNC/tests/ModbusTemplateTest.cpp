@@ -0,0 +1,87 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/Spindles/VFD/ModbusTemplate.h"
+
+#include <string>
+
+using namespace ModbusTemplate;
+
+static std::string request(const Command& cmd, uint32_t rpm, uint32_t maxRPM) {
+    uint8_t msg[MAX_MSG_SIZE];
+    uint8_t length = cmd.build(msg, rpm, maxRPM);
+    return std::string(msg + 1, msg + length);  // Without the address
+}
+
+static std::string bytes(std::initializer_list<uint8_t> list) {
+    return std::string(list.begin(), list.end());
+}
+
+TEST(ModbusTemplate, Scale) {
+    Scale scale;
+    EXPECT_TRUE(compile_scale("", scale));
+    EXPECT_EQ(scale.apply(1234, 1), 1234);
+    EXPECT_TRUE(compile_scale("*10/60", scale));
+    EXPECT_EQ(scale.apply(24000, 1), 4000);
+    EXPECT_TRUE(compile_scale("/6", scale));
+    EXPECT_EQ(scale.apply(24000, 1), 4000);
+    EXPECT_TRUE(compile_scale("%*100", scale));
+    EXPECT_EQ(scale.apply(12000, 24000), 5000);
+    EXPECT_FALSE(compile_scale("x", scale));
+    EXPECT_FALSE(compile_scale("*", scale));
+    EXPECT_FALSE(compile_scale("*10/x", scale));
+}
+
+TEST(ModbusTemplate, Request) {
+    Command          cmd;
+    std::string_view bad;
+    ASSERT_TRUE(compile("06 20 01 rpm*10/60 > echo", cmd, bad));
+    EXPECT_EQ(request(cmd, 24000, 24000), bytes({ 0x06, 0x20, 0x01, 0x0f, 0xa0 }));
+    EXPECT_EQ(cmd.rx_length, cmd.tx_length);
+
+    ASSERT_TRUE(compile("06 10 00 rpm%*100 > echo", cmd, bad));
+    EXPECT_EQ(request(cmd, 12000, 24000), bytes({ 0x06, 0x10, 0x00, 0x13, 0x88 }));
+
+    ASSERT_TRUE(compile("", cmd, bad));
+    EXPECT_TRUE(cmd.empty);
+    EXPECT_EQ(cmd.tx_length, 1);
+    EXPECT_EQ(cmd.rx_length, 1);
+}
+
+TEST(ModbusTemplate, Response) {
+    Command          cmd;
+    std::string_view bad;
+    ASSERT_TRUE(compile("03 00 07 00 02 >  03 04 maxrpm*6 minrpm*6", cmd, bad));
+    EXPECT_EQ(cmd.rx_length, 7);
+
+    const uint8_t good[] = { 0x03, 0x04, 0x0f, 0xa0, 0x00, 0x64 };
+    Values        values;
+    EXPECT_TRUE(cmd.match(good, values));
+    EXPECT_FALSE(values.has_rpm);
+    EXPECT_TRUE(values.has_max_rpm);
+    EXPECT_EQ(values.max_rpm, 24000);
+    EXPECT_TRUE(values.has_min_rpm);
+    EXPECT_EQ(values.min_rpm, 600);
+
+    const uint8_t wrong[] = { 0x03, 0x02, 0x0f, 0xa0, 0x00, 0x64 };
+    EXPECT_FALSE(cmd.match(wrong, values));
+
+    ASSERT_TRUE(compile("04 00 00 00 02 > 04 04 rpm ignore", cmd, bad));
+    const uint8_t speed[] = { 0x04, 0x04, 0x01, 0x02, 0xff, 0xff };
+    values                = Values();
+    EXPECT_TRUE(cmd.match(speed, values));
+    EXPECT_TRUE(values.has_rpm);
+    EXPECT_EQ(values.rpm, 0x102);
+}
+
+TEST(ModbusTemplate, Errors) {
+    Command          cmd;
+    std::string_view bad;
+    EXPECT_FALSE(compile("06 2g > echo", cmd, bad));
+    EXPECT_EQ(bad, "2g");
+    EXPECT_FALSE(compile("06 rpm rpm > echo", cmd, bad));
+    EXPECT_FALSE(compile("03 00 > 03 bogus", cmd, bad));
+    EXPECT_EQ(bad, "bogus");
+    EXPECT_FALSE(compile("01 02 03 04 05 06 07 08 09 0a 0b 0c 0d > echo", cmd, bad));
+}
@@ -0,0 +1,59 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/MqttPacket.h"
+
+static std::string bytes(std::initializer_list<uint8_t> list) {
+    return std::string(list.begin(), list.end());
+}
+
+TEST(MqttPacket, RemainingLength) {
+    struct {
+        size_t      length;
+        std::string encoded;
+    } cases[] = {
+        { 0, bytes({ 0x00 }) },
+        { 127, bytes({ 0x7f }) },
+        { 128, bytes({ 0x80, 0x01 }) },
+        { 16383, bytes({ 0xff, 0x7f }) },
+        { 16384, bytes({ 0x80, 0x80, 0x01 }) },
+    };
+    for (auto& c : cases) {
+        std::string out;
+        Mqtt::put_length(out, c.length);
+        EXPECT_EQ(out, c.encoded) << c.length;
+    }
+}
+
+TEST(MqttPacket, Connect) {
+    std::string out;
+    Mqtt::connect(out, "cnc", 60, "", "");
+    EXPECT_EQ(out, bytes({ 0x10, 15, 0, 4, 'M', 'Q', 'T', 'T', 4, 0x02, 0, 60, 0, 3, 'c', 'n', 'c' }));
+
+    out.clear();
+    Mqtt::connect(out, "c", 30, "u", "pw");
+    EXPECT_EQ(out, bytes({ 0x10, 20, 0, 4, 'M', 'Q', 'T', 'T', 4, 0xc2, 0, 30, 0, 1, 'c', 0, 1, 'u', 0, 2, 'p', 'w' }));
+}
+
+TEST(MqttPacket, Publish) {
+    std::string out;
+    Mqtt::publish(out, "a/b", "Idle", true);
+    Mqtt::pingreq(out);
+    EXPECT_EQ(out, bytes({ 0x31, 9, 0, 3, 'a', '/', 'b', 'I', 'd', 'l', 'e', 0xc0, 0 }));
+
+    out.clear();
+    std::string payload(200, 'x');
+    Mqtt::publish(out, "t", payload);
+    EXPECT_EQ(out.substr(0, 6), bytes({ 0x30, 0xcb, 1, 0, 1, 't' }));
+    EXPECT_EQ(out.length(), 6 + payload.length());
+}
+
+TEST(MqttPacket, Connack) {
+    const uint8_t accepted[] = { 0x20, 2, 0, 0 };
+    const uint8_t refused[]  = { 0x20, 2, 0, 5 };
+    EXPECT_EQ(Mqtt::connack(accepted, sizeof(accepted)), 0);
+    EXPECT_EQ(Mqtt::connack(refused, sizeof(refused)), 5);
+    EXPECT_EQ(Mqtt::connack(accepted, 3), -1);
+    EXPECT_EQ(Mqtt::connack(refused + 1, 3), -1);
+}
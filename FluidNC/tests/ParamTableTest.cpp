@@ -0,0 +1,123 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/ParamTable.h"
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+TEST(ParamTable, Named) {
+    NamedParams params;
+    float       value = 0;
+
+    EXPECT_FALSE(params.get("FOO", value));
+    EXPECT_FALSE(params.exists("FOO"));
+
+    params.set("FOO", 1.5f);
+    params.set("_BAR", -2.0f);
+    EXPECT_TRUE(params.get("FOO", value));
+    EXPECT_EQ(value, 1.5f);
+    EXPECT_TRUE(params.get(std::string("_BAR"), value));
+    EXPECT_EQ(value, -2.0f);
+    EXPECT_FALSE(params.exists("foo"));  // Names are case sensitive; the parser uppercases them
+    EXPECT_EQ(params.size(), 2);
+
+    params.set("FOO", 3.0f);
+    EXPECT_TRUE(params.get("FOO", value));
+    EXPECT_EQ(value, 3.0f);
+    EXPECT_EQ(params.size(), 2);
+
+    params.clear();
+    EXPECT_FALSE(params.exists("FOO"));
+    EXPECT_EQ(params.size(), 0);
+}
+
+TEST(ParamTable, Numbered) {
+    NumberedParams params = { { 5399, 0.0f } };
+    float          value  = 1;
+
+    EXPECT_TRUE(params.get(5399, value));
+    EXPECT_EQ(value, 0.0f);
+    EXPECT_FALSE(params.get(1, value));
+
+    // Enough entries to grow the table several times
+    for (int id = 1; id <= 5000; id++) {
+        params.set(id, float(id) / 2);
+    }
+    EXPECT_EQ(params.size(), 5001);
+    for (int id = 1; id <= 5000; id++) {
+        ASSERT_TRUE(params.get(id, value)) << id;
+        EXPECT_EQ(value, float(id) / 2) << id;
+    }
+    EXPECT_TRUE(params.exists(5399));
+    EXPECT_FALSE(params.exists(5001));
+}
+
+TEST(ParamTable, MatchesMap) {
+    NamedParams                  params;
+    std::map<std::string, float> reference;
+    std::mt19937                 rng(7);
+    for (int i = 0; i < 20000; i++) {
+        std::string name = "_P" + std::to_string(rng() % 500);
+        if (rng() % 2) {
+            float value = float(rng() % 1000);
+            params.set(name, value);
+            reference[name] = value;
+        } else {
+            float value;
+            auto  it = reference.find(name);
+            ASSERT_EQ(params.get(name, value), it != reference.end()) << name;
+            if (it != reference.end()) {
+                EXPECT_EQ(value, it->second) << name;
+            }
+        }
+    }
+    EXPECT_EQ(params.size(), reference.size());
+}
+
+// Typical macro usage: a few dozen names, read far more often than written
+TEST(ParamTable, Throughput) {
+    std::vector<std::string> names;
+    for (int i = 0; i < 40; i++) {
+        names.push_back("_MACRO_PARAM_" + std::to_string(i));
+    }
+    const int rounds = 20000;
+
+    NamedParams                  params;
+    std::map<std::string, float> reference;
+    double                       table_sum = 0;
+    double                       map_sum   = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (auto& name : names) {
+            float value = 0;
+            params.get(name, value);
+            params.set(name, value + 1);
+            table_sum += value;
+        }
+    }
+    auto mid = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (auto& name : names) {
+            float value = 0;
+            if (auto it = reference.find(name); it != reference.end()) {
+                value = it->second;
+            }
+            reference[name] = value + 1;
+            map_sum += value;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double count   = double(rounds) * names.size();
+    double table_s = std::chrono::duration<double>(mid - start).count();
+    double map_s   = std::chrono::duration<double>(end - mid).count();
+    printf("get+set: ParamTable %.1f M/s, std::map %.1f M/s\n", count / table_s / 1e6, count / map_s / 1e6);
+    EXPECT_EQ(table_sum, map_sum);
+}
@@ -0,0 +1,362 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// Host benchmark of the motion pipeline.  A G-code program is replayed through the
+// planner passes of PlannerPasses.h, the S-curve profiles of SCurve.cpp and the segment
+// timing of SegmentTiming.h, for several planner depths with S-curve off and on.  The
+// block handling around them follows plan_queue_block() and fill_segment_buffer(), which
+// need a machine config and cannot run on the host.
+//
+// The regular test run replays the program a few times, checks that the incremental
+// replanning gives the same plan as full replanning, and bounds the replanning work per
+// block.  For numbers, run the bench environment, which optimizes and replays longer:
+//
+//   pio test -e bench -a "--gtest_filter=PlannerBench.*"
+//
+// PLANNER_BENCH_GCODE names a recorded program to use instead of the built-in one.
+
+#include "gtest/gtest.h"
+#include "src/PlannerPasses.h"
+#include "src/SCurve.h"
+#include "src/SegmentTiming.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef PLANNER_BENCH_REPEAT
+#    define PLANNER_BENCH_REPEAT 3
+#endif
+
+static const float    steps_per_mm       = 80.0f;
+static const float    acceleration       = 1000.0f * 3600.0f;    // mm/min^2
+static const float    max_jerk           = 20000.0f * 216000.0f;  // mm/min^3
+static const float    rapid_rate         = 6000.0f;               // mm/min
+static const float    junction_deviation = 0.01f;                 // mm
+static const float    min_junction_speed = 0.0f;
+static const float    dt_segment         = 1.0f / (100 * 60);  // One ACCELERATION_TICKS_PER_SECOND segment, in minutes
+static const uint32_t ticks_per_minute   = 20000000 * 60;
+
+// A pocket finished with a circle in 1 degree chords, the way CAM posts curves
+static std::string builtin_program() {
+    std::ostringstream gcode;
+    gcode << "G0 X0 Y0\nG1 F1500\n";
+    for (int pass = 0; pass < 10; pass++) {
+        gcode << "G1 X40 Y" << pass * 2 << "\n";
+        gcode << "G1 X40 Y" << pass * 2 + 1 << "\n";
+        gcode << "G1 X0 Y" << pass * 2 + 1 << "\n";
+        gcode << "G1 X0 Y" << pass * 2 + 2 << "\n";
+    }
+    gcode << "G0 X30 Y10\nG1 F3000\n";
+    for (int degree = 1; degree <= 360; degree++) {
+        float angle = degree * float(M_PI) / 180.0f;
+        gcode << "G1 X" << 20.0f + 10.0f * cosf(angle) << " Y" << 10.0f + 10.0f * sinf(angle) << "\n";
+    }
+    return gcode.str();
+}
+
+struct Move {
+    float target[3];
+    float feed_rate;
+    bool  rapid;
+};
+
+// Understands G0 and G1 with X, Y, Z and F, which is all that a recorded toolpath needs here
+static std::vector<Move> parse_program(const std::string& text) {
+    std::vector<Move>  moves;
+    std::istringstream lines(text);
+    std::string        line;
+    Move               state = { { 0, 0, 0 }, 1000.0f, true };
+    while (std::getline(lines, line)) {
+        bool        motion = false;
+        const char* p      = line.c_str();
+        while (*p) {
+            char letter = *p++;
+            if (letter == ';' || letter == '(') {
+                break;
+            }
+            if (!isalpha(letter)) {
+                continue;
+            }
+            char* end;
+            float value = strtof(p, &end);
+            if (end == p) {
+                continue;
+            }
+            p = end;
+            switch (toupper(letter)) {
+                case 'G':
+                    if (value == 0.0f || value == 1.0f) {
+                        state.rapid = value == 0.0f;
+                    }
+                    break;
+                case 'X':
+                case 'Y':
+                case 'Z':
+                    state.target[toupper(letter) - 'X'] = value;
+                    motion                              = true;
+                    break;
+                case 'F':
+                    state.feed_rate = value;
+                    break;
+            }
+        }
+        if (motion) {
+            moves.push_back(state);
+        }
+    }
+    return moves;
+}
+
+static std::vector<Move> bench_moves() {
+    const char* path = getenv("PLANNER_BENCH_GCODE");
+    if (path) {
+        std::ifstream     file(path);
+        std::stringstream text;
+        text << file.rdbuf();
+        auto moves = parse_program(text.str());
+        if (!moves.empty()) {
+            return moves;
+        }
+        printf("No moves in %s; using the built-in program\n", path);
+    }
+    return parse_program(builtin_program());
+}
+
+struct BenchBlock {
+    // The fields that planner_passes() uses
+    float entry_speed_sqr;
+    float max_entry_speed_sqr;
+    float acceleration;
+    float millimeters;
+
+    float         max_junction_speed_sqr;
+    float         nominal_speed;
+    uint32_t      step_event_count;
+    bool          use_s_curve;
+    SCurveProfile profile;
+};
+
+struct BenchResult {
+    uint32_t blocks       = 0;
+    uint32_t segments     = 0;
+    uint64_t steps        = 0;
+    uint64_t expected     = 0;  // Sum of the step event counts of the blocks
+    uint64_t visited      = 0;  // Blocks visited by the planner passes
+    double   plan_seconds = 0;
+    double   prep_seconds = 0;
+
+    std::vector<float> entry_speeds;  // Entry speed of each block as it was executed
+};
+
+class BenchPipeline {
+    std::vector<BenchBlock> _blocks;
+    uint16_t                _tail    = 0;
+    uint16_t                _head    = 0;
+    uint16_t                _planned = 0;
+    bool                    _s_curve;
+    bool                    _full_replan;
+    float                   _position[3]      = {};
+    float                   _previous_unit[3] = {};
+    float                   _previous_nominal = 0.0f;
+    uint32_t                _tail_updates     = 0;
+
+    uint16_t next_index(uint16_t index) const { return ++index == _blocks.size() ? 0 : index; }
+    uint16_t prev_index(uint16_t index) const { return (index == 0 ? _blocks.size() : index) - 1; }
+
+public:
+    BenchResult result;
+
+    BenchPipeline(size_t planner_blocks, bool s_curve, bool full_replan) :
+        _blocks(planner_blocks), _s_curve(s_curve), _full_replan(full_replan) {}
+
+    bool full() const { return next_index(_head) == _tail; }
+    bool empty() const { return _head == _tail; }
+
+    // As plan_queue_block(), for a cartesian machine with equal axes
+    void plan(const Move& move) {
+        float delta[3];
+        float mm = 0.0f;
+        for (int i = 0; i < 3; i++) {
+            delta[i] = move.target[i] - _position[i];
+            mm += delta[i] * delta[i];
+        }
+        mm = sqrtf(mm);
+        if (mm == 0.0f) {
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+
+        BenchBlock& block      = _blocks[_head];
+        block                  = {};
+        block.millimeters      = mm;
+        block.acceleration     = acceleration;
+        block.step_event_count = 0;
+        float unit[3];
+        for (int i = 0; i < 3; i++) {
+            unit[i]                = delta[i] / mm;
+            uint32_t steps         = uint32_t(fabsf(delta[i]) * steps_per_mm + 0.5f);
+            block.step_event_count = steps > block.step_event_count ? steps : block.step_event_count;
+        }
+        block.nominal_speed = move.rapid ? rapid_rate : (move.feed_rate < rapid_rate ? move.feed_rate : rapid_rate);
+
+        if (empty()) {
+            block.max_junction_speed_sqr = 0.0f;
+        } else {
+            float cos_theta = 0.0f;
+            for (int i = 0; i < 3; i++) {
+                cos_theta -= _previous_unit[i] * unit[i];
+            }
+            if (cos_theta > 0.999999f) {
+                block.max_junction_speed_sqr = min_junction_speed * min_junction_speed;
+            } else if (cos_theta < -0.999999f) {
+                block.max_junction_speed_sqr = 1.0e38f;
+            } else {
+                float sin_theta_d2 = sqrtf(0.5f * (1.0f - cos_theta));
+                float speed_sqr    = (acceleration * junction_deviation * sin_theta_d2) / (1.0f - sin_theta_d2);
+                if (_s_curve) {
+                    float prev_mm      = _blocks[prev_index(_head)].millimeters;
+                    float angle_factor = fmaxf(0.1f, (1.0f - cos_theta) / 2.0f);
+                    float speed        = calculate_s_curve_junction_velocity(prev_mm, mm, acceleration, max_jerk, angle_factor);
+                    speed_sqr          = fminf(speed_sqr, speed * speed);
+                }
+                block.max_junction_speed_sqr = fmaxf(min_junction_speed * min_junction_speed, speed_sqr);
+            }
+        }
+        float limit               = block.nominal_speed < _previous_nominal ? block.nominal_speed : _previous_nominal;
+        block.max_entry_speed_sqr = fminf(limit * limit, block.max_junction_speed_sqr);
+
+        if (_s_curve && should_use_s_curve(mm, max_jerk, acceleration)) {
+            float entry   = sqrtf(block.entry_speed_sqr);
+            block.profile = calculate_s_curve_cached(
+                mm < 50.0f || entry < 100.0f, mm, entry, 0.0f, block.nominal_speed, acceleration / 3600.0f, max_jerk / 216000.0f);
+            block.use_s_curve = block.profile.valid;
+        }
+
+        for (int i = 0; i < 3; i++) {
+            _position[i]      = move.target[i];
+            _previous_unit[i] = unit[i];
+        }
+        _previous_nominal = block.nominal_speed;
+        _head             = next_index(_head);
+
+        result.visited += planner_passes(_blocks.data(), _blocks.size(), _tail, _head, _planned, _full_replan, 0, [this]() {
+            ++_tail_updates;
+        });
+        result.plan_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ++result.blocks;
+        result.expected += block.step_event_count;
+    }
+
+    // As fill_segment_buffer() and plan_discard_current_block(), for the tail block
+    void execute() {
+        auto start = std::chrono::steady_clock::now();
+
+        BenchBlock& block          = _blocks[_tail];
+        uint16_t    next           = next_index(_tail);
+        float       exit_speed_sqr = next == _head ? 0.0f : _blocks[next].entry_speed_sqr;
+        result.entry_speeds.push_back(sqrtf(block.entry_speed_sqr));
+
+        float         speed       = sqrtf(block.entry_speed_sqr);
+        float         nominal     = block.nominal_speed;
+        float         mm_left     = block.millimeters;
+        float         time        = 0.0f;
+        SegmentTiming timing      = { 0, 0, float(block.step_event_count), 0.0f };
+        float         step_per_mm = block.step_event_count / block.millimeters;
+        while (timing.steps_remaining > 0.0f) {
+            float dt = dt_segment + timing.dt_remainder;
+            if (block.use_s_curve) {
+                time += dt * 60.0f;
+                speed = s_curve_velocity_at_time(block.profile, time, sqrtf(block.entry_speed_sqr));
+            } else {
+                // Accelerate toward nominal speed, but no faster than the block can still decelerate to its exit speed
+                float accel_speed = sqrtf(speed * speed + 2 * block.acceleration * speed * dt);
+                float decel_speed = sqrtf(exit_speed_sqr + 2 * block.acceleration * mm_left);
+                speed             = fminf(fminf(accel_speed, nominal), decel_speed);
+            }
+            if (speed < 1.0f) {
+                speed = 1.0f;
+            }
+            mm_left -= speed * dt;
+            if (mm_left < 0.0f) {
+                mm_left = 0.0f;
+            }
+            segment_timing_fixed(timing.steps_remaining, mm_left * step_per_mm, dt, ticks_per_minute, timing);
+            result.steps += timing.n_step;
+            ++result.segments;
+        }
+
+        if (_tail == _planned) {
+            _planned = next;
+        }
+        _tail = next;
+        result.prep_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void run(const std::vector<Move>& moves, int repeat) {
+        for (int r = 0; r < repeat; r++) {
+            for (auto& move : moves) {
+                if (full()) {
+                    execute();
+                }
+                plan(move);
+            }
+        }
+        while (!empty()) {
+            execute();
+        }
+    }
+};
+
+TEST(PlannerBench, IncrementalMatchesFullReplan) {
+    auto moves = bench_moves();
+    for (bool s_curve : { false, true }) {
+        BenchPipeline incremental(32, s_curve, false);
+        BenchPipeline full(32, s_curve, true);
+        incremental.run(moves, 1);
+        full.run(moves, 1);
+        ASSERT_EQ(incremental.result.entry_speeds.size(), full.result.entry_speeds.size());
+        for (size_t i = 0; i < full.result.entry_speeds.size(); i++) {
+            ASSERT_FLOAT_EQ(incremental.result.entry_speeds[i], full.result.entry_speeds[i]) << "block " << i;
+        }
+        EXPECT_LE(incremental.result.visited, full.result.visited);
+    }
+}
+
+TEST(PlannerBench, Report) {
+    auto moves = bench_moves();
+    printf("%zu moves, replayed %d times\n", moves.size(), PLANNER_BENCH_REPEAT);
+    printf("blocks s_curve    blocks/s  segments/s  visits/block  ns/block\n");
+    double shallow_visits[2] = {};
+    for (size_t planner_blocks : { 16, 32, 64, 128 }) {
+        for (bool s_curve : { false, true }) {
+            s_curve_cache_reset();
+            BenchPipeline pipeline(planner_blocks, s_curve, false);
+            pipeline.run(moves, PLANNER_BENCH_REPEAT);
+            auto& r = pipeline.result;
+
+            EXPECT_EQ(r.steps, r.expected);
+            // With incremental replanning, the work per appended block depends on how far the
+            // change propagates, not on the depth of the buffer
+            double visits = double(r.visited) / r.blocks;
+            if (planner_blocks == 16) {
+                shallow_visits[s_curve] = visits;
+            } else {
+                EXPECT_LT(visits, 1.5 * shallow_visits[s_curve]) << planner_blocks << " blocks";
+            }
+
+            printf("%6zu %7s %11.0f %11.0f %13.2f %9.0f\n",
+                   planner_blocks,
+                   s_curve ? "on" : "off",
+                   r.blocks / r.plan_seconds,
+                   r.segments / r.prep_seconds,
+                   visits,
+                   1e9 * r.plan_seconds / r.blocks);
+        }
+    }
+}
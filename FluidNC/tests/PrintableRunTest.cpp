@@ -0,0 +1,38 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/string_util.h"
+
+#include <string>
+
+static size_t run(const std::string& s) {
+    return string_util::printable_run(reinterpret_cast<const uint8_t*>(s.data()), s.size());
+}
+
+TEST(PrintableRun, Ascii) {
+    EXPECT_EQ(run(""), 0);
+    EXPECT_EQ(run("G1"), 2);
+    EXPECT_EQ(run("G1 X10 Y20 F3000"), 16);
+    EXPECT_EQ(run("G1 X10 Y20 F3000\n"), 16);
+    EXPECT_EQ(run("\nG1 X10"), 0);
+    EXPECT_EQ(run(" ~\x7f"), 3);
+}
+
+TEST(PrintableRun, StopsAtEachPosition) {
+    // The stopping byte at every offset within and across words
+    for (char stop : { '\r', '\n', '\b', '\0', '\x1f', '\x80', '\xc3', '\xff' }) {
+        for (size_t i = 0; i < 12; i++) {
+            std::string s(12, 'a');
+            s[i] = stop;
+            EXPECT_EQ(run(s), i) << int(uint8_t(stop)) << " at " << i;
+        }
+    }
+}
+
+TEST(PrintableRun, BorrowDoesNotStopEarly) {
+    // A control byte after a 0x20 borrows from it; the space must still count
+    EXPECT_EQ(run(std::string(" \n  ", 4)), 1);
+    EXPECT_EQ(run(std::string("ab \x01", 4)), 3);
+    EXPECT_EQ(run(std::string("\x20\x20\x20\x20\x20\x00", 6)), 5);
+}
@@ -0,0 +1,97 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/ReadAhead.h"
+
+#include <string>
+#include <thread>
+
+struct FakeFile {
+    std::string data;
+    size_t      pos = 0;
+};
+
+static size_t fake_read(void* arg, char* buffer, size_t length) {
+    auto*  file = static_cast<FakeFile*>(arg);
+    size_t n    = std::min(length, file->data.size() - file->pos);
+    memcpy(buffer, file->data.data() + file->pos, n);
+    file->pos += n;
+    return n;
+}
+
+static void wait() {
+    std::this_thread::yield();
+}
+
+static std::string make_data(size_t size) {
+    std::string data;
+    for (size_t i = 0; i < size; i++) {
+        data += char('a' + i % 23);
+    }
+    return data;
+}
+
+static std::string read_all(ReadAhead& reader, size_t chunk) {
+    std::string result;
+    char        buffer[100];
+    while (size_t n = reader.read(buffer, std::min(chunk, sizeof(buffer)))) {
+        result.append(buffer, n);
+    }
+    return result;
+}
+
+TEST(ReadAhead, ReaderFillsAlone) {
+    for (size_t size : { 0, 1, 63, 64, 65, 128, 1000 }) {
+        FakeFile  file { make_data(size) };
+        char      storage[128];
+        ReadAhead reader(storage, 64, fake_read, &file, wait);
+        EXPECT_EQ(read_all(reader, 7), file.data) << size;
+        EXPECT_EQ(reader.position(), size);
+        EXPECT_EQ(reader.read(), -1);
+    }
+}
+
+TEST(ReadAhead, BackgroundFillsInOrder) {
+    FakeFile  file { make_data(100000) };
+    char      storage[512];
+    ReadAhead reader(storage, 256, fake_read, &file, wait);
+
+    std::atomic<bool> done { false };
+    std::thread       filler([&] {
+        while (!done) {
+            if (!reader.fill_ahead()) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    std::string result;
+    for (int c; (c = reader.read()) >= 0;) {
+        result += char(c);
+    }
+    done = true;
+    filler.join();
+
+    EXPECT_EQ(result, file.data);
+    EXPECT_EQ(reader.stats().fills, 100000 / 256 + 1);
+    EXPECT_GT(reader.stats().ahead, 0);
+}
+
+TEST(ReadAhead, Reset) {
+    FakeFile  file { make_data(1000) };
+    char      storage[128];
+    ReadAhead reader(storage, 64, fake_read, &file, wait);
+
+    char buffer[10];
+    EXPECT_EQ(reader.read(buffer, 10), 10);
+    EXPECT_TRUE(reader.wants_fill());
+    EXPECT_TRUE(reader.fill_ahead());
+    EXPECT_FALSE(reader.wants_fill());
+
+    reader.suspend();
+    EXPECT_FALSE(reader.fill_ahead());
+    file.pos = 500;
+    reader.reset(500);
+    EXPECT_EQ(reader.position(), 500);
+    EXPECT_EQ(read_all(reader, 33), file.data.substr(500));
+}
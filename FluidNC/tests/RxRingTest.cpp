@@ -0,0 +1,90 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/RxRing.h"
+
+#include <string>
+#include <thread>
+
+TEST(RxRing, Capacity) {
+    RxRing ring(200);
+    EXPECT_EQ(ring.capacity(), 256);
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(RxRing, PeekWraps) {
+    RxRing         ring(8);
+    const uint8_t* data = nullptr;
+
+    EXPECT_EQ(ring.push(reinterpret_cast<const uint8_t*>("abcdef"), 6), 6);
+    ASSERT_EQ(ring.peek(data), 6);
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(data), 4), "abcd");
+    ring.consume(4);
+
+    // Six more bytes wrap around the end of the storage
+    EXPECT_EQ(ring.push(reinterpret_cast<const uint8_t*>("ghijkl"), 6), 6);
+    EXPECT_EQ(ring.size(), 8);
+    ASSERT_EQ(ring.peek(data), 4);
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(data), 4), "efgh");
+    ring.consume(4);
+    ASSERT_EQ(ring.peek(data), 4);
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(data), 4), "ijkl");
+}
+
+TEST(RxRing, Overflow) {
+    RxRing ring(8);
+    EXPECT_EQ(ring.push(reinterpret_cast<const uint8_t*>("0123456789"), 10), 8);
+    EXPECT_FALSE(ring.push('x'));
+
+    uint8_t buffer[16];
+    EXPECT_EQ(ring.read(buffer, 3), 3);
+    EXPECT_EQ(ring.read(buffer, sizeof(buffer)), 5);
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(buffer), 5), "34567");
+
+    ring.push('y');
+    ring.clear();
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(RxRing, TwoTasks) {
+    RxRing       ring(64);
+    const size_t total = 200000;
+
+    std::thread producer([&ring] {
+        uint8_t chunk[13];
+        size_t  sent = 0;
+        while (sent < total) {
+            size_t n = std::min(sizeof(chunk), total - sent);
+            for (size_t i = 0; i < n; i++) {
+                chunk[i] = uint8_t(sent + i);
+            }
+            size_t stored = 0;
+            while (stored < n) {
+                stored += ring.push(chunk + stored, n - stored);
+                if (stored < n) {
+                    std::this_thread::yield();
+                }
+            }
+            sent += n;
+        }
+    });
+
+    size_t received = 0;
+    bool   in_order = true;
+    while (received < total) {
+        const uint8_t* data;
+        size_t         n = ring.peek(data);
+        if (!n) {
+            std::this_thread::yield();
+        }
+        for (size_t i = 0; i < n; i++) {
+            in_order = in_order && data[i] == uint8_t(received + i);
+        }
+        ring.consume(n);
+        received += n;
+    }
+    producer.join();
+    EXPECT_TRUE(in_order);
+    EXPECT_TRUE(ring.empty());
+}
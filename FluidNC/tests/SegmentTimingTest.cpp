@@ -0,0 +1,82 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/SegmentTiming.h"
+
+static const uint32_t ticks_per_minute = 20000000 * 60;
+static const float    dt_segment       = 1.0f / (100 * 60);  // One ACCELERATION_TICKS_PER_SECOND segment, in minutes
+
+// Run one block through both paths, segment by segment, the way prep_buffer() does.
+// speed is in steps/min; each segment covers a fixed step distance at that speed.
+static void run_block(uint32_t step_event_count, float speed) {
+    SegmentTiming flt = { 0, 0, float(step_event_count), 0.0f };
+    SegmentTiming fix = flt;
+
+    float    step_dist_remaining = float(step_event_count);
+    uint32_t float_steps         = 0;
+    uint32_t fixed_steps         = 0;
+    while (step_dist_remaining > 0.0f) {
+        step_dist_remaining -= speed * dt_segment;
+        if (step_dist_remaining < 0.0f) {
+            step_dist_remaining = 0.0f;
+        }
+        float dt_float = dt_segment + flt.dt_remainder;
+        float dt_fixed = dt_segment + fix.dt_remainder;
+        segment_timing_float(flt.steps_remaining, step_dist_remaining, dt_float, ticks_per_minute, flt);
+        segment_timing_fixed(fix.steps_remaining, step_dist_remaining, dt_fixed, ticks_per_minute, fix);
+
+        ASSERT_EQ(flt.n_step, fix.n_step) << "at " << step_dist_remaining << " steps remaining";
+        ASSERT_EQ(flt.steps_remaining, fix.steps_remaining);
+        if (flt.n_step) {
+            // The fixed path rounds the step distance to 1/256 step and the segment time to a tick.
+            ASSERT_NEAR(double(flt.timer_ticks), double(fix.timer_ticks), 1.0 + flt.timer_ticks * 0.005);
+        }
+        ASSERT_NEAR(flt.dt_remainder, fix.dt_remainder, dt_segment * 0.01f);
+        float_steps += flt.n_step;
+        fixed_steps += fix.n_step;
+    }
+    EXPECT_EQ(float_steps, step_event_count);
+    EXPECT_EQ(fixed_steps, step_event_count);
+}
+
+TEST(SegmentTiming, SlowFeed) {
+    run_block(1000, 6000.0f);
+}
+
+TEST(SegmentTiming, FastFeed) {
+    run_block(200000, 3000000.0f);
+}
+
+TEST(SegmentTiming, FractionalStepsPerSegment) {
+    run_block(12345, 77777.7f);
+}
+
+TEST(SegmentTiming, LongBlock) {
+    run_block(4000000, 1000000.0f);
+}
+
+TEST(SegmentTiming, FallsBackBeyondFixedRange) {
+    // More than 2^23 steps remaining must give exactly the float result.
+    SegmentTiming flt, fix;
+    segment_timing_float(9000000.0f, 8999000.5f, dt_segment, ticks_per_minute, flt);
+    segment_timing_fixed(9000000.0f, 8999000.5f, dt_segment, ticks_per_minute, fix);
+    EXPECT_EQ(flt.n_step, fix.n_step);
+    EXPECT_EQ(flt.timer_ticks, fix.timer_ticks);
+    EXPECT_EQ(flt.dt_remainder, fix.dt_remainder);
+
+    // So must a segment that lasts longer than 2^24 ticks.
+    segment_timing_float(10.0f, 9.5f, 1.0f, ticks_per_minute, flt);
+    segment_timing_fixed(10.0f, 9.5f, 1.0f, ticks_per_minute, fix);
+    EXPECT_EQ(flt.timer_ticks, fix.timer_ticks);
+}
+
+TEST(SegmentTiming, ExactStepBoundary) {
+    // A segment that ends exactly on a step leaves no partial step behind.
+    SegmentTiming fix;
+    segment_timing_fixed(100.0f, 90.0f, dt_segment, ticks_per_minute, fix);
+    EXPECT_EQ(fix.n_step, 10);
+    EXPECT_EQ(fix.steps_remaining, 90.0f);
+    EXPECT_EQ(fix.dt_remainder, 0.0f);
+    EXPECT_EQ(fix.timer_ticks, 20000u);
+}
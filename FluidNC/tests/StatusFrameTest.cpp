@@ -0,0 +1,73 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/StatusFrame.h"
+
+static uint32_t get(const uint8_t* p, size_t size) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < size; i++) {
+        value |= uint32_t(p[i]) << (8 * i);
+    }
+    return value;
+}
+
+TEST(StatusFrame, PinBits) {
+    EXPECT_EQ(StatusFrame::pin_bits(""), 0);
+    EXPECT_EQ(StatusFrame::pin_bits("P"), 1);
+    EXPECT_EQ(StatusFrame::pin_bits("XZ"), (1 << 2) | (1 << 4));
+    EXPECT_EQ(StatusFrame::pin_bits("H?"), 1 << 13);
+    EXPECT_EQ(StatusFrame::pin_bit('T'), 1 << 1);
+    EXPECT_EQ(StatusFrame::pin_bit('?'), 0);
+}
+
+TEST(StatusFrame, PinString) {
+    char text[sizeof(StatusFrame::pin_letters)];
+    StatusFrame::pin_string(0, text);
+    EXPECT_STREQ(text, "");
+    StatusFrame::pin_string(StatusFrame::pin_bits("HZP"), text);
+    EXPECT_STREQ(text, "PZH");
+    StatusFrame::pin_string(~0u, text);
+    EXPECT_STREQ(text, StatusFrame::pin_letters);
+}
+
+TEST(StatusFrame, Encode) {
+    StatusFrame::Fields fields;
+    fields.state         = 4;
+    fields.n_axis        = 3;
+    fields.flags         = StatusFrame::WorkPosition;
+    fields.planner_free  = 15;
+    fields.rx_free       = 4000;
+    fields.feed_rate     = 1200;
+    fields.spindle_speed = 18000;
+    fields.feed_override = 110;
+    fields.accessories   = StatusFrame::SpindleCw | StatusFrame::Flood;
+    fields.pins          = StatusFrame::pin_bits("PY");
+    fields.line_number   = 70000;
+    fields.position[0]   = 1.2345f;
+    fields.position[1]   = -250.0f;
+    fields.position[2]   = -0.0004f;
+
+    uint8_t frame[StatusFrame::max_size];
+    size_t  length = StatusFrame::encode(fields, frame);
+    ASSERT_EQ(length, 28 + 3 * 4);
+
+    EXPECT_EQ(frame[0], StatusFrame::magic);
+    EXPECT_EQ(frame[1], StatusFrame::version);
+    EXPECT_EQ(frame[2], 4);
+    EXPECT_EQ(frame[3], 3);
+    EXPECT_EQ(frame[4], StatusFrame::WorkPosition);
+    EXPECT_EQ(frame[5], 15);
+    EXPECT_EQ(get(frame + 6, 2), 4000);
+    EXPECT_EQ(get(frame + 8, 4), 1200);
+    EXPECT_EQ(get(frame + 12, 4), 18000);
+    EXPECT_EQ(frame[16], 110);
+    EXPECT_EQ(frame[17], 100);
+    EXPECT_EQ(frame[18], 100);
+    EXPECT_EQ(frame[19], StatusFrame::SpindleCw | StatusFrame::Flood);
+    EXPECT_EQ(get(frame + 20, 4), (1 << 0) | (1 << 3));
+    EXPECT_EQ(get(frame + 24, 4), 70000);
+    EXPECT_EQ(int32_t(get(frame + 28, 4)), 1235);
+    EXPECT_EQ(int32_t(get(frame + 32, 4)), -250000);
+    EXPECT_EQ(int32_t(get(frame + 36, 4)), 0);
+}
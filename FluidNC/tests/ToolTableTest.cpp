@@ -0,0 +1,92 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/ToolTable.h"
+
+using namespace ToolTable;
+
+TEST(ToolTable, ParseLine) {
+    Tool tool;
+    ASSERT_TRUE(parse_line("T3 L-42.125 D6.35 X100 Y20 Z-30 (6mm end mill)", tool));
+    EXPECT_EQ(tool.number, 3);
+    EXPECT_TRUE(tool.has_length);
+    EXPECT_FLOAT_EQ(tool.length, -42.125f);
+    EXPECT_FLOAT_EQ(tool.diameter, 6.35f);
+    EXPECT_TRUE(tool.has_pocket);
+    EXPECT_FLOAT_EQ(tool.pocket[0], 100.0f);
+    EXPECT_FLOAT_EQ(tool.pocket[1], 20.0f);
+    EXPECT_FLOAT_EQ(tool.pocket[2], -30.0f);
+
+    ASSERT_TRUE(parse_line("t12 d3\r", tool));
+    EXPECT_EQ(tool.number, 12);
+    EXPECT_FALSE(tool.has_length);
+    EXPECT_FALSE(tool.has_pocket);
+
+    // Ignored lines
+    ASSERT_TRUE(parse_line("", tool));
+    EXPECT_EQ(tool.number, 0);
+    ASSERT_TRUE(parse_line("  ; T1 L2", tool));
+    EXPECT_EQ(tool.number, 0);
+
+    EXPECT_FALSE(parse_line("T0 L1", tool));
+    EXPECT_FALSE(parse_line("T2 Q1", tool));
+    EXPECT_FALSE(parse_line("T2 L", tool));
+    EXPECT_FALSE(parse_line("T2 (open", tool));
+}
+
+TEST(ToolTable, FormatLine) {
+    Tool tool;
+    tool.number     = 7;
+    tool.has_length = true;
+    tool.length     = -12.5f;
+    tool.diameter   = 3.175f;
+
+    char line[100];
+    format_line(line, sizeof(line), tool);
+    EXPECT_STREQ(line, "T7 L-12.500 D3.175");
+
+    tool.has_pocket = true;
+    tool.pocket[0]  = 1.0f;
+    format_line(line, sizeof(line), tool);
+    Tool back;
+    ASSERT_TRUE(parse_line(line, back));
+    EXPECT_EQ(back.number, 7);
+    EXPECT_FLOAT_EQ(back.length, tool.length);
+    EXPECT_FLOAT_EQ(back.diameter, tool.diameter);
+    EXPECT_FLOAT_EQ(back.pocket[0], 1.0f);
+
+    // Truncated like snprintf()
+    char short_line[8];
+    EXPECT_GT(format_line(short_line, sizeof(short_line), tool), 8);
+    EXPECT_STREQ(short_line, "T7 L-12");
+}
+
+TEST(ToolTable, Table) {
+    Table table;
+    EXPECT_EQ(table.find(1), nullptr);
+
+    table.get(5).diameter = 2.0f;
+    table.get(1);
+    table.get(3);
+    ASSERT_EQ(table.tools().size(), 3);
+    EXPECT_EQ(table.tools()[0].number, 1);
+    EXPECT_EQ(table.tools()[2].number, 5);
+    ASSERT_NE(table.find(5), nullptr);
+    EXPECT_FALSE(table.find(5)->has_length);
+    EXPECT_FLOAT_EQ(table.find(5)->diameter, 2.0f);
+
+    Tool tool;
+    tool.number     = 3;
+    tool.has_length = true;
+    tool.length     = 4.0f;
+    table.set(tool);
+    EXPECT_EQ(table.tools().size(), 3);
+    EXPECT_TRUE(table.find(3)->has_length);
+
+    EXPECT_TRUE(table.erase(3));
+    EXPECT_FALSE(table.erase(3));
+    EXPECT_EQ(table.find(3), nullptr);
+    table.clear();
+    EXPECT_TRUE(table.tools().empty());
+}
@@ -0,0 +1,52 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/UTF8.h"
+
+static bool decode(std::initializer_list<uint8_t> bytes, uint32_t& value) {
+    UTF8 utf8;
+    return utf8.decode(bytes.begin(), bytes.size(), value);
+}
+
+TEST(UTF8, RoundTrip) {
+    for (uint32_t value : { 0x00, 0x7f, 0x100, 0x13f, 0x140, 0x17f, 0x1ff, 0x200, 0x2ff, 0x7ff, 0x800, 0xffff, 0x10000, 0x100000, 0x10ffff }) {
+        uint8_t  buf[UTF8::max_length];
+        size_t   len = UTF8::encode(value, buf);
+        UTF8     utf8;
+        uint32_t decoded = 0;
+        ASSERT_GT(len, 0) << std::hex << value;
+        EXPECT_TRUE(utf8.decode(buf, len, decoded)) << std::hex << value;
+        EXPECT_EQ(decoded, value);
+    }
+}
+
+TEST(UTF8, EncodeLengths) {
+    uint8_t buf[UTF8::max_length];
+    EXPECT_EQ(UTF8::encode(0x41, buf), 1);
+    EXPECT_EQ(UTF8::encode(0xe9, buf), 2);
+    EXPECT_EQ(buf[0], 0xc3);
+    EXPECT_EQ(buf[1], 0xa9);
+    EXPECT_EQ(UTF8::encode(0x20ac, buf), 3);
+    EXPECT_EQ(UTF8::encode(0x1f600, buf), 4);
+    EXPECT_EQ(UTF8::encode(0x110000, buf), 0);
+}
+
+TEST(UTF8, DecodeErrors) {
+    uint32_t value;
+    EXPECT_FALSE(decode({}, value));                    // Nothing to decode
+    EXPECT_FALSE(decode({ 0xc3 }, value));              // Incomplete sequence
+    EXPECT_FALSE(decode({ 0xc3, 0x30 }, value));        // Non-continuation inside
+    EXPECT_FALSE(decode({ 0xc3, 0xa9, 0x30 }, value));  // Extra bytes
+    EXPECT_FALSE(decode({ 0xf8 }, value));              // Invalid start byte
+    EXPECT_FALSE(decode({ 0xbf }, value));              // Continuation byte outside
+}
+
+TEST(UTF8, RealtimePassThrough) {
+    // GRBL realtime bytes 0x80-0xbe are sent unencoded
+    uint32_t value;
+    EXPECT_TRUE(decode({ 0x85 }, value));
+    EXPECT_EQ(value, 0x85);
+    EXPECT_TRUE(decode({ 0x9e }, value));
+    EXPECT_EQ(value, 0x9e);
+}
@@ -0,0 +1,55 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/WordIndex.h"
+
+#include <vector>
+
+struct TestWord {
+    const char* _name;
+    const char* _grblName;
+
+    const char* getName() { return _name; }
+    const char* getGrblName() { return _grblName; }
+};
+
+TEST(WordIndex, Names) {
+    TestWord               a { "Sta/SSID", "ESP100" };
+    TestWord               b { "Report/Inches", "13" };
+    TestWord               c { "Help", nullptr };
+    std::vector<TestWord*> list { &a, &b, &c };
+
+    WordIndex<TestWord> both(true, true);
+    EXPECT_EQ(both.find(list, "Sta/SSID"), &a);
+    EXPECT_EQ(both.find(list, "sta/ssid"), &a);
+    EXPECT_EQ(both.find(list, "esp100"), &a);
+    EXPECT_EQ(both.find(list, "13"), &b);
+    EXPECT_EQ(both.find(list, "HELP"), &c);
+    EXPECT_EQ(both.find(list, "Hel"), nullptr);
+    EXPECT_EQ(both.find(list, "Helpx"), nullptr);
+    EXPECT_EQ(both.find(list, ""), nullptr);
+
+    WordIndex<TestWord> names(true, false);
+    EXPECT_EQ(names.find(list, "report/inches"), &b);
+    EXPECT_EQ(names.find(list, "13"), nullptr);
+
+    WordIndex<TestWord> grbl(false, true);
+    EXPECT_EQ(grbl.find(list, "13"), &b);
+    EXPECT_EQ(grbl.find(list, "Report/Inches"), nullptr);
+}
+
+TEST(WordIndex, FirstInList) {
+    TestWord               newer { "X", nullptr };
+    TestWord               older { "x", "Y" };
+    TestWord               alias { "Z", "X" };
+    std::vector<TestWord*> list { &newer, &older };
+
+    WordIndex<TestWord> index(true, true);
+    EXPECT_EQ(index.find(list, "X"), &newer);
+
+    // Registration inserts at the front, and the index follows the list
+    list.insert(list.begin(), &alias);
+    EXPECT_EQ(index.find(list, "x"), &alias);
+    EXPECT_EQ(index.find(list, "y"), &older);
+}
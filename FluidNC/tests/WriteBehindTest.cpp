@@ -0,0 +1,89 @@
+// Copyright (c) 2026 -  FluidNC contributors
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/WriteBehind.h"
+
+#include <string>
+#include <thread>
+
+struct FakeFile {
+    std::string data;
+    size_t      limit = std::string::npos;  // Writes fail beyond this size
+};
+
+static size_t fake_write(void* arg, const char* buffer, size_t length) {
+    auto* file = static_cast<FakeFile*>(arg);
+    if (file->data.size() + length > file->limit) {
+        return 0;
+    }
+    file->data.append(buffer, length);
+    return length;
+}
+
+static void wait() {
+    std::this_thread::yield();
+}
+
+static std::string make_data(size_t size) {
+    std::string data;
+    for (size_t i = 0; i < size; i++) {
+        data += char('a' + i % 23);
+    }
+    return data;
+}
+
+// Runs the background side on a thread while the test body writes
+class Writer {
+    std::atomic<bool> _done { false };
+    std::thread       _thread;
+
+public:
+    explicit Writer(WriteBehind& writer) :
+        _thread([&] {
+            while (!_done) {
+                if (!writer.write_behind()) {
+                    std::this_thread::yield();
+                }
+            }
+        }) {}
+    ~Writer() {
+        _done = true;
+        _thread.join();
+    }
+};
+
+TEST(WriteBehind, WritesInOrder) {
+    for (size_t size : { 0, 1, 63, 64, 65, 128, 100000 }) {
+        FakeFile    file;
+        char        storage[128];
+        WriteBehind writer(storage, 64, fake_write, &file, wait);
+        Writer      background(writer);
+
+        std::string data = make_data(size);
+        for (size_t pos = 0; pos < size; pos += 7) {
+            EXPECT_TRUE(writer.write(data.data() + pos, std::min<size_t>(7, size - pos)));
+        }
+        EXPECT_TRUE(writer.finish());
+        EXPECT_EQ(file.data, data) << size;
+        EXPECT_EQ(writer.stats().bytes, size);
+        EXPECT_EQ(writer.stats().writes, (size + 63) / 64);
+    }
+}
+
+TEST(WriteBehind, FailedWrite) {
+    FakeFile file;
+    file.limit = 100;
+    char        storage[128];
+    WriteBehind writer(storage, 64, fake_write, &file, wait);
+    Writer      background(writer);
+
+    std::string data = make_data(1000);
+    bool        ok   = true;
+    for (size_t pos = 0; pos < data.size() && ok; pos += 10) {
+        ok = writer.write(data.data() + pos, 10);
+    }
+    EXPECT_FALSE(writer.finish());
+    EXPECT_TRUE(writer.failed());
+    EXPECT_EQ(file.data, data.substr(0, 64));
+}
@@ -162,3 +162,4 @@ esp_err_t nvs_set_i8(nvs_handle handle, const char* key, int8_t value);
 esp_err_t nvs_set_i32(nvs_handle handle, const char* key, int32_t value);
 esp_err_t nvs_set_str(nvs_handle handle, const char* key, const char* value);
 esp_err_t nvs_set_blob(nvs_handle handle, const char* key, const void* value, size_t length);
+esp_err_t nvs_commit(nvs_handle handle);
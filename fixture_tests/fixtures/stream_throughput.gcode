@@ -0,0 +1,63 @@
+; Short CAM-style moves, streamed in check mode by stream_throughput.nc
+G21 G90 G94
+G1 F1500
+G1 X30.000 Y20.000
+G1 X29.945 Y21.045
+G1 X29.781 Y22.079
+G1 X29.511 Y23.090
+G1 X29.135 Y24.067
+G1 X28.660 Y25.000
+G1 X28.090 Y25.878
+G1 X27.431 Y26.691
+G1 X26.691 Y27.431
+G1 X25.878 Y28.090
+G1 X25.000 Y28.660
+G1 X24.067 Y29.135
+G1 X23.090 Y29.511
+G1 X22.079 Y29.781
+G1 X21.045 Y29.945
+G1 X20.000 Y30.000
+G1 X18.955 Y29.945
+G1 X17.921 Y29.781
+G1 X16.910 Y29.511
+G1 X15.933 Y29.135
+G1 X15.000 Y28.660
+G1 X14.122 Y28.090
+G1 X13.309 Y27.431
+G1 X12.569 Y26.691
+G1 X11.910 Y25.878
+G1 X11.340 Y25.000
+G1 X10.865 Y24.067
+G1 X10.489 Y23.090
+G1 X10.219 Y22.079
+G1 X10.055 Y21.045
+G1 X10.000 Y20.000
+G1 X10.055 Y18.955
+G1 X10.219 Y17.921
+G1 X10.489 Y16.910
+G1 X10.865 Y15.933
+G1 X11.340 Y15.000
+G1 X11.910 Y14.122
+G1 X12.569 Y13.309
+G1 X13.309 Y12.569
+G1 X14.122 Y11.910
+G1 X15.000 Y11.340
+G1 X15.933 Y10.865
+G1 X16.910 Y10.489
+G1 X17.921 Y10.219
+G1 X18.955 Y10.055
+G1 X20.000 Y10.000
+G1 X21.045 Y10.055
+G1 X22.079 Y10.219
+G1 X23.090 Y10.489
+G1 X24.067 Y10.865
+G1 X25.000 Y11.340
+G1 X25.878 Y11.910
+G1 X26.691 Y12.569
+G1 X27.431 Y13.309
+G1 X28.090 Y14.122
+G1 X28.660 Y15.000
+G1 X29.135 Y15.933
+G1 X29.511 Y16.910
+G1 X29.781 Y17.921
+G1 X29.945 Y18.955
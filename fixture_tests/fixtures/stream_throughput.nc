@@ -0,0 +1,18 @@
+# Transport performance: streams in check mode, so that the numbers measure the
+# channel and the parser rather than the motion.  The thresholds are for a USB
+# serial link at 115200 baud; raise them for faster links.
+-> $X
+<~ [MSG:INFO: Caution: Unlocked]
+<- ok
+-> $C
+<- [MSG:INFO: Enabled]
+<- ok
+>> stream_throughput.gcode repeat=40 rx=128 status=0.2
+>= lines_per_sec 200
+<= ack_ms_p99 100
+<= status_ms_p99 50
+?? 100
+<= status_ms_p99 20
+# Leaving check mode resets the controller, which the next fixture waits for
+-> $C
+<- [MSG:INFO: Disabled]
@@ -1,4 +1,5 @@
 import serial
+import time
 from termcolor import colored
 
 
@@ -7,6 +8,8 @@ class Controller:
         self._debug = False
         self._serial = serial.Serial(device, baudrate, timeout=timeout)
         self._current_line = None
+        # Measurements of the performance ops, by name, for the threshold ops to check
+        self.metrics = {}
 
     def send_soft_reset(self):
         self._serial.write(b"\x18")
@@ -34,6 +37,19 @@ class Controller:
         # print(colored("[c] -> " + line, "light_blue"))
         self._serial.write(line.encode("utf-8") + b"\n")
 
+    def send_realtime(self, char):
+        # Realtime commands such as ? are single bytes without a newline
+        self._serial.write(char)
+
+    def timed_line(self):
+        # Returns the next line and the time it was received, or "" on timeout
+        if self._current_line is not None:
+            line = self._current_line
+            self.clear_line()
+            return line, time.monotonic()
+        line = self._serial.readline().decode("utf-8", "replace").strip()
+        return line, time.monotonic()
+
     def getc(self, size):
         return self._serial.read(size) or None
 
@@ -1,6 +1,8 @@
 import re
 from xmodem import XMODEM
 import os
+import time
+from collections import deque
 from tool.utils import remote_file_sha256, file_stream_sha256, color
 import fnmatch
 
@@ -216,6 +218,147 @@ class SendFileOpEntry(OpEntry):
             return True
 
 
+def percentile(values, fraction):
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(fraction * len(ordered)))]
+
+
+def record_latencies(controller, name, seconds):
+    # Stores name_p50, name_p99 and name_max in milliseconds
+    if not seconds:
+        return ""
+    ms = [s * 1000.0 for s in seconds]
+    controller.metrics[name + "_p50"] = percentile(ms, 0.50)
+    controller.metrics[name + "_p99"] = percentile(ms, 0.99)
+    controller.metrics[name + "_max"] = max(ms)
+    return (
+        f"{name} p50:{controller.metrics[name + '_p50']:.1f}ms "
+        f"p99:{controller.metrics[name + '_p99']:.1f}ms "
+        f"max:{controller.metrics[name + '_max']:.1f}ms"
+    )
+
+
+class StreamFileOpEntry(OpEntry):
+    # >> file [repeat=N] [rx=BYTES] [status=SECONDS]
+    # Streams the G-code file with character-counting flow control, as senders do, keeping
+    # up to rx bytes unacknowledged.  Records lines_per_sec, the ack round trip of each line
+    # as ack_ms_*, and the latency of a ? sent every status seconds as status_ms_*.
+    def __init__(self, op, data, lineno, fixture_path):
+        super().__init__(op, data, lineno, fixture_path)
+        fields = data.split(" ")
+        self.local_file_path = os.path.normpath(
+            os.path.join(os.path.dirname(fixture_path), fields[0])
+        )
+        options = dict(field.split("=", 1) for field in fields[1:] if "=" in field)
+        self.repeat = int(options.get("repeat", 1))
+        self.rx_size = int(options.get("rx", 128))
+        self.status_interval = float(options.get("status", 0.2))
+        if not os.path.exists(self.local_file_path):
+            raise ValueError(
+                f"Local file '{self.local_file_path}' does not exist at line {lineno} in fixture file {fixture_path}"
+            )
+
+    def _lines(self):
+        with open(self.local_file_path, "r") as f:
+            lines = [line.strip() for line in f.read().splitlines()]
+        lines = [line for line in lines if line and not line.startswith(";")]
+        return lines * self.repeat
+
+    def execute(self, controller):
+        lines = self._lines()
+        print(
+            self._op_str()
+            + color.green(self.local_file_path)
+            + color.dark_grey(f" ({len(lines)} lines, rx:{self.rx_size})")
+        )
+        in_flight = deque()  # (bytes, time sent) of the unacknowledged lines
+        queued = 0
+        acks = []
+        status = []
+        status_sent = None
+        next_status = time.monotonic() + self.status_interval
+        position = 0
+        start = time.monotonic()
+        while position < len(lines) or in_flight:
+            while position < len(lines) and queued + len(lines[position]) + 1 <= self.rx_size:
+                controller.send_line(lines[position])
+                in_flight.append((len(lines[position]) + 1, time.monotonic()))
+                queued += len(lines[position]) + 1
+                position += 1
+            now = time.monotonic()
+            if status_sent is None and now >= next_status:
+                controller.send_realtime(b"?")
+                status_sent = now
+            line, received = controller.timed_line()
+            if line == "":
+                raise TimeoutError(
+                    f"{len(in_flight)} lines unacknowledged at line {self.lineno} in fixture file {self.fixture_path}"
+                )
+            if line == "ok":
+                size, sent = in_flight.popleft()
+                queued -= size
+                acks.append(received - sent)
+            elif line.startswith("error:") or line.startswith("ALARM:"):
+                print(color.error(f"Line {position - len(in_flight) + 1}: {line}"))
+                return False
+            elif line.startswith("<") and status_sent is not None:
+                status.append(received - status_sent)
+                status_sent = None
+                next_status = received + self.status_interval
+        seconds = time.monotonic() - start
+
+        controller.metrics["lines_per_sec"] = len(lines) / seconds
+        print(self._op_str() + color.green(f"lines_per_sec:{controller.metrics['lines_per_sec']:.0f}"))
+        print(self._op_str() + color.green(record_latencies(controller, "ack_ms", acks)))
+        if status:
+            print(self._op_str() + color.green(record_latencies(controller, "status_ms", status)))
+        # A status report that was requested near the end may still be on its way
+        controller.drain()
+        return True
+
+
+class StatusLatencyOpEntry(OpEntry):
+    # ?? N
+    # Sends ? N times, each after the previous report arrived, and records the time to
+    # each report as status_ms_*.
+    def execute(self, controller):
+        count = int(self.data or 100)
+        latencies = []
+        for _ in range(count):
+            controller.send_realtime(b"?")
+            sent = time.monotonic()
+            while True:
+                line, received = controller.timed_line()
+                if line == "":
+                    raise TimeoutError(
+                        f"No status report at line {self.lineno} in fixture file {self.fixture_path}"
+                    )
+                if line.startswith("<"):
+                    latencies.append(received - sent)
+                    break
+        print(self._op_str() + color.green(record_latencies(controller, "status_ms", latencies)))
+        return True
+
+
+class ThresholdOpEntry(OpEntry):
+    # >= metric value, or <= metric value
+    # Fails the fixture if the last recorded metric is not at least, or at most, value.
+    def execute(self, controller):
+        name, limit = self.data.split(" ")
+        limit = float(limit)
+        if name not in controller.metrics:
+            print(color.error(f"No measurement of {name}"))
+            return False
+        value = controller.metrics[name]
+        passed = value >= limit if self.op == ">=" else value <= limit
+        text = f"{name} {value:.1f} {self.op} {limit:g}"
+        if passed:
+            print(self._op_str() + color.green(text))
+        else:
+            print(color.error("Threshold failed: ") + text)
+        return passed
+
+
 OPS_MAP = {
     # send command to controller
     "->": SendLineOpEntry,
@@ -229,4 +372,11 @@ OPS_MAP = {
     "<...": UntilStringMatchOpEntry,
     # expect one of
     "<|": AnyStringMatchOpEntry,
+    # stream a G-code file, measuring throughput, ack round trip and status latency
+    ">>": StreamFileOpEntry,
+    # measure status report latency
+    "??": StatusLatencyOpEntry,
+    # fail unless a measurement is at least / at most a value
+    ">=": ThresholdOpEntry,
+    "<=": ThresholdOpEntry,
 }